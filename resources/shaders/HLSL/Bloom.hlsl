@@ -0,0 +1,57 @@
+#include "bloom_chain.hlsl"
+
+_BBCONSTANT(BB::ShaderBloom) shader_indices;
+
+// the first level is half the bright image, a box filter of the 4 texels it covers.
+[numthreads(BLOOM_GROUP_SIZE, BLOOM_GROUP_SIZE, 1)]
+void PrefilterMain(uint3 a_thread_id : SV_DispatchThreadID)
+{
+    const uint2 dst_texel = a_thread_id.xy;
+    if (any(dst_texel >= shader_indices.dst_resolution))
+        return;
+
+    const Texture2D bright = textures_data[shader_indices.src];
+    const int2 max_texel = int2(shader_indices.src_resolution) - 1;
+    const int2 src_texel = int2(dst_texel * 2);
+    float3 color = float3(0.0, 0.0, 0.0);
+    color += bright.Load(int3(min(src_texel, max_texel), 0)).rgb;
+    color += bright.Load(int3(min(src_texel + int2(1, 0), max_texel), 0)).rgb;
+    color += bright.Load(int3(min(src_texel + int2(0, 1), max_texel), 0)).rgb;
+    color += bright.Load(int3(min(src_texel + int2(1, 1), max_texel), 0)).rgb;
+
+    StoreBloomTexel(shader_indices.bloom_address, shader_indices.dst_offset, shader_indices.dst_resolution, dst_texel, color * 0.25);
+}
+
+// a 4x4 tent filter, 1 3 3 1 on both axes, so the chain does not flicker when something bright moves.
+[numthreads(BLOOM_GROUP_SIZE, BLOOM_GROUP_SIZE, 1)]
+void DownsampleMain(uint3 a_thread_id : SV_DispatchThreadID)
+{
+    const uint2 dst_texel = a_thread_id.xy;
+    if (any(dst_texel >= shader_indices.dst_resolution))
+        return;
+
+    const float weights[4] = { 1.0, 3.0, 3.0, 1.0 };
+    const int2 src_texel = int2(dst_texel * 2) - 1;
+    float3 color = float3(0.0, 0.0, 0.0);
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++)
+            color += LoadBloomTexel(shader_indices.bloom_address, shader_indices.src, shader_indices.src_resolution, src_texel + int2(x, y)) * weights[x] * weights[y];
+
+    StoreBloomTexel(shader_indices.bloom_address, shader_indices.dst_offset, shader_indices.dst_resolution, dst_texel, color / 64.0);
+}
+
+// adds the smaller level on top of the bigger one, in place, so the first level ends up with the whole chain.
+[numthreads(BLOOM_GROUP_SIZE, BLOOM_GROUP_SIZE, 1)]
+void UpsampleMain(uint3 a_thread_id : SV_DispatchThreadID)
+{
+    const uint2 dst_texel = a_thread_id.xy;
+    if (any(dst_texel >= shader_indices.dst_resolution))
+        return;
+
+    const float2 uv = (float2(dst_texel) + 0.5) / float2(shader_indices.dst_resolution);
+    const float3 color =
+        LoadBloomTexel(shader_indices.bloom_address, shader_indices.dst_offset, shader_indices.dst_resolution, int2(dst_texel)) +
+        SampleBloomLevel(shader_indices.bloom_address, shader_indices.src, shader_indices.src_resolution, uv);
+
+    StoreBloomTexel(shader_indices.bloom_address, shader_indices.dst_offset, shader_indices.dst_resolution, dst_texel, color);
+}
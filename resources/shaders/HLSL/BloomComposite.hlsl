@@ -0,0 +1,25 @@
+#include "bloom_chain.hlsl"
+
+struct VSOutput
+{
+    float4 pos : SV_POSITION;
+    _BBEXT(0)float2 uv : TEXCOORD0;
+};
+
+_BBCONSTANT(BB::ShaderBloomComposite) shader_indices;
+
+// thanks Sascha Willems https://www.saschawillems.de/blog/2016/08/13/vulkan-tutorial-on-rendering-a-fullscreen-quad-without-buffers/
+VSOutput VertexMain(uint a_vertex_index : SV_VertexID)
+{
+    VSOutput output;
+    output.uv = float2((a_vertex_index << 1) & 2, a_vertex_index & 2);
+    output.pos = float4(output.uv * 2.0f + -1.0f, 0.0f, 1.0f);
+    return output;
+}
+
+// the blend state adds this on top of the render target.
+float4 FragmentMain(VSOutput a_input) : SV_Target
+{
+    const float3 bloom = SampleBloomLevel(shader_indices.bloom_address, 0, shader_indices.resolution, a_input.uv);
+    return float4(bloom * shader_indices.strength, 1.0);
+}
@@ -0,0 +1,38 @@
+#include "common.hlsl"
+
+_BBCONSTANT(BB::ShaderHiZBuild) shader_indices;
+
+float LoadSourceDepth(const uint2 a_texel)
+{
+    if (shader_indices.depth_texture != INVALID_TEXTURE)
+        return textures_data[shader_indices.depth_texture].Load(int3(a_texel, 0)).r;
+
+    const uint index = shader_indices.src_offset + a_texel.y * shader_indices.src_resolution.x + a_texel.x;
+    return vk::RawBufferLoad<float>(shader_indices.hiz_address + index * sizeof(float));
+}
+
+// every texel stores the furthest depth of the source texels it covers.
+[numthreads(HIZ_BUILD_GROUP_SIZE, HIZ_BUILD_GROUP_SIZE, 1)]
+void ComputeMain(uint3 a_thread_id : SV_DispatchThreadID)
+{
+    const uint2 dst_texel = a_thread_id.xy;
+    if (any(dst_texel >= shader_indices.dst_resolution))
+        return;
+
+    // an odd source size makes the last texel cover 3 source texels, so nothing is skipped.
+    const uint2 src_begin = dst_texel * shader_indices.src_resolution / shader_indices.dst_resolution;
+    const uint2 src_end = min(((dst_texel + 1) * shader_indices.src_resolution + shader_indices.dst_resolution - 1) / shader_indices.dst_resolution, shader_indices.src_resolution);
+
+    float depth = 0.0;
+    for (uint y = src_begin.y; y < src_end.y; y++)
+        for (uint x = src_begin.x; x < src_end.x; x++)
+            depth = max(depth, LoadSourceDepth(uint2(x, y)));
+
+    // the first level starts the buffer, the other levels follow their source level.
+    uint dst_offset = 0;
+    if (shader_indices.depth_texture == INVALID_TEXTURE)
+        dst_offset = shader_indices.src_offset + shader_indices.src_resolution.x * shader_indices.src_resolution.y;
+
+    const uint index = dst_offset + dst_texel.y * shader_indices.dst_resolution.x + dst_texel.x;
+    vk::RawBufferStore<float>(shader_indices.hiz_address + index * sizeof(float), depth);
+}
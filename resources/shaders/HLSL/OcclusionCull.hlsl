@@ -0,0 +1,158 @@
+#include "common.hlsl"
+
+_BBCONSTANT(BB::ShaderOcclusionCull) shader_indices;
+
+// the most texels a tested rectangle covers on its hi-z level, per axis.
+#define HIZ_MAX_TEXELS 4
+
+float4 LoadFloat4(const uint64_t a_address)
+{
+    return vk::RawBufferLoad<float4>(a_address);
+}
+
+float4x4 LoadFloat4x4(const uint64_t a_address)
+{
+    return float4x4(
+        LoadFloat4(a_address),
+        LoadFloat4(a_address + sizeof(float4)),
+        LoadFloat4(a_address + sizeof(float4) * 2),
+        LoadFloat4(a_address + sizeof(float4) * 3));
+}
+
+uint64_t VisibilityAddress(const uint a_draw_index)
+{
+    return shader_indices.cull_address + a_draw_index * sizeof(uint);
+}
+
+uint64_t IndirectAddress(const uint a_draw_index, const bool a_late)
+{
+    const uint64_t start = shader_indices.cull_address + OCCLUSION_CULL_MAX_DRAWS * sizeof(uint);
+    const uint64_t pass_offset = a_late ? OCCLUSION_CULL_MAX_DRAWS * sizeof(BB::ShaderDrawIndexedIndirect) : 0;
+    return start + pass_offset + a_draw_index * sizeof(BB::ShaderDrawIndexedIndirect);
+}
+
+void WriteIndirect(const uint a_draw_index, const bool a_late, const BB::ShaderOcclusionDraw a_draw, const bool a_visible)
+{
+    const uint64_t address = IndirectAddress(a_draw_index, a_late);
+    vk::RawBufferStore<uint>(address, a_draw.index_count);
+    vk::RawBufferStore<uint>(address + 4, a_visible ? 1 : 0);
+    vk::RawBufferStore<uint>(address + 8, a_draw.first_index);
+    vk::RawBufferStore<int>(address + 12, 0);
+    vk::RawBufferStore<uint>(address + 16, 0);
+}
+
+BB::ShaderOcclusionDraw LoadDraw(const uint a_draw_index)
+{
+    const uint64_t address = shader_indices.draws_address + sizeof(BB::ShaderOcclusionCullHeader) + a_draw_index * sizeof(BB::ShaderOcclusionDraw);
+    const float4 min_first = LoadFloat4(address);
+    const float4 max_count = LoadFloat4(address + sizeof(float4));
+
+    BB::ShaderOcclusionDraw draw;
+    draw.bounds_min = min_first.xyz;
+    draw.first_index = asuint(min_first.w);
+    draw.bounds_max = max_count.xyz;
+    draw.index_count = asuint(max_count.w);
+    return draw;
+}
+
+float LoadHiZ(const uint a_index)
+{
+    return vk::RawBufferLoad<float>(shader_indices.hiz_address + a_index * sizeof(float));
+}
+
+// frustum test and, when there is a pyramid, the occlusion test against the furthest depth behind the bounds.
+bool IsVisible(const BB::ShaderOcclusionDraw a_draw, const float4x4 a_view, const float4x4 a_proj)
+{
+    float2 uv_min = float2(1.0, 1.0);
+    float2 uv_max = float2(0.0, 0.0);
+    float nearest_depth = 1.0;
+    for (uint i = 0; i < 8; i++)
+    {
+        const float3 corner = float3(
+            (i & 1) ? a_draw.bounds_max.x : a_draw.bounds_min.x,
+            (i & 2) ? a_draw.bounds_max.y : a_draw.bounds_min.y,
+            (i & 4) ? a_draw.bounds_max.z : a_draw.bounds_min.z);
+        const float4 clip = mul(a_proj, mul(a_view, float4(corner, 1.0)));
+
+        // the bounds cross the camera plane, they can not be projected so always draw them.
+        if (clip.w <= 0.0)
+            return true;
+
+        const float3 ndc = clip.xyz / clip.w;
+        const float2 uv = ndc.xy * 0.5 + 0.5;
+        uv_min = min(uv_min, uv);
+        uv_max = max(uv_max, uv);
+        nearest_depth = min(nearest_depth, ndc.z);
+    }
+
+    if (any(uv_max < 0.0) || any(uv_min > 1.0) || nearest_depth > 1.0)
+        return false;
+
+    if (shader_indices.hiz_address == 0)
+        return true;
+
+    uv_min = saturate(uv_min);
+    uv_max = saturate(uv_max);
+
+    uint2 level_resolution = uint2(shader_indices.hiz_resolution & 0xFFFF, shader_indices.hiz_resolution >> 16);
+    const float2 size = (uv_max - uv_min) * float2(level_resolution);
+    uint level = uint(ceil(log2(max(max(size.x, size.y), 1.0))));
+
+    // walk to the level, the last level is 1x1 and covers the whole screen.
+    uint level_offset = 0;
+    for (uint current = 0; current < level && any(level_resolution > 1); current++)
+    {
+        level_offset += level_resolution.x * level_resolution.y;
+        level_resolution = max((level_resolution + 1) / 2, uint2(1, 1));
+    }
+
+    const uint2 texel_min = min(uint2(uv_min * float2(level_resolution)), level_resolution - 1);
+    const uint2 texel_max = min(min(uint2(uv_max * float2(level_resolution)), level_resolution - 1), texel_min + HIZ_MAX_TEXELS - 1);
+
+    float furthest_depth = 0.0;
+    for (uint y = texel_min.y; y <= texel_max.y; y++)
+        for (uint x = texel_min.x; x <= texel_max.x; x++)
+            furthest_depth = max(furthest_depth, LoadHiZ(level_offset + y * level_resolution.x + x));
+
+    return nearest_depth <= furthest_depth;
+}
+
+// draws that were visible last frame are tested against the pyramid of last frame and drawn first.
+[numthreads(OCCLUSION_CULL_GROUP_SIZE, 1, 1)]
+void EarlyMain(uint3 a_thread_id : SV_DispatchThreadID)
+{
+    const uint draw_index = a_thread_id.x;
+    if (draw_index >= shader_indices.draw_count)
+        return;
+
+    const BB::ShaderOcclusionDraw draw = LoadDraw(draw_index);
+
+    // without a pyramid the visibility is stale, so leave everything to the late pass.
+    bool visible = false;
+    if (shader_indices.hiz_address != 0 && vk::RawBufferLoad<uint>(VisibilityAddress(draw_index)) != 0)
+    {
+        const float4x4 view = LoadFloat4x4(shader_indices.draws_address);
+        const float4x4 proj = LoadFloat4x4(shader_indices.draws_address + sizeof(float4x4));
+        visible = IsVisible(draw, view, proj);
+    }
+
+    WriteIndirect(draw_index, false, draw, visible);
+}
+
+// every draw is tested against the pyramid built from the early depth, the ones the early pass missed are drawn now.
+[numthreads(OCCLUSION_CULL_GROUP_SIZE, 1, 1)]
+void LateMain(uint3 a_thread_id : SV_DispatchThreadID)
+{
+    const uint draw_index = a_thread_id.x;
+    if (draw_index >= shader_indices.draw_count)
+        return;
+
+    const BB::ShaderOcclusionDraw draw = LoadDraw(draw_index);
+    const float4x4 view = LoadFloat4x4(shader_indices.draws_address);
+    const float4x4 proj = LoadFloat4x4(shader_indices.draws_address + sizeof(float4x4));
+    const bool visible = IsVisible(draw, view, proj);
+
+    const bool drawn_early = vk::RawBufferLoad<uint>(IndirectAddress(draw_index, false) + 4) != 0;
+    WriteIndirect(draw_index, true, draw, visible && !drawn_early);
+    vk::RawBufferStore<uint>(VisibilityAddress(draw_index), visible ? 1 : 0);
+}
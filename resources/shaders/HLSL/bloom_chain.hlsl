@@ -0,0 +1,35 @@
+#ifndef BLOOM_CHAIN_HLSL
+#define BLOOM_CHAIN_HLSL
+#include "common.hlsl"
+
+// the chain is a buffer so the async compute queue never touches an image the graphics queue owns.
+float3 LoadBloomTexel(const uint64_t a_address, const uint a_offset, const uint2 a_resolution, const int2 a_texel)
+{
+    const uint2 texel = uint2(clamp(a_texel, int2(0, 0), int2(a_resolution) - 1));
+    const uint index = a_offset + texel.y * a_resolution.x + texel.x;
+    const uint2 packed = vk::RawBufferLoad<uint2>(a_address + index * sizeof(uint2));
+    return float3(f16tof32(packed.x), f16tof32(packed.x >> 16), f16tof32(packed.y));
+}
+
+void StoreBloomTexel(const uint64_t a_address, const uint a_offset, const uint2 a_resolution, const uint2 a_texel, const float3 a_color)
+{
+    const uint index = a_offset + a_texel.y * a_resolution.x + a_texel.x;
+    const uint2 packed = uint2(f32tof16(a_color.r) | (f32tof16(a_color.g) << 16), f32tof16(a_color.b));
+    vk::RawBufferStore<uint2>(a_address + index * sizeof(uint2), packed);
+}
+
+// bilinear filtering with clamp to edge, a_uv is in 0-1 over the whole level.
+float3 SampleBloomLevel(const uint64_t a_address, const uint a_offset, const uint2 a_resolution, const float2 a_uv)
+{
+    const float2 pos = a_uv * float2(a_resolution) - 0.5;
+    const int2 base = int2(floor(pos));
+    const float2 t = pos - float2(base);
+
+    const float3 c00 = LoadBloomTexel(a_address, a_offset, a_resolution, base);
+    const float3 c10 = LoadBloomTexel(a_address, a_offset, a_resolution, base + int2(1, 0));
+    const float3 c01 = LoadBloomTexel(a_address, a_offset, a_resolution, base + int2(0, 1));
+    const float3 c11 = LoadBloomTexel(a_address, a_offset, a_resolution, base + int2(1, 1));
+    return lerp(lerp(c00, c10, t.x), lerp(c01, c11, t.x), t.y);
+}
+
+#endif // BLOOM_CHAIN_HLSL
@@ -31,7 +31,7 @@ _BBBIND(GLOBAL_BINDLESS_TEXTURES_BINDING, SPACE_GLOBAL)TextureCube textures_cube
 _BBBIND(PER_SCENE_SCENE_DATA_BINDING, SPACE_PER_SCENE)ConstantBuffer<BB::Scene3DInfo> scene_data;
 _BBBIND(PER_SCENE_TRANSFORM_DATA_BINDING, SPACE_PER_SCENE)ByteAddressBuffer transform_data;
 _BBBIND(PER_SCENE_LIGHT_DATA_BINDING, SPACE_PER_SCENE)ByteAddressBuffer light_data;
-_BBBIND(PER_SCENE_LIGHT_PROJECTION_VIEW_DATA_BINDING, SPACE_PER_SCENE)ByteAddressBuffer light_view_projection_data;
+_BBBIND(PER_SCENE_SHADOW_DATA_BINDING, SPACE_PER_SCENE)ByteAddressBuffer shadow_data;
 
 //PER_MATERIAL BINDINGS
 _BBBIND(PER_MATERIAL_BINDING, SPACE_PER_MATERIAL)ConstantBuffer<BB::MeshMetallic> materials_metallic[];
@@ -64,6 +64,71 @@ float4 UnpackR8B8G8A8_UNORMToFloat4(uint a_packed)
     return unpacked * sc;
 }
     
+float3 OctDecode(const float2 a_oct)
+{
+    float3 n = float3(a_oct.x, a_oct.y, 1.0 - abs(a_oct.x) - abs(a_oct.y));
+    const float t = saturate(-n.z);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+float3 GetAttributeCompressedPosition(const uint a_offset, const uint a_vertex_index)
+{
+    const BB::CompressedPositionHeader header = vertex_data.Load<BB::CompressedPositionHeader>(a_offset);
+    const uint2 packed = vertex_data.Load2(a_offset + sizeof(BB::CompressedPositionHeader) + sizeof(uint2) * a_vertex_index);
+    const float3 unorm = float3(packed.x & 0xFFFF, packed.x >> 16, packed.y & 0xFFFF) / 65535.0;
+    return header.bounds_min + unorm * header.bounds_extent;
+}
+
+// two snorm16 values
+float3 GetAttributeOctDirection(const uint a_offset, const uint a_vertex_index)
+{
+    const uint packed = vertex_data.Load(a_offset + sizeof(uint) * a_vertex_index);
+    const int2 snorm = int2(int(packed << 16) >> 16, int(packed) >> 16);
+    return OctDecode(max(float2(snorm) / 32767.0, -1.0));
+}
+
+float2 GetAttributeHalf2(const uint a_offset, const uint a_vertex_index)
+{
+    const uint packed = vertex_data.Load(a_offset + sizeof(uint) * a_vertex_index);
+    return float2(f16tof32(packed), f16tof32(packed >> 16));
+}
+
+float4 GetAttributeR8G8B8A8(const uint a_offset, const uint a_vertex_index)
+{
+    return UnpackR8B8G8A8_UNORMToFloat4(vertex_data.Load(a_offset + sizeof(uint) * a_vertex_index));
+}
+
+// a_vertex_format comes from push constants, so the branch is the same for the whole draw.
+float3 GetVertexPosition(const uint a_offset, const uint a_vertex_index, const uint a_vertex_format)
+{
+    if (a_vertex_format == VERTEX_FORMAT_COMPRESSED)
+        return GetAttributeCompressedPosition(a_offset, a_vertex_index);
+    return GetAttributeFloat3(a_offset, a_vertex_index);
+}
+
+float3 GetVertexDirection(const uint a_offset, const uint a_vertex_index, const uint a_vertex_format)
+{
+    if (a_vertex_format == VERTEX_FORMAT_COMPRESSED)
+        return GetAttributeOctDirection(a_offset, a_vertex_index);
+    return GetAttributeFloat3(a_offset, a_vertex_index);
+}
+
+float2 GetVertexUV(const uint a_offset, const uint a_vertex_index, const uint a_vertex_format)
+{
+    if (a_vertex_format == VERTEX_FORMAT_COMPRESSED)
+        return GetAttributeHalf2(a_offset, a_vertex_index);
+    return GetAttributeFloat2(a_offset, a_vertex_index);
+}
+
+float4 GetVertexColor(const uint a_offset, const uint a_vertex_index, const uint a_vertex_format)
+{
+    if (a_vertex_format == VERTEX_FORMAT_COMPRESSED)
+        return GetAttributeR8G8B8A8(a_offset, a_vertex_index);
+    return GetAttributeFloat4(a_offset, a_vertex_index);
+}
+
 float3 ReinhardToneMapping(const float3 a_hdr_color)
 {
     return a_hdr_color / (a_hdr_color + float3(1.0, 1.0, 1.0));
@@ -2,21 +2,21 @@
 #define LIGHTS_HLSL
 #include "common.hlsl"
 
-float CalculateShadowPCF_impl(const float4 a_world_pos_light, const float2 a_texture_xy, const RDescriptorIndex a_shadow_map_texture, const uint a_shadow_map_base_layer)
+// a_proj_coords is in the ndc of the shadow, the samples are clamped to its tile since the tiles around it are other shadows.
+float CalculateShadowPCF_impl(const float3 a_proj_coords, const float4 a_atlas_rect, const float2 a_texel_size, const RDescriptorIndex a_shadow_atlas)
 {
-    const float4 proj_coords = a_world_pos_light / a_world_pos_light.w;
-    const float2 texture_size = 1.0 / a_texture_xy;
-    const float current_depth = proj_coords.z;
-    if (proj_coords.z > 1.0)
-        return 0.0;
+    const float2 uv = a_atlas_rect.xy + (a_proj_coords.xy * 0.5 + 0.5) * a_atlas_rect.zw;
+    const float2 uv_min = a_atlas_rect.xy + a_texel_size * 0.5;
+    const float2 uv_max = a_atlas_rect.xy + a_atlas_rect.zw - a_texel_size * 0.5;
+    const float current_depth = a_proj_coords.z;
     
     float shadow = 0;
     for (int x = -1; x <= 1; ++x)
     {
         for (int y = -1; y <= 1; ++y)
         {
-            const float3 sample_cords = float3(proj_coords.xy + float2(x, y) * texture_size, (float)a_shadow_map_base_layer);
-            const float pcf_depth = textures_array_data[a_shadow_map_texture].Sample(shadow_map_sampler, sample_cords).r;
+            const float2 sample_uv = clamp(uv + float2(x, y) * a_texel_size, uv_min, uv_max);
+            const float pcf_depth = textures_data[a_shadow_atlas].Sample(shadow_map_sampler, sample_uv).r;
             shadow += current_depth > pcf_depth ? 1.0 : 0.0;
         }
     }
@@ -24,26 +24,43 @@ float CalculateShadowPCF_impl(const float4 a_world_pos_light, const float2 a_tex
     return shadow / 9;
 }
 
-float CalculateShadow_impl(const float4 a_world_pos_light, const RDescriptorIndex a_shadow_map_texture, const uint a_shadow_map_base_layer)
+float CalculateShadow_impl(const float3 a_proj_coords, const float4 a_atlas_rect, const float2 a_texel_size, const RDescriptorIndex a_shadow_atlas)
 {
-    const float4 proj_coords = a_world_pos_light / a_world_pos_light.w;
-    const float closest_depth = textures_array_data[a_shadow_map_texture].Sample(shadow_map_sampler, float3(proj_coords.xy, (float) a_shadow_map_base_layer)).r;
-    const float current_depth = proj_coords.z;
-    const float shadow = current_depth > closest_depth ? 1.0 : 0.0;
-    if (proj_coords.z > 1.0)
-        return 0.0;
-    
-    return shadow;
+    const float2 uv = a_atlas_rect.xy + (a_proj_coords.xy * 0.5 + 0.5) * a_atlas_rect.zw;
+    const float2 sample_uv = clamp(uv, a_atlas_rect.xy + a_texel_size * 0.5, a_atlas_rect.xy + a_atlas_rect.zw - a_texel_size * 0.5);
+    const float closest_depth = textures_data[a_shadow_atlas].Sample(shadow_map_sampler, sample_uv).r;
+    return a_proj_coords.z > closest_depth ? 1.0 : 0.0;
+}
+
+// finds the first shadow of the light that contains a_world_pos, the cascades of a directional light are sorted near to far.
+// returns 0 when no shadow contains the position.
+float CalculateLightShadow_impl(const BB::Light a_light, const float3 a_world_pos, const bool a_pcf)
+{
+    for (uint i = 0; i < a_light.shadow_count; i++)
+    {
+        const BB::ShaderShadow shadow = shadow_data.Load<BB::ShaderShadow>(sizeof(BB::ShaderShadow) * (a_light.shadow_index + i));
+        const float4 shadow_pos = mul(shadow.projection_view, float4(a_world_pos, 1.0));
+        if (shadow_pos.w <= 0.0)
+            continue;
+        const float3 proj_coords = shadow_pos.xyz / shadow_pos.w;
+        if (any(abs(proj_coords.xy) > 1.0) || proj_coords.z > 1.0)
+            continue;
+
+        if (a_pcf)
+            return CalculateShadowPCF_impl(proj_coords, shadow.atlas_rect, scene_data.shadow_atlas_texel_size, scene_data.shadow_atlas_descriptor);
+        return CalculateShadow_impl(proj_coords, shadow.atlas_rect, scene_data.shadow_atlas_texel_size, scene_data.shadow_atlas_descriptor);
+    }
+    return 0.0;
 }
 
-float CalculateShadowPCF(const float4 a_world_pos_light, const float2 a_texture_xy, const RDescriptorIndex a_shadow_map_texture, const uint a_shadow_map_base_layer)
+float CalculateLightShadow(const BB::Light a_light, const float3 a_world_pos)
 {
-    return CalculateShadowPCF_impl(a_world_pos_light, a_texture_xy, a_shadow_map_texture, a_shadow_map_base_layer);
+    return CalculateLightShadow_impl(a_light, a_world_pos, true);
 }
 
-float CalculateShadow(const float4 a_world_pos_light, const float2 a_texture_xy, const RDescriptorIndex a_shadow_map_texture, const uint a_shadow_map_base_layer)
+float CalculateLightShadowNoPCF(const BB::Light a_light, const float3 a_world_pos)
 {
-    return CalculateShadow_impl(a_world_pos_light, a_shadow_map_texture, a_shadow_map_base_layer);
+    return CalculateLightShadow_impl(a_light, a_world_pos, false);
 }
 
 //float3 CalculatePointLight_impl(const BB::Light a_light, const float3 a_normal, const float3 a_world_pos, const float3 a_view_dir, const float a_shininess)
@@ -8,24 +8,17 @@ struct VSOutput
     _BBEXT(1)float4 color : COLOR0;
     _BBEXT(2)float2 uv : UV0;
     _BBEXT(3)float3x3 TBN : POSITION1;
-    _BBEXT(6)float4 world_pos_light[8] : POSITION2;
 };
 
 _BBCONSTANT(BB::ShaderIndices) shader_indices;
 
-static const float4x4 biasMat = float4x4(
-	0.5, 0.0, 0.0, 0.5,
-	0.0, 0.5, 0.0, 0.5,
-	0.0, 0.0, 1.0, 0.0,
-	0.0, 0.0, 0.0, 1.0);
-
 VSOutput VertexMain(uint a_vertex_index : SV_VertexID)
 {
-    const float3 position = GetAttributeFloat3(shader_indices.position_offset, a_vertex_index);
-    const float3 normal = GetAttributeFloat3(shader_indices.normal_offset, a_vertex_index);
-    const float2 uv = GetAttributeFloat2(shader_indices.uv_offset, a_vertex_index);
-    const float4 color = GetAttributeFloat4(shader_indices.color_offset, a_vertex_index);
-    const float3 tangent = GetAttributeFloat3(shader_indices.tangent_offset, a_vertex_index);
+    const float3 position = GetVertexPosition(shader_indices.position_offset, a_vertex_index, shader_indices.vertex_format);
+    const float3 normal = GetVertexDirection(shader_indices.normal_offset, a_vertex_index, shader_indices.vertex_format);
+    const float2 uv = GetVertexUV(shader_indices.uv_offset, a_vertex_index, shader_indices.vertex_format);
+    const float4 color = GetVertexColor(shader_indices.color_offset, a_vertex_index, shader_indices.vertex_format);
+    const float3 tangent = GetVertexDirection(shader_indices.tangent_offset, a_vertex_index, shader_indices.vertex_format);
    
     BB::ShaderTransform transform = transform_data.Load<BB::ShaderTransform>(sizeof(BB::ShaderTransform) * shader_indices.transform_index);
     
@@ -42,12 +35,6 @@ VSOutput VertexMain(uint a_vertex_index : SV_VertexID)
     output.uv = uv;
     output.color = color;
     output.TBN = TBN;
-    
-    for (uint i = 0; i < scene_data.light_count; i++)
-    {
-        const float4x4 projview = light_view_projection_data.Load<float4x4>(sizeof(float4x4) * i);
-        output.world_pos_light[i] = mul(biasMat, mul(projview, mul(transform.transform, float4(position, 1.0))));
-    }
     return output;
 }
 
@@ -89,7 +76,7 @@ PixelOutput FragmentMain(VSOutput a_input)
         const float3 L = normalize(light.pos.xyz - a_input.world_pos);
 
         const float3 light_color = PBRCalculateLight(light, L, V, N, albedo, f0, orm_data, a_input.world_pos);
-        const float shadow = CalculateShadowPCF(a_input.world_pos_light[i], scene_data.shadow_map_resolution, scene_data.shadow_map_array_descriptor, i);
+        const float shadow = CalculateLightShadow(light, a_input.world_pos);
         
         lo += (1.0 - shadow) * (light_color);
     }
@@ -23,10 +23,13 @@ namespace BB
 #define PER_SCENE_SCENE_DATA_BINDING 0
 #define PER_SCENE_TRANSFORM_DATA_BINDING 1
 #define PER_SCENE_LIGHT_DATA_BINDING 2
-#define PER_SCENE_LIGHT_PROJECTION_VIEW_DATA_BINDING 3
+#define PER_SCENE_SHADOW_DATA_BINDING 3
 
 #define PER_MATERIAL_BINDING 0
 
+#define VERTEX_FORMAT_FLOAT 0
+#define VERTEX_FORMAT_COMPRESSED 1
+
 #define CUBEMAP_BACK    0
 #define CUBEMAP_BOTTOM  1
 #define CUBEMAP_FRONT   2
@@ -34,6 +37,15 @@ namespace BB
 #define CUBEMAP_RIGHT   4
 #define CUBEMAP_TOP     5
 
+#define HIZ_BUILD_GROUP_SIZE 8
+#define BLOOM_GROUP_SIZE 8
+// the bloom chain stops before a level gets smaller than this, or at the max level count.
+#define BLOOM_MIN_RESOLUTION 8
+#define BLOOM_MAX_LEVELS 6
+#define OCCLUSION_CULL_GROUP_SIZE 64
+// the visibility and indirect arguments are sized for this many draws, more draws skip occlusion culling.
+#define OCCLUSION_CULL_MAX_DRAWS 16384
+
     struct Vertex2D
     {
         float2 position;
@@ -41,6 +53,15 @@ namespace BB
         uint color;
     };
 
+    // start of a compressed position stream, the positions are 16 bit unorm inside these bounds.
+    struct CompressedPositionHeader
+    {
+        float3 bounds_min;    // 12
+        float pad0;           // 16
+        float3 bounds_extent; // 28
+        float pad1;           // 32
+    };
+
     struct ALIGN_STRUCT(16) GlobalRenderData
     {
         float2 mouse_pos;           // 8
@@ -62,13 +83,13 @@ namespace BB
         float4 ambient_light;            // 144
 
         uint2 scene_resolution;          // 152
-        float2 shadow_map_resolution;    // 160
+        float2 shadow_atlas_texel_size;  // 160
 
         float3 view_pos;                 // 172
         float exposure;                  // 176
 
-        uint shadow_map_count;           // 180
-        RDescriptorIndex shadow_map_array_descriptor; // 184
+        uint shadow_count;               // 180
+        RDescriptorIndex shadow_atlas_descriptor; // 184
         uint light_count;                // 188
         RDescriptorIndex skybox_texture; // 192
         float near_plane;                // 196
@@ -110,6 +131,17 @@ namespace BB
         float radius_quadratic;     // 48
 
         uint light_type;            // 64
+
+        uint shadow_index;          // 68 first ShaderShadow of the light
+        uint shadow_count;          // 72 0 when the light casts no shadow
+        float2 pad0;                // 80
+    };
+
+    // a tile of the shadow atlas, a directional light has one for every cascade.
+    struct ShaderShadow
+    {
+        float4x4 projection_view;   // 64
+        float4 atlas_rect;          // 80 xy = uv offset of the tile, zw = uv size
     };
 
     struct ShaderTransform
@@ -129,7 +161,7 @@ namespace BB
 
         uint transform_index;            // 24
         RDescriptorIndex material_index; // 28
-        float pad0;                      // 32
+        uint vertex_format;              // 32
     };
 
     struct ShaderIndices2D
@@ -145,19 +177,37 @@ namespace BB
     {
         uint position_offset;             // 4
         uint transform_index;             // 8
-        uint light_projection_view_index; // 12
-        uint pad0;                        // 16
+        uint shadow_index;                // 12
+        uint vertex_format;               // 16
         uint4 pad1;                       // 32
     };
 
-    struct ShaderGaussianBlur
+    struct ShaderBloom
+    {
+        uint64_t bloom_address;         // 8  every level of the chain, a texel is a half4 packed in a uint2
+        uint2 src_resolution;           // 16
+        uint2 dst_resolution;           // 24
+        uint src;                       // 28 texel offset of the source level, the bright texture for the prefilter
+        uint dst_offset;                // 32 texel offset of the destination level
+    };
+
+    struct ShaderBloomComposite
+    {
+        uint64_t bloom_address;         // 8
+        uint2 resolution;               // 16 of the first level
+        float strength;                 // 20
+        uint pad0;                      // 24
+        uint2 pad1;                     // 32
+    };
+
+    // samples the rendered part of a larger image up to the whole render target.
+    struct ShaderUpscale
     {
-        RDescriptorIndex src_texture; // 4
-        uint horizontal_enable;       // 8
-        uint2 src_resolution;         // 16
-        float blur_strength;          // 20
-        float blur_scale;             // 24
-        float2 pad0;                  // 32
+        float2 uv_scale;                // 8  rendered size / source size
+        float2 source_size;             // 16 in texels
+        RDescriptorIndex source;        // 20
+        uint pad0;                      // 24
+        uint2 pad1;                     // 32
     };
 
     struct ShaderLine
@@ -168,11 +218,58 @@ namespace BB
         uint4 pad1;
     };
 
+    // the hi-z levels are packed one after the other as floats, every level is half the size of the previous one rounded up.
+    struct ShaderHiZBuild
+    {
+        uint64_t hiz_address;           // 8
+        uint2 src_resolution;           // 16
+        uint2 dst_resolution;           // 24
+        uint src_offset;                // 28 in floats, unused for the first level
+        RDescriptorIndex depth_texture; // 32 only set for the first level, that one reads the depth buffer
+    };
+
+    struct ShaderOcclusionCull
+    {
+        uint64_t draws_address;         // 8  a ShaderOcclusionCullHeader followed by the ShaderOcclusionDraws
+        uint64_t cull_address;          // 16 the visibility of every draw followed by the early and late ShaderDrawIndexedIndirect
+        uint64_t hiz_address;           // 24 0 when there is no pyramid to test against
+        uint draw_count;                // 28
+        uint hiz_resolution;            // 32 first level, x in the low 16 bits and y in the high 16 bits
+    };
+
+    struct ShaderOcclusionCullHeader
+    {
+        float4x4 view;                  // 64
+        float4x4 proj;                  // 128
+    };
+
+    struct ShaderOcclusionDraw
+    {
+        float3 bounds_min;              // 12 world space
+        uint first_index;               // 16
+        float3 bounds_max;              // 28
+        uint index_count;               // 32
+    };
+
+    // matches VkDrawIndexedIndirectCommand
+    struct ShaderDrawIndexedIndirect
+    {
+        uint index_count;
+        uint instance_count;
+        uint first_index;
+        int vertex_offset;
+        uint first_instance;
+    };
+
 #ifndef __HLSL_VERSION // C++ version
     static_assert(
         sizeof(ShaderIndices) == sizeof(ShaderIndices2D) &&
         sizeof(ShaderIndices) == sizeof(ShaderIndicesShadowMapping) &&
-        sizeof(ShaderIndices) == sizeof(ShaderGaussianBlur) &&
-        sizeof(ShaderIndices) == sizeof(ShaderLine));
+        sizeof(ShaderIndices) == sizeof(ShaderBloom) &&
+        sizeof(ShaderIndices) == sizeof(ShaderBloomComposite) &&
+        sizeof(ShaderIndices) == sizeof(ShaderUpscale) &&
+        sizeof(ShaderIndices) == sizeof(ShaderLine) &&
+        sizeof(ShaderIndices) == sizeof(ShaderHiZBuild) &&
+        sizeof(ShaderIndices) == sizeof(ShaderOcclusionCull));
 #endif // __HLSL_VERSION
 }
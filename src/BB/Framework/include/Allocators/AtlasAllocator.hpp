@@ -0,0 +1,56 @@
+#pragma once
+#include "Common.h"
+
+namespace BB
+{
+	struct AtlasAllocation
+	{
+		uint2 offset = uint2(0, 0);
+		uint32_t size = 0;
+		uint32_t node = UINT32_MAX;
+
+		bool IsValid() const { return node != UINT32_MAX; }
+	};
+
+	struct AtlasAllocatorReport
+	{
+		uint64_t used_area;
+		uint32_t largest_free;
+		uint32_t allocation_count;
+	};
+
+	// quadtree packer for square power of 2 tiles inside a square atlas, like shadow maps in a shadow atlas.
+	// a tile is a quadtree node, allocating splits nodes down to the tile size and freeing merges 4 free siblings back into their parent.
+	// the nodes are stored implicitly level by level, so the tree is fixed size and never allocates after Init.
+	class AtlasAllocator
+	{
+	public:
+		// a_atlas_size and a_min_tile_size must be powers of 2, the tree has a level for every size in between.
+		void Init(struct MemoryArena& a_arena, const uint32_t a_atlas_size, const uint32_t a_min_tile_size);
+		void Reset();
+
+		// a_size is rounded up to a power of 2 and at least the min tile size.
+		// returns an invalid allocation when no free tile is large enough.
+		AtlasAllocation Allocate(const uint32_t a_size);
+		void Free(const AtlasAllocation a_allocation);
+
+		AtlasAllocatorReport GetReport() const;
+		uint32_t GetAtlasSize() const { return m_atlas_size; }
+		uint32_t GetMinTileSize() const { return m_min_tile_size; }
+
+	private:
+		uint32_t LevelFirstNode(const uint32_t a_level) const;
+		uint32_t NodeLevel(const uint32_t a_node) const;
+		void UpdateParents(uint32_t a_node, uint32_t a_level);
+
+		uint32_t m_atlas_size;
+		uint32_t m_min_tile_size;
+		uint32_t m_level_count;
+		uint32_t m_node_count;
+		uint32_t m_allocation_count;
+		uint64_t m_used_area;
+
+		// the largest free tile inside the node, 0 when the node is used or full.
+		uint32_t* m_largest_free;
+	};
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Common.h"
+
+namespace BB
+{
+	// different tag, file, line and owner combinations that can be told apart, more then this all count as one overflow site.
+	constexpr uint32_t MEMORY_ACCOUNTING_MAX_SITES = 1024;
+	constexpr uint32_t MEMORY_ACCOUNTING_OVERFLOW_SITE = MEMORY_ACCOUNTING_MAX_SITES;
+	// threads with their own counters, more then this share one set of counters.
+	constexpr uint32_t MEMORY_ACCOUNTING_MAX_THREADS = 64;
+
+	// where memory comes from. owner is what it is allocated from, for a MemoryArena the place it was created.
+	// the owner has to stay the same for short lived allocators, every new owner takes new sites.
+	// the strings are not copied, they need to live as long as the program like string literals and __FILE__.
+	struct MemoryAccountingSite
+	{
+		const void* owner;
+		const char* tag_name;	// nullptr for untagged memory.
+		const char* file;
+		int line;
+		// where the owner was made, only for showing. Sites with the same owner have the same owner file and line.
+		const char* owner_file;	// nullptr when unknown.
+		int owner_line;
+	};
+
+	struct MemoryAccountingCounters
+	{
+		int64_t current_bytes;
+		int64_t current_count;
+		uint64_t total_bytes;	// never goes down, the difference between two snapshots is the churn in between.
+		uint64_t total_count;
+	};
+
+	// the counters of every thread added together, indexed by site.
+	struct MemoryAccountingSnapshot
+	{
+		uint32_t site_count;	// sites that existed when the snapshot was taken, sites only get added.
+		MemoryAccountingCounters sites[MEMORY_ACCOUNTING_MAX_SITES + 1];
+	};
+
+	// finds or adds the site, the index stays valid for the whole program. Lock free, but adding waits for sites that are added at the same time.
+	uint32_t MemoryAccountingGetSiteIndex(const MemoryAccountingSite& a_site);
+	const MemoryAccountingSite& MemoryAccountingGetSite(const uint32_t a_site_index);
+
+	// counting only touches the counters of the calling thread, a free does not need to be on the thread that allocated.
+	void MemoryAccountingAlloc(const uint32_t a_site_index, const size_t a_size);
+	void MemoryAccountingFree(const uint32_t a_site_index, const size_t a_size);
+	void MemoryAccountingResize(const uint32_t a_site_index, const size_t a_old_size, const size_t a_new_size);
+	// moves a live allocation to another site, for memory that gets tagged after it is allocated.
+	// only the current counters move, the totals stay with the site that allocated it.
+	void MemoryAccountingMove(const uint32_t a_from_site_index, const uint32_t a_to_site_index, const size_t a_size);
+
+	// counting continues while the snapshot is taken, every counter is exact but they can be from slightly different moments.
+	void MemoryAccountingTakeSnapshot(MemoryAccountingSnapshot& a_snapshot);
+}
@@ -1,9 +1,10 @@
 #pragma once
 #include "Common.h"
+#include <source_location>
 
 namespace BB
 {
-#define _DEBUG_MEMORY
+// _DEBUG_MEMORY comes from the DEBUG_MEMORY_ENABLE cmake option, it logs every allocation with the file, line and tag.
 #define _DEBUG_POISON_MEMORY_BOUNDRY
 
 #ifdef _DEBUG_MEMORY
@@ -19,10 +20,14 @@ namespace BB
 #define BB_ARENA_DEBUG_SEND
 #define BB_ARENA_DEBUG_FREE
 #endif //_DEBUG_MEMORY
+// with _DEBUG_MEMORY every allocation is also counted in MemoryAccounting by tag, file and line.
 
 	constexpr size_t ARENA_DEFAULT_RESERVE(gbSize * 16);					//16 gb
 	constexpr size_t ARENA_DEFAULT_COMMIT(kbSize * 16);						//16 kb
 	constexpr size_t ARENA_DEFAULT_COMMITTED_SIZE = ARENA_DEFAULT_COMMIT;	//16 kb
+	constexpr size_t ARENA_MAX_COMMIT_STEP(mbSize * 16);					//commits grow with the committed size up to 16 mb at once
+	constexpr uint32_t ARENA_DECAY_RESET_COUNT = 64;						//full resets before memory above their peak is decommitted
+	constexpr size_t ARENA_DECAY_MIN_SIZE(kbSize * 256);					//don't bother decommitting less then this
 
 	struct MemoryArenaAllocationInfo
 	{
@@ -35,6 +40,17 @@ namespace BB
 		uint32_t alignment;				//40
 		size_t alloc_size;				//48
 		const char* tag_name;			//56
+		uint32_t accounting_site;		//60
+	};
+
+	// always on, these are a few counters next to the bump pointer.
+	struct MemoryArenaStats
+	{
+		size_t high_water_mark;				// most memory that was ever in use at once.
+		uint32_t commit_count;				// how often the commit range had to grow.
+		uint32_t allocation_count;			// allocations since the last MemoryArenaStatsNextFrame.
+		uint32_t allocations_last_frame;
+		uint32_t decommit_count;			// how often unused memory was given back after ARENA_DECAY_RESET_COUNT resets.
 	};
 
 	struct MemoryArena
@@ -45,10 +61,19 @@ namespace BB
 		void* at;
 
 		bool owns_memory;
+		MemoryArenaStats stats;
+
+		size_t reset_peak;			// most memory used since the last reset to the start of the arena.
+		size_t decay_peak;			// most memory used over the last decay_reset_count resets.
+		uint32_t decay_reset_count;
 
 #ifdef _DEBUG_MEMORY
 		MemoryArenaAllocationInfo* first;
 		MemoryArenaAllocationInfo* last;
+		// where the arena was created, the memory accounting owner. Unlike the buffer it stays the same for arenas that are made again and again.
+		const void* accounting_owner;
+		const char* create_file;
+		int create_line;
 #endif // _DEBUG_MEMORY
 	};
 
@@ -72,14 +97,20 @@ namespace BB
 		void* m_at;
 	};
 
-	MemoryArena MemoryArenaCreate(const size_t a_reserve_size = ARENA_DEFAULT_RESERVE);
-	MemoryArena MemoryArenaCreate(MemoryArena& a_memory_source, const size_t a_memory_size);
+	//a_huge_pages asks for transparent huge pages, worth it for arenas that hold big transient loads.
+	//a_caller is only used with _DEBUG_MEMORY, the memory profiler shows it for the arena.
+	MemoryArena MemoryArenaCreate(const size_t a_reserve_size = ARENA_DEFAULT_RESERVE, const bool a_huge_pages = false, const std::source_location a_caller = std::source_location::current());
+	MemoryArena MemoryArenaCreate(MemoryArena& a_memory_source, const size_t a_memory_size, const std::source_location a_caller = std::source_location::current());
 	void MemoryArenaFree(MemoryArena& a_arena);
 	void MemoryArenaReset(MemoryArena& a_arena);
 
 	void TagMemory(const MemoryArena& a_arena, void* a_memory_tag, const char* a_tag_name);
 
+	//Always nullptr without _DEBUG_MEMORY.
 	const MemoryArenaAllocationInfo* MemoryArenaGetFrontAllocationLog(const MemoryArena& a_arena);
+	const MemoryArenaStats& MemoryArenaGetStats(const MemoryArena& a_arena);
+	//Moves the allocation count to allocations_last_frame, call it once a frame on arenas you want to watch.
+	void MemoryArenaStatsNextFrame(MemoryArena& a_arena);
 	size_t MemoryArenaSizeRemaining(const MemoryArena& a_arena);
 	size_t MemoryArenaSizeCommited(const MemoryArena& a_arena);
 	size_t MemoryArenaSizeUsed(const MemoryArena& a_arena);
@@ -104,8 +135,8 @@ namespace BB
 #define ArenaAllocType(a_arena, a_type) new (BB::ArenaAlloc_f(BB_ARENA_DEBUG_ARGS a_arena, sizeof(a_type), alignof(a_type))) a_type
 #define ArenaAllocTypeNoZero(a_arena, a_type) new (BB::ArenaAllocNoZero_f(BB_ARENA_DEBUG_ARGS a_arena, sizeof(a_type), alignof(a_type))) a_type
 
-#define ArenaAllocArr(a_arena, a_type, a_count) reinterpret_cast<a_type*>(BB::ArenaAlloc_f(BB_ARENA_DEBUG_ARGS a_arena, sizeof(a_type) * a_count, alignof(a_type)))
-#define ArenaAllocArrNoZero(a_arena, a_memory_size, a_align) reinterpret_cast<a_type*>(BB::ArenaAllocNoZero_f(BB_ARENA_DEBUG_ARGS a_arena, sizeof(a_type) * a_count, alignof(a_type)))
+#define ArenaAllocArr(a_arena, a_type, a_count) reinterpret_cast<a_type*>(BB::ArenaAlloc_f(BB_ARENA_DEBUG_ARGS a_arena, sizeof(a_type) * (a_count), alignof(a_type)))
+#define ArenaAllocArrNoZero(a_arena, a_type, a_count) reinterpret_cast<a_type*>(BB::ArenaAllocNoZero_f(BB_ARENA_DEBUG_ARGS a_arena, sizeof(a_type) * (a_count), alignof(a_type)))
 
 #define ArenaRealloc(a_arena, a_ptr, a_ptr_size, a_memory_size, a_align) BB::ArenaRealloc_f(BB_ARENA_DEBUG_ARGS a_arena, a_ptr, a_ptr_size, a_memory_size, a_align)
 #define ArenaReallocNoZero(a_arena, a_ptr, a_ptr_size, a_memory_size, a_align) BB::ArenaReallocNoZero_f(BB_ARENA_DEBUG_ARGS a_arena, a_ptr, a_ptr_size, a_memory_size, a_align)
@@ -27,4 +27,57 @@ namespace BB
 		FreeBlock* m_free_blocks;
 		size_t m_memory_size;
 	};
+
+	struct TLSFStats
+	{
+		size_t used_size;			// payload of every live allocation, headers not included.
+		size_t free_size;			// payload of every free block.
+		size_t largest_free_block;	// the largest allocation that can still succeed with 16 byte alignment.
+		size_t allocation_count;
+		size_t free_block_count;
+	};
+
+	// Two level segregated fit, alloc and free are O(1) and free merges with both neighbours right away.
+	// The memory given to Initialize also holds the free list table, so around 8kb of it is not usable.
+	// Alloc and Realloc return nullptr when the pool is out of memory.
+	struct TLSFInterface
+	{
+		operator Allocator();
+
+		void Initialize(MemoryArena& a_arena, size_t a_memory_size);
+		void Initialize(void* a_memory, size_t a_memory_size);
+		void* Alloc(size_t a_size, size_t a_alignment);
+		// Grows or shrinks in place when it can, otherwise moves. a_alignment has to match the one a_ptr was allocated with.
+		// A nullptr a_ptr allocates and a size of 0 frees, like realloc. On failure a_ptr stays valid and nullptr is returned.
+		void* Realloc(void* a_ptr, size_t a_size, size_t a_alignment);
+		void Free(const void* a_ptr);
+		void Clear();
+
+		// Walks the free lists, not for every frame.
+		TLSFStats GetStats() const;
+		size_t GetAllocationSize(const void* a_ptr) const;
+
+		struct Block
+		{
+			Block* prev_physical;
+			size_t size;	// payload size, bit 0 is set when the block is free.
+			// only valid while the block is free, they overlap the payload.
+			Block* next_free;
+			Block* prev_free;
+		};
+		struct Control;
+
+	private:
+		void InsertFreeBlock(Block* a_block);
+		void RemoveFreeBlock(Block* a_block);
+		Block* FindFreeBlock(size_t a_size);
+		// splits off the end of a used block if it is large enough to be a block, the end is freed.
+		void TrimUsedBlock(Block* a_block, size_t a_size);
+
+		uint8_t* m_start = nullptr;
+		Control* m_control;
+		size_t m_memory_size;
+		size_t m_used_size;
+		size_t m_allocation_count;
+	};
 }
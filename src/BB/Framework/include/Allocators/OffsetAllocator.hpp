@@ -0,0 +1,76 @@
+#pragma once
+#include "Common.h"
+
+namespace BB
+{
+	constexpr uint32_t OFFSET_ALLOCATOR_BIN_COUNT = 256;
+
+	struct OffsetAllocation
+	{
+		uint32_t offset = UINT32_MAX;
+		uint32_t node = UINT32_MAX;
+
+		bool IsValid() const { return node != UINT32_MAX; }
+	};
+
+	struct OffsetAllocatorReport
+	{
+		uint32_t total_free;
+		uint32_t largest_free;
+		uint32_t allocation_count;
+		uint32_t free_region_count;
+	};
+
+	// TLSF style allocator that only hands out offsets, the memory it manages lives somewhere else like a gpu buffer.
+	// free regions are kept in 256 size class bins with a two level bitmask, allocate and free are O(1).
+	// neighbouring free regions are merged on free.
+	class OffsetAllocator
+	{
+	public:
+		// a_max_nodes limits the allocations + free regions, every allocation can at most split off one free region.
+		void Init(struct MemoryArena& a_arena, const uint32_t a_size, const uint32_t a_max_nodes);
+		void Reset();
+
+		// returns an invalid allocation when there is no free region large enough.
+		OffsetAllocation Allocate(const uint32_t a_size);
+		void Free(const OffsetAllocation a_allocation);
+
+		// allocates the same size as a_allocation in the lowest free region that fits below it, otherwise returns an invalid allocation.
+		// used to compact the allocator, move the data and then free a_allocation. Walks every region below a_allocation.
+		OffsetAllocation AllocateLower(const OffsetAllocation a_allocation);
+
+		uint32_t GetAllocationSize(const OffsetAllocation a_allocation) const;
+		OffsetAllocatorReport GetReport() const;
+		uint32_t GetSize() const { return m_size; }
+
+	private:
+		struct Node
+		{
+			uint32_t offset;
+			uint32_t size;
+			uint32_t bin_prev;
+			uint32_t bin_next;
+			uint32_t neighbour_prev;
+			uint32_t neighbour_next;
+			bool used;
+		};
+
+		OffsetAllocation AllocateFromFreeNode(const uint32_t a_node, const uint32_t a_size);
+		uint32_t InsertFreeNode(const uint32_t a_offset, const uint32_t a_size);
+		void RemoveFreeNode(const uint32_t a_node);
+
+		uint32_t m_size;
+		uint32_t m_max_nodes;
+		uint32_t m_free_storage;
+		uint32_t m_allocation_count;
+
+		uint32_t m_used_bins_top;
+		uint8_t m_used_bins[OFFSET_ALLOCATOR_BIN_COUNT / 8];
+		uint32_t m_bin_heads[OFFSET_ALLOCATOR_BIN_COUNT];
+
+		Node* m_nodes;
+		// stack of unused node indices
+		uint32_t* m_free_nodes;
+		uint32_t m_free_node_count;
+	};
+}
@@ -33,14 +33,14 @@ namespace BB
 	};
 
 	//A simple ring allocator that allocates until it reaches it's maximum, then it overwrites previous elements at the start again. Careful when using this.
-	//A ring allocator that uses virtual alloc to get it's own memory.
+	//A ring allocator that gets it's own mirrored memory, an allocation that crosses the end continues at the start so nothing is skipped.
 	class LocalRingAllocator
 	{
 	public:
 		operator Allocator();
 
-		//Just giving it a size will use virtual_alloc
-		//a_size must be a value above 0, but it will return the actual page aligned size of the allocator.
+		//a_size must be a value above 0, but it will return the actual size of the allocator, a multiple of the OS allocation granularity.
+		//allocations can be up to that size.
 		LocalRingAllocator(size_t& a_size);
 		~LocalRingAllocator();
 
@@ -53,8 +53,8 @@ namespace BB
 		void* Alloc(size_t a_size, size_t a_alignment);
 
 	private:
-		void* m_BufferPos;
+		void* m_buffer;
 		size_t m_size;
-		size_t m_Used;
+		size_t m_position;
 	};
 }
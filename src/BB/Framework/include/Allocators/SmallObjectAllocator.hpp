@@ -0,0 +1,57 @@
+#pragma once
+#include "Common.h"
+#include "MemoryArena.hpp"
+
+namespace BB
+{
+	constexpr size_t SMALL_OBJECT_MAX_SIZE = 1024;
+	constexpr uint32_t SMALL_OBJECT_CLASS_COUNT = 20;
+	// threads that use the allocator at the same time, a thread gives its slot back when it exits.
+	constexpr uint32_t SMALL_OBJECT_MAX_THREADS = 64;
+
+	struct SmallObjectAllocatorStats
+	{
+		uint32_t span_count;
+		size_t object_count;		// every object cut out of a span so far, live or free.
+		size_t depot_object_count;	// objects in the central depot, not counting what threads hold in their cache.
+	};
+
+	// size class allocator for objects up to SMALL_OBJECT_MAX_SIZE, every alloc and free is thread safe.
+	// every thread allocates from and frees into its own cache without locking, a cache that runs dry or holds too much
+	// moves a batch of objects from or to the depot of that size class. Freeing on another thread then the allocating one is the same cost.
+	// memory is only handed back to the OS on Destroy.
+	class SmallObjectAllocator
+	{
+	public:
+		operator Allocator();
+
+		void Init(const size_t a_reserve_size = gbSize);
+		void Destroy();
+
+		// alignment is at most 16, returns nullptr if a_size is larger then SMALL_OBJECT_MAX_SIZE.
+		void* Alloc(const size_t a_size, const size_t a_alignment = 16);
+		void Free(const void* a_ptr);
+		// moves everything the calling thread holds in its cache to the depots.
+		void FlushThreadCache();
+
+		SmallObjectAllocatorStats GetStats();
+		static size_t GetAllocationSize(const void* a_ptr);
+
+		struct SizeClass;
+		struct ThreadCache;
+
+	private:
+		void* RefillCache(const uint32_t a_class, ThreadCache& a_cache);
+		void ReleaseBatch(const uint32_t a_class, ThreadCache& a_cache);
+		void* AllocateSpan(const uint32_t a_class);
+
+		MemoryArena m_arena;
+		BBRWLock m_span_lock;
+		uint8_t* m_span_chunk_pos;
+		uint8_t* m_span_chunk_end;
+		uint32_t m_span_count;
+
+		SizeClass* m_classes;
+		ThreadCache* m_caches;
+	};
+}
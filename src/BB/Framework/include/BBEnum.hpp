@@ -1,6 +1,7 @@
 #pragma once
 
-#define BB_CREATE_ENUM_CLASS_HELPER_(name, value) name = value,
+// the entry lists always pass extra arguments, msvc drops them without complaining but gcc and clang need the ...
+#define BB_CREATE_ENUM_CLASS_HELPER_(name, value, ...) name = value,
 #define BB_CREATE_ENUM_CLASS_(ENUM_NAME, ENUM_TYPE, ENTRIES) \
 enum class ENUM_NAME : ENUM_TYPE \
 { \
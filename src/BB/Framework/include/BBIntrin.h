@@ -1,5 +1,9 @@
 #pragma once
+#ifdef _MSC_VER
 #include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif // _MSC_VER
 #include <Utils.h>
 
 #ifdef __clang__
@@ -9,6 +13,7 @@
 
 namespace BB
 {
+#ifdef _MSC_VER
 	static inline uint32_t BBInterlockedIncrement32(volatile uint32_t* a_value)
 	{
 		return _InterlockedIncrement(reinterpret_cast<volatile long*>(a_value));
@@ -23,6 +28,23 @@ namespace BB
 	{
 		return _InterlockedIncrement64(reinterpret_cast<volatile long long*>(a_value));
 	}
+#else
+	// same as the msvc interlocked functions, full barrier and they return the new value (exchange returns the old one).
+	static inline uint32_t BBInterlockedIncrement32(volatile uint32_t* a_value)
+	{
+		return __atomic_add_fetch(a_value, 1u, __ATOMIC_SEQ_CST);
+	}
+
+	static inline long BBInterlockedExchange32(volatile uint32_t* a_value, const uint32_t a_exc_value)
+	{
+		return static_cast<long>(__atomic_exchange_n(a_value, a_exc_value, __ATOMIC_SEQ_CST));
+	}
+
+	static inline uint64_t BBInterlockedIncrement64(volatile uint64_t* a_value)
+	{
+		return __atomic_add_fetch(a_value, uint64_t(1), __ATOMIC_SEQ_CST);
+	}
+#endif // _MSC_VER
 
 #define BB_USE_SIMD
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.h"
+#include "Utils/StringAtom.hpp"
 
 namespace BB
 {
@@ -12,6 +13,10 @@ namespace BB
 
 		const uint32_t logger_buffer_storage = DEFAULT_LOGGER_BUFFER_STORAGE_SIZE;
 		const WarningTypeFlags logger_enabled_warning_flags = WARNING_TYPES_ALL;
+
+		const uint32_t string_atom_max = STRING_ATOM_DEFAULT_MAX;
+		const size_t string_atom_memory = STRING_ATOM_DEFAULT_STRING_MEMORY;
+		const uint32_t string_atom_transient_max = STRING_ATOM_DEFAULT_TRANSIENT_MAX;
 	};
 
 	void InitBB(const BBInitInfo& a_BBInfo);
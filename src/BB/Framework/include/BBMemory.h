@@ -12,11 +12,19 @@
 
 namespace BB
 {
+#ifdef _LINUX
+//alloca wrapper, does not require a free call.
+#define BBstackAlloc(a_count, a_type) reinterpret_cast<a_type*>(alloca(a_count * sizeof(a_type)))
+//glibc has no _malloca, it is always the stack. BBstackFree_s does nothing.
+#define BBstackAlloc_s(a_count, a_type) reinterpret_cast<a_type*>(alloca(a_count * sizeof(a_type)))
+#define BBstackFree_s(a_ptr) (void)(a_ptr)
+#else
 //_alloca wrapper, does not require a free call.
 #define BBstackAlloc(a_count, a_type) reinterpret_cast<a_type*>(_alloca(a_count * sizeof(a_type)))
 //_malloca wrapper, be sure to call BBstackFree_s
 #define BBstackAlloc_s(a_count, a_type) reinterpret_cast<a_type*>(_malloca(a_count * sizeof(a_type)))
 #define BBstackFree_s(a_ptr) _freea(a_ptr)
+#endif //_LINUX
 
 #define BBalloc(a_allocator, a_size) BB::BBalloc_f(BB_MEMORY_DEBUG_ARGS a_allocator, a_size, sizeof(size_t))
 #define BBnew(a_allocator, a_type) new (BB::BBalloc_f(BB_MEMORY_DEBUG_ARGS a_allocator, sizeof(a_type), __alignof(a_type))) a_type
@@ -72,7 +80,7 @@ namespace BB
 	inline void BBfree_f(Allocator a_allocator, T* a_ptr)
 	{
 		BB_ASSERT(a_ptr != nullptr, "Trying to free a nullptr");
-		if constexpr (!std::is_trivially_destructible<T>::value)
+		if constexpr (!std::is_void_v<T> && !std::is_trivially_destructible<T>::value)
 		{
 			BB_WARNINGS_OFF // turn off warnings here due to CLANG thinking this will destruct a type void, which it won't due to is_trivially_destructible
 			a_ptr->~T();
@@ -29,6 +29,8 @@ namespace BB
 
 		ThreadTask StartTaskThread(void(*a_function)(MemoryArena& a_thread_arena, void*), void* a_func_parameter, const size_t a_func_parameter_size, const wchar_t* a_task_name = L"no task name");
 		ThreadTask StartTaskThread(void(*a_function)(MemoryArena& a_thread_arena, void*), const wchar_t* a_task_name = L"no task name");
+		// same as StartTaskThread but returns an invalid ThreadTask when all threads are busy, thread safe.
+		ThreadTask TryStartTaskThread(void(*a_function)(MemoryArena& a_thread_arena, void*), void* a_func_parameter, const size_t a_func_parameter_size, const wchar_t* a_task_name = L"no task name");
 
 		void WaitForTask(const ThreadTask a_handle);
 		bool TaskFinished(const ThreadTask a_handle);
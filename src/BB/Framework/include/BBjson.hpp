@@ -3,6 +3,7 @@
 #include "BBMemory.h"
 #include "Storage/Hashmap.h"
 #include "Storage/BBString.h"
+#include "OS/Program.h"
 
 //tutorial/guide used: https://kishoreganesh.com/post/writing-a-json-parser-in-cplusplus/
 namespace BB
@@ -100,7 +101,7 @@ namespace BB
 	class JsonParser
 	{
 	public:
-		//load from disk
+		//load from disk, the file is mapped and parsed in place.
 		JsonParser(const char* a_path);
 		//load from memory
 		JsonParser(const Buffer& a_Buffer);
@@ -122,6 +123,7 @@ namespace BB
 		JsonNode* PraseSingleToken(const Token& a_token);
 		MemoryArena m_arena;
 		JsonFile m_json_file;
+		OSMappedFile m_mapped_file{ nullptr, 0 };
 
 		JsonNode* m_RootNode = nullptr;
 	};
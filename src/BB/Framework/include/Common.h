@@ -33,8 +33,23 @@ namespace BB
 
 #define BB_WARNINGS_OFF			BB_PRAGMA(warning(push, 0))
 #define BB_WARNINGS_ON			BB_PRAGMA(warning(pop, 0))
+#elif __GNUC__
+#define BB_PAD(n) unsigned char BB_CONCAT(_padding_, __LINE__)[n]
+
+#define BB_NO_RETURN			__attribute__((noreturn))
+
+#define BB_WARNINGS_OFF			BB_PRAGMA(GCC diagnostic push) \
+								BB_PRAGMA(GCC diagnostic ignored "-Wall") \
+								BB_PRAGMA(GCC diagnostic ignored "-Wextra") \
+								BB_PRAGMA(GCC diagnostic ignored "-Wpedantic")
+
+#define BB_WARNINGS_ON			BB_PRAGMA(GCC diagnostic pop)
 #endif
 
+#ifndef _WIN32
+#define _countof(a_array) (sizeof(a_array) / sizeof((a_array)[0]))
+#endif // _WIN32
+
 	// logger info 
 	using WarningTypeFlags = unsigned int;
 	enum class WarningType : WarningTypeFlags
@@ -364,36 +379,26 @@ namespace BB
 	{
 		float3x3()
 		{
-			r0 = {};
-			r1 = {};
-			r2 = {};
+			r[0] = {};
+			r[1] = {};
+			r[2] = {};
 		}
 		float e[3][3];
-		struct
-		{
-			float3 r0;
-			float3 r1;
-			float3 r2;
-		};
+		// not an anonymous struct of rows, gcc and clang do not allow members with constructors in those.
+		float3 r[3];
 	};
 
 	union float4x4
 	{
 		float4x4()
 		{
-			r0 = {};
-			r1 = {};
-			r2 = {};
-			r3 = {};
+			r[0] = {};
+			r[1] = {};
+			r[2] = {};
+			r[3] = {};
 		}
 		float e[4][4];
-		struct
-		{
-			float4 r0;
-			float4 r1;
-			float4 r2;
-			float4 r3;
-		};
+		float4 r[4];
 		VecFloat4 vec[4];
 	};
 }
@@ -0,0 +1,64 @@
+#pragma once
+#include "Common.h"
+#include "Storage/CountingRingBuffer.hpp"
+
+namespace BB
+{
+	struct MemoryArena;
+
+	struct DynamicResolutionCreateInfo
+	{
+		// in miliseconds.
+		float target_frame_time;
+		float min_scale;
+		float max_scale;
+		// frames at the same scale that are averaged before the scale changes again.
+		uint32_t window_size;
+	};
+
+	struct DynamicResolutionState
+	{
+		float scale;
+		double cpu_average;
+		double gpu_average;
+		uint32_t scale_changes;
+	};
+
+	// picks the render scale of the next frame from the cpu and gpu times of the frames before it.
+	// the gpu time is assumed to grow with the pixel count, so scale^2. the gpu may use the time the cpu takes anyway, a cpu bound frame does not get faster at a lower scale.
+	// drops quickly and grows slowly, with a band in between where it stays, so noise does not make it flip between 2 scales.
+	class DynamicResolution
+	{
+	public:
+		void Init(MemoryArena& a_arena, const DynamicResolutionCreateInfo& a_create_info);
+
+		// call once for every finished frame, returns the scale to render the next frame at.
+		float Update(const double a_cpu_frame_time, const double a_gpu_frame_time);
+		// starts over at a_scale, like after a resize or when it was turned off.
+		void Reset(const float a_scale);
+		void SetTargetFrameTime(const float a_target_frame_time);
+
+		float GetScale() const { return m_scale; }
+		float GetTargetFrameTime() const { return m_target_frame_time; }
+		// a_max_resolution scaled and rounded, never 0.
+		uint2 GetScaledResolution(const uint2 a_max_resolution) const;
+		DynamicResolutionState GetState() const;
+
+		const CountingRingBuffer& GetCPUHistory() const { return m_cpu_history; }
+		const CountingRingBuffer& GetGPUHistory() const { return m_gpu_history; }
+
+	private:
+		void SetScale(const float a_scale);
+
+		float m_target_frame_time;
+		float m_min_scale;
+		float m_max_scale;
+		float m_scale;
+		uint32_t m_window_size;
+		uint32_t m_scale_changes;
+
+		// only the frames since the last scale change.
+		CountingRingBuffer m_cpu_history;
+		CountingRingBuffer m_gpu_history;
+	};
+}
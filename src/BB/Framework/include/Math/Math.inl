@@ -134,9 +134,9 @@ namespace BB
 	static inline float3 operator*(const float3x3 a_mat, const float3 a_vec)
 	{
 		float3 vec;
-		vec.x = a_vec.x * a_mat.r0.x + a_vec.y * a_mat.r1.x + a_vec.z * a_mat.r2.x;
-		vec.y = a_vec.x * a_mat.r0.y + a_vec.y * a_mat.r1.y + a_vec.z * a_mat.r2.y;
-		vec.z = a_vec.x * a_mat.r0.z + a_vec.y * a_mat.r1.z + a_vec.z * a_mat.r2.z;
+		vec.x = a_vec.x * a_mat.r[0].x + a_vec.y * a_mat.r[1].x + a_vec.z * a_mat.r[2].x;
+		vec.y = a_vec.x * a_mat.r[0].y + a_vec.y * a_mat.r[1].y + a_vec.z * a_mat.r[2].y;
+		vec.z = a_vec.x * a_mat.r[0].z + a_vec.y * a_mat.r[1].z + a_vec.z * a_mat.r[2].z;
 		return vec;
 	}
 
@@ -192,6 +192,16 @@ namespace BB
 		return a * rcp_length;
 	}
 
+	static inline float3 Float3Min(const float3 a_lhs, const float3 a_rhs)
+	{
+		return float3(fminf(a_lhs.x, a_rhs.x), fminf(a_lhs.y, a_rhs.y), fminf(a_lhs.z, a_rhs.z));
+	}
+
+	static inline float3 Float3Max(const float3 a_lhs, const float3 a_rhs)
+	{
+		return float3(fmaxf(a_lhs.x, a_rhs.x), fmaxf(a_lhs.y, a_rhs.y), fmaxf(a_lhs.z, a_rhs.z));
+	}
+
     static inline float3 Float3RotatePoint(const float3x3& a_rotation_matrix, const float3 a_point, const float3 a_middle)
     {
         const float3 res = a_rotation_matrix * (a_point - a_middle);
@@ -240,20 +250,20 @@ namespace BB
 	static inline float4 operator*(const float4x4 a_mat, const float4 a_vec)
 	{
 		float4 vec;
-		vec.x = a_vec.x * a_mat.r0.x + a_vec.y * a_mat.r1.x + a_vec.z * a_mat.r2.x + a_vec.w * a_mat.r3.x;
-		vec.y = a_vec.x * a_mat.r0.y + a_vec.y * a_mat.r1.y + a_vec.z * a_mat.r2.y + a_vec.w * a_mat.r3.y;
-		vec.z = a_vec.x * a_mat.r0.z + a_vec.y * a_mat.r1.z + a_vec.z * a_mat.r2.z + a_vec.w * a_mat.r3.z;
-		vec.w = a_vec.x * a_mat.r0.w + a_vec.y * a_mat.r1.w + a_vec.z * a_mat.r2.w + a_vec.w * a_mat.r3.w;
+		vec.x = a_vec.x * a_mat.r[0].x + a_vec.y * a_mat.r[1].x + a_vec.z * a_mat.r[2].x + a_vec.w * a_mat.r[3].x;
+		vec.y = a_vec.x * a_mat.r[0].y + a_vec.y * a_mat.r[1].y + a_vec.z * a_mat.r[2].y + a_vec.w * a_mat.r[3].y;
+		vec.z = a_vec.x * a_mat.r[0].z + a_vec.y * a_mat.r[1].z + a_vec.z * a_mat.r[2].z + a_vec.w * a_mat.r[3].z;
+		vec.w = a_vec.x * a_mat.r[0].w + a_vec.y * a_mat.r[1].w + a_vec.z * a_mat.r[2].w + a_vec.w * a_mat.r[3].w;
 		return vec;
 	}
 
     static inline float4 operator*(const float4 a_vec, const float4x4 a_mat)
     {
         float4 vec;
-        vec.x = a_vec.x * a_mat.r0.x + a_vec.y * a_mat.r0.y + a_vec.z * a_mat.r0.z + a_vec.w * a_mat.r0.w;
-        vec.y = a_vec.x * a_mat.r1.x + a_vec.y * a_mat.r1.y + a_vec.z * a_mat.r1.z + a_vec.w * a_mat.r1.w;
-        vec.z = a_vec.x * a_mat.r2.x + a_vec.y * a_mat.r2.y + a_vec.z * a_mat.r2.z + a_vec.w * a_mat.r2.w;
-        vec.w = a_vec.x * a_mat.r3.x + a_vec.y * a_mat.r3.y + a_vec.z * a_mat.r3.z + a_vec.w * a_mat.r3.w;
+        vec.x = a_vec.x * a_mat.r[0].x + a_vec.y * a_mat.r[0].y + a_vec.z * a_mat.r[0].z + a_vec.w * a_mat.r[0].w;
+        vec.y = a_vec.x * a_mat.r[1].x + a_vec.y * a_mat.r[1].y + a_vec.z * a_mat.r[1].z + a_vec.w * a_mat.r[1].w;
+        vec.z = a_vec.x * a_mat.r[2].x + a_vec.y * a_mat.r[2].y + a_vec.z * a_mat.r[2].z + a_vec.w * a_mat.r[2].w;
+        vec.w = a_vec.x * a_mat.r[3].x + a_vec.y * a_mat.r[3].y + a_vec.z * a_mat.r[3].z + a_vec.w * a_mat.r[3].w;
         return vec;
     }
 
@@ -343,9 +353,9 @@ namespace BB
 	static inline float3x3 operator*(const float3x3& a_lhs, const float3x3& a_rhs)
 	{
 		float3x3 mat;
-		mat.r0 = a_lhs.r0 * a_rhs.r0.x + a_lhs.r1 * a_rhs.r0.y + a_lhs.r2 * a_rhs.r0.z;
-		mat.r1 = a_lhs.r0 * a_rhs.r1.x + a_lhs.r1 * a_rhs.r1.y + a_lhs.r2 * a_rhs.r1.z;
-		mat.r2 = a_lhs.r0 * a_rhs.r2.x + a_lhs.r1 * a_rhs.r2.y + a_lhs.r2 * a_rhs.r2.z;
+		mat.r[0] = a_lhs.r[0] * a_rhs.r[0].x + a_lhs.r[1] * a_rhs.r[0].y + a_lhs.r[2] * a_rhs.r[0].z;
+		mat.r[1] = a_lhs.r[0] * a_rhs.r[1].x + a_lhs.r[1] * a_rhs.r[1].y + a_lhs.r[2] * a_rhs.r[1].z;
+		mat.r[2] = a_lhs.r[0] * a_rhs.r[2].x + a_lhs.r[1] * a_rhs.r[2].y + a_lhs.r[2] * a_rhs.r[2].z;
 		return mat;
 	}
 
@@ -485,20 +495,20 @@ namespace BB
 	static inline float4x4 operator*(const float4x4& a_lhs, const float4x4& a_rhs)
 	{
 		float4x4 mat;
-		mat.r0 = a_lhs.r0 * a_rhs.r0.x + a_lhs.r1 * a_rhs.r0.y + a_lhs.r2 * a_rhs.r0.z + a_lhs.r3 * a_rhs.r0.w;
-		mat.r1 = a_lhs.r0 * a_rhs.r1.x + a_lhs.r1 * a_rhs.r1.y + a_lhs.r2 * a_rhs.r1.z + a_lhs.r3 * a_rhs.r1.w;
-		mat.r2 = a_lhs.r0 * a_rhs.r2.x + a_lhs.r1 * a_rhs.r2.y + a_lhs.r2 * a_rhs.r2.z + a_lhs.r3 * a_rhs.r2.w;
-		mat.r3 = a_lhs.r0 * a_rhs.r3.x + a_lhs.r1 * a_rhs.r3.y + a_lhs.r2 * a_rhs.r3.z + a_lhs.r3 * a_rhs.r3.w;
+		mat.r[0] = a_lhs.r[0] * a_rhs.r[0].x + a_lhs.r[1] * a_rhs.r[0].y + a_lhs.r[2] * a_rhs.r[0].z + a_lhs.r[3] * a_rhs.r[0].w;
+		mat.r[1] = a_lhs.r[0] * a_rhs.r[1].x + a_lhs.r[1] * a_rhs.r[1].y + a_lhs.r[2] * a_rhs.r[1].z + a_lhs.r[3] * a_rhs.r[1].w;
+		mat.r[2] = a_lhs.r[0] * a_rhs.r[2].x + a_lhs.r[1] * a_rhs.r[2].y + a_lhs.r[2] * a_rhs.r[2].z + a_lhs.r[3] * a_rhs.r[2].w;
+		mat.r[3] = a_lhs.r[0] * a_rhs.r[3].x + a_lhs.r[1] * a_rhs.r[3].y + a_lhs.r[2] * a_rhs.r[3].z + a_lhs.r[3] * a_rhs.r[3].w;
 		return mat;
 	}
 
 	static inline float4x4 operator*(const float4x4& a_lhs, const float3x3& a_rhs)
 	{
 		return Float4x4FromFloats(
-			a_lhs.r0.x * a_rhs.r0.x, a_lhs.r0.y * a_rhs.r0.y, a_lhs.r0.z * a_rhs.r0.z, a_lhs.r0.w,
-			a_lhs.r1.x * a_rhs.r1.x, a_lhs.r1.y * a_rhs.r1.y, a_lhs.r1.z * a_rhs.r1.z, a_lhs.r1.w,
-			a_lhs.r2.x * a_rhs.r2.x, a_lhs.r2.y * a_rhs.r2.y, a_lhs.r2.z * a_rhs.r2.z, a_lhs.r2.w,
-			a_lhs.r3.x, a_lhs.r3.y, a_lhs.r3.z, a_lhs.r3.w);
+			a_lhs.r[0].x * a_rhs.r[0].x, a_lhs.r[0].y * a_rhs.r[0].y, a_lhs.r[0].z * a_rhs.r[0].z, a_lhs.r[0].w,
+			a_lhs.r[1].x * a_rhs.r[1].x, a_lhs.r[1].y * a_rhs.r[1].y, a_lhs.r[1].z * a_rhs.r[1].z, a_lhs.r[1].w,
+			a_lhs.r[2].x * a_rhs.r[2].x, a_lhs.r[2].y * a_rhs.r[2].y, a_lhs.r[2].z * a_rhs.r[2].z, a_lhs.r[2].w,
+			a_lhs.r[3].x, a_lhs.r[3].y, a_lhs.r[3].z, a_lhs.r[3].w);
 	}
 
 	static inline float4x4 Float4x4Identity()
@@ -514,9 +524,9 @@ namespace BB
 	static inline float4x4 Float4x4FromTranslation(const float3 translation)
 	{
 		float4x4 result = Float4x4Identity();
-		result.r3.x = translation.x;
-		result.r3.y = translation.y;
-		result.r3.z = translation.z;
+		result.r[3].x = translation.x;
+		result.r[3].y = translation.y;
+		result.r[3].z = translation.z;
 		return result;
 	}
 
@@ -571,10 +581,10 @@ namespace BB
 	static inline float4x4 Float4x4Scale(const float4x4& m, const float3 s)
 	{
 		float4x4 mat;
-		mat.r0 = m.r0 * s.x;
-		mat.r1 = m.r1 * s.y;
-		mat.r2 = m.r2 * s.z;
-		mat.r3 = m.r3;
+		mat.r[0] = m.r[0] * s.x;
+		mat.r[1] = m.r[1] * s.y;
+		mat.r[2] = m.r[2] * s.z;
+		mat.r[3] = m.r[3];
 		return mat;
 	}
 
@@ -616,19 +626,19 @@ namespace BB
 		const float3 up = Float3Normalize(Float3Cross(right, forward));
 
 		float4x4 mat;
-        mat.r0 = float4(right.x, right.y, right.z, -Float3Dot(right, a_eye));
-        mat.r1 = float4(up.x, up.y, up.z, -Float3Dot(up, a_eye));
-        mat.r2 = float4(-forward.x, -forward.y, -forward.z, Float3Dot(forward, a_eye));
-        mat.r3 = float4(0.f, 0.f, 0.f, 1.f);
+        mat.r[0] = float4(right.x, right.y, right.z, -Float3Dot(right, a_eye));
+        mat.r[1] = float4(up.x, up.y, up.z, -Float3Dot(up, a_eye));
+        mat.r[2] = float4(-forward.x, -forward.y, -forward.z, Float3Dot(forward, a_eye));
+        mat.r[3] = float4(0.f, 0.f, 0.f, 1.f);
 
 		return mat;
 	}
 
     static inline void Float4x4ExtractView(const float4x4& a_view, float3& a_right, float3& a_up, float3& a_forward)
     {
-        a_right = float3(a_view.r0.x, a_view.r0.y, a_view.r0.z);
-        a_up = float3(a_view.r1.x, a_view.r1.y, a_view.r1.z);
-        a_forward = float3(-a_view.r2.x, -a_view.r2.y, -a_view.r2.z);
+        a_right = float3(a_view.r[0].x, a_view.r[0].y, a_view.r[0].z);
+        a_up = float3(a_view.r[1].x, a_view.r[1].y, a_view.r[1].z);
+        a_forward = float3(-a_view.r[2].x, -a_view.r[2].y, -a_view.r[2].z);
     }
 
 	static inline float4x4 Float4x4Inverse(const float4x4& m)
@@ -669,7 +679,7 @@ namespace BB
 
 	static inline float3 Float4x4ExtractTranslation(const float4x4& a_transform)
 	{
-		return float3(a_transform.r3.x, a_transform.r3.y, a_transform.r3.z);
+		return float3(a_transform.r[3].x, a_transform.r[3].y, a_transform.r[3].z);
 	}
 
 	static inline float3x3 Float3x3ExtractRotationFromFloat4x4(const float4x4& a_transform, const float3 a_scale)
@@ -683,9 +693,9 @@ namespace BB
 	static inline float3 Float4x4ExtractScale(const float4x4& a_transform)
 	{
 		return float3(
-			Float3Length(float3(a_transform.r0.x, a_transform.r1.x, a_transform.r2.x)),
-			Float3Length(float3(a_transform.r0.y, a_transform.r1.y, a_transform.r2.y)),
-			Float3Length(float3(a_transform.r0.z, a_transform.r1.z, a_transform.r2.z)));
+			Float3Length(float3(a_transform.r[0].x, a_transform.r[1].x, a_transform.r[2].x)),
+			Float3Length(float3(a_transform.r[0].y, a_transform.r[1].y, a_transform.r[2].y)),
+			Float3Length(float3(a_transform.r[0].z, a_transform.r[1].z, a_transform.r[2].z)));
 	}
 
 	static inline float4x4 Float4x4ExtractRotationAsFloat4x4(const float4x4& a_transform, const float3 a_scale)
@@ -0,0 +1,50 @@
+#pragma once
+#include "Common.h"
+#include "Slice.h"
+
+namespace BB
+{
+	struct MemoryArena;
+
+	constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+	constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+	// a cone_cutoff above 1 never culls, used when the triangles of a meshlet face too many directions.
+	constexpr float MESHLET_CONE_DISABLED = 2.f;
+
+	// a cluster of triangles that are next to each other, the triangles are a range inside the index buffer.
+	struct Meshlet
+	{
+		uint32_t index_start;
+		uint32_t index_count;
+
+		float3 center;
+		float radius;
+
+		// all triangles face away from the viewer when dot(normalize(cone_apex - view_position), cone_axis) >= cone_cutoff
+		float3 cone_apex;
+		float3 cone_axis;
+		float cone_cutoff;
+	};
+
+	struct MeshletDrawRange
+	{
+		uint32_t index_start;
+		uint32_t index_count;
+	};
+
+	// world space frustum planes, xyz is the normal pointing inside and w the distance.
+	struct MeshletCullView
+	{
+		float4 frustum_planes[6];
+		float3 view_position;
+	};
+
+	// reorders a_indices so that every meshlet is a contiguous range, index_start is relative to the start of a_indices.
+	// disable a_cone_culling for double sided geometry.
+	Slice<Meshlet> BuildMeshlets(MemoryArena& a_arena, const ConstSlice<float3> a_positions, const Slice<uint32_t> a_indices, const bool a_cone_culling);
+
+	MeshletCullView CreateMeshletCullView(const float4x4& a_view, const float4x4& a_projection, const float3 a_view_position);
+	bool IsMeshletVisible(const Meshlet& a_meshlet, const float4x4& a_world, const float a_world_scale, const bool a_cone_culling, const MeshletCullView& a_view);
+	// writes the visible meshlets as index ranges, neighbouring meshlets are merged. a_out_ranges needs space for a_meshlets.size() ranges.
+	uint32_t CullMeshlets(const ConstSlice<Meshlet> a_meshlets, const float4x4& a_world, const MeshletCullView& a_view, MeshletDrawRange* a_out_ranges);
+}
@@ -23,6 +23,7 @@ namespace BB
 	typedef void (*PFN_WindowMoveEvent)(const WindowHandle a_window_handle, const uint32_t a_X, const uint32_t a_Y);
 
 	using OSThreadHandle = FrameworkHandle<struct ThreadHandletag>;
+	using OSAsyncRead = FrameworkHandle<struct OSAsyncReadTag>;
 
 	enum class OS_WINDOW_STYLE
 	{
@@ -37,10 +38,10 @@ namespace BB
 		BEGIN = 0,
 		CURRENT = 1,
 		END = 2
-#elif _LINUX //Need to test for linux
-		//BEGIN = 0,
-		//CURRENT = 1,
-		//END = 2
+#elif _LINUX
+		BEGIN = 0,		// SEEK_SET
+		CURRENT = 1,	// SEEK_CUR
+		END = 2			// SEEK_END
 #endif
 	};
 
@@ -61,6 +62,8 @@ namespace BB
 	bool CommitVirtualMemory(void* a_ptr, const size_t a_size);
 	bool DecommitVirtualMemory(void* a_ptr, const size_t a_size);
 	bool ReleaseVirtualMemory(void* a_ptr);
+	//Asks the OS to back the range with huge pages when it can, returns false if the OS has no transparent huge pages.
+	bool AdviseHugePages(void* a_ptr, const size_t a_size);
 
 	//Prints the latest OS error and returns the error code, if it has no error code it returns 0.
 	uint32_t LatestOSError();
@@ -108,10 +111,66 @@ namespace BB
 	bool OSOpenFolder(const StringView a_directory, MemoryArenaTemp a_temp_arena);
 
 	bool CloseOSFile(const OSFileHandle a_file_handle);
+	//Reads from a_offset without moving the file position, returns the bytes read. Less then a_size only at the end of the file or on failure.
+	size_t OSReadFileAt(const OSFileHandle a_file_handle, void* a_memory, const size_t a_size, const uint64_t a_offset);
+
+	enum class OS_ASYNC_READ_STATUS : uint32_t
+	{
+		PENDING,
+		DONE,
+		FAILED,
+		CANCELLED
+	};
+
+	struct OSAsyncReadInfo
+	{
+		OSFileHandle file;
+		uint64_t file_offset;
+		void* buffer;
+		size_t size;
+	};
+
+	//Async reads run on io_uring on linux when the kernel allows it, otherwise on a few io threads.
+	//Submits all reads or none, returns false when there are not enough free read slots.
+	//Every handle has to be finished with OSWaitAsyncRead or an OSPollAsyncRead that returns something else then PENDING, the handle is invalid after.
+	bool OSSubmitAsyncReads(const OSAsyncReadInfo* a_reads, const uint32_t a_read_count, OSAsyncRead* a_out_reads);
+	OS_ASYNC_READ_STATUS OSPollAsyncRead(const OSAsyncRead a_read, size_t* a_bytes_read = nullptr);
+	OS_ASYNC_READ_STATUS OSWaitAsyncRead(const OSAsyncRead a_read, size_t* a_bytes_read = nullptr);
+	//A read that already started can still finish, it still needs a wait.
+	void OSCancelAsyncRead(const OSAsyncRead a_read);
+	//Reads into registered memory skip pinning the pages on every read. Only works when no async reads are in flight.
+	bool OSRegisterAsyncReadBuffer(void* a_memory, const size_t a_size);
+
+	enum class OS_MAP_HINT : uint32_t
+	{
+		NONE,
+		SEQUENTIAL,	// read front to back once, pages behind the reader can be dropped early.
+		WILL_NEED	// the whole file is used soon, start reading it in now.
+	};
+
+	struct OSMappedFile
+	{
+		const void* data;
+		size_t size;
+
+		bool IsValid() const { return data != nullptr; }
+	};
+
+	//Maps the whole file read only, the memory stays valid after the file is deleted or closed until OSUnmapFile.
+	//Returns an invalid mapping if the file does not exist or is empty.
+	OSMappedFile OSMapFile(const char* a_path, const OS_MAP_HINT a_hint = OS_MAP_HINT::NONE);
+	void OSUnmapFile(const OSMappedFile& a_mapped_file);
+
+	//Maps the same memory twice back to back, so a write that runs past the end of the first half lands at the start.
+	//a_size is rounded up to the allocation granularity and returned, the returned range is 2 * a_size long. Returns nullptr on failure.
+	void* OSCreateMirroredMemory(size_t& a_size);
+	bool OSFreeMirroredMemory(void* a_ptr, const size_t a_size);
 
 	OSThreadHandle OSCreateThread(void(*a_func)(void*), const unsigned int a_stack_size, void* a_arg_list);
 	bool OSWaitThreadfinish(const OSThreadHandle a_thread);
 	bool OSSetThreadName(const wchar_t* a_wstr);
+	//Bit N of a_core_mask allows the thread to run on logical core N.
+	bool OSSetThreadAffinity(const OSThreadHandle a_thread, const uint64_t a_core_mask);
 
 	BBMutex OSCreateMutex();
 	bool OSWaitAndLockMutex(const BBMutex a_mutex);
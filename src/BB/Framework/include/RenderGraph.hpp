@@ -0,0 +1,123 @@
+#pragma once
+#include "Common.h"
+#include "Slice.h"
+#include "Storage/Array.h"
+
+namespace BB
+{
+	struct MemoryArena;
+
+	// states are owned by the user of the graph, the graph only compares them. 0 means the content is undefined.
+	constexpr uint32_t RENDER_GRAPH_STATE_UNDEFINED = 0;
+	constexpr uint32_t RENDER_GRAPH_INVALID_PASS = UINT32_MAX;
+
+	using RGResource = FrameworkHandle32Bit<struct RGResourceTag>;
+	using RGPass = FrameworkHandle32Bit<struct RGPassTag>;
+
+	enum class RENDER_GRAPH_ACCESS : uint32_t
+	{
+		READ,		// reads the content written before
+		WRITE,		// reads and writes, the content written before is kept
+		OVERWRITE	// writes everything, the content written before is not needed
+	};
+
+	struct RenderGraphBarrier
+	{
+		RGResource resource;
+		uint32_t prev_state;
+		uint32_t next_state;
+		// first use of memory that an earlier transient resource used, the earlier work on that memory must be finished.
+		bool aliased;
+	};
+
+	struct RenderGraphPassPlan
+	{
+		RGPass pass;
+		// the barriers before the pass, all of them can be issued in one batch.
+		uint32_t barrier_start;
+		uint32_t barrier_count;
+	};
+
+	struct RenderGraphResourcePlan
+	{
+		// only valid for transient resources that are used by a pass that runs.
+		uint64_t heap_offset;
+		uint32_t first_pass;	// index into RenderGraphPlan::passes, RENDER_GRAPH_INVALID_PASS when no running pass uses it
+		uint32_t last_pass;
+		uint32_t final_state;
+	};
+
+	struct RenderGraphPlan
+	{
+		// the passes that run in the order they must be recorded.
+		ConstSlice<RenderGraphPassPlan> passes;
+		ConstSlice<RenderGraphBarrier> barriers;
+		// indexed by RGResource
+		ConstSlice<RenderGraphResourcePlan> resources;
+		// the memory all the transient resources share.
+		uint64_t transient_heap_size;
+		// what the heap would be if every transient resource had its own memory.
+		uint64_t transient_unaliased_size;
+		uint32_t culled_pass_count;
+	};
+
+	// passes declare what they read and write, Compile orders them, removes passes that nothing needs,
+	// creates the barriers between them and places the transient resources in shared memory.
+	// everything here runs on the cpu only, the user turns the plan into real resources and barriers.
+	class RenderGraph
+	{
+	public:
+		void Init(MemoryArena& a_arena, const uint32_t a_max_passes, const uint32_t a_max_resources, const uint32_t a_max_accesses);
+		void Reset();
+
+		// a_size and a_alignment are the memory requirements, the resource only lives between its first and last use.
+		RGResource CreateTransient(const char* a_name, const uint64_t a_size, const uint64_t a_alignment);
+		// a resource that lives outside of the graph, a_state is the state it is in before the graph starts.
+		// passes that write to it are never culled.
+		RGResource Import(const char* a_name, const uint32_t a_state);
+
+		// passes are recorded in the order they are added. a_has_side_effects keeps the pass even if nothing reads what it writes.
+		RGPass AddPass(const char* a_name, const bool a_has_side_effects = false);
+		void Read(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state);
+		void Write(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state);
+		void Overwrite(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state);
+
+		RenderGraphPlan Compile(MemoryArena& a_arena) const;
+
+		const char* GetPassName(const RGPass a_pass) const { return m_passes[a_pass.handle].name; }
+		const char* GetResourceName(const RGResource a_resource) const { return m_resources[a_resource.handle].name; }
+		uint32_t GetPassCount() const { return m_passes.size(); }
+		uint32_t GetResourceCount() const { return m_resources.size(); }
+
+	private:
+		void AddAccess(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state, const RENDER_GRAPH_ACCESS a_access);
+
+		struct Resource
+		{
+			const char* name;
+			uint64_t size;
+			uint64_t alignment;
+			uint32_t import_state;
+			bool imported;
+		};
+
+		struct Pass
+		{
+			const char* name;
+			uint32_t access_start;
+			uint32_t access_count;
+			bool has_side_effects;
+		};
+
+		struct Access
+		{
+			RGResource resource;
+			uint32_t state;
+			RENDER_GRAPH_ACCESS access;
+		};
+
+		StaticArray<Resource> m_resources;
+		StaticArray<Pass> m_passes;
+		StaticArray<Access> m_accesses;
+	};
+}
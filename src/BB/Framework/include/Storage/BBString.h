@@ -435,7 +435,7 @@ namespace BB
 		// this function will recalculate how big the string is.
 		void RecalculateStringSize()
 		{
-			m_size = strnlen_s(m_string, STRING_SIZE);
+			m_size = strnlen(m_string, STRING_SIZE);
 		}	
 
 		size_t find_first_of(const CharT a_char) const
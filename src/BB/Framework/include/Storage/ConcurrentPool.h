@@ -0,0 +1,258 @@
+#pragma once
+#include "Utils/Logger.h"
+#include "Allocators/MemoryArena.hpp"
+#include "OS/Program.h"
+
+#include <atomic>
+
+namespace BB
+{
+	/// <summary>
+	/// Lock free stack of indices, the free list that the concurrent pools share.
+	/// The head holds a tag next to the index that changes on every push and pop, so a pop that read an old head fails its CAS (no ABA).
+	/// The links are kept in their own array, objects are never read or written by the free list.
+	/// </summary>
+	class ConcurrentIndexFreelist
+	{
+	public:
+		static constexpr uint32_t EMPTY = UINT32_MAX;
+
+		void Init(std::atomic<uint32_t>* a_next)
+		{
+			m_next = a_next;
+			m_head.store(MakeHead(0, EMPTY), std::memory_order_relaxed);
+		}
+
+		// returns EMPTY if there is nothing to pop.
+		uint32_t Pop()
+		{
+			uint64_t head = m_head.load(std::memory_order_acquire);
+			while (true)
+			{
+				const uint32_t index = HeadIndex(head);
+				if (index == EMPTY)
+					return EMPTY;
+				// another thread can pop and push index in between, then the tag is different and the CAS fails.
+				const uint32_t next = m_next[index].load(std::memory_order_relaxed);
+				if (m_head.compare_exchange_weak(head, MakeHead(HeadTag(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire))
+					return index;
+			}
+		}
+
+		void Push(const uint32_t a_index)
+		{
+			PushChain(a_index, a_index);
+		}
+
+		// pushes a list that is already linked from a_first to a_last in one go.
+		void PushChain(const uint32_t a_first, const uint32_t a_last)
+		{
+			uint64_t head = m_head.load(std::memory_order_relaxed);
+			do
+			{
+				m_next[a_last].store(HeadIndex(head), std::memory_order_relaxed);
+			} while (!m_head.compare_exchange_weak(head, MakeHead(HeadTag(head) + 1, a_first), std::memory_order_release, std::memory_order_relaxed));
+		}
+
+	private:
+		static uint64_t MakeHead(const uint32_t a_tag, const uint32_t a_index) { return (static_cast<uint64_t>(a_tag) << 32) | a_index; }
+		static uint32_t HeadIndex(const uint64_t a_head) { return static_cast<uint32_t>(a_head); }
+		static uint32_t HeadTag(const uint64_t a_head) { return static_cast<uint32_t>(a_head >> 32); }
+
+		std::atomic<uint64_t> m_head;
+		std::atomic<uint32_t>* m_next;
+	};
+
+	/// <summary>
+	/// Thread safe version of Pool, Get and Free can be called from any thread without a lock.
+	/// Unlike Pool the objects can be smaller then a pointer, the free list costs 4 bytes per object on the side.
+	/// </summary>
+	template<typename T>
+	class ConcurrentPool
+	{
+	public:
+		void CreatePool(MemoryArena& a_arena, const size_t a_size)
+		{
+			BB_ASSERT(m_start == nullptr, "Trying to create a pool while one already exists!");
+			BB_ASSERT(a_size > 0 && a_size < ConcurrentIndexFreelist::EMPTY, "ConcurrentPool size must fit in 32 bits");
+
+			m_start = reinterpret_cast<T*>(ArenaAlloc(a_arena, a_size * sizeof(T), alignof(T)));
+			m_capacity = static_cast<uint32_t>(a_size);
+			std::atomic<uint32_t>* next = ArenaAllocArr(a_arena, std::atomic<uint32_t>, a_size);
+			for (uint32_t i = 0; i < m_capacity - 1; i++)
+				next[i].store(i + 1, std::memory_order_relaxed);
+
+			m_freelist.Init(next);
+			m_freelist.PushChain(0, m_capacity - 1);
+		}
+
+		/// <summary>
+		/// Get an object from the pool, returns nullptr if the pool is empty.
+		/// </summary>
+		T* Get()
+		{
+			const uint32_t index = m_freelist.Pop();
+			if (index == ConcurrentIndexFreelist::EMPTY)
+			{
+				BB_WARNING(false, "Trying to get an pool object while there are none left!", WarningType::HIGH);
+				return nullptr;
+			}
+			return &m_start[index];
+		}
+
+		/// <summary>
+		/// Return an object to the pool.
+		/// </summary>
+		void Free(T* a_ptr)
+		{
+			m_freelist.Push(IndexOf(a_ptr));
+		}
+
+		uint32_t IndexOf(const T* a_ptr) const
+		{
+			BB_ASSERT(a_ptr >= m_start && a_ptr < m_start + m_capacity, "Pool object is not part of this pool!");
+			return static_cast<uint32_t>(a_ptr - m_start);
+		}
+
+		T& At(const uint32_t a_index) const
+		{
+			BB_ASSERT(a_index < m_capacity, "Pool index out of bounds");
+			return m_start[a_index];
+		}
+
+		uint32_t Capacity() const { return m_capacity; }
+
+	private:
+		T* m_start = nullptr;
+		uint32_t m_capacity = 0;
+		ConcurrentIndexFreelist m_freelist;
+	};
+
+	/// <summary>
+	/// Thread safe version of GrowPool. Reserves virtual memory for a_max_size objects and commits more when it runs out.
+	/// Get and Free are lock free, only the thread that grows the pool takes a lock while the others wait for it.
+	/// Objects never move, pointers stay valid until DestroyPool.
+	/// </summary>
+	template<typename T>
+	class ConcurrentGrowPool
+	{
+	public:
+		ConcurrentGrowPool() {};
+#ifdef _DEBUG
+		~ConcurrentGrowPool()
+		{
+			BB_ASSERT(m_start == nullptr, "Memory pool was not destroyed before it went out of scope!");
+		}
+#endif //_DEBUG
+
+		//just delete these for safety, copies might cause errors.
+		ConcurrentGrowPool(const ConcurrentGrowPool&) = delete;
+		ConcurrentGrowPool(const ConcurrentGrowPool&&) = delete;
+		ConcurrentGrowPool& operator =(const ConcurrentGrowPool&) = delete;
+		ConcurrentGrowPool& operator =(ConcurrentGrowPool&&) = delete;
+
+		void CreatePool(const size_t a_size, const size_t a_max_size = 1024 * 1024);
+		void DestroyPool();
+
+		/// <summary>
+		/// Get an object from the pool, grows the pool when it is empty. Returns nullptr only when a_max_size is reached.
+		/// </summary>
+		T* Get();
+		/// <summary>
+		/// Return an object to the pool.
+		/// </summary>
+		void Free(T* a_ptr);
+
+		uint32_t Capacity() const { return m_capacity.load(std::memory_order_relaxed); }
+
+	private:
+		// commits a_grow_count more objects unless another thread already grew the pool past a_seen_capacity.
+		bool Grow(const uint32_t a_seen_capacity, const uint32_t a_grow_count);
+
+		T* m_start = nullptr;
+		std::atomic<uint32_t>* m_next = nullptr;
+		std::atomic<uint32_t> m_capacity;
+		uint32_t m_max_capacity;
+		BBRWLock m_grow_lock;
+		ConcurrentIndexFreelist m_freelist;
+	};
+
+	template<typename T>
+	inline void ConcurrentGrowPool<T>::CreatePool(const size_t a_size, const size_t a_max_size)
+	{
+		BB_ASSERT(m_start == nullptr, "Trying to create a pool while one already exists!");
+		BB_ASSERT(a_size > 0 && a_size <= a_max_size && a_max_size < ConcurrentIndexFreelist::EMPTY, "ConcurrentGrowPool sizes must fit in 32 bits");
+
+		m_start = reinterpret_cast<T*>(ReserveVirtualMemory(a_max_size * sizeof(T)));
+		m_next = reinterpret_cast<std::atomic<uint32_t>*>(ReserveVirtualMemory(a_max_size * sizeof(std::atomic<uint32_t>)));
+		m_max_capacity = static_cast<uint32_t>(a_max_size);
+		m_capacity.store(0, std::memory_order_relaxed);
+		m_grow_lock = OSCreateRWLock();
+		m_freelist.Init(m_next);
+		Grow(0, static_cast<uint32_t>(a_size));
+	}
+
+	template<typename T>
+	inline void ConcurrentGrowPool<T>::DestroyPool()
+	{
+		ReleaseVirtualMemory(m_start);
+		ReleaseVirtualMemory(m_next);
+		m_start = nullptr;
+		m_next = nullptr;
+		m_capacity.store(0, std::memory_order_relaxed);
+	}
+
+	template<typename T>
+	inline T* ConcurrentGrowPool<T>::Get()
+	{
+		while (true)
+		{
+			const uint32_t capacity = Capacity();
+			const uint32_t index = m_freelist.Pop();
+			if (index != ConcurrentIndexFreelist::EMPTY)
+				return &m_start[index];
+
+			// double, at least a page worth of objects.
+			const uint32_t grow_count = static_cast<uint32_t>(Max(static_cast<size_t>(capacity), Max(OSPageSize() / sizeof(T), size_t(8))));
+			if (!Grow(capacity, grow_count))
+			{
+				BB_WARNING(false, "ConcurrentGrowPool is at its maximum size!", WarningType::HIGH);
+				return nullptr;
+			}
+		}
+	}
+
+	template<typename T>
+	inline void ConcurrentGrowPool<T>::Free(T* a_ptr)
+	{
+		BB_ASSERT(a_ptr >= m_start && a_ptr < m_start + Capacity(), "Trying to free an pool object that is not part of this pool!");
+		m_freelist.Push(static_cast<uint32_t>(a_ptr - m_start));
+	}
+
+	template<typename T>
+	inline bool ConcurrentGrowPool<T>::Grow(const uint32_t a_seen_capacity, const uint32_t a_grow_count)
+	{
+		BBRWLockScopeWrite lock(m_grow_lock);
+		const uint32_t capacity = m_capacity.load(std::memory_order_relaxed);
+		// someone else grew it while this thread waited for the lock, try their objects first.
+		if (capacity != a_seen_capacity)
+			return true;
+		if (capacity == m_max_capacity)
+			return false;
+
+		if (capacity != 0)
+			BB_WARNING(false, "Growing the concurrent growpool, if this happens often try to reserve more.", WarningType::OPTIMIZATION);
+
+		const uint32_t grow_count = Min(a_grow_count, m_max_capacity - capacity);
+		if (!CommitVirtualMemory(m_start + capacity, grow_count * sizeof(T)) ||
+			!CommitVirtualMemory(m_next + capacity, grow_count * sizeof(std::atomic<uint32_t>)))
+			return false;
+
+		const uint32_t last = capacity + grow_count - 1;
+		for (uint32_t i = capacity; i < last; i++)
+			m_next[i].store(i + 1, std::memory_order_relaxed);
+		m_capacity.store(capacity + grow_count, std::memory_order_relaxed);
+		m_freelist.PushChain(capacity, last);
+		return true;
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "MemoryArena.hpp"
+#include "Storage/Array.h"
+
+namespace BB
+{
+	// a history of the last max_size - 1 values that keeps their sum, so the average is free.
+	struct CountingRingBuffer
+	{
+		double sum;
+		double* buffer;
+		uint32_t head;
+		uint32_t tail;
+		uint32_t max_size;
+	};
+
+	inline static void CountingRingBufferInit(MemoryArena& a_arena, CountingRingBuffer& a_buff, const uint32_t a_max_size)
+	{
+		a_buff.buffer = ArenaAllocArr(a_arena, double, a_max_size);
+		a_buff.max_size = a_max_size;
+		a_buff.head = 0;
+		a_buff.tail = 0;
+		a_buff.sum = 0;
+	}
+
+	inline static void CountingRingBufferClear(CountingRingBuffer& a_buff)
+	{
+		for (uint32_t i = 0; i < a_buff.max_size; i++)
+			a_buff.buffer[i] = 0;
+		a_buff.head = 0;
+		a_buff.tail = 0;
+		a_buff.sum = 0;
+	}
+
+	inline static void CountingRingBufferPush(CountingRingBuffer& a_buff, const double a_value)
+	{
+		a_buff.sum += a_value;
+		a_buff.buffer[a_buff.head] = a_value;
+		a_buff.head = (a_buff.head + 1) % a_buff.max_size;
+
+		// we waste 1 slot but who cares, head == tail means empty so the oldest value leaves the sum here.
+		if (a_buff.head == a_buff.tail)
+		{
+			a_buff.sum -= a_buff.buffer[a_buff.tail];
+			a_buff.tail = (a_buff.tail + 1) % a_buff.max_size;
+		}
+	}
+
+	inline static uint32_t CountingRingBufferSize(const CountingRingBuffer& a_buff)
+	{
+		if (a_buff.head >= a_buff.tail)
+			return a_buff.head - a_buff.tail;
+		return a_buff.max_size + a_buff.head - a_buff.tail;
+	}
+
+	inline static double CountingRingBufferAverage(const CountingRingBuffer& a_buff)
+	{
+		const uint32_t size = CountingRingBufferSize(a_buff);
+		if (size == 0)
+			return 0;
+		return a_buff.sum / static_cast<double>(size);
+	}
+
+	// not thread safe, so specify your own head and tail here.
+	// Strange things can still happen.
+	// please don't use it
+	inline static StaticArray<double> CountingRingBufferLinear(MemoryArena& a_arena, const CountingRingBuffer& a_buff)
+	{
+		StaticArray<double> arr{};
+		arr.Init(a_arena, a_buff.max_size);
+
+		const size_t copy_size = CountingRingBufferSize(a_buff);
+		if (copy_size + a_buff.tail >= a_buff.max_size)
+		{
+			const size_t remainder = (copy_size + a_buff.tail) % a_buff.max_size;
+
+			arr.push_back(&a_buff.buffer[a_buff.tail], copy_size - remainder);
+			arr.push_back(&a_buff.buffer[0], remainder);
+		}
+		else
+		{
+			arr.push_back(&a_buff.buffer[a_buff.tail], copy_size);
+		}
+
+		return arr;
+	}
+}
@@ -81,6 +81,7 @@ namespace BB
 		{
 			m_arr[a_index].index = m_next_free;
 			m_next_free = a_index;
+			--m_size;
 		}
 
 		void clear()
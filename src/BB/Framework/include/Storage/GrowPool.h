@@ -104,7 +104,7 @@ namespace BB
 	{
 		if (*m_pool == nullptr)
 		{
-			BB_WARNING(false, "Growing the growpool, if this happens often try to reserve more.", WarningType::OPTIMALIZATION);
+			BB_WARNING(false, "Growing the growpool, if this happens often try to reserve more.", WarningType::OPTIMIZATION);
 			//get more memory!
 			size_t alloc_size = 8 * sizeof(T);
 			mallocVirtual(m_start, alloc_size);
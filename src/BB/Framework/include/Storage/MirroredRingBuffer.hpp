@@ -0,0 +1,88 @@
+#pragma once
+#include "Utils/Logger.h"
+#include "OS/Program.h"
+
+#include <atomic>
+#include <bit>
+
+namespace BB
+{
+	// a byte ring buffer on mirrored memory, every write and read up to the capacity is one contiguous range.
+	// no wrapping when a write crosses the end and no tail space thrown away, the mirror makes it continue at the start.
+	// lock free for one producer thread and one consumer thread.
+	class MirroredRingBuffer
+	{
+	public:
+		// the capacity is a_min_size rounded up to a power of 2 and at least the OS allocation granularity.
+		bool Init(const size_t a_min_size)
+		{
+			BB_ASSERT(m_memory == nullptr, "MirroredRingBuffer is already initialized");
+			size_t size = std::bit_ceil(a_min_size);
+			m_memory = reinterpret_cast<uint8_t*>(OSCreateMirroredMemory(size));
+			if (m_memory == nullptr)
+				return false;
+
+			BB_ASSERT(std::has_single_bit(size), "mirrored memory size is not a power of 2");
+			m_capacity = size;
+			m_head.store(0, std::memory_order_relaxed);
+			m_tail.store(0, std::memory_order_relaxed);
+			return true;
+		}
+
+		void Destroy()
+		{
+			OSFreeMirroredMemory(m_memory, m_capacity);
+			m_memory = nullptr;
+			m_capacity = 0;
+		}
+
+		// producer, returns where a_size bytes can be written or nullptr if the consumer did not free up enough yet.
+		void* BeginWrite(const size_t a_size)
+		{
+			const uint64_t head = m_head.load(std::memory_order_relaxed);
+			if (m_capacity - (head - m_tail.load(std::memory_order_acquire)) < a_size)
+				return nullptr;
+			return m_memory + (head & (m_capacity - 1));
+		}
+
+		// producer, makes a_size bytes from the last BeginWrite visible to the consumer.
+		void EndWrite(const size_t a_size)
+		{
+			m_head.store(m_head.load(std::memory_order_relaxed) + a_size, std::memory_order_release);
+		}
+
+		bool Write(const void* a_data, const size_t a_size)
+		{
+			void* dst = BeginWrite(a_size);
+			if (dst == nullptr)
+				return false;
+			memcpy(dst, a_data, a_size);
+			EndWrite(a_size);
+			return true;
+		}
+
+		// consumer, returns everything that is written so far as one range.
+		const void* BeginRead(size_t& a_size) const
+		{
+			const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+			a_size = static_cast<size_t>(m_head.load(std::memory_order_acquire) - tail);
+			return m_memory + (tail & (m_capacity - 1));
+		}
+
+		// consumer, gives a_size bytes from the last BeginRead back to the producer.
+		void EndRead(const size_t a_size)
+		{
+			m_tail.store(m_tail.load(std::memory_order_relaxed) + a_size, std::memory_order_release);
+		}
+
+		size_t Capacity() const { return m_capacity; }
+		size_t Size() const { return static_cast<size_t>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire)); }
+
+	private:
+		uint8_t* m_memory = nullptr;
+		size_t m_capacity = 0;
+		// on their own cache line, the producer writes one and the consumer the other.
+		alignas(64) std::atomic<uint64_t> m_head;
+		alignas(64) std::atomic<uint64_t> m_tail;
+	};
+}
@@ -5,6 +5,28 @@
 
 namespace BB
 {
+	// djb2, constexpr so that literal names can be hashed at compile time.
+	constexpr uint64_t StringHash(const char* a_string, const size_t a_size)
+	{
+		uint64_t hash = 5381;
+		for (size_t i = 0; i < a_size; i++)
+			hash = ((hash << 5) + hash) + static_cast<unsigned char>(a_string[i]);
+		return hash;
+	}
+
+	constexpr uint64_t StringHash(const char* a_string)
+	{
+		uint64_t hash = 5381;
+		while (*a_string != '\0')
+			hash = ((hash << 5) + hash) + static_cast<unsigned char>(*a_string++);
+		return hash;
+	}
+
+	inline uint64_t StringHash(const StringView a_view)
+	{
+		return StringHash(a_view.c_str(), a_view.size());
+	}
+
 	//will remove this, I don't like it.
 	//Maybe a unified hash is cringe and I should just have some basic hashing operations in this file.
 	struct Hash
@@ -25,12 +47,7 @@ namespace BB
 		template<size_t STRING_SIZE>
 		static Hash MakeHash(const StackString<STRING_SIZE>& a_str)
 		{
-			uint64_t hash = 5381;
-
-			for (size_t i = 0; i < a_str.size(); i++)
-				hash = ((hash << 5) + hash) + static_cast<unsigned char>(a_str[i]);
-
-			return hash;
+			return StringHash(a_str.c_str(), a_str.size());
 		}
 
 	private:
@@ -57,12 +74,6 @@ namespace BB
 
 	inline Hash Hash::MakeHash(const char* a_value)
 	{
-		uint64_t hash = 5381;
-		char c = 0;
-
-		while (c == *a_value++)
-			hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);
-
-		return hash;
+		return StringHash(a_value);
 	}
 }
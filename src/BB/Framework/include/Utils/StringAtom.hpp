@@ -0,0 +1,45 @@
+#pragma once
+#include "Common.h"
+#include "MemoryArena.hpp"
+#include "Storage/BBString.h"
+#include "Utils/Hash.h"
+
+namespace BB
+{
+	// a StringAtom is an index into the global string atom table.
+	// equal strings always intern to the same atom, so comparing names is an integer compare.
+	using StringAtom = FrameworkHandle32Bit<struct StringAtomTag>;
+
+	constexpr uint32_t STRING_ATOM_DEFAULT_MAX = 8192;
+	constexpr size_t STRING_ATOM_DEFAULT_STRING_MEMORY = mbSize;
+	constexpr uint32_t STRING_ATOM_DEFAULT_TRANSIENT_MAX = 4096;
+	// longer transient strings are interned like normal strings.
+	constexpr uint32_t STRING_ATOM_TRANSIENT_STRING_MAX = 63;
+
+	// called by InitBB, only call this yourself when not using InitBB.
+	void InitStringAtomTable(MemoryArena& a_arena, const uint32_t a_max_atoms, const size_t a_string_memory, const uint32_t a_max_transient_atoms = STRING_ATOM_DEFAULT_TRANSIENT_MAX);
+
+	// thread safe, returns the existing atom if the string was already interned.
+	// the string stays in the table for the rest of the program, when the table is full this returns the "#STRING ATOM TABLE FULL#" atom.
+	StringAtom StringAtomIntern(const StringView a_string);
+	// thread safe, for strings that come and go at runtime like entity names from lua or the editor.
+	// every call needs a StringAtomRelease, the string leaves the table after the last one.
+	// returns the normal atom when the string is already interned for good, releasing that does nothing.
+	// StringAtomIntern of a string with a live transient atom makes a second atom, do not mix the two for the same strings.
+	StringAtom StringAtomInternTransient(const StringView a_string);
+	// thread safe, does nothing for atoms that are not transient.
+	void StringAtomRelease(const StringAtom a_atom);
+	// thread safe, returns an invalid atom if the string was never interned.
+	StringAtom StringAtomFind(const StringView a_string);
+
+	StringView StringAtomGetView(const StringAtom a_atom);
+	const char* StringAtomGetCStr(const StringAtom a_atom);
+	// the StringHash of the string, calculated once on interning.
+	uint64_t StringAtomGetHash(const StringAtom a_atom);
+	// atoms that stay for the whole program, transient atoms are not counted.
+	uint32_t StringAtomCount();
+
+	// intern a string literal once per call site, the atom is cached in a function local static.
+	// do not use this for strings that change at runtime.
+#define BB_STRING_ATOM(a_literal) ([]() -> BB::StringAtom { static const BB::StringAtom s_atom = BB::StringAtomIntern(a_literal); return s_atom; }())
+}
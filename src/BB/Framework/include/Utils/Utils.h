@@ -4,6 +4,8 @@
 #include <cstring>
 
 #include <cwchar>
+#include <type_traits>
+#include <new>
 
 #include <immintrin.h>
 
@@ -74,14 +76,12 @@ namespace BB
 			{
 				return memmove(a_destination, a_source, a_element_count * sizeof(T));
 			}
-			else if constexpr (!TRIVIAL_CONTSRUCTABLE && !TRIVIAL_DESTRUCTABLE)
+			else
 			{
+				// a type with only a constructor, like default member values, still needs to be constructed.
 				for (size_t i = 0; i < a_element_count; i++)
 				{
-					if constexpr (!TRIVIAL_CONTSRUCTABLE)
-					{
-						new (&a_destination[i]) T(a_source[i]);
-					}
+					new (&a_destination[i]) T(a_source[i]);
 					if constexpr (!TRIVIAL_DESTRUCTABLE)
 					{
 						a_source[i].~T();
@@ -89,9 +89,6 @@ namespace BB
 				}
 				return a_destination;
 			}
-			else
-				BB_STATIC_ASSERT(false, "Something weird happened, Unsafe Move.");
-			return nullptr;
 		}
 
 		/// <summary>
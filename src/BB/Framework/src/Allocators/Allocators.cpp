@@ -187,7 +187,7 @@ void BB::allocators::BaseAllocator::Validate() const
 			temp_string.append(begin, sizeof(begin) - 1);
 			
 			char leak_size[16]{};
-			sprintf_s(leak_size, 15, "%u", static_cast<uint32_t>(front_log->alloc_size));
+			snprintf(leak_size, sizeof(leak_size), "%u", static_cast<uint32_t>(front_log->alloc_size));
 			temp_string.append(leak_size);
 		}
 	
@@ -619,11 +619,35 @@ BB::allocators::POW_FreelistAllocator::~POW_FreelistAllocator()
 	freeVirtual(m_FreeLists);
 }
 
+static void* POW_FreelistRealloc(BB_MEMORY_DEBUG void* a_allocator, size_t a_size, const size_t a_alignment, void* a_ptr)
+{
+	POW_FreelistAllocator* freelist = reinterpret_cast<POW_FreelistAllocator*>(a_allocator);
+	if (a_size > 0)
+	{
+#ifdef _DEBUG
+		a_size += MEMORY_BOUNDRY_FRONT + MEMORY_BOUNDRY_BACK + sizeof(BaseAllocator::AllocationLog);
+#endif //_DEBUG
+		void* allocated_ptr = freelist->Alloc(a_size, a_alignment);
+#ifdef _DEBUG
+		allocated_ptr = AllocDebug(a_file, a_line, a_is_array, freelist, a_size, allocated_ptr);
+#endif //_DEBUG
+		return allocated_ptr;
+	}
+	else
+	{
+#ifdef _DEBUG
+		a_ptr = FreeDebug(freelist, a_is_array, a_ptr);
+#endif //_DEBUG
+		freelist->Free(a_ptr);
+		return nullptr;
+	}
+};
+
 POW_FreelistAllocator::operator Allocator()
 {
 	Allocator allocator_interface;
 	allocator_interface.allocator = this;
-	allocator_interface.func = FreelistRealloc;
+	allocator_interface.func = POW_FreelistRealloc;
 	return allocator_interface;
 }
 
@@ -0,0 +1,139 @@
+#include "AtlasAllocator.hpp"
+#include "MemoryArena.hpp"
+#include "Logger.h"
+
+#include <bit>
+
+using namespace BB;
+
+void AtlasAllocator::Init(MemoryArena& a_arena, const uint32_t a_atlas_size, const uint32_t a_min_tile_size)
+{
+	BB_ASSERT(std::has_single_bit(a_atlas_size) && std::has_single_bit(a_min_tile_size), "atlas and min tile size must be a power of 2");
+	BB_ASSERT(a_min_tile_size <= a_atlas_size, "min tile size is larger then the atlas");
+	m_atlas_size = a_atlas_size;
+	m_min_tile_size = a_min_tile_size;
+	m_level_count = static_cast<uint32_t>(std::countr_zero(a_atlas_size / a_min_tile_size)) + 1;
+	// 1 + 4 + 16 + ... for every level.
+	m_node_count = LevelFirstNode(m_level_count);
+	m_largest_free = ArenaAllocArr(a_arena, uint32_t, m_node_count);
+	Reset();
+}
+
+void AtlasAllocator::Reset()
+{
+	m_allocation_count = 0;
+	m_used_area = 0;
+	// every node is free, a free node always has free children so they can be split without touching them.
+	for (uint32_t level = 0; level < m_level_count; level++)
+	{
+		const uint32_t level_size = m_atlas_size >> level;
+		for (uint32_t node = LevelFirstNode(level); node < LevelFirstNode(level + 1); node++)
+			m_largest_free[node] = level_size;
+	}
+}
+
+AtlasAllocation AtlasAllocator::Allocate(const uint32_t a_size)
+{
+	const uint32_t size = Max(std::bit_ceil(a_size), m_min_tile_size);
+	if (a_size == 0 || size > m_atlas_size || m_largest_free[0] < size)
+		return AtlasAllocation();
+
+	uint32_t node = 0;
+	uint32_t level = 0;
+	uint32_t local = 0;
+	uint32_t node_size = m_atlas_size;
+	uint2 offset = uint2(0, 0);
+	while (node_size > size)
+	{
+		// take the child with the smallest free tile that still fits, that keeps the large free nodes whole.
+		const uint32_t first_child = LevelFirstNode(level + 1) + local * 4;
+		uint32_t best_child = UINT32_MAX;
+		for (uint32_t child = 0; child < 4; child++)
+		{
+			const uint32_t child_free = m_largest_free[first_child + child];
+			if (child_free >= size && (best_child == UINT32_MAX || child_free < m_largest_free[first_child + best_child]))
+				best_child = child;
+		}
+		BB_ASSERT(best_child != UINT32_MAX, "atlas node claims free space that none of its children have");
+
+		node_size /= 2;
+		offset.x += (best_child & 1) * node_size;
+		offset.y += (best_child >> 1) * node_size;
+		node = first_child + best_child;
+		local = local * 4 + best_child;
+		++level;
+	}
+	BB_ASSERT(m_largest_free[node] == node_size, "atlas allocated a node that is not free");
+
+	m_largest_free[node] = 0;
+	UpdateParents(node, level);
+	++m_allocation_count;
+	m_used_area += static_cast<uint64_t>(size) * size;
+
+	AtlasAllocation allocation;
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.node = node;
+	return allocation;
+}
+
+void AtlasAllocator::Free(const AtlasAllocation a_allocation)
+{
+	BB_ASSERT(a_allocation.IsValid() && a_allocation.node < m_node_count, "freeing an invalid atlas allocation");
+	BB_ASSERT(m_largest_free[a_allocation.node] == 0, "freeing an atlas allocation that is not allocated");
+	const uint32_t level = NodeLevel(a_allocation.node);
+	BB_ASSERT((m_atlas_size >> level) == a_allocation.size, "atlas allocation size does not match its node");
+
+	// the children of a used node were never touched, so the node is whole again.
+	m_largest_free[a_allocation.node] = a_allocation.size;
+	UpdateParents(a_allocation.node, level);
+	--m_allocation_count;
+	m_used_area -= static_cast<uint64_t>(a_allocation.size) * a_allocation.size;
+}
+
+AtlasAllocatorReport AtlasAllocator::GetReport() const
+{
+	AtlasAllocatorReport report;
+	report.used_area = m_used_area;
+	report.largest_free = m_largest_free[0];
+	report.allocation_count = m_allocation_count;
+	return report;
+}
+
+uint32_t AtlasAllocator::LevelFirstNode(const uint32_t a_level) const
+{
+	return ((1u << (a_level * 2)) - 1) / 3;
+}
+
+uint32_t AtlasAllocator::NodeLevel(const uint32_t a_node) const
+{
+	uint32_t level = 0;
+	while (LevelFirstNode(level + 1) <= a_node)
+		++level;
+	return level;
+}
+
+void AtlasAllocator::UpdateParents(uint32_t a_node, uint32_t a_level)
+{
+	while (a_level > 0)
+	{
+		const uint32_t local = a_node - LevelFirstNode(a_level);
+		const uint32_t first_sibling = LevelFirstNode(a_level) + (local & ~3u);
+		const uint32_t child_size = m_atlas_size >> a_level;
+
+		uint32_t largest_free = 0;
+		uint32_t whole_children = 0;
+		for (uint32_t child = 0; child < 4; child++)
+		{
+			const uint32_t child_free = m_largest_free[first_sibling + child];
+			largest_free = Max(largest_free, child_free);
+			if (child_free == child_size)
+				++whole_children;
+		}
+
+		--a_level;
+		a_node = LevelFirstNode(a_level) + (local >> 2);
+		// 4 whole children merge back into one free parent.
+		m_largest_free[a_node] = whole_children == 4 ? child_size * 2 : largest_free;
+	}
+}
@@ -0,0 +1,241 @@
+#include "MemoryAccounting.hpp"
+#include "Logger.h"
+
+#include <atomic>
+#include <bit>
+#include <thread>
+
+using namespace BB;
+
+static_assert(std::has_single_bit(MEMORY_ACCOUNTING_MAX_SITES), "the site table is probed with a mask");
+static_assert(MEMORY_ACCOUNTING_MAX_THREADS <= 64, "thread slots are a 64 bit mask");
+
+// open addressing from site hash to site index, slots are only ever added.
+struct SiteSlot
+{
+	std::atomic<uint64_t> hash;			// 0 is an empty slot.
+	std::atomic<uint32_t> index_plus_one;	// 0 until the site is written.
+};
+
+static SiteSlot s_site_slots[MEMORY_ACCOUNTING_MAX_SITES];
+static MemoryAccountingSite s_sites[MEMORY_ACCOUNTING_MAX_SITES];
+// the indices that are handed out, s_site_count only goes past a site after it is written.
+static std::atomic<uint32_t> s_site_reserved_count{ 0 };
+static std::atomic<uint32_t> s_site_count{ 0 };
+static constexpr MemoryAccountingSite s_overflow_site{ nullptr, "site overflow", nullptr, 0, nullptr, 0 };
+
+struct SiteCounters
+{
+	std::atomic<int64_t> current_bytes;
+	std::atomic<int64_t> current_count;
+	std::atomic<uint64_t> total_bytes;
+	std::atomic<uint64_t> total_count;
+};
+
+// only the thread that owns the slot writes to it, the atomics are for the snapshot that reads them from another thread.
+// the last one is shared by the threads that did not get a slot of their own, only that one needs read modify writes.
+struct alignas(64) ThreadCounters
+{
+	SiteCounters sites[MEMORY_ACCOUNTING_MAX_SITES + 1];
+};
+static ThreadCounters s_thread_counters[MEMORY_ACCOUNTING_MAX_THREADS + 1];
+
+// a thread that exits gives the slot back but the counters stay, so a snapshot still adds up the frees of memory it allocated.
+static std::atomic<uint64_t> s_thread_slots{ 0 };
+static std::atomic<uint64_t> s_thread_slots_ever_used{ 0 };
+static std::atomic<bool> s_shared_slot_used{ false };
+
+struct AccountingThreadSlot
+{
+	uint32_t index = UINT32_MAX;
+	~AccountingThreadSlot()
+	{
+		if (index < MEMORY_ACCOUNTING_MAX_THREADS)
+			s_thread_slots.fetch_and(~(uint64_t(1) << index), std::memory_order_release);
+	}
+};
+static thread_local AccountingThreadSlot s_thread_slot;
+
+// no logging in here, the logger allocates from memory that is being counted.
+static uint32_t GetThreadSlot()
+{
+	if (s_thread_slot.index != UINT32_MAX)
+		return s_thread_slot.index;
+
+	uint64_t used = s_thread_slots.load(std::memory_order_relaxed);
+	while (used != UINT64_MAX)
+	{
+		const uint32_t index = static_cast<uint32_t>(std::countr_zero(~used));
+		if (index >= MEMORY_ACCOUNTING_MAX_THREADS)
+			break;
+		if (s_thread_slots.compare_exchange_weak(used, used | (uint64_t(1) << index), std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			s_thread_slots_ever_used.fetch_or(uint64_t(1) << index, std::memory_order_relaxed);
+			s_thread_slot.index = index;
+			return index;
+		}
+	}
+
+	s_shared_slot_used.store(true, std::memory_order_relaxed);
+	s_thread_slot.index = MEMORY_ACCOUNTING_MAX_THREADS;
+	return MEMORY_ACCOUNTING_MAX_THREADS;
+}
+
+// a plain load and store for a slot with one writer, no locked instruction on every allocation.
+template<typename T>
+static void CounterAdd(std::atomic<T>& a_counter, const T a_value, const uint32_t a_thread_slot)
+{
+	if (a_thread_slot == MEMORY_ACCOUNTING_MAX_THREADS)
+		a_counter.fetch_add(a_value, std::memory_order_relaxed);
+	else
+		a_counter.store(a_counter.load(std::memory_order_relaxed) + a_value, std::memory_order_relaxed);
+}
+
+template<typename T>
+static void CounterSub(std::atomic<T>& a_counter, const T a_value, const uint32_t a_thread_slot)
+{
+	if (a_thread_slot == MEMORY_ACCOUNTING_MAX_THREADS)
+		a_counter.fetch_sub(a_value, std::memory_order_relaxed);
+	else
+		a_counter.store(a_counter.load(std::memory_order_relaxed) - a_value, std::memory_order_relaxed);
+}
+
+static uint64_t HashSite(const MemoryAccountingSite& a_site)
+{
+	constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15;
+	uint64_t hash = reinterpret_cast<uintptr_t>(a_site.owner) * MULTIPLIER;
+	hash = (hash ^ reinterpret_cast<uintptr_t>(a_site.tag_name)) * MULTIPLIER;
+	hash = (hash ^ reinterpret_cast<uintptr_t>(a_site.file)) * MULTIPLIER;
+	hash = (hash ^ static_cast<uint64_t>(a_site.line)) * MULTIPLIER;
+	return (hash ^ (hash >> 32)) | 1;
+}
+
+static bool SiteEqual(const MemoryAccountingSite& a_lhs, const MemoryAccountingSite& a_rhs)
+{
+	return a_lhs.owner == a_rhs.owner && a_lhs.tag_name == a_rhs.tag_name && a_lhs.file == a_rhs.file && a_lhs.line == a_rhs.line;
+}
+
+uint32_t BB::MemoryAccountingGetSiteIndex(const MemoryAccountingSite& a_site)
+{
+	const uint64_t hash = HashSite(a_site);
+	for (uint32_t probe = 0; probe < MEMORY_ACCOUNTING_MAX_SITES; probe++)
+	{
+		SiteSlot& slot = s_site_slots[(hash + probe) & (MEMORY_ACCOUNTING_MAX_SITES - 1)];
+		uint64_t slot_hash = slot.hash.load(std::memory_order_acquire);
+		if (slot_hash == 0)
+		{
+			if (slot.hash.compare_exchange_strong(slot_hash, hash, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				// every slot holds at most one site, so this never goes over MEMORY_ACCOUNTING_MAX_SITES.
+				const uint32_t index = s_site_reserved_count.fetch_add(1, std::memory_order_relaxed);
+				s_sites[index] = a_site;
+				slot.index_plus_one.store(index + 1, std::memory_order_release);
+				// a snapshot reads every site below the count, publish in index order after the site is written.
+				uint32_t published = index;
+				while (!s_site_count.compare_exchange_weak(published, index + 1, std::memory_order_release, std::memory_order_relaxed))
+				{
+					published = index;
+					std::this_thread::yield();
+				}
+				return index;
+			}
+			// another thread took the slot, slot_hash now holds their hash.
+		}
+
+		if (slot_hash != hash)
+			continue;
+
+		// same hash, wait for the thread that added it to write the site.
+		uint32_t index_plus_one;
+		while ((index_plus_one = slot.index_plus_one.load(std::memory_order_acquire)) == 0)
+			std::this_thread::yield();
+		if (SiteEqual(s_sites[index_plus_one - 1], a_site))
+			return index_plus_one - 1;
+	}
+
+	return MEMORY_ACCOUNTING_OVERFLOW_SITE;
+}
+
+const MemoryAccountingSite& BB::MemoryAccountingGetSite(const uint32_t a_site_index)
+{
+	if (a_site_index == MEMORY_ACCOUNTING_OVERFLOW_SITE)
+		return s_overflow_site;
+	BB_ASSERT(a_site_index < s_site_reserved_count.load(std::memory_order_relaxed), "memory accounting site index out of bounds");
+	return s_sites[a_site_index];
+}
+
+void BB::MemoryAccountingAlloc(const uint32_t a_site_index, const size_t a_size)
+{
+	const uint32_t thread_slot = GetThreadSlot();
+	SiteCounters& counters = s_thread_counters[thread_slot].sites[a_site_index];
+	CounterAdd(counters.current_bytes, static_cast<int64_t>(a_size), thread_slot);
+	CounterAdd(counters.current_count, int64_t(1), thread_slot);
+	CounterAdd(counters.total_bytes, static_cast<uint64_t>(a_size), thread_slot);
+	CounterAdd(counters.total_count, uint64_t(1), thread_slot);
+}
+
+void BB::MemoryAccountingFree(const uint32_t a_site_index, const size_t a_size)
+{
+	const uint32_t thread_slot = GetThreadSlot();
+	SiteCounters& counters = s_thread_counters[thread_slot].sites[a_site_index];
+	CounterSub(counters.current_bytes, static_cast<int64_t>(a_size), thread_slot);
+	CounterSub(counters.current_count, int64_t(1), thread_slot);
+}
+
+void BB::MemoryAccountingResize(const uint32_t a_site_index, const size_t a_old_size, const size_t a_new_size)
+{
+	const uint32_t thread_slot = GetThreadSlot();
+	SiteCounters& counters = s_thread_counters[thread_slot].sites[a_site_index];
+	CounterAdd(counters.current_bytes, static_cast<int64_t>(a_new_size) - static_cast<int64_t>(a_old_size), thread_slot);
+	if (a_new_size > a_old_size)
+		CounterAdd(counters.total_bytes, static_cast<uint64_t>(a_new_size - a_old_size), thread_slot);
+}
+
+void BB::MemoryAccountingMove(const uint32_t a_from_site_index, const uint32_t a_to_site_index, const size_t a_size)
+{
+	if (a_from_site_index == a_to_site_index)
+		return;
+
+	const uint32_t thread_slot = GetThreadSlot();
+	SiteCounters& from = s_thread_counters[thread_slot].sites[a_from_site_index];
+	CounterSub(from.current_bytes, static_cast<int64_t>(a_size), thread_slot);
+	CounterSub(from.current_count, int64_t(1), thread_slot);
+
+	SiteCounters& to = s_thread_counters[thread_slot].sites[a_to_site_index];
+	CounterAdd(to.current_bytes, static_cast<int64_t>(a_size), thread_slot);
+	CounterAdd(to.current_count, int64_t(1), thread_slot);
+}
+
+static void AddThreadCounters(MemoryAccountingSnapshot& a_snapshot, const ThreadCounters& a_thread_counters)
+{
+	auto add_site = [&](const uint32_t a_index)
+	{
+		const SiteCounters& counters = a_thread_counters.sites[a_index];
+		MemoryAccountingCounters& sum = a_snapshot.sites[a_index];
+		sum.current_bytes += counters.current_bytes.load(std::memory_order_relaxed);
+		sum.current_count += counters.current_count.load(std::memory_order_relaxed);
+		sum.total_bytes += counters.total_bytes.load(std::memory_order_relaxed);
+		sum.total_count += counters.total_count.load(std::memory_order_relaxed);
+	};
+
+	for (uint32_t i = 0; i < a_snapshot.site_count; i++)
+		add_site(i);
+	add_site(MEMORY_ACCOUNTING_OVERFLOW_SITE);
+}
+
+void BB::MemoryAccountingTakeSnapshot(MemoryAccountingSnapshot& a_snapshot)
+{
+	a_snapshot.site_count = s_site_count.load(std::memory_order_acquire);
+	memset(a_snapshot.sites, 0, sizeof(a_snapshot.sites));
+
+	// only the counters of threads that ever counted something, most slots are never used.
+	uint64_t used = s_thread_slots_ever_used.load(std::memory_order_acquire);
+	while (used)
+	{
+		const uint32_t index = static_cast<uint32_t>(std::countr_zero(used));
+		AddThreadCounters(a_snapshot, s_thread_counters[index]);
+		used &= used - 1;
+	}
+	if (s_shared_slot_used.load(std::memory_order_acquire))
+		AddThreadCounters(a_snapshot, s_thread_counters[MEMORY_ACCOUNTING_MAX_THREADS]);
+}
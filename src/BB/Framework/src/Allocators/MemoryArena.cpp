@@ -1,12 +1,25 @@
 #include "MemoryArena.hpp"
+#include "MemoryAccounting.hpp"
 #include "Program.h"
 
 
+// gcc before 14 has no __has_feature, the boundry poisoning stays off there.
+#if defined(__has_feature)
 #if __has_feature(address_sanitizer) && defined(_DEBUG_POISON_MEMORY_BOUNDRY)
 #define SANITIZER_ENABLED
 constexpr size_t MEMORY_BOUNDRY_SIZE = 8;
 #include <sanitizer/asan_interface.h>
 #endif // _DEBUG_POISON_MEMORY_BOUNDRY
+#endif // __has_feature
+
+#ifdef _DEBUG_MEMORY
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ARENA_CREATE_CALLER() _ReturnAddress()
+#else
+#define ARENA_CREATE_CALLER() __builtin_return_address(0)
+#endif // _MSC_VER
+#endif // _DEBUG_MEMORY
 
 using namespace BB;
 
@@ -15,18 +28,63 @@ static inline size_t GetAddressRange(const void* a_begin, const void* a_end)
 	return reinterpret_cast<uintptr_t>(a_end) - reinterpret_cast<uintptr_t>(a_begin);
 }
 
+static void MemoryArenaResetTo(MemoryArena& a_arena, void* a_memory_marker);
+
+#ifdef _DEBUG_MEMORY
+// drops the allocation log entries past the marker and takes them out of the memory accounting.
+static void MemoryArenaPopAllocationLog(MemoryArena& a_arena, const void* a_memory_marker)
+{
+	while (a_arena.last && a_arena.last->alloc_address > a_memory_marker)
+	{
+		MemoryAccountingFree(a_arena.last->accounting_site, a_arena.last->alloc_size);
+		a_arena.last = a_arena.last->prev;
+	}
+
+	if (a_arena.last)
+		a_arena.last->next = nullptr;
+	else
+		a_arena.first = nullptr;
+}
+#endif // _DEBUG_MEMORY
+
 static inline void ChangeArenaAt(MemoryArena& a_arena, void* a_at)
 {
 	BB_ASSERT(MemoryArenaIsPointerWithinArena(a_arena, a_at), "modifying memory arena at that is not inside the arena, arena may be full");
 	if (a_at > a_arena.commited)
 	{
-		const size_t commit_range = RoundUp(GetAddressRange(a_arena.commited, a_at), ARENA_DEFAULT_COMMIT);
+		// grow with the arena, a big load then takes a handful of commits instead of one every 16 kb.
+		const size_t required_range = RoundUp(GetAddressRange(a_arena.commited, a_at), ARENA_DEFAULT_COMMIT);
+		const size_t growth_range = Min(GetAddressRange(a_arena.buffer, a_arena.commited), ARENA_MAX_COMMIT_STEP);
+		const size_t commit_range = Min(Max(required_range, growth_range), GetAddressRange(a_arena.commited, a_arena.end));
 		const bool success = CommitVirtualMemory(a_arena.commited, commit_range);
 		BB_ASSERT(success, "increase commit range of memory arena failed");
 		a_arena.commited = Pointer::Add(a_arena.commited, commit_range);
+		++a_arena.stats.commit_count;
 	}
 
 	a_arena.at = a_at;
+	a_arena.reset_peak = Max(a_arena.reset_peak, GetAddressRange(a_arena.buffer, a_at));
+	a_arena.stats.high_water_mark = Max(a_arena.stats.high_water_mark, a_arena.reset_peak);
+}
+
+// called on every reset to the start, after ARENA_DECAY_RESET_COUNT of those the memory above their peak was idle the whole time.
+static void MemoryArenaDecay(MemoryArena& a_arena)
+{
+	a_arena.decay_peak = Max(a_arena.decay_peak, a_arena.reset_peak);
+	a_arena.reset_peak = 0;
+	if (!a_arena.owns_memory || ++a_arena.decay_reset_count < ARENA_DECAY_RESET_COUNT)
+		return;
+
+	void* keep_end = Pointer::Add(a_arena.buffer, RoundUp(Max(a_arena.decay_peak, ARENA_DEFAULT_COMMIT), ARENA_DEFAULT_COMMIT));
+	if (keep_end < a_arena.commited && GetAddressRange(keep_end, a_arena.commited) >= ARENA_DECAY_MIN_SIZE)
+	{
+		const bool success = DecommitVirtualMemory(keep_end, GetAddressRange(keep_end, a_arena.commited));
+		BB_ASSERT(success, "decommit of idle memory arena range failed");
+		a_arena.commited = keep_end;
+		++a_arena.stats.decommit_count;
+	}
+	a_arena.decay_peak = 0;
+	a_arena.decay_reset_count = 0;
 }
 
 MemoryArenaTemp::MemoryArenaTemp(MemoryArena& a_arena) : m_arena(a_arena)
@@ -49,19 +107,28 @@ MemoryArenaTemp::operator MemoryArena& () const
 	return m_arena; 
 };
 
-MemoryArena BB::MemoryArenaCreate(const size_t a_reserve_size)
+MemoryArena BB::MemoryArenaCreate(const size_t a_reserve_size, const bool a_huge_pages, const std::source_location a_caller)
 {
 	MemoryArena memory_arena{};
 	memory_arena.buffer = ReserveVirtualMemory(a_reserve_size);
+	if (a_huge_pages)
+		AdviseHugePages(memory_arena.buffer, a_reserve_size);
 	memory_arena.commited = memory_arena.buffer;
 	memory_arena.end = Pointer::Add(memory_arena.buffer, a_reserve_size);
 	memory_arena.at = memory_arena.buffer;
 
 	memory_arena.owns_memory = true;
+#ifdef _DEBUG_MEMORY
+	memory_arena.accounting_owner = ARENA_CREATE_CALLER();
+	memory_arena.create_file = a_caller.file_name();
+	memory_arena.create_line = static_cast<int>(a_caller.line());
+#else
+	(void)a_caller;
+#endif // _DEBUG_MEMORY
 	return memory_arena;
 }
 
-MemoryArena BB::MemoryArenaCreate(MemoryArena& a_memory_source, const size_t a_memory_size)
+MemoryArena BB::MemoryArenaCreate(MemoryArena& a_memory_source, const size_t a_memory_size, const std::source_location a_caller)
 {
 	MemoryArena memory_arena{};
 	memory_arena.buffer = ArenaAlloc(a_memory_source, a_memory_size, 8);
@@ -70,6 +137,13 @@ MemoryArena BB::MemoryArenaCreate(MemoryArena& a_memory_source, const size_t a_m
 	memory_arena.at = memory_arena.buffer;
 
 	memory_arena.owns_memory = false;
+#ifdef _DEBUG_MEMORY
+	memory_arena.accounting_owner = ARENA_CREATE_CALLER();
+	memory_arena.create_file = a_caller.file_name();
+	memory_arena.create_line = static_cast<int>(a_caller.line());
+#else
+	(void)a_caller;
+#endif // _DEBUG_MEMORY
 	return memory_arena;
 }
 
@@ -78,6 +152,7 @@ void BB::MemoryArenaFree(MemoryArena& a_arena)
 	// sometimes in the engine the memory arena is responsible for holding the memory of it's own struct.
 	// yes i'm sane why do you ask.
 	void* buffer = a_arena.buffer;
+	const bool owns_memory = a_arena.owns_memory;
 
 	a_arena.buffer = nullptr;
 	a_arena.commited = nullptr;
@@ -86,8 +161,12 @@ void BB::MemoryArenaFree(MemoryArena& a_arena)
 
 	a_arena.owns_memory = false;
 
-	if (a_arena.owns_memory)
+	if (owns_memory)
 	{
+#ifdef _DEBUG_MEMORY
+		MemoryArenaPopAllocationLog(a_arena, buffer);
+#endif // _DEBUG_MEMORY
+
 		const bool success = ReleaseVirtualMemory(buffer);
 		BB_ASSERT(success, "failed to release memory");
 	}
@@ -99,13 +178,17 @@ void BB::MemoryArenaFree(MemoryArena& a_arena)
 
 void BB::MemoryArenaReset(MemoryArena& a_arena)
 {
+	MemoryArenaResetTo(a_arena, a_arena.buffer);
+#ifdef _DEBUG_MEMORY
+	// stale pointers into a reset arena read zeroes instead of old data, without it ArenaAlloc already zeroes what it hands out.
 	memset(a_arena.buffer, 0, GetAddressRange(a_arena.buffer, a_arena.commited));
-	a_arena.at = a_arena.buffer;
+#endif // _DEBUG_MEMORY
 }
 
 void BB::TagMemory(const MemoryArena& a_arena, void* a_ptr, const char* a_tag_name)
 {
 	BB_ASSERT(MemoryArenaIsPointerWithinArena(a_arena, a_ptr), "Trying to tag memory that is not within the memory arena!");
+#ifdef _DEBUG_MEMORY
 #ifdef SANITIZER_ENABLED
 	constexpr size_t SUBTRACT_VALUE = sizeof(MemoryArenaAllocationInfo) + MEMORY_BOUNDRY_SIZE;
 #else
@@ -114,23 +197,19 @@ void BB::TagMemory(const MemoryArena& a_arena, void* a_ptr, const char* a_tag_na
 
 	MemoryArenaAllocationInfo* allocation_info = reinterpret_cast<MemoryArenaAllocationInfo*>(Pointer::Subtract(a_ptr, SUBTRACT_VALUE));
 	allocation_info->tag_name = a_tag_name;
+
+	const uint32_t tagged_site = MemoryAccountingGetSiteIndex(MemoryAccountingSite{ a_arena.accounting_owner, a_tag_name, allocation_info->file, allocation_info->line, a_arena.create_file, a_arena.create_line });
+	MemoryAccountingMove(allocation_info->accounting_site, tagged_site, allocation_info->alloc_size);
+	allocation_info->accounting_site = tagged_site;
+#else
+	(void)a_tag_name;
+#endif // _DEBUG_MEMORY
 }
 
 static void MemoryArenaResetTo(MemoryArena& a_arena, void* a_memory_marker)
 {
 #ifdef _DEBUG_MEMORY
-	while (a_arena.last)
-	{
-		if (a_arena.last->alloc_address <= a_memory_marker)
-			break;
-
-		a_arena.last = a_arena.last->prev;
-	}
-	if (a_memory_marker == a_arena.buffer)
-	{
-		a_arena.first = nullptr;
-	}
-
+	MemoryArenaPopAllocationLog(a_arena, a_memory_marker);
 #endif // _DEBUG_MEMORY
 
 #ifdef SANITIZER_ENABLED
@@ -139,6 +218,9 @@ static void MemoryArenaResetTo(MemoryArena& a_arena, void* a_memory_marker)
 	__asan_unpoison_memory_region(a_memory_marker.at, a_range);
 #endif // SANITIZER_ENABLED
 
+	if (a_memory_marker == a_arena.buffer)
+		MemoryArenaDecay(a_arena);
+
 	a_arena.at = a_memory_marker;
 }
 
@@ -157,7 +239,23 @@ void BB::MemoryArenaSetMemoryMarker(MemoryArena& a_arena, const MemoryArenaMarke
 
 const MemoryArenaAllocationInfo* BB::MemoryArenaGetFrontAllocationLog(const MemoryArena& a_arena)
 {
+#ifdef _DEBUG_MEMORY
 	return a_arena.first;
+#else
+	(void)a_arena;
+	return nullptr;
+#endif // _DEBUG_MEMORY
+}
+
+const MemoryArenaStats& BB::MemoryArenaGetStats(const MemoryArena& a_arena)
+{
+	return a_arena.stats;
+}
+
+void BB::MemoryArenaStatsNextFrame(MemoryArena& a_arena)
+{
+	a_arena.stats.allocations_last_frame = a_arena.stats.allocation_count;
+	a_arena.stats.allocation_count = 0;
 }
 
 size_t BB::MemoryArenaSizeRemaining(const MemoryArena& a_arena)
@@ -204,6 +302,8 @@ void* BB::ArenaAllocNoZero_f(BB_ARENA_DEBUG MemoryArena& a_arena, size_t a_memor
 	debug_address->alloc_size = a_memory_size;
 	debug_address->alignment = a_align;
 	debug_address->tag_name = nullptr;
+	debug_address->accounting_site = MemoryAccountingGetSiteIndex(MemoryAccountingSite{ a_arena.accounting_owner, nullptr, a_file, a_line, a_arena.create_file, a_arena.create_line });
+	MemoryAccountingAlloc(debug_address->accounting_site, a_memory_size);
 	debug_address->next = nullptr;
 	debug_address->prev = a_arena.last;
 
@@ -219,7 +319,8 @@ void* BB::ArenaAllocNoZero_f(BB_ARENA_DEBUG MemoryArena& a_arena, size_t a_memor
 	}
 
 #endif // _DEBUG_MEMORY
-	
+	++a_arena.stats.allocation_count;
+
 	void* return_address = Pointer::AlignAddress(a_arena.at, a_align);
 
 #ifdef SANITIZER_ENABLED
@@ -248,10 +349,8 @@ void* BB::ArenaRealloc_f(BB_ARENA_DEBUG MemoryArena& a_arena, void* a_ptr, const
 void* BB::ArenaReallocNoZero_f(BB_ARENA_DEBUG MemoryArena& a_arena, void* a_ptr, const size_t a_ptr_size, const size_t a_memory_size, const uint32_t a_align)
 {
 #ifdef SANITIZER_ENABLED
-	constexpr size_t mem_debug_offset = sizeof(MemoryArenaAllocationInfo) + MEMORY_BOUNDRY_SIZE;
 	const size_t mem_end_offset = MEMORY_BOUNDRY_SIZE;
 #else
-	constexpr size_t mem_debug_offset = sizeof(MemoryArenaAllocationInfo);
 	const size_t mem_end_offset = 0;
 #endif // SANITIZER_ENABLED
 
@@ -269,16 +368,20 @@ void* BB::ArenaReallocNoZero_f(BB_ARENA_DEBUG MemoryArena& a_arena, void* a_ptr,
 		ChangeArenaAt(a_arena, Pointer::Add(a_ptr, a_memory_size));
 
 #ifdef _DEBUG_MEMORY
+		constexpr size_t mem_debug_offset = sizeof(MemoryArenaAllocationInfo) + mem_end_offset;
 		MemoryArenaAllocationInfo* debug_address = reinterpret_cast<MemoryArenaAllocationInfo*>(Pointer::Subtract(a_ptr, mem_debug_offset));
+		MemoryAccountingResize(debug_address->accounting_site, debug_address->alloc_size, a_memory_size);
 		debug_address->alloc_size = a_memory_size;
-#endif // _DEBUG
+#endif // _DEBUG_MEMORY
 
 		return a_ptr;
 	}
 	else
 	{
+#ifdef _DEBUG_MEMORY
 		(void)a_line;
 		(void)a_file;
+#endif // _DEBUG_MEMORY
 		(void)a_align;
 		BB_UNIMPLEMENTED("rest of realloc");
 		return nullptr;
@@ -1,6 +1,8 @@
 #include "MemoryInterfaces.hpp"
 #include "Logger.h"
 
+#include <bit>
+
 using namespace BB;
 
 void FreelistInterface::Initialize(MemoryArena& a_arena, size_t a_memory_size)
@@ -120,3 +122,358 @@ void FreelistInterface::Clear()
 	m_free_blocks->size = m_memory_size;
 	m_free_blocks->next = nullptr;
 }
+
+
+// TLSF, a first level for the power of two and a second level that splits it in SL_COUNT linear steps.
+// The table has a bitmap per level so finding a free block is two bit scans.
+constexpr size_t TLSF_ALIGNMENT = 16;
+constexpr uint32_t TLSF_SL_LOG2 = 5;
+constexpr uint32_t TLSF_SL_COUNT = 1 << TLSF_SL_LOG2;
+constexpr uint32_t TLSF_FL_SHIFT = TLSF_SL_LOG2 + 4; // 4 is log2 of the alignment
+constexpr uint32_t TLSF_FL_MAX = 40;
+constexpr uint32_t TLSF_FL_COUNT = TLSF_FL_MAX - TLSF_FL_SHIFT + 1;
+// below this the second level steps are TLSF_ALIGNMENT apart and every list holds one exact size.
+constexpr size_t TLSF_SMALL_BLOCK = size_t(1) << TLSF_FL_SHIFT;
+constexpr size_t TLSF_MAX_BLOCK = size_t(1) << TLSF_FL_MAX;
+
+using TLSFBlock = TLSFInterface::Block;
+constexpr size_t TLSF_HEADER = offsetof(TLSFBlock, next_free);
+constexpr size_t TLSF_MIN_PAYLOAD = sizeof(TLSFBlock) - TLSF_HEADER;
+static_assert(TLSF_HEADER == TLSF_ALIGNMENT, "TLSF block header must keep the payload aligned");
+static_assert(TLSF_FL_COUNT <= 32, "TLSF first level bitmap is 32 bits");
+
+struct TLSFInterface::Control
+{
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap[TLSF_FL_COUNT];
+	Block* blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+};
+
+static inline size_t TLSFBlockSize(const TLSFBlock* a_block)
+{
+	return a_block->size & ~size_t(1);
+}
+
+static inline bool TLSFBlockIsFree(const TLSFBlock* a_block)
+{
+	return (a_block->size & 1) != 0;
+}
+
+static inline void* TLSFBlockToPtr(TLSFBlock* a_block)
+{
+	return reinterpret_cast<uint8_t*>(a_block) + TLSF_HEADER;
+}
+
+static inline TLSFBlock* TLSFPtrToBlock(const void* a_ptr)
+{
+	return reinterpret_cast<TLSFBlock*>(const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(a_ptr)) - TLSF_HEADER);
+}
+
+static inline TLSFBlock* TLSFNextPhysical(TLSFBlock* a_block)
+{
+	return reinterpret_cast<TLSFBlock*>(reinterpret_cast<uint8_t*>(a_block) + TLSF_HEADER + TLSFBlockSize(a_block));
+}
+
+static inline size_t TLSFAdjustSize(const size_t a_size)
+{
+	const size_t size = (a_size + TLSF_ALIGNMENT - 1) & ~(TLSF_ALIGNMENT - 1);
+	return size < TLSF_MIN_PAYLOAD ? TLSF_MIN_PAYLOAD : size;
+}
+
+static inline void TLSFMappingInsert(const size_t a_size, uint32_t& a_fl, uint32_t& a_sl)
+{
+	if (a_size < TLSF_SMALL_BLOCK)
+	{
+		a_fl = 0;
+		a_sl = static_cast<uint32_t>(a_size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT));
+	}
+	else
+	{
+		const uint32_t fl = static_cast<uint32_t>(std::bit_width(a_size)) - 1;
+		a_sl = static_cast<uint32_t>(a_size >> (fl - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+		a_fl = fl - (TLSF_FL_SHIFT - 1);
+	}
+}
+
+// rounds up to the next list so that every block in the list that is found fits.
+static inline void TLSFMappingSearch(size_t a_size, uint32_t& a_fl, uint32_t& a_sl)
+{
+	if (a_size >= TLSF_SMALL_BLOCK)
+		a_size += (size_t(1) << (std::bit_width(a_size) - 1 - TLSF_SL_LOG2)) - 1;
+	TLSFMappingInsert(a_size, a_fl, a_sl);
+}
+
+static void* TLSFRealloc(BB_MEMORY_DEBUG_UNUSED void* a_allocator, size_t a_size, const size_t a_alignment, void* a_ptr)
+{
+	TLSFInterface* tlsf = reinterpret_cast<TLSFInterface*>(a_allocator);
+	if (a_size > 0)
+		return tlsf->Alloc(a_size, a_alignment);
+
+	tlsf->Free(a_ptr);
+	return nullptr;
+}
+
+TLSFInterface::operator Allocator()
+{
+	Allocator allocator_interface;
+	allocator_interface.allocator = this;
+	allocator_interface.func = TLSFRealloc;
+	return allocator_interface;
+}
+
+void TLSFInterface::Initialize(MemoryArena& a_arena, size_t a_memory_size)
+{
+	Initialize(ArenaAlloc(a_arena, a_memory_size, TLSF_ALIGNMENT), a_memory_size);
+}
+
+void TLSFInterface::Initialize(void* a_memory, size_t a_memory_size)
+{
+	m_start = reinterpret_cast<uint8_t*>(a_memory);
+	m_memory_size = a_memory_size;
+	Clear();
+}
+
+void* TLSFInterface::Alloc(size_t a_size, size_t a_alignment)
+{
+	BB_ASSERT(a_alignment != 0 && (a_alignment & (a_alignment - 1)) == 0, "TLSF alignment is not a power of 2");
+	const size_t size = TLSFAdjustSize(a_size);
+	if (size >= TLSF_MAX_BLOCK)
+		return nullptr;
+
+	Block* block;
+	if (a_alignment <= TLSF_ALIGNMENT)
+	{
+		block = FindFreeBlock(size);
+		if (block == nullptr)
+			return nullptr;
+	}
+	else
+	{
+		// room for the worst case gap in front, which has to be large enough to become a free block.
+		block = FindFreeBlock(size + a_alignment + sizeof(Block));
+		if (block == nullptr)
+			return nullptr;
+
+		const uintptr_t payload = reinterpret_cast<uintptr_t>(TLSFBlockToPtr(block));
+		uintptr_t aligned = (payload + a_alignment - 1) & ~(a_alignment - 1);
+		if (aligned != payload && aligned - payload < sizeof(Block))
+			aligned = (payload + sizeof(Block) + a_alignment - 1) & ~(a_alignment - 1);
+
+		const size_t gap = aligned - payload;
+		if (gap != 0)
+		{
+			Block* aligned_block = reinterpret_cast<Block*>(aligned - TLSF_HEADER);
+			aligned_block->prev_physical = block;
+			aligned_block->size = TLSFBlockSize(block) - gap;
+			TLSFNextPhysical(aligned_block)->prev_physical = aligned_block;
+
+			// the block in front of a free block is never free, so the gap does not need to merge.
+			block->size = gap - TLSF_HEADER;
+			InsertFreeBlock(block);
+			block = aligned_block;
+		}
+	}
+
+	block->size = TLSFBlockSize(block);
+	TrimUsedBlock(block, size);
+	m_used_size += TLSFBlockSize(block);
+	++m_allocation_count;
+	return TLSFBlockToPtr(block);
+}
+
+void* TLSFInterface::Realloc(void* a_ptr, size_t a_size, size_t a_alignment)
+{
+	if (a_ptr == nullptr)
+		return Alloc(a_size, a_alignment);
+	if (a_size == 0)
+	{
+		Free(a_ptr);
+		return nullptr;
+	}
+
+	Block* block = TLSFPtrToBlock(a_ptr);
+	BB_ASSERT(!TLSFBlockIsFree(block), "TLSF realloc on a freed pointer");
+	const size_t size = TLSFAdjustSize(a_size);
+	const size_t current_size = TLSFBlockSize(block);
+
+	Block* next = TLSFNextPhysical(block);
+	if (size > current_size)
+	{
+		if (!TLSFBlockIsFree(next) || current_size + TLSF_HEADER + TLSFBlockSize(next) < size)
+		{
+			void* new_ptr = Alloc(a_size, a_alignment);
+			if (new_ptr == nullptr)
+				return nullptr;
+			memcpy(new_ptr, a_ptr, current_size);
+			Free(a_ptr);
+			return new_ptr;
+		}
+
+		RemoveFreeBlock(next);
+		block->size = current_size + TLSF_HEADER + TLSFBlockSize(next);
+		TLSFNextPhysical(block)->prev_physical = block;
+	}
+
+	TrimUsedBlock(block, size);
+	m_used_size = m_used_size - current_size + TLSFBlockSize(block);
+	return a_ptr;
+}
+
+void TLSFInterface::Free(const void* a_ptr)
+{
+	BB_ASSERT(a_ptr != nullptr, "Nullptr send to TLSFInterface::Free!");
+	Block* block = TLSFPtrToBlock(a_ptr);
+	BB_ASSERT(!TLSFBlockIsFree(block), "TLSF double free");
+	m_used_size -= TLSFBlockSize(block);
+	--m_allocation_count;
+
+	Block* prev = block->prev_physical;
+	if (prev != nullptr && TLSFBlockIsFree(prev))
+	{
+		RemoveFreeBlock(prev);
+		prev->size = TLSFBlockSize(prev) + TLSF_HEADER + TLSFBlockSize(block);
+		block = prev;
+	}
+
+	Block* next = TLSFNextPhysical(block);
+	if (TLSFBlockIsFree(next))
+	{
+		RemoveFreeBlock(next);
+		block->size = TLSFBlockSize(block) + TLSF_HEADER + TLSFBlockSize(next);
+	}
+	TLSFNextPhysical(block)->prev_physical = block;
+	InsertFreeBlock(block);
+}
+
+void TLSFInterface::Clear()
+{
+	const uintptr_t start = reinterpret_cast<uintptr_t>(m_start);
+	m_control = reinterpret_cast<Control*>((start + alignof(Control) - 1) & ~(alignof(Control) - 1));
+	memset(m_control, 0, sizeof(Control));
+	m_used_size = 0;
+	m_allocation_count = 0;
+
+	const uintptr_t pool_start = (reinterpret_cast<uintptr_t>(m_control + 1) + TLSF_ALIGNMENT - 1) & ~(TLSF_ALIGNMENT - 1);
+	const uintptr_t pool_end = (start + m_memory_size) & ~(TLSF_ALIGNMENT - 1);
+	BB_ASSERT(pool_end > pool_start && pool_end - pool_start >= sizeof(Block) + TLSF_HEADER, "TLSF memory too small to hold the free list table");
+
+	// the last block is a used block of size 0 so that the real last block never looks past the pool.
+	Block* block = reinterpret_cast<Block*>(pool_start);
+	block->prev_physical = nullptr;
+	block->size = pool_end - pool_start - TLSF_HEADER * 2;
+	BB_ASSERT(block->size < TLSF_MAX_BLOCK, "TLSF memory larger then the largest block");
+
+	Block* end_block = TLSFNextPhysical(block);
+	end_block->prev_physical = block;
+	end_block->size = 0;
+	InsertFreeBlock(block);
+}
+
+TLSFStats TLSFInterface::GetStats() const
+{
+	TLSFStats stats{};
+	stats.used_size = m_used_size;
+	stats.allocation_count = m_allocation_count;
+	for (uint32_t fl = 0; fl < TLSF_FL_COUNT; fl++)
+	{
+		for (uint32_t sl = 0; sl < TLSF_SL_COUNT; sl++)
+		{
+			for (const Block* block = m_control->blocks[fl][sl]; block != nullptr; block = block->next_free)
+			{
+				const size_t size = TLSFBlockSize(block);
+				stats.free_size += size;
+				stats.largest_free_block = Max(stats.largest_free_block, size);
+				++stats.free_block_count;
+			}
+		}
+	}
+	return stats;
+}
+
+size_t TLSFInterface::GetAllocationSize(const void* a_ptr) const
+{
+	return TLSFBlockSize(TLSFPtrToBlock(a_ptr));
+}
+
+void TLSFInterface::InsertFreeBlock(Block* a_block)
+{
+	uint32_t fl, sl;
+	TLSFMappingInsert(TLSFBlockSize(a_block), fl, sl);
+	a_block->size |= 1;
+
+	Block* head = m_control->blocks[fl][sl];
+	a_block->next_free = head;
+	a_block->prev_free = nullptr;
+	if (head != nullptr)
+		head->prev_free = a_block;
+	m_control->blocks[fl][sl] = a_block;
+	m_control->fl_bitmap |= 1u << fl;
+	m_control->sl_bitmap[fl] |= 1u << sl;
+}
+
+void TLSFInterface::RemoveFreeBlock(Block* a_block)
+{
+	uint32_t fl, sl;
+	TLSFMappingInsert(TLSFBlockSize(a_block), fl, sl);
+
+	if (a_block->next_free != nullptr)
+		a_block->next_free->prev_free = a_block->prev_free;
+	if (a_block->prev_free != nullptr)
+		a_block->prev_free->next_free = a_block->next_free;
+
+	if (m_control->blocks[fl][sl] == a_block)
+	{
+		m_control->blocks[fl][sl] = a_block->next_free;
+		if (a_block->next_free == nullptr)
+		{
+			m_control->sl_bitmap[fl] &= ~(1u << sl);
+			if (m_control->sl_bitmap[fl] == 0)
+				m_control->fl_bitmap &= ~(1u << fl);
+		}
+	}
+}
+
+TLSFInterface::Block* TLSFInterface::FindFreeBlock(size_t a_size)
+{
+	uint32_t fl, sl;
+	TLSFMappingSearch(a_size, fl, sl);
+	if (fl >= TLSF_FL_COUNT)
+		return nullptr;
+
+	uint32_t sl_map = m_control->sl_bitmap[fl] & (~0u << sl);
+	if (sl_map == 0)
+	{
+		const uint32_t fl_map = fl + 1 < TLSF_FL_COUNT ? m_control->fl_bitmap & (~0u << (fl + 1)) : 0;
+		if (fl_map == 0)
+			return nullptr;
+		fl = static_cast<uint32_t>(std::countr_zero(fl_map));
+		sl_map = m_control->sl_bitmap[fl];
+	}
+	sl = static_cast<uint32_t>(std::countr_zero(sl_map));
+
+	Block* block = m_control->blocks[fl][sl];
+	RemoveFreeBlock(block);
+	return block;
+}
+
+void TLSFInterface::TrimUsedBlock(Block* a_block, size_t a_size)
+{
+	const size_t block_size = TLSFBlockSize(a_block);
+	if (block_size < a_size + sizeof(Block))
+		return;
+
+	Block* remainder = reinterpret_cast<Block*>(reinterpret_cast<uint8_t*>(TLSFBlockToPtr(a_block)) + a_size);
+	remainder->prev_physical = a_block;
+	remainder->size = block_size - a_size - TLSF_HEADER;
+	a_block->size = a_size;
+
+	Block* next = TLSFNextPhysical(remainder);
+	if (TLSFBlockIsFree(next))
+	{
+		RemoveFreeBlock(next);
+		remainder->size = TLSFBlockSize(remainder) + TLSF_HEADER + TLSFBlockSize(next);
+		next = TLSFNextPhysical(remainder);
+	}
+	next->prev_physical = remainder;
+	InsertFreeBlock(remainder);
+}
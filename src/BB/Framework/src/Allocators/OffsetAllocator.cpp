@@ -0,0 +1,286 @@
+#include "OffsetAllocator.hpp"
+#include "MemoryArena.hpp"
+#include "Logger.h"
+
+#include <bit>
+
+using namespace BB;
+
+constexpr uint32_t NO_NODE = UINT32_MAX;
+constexpr uint32_t NO_BIT = UINT32_MAX;
+
+// sizes are binned as a small float, 3 mantissa bits and a 5 bit exponent.
+// every power of 2 is split up into 8 bins, so a bin wastes at most 12.5% of an allocation.
+constexpr uint32_t MANTISSA_BITS = 3;
+constexpr uint32_t MANTISSA_VALUE = 1 << MANTISSA_BITS;
+constexpr uint32_t MANTISSA_MASK = MANTISSA_VALUE - 1;
+
+static uint32_t SizeToBinRoundUp(const uint32_t a_size)
+{
+	if (a_size < MANTISSA_VALUE)
+		return a_size;
+
+	const uint32_t highest_bit = 31 - static_cast<uint32_t>(std::countl_zero(a_size));
+	const uint32_t mantissa_start_bit = highest_bit - MANTISSA_BITS;
+	const uint32_t exponent = mantissa_start_bit + 1;
+	uint32_t mantissa = (a_size >> mantissa_start_bit) & MANTISSA_MASK;
+
+	// round up so that every region in the bin fits the size, a mantissa overflow moves into the next exponent.
+	const uint32_t low_bits_mask = (1u << mantissa_start_bit) - 1;
+	if ((a_size & low_bits_mask) != 0)
+		++mantissa;
+
+	return (exponent << MANTISSA_BITS) + mantissa;
+}
+
+static uint32_t SizeToBinRoundDown(const uint32_t a_size)
+{
+	if (a_size < MANTISSA_VALUE)
+		return a_size;
+
+	const uint32_t highest_bit = 31 - static_cast<uint32_t>(std::countl_zero(a_size));
+	const uint32_t mantissa_start_bit = highest_bit - MANTISSA_BITS;
+	const uint32_t exponent = mantissa_start_bit + 1;
+	const uint32_t mantissa = (a_size >> mantissa_start_bit) & MANTISSA_MASK;
+	return (exponent << MANTISSA_BITS) | mantissa;
+}
+
+static uint32_t FindLowestSetBitAfter(const uint32_t a_mask, const uint32_t a_start_bit)
+{
+	if (a_start_bit >= 32)
+		return NO_BIT;
+	const uint32_t mask = a_mask & ~((1u << a_start_bit) - 1);
+	if (mask == 0)
+		return NO_BIT;
+	return static_cast<uint32_t>(std::countr_zero(mask));
+}
+
+void OffsetAllocator::Init(MemoryArena& a_arena, const uint32_t a_size, const uint32_t a_max_nodes)
+{
+	BB_ASSERT(a_max_nodes > 1, "offset allocator needs at least 2 nodes");
+	m_size = a_size;
+	m_max_nodes = a_max_nodes;
+	m_nodes = ArenaAllocArr(a_arena, Node, a_max_nodes);
+	m_free_nodes = ArenaAllocArr(a_arena, uint32_t, a_max_nodes);
+	Reset();
+}
+
+void OffsetAllocator::Reset()
+{
+	m_free_storage = 0;
+	m_allocation_count = 0;
+	m_used_bins_top = 0;
+	for (uint32_t i = 0; i < _countof(m_used_bins); i++)
+		m_used_bins[i] = 0;
+	for (uint32_t i = 0; i < OFFSET_ALLOCATOR_BIN_COUNT; i++)
+		m_bin_heads[i] = NO_NODE;
+
+	// pop from the back so the first nodes are used first.
+	m_free_node_count = m_max_nodes;
+	for (uint32_t i = 0; i < m_max_nodes; i++)
+		m_free_nodes[i] = m_max_nodes - i - 1;
+
+	InsertFreeNode(0, m_size);
+}
+
+OffsetAllocation OffsetAllocator::Allocate(const uint32_t a_size)
+{
+	// a split needs a node for the remainder.
+	if (a_size == 0 || m_free_node_count < 1)
+		return OffsetAllocation();
+
+	const uint32_t min_bin = SizeToBinRoundUp(a_size);
+	uint32_t top_bin = min_bin >> MANTISSA_BITS;
+	uint32_t leaf_bin = NO_BIT;
+
+	if (m_used_bins_top & (1u << top_bin))
+		leaf_bin = FindLowestSetBitAfter(m_used_bins[top_bin], min_bin & MANTISSA_MASK);
+
+	// nothing in the top bin of the size, take the smallest bin of the next non empty top bin.
+	if (leaf_bin == NO_BIT)
+	{
+		top_bin = FindLowestSetBitAfter(m_used_bins_top, top_bin + 1);
+		if (top_bin == NO_BIT)
+			return OffsetAllocation();
+		leaf_bin = static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(m_used_bins[top_bin])));
+	}
+
+	const uint32_t bin = (top_bin << MANTISSA_BITS) | leaf_bin;
+	return AllocateFromFreeNode(m_bin_heads[bin], a_size);
+}
+
+OffsetAllocation OffsetAllocator::AllocateFromFreeNode(const uint32_t a_node, const uint32_t a_size)
+{
+	const uint32_t node_index = a_node;
+	Node& node = m_nodes[node_index];
+	const uint32_t region_size = node.size;
+	RemoveFreeNode(node_index);
+
+	node.used = true;
+	node.size = a_size;
+
+	const uint32_t remainder = region_size - a_size;
+	if (remainder > 0)
+	{
+		const uint32_t new_node_index = InsertFreeNode(node.offset + a_size, remainder);
+		Node& new_node = m_nodes[new_node_index];
+
+		// the remainder sits between the allocation and its old next neighbour.
+		if (node.neighbour_next != NO_NODE)
+			m_nodes[node.neighbour_next].neighbour_prev = new_node_index;
+		new_node.neighbour_prev = node_index;
+		new_node.neighbour_next = node.neighbour_next;
+		node.neighbour_next = new_node_index;
+	}
+
+	++m_allocation_count;
+	OffsetAllocation allocation;
+	allocation.offset = node.offset;
+	allocation.node = node_index;
+	return allocation;
+}
+
+void OffsetAllocator::Free(const OffsetAllocation a_allocation)
+{
+	BB_ASSERT(a_allocation.IsValid() && a_allocation.node < m_max_nodes, "invalid offset allocation");
+	const Node& node = m_nodes[a_allocation.node];
+	BB_ASSERT(node.used && node.offset == a_allocation.offset, "offset allocation is already freed");
+
+	uint32_t offset = node.offset;
+	uint32_t size = node.size;
+	uint32_t neighbour_prev = node.neighbour_prev;
+	uint32_t neighbour_next = node.neighbour_next;
+
+	// merge with the free regions around it, they are never next to another free region.
+	if (neighbour_prev != NO_NODE && !m_nodes[neighbour_prev].used)
+	{
+		const Node& prev = m_nodes[neighbour_prev];
+		offset = prev.offset;
+		size += prev.size;
+		RemoveFreeNode(neighbour_prev);
+		m_free_nodes[m_free_node_count++] = neighbour_prev;
+		neighbour_prev = prev.neighbour_prev;
+	}
+
+	if (neighbour_next != NO_NODE && !m_nodes[neighbour_next].used)
+	{
+		const Node& next = m_nodes[neighbour_next];
+		size += next.size;
+		RemoveFreeNode(neighbour_next);
+		m_free_nodes[m_free_node_count++] = neighbour_next;
+		neighbour_next = next.neighbour_next;
+	}
+
+	m_free_nodes[m_free_node_count++] = a_allocation.node;
+
+	const uint32_t merged_index = InsertFreeNode(offset, size);
+	Node& merged = m_nodes[merged_index];
+	merged.neighbour_prev = neighbour_prev;
+	merged.neighbour_next = neighbour_next;
+	if (neighbour_prev != NO_NODE)
+		m_nodes[neighbour_prev].neighbour_next = merged_index;
+	if (neighbour_next != NO_NODE)
+		m_nodes[neighbour_next].neighbour_prev = merged_index;
+
+	--m_allocation_count;
+}
+
+OffsetAllocation OffsetAllocator::AllocateLower(const OffsetAllocation a_allocation)
+{
+	const uint32_t size = GetAllocationSize(a_allocation);
+	if (m_free_node_count < 1)
+		return OffsetAllocation();
+
+	// the neighbours are in address order, the last free region that fits before reaching the start is the lowest one.
+	uint32_t lowest = NO_NODE;
+	for (uint32_t node = m_nodes[a_allocation.node].neighbour_prev; node != NO_NODE; node = m_nodes[node].neighbour_prev)
+	{
+		if (!m_nodes[node].used && m_nodes[node].size >= size)
+			lowest = node;
+	}
+
+	if (lowest == NO_NODE)
+		return OffsetAllocation();
+	return AllocateFromFreeNode(lowest, size);
+}
+
+uint32_t OffsetAllocator::GetAllocationSize(const OffsetAllocation a_allocation) const
+{
+	BB_ASSERT(a_allocation.IsValid() && a_allocation.node < m_max_nodes, "invalid offset allocation");
+	return m_nodes[a_allocation.node].size;
+}
+
+OffsetAllocatorReport OffsetAllocator::GetReport() const
+{
+	OffsetAllocatorReport report;
+	report.total_free = m_free_storage;
+	report.largest_free = 0;
+	report.allocation_count = m_allocation_count;
+	report.free_region_count = 0;
+
+	for (uint32_t bin = 0; bin < OFFSET_ALLOCATOR_BIN_COUNT; bin++)
+	{
+		for (uint32_t node = m_bin_heads[bin]; node != NO_NODE; node = m_nodes[node].bin_next)
+		{
+			report.largest_free = Max(report.largest_free, m_nodes[node].size);
+			++report.free_region_count;
+		}
+	}
+	return report;
+}
+
+uint32_t OffsetAllocator::InsertFreeNode(const uint32_t a_offset, const uint32_t a_size)
+{
+	BB_ASSERT(m_free_node_count > 0, "offset allocator is out of nodes");
+	const uint32_t bin = SizeToBinRoundDown(a_size);
+	const uint32_t top_bin = bin >> MANTISSA_BITS;
+	const uint32_t leaf_bin = bin & MANTISSA_MASK;
+
+	if (m_bin_heads[bin] == NO_NODE)
+	{
+		m_used_bins[top_bin] |= static_cast<uint8_t>(1u << leaf_bin);
+		m_used_bins_top |= 1u << top_bin;
+	}
+
+	const uint32_t node_index = m_free_nodes[--m_free_node_count];
+	Node& node = m_nodes[node_index];
+	node.offset = a_offset;
+	node.size = a_size;
+	node.bin_prev = NO_NODE;
+	node.bin_next = m_bin_heads[bin];
+	node.neighbour_prev = NO_NODE;
+	node.neighbour_next = NO_NODE;
+	node.used = false;
+	if (node.bin_next != NO_NODE)
+		m_nodes[node.bin_next].bin_prev = node_index;
+	m_bin_heads[bin] = node_index;
+
+	m_free_storage += a_size;
+	return node_index;
+}
+
+void OffsetAllocator::RemoveFreeNode(const uint32_t a_node)
+{
+	const Node& node = m_nodes[a_node];
+	if (node.bin_prev != NO_NODE)
+		m_nodes[node.bin_prev].bin_next = node.bin_next;
+	if (node.bin_next != NO_NODE)
+		m_nodes[node.bin_next].bin_prev = node.bin_prev;
+
+	if (node.bin_prev == NO_NODE)
+	{
+		// the node was the bin head, clear the bin bits when it is now empty.
+		const uint32_t bin = SizeToBinRoundDown(node.size);
+		m_bin_heads[bin] = node.bin_next;
+		if (node.bin_next == NO_NODE)
+		{
+			const uint32_t top_bin = bin >> MANTISSA_BITS;
+			const uint32_t leaf_bin = bin & MANTISSA_MASK;
+			m_used_bins[top_bin] &= static_cast<uint8_t>(~(1u << leaf_bin));
+			if (m_used_bins[top_bin] == 0)
+				m_used_bins_top &= ~(1u << top_bin);
+		}
+	}
+
+	m_free_storage -= node.size;
+}
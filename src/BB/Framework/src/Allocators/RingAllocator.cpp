@@ -1,5 +1,6 @@
 #include "RingAllocator.h"
 #include "BackingAllocator.h"
+#include "Program.h"
 
 using namespace BB;
 
@@ -75,36 +76,26 @@ LocalRingAllocator::operator BB::Allocator()
 
 LocalRingAllocator::LocalRingAllocator(size_t& a_size)
 {
-	m_BufferPos = mallocVirtual(nullptr, a_size, VIRTUAL_RESERVE_NONE);
+	m_buffer = OSCreateMirroredMemory(a_size);
+	BB_ASSERT(m_buffer != nullptr, "failed to create mirrored memory for the ring allocator");
 
 	m_size = a_size;
-	m_Used = 0;
+	m_position = 0;
 }
 
 LocalRingAllocator::~LocalRingAllocator()
 {
-	m_BufferPos = Pointer::Subtract(m_BufferPos, m_Used);
-	freeVirtual(m_BufferPos);
+	OSFreeMirroredMemory(m_buffer, m_size);
 }
 
 void* LocalRingAllocator::Alloc(size_t a_size, size_t a_alignment)
 {
-	size_t t_Adjustment = Pointer::AlignForwardAdjustment(m_BufferPos, a_alignment);
-	size_t t_AdjustedSize = a_size + a_alignment;
-	//Go back to the buffer start if we cannot fill this allocation.
-	if (m_Used + t_AdjustedSize > m_size)
-	{
-		BB_ASSERT(m_size > t_AdjustedSize,
-			"Ring allocator tries to allocate something bigger then it's allocator size!");
-
-		m_BufferPos = Pointer::Subtract(m_BufferPos, m_Used);
-		m_Used = 0;
-		return Alloc(a_size, a_alignment);
-	}
-
-	void* t_ReturnPtr = Pointer::Add(m_BufferPos, t_Adjustment);
-	m_BufferPos = Pointer::Add(m_BufferPos, t_AdjustedSize);
-	m_Used += t_AdjustedSize;
-
-	return t_ReturnPtr;
+	void* position = Pointer::Add(m_buffer, m_position);
+	const size_t adjustment = Pointer::AlignForwardAdjustment(position, a_alignment);
+	BB_ASSERT(m_size >= a_size + adjustment,
+		"Ring allocator tries to allocate something bigger then it's allocator size!");
+
+	//no going back to the start when it does not fit, the mirror behind the buffer makes the allocation continue there.
+	m_position = (m_position + adjustment + a_size) % m_size;
+	return Pointer::Add(position, adjustment);
 }
@@ -0,0 +1,344 @@
+#include "SmallObjectAllocator.hpp"
+#include "Program.h"
+#include "Logger.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <thread>
+
+using namespace BB;
+
+constexpr uint16_t SMALL_OBJECT_SIZES[SMALL_OBJECT_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512,
+	640, 768, 896, 1024 };
+static_assert(SMALL_OBJECT_SIZES[SMALL_OBJECT_CLASS_COUNT - 1] == SMALL_OBJECT_MAX_SIZE);
+
+// spans are aligned to their size so a free finds the size class in the span header by masking the pointer.
+constexpr size_t SMALL_OBJECT_SPAN_SIZE = 64 * kbSize;
+constexpr size_t SMALL_OBJECT_SPAN_HEADER = 16;
+// spans are taken from the arena a chunk at a time so the arena's own alignment padding is paid once per chunk.
+constexpr size_t SMALL_OBJECT_SPAN_CHUNK_SIZE = SMALL_OBJECT_SPAN_SIZE * 16;
+
+struct SpanHeader
+{
+	uint32_t size_class;
+	uint32_t object_size;
+};
+static_assert(sizeof(SpanHeader) <= SMALL_OBJECT_SPAN_HEADER);
+
+// a free object links the next object in its list, the first object of a depot batch also links the next batch.
+struct FreeObject
+{
+	FreeObject* next;
+	FreeObject* next_batch;
+};
+
+struct alignas(64) SmallObjectAllocator::SizeClass
+{
+	BBRWLock lock;
+	FreeObject* batches;
+	size_t object_count;
+	uint8_t* span_pos;
+	uint8_t* span_end;
+};
+
+// every thread slot has its own cache line aligned cache, only the thread that owns the slot touches it.
+struct alignas(64) SmallObjectAllocator::ThreadCache
+{
+	struct List
+	{
+		FreeObject* head;
+		uint32_t count;
+	};
+	List lists[SMALL_OBJECT_CLASS_COUNT];
+};
+
+// objects moved between a thread cache and the depot in one go, around 4kb worth.
+static constexpr uint32_t BatchSize(const uint32_t a_class)
+{
+	const uint32_t count = 4096 / SMALL_OBJECT_SIZES[a_class];
+	return count < 4 ? 4 : count > 64 ? 64 : count;
+}
+
+static constexpr std::array<uint8_t, SMALL_OBJECT_MAX_SIZE / 16> SIZE_TO_CLASS = []()
+{
+	std::array<uint8_t, SMALL_OBJECT_MAX_SIZE / 16> table{};
+	uint8_t size_class = 0;
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		while (SMALL_OBJECT_SIZES[size_class] < (i + 1) * 16)
+			++size_class;
+		table[i] = size_class;
+	}
+	return table;
+}();
+
+static inline uint32_t SizeToClass(const size_t a_size)
+{
+	return SIZE_TO_CLASS[(Max(a_size, size_t(1)) + 15) / 16 - 1];
+}
+
+static inline const SpanHeader* GetSpanHeader(const void* a_ptr)
+{
+	return reinterpret_cast<const SpanHeader*>(reinterpret_cast<uintptr_t>(a_ptr) & ~(SMALL_OBJECT_SPAN_SIZE - 1));
+}
+
+// thread slots are shared by every SmallObjectAllocator, a thread takes one on first use and gives it back when it exits.
+// the next thread on that slot gets the cache with whatever was left in it.
+static std::atomic<uint64_t> s_thread_slots{ 0 };
+static_assert(SMALL_OBJECT_MAX_THREADS <= 64, "thread slots are a 64 bit mask");
+
+struct ThreadSlot
+{
+	uint32_t index = UINT32_MAX;
+	~ThreadSlot()
+	{
+		if (index != UINT32_MAX)
+			s_thread_slots.fetch_and(~(uint64_t(1) << index), std::memory_order_release);
+	}
+};
+static thread_local ThreadSlot s_thread_slot;
+
+static uint32_t GetThreadSlot()
+{
+	if (s_thread_slot.index != UINT32_MAX)
+		return s_thread_slot.index;
+
+	uint64_t used = s_thread_slots.load(std::memory_order_relaxed);
+	bool warned = false;
+	while (true)
+	{
+		if (used == UINT64_MAX)
+		{
+			if (!warned)
+			{
+				BB_WARNING(false, "more then SMALL_OBJECT_MAX_THREADS threads use the small object allocator, waiting for one to exit", WarningType::HIGH);
+				warned = true;
+			}
+			std::this_thread::yield();
+			used = s_thread_slots.load(std::memory_order_relaxed);
+			continue;
+		}
+		const uint32_t index = static_cast<uint32_t>(std::countr_zero(~used));
+		if (s_thread_slots.compare_exchange_weak(used, used | (uint64_t(1) << index), std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			s_thread_slot.index = index;
+			return index;
+		}
+	}
+}
+
+static void* SmallObjectRealloc(BB_MEMORY_DEBUG_UNUSED void* a_allocator, size_t a_size, const size_t a_alignment, void* a_ptr)
+{
+	SmallObjectAllocator* allocator = reinterpret_cast<SmallObjectAllocator*>(a_allocator);
+	if (a_size > 0)
+		return allocator->Alloc(a_size, a_alignment);
+
+	allocator->Free(a_ptr);
+	return nullptr;
+}
+
+SmallObjectAllocator::operator Allocator()
+{
+	Allocator allocator_interface;
+	allocator_interface.allocator = this;
+	allocator_interface.func = SmallObjectRealloc;
+	return allocator_interface;
+}
+
+void SmallObjectAllocator::Init(const size_t a_reserve_size)
+{
+	m_arena = MemoryArenaCreate(a_reserve_size);
+	m_span_lock = OSCreateRWLock();
+	m_span_chunk_pos = nullptr;
+	m_span_chunk_end = nullptr;
+	m_span_count = 0;
+
+	m_classes = ArenaAllocArr(m_arena, SizeClass, SMALL_OBJECT_CLASS_COUNT);
+	for (uint32_t i = 0; i < SMALL_OBJECT_CLASS_COUNT; i++)
+	{
+		m_classes[i].lock = OSCreateRWLock();
+		m_classes[i].batches = nullptr;
+		m_classes[i].object_count = 0;
+		m_classes[i].span_pos = nullptr;
+		m_classes[i].span_end = nullptr;
+	}
+	m_caches = ArenaAllocArr(m_arena, ThreadCache, SMALL_OBJECT_MAX_THREADS);
+}
+
+void SmallObjectAllocator::Destroy()
+{
+	MemoryArenaFree(m_arena);
+	m_classes = nullptr;
+	m_caches = nullptr;
+}
+
+void* SmallObjectAllocator::Alloc(const size_t a_size, const size_t a_alignment)
+{
+	BB_ASSERT(a_alignment <= 16, "small object allocator only aligns to 16 bytes");
+	if (a_size > SMALL_OBJECT_MAX_SIZE)
+	{
+		BB_ASSERT(false, "allocation too large for the small object allocator");
+		return nullptr;
+	}
+
+	const uint32_t size_class = SizeToClass(a_size);
+	ThreadCache& cache = m_caches[GetThreadSlot()];
+	ThreadCache::List& list = cache.lists[size_class];
+	if (list.head == nullptr)
+		return RefillCache(size_class, cache);
+
+	FreeObject* object = list.head;
+	list.head = object->next;
+	--list.count;
+	return object;
+}
+
+void SmallObjectAllocator::Free(const void* a_ptr)
+{
+	BB_ASSERT(a_ptr != nullptr, "Nullptr send to SmallObjectAllocator::Free!");
+	const uint32_t size_class = GetSpanHeader(a_ptr)->size_class;
+	ThreadCache& cache = m_caches[GetThreadSlot()];
+	ThreadCache::List& list = cache.lists[size_class];
+
+	FreeObject* object = reinterpret_cast<FreeObject*>(const_cast<void*>(a_ptr));
+	object->next = list.head;
+	list.head = object;
+	// keep a batch around after releasing one, so alternating alloc and free on the edge does not hit the depot every time.
+	if (++list.count >= BatchSize(size_class) * 2)
+		ReleaseBatch(size_class, cache);
+}
+
+void SmallObjectAllocator::FlushThreadCache()
+{
+	ThreadCache& cache = m_caches[GetThreadSlot()];
+	for (uint32_t i = 0; i < SMALL_OBJECT_CLASS_COUNT; i++)
+	{
+		ThreadCache::List& list = cache.lists[i];
+		if (list.head == nullptr)
+			continue;
+
+		SizeClass& size_class = m_classes[i];
+		BBRWLockScopeWrite lock(size_class.lock);
+		list.head->next_batch = size_class.batches;
+		size_class.batches = list.head;
+		list.head = nullptr;
+		list.count = 0;
+	}
+}
+
+SmallObjectAllocatorStats SmallObjectAllocator::GetStats()
+{
+	SmallObjectAllocatorStats stats{};
+	{
+		BBRWLockScopeWrite lock(m_span_lock);
+		stats.span_count = m_span_count;
+	}
+	for (uint32_t i = 0; i < SMALL_OBJECT_CLASS_COUNT; i++)
+	{
+		BBRWLockScopeWrite lock(m_classes[i].lock);
+		stats.object_count += m_classes[i].object_count;
+		for (const FreeObject* batch = m_classes[i].batches; batch != nullptr; batch = batch->next_batch)
+			for (const FreeObject* object = batch; object != nullptr; object = object->next)
+				++stats.depot_object_count;
+	}
+	return stats;
+}
+
+size_t SmallObjectAllocator::GetAllocationSize(const void* a_ptr)
+{
+	return GetSpanHeader(a_ptr)->object_size;
+}
+
+void* SmallObjectAllocator::RefillCache(const uint32_t a_class, ThreadCache& a_cache)
+{
+	SizeClass& size_class = m_classes[a_class];
+	FreeObject* batch = nullptr;
+	{
+		BBRWLockScopeWrite lock(size_class.lock);
+		if (size_class.batches != nullptr)
+		{
+			batch = size_class.batches;
+			size_class.batches = batch->next_batch;
+		}
+		else
+		{
+			// nothing was freed back yet, cut a new batch out of the span.
+			const size_t object_size = SMALL_OBJECT_SIZES[a_class];
+			for (uint32_t i = 0; i < BatchSize(a_class); i++)
+			{
+				if (size_class.span_pos + object_size > size_class.span_end)
+				{
+					uint8_t* span = reinterpret_cast<uint8_t*>(AllocateSpan(a_class));
+					if (span == nullptr)
+						break;
+					size_class.span_pos = span + SMALL_OBJECT_SPAN_HEADER;
+					size_class.span_end = span + SMALL_OBJECT_SPAN_SIZE;
+				}
+				FreeObject* object = reinterpret_cast<FreeObject*>(size_class.span_pos);
+				size_class.span_pos += object_size;
+				++size_class.object_count;
+				object->next = batch;
+				batch = object;
+			}
+		}
+	}
+	if (batch == nullptr)
+		return nullptr;
+
+	// the first one is returned, the rest goes in the cache.
+	ThreadCache::List& list = a_cache.lists[a_class];
+	list.head = batch->next;
+	list.count = 0;
+	for (const FreeObject* object = list.head; object != nullptr; object = object->next)
+		++list.count;
+	return batch;
+}
+
+void SmallObjectAllocator::ReleaseBatch(const uint32_t a_class, ThreadCache& a_cache)
+{
+	ThreadCache::List& list = a_cache.lists[a_class];
+	const uint32_t batch_size = BatchSize(a_class);
+
+	FreeObject* batch = list.head;
+	FreeObject* last = batch;
+	for (uint32_t i = 1; i < batch_size; i++)
+		last = last->next;
+	list.head = last->next;
+	list.count -= batch_size;
+	last->next = nullptr;
+
+	SizeClass& size_class = m_classes[a_class];
+	BBRWLockScopeWrite lock(size_class.lock);
+	batch->next_batch = size_class.batches;
+	size_class.batches = batch;
+}
+
+void* SmallObjectAllocator::AllocateSpan(const uint32_t a_class)
+{
+	uint8_t* span;
+	{
+		BBRWLockScopeWrite lock(m_span_lock);
+		if (m_span_chunk_pos == m_span_chunk_end)
+		{
+			m_span_chunk_pos = reinterpret_cast<uint8_t*>(ArenaAllocNoZero(m_arena, SMALL_OBJECT_SPAN_CHUNK_SIZE, SMALL_OBJECT_SPAN_SIZE));
+			if (m_span_chunk_pos == nullptr)
+			{
+				m_span_chunk_end = nullptr;
+				return nullptr;
+			}
+			m_span_chunk_end = m_span_chunk_pos + SMALL_OBJECT_SPAN_CHUNK_SIZE;
+		}
+		span = m_span_chunk_pos;
+		m_span_chunk_pos += SMALL_OBJECT_SPAN_SIZE;
+		++m_span_count;
+	}
+
+	SpanHeader* header = reinterpret_cast<SpanHeader*>(span);
+	header->size_class = a_class;
+	header->object_size = SMALL_OBJECT_SIZES[a_class];
+	return span;
+}
@@ -4,6 +4,9 @@
 
 using namespace BB;
 
+// memory for framework systems that live as long as the program.
+static MemoryArena s_bb_arena;
+
 void BB::InitBB(const BBInitInfo& a_bb_info)
 {
 	g_program_name = a_bb_info.program_name;
@@ -17,6 +20,9 @@ void BB::InitBB(const BBInitInfo& a_bb_info)
 		LatestOSError();
 
 	InitProgram();
+
+	s_bb_arena = MemoryArenaCreate();
+	InitStringAtomTable(s_bb_arena, a_bb_info.string_atom_max, a_bb_info.string_atom_memory, a_bb_info.string_atom_transient_max);
 }
 
 void BB::DestroyBB()
@@ -40,8 +40,9 @@ struct ThreadInfo
 {
 	void(*function)(MemoryArena& a_thread_arena, void*);
 	void* function_parameter;
-	THREAD_STATUS thread_status;
-	//debug value for the ThreadHandle extra_index;
+	std::atomic<THREAD_STATUS> thread_status;
+	// protects thread_status changes to and from IDLE, held by the worker except while waiting on the condition.
+	BBRWLock lock;
 	BBConditionalVariable condition;
 	const wchar_t* task_name;
 	std::atomic<uint32_t> generation;
@@ -66,23 +67,33 @@ static ThreadScheduler s_thread_scheduler{};
 static void ThreadStartFunc(void* a_args)
 {
 	ThreadInfo* thread_info = reinterpret_cast<ThreadInfo*>(a_args);
-	thread_info->arena = MemoryArenaCreate();
-	BBRWLock lock = OSCreateRWLock();
-	OSAcquireSRWLockWrite(&lock);
+	// asset loading runs on these, a gltf load can take hundreds of mb for a moment.
+	thread_info->arena = MemoryArenaCreate(ARENA_DEFAULT_RESERVE, true);
 	MemoryArenaMarker mem_start = MemoryArenaGetMemoryMarker(thread_info->arena);
 
-	while (thread_info->thread_status != THREAD_STATUS::DESTROY)
+	OSAcquireSRWLockWrite(&thread_info->lock);
+	while (true)
 	{
-		OSWaitConditionalVariableExclusive(&thread_info->condition, &lock);
+		// loop to handle spurious wakeups, the status is only changed while holding the lock.
+		while (thread_info->thread_status == THREAD_STATUS::IDLE)
+			OSWaitConditionalVariableExclusive(&thread_info->condition, &thread_info->lock);
+		if (thread_info->thread_status == THREAD_STATUS::DESTROY)
+			break;
+		OSReleaseSRWLockWrite(&thread_info->lock);
+
 		OSSetThreadName(thread_info->task_name);
 		thread_info->function(thread_info->arena, thread_info->function_parameter);
 		thread_info->function = nullptr;
 		thread_info->function_parameter = nullptr;
-		++thread_info->generation;
 		OSSetThreadName(L"none");
-		thread_info->thread_status = THREAD_STATUS::IDLE;
 		MemoryArenaSetMemoryMarker(thread_info->arena, mem_start);
+
+		OSAcquireSRWLockWrite(&thread_info->lock);
+		++thread_info->generation;
+		if (thread_info->thread_status == THREAD_STATUS::BUSY)
+			thread_info->thread_status = THREAD_STATUS::IDLE;
 	}
+	OSReleaseSRWLockWrite(&thread_info->lock);
 }
 #pragma optimize( "", on )
 
@@ -102,6 +113,7 @@ void BB::Threads::InitThreads(const uint32_t a_thread_count)
 		s_thread_scheduler.threads[i].thread_info.function_parameter = nullptr;
 		s_thread_scheduler.threads[i].thread_info.thread_status = THREAD_STATUS::IDLE;
 		s_thread_scheduler.threads[i].thread_info.generation = 1;
+		s_thread_scheduler.threads[i].thread_info.lock = OSCreateRWLock();
 		s_thread_scheduler.threads[i].thread_info.condition = OSCreateConditionalVariable();
 		s_thread_scheduler.threads[i].os_thread_handle = OSCreateThread(ThreadStartFunc,
 			0,
@@ -113,11 +125,15 @@ void BB::Threads::DestroyThreads()
 {
 	for (uint32_t i = 0; i < s_thread_scheduler.thread_count; i++)
 	{
-		s_thread_scheduler.threads[i].thread_info.thread_status = THREAD_STATUS::DESTROY;
+		ThreadInfo& thread_info = s_thread_scheduler.threads[i].thread_info;
+		OSAcquireSRWLockWrite(&thread_info.lock);
+		thread_info.thread_status = THREAD_STATUS::DESTROY;
+		OSWakeConditionVariable(&thread_info.condition);
+		OSReleaseSRWLockWrite(&thread_info.lock);
 	}
 }
 
-ThreadTask BB::Threads::StartTaskThread(void(*a_function)(MemoryArena&, void*), void* a_func_parameter, const size_t a_func_parameter_size, const wchar_t* a_task_name)
+ThreadTask BB::Threads::TryStartTaskThread(void(*a_function)(MemoryArena&, void*), void* a_func_parameter, const size_t a_func_parameter_size, const wchar_t* a_task_name)
 {
 	if (FORCE_SINGLE_THREAD)
 	{
@@ -127,25 +143,39 @@ ThreadTask BB::Threads::StartTaskThread(void(*a_function)(MemoryArena&, void*),
 		}
 		return ThreadTask(0);
 	}
-	else
+
+	for (uint32_t i = 0; i < s_thread_scheduler.thread_count; i++)
 	{
-		for (uint32_t i = 0; i < s_thread_scheduler.thread_count; i++)
+		ThreadInfo& thread_info = s_thread_scheduler.threads[i].thread_info;
+		if (thread_info.thread_status != THREAD_STATUS::IDLE)
+			continue;
+
+		// tasks can be started from multiple threads, so check again while holding the lock.
+		OSAcquireSRWLockWrite(&thread_info.lock);
+		if (thread_info.thread_status != THREAD_STATUS::IDLE)
 		{
-			if (s_thread_scheduler.threads[i].thread_info.thread_status == THREAD_STATUS::IDLE)
-			{
-				const uint32_t next_gen = s_thread_scheduler.threads[i].thread_info.generation + 1;
-				s_thread_scheduler.threads[i].thread_info.task_name = a_task_name;
-				s_thread_scheduler.threads[i].thread_info.function = a_function;
-				void* func_parameter_mem = ArenaAlloc(s_thread_scheduler.threads[i].thread_info.arena, a_func_parameter_size, 16);
-				s_thread_scheduler.threads[i].thread_info.function_parameter = memcpy(func_parameter_mem, a_func_parameter, a_func_parameter_size);
-				s_thread_scheduler.threads[i].thread_info.thread_status = THREAD_STATUS::BUSY;
-				OSWakeConditionVariable(&s_thread_scheduler.threads[i].thread_info.condition);
-				return ThreadTask(i, next_gen);
-			}
+			OSReleaseSRWLockWrite(&thread_info.lock);
+			continue;
 		}
-		BB_ASSERT(false, "No free threads! Maybe implement a way to just re-iterate over the list again.");
-		return ThreadTask(BB_INVALID_HANDLE_64);
+
+		const uint32_t next_gen = thread_info.generation + 1;
+		thread_info.task_name = a_task_name;
+		thread_info.function = a_function;
+		void* func_parameter_mem = ArenaAlloc(thread_info.arena, a_func_parameter_size, 16);
+		thread_info.function_parameter = memcpy(func_parameter_mem, a_func_parameter, a_func_parameter_size);
+		thread_info.thread_status = THREAD_STATUS::BUSY;
+		OSWakeConditionVariable(&thread_info.condition);
+		OSReleaseSRWLockWrite(&thread_info.lock);
+		return ThreadTask(i, next_gen);
 	}
+	return ThreadTask(BB_INVALID_HANDLE_64);
+}
+
+ThreadTask BB::Threads::StartTaskThread(void(*a_function)(MemoryArena&, void*), void* a_func_parameter, const size_t a_func_parameter_size, const wchar_t* a_task_name)
+{
+	const ThreadTask task = TryStartTaskThread(a_function, a_func_parameter, a_func_parameter_size, a_task_name);
+	BB_ASSERT(task.IsValid(), "No free threads! Maybe implement a way to just re-iterate over the list again.");
+	return task;
 }
 
 ThreadTask BB::Threads::StartTaskThread(void(*a_function)(MemoryArena& a_thread_arena, void*), const wchar_t* a_task_name)
@@ -34,18 +34,26 @@ static char ignoreWhiteSpace(JsonFile& a_JsonFile)
 	char character = a_JsonFile.data[a_JsonFile.pos++];
 	while ((character == ' ' || character == '\n' || character == '\r'))
 	{
-		BB_ASSERT(a_JsonFile.pos <= a_JsonFile.size, "out of tokens");
+		//trailing whitespace, a mapped file has nothing readable past the last byte.
+		if (a_JsonFile.pos >= a_JsonFile.size)
+			return '\0';
 		character = a_JsonFile.data[a_JsonFile.pos++];
 	}
 
 	return character;
 }
 
+//the literal starts at the character that is already read.
+static bool LiteralFits(const JsonFile& a_JsonFile, const uint32_t a_size)
+{
+	return a_JsonFile.pos - 1 + a_size <= a_JsonFile.size;
+}
+
 static Token GetToken(JsonFile& a_JsonFile)
 {
 	Token token;
 
-	if (a_JsonFile.pos > a_JsonFile.size) //If we are at the end of the file, we will produce no more tokens.
+	if (a_JsonFile.pos >= a_JsonFile.size) //If we are at the end of the file, we will produce no more tokens.
 	{
 		token.type = TOKEN_TYPE::OUT_OF_TOKENS;
 		return token;
@@ -55,57 +63,62 @@ static Token GetToken(JsonFile& a_JsonFile)
 
 	if (character == '"') //is string
 	{
-		//get string length
+		//get string length, bound by the file size since a mapped file has nothing readable past the last byte.
 		size_t t_StrLen = 0;
-		while (a_JsonFile.data[a_JsonFile.pos + t_StrLen] != '"')
+		while (a_JsonFile.pos + t_StrLen < a_JsonFile.size && a_JsonFile.data[a_JsonFile.pos + t_StrLen] != '"')
 			++t_StrLen;
+		BB_WARNING(a_JsonFile.pos + t_StrLen < a_JsonFile.size, "JSON string is not closed before the end of the file", WarningType::MEDIUM);
 
 		token.type = TOKEN_TYPE::STRING;
 		token.str_size = static_cast<uint32_t>(t_StrLen);
 		token.str = &a_JsonFile.data[a_JsonFile.pos];
 
-		a_JsonFile.pos += static_cast<uint32_t>(t_StrLen) + 1; //includes the last "
+		a_JsonFile.pos = Min(a_JsonFile.pos + static_cast<uint32_t>(t_StrLen) + 1, a_JsonFile.size); //includes the last "
 	}
 	else if (character == '-' || (character >= '0' && character <= '9')) //is number
 	{
-		//get string length which are numbers
-		size_t t_StrLen = 1;
-		char t_Num = a_JsonFile.data[a_JsonFile.pos + t_StrLen];
-		while (t_Num == '-' || (t_Num >= '0' && t_Num <= '9') || t_Num == '.')
-			t_Num = a_JsonFile.data[a_JsonFile.pos + t_StrLen++];
+		//get string length which are numbers, the first character is already read.
+		uint32_t t_End = a_JsonFile.pos;
+		while (t_End < a_JsonFile.size)
+		{
+			const char t_Num = a_JsonFile.data[t_End];
+			if (!(t_Num == '-' || (t_Num >= '0' && t_Num <= '9') || t_Num == '.' || t_Num == 'e' || t_Num == 'E' || t_Num == '+'))
+				break;
+			++t_End;
+		}
 
 		token.type = TOKEN_TYPE::NUMBER;
-		token.str_size = static_cast<uint32_t>(t_StrLen);
+		token.str_size = t_End - a_JsonFile.pos + 1;
 		token.str = &a_JsonFile.data[a_JsonFile.pos - 1];
 
-		a_JsonFile.pos += static_cast<uint32_t>(t_StrLen) - 1; //includes the last
+		a_JsonFile.pos = t_End;
 	}
 	else if (character == 'f') {
 		token.type = TOKEN_TYPE::BOOLEAN;
 		token.str_size = 5;
 		token.str = &a_JsonFile.data[a_JsonFile.pos - 1];
 		//Do a janky check to see if False was actually correctly written.
-		BB_WARNING(Memory::Compare("false", &a_JsonFile.data[a_JsonFile.pos - 1], 5) == 0,
+		BB_WARNING(LiteralFits(a_JsonFile, 5) && Memory::Compare("false", &a_JsonFile.data[a_JsonFile.pos - 1], 5) == 0,
 			"JSON file tried to read a boolean that was set to True but it's not written as True!",
 			WarningType::MEDIUM);
-		a_JsonFile.pos += 4;
+		a_JsonFile.pos = Min(a_JsonFile.pos + 4, a_JsonFile.size);
 	}
 	else if (character == 't') {
 		token.type = TOKEN_TYPE::BOOLEAN;
 		token.str_size = 4;
 		token.str = &a_JsonFile.data[a_JsonFile.pos - 1];
 		//Do a janky check to see if True was actually correctly written.
-		BB_WARNING(Memory::Compare("true", &a_JsonFile.data[a_JsonFile.pos - 1], 4) == 0,
+		BB_WARNING(LiteralFits(a_JsonFile, 4) && Memory::Compare("true", &a_JsonFile.data[a_JsonFile.pos - 1], 4) == 0,
 			"JSON file tried to read a boolean that was set to True but it's not written as True!",
 			WarningType::MEDIUM);
-		a_JsonFile.pos += 3;
+		a_JsonFile.pos = Min(a_JsonFile.pos + 3, a_JsonFile.size);
 	}
 	else if (character == 'n') {
 		token.type = TOKEN_TYPE::NULL_TYPE;
-		BB_WARNING(Memory::Compare("null", &a_JsonFile.data[a_JsonFile.pos - 1], 4) == 0,
+		BB_WARNING(LiteralFits(a_JsonFile, 4) && Memory::Compare("null", &a_JsonFile.data[a_JsonFile.pos - 1], 4) == 0,
 			"JSON file tried to read a boolean that was set to True but it's not written as True!",
 			WarningType::MEDIUM);
-		a_JsonFile.pos += 3;
+		a_JsonFile.pos = Min(a_JsonFile.pos + 3, a_JsonFile.size);
 	}
 	else if (character == '{')
 	{
@@ -203,9 +216,10 @@ void BB::JsonNodeToString(const JsonNode* a_Node, String& a_string)
 JsonParser::JsonParser(const char* a_path)
 {
 	m_arena = MemoryArenaCreate();
-	Buffer buffer = OSReadFile(m_arena, a_path);
-	m_json_file.data = reinterpret_cast<char*>(buffer.data);
-	m_json_file.size = static_cast<uint32_t>(buffer.size);
+	m_mapped_file = OSMapFile(a_path, OS_MAP_HINT::SEQUENTIAL);
+	// the parser only reads from the file, strings and numbers are copied out of it.
+	m_json_file.data = const_cast<char*>(reinterpret_cast<const char*>(m_mapped_file.data));
+	m_json_file.size = static_cast<uint32_t>(m_mapped_file.size);
 }
 
 JsonParser::JsonParser(const Buffer& a_Buffer)
@@ -218,6 +232,7 @@ JsonParser::JsonParser(const Buffer& a_Buffer)
 JsonParser::~JsonParser()
 {
 	MemoryArenaFree(m_arena);
+	OSUnmapFile(m_mapped_file);
 }
 
 JsonNode* JsonParser::PraseSingleToken(const Token& a_token)
@@ -478,24 +493,23 @@ JsonNode* JsonParser::ParseNumber(const Token& a_token)
 	JsonNode* node = ArenaAllocType(m_arena, JsonNode);
 	node->type = JSON_TYPE::NUMBER;
 
-	node->number = std::stof(a_token.str);
+	// the token is not null terminated, at the end of a mapped file there is nothing after it.
+	char number[64];
+	const uint32_t number_size = Min(a_token.str_size, static_cast<uint32_t>(sizeof(number) - 1));
+	Memory::Copy(number, a_token.str, number_size);
+	number[number_size] = '\0';
+	node->number = strtof(number, nullptr);
 
 	return node;
 }
 
 JsonNode* JsonParser::ParseBoolean(const Token& a_token)
 {
-	(void)a_token;
 	JsonNode* node = ArenaAllocType(m_arena, JsonNode);
 	node->type = JSON_TYPE::BOOL;
 
-	const Token token = GetToken(m_json_file);
-	if (strcmp(token.str, "False") == 0)
-		node->boolean = false;
-	else if (strcmp(token.str, "True") == 0)
-		node->boolean = true;
-	else
-		BB_ASSERT(false, "JSON bool is wrongly typed, this assert should never be hit even with a wrong json anyway.");
+	//the token is the literal itself, GetToken already checked how it is written.
+	node->boolean = a_token.str_size == 4;
 
 	return node;
 }
@@ -0,0 +1,109 @@
+#include "DynamicResolution.hpp"
+#include "MemoryArena.hpp"
+#include "Logger.h"
+#include "Utils/Utils.h"
+
+#include <cmath>
+
+using namespace BB;
+
+// above this part of the budget the scale drops, below UNDER_BUDGET it grows.
+constexpr double OVER_BUDGET = 0.95;
+constexpr double UNDER_BUDGET = 0.8;
+// the part of the budget a new scale aims for, in the middle of the band so the next window stays inside it.
+constexpr double BUDGET_FILL = 0.875;
+constexpr float MAX_DROP_STEP = 0.25f;
+constexpr float MAX_GROW_STEP = 0.05f;
+// scales snap to this, every change costs a window of frames so tiny ones are not worth it.
+constexpr float SCALE_STEP = 1.f / 64.f;
+
+void DynamicResolution::Init(MemoryArena& a_arena, const DynamicResolutionCreateInfo& a_create_info)
+{
+	BB_ASSERT(a_create_info.min_scale > 0.f && a_create_info.min_scale <= a_create_info.max_scale, "invalid dynamic resolution scale range");
+	BB_ASSERT(a_create_info.window_size != 0, "dynamic resolution window size is 0");
+	m_target_frame_time = a_create_info.target_frame_time;
+	m_min_scale = a_create_info.min_scale;
+	m_max_scale = a_create_info.max_scale;
+	m_window_size = a_create_info.window_size;
+	m_scale_changes = 0;
+
+	// one more since the ring buffer wastes a slot.
+	CountingRingBufferInit(a_arena, m_cpu_history, m_window_size + 1);
+	CountingRingBufferInit(a_arena, m_gpu_history, m_window_size + 1);
+	Reset(m_max_scale);
+}
+
+float DynamicResolution::Update(const double a_cpu_frame_time, const double a_gpu_frame_time)
+{
+	CountingRingBufferPush(m_cpu_history, a_cpu_frame_time);
+	CountingRingBufferPush(m_gpu_history, a_gpu_frame_time);
+	if (CountingRingBufferSize(m_gpu_history) < m_window_size)
+		return m_scale;
+
+	const double cpu_average = CountingRingBufferAverage(m_cpu_history);
+	const double gpu_average = CountingRingBufferAverage(m_gpu_history);
+	// no gpu times, nothing to go on.
+	if (gpu_average <= 0.0)
+		return m_scale;
+
+	// the frame takes as long as the slowest of the two, the gpu can have the time the cpu takes anyway.
+	const double budget = Max(static_cast<double>(m_target_frame_time), cpu_average);
+	const float ideal_scale = m_scale * static_cast<float>(sqrt(budget * BUDGET_FILL / gpu_average));
+
+	float new_scale;
+	if (gpu_average > budget * OVER_BUDGET)
+	{
+		new_scale = Max(ideal_scale, m_scale * (1.f - MAX_DROP_STEP));
+		new_scale = floorf(new_scale / SCALE_STEP) * SCALE_STEP;
+	}
+	else if (gpu_average < budget * UNDER_BUDGET)
+	{
+		new_scale = Min(ideal_scale, m_scale * (1.f + MAX_GROW_STEP));
+		new_scale = ceilf(new_scale / SCALE_STEP) * SCALE_STEP;
+	}
+	else
+		return m_scale;
+
+	new_scale = Clampf(new_scale, m_min_scale, m_max_scale);
+	if (new_scale != m_scale)
+	{
+		SetScale(new_scale);
+		++m_scale_changes;
+	}
+	return m_scale;
+}
+
+void DynamicResolution::Reset(const float a_scale)
+{
+	SetScale(Clampf(a_scale, m_min_scale, m_max_scale));
+}
+
+void DynamicResolution::SetTargetFrameTime(const float a_target_frame_time)
+{
+	m_target_frame_time = a_target_frame_time;
+}
+
+uint2 DynamicResolution::GetScaledResolution(const uint2 a_max_resolution) const
+{
+	const uint32_t x = static_cast<uint32_t>(static_cast<float>(a_max_resolution.x) * m_scale + 0.5f);
+	const uint32_t y = static_cast<uint32_t>(static_cast<float>(a_max_resolution.y) * m_scale + 0.5f);
+	return uint2(Min(Max(x, 1u), a_max_resolution.x), Min(Max(y, 1u), a_max_resolution.y));
+}
+
+DynamicResolutionState DynamicResolution::GetState() const
+{
+	DynamicResolutionState state;
+	state.scale = m_scale;
+	state.cpu_average = CountingRingBufferAverage(m_cpu_history);
+	state.gpu_average = CountingRingBufferAverage(m_gpu_history);
+	state.scale_changes = m_scale_changes;
+	return state;
+}
+
+void DynamicResolution::SetScale(const float a_scale)
+{
+	m_scale = a_scale;
+	// the frames before were at another scale, they say nothing about this one.
+	CountingRingBufferClear(m_cpu_history);
+	CountingRingBufferClear(m_gpu_history);
+}
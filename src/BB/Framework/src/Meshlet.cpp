@@ -0,0 +1,310 @@
+#include "Meshlet.hpp"
+#include "MemoryArena.hpp"
+#include "Logger.h"
+#include "Utils/Utils.h"
+
+#include "Math/Math.inl"
+
+using namespace BB;
+
+constexpr uint32_t NO_TRIANGLE = UINT32_MAX;
+// triangles that face more then ~85 degrees apart make the cone useless.
+constexpr float MESHLET_CONE_MIN_SPREAD = 0.1f;
+
+static float3 TriangleNormal(const ConstSlice<float3> a_positions, const uint32_t* a_triangle)
+{
+	const float3 p0 = a_positions[a_triangle[0]];
+	const float3 p1 = a_positions[a_triangle[1]];
+	const float3 p2 = a_positions[a_triangle[2]];
+	// counter clockwise is front facing, like gltf.
+	return Float3Cross(p1 - p0, p2 - p0);
+}
+
+static void CalculateMeshletBounds(const ConstSlice<float3> a_positions, const uint32_t* a_indices, const bool a_cone_culling, Meshlet& a_meshlet)
+{
+	const uint32_t* indices = a_indices + a_meshlet.index_start;
+
+	float3 bounds_min = a_positions[indices[0]];
+	float3 bounds_max = bounds_min;
+	for (uint32_t i = 1; i < a_meshlet.index_count; i++)
+	{
+		bounds_min = Float3Min(bounds_min, a_positions[indices[i]]);
+		bounds_max = Float3Max(bounds_max, a_positions[indices[i]]);
+	}
+
+	a_meshlet.center = (bounds_min + bounds_max) * 0.5f;
+	a_meshlet.radius = 0.f;
+	for (uint32_t i = 0; i < a_meshlet.index_count; i++)
+		a_meshlet.radius = Max(a_meshlet.radius, Float3Length(a_positions[indices[i]] - a_meshlet.center));
+
+	a_meshlet.cone_apex = a_meshlet.center;
+	a_meshlet.cone_axis = float3(0.f, 0.f, 1.f);
+	a_meshlet.cone_cutoff = MESHLET_CONE_DISABLED;
+	if (!a_cone_culling)
+		return;
+
+	float3 normal_sum = float3(0.f);
+	for (uint32_t i = 0; i < a_meshlet.index_count; i += 3)
+	{
+		const float3 normal = TriangleNormal(a_positions, &indices[i]);
+		const float length = Float3Length(normal);
+		if (length > 0.f)
+			normal_sum = normal_sum + normal * (1.f / length);
+	}
+
+	const float sum_length = Float3Length(normal_sum);
+	if (sum_length == 0.f)
+		return;
+	const float3 axis = normal_sum * (1.f / sum_length);
+
+	float min_dot = 1.f;
+	for (uint32_t i = 0; i < a_meshlet.index_count; i += 3)
+	{
+		const float3 normal = TriangleNormal(a_positions, &indices[i]);
+		const float length = Float3Length(normal);
+		if (length > 0.f)
+			min_dot = Min(min_dot, Float3Dot(normal * (1.f / length), axis));
+	}
+
+	if (min_dot <= MESHLET_CONE_MIN_SPREAD)
+		return;
+
+	// move the apex back until it is behind every triangle plane, then the test holds for every point of the meshlet.
+	float max_t = 0.f;
+	for (uint32_t i = 0; i < a_meshlet.index_count; i += 3)
+	{
+		const float3 normal = TriangleNormal(a_positions, &indices[i]);
+		const float length = Float3Length(normal);
+		if (length == 0.f)
+			continue;
+		const float3 unit_normal = normal * (1.f / length);
+		const float t = Float3Dot(a_meshlet.center - a_positions[indices[i]], unit_normal) / Float3Dot(unit_normal, axis);
+		max_t = Max(max_t, t);
+	}
+
+	a_meshlet.cone_apex = a_meshlet.center - axis * max_t;
+	a_meshlet.cone_axis = axis;
+	a_meshlet.cone_cutoff = sqrtf(1.f - min_dot * min_dot);
+}
+
+Slice<Meshlet> BB::BuildMeshlets(MemoryArena& a_arena, const ConstSlice<float3> a_positions, const Slice<uint32_t> a_indices, const bool a_cone_culling)
+{
+	BB_ASSERT(a_indices.size() % 3 == 0, "meshlet indices are not a triangle list");
+	const uint32_t triangle_count = static_cast<uint32_t>(a_indices.size() / 3);
+	if (triangle_count == 0)
+		return Slice<Meshlet>();
+
+	// every meshlet but the last one is closed with at least MESHLET_MAX_VERTICES / 3 triangles.
+	const uint32_t max_meshlets = triangle_count / (MESHLET_MAX_VERTICES / 3) + 1;
+	Meshlet* meshlets = ArenaAllocArr(a_arena, Meshlet, max_meshlets);
+	uint32_t meshlet_count = 0;
+
+	MemoryArenaScope(a_arena)
+	{
+		uint32_t vertex_count = 0;
+		for (size_t i = 0; i < a_indices.size(); i++)
+			vertex_count = Max(vertex_count, a_indices[i] + 1);
+		BB_ASSERT(vertex_count <= a_positions.size(), "meshlet index is out of bounds of the positions");
+
+		// vertex to triangle adjacency
+		uint32_t* adjacency_offsets = ArenaAllocArr(a_arena, uint32_t, vertex_count + 1);
+		uint32_t* adjacency = ArenaAllocArr(a_arena, uint32_t, a_indices.size());
+		for (size_t i = 0; i < a_indices.size(); i++)
+			++adjacency_offsets[a_indices[i] + 1];
+		for (uint32_t i = 0; i < vertex_count; i++)
+			adjacency_offsets[i + 1] += adjacency_offsets[i];
+
+		uint32_t* adjacency_fill = ArenaAllocArr(a_arena, uint32_t, vertex_count);
+		for (size_t i = 0; i < a_indices.size(); i++)
+		{
+			const uint32_t vertex = a_indices[i];
+			adjacency[adjacency_offsets[vertex] + adjacency_fill[vertex]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		bool* triangle_used = ArenaAllocArr(a_arena, bool, triangle_count);
+		// the meshlet a vertex was last added to, + 1 so that 0 means none.
+		uint32_t* vertex_meshlet = ArenaAllocArr(a_arena, uint32_t, vertex_count);
+		uint32_t* new_indices = ArenaAllocArr(a_arena, uint32_t, a_indices.size());
+
+		uint32_t meshlet_vertices[MESHLET_MAX_VERTICES];
+		uint32_t meshlet_vertex_count = 0;
+		uint32_t meshlet_triangle_count = 0;
+		uint32_t index_write = 0;
+		uint32_t next_seed = 0;
+
+		auto new_vertex_count = [&](const uint32_t a_triangle)
+			{
+				uint32_t count = 0;
+				for (uint32_t i = 0; i < 3; i++)
+					if (vertex_meshlet[a_indices[a_triangle * 3 + i]] != meshlet_count + 1)
+						++count;
+				return count;
+			};
+
+		auto finish_meshlet = [&]()
+			{
+				Meshlet& meshlet = meshlets[meshlet_count];
+				meshlet.index_count = meshlet_triangle_count * 3;
+				meshlet.index_start = index_write - meshlet.index_count;
+				CalculateMeshletBounds(a_positions, new_indices, a_cone_culling, meshlet);
+				++meshlet_count;
+				meshlet_vertex_count = 0;
+				meshlet_triangle_count = 0;
+			};
+
+		for (uint32_t emitted = 0; emitted < triangle_count; emitted++)
+		{
+			// grow the meshlet with the triangle next to it that adds the least new vertices.
+			uint32_t best_triangle = NO_TRIANGLE;
+			uint32_t best_new_vertices = 4;
+			for (uint32_t v = 0; v < meshlet_vertex_count && best_new_vertices != 0; v++)
+			{
+				const uint32_t vertex = meshlet_vertices[v];
+				for (uint32_t adj = adjacency_offsets[vertex]; adj < adjacency_offsets[vertex + 1]; adj++)
+				{
+					const uint32_t triangle = adjacency[adj];
+					if (triangle_used[triangle])
+						continue;
+					const uint32_t new_vertices = new_vertex_count(triangle);
+					if (new_vertices < best_new_vertices)
+					{
+						best_triangle = triangle;
+						best_new_vertices = new_vertices;
+						if (new_vertices == 0)
+							break;
+					}
+				}
+			}
+
+			// nothing connected, continue with the next triangle in the original order.
+			if (best_triangle == NO_TRIANGLE)
+			{
+				while (triangle_used[next_seed])
+					++next_seed;
+				best_triangle = next_seed;
+				best_new_vertices = new_vertex_count(best_triangle);
+			}
+
+			// the best triangle does not fit, it becomes the start of the next meshlet.
+			if (meshlet_vertex_count + best_new_vertices > MESHLET_MAX_VERTICES || meshlet_triangle_count + 1 > MESHLET_MAX_TRIANGLES)
+			{
+				finish_meshlet();
+				best_new_vertices = 3;
+			}
+
+			triangle_used[best_triangle] = true;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const uint32_t vertex = a_indices[best_triangle * 3 + i];
+				if (vertex_meshlet[vertex] != meshlet_count + 1)
+				{
+					vertex_meshlet[vertex] = meshlet_count + 1;
+					meshlet_vertices[meshlet_vertex_count++] = vertex;
+				}
+				new_indices[index_write++] = vertex;
+			}
+			++meshlet_triangle_count;
+		}
+		finish_meshlet();
+		BB_ASSERT(meshlet_count <= max_meshlets, "more meshlets then the upper bound");
+
+		memcpy(a_indices.data(), new_indices, a_indices.sizeInBytes());
+	}
+
+	return Slice<Meshlet>(meshlets, meshlet_count);
+}
+
+MeshletCullView BB::CreateMeshletCullView(const float4x4& a_view, const float4x4& a_projection, const float3 a_view_position)
+{
+	// the columns of the view projection, clip = (point * view) * projection.
+	float4 columns[4];
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		float4 basis = float4(0.f);
+		basis.e[i] = 1.f;
+		columns[i] = (basis * a_view) * a_projection;
+	}
+
+	const float4 row_x = float4(columns[0].x, columns[1].x, columns[2].x, columns[3].x);
+	const float4 row_y = float4(columns[0].y, columns[1].y, columns[2].y, columns[3].y);
+	const float4 row_z = float4(columns[0].z, columns[1].z, columns[2].z, columns[3].z);
+	const float4 row_w = float4(columns[0].w, columns[1].w, columns[2].w, columns[3].w);
+
+	MeshletCullView view;
+	view.frustum_planes[0] = row_w + row_x; // left
+	view.frustum_planes[1] = row_w - row_x; // right
+	view.frustum_planes[2] = row_w + row_y; // bottom
+	view.frustum_planes[3] = row_w - row_y; // top
+	view.frustum_planes[4] = row_w + row_z; // near
+	view.frustum_planes[5] = row_w - row_z; // far
+	for (uint32_t i = 0; i < _countof(view.frustum_planes); i++)
+	{
+		const float4 plane = view.frustum_planes[i];
+		const float length = Float3Length(float3(plane.x, plane.y, plane.z));
+		view.frustum_planes[i] = plane * (1.f / length);
+	}
+	view.view_position = a_view_position;
+	return view;
+}
+
+bool BB::IsMeshletVisible(const Meshlet& a_meshlet, const float4x4& a_world, const float a_world_scale, const bool a_cone_culling, const MeshletCullView& a_view)
+{
+	const float4 center = a_world * float4(a_meshlet.center, 1.f);
+	const float radius = a_meshlet.radius * a_world_scale;
+	for (uint32_t i = 0; i < _countof(a_view.frustum_planes); i++)
+	{
+		const float4 plane = a_view.frustum_planes[i];
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+			return false;
+	}
+
+	if (a_cone_culling && a_meshlet.cone_cutoff < 1.f)
+	{
+		const float4 apex = a_world * float4(a_meshlet.cone_apex, 1.f);
+		const float4 axis = a_world * float4(a_meshlet.cone_axis, 0.f);
+		const float3 view_dir = float3(apex.x, apex.y, apex.z) - a_view.view_position;
+		const float view_length = Float3Length(view_dir);
+		const float axis_length = Float3Length(float3(axis.x, axis.y, axis.z));
+		if (view_length > 0.f && axis_length > 0.f)
+		{
+			const float cone_dot = Float3Dot(view_dir, float3(axis.x, axis.y, axis.z)) / (view_length * axis_length);
+			if (cone_dot >= a_meshlet.cone_cutoff)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t BB::CullMeshlets(const ConstSlice<Meshlet> a_meshlets, const float4x4& a_world, const MeshletCullView& a_view, MeshletDrawRange* a_out_ranges)
+{
+	const float3 world_x = float3(a_world.r[0].x, a_world.r[0].y, a_world.r[0].z);
+	const float3 world_y = float3(a_world.r[1].x, a_world.r[1].y, a_world.r[1].z);
+	const float3 world_z = float3(a_world.r[2].x, a_world.r[2].y, a_world.r[2].z);
+	const float world_scale = Max(Float3Length(world_x), Max(Float3Length(world_y), Float3Length(world_z)));
+	// a mirrored transform flips the winding, so the cones point the wrong way.
+	const bool cone_culling = Float3Dot(Float3Cross(world_x, world_y), world_z) > 0.f;
+
+	uint32_t range_count = 0;
+	for (size_t i = 0; i < a_meshlets.size(); i++)
+	{
+		const Meshlet& meshlet = a_meshlets[i];
+		if (!IsMeshletVisible(meshlet, a_world, world_scale, cone_culling, a_view))
+			continue;
+
+		if (range_count != 0)
+		{
+			MeshletDrawRange& last = a_out_ranges[range_count - 1];
+			if (last.index_start + last.index_count == meshlet.index_start)
+			{
+				last.index_count += meshlet.index_count;
+				continue;
+			}
+		}
+
+		a_out_ranges[range_count].index_start = meshlet.index_start;
+		a_out_ranges[range_count].index_count = meshlet.index_count;
+		++range_count;
+	}
+	return range_count;
+}
@@ -0,0 +1,528 @@
+#include "Program.h"
+#include "Utils/Logger.h"
+#include "Utils/Utils.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifdef _LINUX
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif //_LINUX
+
+using namespace BB;
+
+// every read lives in a slot until it is waited on, the handle is the slot index with a generation in extra_index.
+// the reads go to io_uring when it is there, otherwise to ASYNC_IO_THREAD_COUNT threads that do blocking reads.
+// those are not the job system threads, asset loading waits on reads from inside jobs.
+
+constexpr uint32_t ASYNC_READ_SLOT_COUNT = 256;
+constexpr uint32_t ASYNC_IO_THREAD_COUNT = 4;
+constexpr uint32_t ASYNC_REGISTERED_BUFFER_MAX = 8;
+constexpr uint32_t ASYNC_SLOT_INVALID = UINT32_MAX;
+
+struct AsyncReadSlot
+{
+	OSAsyncReadInfo info;
+	std::atomic<OS_ASYNC_READ_STATUS> status;
+	std::atomic<bool> cancel_requested;
+	uint32_t generation;
+	size_t bytes_read;
+	// set while io_uring has the read, those are the reads that move to the io threads when the ring breaks.
+	bool in_io_uring;
+	// signaled once when the read is done, every finish takes it once.
+	BBSemaphore done;
+	uint32_t next_free;
+};
+
+struct AsyncRegisteredBuffer
+{
+	void* memory;
+	size_t size;
+};
+
+struct AsyncFileIO
+{
+	BBRWLock lock;
+	AsyncReadSlot slots[ASYNC_READ_SLOT_COUNT];
+	uint32_t first_free;
+	uint32_t free_count;
+
+	AsyncRegisteredBuffer registered_buffers[ASYNC_REGISTERED_BUFFER_MAX];
+	uint32_t registered_buffer_count;
+
+	bool use_io_uring;
+
+	// io thread fallback, a ring of slot indices that wait for a thread.
+	BBSemaphore queued;
+	uint32_t queue[ASYNC_READ_SLOT_COUNT];
+	uint32_t queue_front;
+	uint32_t queue_size;
+};
+
+static AsyncFileIO s_async_io;
+static BBRWLock s_async_init_lock{ OSCreateRWLock() };
+static std::atomic<bool> s_async_initialized{ false };
+
+static void FinishSlot(const uint32_t a_slot, const OS_ASYNC_READ_STATUS a_status, const size_t a_bytes_read)
+{
+	AsyncReadSlot& slot = s_async_io.slots[a_slot];
+	slot.bytes_read = a_bytes_read;
+	slot.status.store(a_status, std::memory_order_release);
+	OSSignalSemaphore(slot.done, 1);
+}
+
+// at the end of the file a short read is fine, a read that got nothing while it asked for something is not.
+static OS_ASYNC_READ_STATUS EndOfFileStatus(const AsyncReadSlot& a_slot, const size_t a_bytes_read)
+{
+	return a_bytes_read == 0 && a_slot.info.size != 0 ? OS_ASYNC_READ_STATUS::FAILED : OS_ASYNC_READ_STATUS::DONE;
+}
+
+// does what is left of the read on the calling thread.
+static void ReadSlotBlocking(const uint32_t a_slot)
+{
+	AsyncReadSlot& slot = s_async_io.slots[a_slot];
+	const OSAsyncReadInfo& info = slot.info;
+	const size_t bytes_read = slot.bytes_read + OSReadFileAt(info.file, Pointer::Add(info.buffer, slot.bytes_read), info.size - slot.bytes_read, info.file_offset + slot.bytes_read);
+	FinishSlot(a_slot, EndOfFileStatus(slot, bytes_read), bytes_read);
+}
+
+#ifdef _LINUX
+// io_uring without liburing, the rings are mapped and filled by hand.
+constexpr uint64_t IO_URING_CANCEL_TAG = 1ull << 63;
+// sqe.len is 32 bits and linux stops a single read at about 2 GB, bigger reads are done in parts.
+constexpr uint32_t IO_URING_MAX_READ = 1u << 30;
+// io_uring_enter failing this many times in a row means the ring is broken, the wait between tries doubles until then.
+constexpr uint32_t IO_URING_MAX_ENTER_FAILURES = 8;
+constexpr uint32_t IO_URING_ENTER_RETRY_MICROSECONDS = 100;
+
+struct IOUring
+{
+	int fd;
+	std::atomic<uint32_t>* sq_head;
+	std::atomic<uint32_t>* sq_tail;
+	uint32_t sq_mask;
+	uint32_t* sq_array;
+	io_uring_sqe* sqes;
+
+	std::atomic<uint32_t>* cq_head;
+	std::atomic<uint32_t>* cq_tail;
+	uint32_t cq_mask;
+	io_uring_cqe* cqes;
+};
+
+static IOUring s_io_uring;
+
+static int IOUringEnter(const uint32_t a_to_submit, const uint32_t a_min_complete, const uint32_t a_flags)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, s_io_uring.fd, a_to_submit, a_min_complete, a_flags, nullptr, 0));
+}
+
+static void IOUringPrepareRead(const uint32_t a_slot);
+static uint32_t IOUringSubmit(const uint32_t a_count);
+static void StartAsyncIOThreads();
+
+// the ring stopped working, the reads it still has and every new read go to the io threads.
+static void IOUringFallBackToThreads()
+{
+	OSAcquireSRWLockWrite(&s_async_io.lock);
+	s_async_io.use_io_uring = false;
+	StartAsyncIOThreads();
+	uint32_t moved = 0;
+	for (uint32_t i = 0; i < ASYNC_READ_SLOT_COUNT; i++)
+	{
+		AsyncReadSlot& slot = s_async_io.slots[i];
+		if (!slot.in_io_uring)
+			continue;
+		// bytes_read only counts completed parts, the io thread continues from there.
+		slot.in_io_uring = false;
+		s_async_io.queue[(s_async_io.queue_front + s_async_io.queue_size++) % ASYNC_READ_SLOT_COUNT] = i;
+		++moved;
+	}
+	// closing the ring cancels what the kernel still has.
+	close(s_io_uring.fd);
+	OSReleaseSRWLockWrite(&s_async_io.lock);
+
+	if (moved)
+		OSSignalSemaphore(s_async_io.queued, moved);
+}
+
+static void IOUringCompletionThread(void*)
+{
+	OSSetThreadName(L"async file io");
+	uint32_t enter_failures = 0;
+	while (true)
+	{
+		if (IOUringEnter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+		{
+			if (++enter_failures == IO_URING_MAX_ENTER_FAILURES)
+			{
+				BB_WARNING(false, "io_uring_enter keeps failing while waiting on completions, switching to the io threads", WarningType::HIGH);
+				IOUringFallBackToThreads();
+				return;
+			}
+			usleep(IO_URING_ENTER_RETRY_MICROSECONDS << enter_failures);
+			continue;
+		}
+		enter_failures = 0;
+
+		uint32_t head = s_io_uring.cq_head->load(std::memory_order_relaxed);
+		const uint32_t tail = s_io_uring.cq_tail->load(std::memory_order_acquire);
+		for (; head != tail; head++)
+		{
+			const io_uring_cqe& cqe = s_io_uring.cqes[head & s_io_uring.cq_mask];
+			if (cqe.user_data & IO_URING_CANCEL_TAG)
+				continue;
+
+			const uint32_t slot_index = static_cast<uint32_t>(cqe.user_data);
+			AsyncReadSlot& slot = s_async_io.slots[slot_index];
+			// pairs with the release in OSSubmitAsyncReads, the kernel already orders it but the sanitizers do not see that.
+			BB_ASSERT(slot.status.load(std::memory_order_acquire) == OS_ASYNC_READ_STATUS::PENDING, "io_uring completed a read that is not pending");
+			slot.in_io_uring = false;
+			if (cqe.res > 0)
+			{
+				slot.bytes_read += static_cast<size_t>(cqe.res);
+				if (slot.bytes_read == slot.info.size)
+					FinishSlot(slot_index, OS_ASYNC_READ_STATUS::DONE, slot.bytes_read);
+				else if (slot.cancel_requested.load(std::memory_order_relaxed))
+					FinishSlot(slot_index, OS_ASYNC_READ_STATUS::CANCELLED, slot.bytes_read);
+				else
+				{
+					// a read in parts or a short read, continue where it stopped.
+					OSAcquireSRWLockWrite(&s_async_io.lock);
+					IOUringPrepareRead(slot_index);
+					const bool submitted = IOUringSubmit(1) == 1;
+					slot.in_io_uring = submitted;
+					OSReleaseSRWLockWrite(&s_async_io.lock);
+					if (!submitted)
+						ReadSlotBlocking(slot_index);
+				}
+			}
+			else if (cqe.res == 0)
+				FinishSlot(slot_index, EndOfFileStatus(slot, slot.bytes_read), slot.bytes_read);
+			else if (cqe.res == -ECANCELED)
+				FinishSlot(slot_index, OS_ASYNC_READ_STATUS::CANCELLED, 0);
+			else
+				FinishSlot(slot_index, OS_ASYNC_READ_STATUS::FAILED, 0);
+		}
+		s_io_uring.cq_head->store(head, std::memory_order_release);
+	}
+}
+
+static bool IOUringInit()
+{
+	io_uring_params params{};
+	const int fd = static_cast<int>(syscall(__NR_io_uring_setup, ASYNC_READ_SLOT_COUNT, &params));
+	// containers often block io_uring, the io threads take over then.
+	if (fd < 0)
+		return false;
+
+	const size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	const size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+	const size_t sq_map_size = single_mmap ? Max(sq_size, cq_size) : sq_size;
+
+	void* sq_ring = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	void* cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	void* sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED)
+	{
+		close(fd);
+		return false;
+	}
+
+	s_io_uring.fd = fd;
+	s_io_uring.sq_head = reinterpret_cast<std::atomic<uint32_t>*>(Pointer::Add(sq_ring, params.sq_off.head));
+	s_io_uring.sq_tail = reinterpret_cast<std::atomic<uint32_t>*>(Pointer::Add(sq_ring, params.sq_off.tail));
+	s_io_uring.sq_mask = *reinterpret_cast<uint32_t*>(Pointer::Add(sq_ring, params.sq_off.ring_mask));
+	s_io_uring.sq_array = reinterpret_cast<uint32_t*>(Pointer::Add(sq_ring, params.sq_off.array));
+	s_io_uring.sqes = reinterpret_cast<io_uring_sqe*>(sqes);
+	s_io_uring.cq_head = reinterpret_cast<std::atomic<uint32_t>*>(Pointer::Add(cq_ring, params.cq_off.head));
+	s_io_uring.cq_tail = reinterpret_cast<std::atomic<uint32_t>*>(Pointer::Add(cq_ring, params.cq_off.tail));
+	s_io_uring.cq_mask = *reinterpret_cast<uint32_t*>(Pointer::Add(cq_ring, params.cq_off.ring_mask));
+	s_io_uring.cqes = reinterpret_cast<io_uring_cqe*>(Pointer::Add(cq_ring, params.cq_off.cqes));
+
+	OSCreateThread(IOUringCompletionThread, 0, nullptr);
+	return true;
+}
+
+// lock held, the sq is empty after every enter since there is no sq polling thread.
+static io_uring_sqe& IOUringNextSQE()
+{
+	const uint32_t tail = s_io_uring.sq_tail->load(std::memory_order_relaxed);
+	const uint32_t index = tail & s_io_uring.sq_mask;
+	s_io_uring.sq_array[index] = index;
+	s_io_uring.sq_tail->store(tail + 1, std::memory_order_relaxed);
+	io_uring_sqe& sqe = s_io_uring.sqes[index];
+	memset(&sqe, 0, sizeof(sqe));
+	return sqe;
+}
+
+static void IOUringPrepareRead(const uint32_t a_slot)
+{
+	AsyncReadSlot& slot = s_async_io.slots[a_slot];
+	slot.in_io_uring = true;
+	const OSAsyncReadInfo& info = slot.info;
+	void* buffer = Pointer::Add(info.buffer, slot.bytes_read);
+	const uint32_t size = static_cast<uint32_t>(Min(info.size - slot.bytes_read, static_cast<size_t>(IO_URING_MAX_READ)));
+	io_uring_sqe& sqe = IOUringNextSQE();
+	sqe.opcode = IORING_OP_READ;
+	for (uint32_t i = 0; i < s_async_io.registered_buffer_count; i++)
+	{
+		const AsyncRegisteredBuffer& registered = s_async_io.registered_buffers[i];
+		if (buffer >= registered.memory && Pointer::Add(buffer, size) <= Pointer::Add(registered.memory, registered.size))
+		{
+			sqe.opcode = IORING_OP_READ_FIXED;
+			sqe.buf_index = static_cast<uint16_t>(i);
+			break;
+		}
+	}
+	sqe.fd = static_cast<int>(info.file.handle);
+	sqe.off = info.file_offset + slot.bytes_read;
+	sqe.addr = reinterpret_cast<uint64_t>(buffer);
+	sqe.len = size;
+	sqe.user_data = a_slot;
+}
+
+// lock held, returns how many of the last a_count sqes the kernel took. The ones it did not take are removed from the sq.
+static uint32_t IOUringSubmit(const uint32_t a_count)
+{
+	uint32_t submitted = 0;
+	while (submitted < a_count)
+	{
+		const int result = IOUringEnter(a_count - submitted, 0, 0);
+		if (result < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+				continue;
+			break;
+		}
+		submitted += static_cast<uint32_t>(result);
+	}
+	if (submitted != a_count)
+		s_io_uring.sq_tail->store(s_io_uring.sq_tail->load(std::memory_order_relaxed) - (a_count - submitted), std::memory_order_relaxed);
+	return submitted;
+}
+
+static bool IOUringRegisterBuffers()
+{
+	syscall(__NR_io_uring_register, s_io_uring.fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+	iovec iovecs[ASYNC_REGISTERED_BUFFER_MAX];
+	for (uint32_t i = 0; i < s_async_io.registered_buffer_count; i++)
+	{
+		iovecs[i].iov_base = s_async_io.registered_buffers[i].memory;
+		iovecs[i].iov_len = s_async_io.registered_buffers[i].size;
+	}
+	return syscall(__NR_io_uring_register, s_io_uring.fd, IORING_REGISTER_BUFFERS, iovecs, s_async_io.registered_buffer_count) == 0;
+}
+#endif //_LINUX
+
+static void AsyncIOThread(void*)
+{
+	OSSetThreadName(L"async file io");
+	while (true)
+	{
+		OSWaitSemaphore(s_async_io.queued);
+		OSAcquireSRWLockWrite(&s_async_io.lock);
+		const uint32_t slot_index = s_async_io.queue[s_async_io.queue_front];
+		s_async_io.queue_front = (s_async_io.queue_front + 1) % ASYNC_READ_SLOT_COUNT;
+		--s_async_io.queue_size;
+		OSReleaseSRWLockWrite(&s_async_io.lock);
+
+		AsyncReadSlot& slot = s_async_io.slots[slot_index];
+		if (slot.cancel_requested.load(std::memory_order_relaxed))
+		{
+			FinishSlot(slot_index, OS_ASYNC_READ_STATUS::CANCELLED, 0);
+			continue;
+		}
+
+		ReadSlotBlocking(slot_index);
+	}
+}
+
+// lock held or still initializing.
+static void StartAsyncIOThreads()
+{
+	s_async_io.queued = OSCreateSemaphore(0, ASYNC_READ_SLOT_COUNT);
+	for (uint32_t i = 0; i < ASYNC_IO_THREAD_COUNT; i++)
+		OSCreateThread(AsyncIOThread, 0, nullptr);
+}
+
+static void InitAsyncFileIO()
+{
+	if (s_async_initialized.load(std::memory_order_acquire))
+		return;
+
+	OSAcquireSRWLockWrite(&s_async_init_lock);
+	if (!s_async_initialized.load(std::memory_order_relaxed))
+	{
+		s_async_io.lock = OSCreateRWLock();
+		for (uint32_t i = 0; i < ASYNC_READ_SLOT_COUNT; i++)
+		{
+			AsyncReadSlot& slot = s_async_io.slots[i];
+			slot.status = OS_ASYNC_READ_STATUS::DONE;
+			slot.cancel_requested = false;
+			slot.generation = 0;
+			slot.in_io_uring = false;
+			slot.done = OSCreateSemaphore(0, 1);
+			slot.next_free = i + 1 < ASYNC_READ_SLOT_COUNT ? i + 1 : ASYNC_SLOT_INVALID;
+		}
+		s_async_io.first_free = 0;
+		s_async_io.free_count = ASYNC_READ_SLOT_COUNT;
+		s_async_io.registered_buffer_count = 0;
+		s_async_io.queue_front = 0;
+		s_async_io.queue_size = 0;
+
+#ifdef _LINUX
+		s_async_io.use_io_uring = IOUringInit();
+#else
+		s_async_io.use_io_uring = false;
+#endif //_LINUX
+		if (!s_async_io.use_io_uring)
+			StartAsyncIOThreads();
+		s_async_initialized.store(true, std::memory_order_release);
+	}
+	OSReleaseSRWLockWrite(&s_async_init_lock);
+}
+
+static uint32_t GetSlotIndex(const OSAsyncRead a_read)
+{
+	BB_ASSERT(a_read.index < ASYNC_READ_SLOT_COUNT && s_async_io.slots[a_read.index].generation == a_read.extra_index, "invalid or already finished OSAsyncRead");
+	return a_read.index;
+}
+
+// takes the done signal and gives the slot back.
+static OS_ASYNC_READ_STATUS ReleaseSlot(const uint32_t a_slot, size_t* a_bytes_read)
+{
+	AsyncReadSlot& slot = s_async_io.slots[a_slot];
+	OSWaitSemaphore(slot.done);
+	const OS_ASYNC_READ_STATUS status = slot.status.load(std::memory_order_acquire);
+	if (a_bytes_read)
+		*a_bytes_read = slot.bytes_read;
+
+	OSAcquireSRWLockWrite(&s_async_io.lock);
+	++slot.generation;
+	slot.next_free = s_async_io.first_free;
+	s_async_io.first_free = a_slot;
+	++s_async_io.free_count;
+	OSReleaseSRWLockWrite(&s_async_io.lock);
+	return status;
+}
+
+bool BB::OSSubmitAsyncReads(const OSAsyncReadInfo* a_reads, const uint32_t a_read_count, OSAsyncRead* a_out_reads)
+{
+	InitAsyncFileIO();
+
+	OSAcquireSRWLockWrite(&s_async_io.lock);
+	if (s_async_io.free_count < a_read_count)
+	{
+		OSReleaseSRWLockWrite(&s_async_io.lock);
+		return false;
+	}
+	// the completion thread can switch to the io threads, decide once under the lock.
+	const bool use_io_uring = s_async_io.use_io_uring;
+
+	for (uint32_t i = 0; i < a_read_count; i++)
+	{
+		const uint32_t slot_index = s_async_io.first_free;
+		AsyncReadSlot& slot = s_async_io.slots[slot_index];
+		s_async_io.first_free = slot.next_free;
+		--s_async_io.free_count;
+
+		slot.info = a_reads[i];
+		slot.cancel_requested.store(false, std::memory_order_relaxed);
+		slot.bytes_read = 0;
+		a_out_reads[i] = OSAsyncRead(slot_index, slot.generation);
+
+#ifdef _LINUX
+		if (use_io_uring)
+		{
+			IOUringPrepareRead(slot_index);
+			slot.status.store(OS_ASYNC_READ_STATUS::PENDING, std::memory_order_release);
+			continue;
+		}
+#endif //_LINUX
+		slot.status.store(OS_ASYNC_READ_STATUS::PENDING, std::memory_order_relaxed);
+		s_async_io.queue[(s_async_io.queue_front + s_async_io.queue_size++) % ASYNC_READ_SLOT_COUNT] = slot_index;
+	}
+
+	uint32_t submitted = a_read_count;
+#ifdef _LINUX
+	if (use_io_uring)
+	{
+		submitted = IOUringSubmit(a_read_count);
+		for (uint32_t i = submitted; i < a_read_count; i++)
+			s_async_io.slots[a_out_reads[i].index].in_io_uring = false;
+	}
+#endif //_LINUX
+	OSReleaseSRWLockWrite(&s_async_io.lock);
+
+	if (!use_io_uring)
+		OSSignalSemaphore(s_async_io.queued, a_read_count);
+
+	// the reads io_uring did not take still finish, so every handle can be waited on like normal.
+	BB_WARNING(submitted == a_read_count, "io_uring submit failed, reading on the calling thread instead", WarningType::HIGH);
+	for (uint32_t i = submitted; i < a_read_count; i++)
+		ReadSlotBlocking(a_out_reads[i].index);
+	return true;
+}
+
+OS_ASYNC_READ_STATUS BB::OSPollAsyncRead(const OSAsyncRead a_read, size_t* a_bytes_read)
+{
+	const uint32_t slot_index = GetSlotIndex(a_read);
+	if (s_async_io.slots[slot_index].status.load(std::memory_order_acquire) == OS_ASYNC_READ_STATUS::PENDING)
+		return OS_ASYNC_READ_STATUS::PENDING;
+	// done, the semaphore is signaled so this does not block.
+	return ReleaseSlot(slot_index, a_bytes_read);
+}
+
+OS_ASYNC_READ_STATUS BB::OSWaitAsyncRead(const OSAsyncRead a_read, size_t* a_bytes_read)
+{
+	return ReleaseSlot(GetSlotIndex(a_read), a_bytes_read);
+}
+
+void BB::OSCancelAsyncRead(const OSAsyncRead a_read)
+{
+	const uint32_t slot_index = GetSlotIndex(a_read);
+	s_async_io.slots[slot_index].cancel_requested.store(true, std::memory_order_relaxed);
+
+#ifdef _LINUX
+	OSAcquireSRWLockWrite(&s_async_io.lock);
+	if (s_async_io.use_io_uring)
+	{
+		io_uring_sqe& sqe = IOUringNextSQE();
+		sqe.opcode = IORING_OP_ASYNC_CANCEL;
+		sqe.addr = slot_index;
+		sqe.user_data = IO_URING_CANCEL_TAG | slot_index;
+		IOUringSubmit(1);
+	}
+	OSReleaseSRWLockWrite(&s_async_io.lock);
+#endif //_LINUX
+}
+
+bool BB::OSRegisterAsyncReadBuffer(void* a_memory, const size_t a_size)
+{
+	InitAsyncFileIO();
+
+	OSAcquireSRWLockWrite(&s_async_io.lock);
+	bool success = s_async_io.free_count == ASYNC_READ_SLOT_COUNT && s_async_io.registered_buffer_count < ASYNC_REGISTERED_BUFFER_MAX;
+	if (success)
+	{
+		s_async_io.registered_buffers[s_async_io.registered_buffer_count++] = { a_memory, a_size };
+#ifdef _LINUX
+		// the io threads read into any memory the same way, only io_uring cares.
+		if (s_async_io.use_io_uring && !IOUringRegisterBuffers())
+		{
+			--s_async_io.registered_buffer_count;
+			IOUringRegisterBuffers();
+			success = false;
+		}
+#endif //_LINUX
+	}
+	OSReleaseSRWLockWrite(&s_async_io.lock);
+	return success;
+}
@@ -0,0 +1,904 @@
+#include "BBGlobal.h"
+#include "Program.h"
+#include "HID.h"
+#include "Utils/Logger.h"
+#include "Storage/Array.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <atomic>
+#include <cstring>
+#include <cwchar>
+
+// linux has no window layer here, the framework runs headless on it for tools, servers and the unit tests.
+// windows are never created and ProcessMessages returns false, so the main loops end after their first frame.
+
+using namespace BB;
+
+static void DefaultClose(WindowHandle) {}
+static void DefaultResize(WindowHandle, uint32_t, uint32_t) {}
+static void DefaultMove(WindowHandle, uint32_t, uint32_t) {}
+
+static PFN_WindowCloseEvent s_pfn_close_event = DefaultClose;
+static PFN_WindowResizeEvent s_pfn_resize_event = DefaultResize;
+static PFN_WindowMoveEvent s_pfn_move_event = DefaultMove;
+
+// reservations store their size in front of them, ReleaseVirtualMemory only gets the pointer.
+struct VirtualMemoryHeader
+{
+	size_t reserved_size;
+};
+
+static size_t s_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+static OSFileHandle FileDescriptorToHandle(const int a_fd)
+{
+	// -1 becomes BB_INVALID_HANDLE_64, like INVALID_HANDLE_VALUE on windows.
+	return OSFileHandle(static_cast<uint64_t>(static_cast<int64_t>(a_fd)));
+}
+
+static int HandleToFileDescriptor(const OSFileHandle a_file_handle)
+{
+	return static_cast<int>(a_file_handle.handle);
+}
+
+static bool WideToMultiByte(const wchar* a_wide, char* a_out, const size_t a_out_size)
+{
+	const size_t size = wcstombs(a_out, a_wide, a_out_size - 1);
+	if (size == static_cast<size_t>(-1))
+	{
+		a_out[0] = '\0';
+		return false;
+	}
+	a_out[size] = '\0';
+	return true;
+}
+
+void BB::InitProgram()
+{
+}
+
+void BB::OSSystemInfo(SystemInfo& a_system_info)
+{
+	a_system_info.processor_num = static_cast<uint32_t>(sysconf(_SC_NPROCESSORS_ONLN));
+	a_system_info.page_size = static_cast<uint32_t>(s_page_size);
+	a_system_info.allocation_granularity = static_cast<uint32_t>(s_page_size);
+}
+
+uint32_t BB::OSPageSize()
+{
+	return static_cast<uint32_t>(s_page_size);
+}
+
+void* BB::ReserveVirtualMemory(const size_t a_size)
+{
+	// one extra page for the header, that page is the only one committed.
+	const size_t reserved_size = RoundUp(a_size, s_page_size) + s_page_size;
+	void* reservation = mmap(nullptr, reserved_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (reservation == MAP_FAILED)
+		return nullptr;
+	if (mprotect(reservation, s_page_size, PROT_READ | PROT_WRITE) != 0)
+	{
+		munmap(reservation, reserved_size);
+		return nullptr;
+	}
+	reinterpret_cast<VirtualMemoryHeader*>(reservation)->reserved_size = reserved_size;
+	return Pointer::Add(reservation, s_page_size);
+}
+
+bool BB::CommitVirtualMemory(void* a_ptr, const size_t a_size)
+{
+	// like VirtualAlloc, every page that the range touches gets committed.
+	const uintptr_t begin = reinterpret_cast<uintptr_t>(a_ptr) & ~(s_page_size - 1);
+	const uintptr_t end = RoundUp(reinterpret_cast<uintptr_t>(a_ptr) + a_size, s_page_size);
+	return mprotect(reinterpret_cast<void*>(begin), end - begin, PROT_READ | PROT_WRITE) == 0;
+}
+
+bool BB::DecommitVirtualMemory(void* a_ptr, const size_t a_size)
+{
+	const uintptr_t begin = reinterpret_cast<uintptr_t>(a_ptr) & ~(s_page_size - 1);
+	const uintptr_t end = RoundUp(reinterpret_cast<uintptr_t>(a_ptr) + a_size, s_page_size);
+	// MADV_DONTNEED gives the pages back, the next commit gets them zeroed like on windows.
+	if (madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED) != 0)
+		return false;
+	return mprotect(reinterpret_cast<void*>(begin), end - begin, PROT_NONE) == 0;
+}
+
+bool BB::AdviseHugePages(void* a_ptr, const size_t a_size)
+{
+	// works on reserved memory as well, the pages that get committed later are backed by huge pages where they are 2mb aligned.
+	const uintptr_t begin = reinterpret_cast<uintptr_t>(a_ptr) & ~(s_page_size - 1);
+	const uintptr_t end = RoundUp(reinterpret_cast<uintptr_t>(a_ptr) + a_size, s_page_size);
+	return madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE) == 0;
+}
+
+bool BB::ReleaseVirtualMemory(void* a_ptr)
+{
+	void* reservation = Pointer::Subtract(a_ptr, s_page_size);
+	const size_t reserved_size = reinterpret_cast<VirtualMemoryHeader*>(reservation)->reserved_size;
+	return munmap(reservation, reserved_size) == 0;
+}
+
+uint32_t BB::LatestOSError()
+{
+	const int error = errno;
+	if (error == 0)
+		return 0;
+
+	BB_WARNING(false, strerror(error), WarningType::HIGH);
+	return static_cast<uint32_t>(error);
+}
+
+LibHandle BB::LoadLib(const wchar* a_lib_name)
+{
+	char lib_name[MAX_PATH_SIZE];
+	if (!WideToMultiByte(a_lib_name, lib_name, sizeof(lib_name)))
+		return LibHandle();
+	return LibHandle(reinterpret_cast<uintptr_t>(dlopen(lib_name, RTLD_NOW | RTLD_LOCAL)));
+}
+
+bool BB::UnloadLib(const LibHandle a_handle)
+{
+	return dlclose(reinterpret_cast<void*>(a_handle.handle)) == 0;
+}
+
+LibFuncPtr BB::LibLoadFunc(const LibHandle a_handle, const char* a_func_name)
+{
+	LibFuncPtr func = dlsym(reinterpret_cast<void*>(a_handle.handle), a_func_name);
+	if (func == nullptr)
+	{
+		BB_WARNING(false, dlerror(), WarningType::HIGH);
+		BB_ASSERT(false, "Failed to load function from .so");
+	}
+	return func;
+}
+
+bool BB::WriteToConsole(const char* a_string, uint32_t a_str_length)
+{
+	return write(STDOUT_FILENO, a_string, a_str_length) == static_cast<ssize_t>(a_str_length);
+}
+
+bool BB::WriteToConsole(const wchar_t* a_string, uint32_t a_str_length)
+{
+	// converted in chunks, a console line is never that long anyway.
+	bool success = true;
+	wchar_t wide_chunk[256];
+	char chunk[sizeof(wide_chunk)];
+	uint32_t written = 0;
+	while (written < a_str_length && success)
+	{
+		const uint32_t chunk_length = Min(a_str_length - written, static_cast<uint32_t>(sizeof(wide_chunk) / sizeof(wide_chunk[0]) - 1));
+		memcpy(wide_chunk, a_string + written, chunk_length * sizeof(wchar_t));
+		wide_chunk[chunk_length] = L'\0';
+		const size_t size = wcstombs(chunk, wide_chunk, sizeof(chunk));
+		if (size == static_cast<size_t>(-1))
+			return false;
+		success = WriteToConsole(chunk, static_cast<uint32_t>(size));
+		written += chunk_length;
+	}
+	return success;
+}
+
+bool BB::OSCreateDirectory(const char* a_path_name)
+{
+	return mkdir(a_path_name, 0755) == 0;
+}
+
+bool BB::OSDirectoryExist(const char* a_path_name)
+{
+	struct stat info;
+	return stat(a_path_name, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool BB::OSSetCurrentDirectory(const char* a_path_name)
+{
+	return chdir(a_path_name) == 0;
+}
+
+bool BB::OSFileIsValid(const OSFileHandle a_file_handle)
+{
+	return a_file_handle.handle != BB_INVALID_HANDLE_64;
+}
+
+OSFileHandle BB::OSCreateFile(const char* a_file_name)
+{
+	return FileDescriptorToHandle(open(a_file_name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+}
+
+OSFileHandle BB::OSCreateFile(const wchar* a_file_name)
+{
+	char file_name[MAX_PATH_SIZE];
+	if (!WideToMultiByte(a_file_name, file_name, sizeof(file_name)))
+		return OSFileHandle();
+	return OSCreateFile(file_name);
+}
+
+OSFileHandle BB::OSLoadFile(const char* a_file_name)
+{
+	int fd = open(a_file_name, O_RDWR | O_CLOEXEC);
+	// installed resources are often read only, reading them is all that is needed.
+	if (fd == -1 && errno == EACCES)
+		fd = open(a_file_name, O_RDONLY | O_CLOEXEC);
+	return FileDescriptorToHandle(fd);
+}
+
+OSFileHandle BB::OSLoadFile(const wchar* a_file_name)
+{
+	char file_name[MAX_PATH_SIZE];
+	if (!WideToMultiByte(a_file_name, file_name, sizeof(file_name)))
+		return OSFileHandle();
+	return OSLoadFile(file_name);
+}
+
+void BB::OSReadFile(const OSFileHandle a_file_handle, void* a_memory, const size_t a_memory_size)
+{
+	size_t bytes_read = 0;
+	while (bytes_read < a_memory_size)
+	{
+		const ssize_t result = read(HandleToFileDescriptor(a_file_handle), Pointer::Add(a_memory, bytes_read), a_memory_size - bytes_read);
+		if (result == -1 && errno == EINTR)
+			continue;
+		if (result <= 0)
+		{
+			LatestOSError();
+			BB_WARNING(false,
+				"OS, failed to read file!",
+				WarningType::HIGH);
+			return;
+		}
+		bytes_read += static_cast<size_t>(result);
+	}
+}
+
+Buffer BB::OSReadFile(MemoryArena& a_arena, const OSFileHandle a_file_handle)
+{
+	Buffer file_buffer{};
+	file_buffer.size = GetOSFileSize(a_file_handle);
+	file_buffer.data = reinterpret_cast<char*>(ArenaAlloc(a_arena, file_buffer.size, alignof(size_t)));
+
+	OSReadFile(a_file_handle, file_buffer.data, file_buffer.size);
+
+	return file_buffer;
+}
+
+Buffer BB::OSReadFile(MemoryArena& a_arena, const char* a_path)
+{
+	OSFileHandle read_file = OSLoadFile(a_path);
+	BB_ASSERT(OSFileIsValid(read_file), "OS file invalid, will cause errors");
+
+	Buffer file_buffer = OSReadFile(a_arena, read_file);
+
+	CloseOSFile(read_file);
+
+	return file_buffer;
+}
+
+Buffer BB::OSReadFile(MemoryArena& a_arena, const wchar* a_path)
+{
+	OSFileHandle read_file = OSLoadFile(a_path);
+	BB_ASSERT(OSFileIsValid(read_file), "OS file invalid, will cause errors");
+
+	Buffer file_buffer = OSReadFile(a_arena, read_file);
+
+	CloseOSFile(read_file);
+
+	return file_buffer;
+}
+
+// a_path is a directory and a wildcard pattern like FindFirstFile takes, "scripts/*lua".
+bool BB::OSGetDirectoryEntries(MemoryArena& a_arena, const char* a_path, ConstSlice<StackString<MAX_PATH_SIZE>>& a_out_entries)
+{
+	char directory[MAX_PATH_SIZE];
+	const char* pattern = strrchr(a_path, '/');
+	if (pattern == nullptr)
+	{
+		directory[0] = '.';
+		directory[1] = '\0';
+		pattern = a_path;
+	}
+	else
+	{
+		const size_t directory_size = static_cast<size_t>(pattern - a_path);
+		if (directory_size >= sizeof(directory))
+			return false;
+		memcpy(directory, a_path, directory_size);
+		directory[directory_size] = '\0';
+		++pattern;
+	}
+
+	DIR* dir = opendir(directory);
+	if (dir == nullptr)
+		return false;
+
+	uint32_t entries = 0;
+	while (const dirent* entry = readdir(dir))
+		if (fnmatch(pattern, entry->d_name, 0) == 0)
+			++entries;
+	if (entries == 0)
+	{
+		closedir(dir);
+		return false;
+	}
+
+	StaticArray<StackString<MAX_PATH_SIZE>> arr{};
+	arr.Init(a_arena, entries);
+	rewinddir(dir);
+	while (const dirent* entry = readdir(dir))
+		if (fnmatch(pattern, entry->d_name, 0) == 0 && arr.size() < entries)
+			arr.emplace_back(entry->d_name);
+
+	a_out_entries = arr.const_slice();
+
+	return closedir(dir) == 0;
+}
+
+bool BB::OSWriteFile(const OSFileHandle a_file_handle, const void* a_data, const size_t a_size)
+{
+	size_t bytes_written = 0;
+	while (bytes_written < a_size)
+	{
+		const ssize_t result = write(HandleToFileDescriptor(a_file_handle), Pointer::Add(a_data, bytes_written), a_size - bytes_written);
+		if (result == -1 && errno == EINTR)
+			continue;
+		if (result <= 0)
+			return false;
+		bytes_written += static_cast<size_t>(result);
+	}
+	return true;
+}
+
+uint64_t BB::GetOSFileSize(const OSFileHandle a_file_handle)
+{
+	struct stat info;
+	if (fstat(HandleToFileDescriptor(a_file_handle), &info) != 0)
+		return 0;
+	return static_cast<uint64_t>(info.st_size);
+}
+
+void BB::SetOSFilePosition(const OSFileHandle a_file_handle, const uint32_t a_offset, const OS_FILE_READ_POINT a_file_read_point)
+{
+	const off_t position = lseek(HandleToFileDescriptor(a_file_handle), static_cast<off_t>(a_offset), static_cast<int>(a_file_read_point));
+#ifdef _DEBUG
+	if (position == -1 &&
+		LatestOSError() == EINVAL)
+	{
+		BB_WARNING(false,
+			"OS, Setting the file position failed by putting it in negative! LINUX ERROR: EINVAL.",
+			WarningType::HIGH);
+	}
+#else
+	(void)position;
+#endif //_DEBUG
+}
+
+bool BB::OSFileExist(const char* a_path)
+{
+	if (access(a_path, F_OK) != 0)
+	{
+		// make sure that the error is nothing else
+		BB_ASSERT(errno == ENOENT, "OSFileExist is false but not related to the file not existing, this should never happen");
+		return false;
+	}
+	return true;
+}
+
+bool BB::OSFindFileNameDialogWindow(char*, const size_t, const char*)
+{
+	BB_WARNING(false, "OSFindFileNameDialogWindow, no file dialog on linux", WarningType::MEDIUM);
+	return false;
+}
+
+bool BB::OSOpenFolder(const StringView a_directory, MemoryArenaTemp)
+{
+	// leave it to the desktop, like explorer does on windows.
+	char* argv[] = { const_cast<char*>("xdg-open"), const_cast<char*>(a_directory.c_str()), nullptr };
+	pid_t pid;
+	return posix_spawnp(&pid, "xdg-open", nullptr, nullptr, argv, environ) == 0;
+}
+
+bool BB::CloseOSFile(const OSFileHandle a_file_handle)
+{
+	return close(HandleToFileDescriptor(a_file_handle)) == 0;
+}
+
+size_t BB::OSReadFileAt(const OSFileHandle a_file_handle, void* a_memory, const size_t a_size, const uint64_t a_offset)
+{
+	size_t bytes_read = 0;
+	while (bytes_read < a_size)
+	{
+		const ssize_t result = pread(HandleToFileDescriptor(a_file_handle), Pointer::Add(a_memory, bytes_read), a_size - bytes_read, static_cast<off_t>(a_offset + bytes_read));
+		if (result == -1 && errno == EINTR)
+			continue;
+		if (result <= 0)
+			break;
+		bytes_read += static_cast<size_t>(result);
+	}
+	return bytes_read;
+}
+
+OSMappedFile BB::OSMapFile(const char* a_path, const OS_MAP_HINT a_hint)
+{
+	OSMappedFile mapped_file{ nullptr, 0 };
+	const int fd = open(a_path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return mapped_file;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+	{
+		const size_t size = static_cast<size_t>(file_stat.st_size);
+		// the mapping holds its own reference to the file, the descriptor is not needed after this.
+		void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED)
+		{
+			if (a_hint == OS_MAP_HINT::SEQUENTIAL)
+				madvise(data, size, MADV_SEQUENTIAL);
+			else if (a_hint == OS_MAP_HINT::WILL_NEED)
+				madvise(data, size, MADV_WILLNEED);
+			mapped_file.data = data;
+			mapped_file.size = size;
+		}
+	}
+	close(fd);
+	return mapped_file;
+}
+
+void BB::OSUnmapFile(const OSMappedFile& a_mapped_file)
+{
+	if (a_mapped_file.IsValid())
+		munmap(const_cast<void*>(a_mapped_file.data), a_mapped_file.size);
+}
+
+void* BB::OSCreateMirroredMemory(size_t& a_size)
+{
+	a_size = RoundUp(a_size, s_page_size);
+	// an anonymous file is the physical memory, both halves of the reservation map it.
+	const int fd = memfd_create("bb_mirrored_memory", MFD_CLOEXEC);
+	if (fd == -1)
+		return nullptr;
+
+	uint8_t* memory = nullptr;
+	if (ftruncate(fd, static_cast<off_t>(a_size)) == 0)
+	{
+		void* reservation = mmap(nullptr, a_size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (reservation != MAP_FAILED)
+		{
+			memory = reinterpret_cast<uint8_t*>(reservation);
+			if (mmap(memory, a_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+				mmap(memory + a_size, a_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+			{
+				munmap(reservation, a_size * 2);
+				memory = nullptr;
+			}
+		}
+	}
+	// the mappings keep the file alive.
+	close(fd);
+	return memory;
+}
+
+bool BB::OSFreeMirroredMemory(void* a_ptr, const size_t a_size)
+{
+	return munmap(a_ptr, a_size * 2) == 0;
+}
+
+// pthreads want a function that returns void*, the framework thread functions return nothing.
+struct ThreadStart
+{
+	void(*func)(void*);
+	void* arg;
+};
+
+static void* ThreadStartFunc(void* a_thread_start)
+{
+	const ThreadStart thread_start = *reinterpret_cast<ThreadStart*>(a_thread_start);
+	free(a_thread_start);
+	thread_start.func(thread_start.arg);
+	return nullptr;
+}
+
+OSThreadHandle BB::OSCreateThread(void(*a_func)(void*), const unsigned int a_stack_size, void* a_arg_list)
+{
+	ThreadStart* thread_start = reinterpret_cast<ThreadStart*>(malloc(sizeof(ThreadStart)));
+	thread_start->func = a_func;
+	thread_start->arg = a_arg_list;
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	if (a_stack_size != 0)
+		pthread_attr_setstacksize(&attributes, Max(static_cast<size_t>(a_stack_size), static_cast<size_t>(PTHREAD_STACK_MIN)));
+
+	pthread_t thread;
+	const int result = pthread_create(&thread, &attributes, ThreadStartFunc, thread_start);
+	pthread_attr_destroy(&attributes);
+	if (result != 0)
+	{
+		free(thread_start);
+		return OSThreadHandle();
+	}
+	return OSThreadHandle(static_cast<uint64_t>(thread));
+}
+
+bool BB::OSWaitThreadfinish(const OSThreadHandle a_thread)
+{
+	return pthread_join(static_cast<pthread_t>(a_thread.handle), nullptr) == 0;
+}
+
+bool BB::OSSetThreadName(const wchar_t* a_wstr)
+{
+	// linux thread names are 15 characters at most.
+	char name[64];
+	WideToMultiByte(a_wstr, name, sizeof(name));
+	name[15] = '\0';
+	return pthread_setname_np(pthread_self(), name) == 0;
+}
+
+bool BB::OSSetThreadAffinity(const OSThreadHandle a_thread, const uint64_t a_core_mask)
+{
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (uint32_t core = 0; core < 64; core++)
+		if (a_core_mask & (1ull << core))
+			CPU_SET(core, &cpu_set);
+	return pthread_setaffinity_np(static_cast<pthread_t>(a_thread.handle), sizeof(cpu_set), &cpu_set) == 0;
+}
+
+//////// futex synchronization ////////
+// the mutex and the semaphore are heap allocated since their handles are passed by value.
+// the rw lock and the condition variable live in the 64 bit handle itself, like SRWLOCK and CONDITION_VARIABLE on windows.
+// all of them spin a little first, most waits in the job system are shorter then a trip through the kernel.
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free);
+constexpr uint32_t FUTEX_SPIN_COUNT = 64;
+
+static inline void CPURelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+static void FutexWait(std::atomic<uint32_t>* a_address, const uint32_t a_expected)
+{
+	// returns right away when the value is no longer a_expected, the callers check the state again either way.
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(a_address), FUTEX_WAIT_PRIVATE, a_expected, nullptr, nullptr, 0);
+}
+
+static void FutexWake(std::atomic<uint32_t>* a_address, const int a_count)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(a_address), FUTEX_WAKE_PRIVATE, a_count, nullptr, nullptr, 0);
+}
+
+template<typename Tag>
+static std::atomic<uint32_t>* HandleAtomic(FrameworkHandle<Tag>* a_handle)
+{
+	return reinterpret_cast<std::atomic<uint32_t>*>(&a_handle->index);
+}
+
+// 0 unlocked, 1 locked, 2 locked and there might be threads sleeping on it.
+struct FutexMutex
+{
+	std::atomic<uint32_t> state;
+};
+
+BBMutex BB::OSCreateMutex()
+{
+	FutexMutex* mutex = new FutexMutex();
+	mutex->state.store(0, std::memory_order_relaxed);
+	return BBMutex(reinterpret_cast<uintptr_t>(mutex));
+}
+
+bool BB::OSWaitAndLockMutex(const BBMutex a_mutex)
+{
+	FutexMutex* mutex = reinterpret_cast<FutexMutex*>(a_mutex.handle);
+	uint32_t state = 0;
+	for (uint32_t i = 0; i < FUTEX_SPIN_COUNT; i++)
+	{
+		state = 0;
+		if (mutex->state.compare_exchange_weak(state, 1, std::memory_order_acquire, std::memory_order_relaxed))
+			return true;
+		if (state == 2)
+			break;
+		CPURelax();
+	}
+
+	// from here on the unlock has to wake someone, so it is always taken as 2.
+	state = mutex->state.exchange(2, std::memory_order_acquire);
+	while (state != 0)
+	{
+		FutexWait(&mutex->state, 2);
+		state = mutex->state.exchange(2, std::memory_order_acquire);
+	}
+	return true;
+}
+
+bool BB::OSUnlockMutex(const BBMutex a_mutex)
+{
+	FutexMutex* mutex = reinterpret_cast<FutexMutex*>(a_mutex.handle);
+	if (mutex->state.exchange(0, std::memory_order_release) == 2)
+		FutexWake(&mutex->state, 1);
+	return true;
+}
+
+bool BB::OSDestroyMutex(const BBMutex a_mutex)
+{
+	delete reinterpret_cast<FutexMutex*>(a_mutex.handle);
+	return true;
+}
+
+struct FutexSemaphore
+{
+	std::atomic<uint32_t> count;
+	std::atomic<uint32_t> waiters;
+	uint32_t maximum_count;
+};
+
+BBSemaphore BB::OSCreateSemaphore(const uint32_t a_initial_count, const uint32_t a_maximum_count)
+{
+	FutexSemaphore* semaphore = new FutexSemaphore();
+	semaphore->count.store(a_initial_count, std::memory_order_relaxed);
+	semaphore->waiters.store(0, std::memory_order_relaxed);
+	semaphore->maximum_count = a_maximum_count;
+	return BBSemaphore(reinterpret_cast<uintptr_t>(semaphore));
+}
+
+bool BB::OSWaitSemaphore(const BBSemaphore a_semaphore)
+{
+	FutexSemaphore* semaphore = reinterpret_cast<FutexSemaphore*>(a_semaphore.handle);
+	uint32_t spin = 0;
+	while (true)
+	{
+		uint32_t count = semaphore->count.load(std::memory_order_relaxed);
+		while (count != 0)
+		{
+			if (semaphore->count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+		}
+
+		if (spin++ < FUTEX_SPIN_COUNT)
+		{
+			CPURelax();
+			continue;
+		}
+
+		// a signal between the check and the wait changes the count, so the wait returns right away.
+		semaphore->waiters.fetch_add(1, std::memory_order_seq_cst);
+		FutexWait(&semaphore->count, 0);
+		semaphore->waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+bool BB::OSSignalSemaphore(const BBSemaphore a_semaphore, const uint32_t a_signal_count)
+{
+	FutexSemaphore* semaphore = reinterpret_cast<FutexSemaphore*>(a_semaphore.handle);
+	uint32_t count = semaphore->count.load(std::memory_order_relaxed);
+	do
+	{
+		// ReleaseSemaphore fails and changes nothing when it would go over the maximum.
+		if (count + a_signal_count > semaphore->maximum_count)
+			return false;
+	} while (!semaphore->count.compare_exchange_weak(count, count + a_signal_count, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+	if (semaphore->waiters.load(std::memory_order_seq_cst) != 0)
+		FutexWake(&semaphore->count, static_cast<int>(a_signal_count));
+	return true;
+}
+
+bool BB::OSDestroySemaphore(const BBSemaphore a_semaphore)
+{
+	delete reinterpret_cast<FutexSemaphore*>(a_semaphore.handle);
+	return true;
+}
+
+// the low bits count the readers.
+constexpr uint32_t RW_LOCK_WRITER = 1u << 30;
+constexpr uint32_t RW_LOCK_WAITERS = 1u << 31;
+constexpr uint32_t RW_LOCK_READER_MASK = RW_LOCK_WRITER - 1;
+
+BBRWLock BB::OSCreateRWLock()
+{
+	return BBRWLock(static_cast<uint64_t>(0));
+}
+
+// a_blocked are the bits that stop this acquire, a_add is what the acquire adds to the state.
+static void RWLockAcquire(std::atomic<uint32_t>* a_state, const uint32_t a_blocked, const uint32_t a_add)
+{
+	uint32_t spin = 0;
+	uint32_t state = a_state->load(std::memory_order_relaxed);
+	while (true)
+	{
+		if ((state & a_blocked) == 0)
+		{
+			if (a_state->compare_exchange_weak(state, state + a_add, std::memory_order_acquire, std::memory_order_relaxed))
+				return;
+			continue;
+		}
+
+		if (spin++ < FUTEX_SPIN_COUNT)
+		{
+			CPURelax();
+			state = a_state->load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// mark that someone sleeps, so the release knows to wake.
+		if ((state & RW_LOCK_WAITERS) == 0 && !a_state->compare_exchange_weak(state, state | RW_LOCK_WAITERS, std::memory_order_relaxed))
+			continue;
+		FutexWait(a_state, state | RW_LOCK_WAITERS);
+		state = a_state->load(std::memory_order_relaxed);
+	}
+}
+
+static void RWLockWakeWaiters(std::atomic<uint32_t>* a_state)
+{
+	// readers and writers sleep on the same word, everyone wakes and tries again.
+	a_state->fetch_and(~RW_LOCK_WAITERS, std::memory_order_relaxed);
+	FutexWake(a_state, INT32_MAX);
+}
+
+void BB::OSAcquireSRWLockRead(BBRWLock* a_lock)
+{
+	RWLockAcquire(HandleAtomic(a_lock), RW_LOCK_WRITER, 1);
+}
+
+void BB::OSAcquireSRWLockWrite(BBRWLock* a_lock)
+{
+	RWLockAcquire(HandleAtomic(a_lock), RW_LOCK_WRITER | RW_LOCK_READER_MASK, RW_LOCK_WRITER);
+}
+
+void BB::OSReleaseSRWLockRead(BBRWLock* a_lock)
+{
+	std::atomic<uint32_t>* state = HandleAtomic(a_lock);
+	const uint32_t previous = state->fetch_sub(1, std::memory_order_release);
+	BB_ASSERT((previous & RW_LOCK_READER_MASK) != 0, "releasing a read lock that is not held");
+	if ((previous & RW_LOCK_READER_MASK) == 1 && (previous & RW_LOCK_WAITERS))
+		RWLockWakeWaiters(state);
+}
+
+void BB::OSReleaseSRWLockWrite(BBRWLock* a_lock)
+{
+	std::atomic<uint32_t>* state = HandleAtomic(a_lock);
+	const uint32_t previous = state->fetch_and(~RW_LOCK_WRITER, std::memory_order_release);
+	BB_ASSERT(previous & RW_LOCK_WRITER, "releasing a write lock that is not held");
+	if (previous & RW_LOCK_WAITERS)
+		RWLockWakeWaiters(state);
+}
+
+// a sequence number, a wake changes it so a waiter that has not gone to sleep yet does not miss it.
+BBConditionalVariable BB::OSCreateConditionalVariable()
+{
+	return BBConditionalVariable(static_cast<uint64_t>(0));
+}
+
+bool BB::OSWaitConditionalVariableShared(BBConditionalVariable* a_condition, BBRWLock* a_lock)
+{
+	std::atomic<uint32_t>* sequence = HandleAtomic(a_condition);
+	const uint32_t current = sequence->load(std::memory_order_relaxed);
+	OSReleaseSRWLockRead(a_lock);
+	FutexWait(sequence, current);
+	OSAcquireSRWLockRead(a_lock);
+	return true;
+}
+
+bool BB::OSWaitConditionalVariableExclusive(BBConditionalVariable* a_condition, BBRWLock* a_lock)
+{
+	std::atomic<uint32_t>* sequence = HandleAtomic(a_condition);
+	const uint32_t current = sequence->load(std::memory_order_relaxed);
+	OSReleaseSRWLockWrite(a_lock);
+	FutexWait(sequence, current);
+	OSAcquireSRWLockWrite(a_lock);
+	return true;
+}
+
+void BB::OSWakeConditionVariable(BBConditionalVariable* a_condition)
+{
+	std::atomic<uint32_t>* sequence = HandleAtomic(a_condition);
+	sequence->fetch_add(1, std::memory_order_relaxed);
+	FutexWake(sequence, 1);
+}
+
+//////// headless window functions ////////
+
+WindowHandle BB::CreateOSWindow(const OS_WINDOW_STYLE, const int, const int, const int, const int, const wchar*)
+{
+	BB_WARNING(false, "CreateOSWindow, linux runs headless and has no windows", WarningType::MEDIUM);
+	return WindowHandle();
+}
+
+void* BB::GetOSWindowHandle(const WindowHandle)
+{
+	return nullptr;
+}
+
+bool BB::OSGetWindowSize(const WindowHandle, int& a_x, int& a_y)
+{
+	a_x = 0;
+	a_y = 0;
+	return false;
+}
+
+bool BB::OSGetWindowOffset(const WindowHandle, int& a_x, int& a_y)
+{
+	a_x = 0;
+	a_y = 0;
+	return false;
+}
+
+bool BB::DirectDestroyOSWindow(const WindowHandle)
+{
+	return false;
+}
+
+bool BB::FreezeMouseOnWindow(const WindowHandle)
+{
+	return false;
+}
+
+bool BB::UnfreezeMouseOnWindow()
+{
+	return true;
+}
+
+float2 BB::OSGetCursorPos(const WindowHandle)
+{
+	return float2(0.f, 0.f);
+}
+
+void BB::OSMessageBoxOk(const char* a_box_title, const char* a_message)
+{
+	WriteToConsole(a_box_title, static_cast<uint32_t>(strlen(a_box_title)));
+	WriteToConsole(": ", 2);
+	WriteToConsole(a_message, static_cast<uint32_t>(strlen(a_message)));
+	WriteToConsole("\n", 1);
+}
+
+bool BB::OSMessageBoxYesNo(const char* a_box_title, const char* a_message)
+{
+	// nobody to answer, so no.
+	OSMessageBoxOk(a_box_title, a_message);
+	return false;
+}
+
+void BB::SetWindowCloseEvent(PFN_WindowCloseEvent a_func)
+{
+	s_pfn_close_event = a_func;
+}
+
+void BB::SetWindowResizeEvent(PFN_WindowResizeEvent a_func)
+{
+	s_pfn_resize_event = a_func;
+}
+
+void BB::SetWindowMoveEvent(PFN_WindowMoveEvent a_func)
+{
+	s_pfn_move_event = a_func;
+}
+
+BB_NO_RETURN void BB::ExitApp()
+{
+	exit(EXIT_SUCCESS);
+}
+
+bool BB::ProcessMessages(const WindowHandle)
+{
+	return false;
+}
+
+void BB::PollInputEvents(InputEvent*, size_t& input_event_amount)
+{
+	input_event_amount = 0;
+}
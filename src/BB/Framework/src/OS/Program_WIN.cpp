@@ -258,6 +258,12 @@ bool BB::DecommitVirtualMemory(void* a_ptr, const size_t a_size)
 	return VirtualFree(a_ptr, a_size, MEM_DECOMMIT);
 }
 
+bool BB::AdviseHugePages(void*, const size_t)
+{
+	// large pages on windows need SeLockMemoryPrivilege and have to be committed at reserve time, nothing transparent about it.
+	return false;
+}
+
 bool BB::ReleaseVirtualMemory(void* a_ptr)
 {
 	return VirtualFree(a_ptr, 0, MEM_RELEASE);
@@ -586,6 +592,126 @@ bool BB::CloseOSFile(const OSFileHandle a_file_handle)
 	return CloseHandle(reinterpret_cast<HANDLE>(a_file_handle.handle));
 }
 
+size_t BB::OSReadFileAt(const OSFileHandle a_file_handle, void* a_memory, const size_t a_size, const uint64_t a_offset)
+{
+	// the OVERLAPPED offset works on handles without FILE_FLAG_OVERLAPPED too, the call just blocks.
+	size_t bytes_read = 0;
+	while (bytes_read < a_size)
+	{
+		const uint64_t offset = a_offset + bytes_read;
+		OVERLAPPED overlapped{};
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		const DWORD read_size = static_cast<DWORD>(Min(a_size - bytes_read, static_cast<size_t>(UINT32_MAX)));
+		DWORD read = 0;
+		if (FALSE == ReadFile(reinterpret_cast<HANDLE>(a_file_handle.handle), Pointer::Add(a_memory, bytes_read), read_size, &read, &overlapped) || read == 0)
+			break;
+		bytes_read += read;
+	}
+	return bytes_read;
+}
+
+OSMappedFile BB::OSMapFile(const char* a_path, const OS_MAP_HINT a_hint)
+{
+	OSMappedFile mapped_file{ nullptr, 0 };
+	const DWORD flags = a_hint == OS_MAP_HINT::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+	const HANDLE file = CreateFileA(a_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return mapped_file;
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+	{
+		// the view keeps the mapping object and the file alive, both handles can be closed right away.
+		const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (data)
+			{
+				mapped_file.data = data;
+				mapped_file.size = static_cast<size_t>(file_size.QuadPart);
+				if (a_hint == OS_MAP_HINT::WILL_NEED)
+				{
+					WIN32_MEMORY_RANGE_ENTRY range{ data, mapped_file.size };
+					PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+				}
+			}
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	return mapped_file;
+}
+
+void BB::OSUnmapFile(const OSMappedFile& a_mapped_file)
+{
+	if (a_mapped_file.IsValid())
+		UnmapViewOfFile(a_mapped_file.data);
+}
+
+// placeholders came with windows 10 1803 and live in onecore, load them at runtime instead of linking against it.
+#ifndef MEM_RESERVE_PLACEHOLDER
+#define MEM_RESERVE_PLACEHOLDER 0x00040000
+#define MEM_REPLACE_PLACEHOLDER 0x00004000
+#define MEM_PRESERVE_PLACEHOLDER 0x00000002
+#endif
+typedef PVOID(WINAPI* PFN_VirtualAlloc2)(HANDLE a_process, PVOID a_base_address, SIZE_T a_size, ULONG a_allocation_type, ULONG a_page_protection, void* a_extended_parameters, ULONG a_parameter_count);
+typedef PVOID(WINAPI* PFN_MapViewOfFile3)(HANDLE a_file_mapping, HANDLE a_process, PVOID a_base_address, ULONG64 a_offset, SIZE_T a_view_size, ULONG a_allocation_type, ULONG a_page_protection, void* a_extended_parameters, ULONG a_parameter_count);
+
+void* BB::OSCreateMirroredMemory(size_t& a_size)
+{
+	static const HMODULE kernelbase = LoadLibraryW(L"kernelbase.dll");
+	static const PFN_VirtualAlloc2 virtual_alloc2 = reinterpret_cast<PFN_VirtualAlloc2>(GetProcAddress(kernelbase, "VirtualAlloc2"));
+	static const PFN_MapViewOfFile3 map_view_of_file3 = reinterpret_cast<PFN_MapViewOfFile3>(GetProcAddress(kernelbase, "MapViewOfFile3"));
+	if (virtual_alloc2 == nullptr || map_view_of_file3 == nullptr)
+		return nullptr;
+
+	SYSTEM_INFO sys_info;
+	GetSystemInfo(&sys_info);
+	a_size = RoundUp(a_size, static_cast<size_t>(sys_info.dwAllocationGranularity));
+
+	const HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(static_cast<uint64_t>(a_size) >> 32), static_cast<DWORD>(a_size & 0xFFFFFFFF), nullptr);
+	if (mapping == nullptr)
+		return nullptr;
+
+	// reserve both halves as one placeholder and split it, each half then gets replaced by a view of the same mapping.
+	uint8_t* memory = reinterpret_cast<uint8_t*>(virtual_alloc2(nullptr, nullptr, a_size * 2, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0));
+	void* first_view = nullptr;
+	void* second_view = nullptr;
+	if (memory && VirtualFree(memory, a_size, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+	{
+		first_view = map_view_of_file3(mapping, nullptr, memory, 0, a_size, MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+		if (first_view)
+			second_view = map_view_of_file3(mapping, nullptr, memory + a_size, 0, a_size, MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+	}
+
+	// the views keep the mapping alive.
+	CloseHandle(mapping);
+	if (second_view)
+		return memory;
+
+	if (first_view)
+	{
+		UnmapViewOfFile(first_view);
+		VirtualFree(memory + a_size, 0, MEM_RELEASE);
+	}
+	else if (memory)
+	{
+		VirtualFree(memory, 0, MEM_RELEASE);
+		VirtualFree(memory + a_size, 0, MEM_RELEASE);
+	}
+	return nullptr;
+}
+
+bool BB::OSFreeMirroredMemory(void* a_ptr, const size_t a_size)
+{
+	const bool first = UnmapViewOfFile(a_ptr);
+	const bool second = UnmapViewOfFile(reinterpret_cast<uint8_t*>(a_ptr) + a_size);
+	return first && second;
+}
+
 OSThreadHandle BB::OSCreateThread(void(*a_func)(void*), const unsigned int a_stack_size, void* a_arg_list)
 {
 	return OSThreadHandle(_beginthread(a_func, a_stack_size, a_arg_list));
@@ -601,6 +727,11 @@ bool BB::OSSetThreadName(const wchar_t* a_wstr)
 	return SetThreadDescription(GetCurrentThread(), a_wstr);
 }
 
+bool BB::OSSetThreadAffinity(const OSThreadHandle a_thread, const uint64_t a_core_mask)
+{
+	return SetThreadAffinityMask(reinterpret_cast<HANDLE>(a_thread.handle), static_cast<DWORD_PTR>(a_core_mask)) != 0;
+}
+
 BBMutex BB::OSCreateMutex()
 {
 	return BBMutex(reinterpret_cast<uintptr_t>(CreateMutex(nullptr, false, nullptr)));
@@ -0,0 +1,277 @@
+#include "RenderGraph.hpp"
+#include "MemoryArena.hpp"
+#include "Logger.h"
+#include "Utils/Utils.h"
+
+using namespace BB;
+
+void RenderGraph::Init(MemoryArena& a_arena, const uint32_t a_max_passes, const uint32_t a_max_resources, const uint32_t a_max_accesses)
+{
+	m_resources.Init(a_arena, a_max_resources);
+	m_passes.Init(a_arena, a_max_passes);
+	m_accesses.Init(a_arena, a_max_accesses);
+}
+
+void RenderGraph::Reset()
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_accesses.clear();
+}
+
+RGResource RenderGraph::CreateTransient(const char* a_name, const uint64_t a_size, const uint64_t a_alignment)
+{
+	BB_ASSERT(a_alignment != 0, "transient resource alignment cannot be 0");
+	Resource resource;
+	resource.name = a_name;
+	resource.size = a_size;
+	resource.alignment = a_alignment;
+	resource.import_state = RENDER_GRAPH_STATE_UNDEFINED;
+	resource.imported = false;
+	m_resources.push_back(resource);
+	return RGResource(m_resources.size() - 1);
+}
+
+RGResource RenderGraph::Import(const char* a_name, const uint32_t a_state)
+{
+	Resource resource;
+	resource.name = a_name;
+	resource.size = 0;
+	resource.alignment = 1;
+	resource.import_state = a_state;
+	resource.imported = true;
+	m_resources.push_back(resource);
+	return RGResource(m_resources.size() - 1);
+}
+
+RGPass RenderGraph::AddPass(const char* a_name, const bool a_has_side_effects)
+{
+	Pass pass;
+	pass.name = a_name;
+	pass.access_start = m_accesses.size();
+	pass.access_count = 0;
+	pass.has_side_effects = a_has_side_effects;
+	m_passes.push_back(pass);
+	return RGPass(m_passes.size() - 1);
+}
+
+void RenderGraph::Read(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state)
+{
+	AddAccess(a_pass, a_resource, a_state, RENDER_GRAPH_ACCESS::READ);
+}
+
+void RenderGraph::Write(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state)
+{
+	AddAccess(a_pass, a_resource, a_state, RENDER_GRAPH_ACCESS::WRITE);
+}
+
+void RenderGraph::Overwrite(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state)
+{
+	AddAccess(a_pass, a_resource, a_state, RENDER_GRAPH_ACCESS::OVERWRITE);
+}
+
+void RenderGraph::AddAccess(const RGPass a_pass, const RGResource a_resource, const uint32_t a_state, const RENDER_GRAPH_ACCESS a_access)
+{
+	Pass& pass = m_passes[a_pass.handle];
+	// the accesses of a pass are stored together, so they must be added before the next pass.
+	BB_ASSERT(pass.access_start + pass.access_count == m_accesses.size(), "render graph accesses must be added directly after their pass");
+	BB_ASSERT(a_resource.handle < m_resources.size(), "render graph resource does not exist");
+	for (uint32_t i = pass.access_start; i < pass.access_start + pass.access_count; i++)
+		BB_ASSERT(m_accesses[i].resource != a_resource, "a render graph pass can only access a resource once, use Write for read and write");
+
+	Access access;
+	access.resource = a_resource;
+	access.state = a_state;
+	access.access = a_access;
+	m_accesses.push_back(access);
+	++pass.access_count;
+}
+
+RenderGraphPlan RenderGraph::Compile(MemoryArena& a_arena) const
+{
+	const uint32_t pass_count = m_passes.size();
+	const uint32_t resource_count = m_resources.size();
+
+	// walk back from the outputs, a pass runs when it writes something that is imported or that a running pass reads.
+	bool* pass_alive = ArenaAllocArr(a_arena, bool, pass_count);
+	bool* content_needed = ArenaAllocArr(a_arena, bool, resource_count);
+	for (uint32_t i = 0; i < resource_count; i++)
+		content_needed[i] = false;
+
+	uint32_t alive_count = 0;
+	for (uint32_t pass_index = pass_count; pass_index-- > 0;)
+	{
+		const Pass& pass = m_passes[pass_index];
+		bool alive = pass.has_side_effects;
+		for (uint32_t i = pass.access_start; i < pass.access_start + pass.access_count; i++)
+		{
+			const Access& access = m_accesses[i];
+			if (access.access != RENDER_GRAPH_ACCESS::READ && (m_resources[access.resource.handle].imported || content_needed[access.resource.handle]))
+				alive = true;
+		}
+
+		pass_alive[pass_index] = alive;
+		if (!alive)
+			continue;
+		++alive_count;
+
+		// an overwrite does not need the earlier content, everything else does.
+		for (uint32_t i = pass.access_start; i < pass.access_start + pass.access_count; i++)
+		{
+			const Access& access = m_accesses[i];
+			content_needed[access.resource.handle] = access.access != RENDER_GRAPH_ACCESS::OVERWRITE;
+		}
+	}
+
+	RenderGraphPassPlan* passes = ArenaAllocArr(a_arena, RenderGraphPassPlan, alive_count);
+	RenderGraphResourcePlan* resources = ArenaAllocArr(a_arena, RenderGraphResourcePlan, resource_count);
+	for (uint32_t i = 0; i < resource_count; i++)
+	{
+		resources[i].heap_offset = 0;
+		resources[i].first_pass = RENDER_GRAPH_INVALID_PASS;
+		resources[i].last_pass = RENDER_GRAPH_INVALID_PASS;
+		resources[i].final_state = m_resources[i].import_state;
+	}
+
+	uint32_t plan_pass_count = 0;
+	for (uint32_t pass_index = 0; pass_index < pass_count; pass_index++)
+	{
+		if (!pass_alive[pass_index])
+			continue;
+		const Pass& pass = m_passes[pass_index];
+		for (uint32_t i = pass.access_start; i < pass.access_start + pass.access_count; i++)
+		{
+			RenderGraphResourcePlan& resource = resources[m_accesses[i].resource.handle];
+			if (resource.first_pass == RENDER_GRAPH_INVALID_PASS)
+				resource.first_pass = plan_pass_count;
+			resource.last_pass = plan_pass_count;
+		}
+		passes[plan_pass_count].pass = RGPass(pass_index);
+		++plan_pass_count;
+	}
+
+	// place the biggest resources first, each one goes at the lowest offset that no resource alive at the same time uses.
+	uint32_t* placement_order = ArenaAllocArr(a_arena, uint32_t, resource_count);
+	bool* placed = ArenaAllocArr(a_arena, bool, resource_count);
+	uint32_t transient_count = 0;
+	uint64_t unaliased_size = 0;
+	for (uint32_t i = 0; i < resource_count; i++)
+	{
+		placed[i] = false;
+		if (m_resources[i].imported || resources[i].first_pass == RENDER_GRAPH_INVALID_PASS)
+			continue;
+
+		uint32_t insert = transient_count++;
+		while (insert > 0 && m_resources[placement_order[insert - 1]].size < m_resources[i].size)
+		{
+			placement_order[insert] = placement_order[insert - 1];
+			--insert;
+		}
+		placement_order[insert] = i;
+		unaliased_size = RoundUp(unaliased_size, m_resources[i].alignment) + m_resources[i].size;
+	}
+
+	auto lifetimes_overlap = [resources](const uint32_t a_lhs, const uint32_t a_rhs)
+	{
+		return resources[a_lhs].first_pass <= resources[a_rhs].last_pass && resources[a_rhs].first_pass <= resources[a_lhs].last_pass;
+	};
+	auto memory_overlaps = [this, resources](const uint32_t a_lhs, const uint32_t a_rhs)
+	{
+		return resources[a_lhs].heap_offset < resources[a_rhs].heap_offset + m_resources[a_rhs].size &&
+			resources[a_rhs].heap_offset < resources[a_lhs].heap_offset + m_resources[a_lhs].size;
+	};
+
+	uint64_t heap_size = 0;
+	for (uint32_t order = 0; order < transient_count; order++)
+	{
+		const uint32_t resource_index = placement_order[order];
+		const Resource& resource = m_resources[resource_index];
+
+		// the best offset is either 0 or directly after a resource that is alive at the same time.
+		uint64_t best_offset = UINT64_MAX;
+		for (uint32_t candidate = 0; candidate <= order; candidate++)
+		{
+			uint64_t offset = 0;
+			if (candidate != order)
+			{
+				const uint32_t other = placement_order[candidate];
+				if (!lifetimes_overlap(resource_index, other))
+					continue;
+				offset = RoundUp(resources[other].heap_offset + m_resources[other].size, resource.alignment);
+			}
+			if (offset >= best_offset)
+				continue;
+
+			resources[resource_index].heap_offset = offset;
+			bool fits = true;
+			for (uint32_t i = 0; i < order && fits; i++)
+			{
+				const uint32_t other = placement_order[i];
+				fits = !lifetimes_overlap(resource_index, other) || !memory_overlaps(resource_index, other);
+			}
+			if (fits)
+				best_offset = offset;
+		}
+
+		resources[resource_index].heap_offset = best_offset;
+		placed[resource_index] = true;
+		heap_size = Max(heap_size, best_offset + resource.size);
+	}
+
+	// every access that changes the state or follows a write needs a barrier, reads in the same state share the earlier one.
+	RenderGraphBarrier* barriers = ArenaAllocArr(a_arena, RenderGraphBarrier, m_accesses.size());
+	bool* last_access_wrote = ArenaAllocArr(a_arena, bool, resource_count);
+	for (uint32_t i = 0; i < resource_count; i++)
+		last_access_wrote[i] = false;
+
+	uint32_t barrier_count = 0;
+	for (uint32_t plan_index = 0; plan_index < plan_pass_count; plan_index++)
+	{
+		RenderGraphPassPlan& pass_plan = passes[plan_index];
+		const Pass& pass = m_passes[pass_plan.pass.handle];
+		pass_plan.barrier_start = barrier_count;
+
+		for (uint32_t i = pass.access_start; i < pass.access_start + pass.access_count; i++)
+		{
+			const Access& access = m_accesses[i];
+			const uint32_t resource_index = access.resource.handle;
+			RenderGraphResourcePlan& resource = resources[resource_index];
+			const bool writes = access.access != RENDER_GRAPH_ACCESS::READ;
+
+			RenderGraphBarrier barrier;
+			barrier.resource = access.resource;
+			barrier.prev_state = resource.final_state;
+			barrier.next_state = access.state;
+			barrier.aliased = false;
+
+			const bool first_transient_use = !m_resources[resource_index].imported && resource.first_pass == plan_index;
+			if (first_transient_use)
+			{
+				BB_ASSERT(access.access == RENDER_GRAPH_ACCESS::OVERWRITE, "a transient render graph resource is read before it is written");
+				barrier.prev_state = RENDER_GRAPH_STATE_UNDEFINED;
+				for (uint32_t other = 0; other < resource_count; other++)
+				{
+					if (other != resource_index && placed[other] && resources[other].last_pass < plan_index && memory_overlaps(resource_index, other))
+						barrier.aliased = true;
+				}
+				barriers[barrier_count++] = barrier;
+			}
+			else if (barrier.prev_state != barrier.next_state || last_access_wrote[resource_index] || writes)
+				barriers[barrier_count++] = barrier;
+
+			resource.final_state = access.state;
+			last_access_wrote[resource_index] = writes;
+		}
+
+		pass_plan.barrier_count = barrier_count - pass_plan.barrier_start;
+	}
+
+	RenderGraphPlan plan;
+	plan.passes = ConstSlice<RenderGraphPassPlan>(passes, plan_pass_count);
+	plan.barriers = ConstSlice<RenderGraphBarrier>(barriers, barrier_count);
+	plan.resources = ConstSlice<RenderGraphResourcePlan>(resources, resource_count);
+	plan.transient_heap_size = heap_size;
+	plan.transient_unaliased_size = unaliased_size;
+	plan.culled_pass_count = pass_count - plan_pass_count;
+	return plan;
+}
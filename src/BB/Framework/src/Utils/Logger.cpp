@@ -25,8 +25,12 @@ static void StandardLogCallback(const char* a_file_name, const int a_line, const
 			//check to see if we do not go over bounds, largly to deal with non-null-terminated wchar strings.
 			BB_ASSERT(char_size < string.capacity() - string.size(), "error log string size exceeds 1024 characters!");
 			char* character = BBstackAlloc_s(char_size, char);
+#ifdef _LINUX
+			wcstombs(character, w_char, char_size);
+#else
 			size_t conv_chars = 0;
 			wcstombs_s(&conv_chars, character, char_size, w_char, _TRUNCATE);
+#endif //_LINUX
 			string.append(character);
 			BBstackFree_s(character);
 		}
@@ -93,7 +97,7 @@ void Logger::LogToConsole(const char* a_file_name, int a_line, const WarningType
 
 	// get the line number into the buffer
 	char lineNumString[8]{};
-	sprintf_s(lineNumString, 8, "%u", a_line);
+	snprintf(lineNumString, 8, "%u", a_line);
 	string.append(LOG_MESSAGE_LINE_NUMBER_1, sizeof(LOG_MESSAGE_LINE_NUMBER_1) - 1);
 	string.append(lineNumString);
 
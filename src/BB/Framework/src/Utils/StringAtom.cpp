@@ -0,0 +1,320 @@
+#include "StringAtom.hpp"
+#include "Program.h"
+
+#include <atomic>
+
+using namespace BB;
+
+// transient atoms have this bit set in their handle, the rest is the index into the transient entries.
+constexpr uint32_t STRING_ATOM_TRANSIENT_BIT = 1u << 31;
+// the first atom, returned when the table is full so that a full table shows up as a name instead of a crash.
+constexpr uint32_t STRING_ATOM_FULL_INDEX = 0;
+
+struct StringAtomEntry
+{
+	uint64_t hash;			//8
+	const char* string;		//16
+	uint32_t size;			//20
+};
+
+struct TransientAtomEntry
+{
+	uint64_t hash;
+	uint32_t size;
+	uint32_t ref_count;		// 0 when the entry is free.
+	uint32_t next_free;
+	char string[STRING_ATOM_TRANSIENT_STRING_MAX + 1];
+};
+
+struct StringAtomTable
+{
+	BBRWLock lock;
+
+	// written under the lock, atom accessors read it without the lock.
+	std::atomic<uint32_t> atom_count;
+	uint32_t atom_max;
+	StringAtomEntry* atoms;
+
+	// open addressing with linear probing, holds the atom index or BB_INVALID_HANDLE_32 when empty.
+	// slot count is a power of 2 and at least twice the atom max so probing always hits an empty slot.
+	uint32_t slot_mask;
+	uint32_t* slots;
+
+	// interned strings are copied here with a null terminator and are never freed.
+	char* string_memory;
+	size_t string_memory_used;
+	size_t string_memory_size;
+	bool warned_full;
+
+	// the same setup for transient atoms, their slots are removed again with a backward shift.
+	uint32_t transient_max;
+	TransientAtomEntry* transient_atoms;
+	uint32_t transient_first_free;
+	uint32_t transient_slot_mask;
+	uint32_t* transient_slots;
+	bool warned_transient_full;
+};
+
+static StringAtomTable s_atom_table{};
+
+static bool IsTransient(const StringAtom a_atom)
+{
+	return a_atom.IsValid() && (a_atom.handle & STRING_ATOM_TRANSIENT_BIT);
+}
+
+static uint32_t FindAtomSlot(const StringView a_string, const uint64_t a_hash)
+{
+	uint32_t slot = static_cast<uint32_t>(a_hash) & s_atom_table.slot_mask;
+	while (true)
+	{
+		const uint32_t atom_index = s_atom_table.slots[slot];
+		if (atom_index == BB_INVALID_HANDLE_32)
+			return slot;
+
+		const StringAtomEntry& entry = s_atom_table.atoms[atom_index];
+		if (entry.hash == a_hash && entry.size == a_string.size() && memcmp(entry.string, a_string.c_str(), a_string.size()) == 0)
+			return slot;
+
+		slot = (slot + 1) & s_atom_table.slot_mask;
+	}
+}
+
+static uint32_t FindTransientSlot(const StringView a_string, const uint64_t a_hash)
+{
+	uint32_t slot = static_cast<uint32_t>(a_hash) & s_atom_table.transient_slot_mask;
+	while (true)
+	{
+		const uint32_t atom_index = s_atom_table.transient_slots[slot];
+		if (atom_index == BB_INVALID_HANDLE_32)
+			return slot;
+
+		const TransientAtomEntry& entry = s_atom_table.transient_atoms[atom_index];
+		if (entry.hash == a_hash && entry.size == a_string.size() && memcmp(entry.string, a_string.c_str(), a_string.size()) == 0)
+			return slot;
+
+		slot = (slot + 1) & s_atom_table.transient_slot_mask;
+	}
+}
+
+// moves the entries after the hole back so that probing never stops early on it.
+static void RemoveTransientSlot(const uint32_t a_slot)
+{
+	const uint32_t mask = s_atom_table.transient_slot_mask;
+	uint32_t hole = a_slot;
+	uint32_t slot = (hole + 1) & mask;
+	while (s_atom_table.transient_slots[slot] != BB_INVALID_HANDLE_32)
+	{
+		const uint32_t home = static_cast<uint32_t>(s_atom_table.transient_atoms[s_atom_table.transient_slots[slot]].hash) & mask;
+		// the hole is between the home slot and the current slot, so it can move into the hole.
+		if (((slot - home) & mask) >= ((slot - hole) & mask))
+		{
+			s_atom_table.transient_slots[hole] = s_atom_table.transient_slots[slot];
+			hole = slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+	s_atom_table.transient_slots[hole] = BB_INVALID_HANDLE_32;
+}
+
+static uint32_t SlotCount(const uint32_t a_max_atoms)
+{
+	uint32_t slot_count = 16;
+	while (slot_count < a_max_atoms * 2)
+		slot_count <<= 1;
+	return slot_count;
+}
+
+// lock held for writing.
+static StringAtom AddAtom(const StringView a_string, const uint64_t a_hash, const uint32_t a_slot)
+{
+	if (s_atom_table.atom_count.load(std::memory_order_relaxed) == s_atom_table.atom_max ||
+		s_atom_table.string_memory_used + a_string.size() + 1 > s_atom_table.string_memory_size)
+	{
+		BB_WARNING(s_atom_table.warned_full, "string atom table is full, raise BBInitInfo::string_atom_max or string_atom_memory", WarningType::HIGH);
+		s_atom_table.warned_full = true;
+		return StringAtom(STRING_ATOM_FULL_INDEX);
+	}
+
+	char* string = &s_atom_table.string_memory[s_atom_table.string_memory_used];
+	memcpy(string, a_string.c_str(), a_string.size());
+	string[a_string.size()] = '\0';
+	s_atom_table.string_memory_used += a_string.size() + 1;
+
+	const uint32_t atom_index = s_atom_table.atom_count.load(std::memory_order_relaxed);
+	StringAtomEntry& entry = s_atom_table.atoms[atom_index];
+	entry.hash = a_hash;
+	entry.string = string;
+	entry.size = static_cast<uint32_t>(a_string.size());
+
+	s_atom_table.slots[a_slot] = atom_index;
+	s_atom_table.atom_count.store(atom_index + 1, std::memory_order_release);
+	return StringAtom(atom_index);
+}
+
+void BB::InitStringAtomTable(MemoryArena& a_arena, const uint32_t a_max_atoms, const size_t a_string_memory, const uint32_t a_max_transient_atoms)
+{
+	BB_ASSERT(s_atom_table.atoms == nullptr, "string atom table already initialized");
+	BB_ASSERT(a_max_transient_atoms < STRING_ATOM_TRANSIENT_BIT, "too many transient string atoms");
+	s_atom_table.lock = OSCreateRWLock();
+
+	const uint32_t slot_count = SlotCount(a_max_atoms);
+	s_atom_table.atom_count.store(0, std::memory_order_relaxed);
+	s_atom_table.atom_max = a_max_atoms;
+	s_atom_table.atoms = ArenaAllocArr(a_arena, StringAtomEntry, a_max_atoms);
+
+	s_atom_table.slot_mask = slot_count - 1;
+	s_atom_table.slots = ArenaAllocArr(a_arena, uint32_t, slot_count);
+	for (uint32_t i = 0; i < slot_count; i++)
+		s_atom_table.slots[i] = BB_INVALID_HANDLE_32;
+
+	s_atom_table.string_memory = ArenaAllocArr(a_arena, char, a_string_memory);
+	s_atom_table.string_memory_used = 0;
+	s_atom_table.string_memory_size = a_string_memory;
+	s_atom_table.warned_full = false;
+
+	const uint32_t transient_slot_count = SlotCount(a_max_transient_atoms);
+	s_atom_table.transient_max = a_max_transient_atoms;
+	s_atom_table.transient_atoms = ArenaAllocArr(a_arena, TransientAtomEntry, a_max_transient_atoms);
+	for (uint32_t i = 0; i < a_max_transient_atoms; i++)
+		s_atom_table.transient_atoms[i].next_free = i + 1 < a_max_transient_atoms ? i + 1 : BB_INVALID_HANDLE_32;
+	s_atom_table.transient_first_free = a_max_transient_atoms ? 0 : BB_INVALID_HANDLE_32;
+	s_atom_table.transient_slot_mask = transient_slot_count - 1;
+	s_atom_table.transient_slots = ArenaAllocArr(a_arena, uint32_t, transient_slot_count);
+	for (uint32_t i = 0; i < transient_slot_count; i++)
+		s_atom_table.transient_slots[i] = BB_INVALID_HANDLE_32;
+	s_atom_table.warned_transient_full = false;
+
+	BBRWLockScopeWrite scope_lock(s_atom_table.lock);
+	const StringView full_name = "#STRING ATOM TABLE FULL#";
+	const uint64_t full_hash = StringHash(full_name);
+	const StringAtom full_atom = AddAtom(full_name, full_hash, FindAtomSlot(full_name, full_hash));
+	BB_ASSERT(full_atom.handle == STRING_ATOM_FULL_INDEX, "the first string atom is not the table full atom");
+}
+
+StringAtom BB::StringAtomIntern(const StringView a_string)
+{
+	const uint64_t hash = StringHash(a_string);
+
+	// most interns are for strings that already exist, so try with a shared lock first.
+	OSAcquireSRWLockRead(&s_atom_table.lock);
+	const uint32_t found_atom = s_atom_table.slots[FindAtomSlot(a_string, hash)];
+	OSReleaseSRWLockRead(&s_atom_table.lock);
+	if (found_atom != BB_INVALID_HANDLE_32)
+		return StringAtom(found_atom);
+
+	BBRWLockScopeWrite scope_lock(s_atom_table.lock);
+	// another thread could have interned the same string in between the locks.
+	const uint32_t slot = FindAtomSlot(a_string, hash);
+	if (s_atom_table.slots[slot] != BB_INVALID_HANDLE_32)
+		return StringAtom(s_atom_table.slots[slot]);
+
+	return AddAtom(a_string, hash, slot);
+}
+
+StringAtom BB::StringAtomInternTransient(const StringView a_string)
+{
+	const uint64_t hash = StringHash(a_string);
+	BBRWLockScopeWrite scope_lock(s_atom_table.lock);
+
+	const uint32_t slot = FindAtomSlot(a_string, hash);
+	if (s_atom_table.slots[slot] != BB_INVALID_HANDLE_32)
+		return StringAtom(s_atom_table.slots[slot]);
+
+	const uint32_t transient_slot = FindTransientSlot(a_string, hash);
+	if (s_atom_table.transient_slots[transient_slot] != BB_INVALID_HANDLE_32)
+	{
+		const uint32_t atom_index = s_atom_table.transient_slots[transient_slot];
+		++s_atom_table.transient_atoms[atom_index].ref_count;
+		return StringAtom(atom_index | STRING_ATOM_TRANSIENT_BIT);
+	}
+
+	// long strings are rare, those stay forever.
+	if (a_string.size() > STRING_ATOM_TRANSIENT_STRING_MAX)
+		return AddAtom(a_string, hash, slot);
+	if (s_atom_table.transient_first_free == BB_INVALID_HANDLE_32)
+	{
+		BB_WARNING(s_atom_table.warned_transient_full, "transient string atom table is full, strings are interned for good now", WarningType::MEDIUM);
+		s_atom_table.warned_transient_full = true;
+		return AddAtom(a_string, hash, slot);
+	}
+
+	const uint32_t atom_index = s_atom_table.transient_first_free;
+	TransientAtomEntry& entry = s_atom_table.transient_atoms[atom_index];
+	s_atom_table.transient_first_free = entry.next_free;
+	entry.hash = hash;
+	entry.size = static_cast<uint32_t>(a_string.size());
+	entry.ref_count = 1;
+	memcpy(entry.string, a_string.c_str(), a_string.size());
+	entry.string[a_string.size()] = '\0';
+
+	s_atom_table.transient_slots[transient_slot] = atom_index;
+	return StringAtom(atom_index | STRING_ATOM_TRANSIENT_BIT);
+}
+
+void BB::StringAtomRelease(const StringAtom a_atom)
+{
+	if (!IsTransient(a_atom))
+		return;
+
+	const uint32_t atom_index = a_atom.handle & ~STRING_ATOM_TRANSIENT_BIT;
+	BB_ASSERT(atom_index < s_atom_table.transient_max, "invalid transient string atom");
+	BBRWLockScopeWrite scope_lock(s_atom_table.lock);
+	TransientAtomEntry& entry = s_atom_table.transient_atoms[atom_index];
+	BB_ASSERT(entry.ref_count != 0, "transient string atom released more often then it was interned");
+	if (--entry.ref_count != 0)
+		return;
+
+	RemoveTransientSlot(FindTransientSlot(StringView(entry.string, entry.size), entry.hash));
+	entry.next_free = s_atom_table.transient_first_free;
+	s_atom_table.transient_first_free = atom_index;
+}
+
+StringAtom BB::StringAtomFind(const StringView a_string)
+{
+	const uint64_t hash = StringHash(a_string);
+
+	OSAcquireSRWLockRead(&s_atom_table.lock);
+	uint32_t found_atom = s_atom_table.slots[FindAtomSlot(a_string, hash)];
+	if (found_atom == BB_INVALID_HANDLE_32)
+	{
+		found_atom = s_atom_table.transient_slots[FindTransientSlot(a_string, hash)];
+		if (found_atom != BB_INVALID_HANDLE_32)
+			found_atom |= STRING_ATOM_TRANSIENT_BIT;
+	}
+	OSReleaseSRWLockRead(&s_atom_table.lock);
+	return StringAtom(found_atom);
+}
+
+// atom entries are immutable while the atom lives, so reading them does not need the lock.
+StringView BB::StringAtomGetView(const StringAtom a_atom)
+{
+	if (IsTransient(a_atom))
+	{
+		const TransientAtomEntry& entry = s_atom_table.transient_atoms[a_atom.handle & ~STRING_ATOM_TRANSIENT_BIT];
+		return StringView(entry.string, entry.size);
+	}
+	BB_ASSERT(a_atom.handle < s_atom_table.atom_count.load(std::memory_order_acquire), "invalid string atom");
+	const StringAtomEntry& entry = s_atom_table.atoms[a_atom.handle];
+	return StringView(entry.string, entry.size);
+}
+
+const char* BB::StringAtomGetCStr(const StringAtom a_atom)
+{
+	if (IsTransient(a_atom))
+		return s_atom_table.transient_atoms[a_atom.handle & ~STRING_ATOM_TRANSIENT_BIT].string;
+	BB_ASSERT(a_atom.handle < s_atom_table.atom_count.load(std::memory_order_acquire), "invalid string atom");
+	return s_atom_table.atoms[a_atom.handle].string;
+}
+
+uint64_t BB::StringAtomGetHash(const StringAtom a_atom)
+{
+	if (IsTransient(a_atom))
+		return s_atom_table.transient_atoms[a_atom.handle & ~STRING_ATOM_TRANSIENT_BIT].hash;
+	BB_ASSERT(a_atom.handle < s_atom_table.atom_count.load(std::memory_order_acquire), "invalid string atom");
+	return s_atom_table.atoms[a_atom.handle].hash;
+}
+
+uint32_t BB::StringAtomCount()
+{
+	return s_atom_table.atom_count.load(std::memory_order_acquire);
+}
@@ -124,7 +124,7 @@ namespace BB
 		//Again but then go by byte.
 		for (size_t i = 0; i < a_size; i++)
 		{
-			*dest_char++ = reinterpret_cast<uint8_t*>(static_cast<uint8_t>(a_value))[i];
+			*dest_char++ = reinterpret_cast<const uint8_t*>(&a_value)[i];
 		}
 	}
 
@@ -135,7 +135,8 @@ namespace BB
 
 		while (a_size >= sizeof(__m128i))
 		{
-			*dest++ = _mm_set1_epi64x(static_cast<long long>(a_value));
+			// unaligned store, the destination can be any address.
+			_mm_storeu_si128(dest++, _mm_set1_epi64x(static_cast<long long>(a_value)));
 			a_size -= sizeof(__m128i);
 		}
 
@@ -152,7 +153,7 @@ namespace BB
 		//Again but then go by byte.
 		for (size_t i = 0; i < a_size; i++)
 		{
-			*dest_char++ = reinterpret_cast<uint8_t*>(static_cast<uint8_t>(a_value))[i];
+			*dest_char++ = reinterpret_cast<const uint8_t*>(&a_value)[i];
 		}
 	}
 
@@ -163,7 +164,7 @@ namespace BB
 
 		while (a_size > sizeof(__m256i))
 		{
-			*dest++ = _mm256_set1_epi64x(static_cast<long long>(a_value));
+			_mm256_storeu_si256(dest++, _mm256_set1_epi64x(static_cast<long long>(a_value)));
 			a_size -= sizeof(__m256i);
 		}
 		
@@ -180,7 +181,7 @@ namespace BB
 		//Again but then go by byte.
 		for (size_t i = 0; i < a_size; i++)
 		{
-			*dest_char++ = reinterpret_cast<uint8_t*>(static_cast<uint8_t>(a_value))[i];
+			*dest_char++ = reinterpret_cast<const uint8_t*>(&a_value)[i];
 		}
 	}
 
@@ -0,0 +1,130 @@
+#pragma once
+#include "../TestValues.h"
+#include "ecs/ArchetypeMap.hpp"
+#include "ecs/components/TransformComponents.hpp"
+
+#include <vector>
+
+static void InitTestArchetypeMap(BB::ECSArchetypeMap& a_map, const uint32_t a_entity_max)
+{
+	a_map.Init(a_entity_max);
+	a_map.RegisterComponent<BB::PositionComponentPool>();
+	a_map.RegisterComponent<BB::ScaleComponentPool>();
+	a_map.RegisterComponent<BB::BoundingBoxComponentPool>();
+}
+
+TEST(ArchetypeMap, add_move_and_remove)
+{
+	BB::ECSArchetypeMap map;
+	InitTestArchetypeMap(map, 64);
+
+	const BB::ECSEntity entity = BB::ECSEntity(3, 0);
+	ASSERT_TRUE(map.AddEntity(entity, BB::ECSArchetypeMap::MakeSignature<BB::PositionComponentPool>()));
+	EXPECT_FALSE(map.AddEntity(entity, BB::ECSArchetypeMap::MakeSignature<BB::PositionComponentPool>()));
+	EXPECT_TRUE(map.HasEntity(entity));
+	EXPECT_TRUE(map.HasComponent<BB::PositionComponentPool>(entity));
+	EXPECT_FALSE(map.HasComponent<BB::ScaleComponentPool>(entity));
+	// new components are zero initialized.
+	EXPECT_EQ(map.GetComponent<BB::PositionComponentPool>(entity).x, 0.f);
+	map.GetComponent<BB::PositionComponentPool>(entity) = BB::float3(1.f, 2.f, 3.f);
+
+	// adding a component moves the entity to a new archetype, the components it had come along.
+	ASSERT_TRUE(map.AddComponent<BB::ScaleComponentPool>(entity, BB::float3(4.f, 5.f, 6.f)));
+	EXPECT_EQ(map.GetArchetypeCount(), 2u);
+	EXPECT_TRUE(map.HasComponent<BB::ScaleComponentPool>(entity));
+	EXPECT_EQ(map.GetComponent<BB::PositionComponentPool>(entity).y, 2.f);
+	EXPECT_EQ(map.GetComponent<BB::ScaleComponentPool>(entity).z, 6.f);
+
+	// adding it again overwrites it in place.
+	ASSERT_TRUE(map.AddComponent<BB::ScaleComponentPool>(entity, BB::float3(7.f, 8.f, 9.f)));
+	EXPECT_EQ(map.GetArchetypeCount(), 2u);
+	EXPECT_EQ(map.GetComponent<BB::ScaleComponentPool>(entity).x, 7.f);
+
+	ASSERT_TRUE(map.RemoveComponent<BB::PositionComponentPool>(entity));
+	EXPECT_FALSE(map.HasComponent<BB::PositionComponentPool>(entity));
+	EXPECT_EQ(map.GetComponent<BB::ScaleComponentPool>(entity).y, 8.f);
+	EXPECT_EQ(map.Count<BB::PositionComponentPool>(), 0u);
+	EXPECT_EQ(map.Count<BB::ScaleComponentPool>(), 1u);
+
+	ASSERT_TRUE(map.RemoveEntity(entity));
+	EXPECT_FALSE(map.HasEntity(entity));
+	EXPECT_FALSE(map.RemoveEntity(entity));
+	EXPECT_EQ(map.Count<BB::ScaleComponentPool>(), 0u);
+
+	// a stale handle to a reused index is not the new entity.
+	const BB::ECSEntity reused = BB::ECSEntity(3, 1);
+	ASSERT_TRUE(map.AddEntity(reused, BB::ECSArchetypeMap::MakeSignature<BB::ScaleComponentPool>()));
+	EXPECT_TRUE(map.HasEntity(reused));
+	EXPECT_FALSE(map.HasEntity(entity));
+
+	map.Destroy();
+}
+
+// removing swaps the last entity of the archetype into the hole, the iteration and lookups must still find every entity once.
+TEST(ArchetypeMap, iteration_after_swap_remove)
+{
+	constexpr uint32_t entity_count = 2000;
+	BB::ECSArchetypeMap map;
+	InitTestArchetypeMap(map, entity_count);
+
+	const BB::ECSSignature signature = BB::ECSArchetypeMap::MakeSignature<BB::PositionComponentPool, BB::ScaleComponentPool>();
+	for (uint32_t i = 0; i < entity_count; i++)
+	{
+		const BB::ECSEntity entity = BB::ECSEntity(i, 0);
+		ASSERT_TRUE(map.AddEntity(entity, signature));
+		map.GetComponent<BB::PositionComponentPool>(entity) = BB::float3(static_cast<float>(i), 0.f, 0.f);
+		map.GetComponent<BB::ScaleComponentPool>(entity) = BB::float3(0.f, static_cast<float>(i), 0.f);
+	}
+	ASSERT_GT(map.GetChunkCount(), 1u);
+
+	// every third one, that takes entities out of the middle of chunks and the last one.
+	std::vector<bool> removed(entity_count, false);
+	uint32_t remaining = entity_count;
+	for (uint32_t i = 0; i < entity_count; i += 3)
+	{
+		ASSERT_TRUE(map.RemoveEntity(BB::ECSEntity(i, 0)));
+		removed[i] = true;
+		--remaining;
+	}
+	ASSERT_TRUE(map.RemoveEntity(BB::ECSEntity(entity_count - 1, 0)));
+	removed[entity_count - 1] = true;
+	--remaining;
+
+	EXPECT_EQ((map.Count<BB::PositionComponentPool, BB::ScaleComponentPool>()), remaining);
+
+	std::vector<uint32_t> visited(entity_count, 0);
+	map.ForEach<BB::PositionComponentPool, BB::ScaleComponentPool>([&](const BB::ECSEntity a_entity, BB::float3& a_position, BB::float3& a_scale)
+	{
+		ASSERT_LT(a_entity.index, entity_count);
+		EXPECT_FALSE(removed[a_entity.index]);
+		EXPECT_EQ(a_position.x, static_cast<float>(a_entity.index));
+		EXPECT_EQ(a_scale.y, static_cast<float>(a_entity.index));
+		++visited[a_entity.index];
+	});
+
+	for (uint32_t i = 0; i < entity_count; i++)
+	{
+		const BB::ECSEntity entity = BB::ECSEntity(i, 0);
+		EXPECT_EQ(visited[i], removed[i] ? 0u : 1u);
+		EXPECT_EQ(map.HasEntity(entity), !removed[i]);
+		// the moved entities have their lookup updated.
+		if (!removed[i])
+		{
+			EXPECT_EQ(map.GetComponent<BB::PositionComponentPool>(entity).x, static_cast<float>(i));
+		}
+	}
+
+	// the chunks split over workers add up to the same.
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	const BB::ConstSlice<BB::ECSArchetypeChunk*> chunks = map.GatherChunks<BB::PositionComponentPool, BB::ScaleComponentPool>(arena);
+	uint32_t chunk_entities = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		auto count = [&chunk_entities](const BB::ECSEntity, BB::float3&, BB::float3&) { ++chunk_entities; };
+		BB::ECSArchetypeMap::ForEachInChunk<BB::PositionComponentPool, BB::ScaleComponentPool>(*chunks[i], count);
+	}
+	EXPECT_EQ(chunk_entities, remaining);
+
+	BB::MemoryArenaFree(arena);
+	map.Destroy();
+}
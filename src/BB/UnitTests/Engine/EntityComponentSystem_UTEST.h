@@ -0,0 +1,123 @@
+#pragma once
+#include "../TestValues.h"
+#include "SceneHierarchy.hpp"
+#include "Math/Math.inl"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static BB::RenderComponent TestCasterComponent(const BB::BoundingBox& a_box)
+{
+	BB::RenderComponent component{};
+	component.material = BB::MaterialHandle(BB_INVALID_HANDLE_64);
+	component.material_dirty = false;
+	component.bounding_box = a_box;
+	return component;
+}
+
+static BB::float3 TestEntityPosition(const uint32_t a_index)
+{
+	return BB::float3(static_cast<float>(a_index % 16) * 2.f, 1.f, static_cast<float>(a_index / 16) * 2.f);
+}
+
+static void CreateEntitiesSingle(BB::EntityComponentSystem& a_ecs, const uint32_t a_count, const BB::BoundingBox& a_box, std::vector<BB::ECSEntity>& a_entities)
+{
+	for (uint32_t i = 0; i < a_count; i++)
+	{
+		const BB::ECSEntity entity = a_ecs.CreateEntity("caster", BB::INVALID_ECS_OBJ, TestEntityPosition(i));
+		EXPECT_TRUE(a_ecs.EntityAssignRenderComponent(entity, TestCasterComponent(a_box)));
+		EXPECT_TRUE(a_ecs.EntityAssignBoundingBox(entity, a_box));
+		a_entities.push_back(entity);
+	}
+}
+
+static std::vector<BB::ECSEntityPrototype> TestCasterPrototypes(const uint32_t a_count, const BB::BoundingBox& a_box)
+{
+	std::vector<BB::ECSEntityPrototype> prototypes(a_count);
+	for (uint32_t i = 0; i < a_count; i++)
+	{
+		BB::ECSEntityPrototype& prototype = prototypes[i];
+		prototype.name = BB::StringAtomIntern("caster");
+		prototype.parent_index = BB::ECS_PROTOTYPE_NO_PARENT;
+		prototype.position = TestEntityPosition(i);
+		prototype.rotation = BB::Float3x3Identity();
+		prototype.scale = BB::float3(1.f);
+		prototype.has_render_component = true;
+		prototype.render_component = TestCasterComponent(a_box);
+		prototype.has_bounding_box = true;
+		prototype.bounding_box = a_box;
+	}
+	return prototypes;
+}
+
+static void CreateEntitiesBatched(BB::MemoryArena& a_temp_arena, BB::EntityComponentSystem& a_ecs, const std::vector<BB::ECSEntityPrototype>& a_prototypes, std::vector<BB::ECSEntity>& a_entities)
+{
+	const size_t first = a_entities.size();
+	a_entities.resize(first + a_prototypes.size());
+	EXPECT_TRUE(a_ecs.CreateEntities(a_temp_arena, BB::ConstSlice<BB::ECSEntityPrototype>(a_prototypes.data(), a_prototypes.size()), BB::INVALID_ECS_OBJ, BB::Slice<BB::ECSEntity>(&a_entities[first], a_prototypes.size())));
+}
+
+// batched creation does the same bookkeeping as creating them one by one: dirty transforms, render components and the shadow caster bounds.
+// every scene takes index buffer space for its render system that is never given back, so both checks share the two scenes.
+TEST(EntityComponentSystem, batched_creation_matches_single)
+{
+	constexpr uint32_t entity_count = 64;
+	constexpr uint32_t timing_entity_count = 2048;
+	const BB::BoundingBox box{ BB::float3(-0.5f, -0.5f, -0.5f), BB::float3(0.5f, 0.5f, 0.5f) };
+
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::SceneHierarchy* single_scene = ArenaAllocType(arena, BB::SceneHierarchy);
+	single_scene->Init(arena, entity_count + timing_entity_count, BB::uint2(64, 64), "single scene");
+	BB::SceneHierarchy* batched_scene = ArenaAllocType(arena, BB::SceneHierarchy);
+	batched_scene->Init(arena, entity_count + timing_entity_count, BB::uint2(64, 64), "batched scene");
+	BB::EntityComponentSystem& single = single_scene->GetECS();
+	BB::EntityComponentSystem& batched = batched_scene->GetECS();
+
+	std::vector<BB::ECSEntity> single_entities;
+	std::vector<BB::ECSEntity> batched_entities;
+	CreateEntitiesSingle(single, entity_count, box, single_entities);
+	CreateEntitiesBatched(arena, batched, TestCasterPrototypes(entity_count, box), batched_entities);
+
+	// every new caster invalidates the shadows it is in.
+	EXPECT_EQ(single.GetChangedCasterBounds().size(), entity_count);
+	EXPECT_EQ(batched.GetChangedCasterBounds().size(), entity_count);
+
+	// both are in the transform pass, that adds the bounds from before and after it for every caster.
+	single.TransformSystemUpdate();
+	batched.TransformSystemUpdate();
+	const BB::ConstSlice<BB::BoundingBox> single_bounds = single.GetChangedCasterBounds();
+	const BB::ConstSlice<BB::BoundingBox> batched_bounds = batched.GetChangedCasterBounds();
+	ASSERT_EQ(single_bounds.size(), entity_count * 3);
+	ASSERT_EQ(batched_bounds.size(), entity_count * 3);
+
+	for (uint32_t i = 0; i < entity_count; i++)
+	{
+		ASSERT_TRUE(batched.ValidateEntity(batched_entities[i]));
+		EXPECT_EQ(memcmp(&single.GetWorldMatrix(single_entities[i]), &batched.GetWorldMatrix(batched_entities[i]), sizeof(BB::float4x4)), 0);
+		EXPECT_EQ(batched.GetBoundingBox(batched_entities[i]).max.x, box.max.x);
+
+		// the bounds after the transform pass are in world space, the single ones before it are not as the entity had no transform yet.
+		const size_t after_transform = entity_count + i * 2 + 1;
+		EXPECT_EQ(single_bounds[after_transform].min.x, batched_bounds[after_transform].min.x);
+		EXPECT_EQ(single_bounds[after_transform].max.z, batched_bounds[after_transform].max.z);
+	}
+
+	// the time of creating the same entities one by one and in one batch, the prototypes are made up front like a model does.
+	const std::vector<BB::ECSEntityPrototype> prototypes = TestCasterPrototypes(timing_entity_count, box);
+	single_entities.clear();
+	batched_entities.clear();
+
+	const auto single_start = std::chrono::steady_clock::now();
+	CreateEntitiesSingle(single, timing_entity_count, box, single_entities);
+	const auto single_end = std::chrono::steady_clock::now();
+	CreateEntitiesBatched(arena, batched, prototypes, batched_entities);
+	const auto batched_end = std::chrono::steady_clock::now();
+
+	ASSERT_EQ(single_entities.size(), batched_entities.size());
+	EXPECT_EQ(single.GetChangedCasterBounds().size(), batched.GetChangedCasterBounds().size());
+
+	const double single_ms = std::chrono::duration<double, std::milli>(single_end - single_start).count();
+	const double batched_ms = std::chrono::duration<double, std::milli>(batched_end - single_end).count();
+	printf("creating %u render entities, single: %.3f ms, batched: %.3f ms\n", timing_entity_count, single_ms, batched_ms);
+}
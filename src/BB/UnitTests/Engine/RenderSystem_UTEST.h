@@ -0,0 +1,207 @@
+#pragma once
+#include "../TestValues.h"
+#include "SceneHierarchy.hpp"
+#include "MaterialSystem.hpp"
+#include "Renderer.hpp"
+#include "NullRenderer.hpp"
+#include "Math/Math.inl"
+
+#include <cstdio>
+#include <vector>
+
+struct HeadlessStageTime
+{
+	const char* name;
+	double total_milliseconds;
+	uint32_t frames;
+};
+
+// runs frames of the scene through the render system like the editor does, returns false if a submit failed.
+static bool RunHeadlessFrames(BB::EntityComponentSystem& a_ecs, const BB::uint2 a_draw_area, const uint32_t a_frame_count, std::vector<HeadlessStageTime>& a_stage_times)
+{
+	for (uint32_t frame = 0; frame < a_frame_count; frame++)
+	{
+		BB::CommandPool& pool = BB::GetGraphicsCommandPool();
+		const BB::RCommandList list = pool.StartCommandList();
+
+		a_ecs.SystemsUpdate();
+		a_ecs.StartFrame();
+		const BB::RenderSystemFrame render_frame = a_ecs.RenderSystemUpdate(list, a_draw_area);
+		a_ecs.EndFrame();
+		pool.EndCommandList(list);
+
+		const uint32_t wait_count = render_frame.wait_fence.IsValid() ? 1u : 0u;
+		uint64_t fence_value;
+		if (!BB::ExecuteGraphicCommands(BB::Slice<BB::CommandPool>(&pool, 1), &render_frame.fence, &render_frame.fence_value, 1, &render_frame.wait_fence, &render_frame.wait_value, wait_count, fence_value))
+			return false;
+
+		// the graph passes come back in a different order when occlusion culling turns on, so match them by name.
+		const BB::ConstSlice<BB::RenderStageCPUTime> stage_times = a_ecs.GetRenderSystem().GetStageCPUTimes();
+		for (size_t i = 0; i < stage_times.size(); i++)
+		{
+			auto it = std::find_if(a_stage_times.begin(), a_stage_times.end(), [&](const HeadlessStageTime& a_time) { return strcmp(a_time.name, stage_times[i].name) == 0; });
+			if (it == a_stage_times.end())
+				it = a_stage_times.insert(a_stage_times.end(), HeadlessStageTime{ stage_times[i].name, 0.0, 0 });
+			it->total_milliseconds += stage_times[i].milliseconds;
+			++it->frames;
+		}
+	}
+	return true;
+}
+
+// a unit cube with a normal per face, the models in resources/models need textures that are not in the repository.
+static const BB::Model::Mesh& LoadTestCube(BB::MemoryArena& a_temp_arena)
+{
+	BB::float3 positions[24];
+	BB::float3 normals[24];
+	BB::float2 uvs[24];
+	BB::float4 colors[24];
+	uint32_t indices[36];
+	for (uint32_t face = 0; face < 6; face++)
+	{
+		const uint32_t axis = face / 2;
+		const float side = (face & 1) ? 1.f : -1.f;
+		BB::float3 normal = BB::float3(0.f, 0.f, 0.f);
+		normal.e[axis] = side;
+		for (uint32_t corner = 0; corner < 4; corner++)
+		{
+			BB::float3 position = normal * 0.5f;
+			position.e[(axis + 1) % 3] = (corner == 1 || corner == 2) ? 0.5f : -0.5f;
+			position.e[(axis + 2) % 3] = (corner >= 2) ? 0.5f : -0.5f;
+			positions[face * 4 + corner] = position;
+			normals[face * 4 + corner] = normal;
+			uvs[face * 4 + corner] = BB::float2((corner == 1 || corner == 2) ? 1.f : 0.f, corner >= 2 ? 1.f : 0.f);
+			colors[face * 4 + corner] = BB::float4(1.f);
+		}
+		const uint32_t quad[6] = { 0, 1, 2, 2, 3, 0 };
+		for (uint32_t i = 0; i < 6; i++)
+			indices[face * 6 + i] = face * 4 + quad[i];
+	}
+
+	BB::Asset::MeshLoadFromMemory load_info;
+	load_info.name = "headless test cube";
+	load_info.indices = BB::ConstSlice<uint32_t>(indices, _countof(indices));
+	load_info.base_albedo = BB::Asset::GetCheckerBoardTexture();
+	load_info.mesh_load.positions = BB::ConstSlice<BB::float3>(positions, _countof(positions));
+	load_info.mesh_load.normals = BB::ConstSlice<BB::float3>(normals, _countof(normals));
+	load_info.mesh_load.uvs = BB::ConstSlice<BB::float2>(uvs, _countof(uvs));
+	load_info.mesh_load.colors = BB::ConstSlice<BB::float4>(colors, _countof(colors));
+	return BB::Asset::LoadMeshFromMemory(a_temp_arena, load_info).meshes[0];
+}
+
+static uint64_t NullDrawCount()
+{
+	const BB::NullRenderer::NullRendererStats stats = BB::NullRenderer::GetStats();
+	return stats.command_counts[static_cast<uint32_t>(BB::NullRenderer::NULL_COMMAND::DRAW_INDEXED)] +
+		stats.command_counts[static_cast<uint32_t>(BB::NullRenderer::NULL_COMMAND::DRAW_INDEXED_INDIRECT)];
+}
+
+// a grid of cubes and a sun, the entities of the cubes go in a_cubes.
+static BB::SceneHierarchy* CreateHeadlessScene(BB::MemoryArena& a_arena, const uint32_t a_grid_size, const BB::uint2 a_draw_area, const bool a_archetype_storage, std::vector<BB::ECSEntity>& a_cubes)
+{
+	BB::SceneHierarchy* scene = ArenaAllocType(a_arena, BB::SceneHierarchy);
+	scene->Init(a_arena, a_grid_size * a_grid_size * 4, a_draw_area, "headless scene", a_archetype_storage);
+	BB::EntityComponentSystem& ecs = scene->GetECS();
+
+	MemoryArenaScope(a_arena)
+	{
+		const BB::Model::Mesh& cube = LoadTestCube(a_arena);
+		BB::SceneMeshCreateInfo mesh_info;
+		mesh_info.mesh = cube.mesh;
+		mesh_info.index_start = cube.primitives[0].start_index;
+		mesh_info.index_count = cube.primitives[0].index_count;
+		mesh_info.master_material = BB::Material::GetDefaultMasterMaterial(BB::PASS_TYPE::SCENE, BB::MATERIAL_TYPE::MATERIAL_3D);
+		mesh_info.material_data = cube.primitives[0].material_data.mesh_metallic;
+		for (uint32_t x = 0; x < a_grid_size; x++)
+			for (uint32_t z = 0; z < a_grid_size; z++)
+				a_cubes.push_back(scene->CreateEntityMesh(BB::float3(static_cast<float>(x) * 3.f, 0.f, static_cast<float>(z) * 3.f), mesh_info, "cube", cube.primitives[0].bounding_box));
+	}
+
+	BB::LightCreateInfo light_info{};
+	light_info.light_type = BB::LIGHT_TYPE::DIRECTIONAL_LIGHT;
+	light_info.color = BB::float3(1.f, 1.f, 1.f);
+	light_info.pos = BB::float3(24.f, 40.f, 24.f);
+	light_info.specular_strength = 0.5f;
+	light_info.direction = BB::float3(0.f, -1.f, 0.2f);
+	light_info.cutoff_radius = 0.f;
+	scene->CreateEntityAsLight(light_info, "sun");
+
+	BB::RenderSystem& render_system = ecs.GetRenderSystem();
+	render_system.SetProjection(BB::Float4x4Perspective(BB::ToRadians(60.f), static_cast<float>(a_draw_area.x) / static_cast<float>(a_draw_area.y), 0.001f, 10000.f), 0.001f);
+	ecs.CalculateView(BB::float3(24.f, 20.f, -20.f), BB::float3(24.f, 0.f, 24.f), BB::float3(0.f, 1.f, 0.f));
+	return scene;
+}
+
+// a grid of models through the render system on the null backend, prints the average cpu time of every stage.
+TEST(RenderSystem, headless_scene_stage_cpu_times)
+{
+	constexpr uint32_t grid_size = 16;
+	constexpr uint32_t frame_count = 32;
+	const BB::uint2 draw_area = BB::uint2(1280, 720);
+
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	std::vector<BB::ECSEntity> cubes;
+	BB::SceneHierarchy* scene = CreateHeadlessScene(arena, grid_size, draw_area, false, cubes);
+	BB::EntityComponentSystem& ecs = scene->GetECS();
+
+	BB::NullRenderer::ResetStats();
+	std::vector<HeadlessStageTime> stage_times;
+	ASSERT_TRUE(RunHeadlessFrames(ecs, draw_area, frame_count, stage_times));
+
+	const BB::NullRenderer::NullRendererStats stats = BB::NullRenderer::GetStats();
+	EXPECT_GE(stats.submit_count, frame_count);
+	EXPECT_EQ(stats.unsignaled_fence_waits, 0u);
+	EXPECT_GT(NullDrawCount(), 0u);
+
+	auto find_stage = [&stage_times](const char* a_name)
+	{
+		return std::find_if(stage_times.begin(), stage_times.end(), [a_name](const HeadlessStageTime& a_time) { return strcmp(a_time.name, a_name) == 0; });
+	};
+	ASSERT_NE(find_stage("draw list"), stage_times.end());
+	EXPECT_EQ(find_stage("draw list")->frames, frame_count);
+	EXPECT_NE(find_stage("shadow map"), stage_times.end());
+
+	double total = 0.0;
+	for (const HeadlessStageTime& stage_time : stage_times)
+		total += stage_time.total_milliseconds;
+	printf("render system cpu time per frame, %u entities over %u frames:\n", grid_size * grid_size, frame_count);
+	for (const HeadlessStageTime& stage_time : stage_times)
+		printf("  %-24s %8.4f ms\n", stage_time.name, stage_time.total_milliseconds / stage_time.frames);
+	printf("  %-24s %8.4f ms\n", "total", total / frame_count);
+}
+
+// the same scene with the archetype storage, half the cubes are destroyed between frames.
+TEST(RenderSystem, headless_archetype_scene)
+{
+	constexpr uint32_t grid_size = 16;
+	constexpr uint32_t frame_count = 4;
+	const BB::uint2 draw_area = BB::uint2(1280, 720);
+
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	std::vector<BB::ECSEntity> cubes;
+	BB::SceneHierarchy* scene = CreateHeadlessScene(arena, grid_size, draw_area, true, cubes);
+	BB::EntityComponentSystem& ecs = scene->GetECS();
+
+	std::vector<HeadlessStageTime> stage_times;
+	BB::NullRenderer::ResetStats();
+	ASSERT_TRUE(RunHeadlessFrames(ecs, draw_area, frame_count, stage_times));
+	EXPECT_GT(NullDrawCount(), 0u);
+
+	// the archetype storage owns the name atoms, renaming and destroying gives them back.
+	// the cube already has a name, so the assign replaces it and reports the signature as already registered.
+	ecs.EntityAssignName(cubes[0], "archetype name first");
+	ecs.EntityAssignName(cubes[0], "archetype name second");
+	EXPECT_FALSE(BB::StringAtomFind("archetype name first").IsValid());
+	EXPECT_TRUE(BB::StringAtomFind("archetype name second").IsValid());
+
+	for (size_t i = 0; i < cubes.size(); i += 2)
+		EXPECT_TRUE(ecs.DestroyEntity(cubes[i]));
+	EXPECT_FALSE(BB::StringAtomFind("archetype name second").IsValid());
+	for (size_t i = 0; i < cubes.size(); i++)
+		EXPECT_EQ(ecs.ValidateEntity(cubes[i]), (i & 1) == 1);
+
+	BB::NullRenderer::ResetStats();
+	ASSERT_TRUE(RunHeadlessFrames(ecs, draw_area, frame_count, stage_times));
+	EXPECT_GT(NullDrawCount(), 0u);
+	EXPECT_EQ(BB::NullRenderer::GetStats().unsignaled_fence_waits, 0u);
+}
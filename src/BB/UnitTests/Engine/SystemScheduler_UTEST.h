@@ -0,0 +1,231 @@
+#pragma once
+#include "../TestValues.h"
+#include "SceneHierarchy.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+struct SchedulerProbe
+{
+	std::atomic<uint32_t> running;
+	std::atomic<uint32_t> max_running;
+	std::atomic<uint32_t> finished;
+	// the amount of probes that could run at the same time.
+	uint32_t level_width;
+};
+
+struct SchedulerProbeSystem
+{
+	SchedulerProbe* probe;
+	uint32_t finish_order;
+};
+
+// stays in the system until every probe that may run next to it has started, or until it is clear nothing else will start.
+static void SchedulerProbeFunction(BB::EntityComponentSystem&, BB::MemoryArena&, void* a_user_data)
+{
+	SchedulerProbeSystem& system = *reinterpret_cast<SchedulerProbeSystem*>(a_user_data);
+	SchedulerProbe& probe = *system.probe;
+	const uint32_t running = ++probe.running;
+	uint32_t max_running = probe.max_running.load();
+	while (running > max_running && !probe.max_running.compare_exchange_weak(max_running, running)) {}
+
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+	while (probe.max_running.load() < probe.level_width && std::chrono::steady_clock::now() < timeout)
+		std::this_thread::yield();
+
+	system.finish_order = probe.finished++;
+	--probe.running;
+}
+
+static void RegisterProbeSystem(BB::ECSSystemScheduler& a_scheduler, SchedulerProbeSystem& a_system, const BB::ECSSystemAccess& a_access)
+{
+	BB::ECSSystemCreateInfo create_info;
+	create_info.name = "probe system";
+	create_info.function = SchedulerProbeFunction;
+	create_info.user_data = &a_system;
+	create_info.access = a_access;
+	a_scheduler.RegisterSystem(create_info);
+}
+
+// every scene takes index buffer space for its render system that is never given back, the tests in this file share one.
+static BB::EntityComponentSystem& SchedulerTestECS()
+{
+	static BB::MemoryArena arena = BB::MemoryArenaCreate();
+	static BB::SceneHierarchy* scene = nullptr;
+	if (scene == nullptr)
+	{
+		scene = ArenaAllocType(arena, BB::SceneHierarchy);
+		scene->Init(arena, 64, BB::uint2(64, 64), "scheduler scene");
+	}
+	return scene->GetECS();
+}
+
+TEST(SystemScheduler, conflicting_access_is_serialized_and_disjoint_runs_in_parallel)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::EntityComponentSystem& ecs = SchedulerTestECS();
+
+	// the transform system writes the world matrices the render transform system reads, the render light system only reads lights.
+	EXPECT_EQ(ecs.GetSystemScheduler().GetSystemCount(), 3u);
+	ecs.SystemsUpdate();
+	EXPECT_EQ(ecs.GetSystemScheduler().GetLastLevelCount(), 2u);
+
+	{
+		// a writer and a reader of the same pool, the reader runs after the writer.
+		SchedulerProbe probe{};
+		probe.level_width = 2;
+		SchedulerProbeSystem writer{ &probe, UINT32_MAX };
+		SchedulerProbeSystem reader{ &probe, UINT32_MAX };
+
+		BB::ECSSystemScheduler scheduler;
+		scheduler.Init(arena, 2);
+		RegisterProbeSystem(scheduler, writer, BB::ECSSystemAccess().Write<BB::PositionComponentPool>());
+		RegisterProbeSystem(scheduler, reader, BB::ECSSystemAccess().Read<BB::PositionComponentPool, BB::ScaleComponentPool>());
+		scheduler.Execute(ecs, arena);
+
+		EXPECT_EQ(scheduler.GetLastLevelCount(), 2u);
+		EXPECT_EQ(probe.max_running.load(), 1u);
+		EXPECT_EQ(writer.finish_order, 0u);
+		EXPECT_EQ(reader.finish_order, 1u);
+	}
+
+	{
+		// readers of the same pool and writers of different pools do not conflict, all of them run at the same time.
+		SchedulerProbe probe{};
+		probe.level_width = 3;
+		SchedulerProbeSystem systems[3]{ { &probe, UINT32_MAX }, { &probe, UINT32_MAX }, { &probe, UINT32_MAX } };
+
+		BB::ECSSystemScheduler scheduler;
+		scheduler.Init(arena, 3);
+		RegisterProbeSystem(scheduler, systems[0], BB::ECSSystemAccess().Read<BB::PositionComponentPool>().Write<BB::ScaleComponentPool>());
+		RegisterProbeSystem(scheduler, systems[1], BB::ECSSystemAccess().Read<BB::PositionComponentPool>().Write<BB::RotationComponentPool>());
+		RegisterProbeSystem(scheduler, systems[2], BB::ECSSystemAccess().Write<BB::BoundingBoxComponentPool>());
+		scheduler.Execute(ecs, arena);
+
+		EXPECT_EQ(scheduler.GetLastLevelCount(), 1u);
+		EXPECT_EQ(probe.max_running.load(), 3u);
+		EXPECT_EQ(probe.finished.load(), 3u);
+	}
+}
+
+struct CommandRecordSystem
+{
+	BB::ECSCommandBuffer buffer;
+	BB::ECSEntity destroy_target;
+	BB::float3 position;
+};
+
+static BB::ECSEntity SelectEntityAbove(BB::EntityComponentSystem& a_ecs, const BB::float3 a_position)
+{
+	return a_ecs.SelectEntityByRay(a_position + BB::float3(0.f, 50.f, 0.f), BB::float3(0.f, -1.f, 0.f));
+}
+
+// records out of order on purpose, playback creates first, then adds components and destroys last.
+static void CommandRecordFunction(BB::EntityComponentSystem& a_ecs, BB::MemoryArena&, void* a_user_data)
+{
+	CommandRecordSystem& system = *reinterpret_cast<CommandRecordSystem*>(a_user_data);
+	BB::ECSCommandBuffer& buffer = system.buffer;
+	const BB::BoundingBox box{ BB::float3(-0.5f, -0.5f, -0.5f), BB::float3(0.5f, 0.5f, 0.5f) };
+
+	buffer.DestroyEntity(system.destroy_target);
+	const BB::ECSEntity spawned = buffer.CreateEntity("spawned", BB::INVALID_ECS_OBJ, system.position);
+	buffer.AssignBoundingBox(spawned, box);
+
+	// the child is recorded after the destroy of its parent, it is created first and destroyed with the parent.
+	const BB::ECSEntity parent = buffer.CreateEntity("parent", BB::INVALID_ECS_OBJ, system.position + BB::float3(0.f, 0.f, 4.f));
+	buffer.DestroyEntity(parent);
+	const BB::ECSEntity child = buffer.CreateEntity("child", parent, BB::float3(0.f, 0.f, 4.f));
+	buffer.AssignBoundingBox(parent, box);
+	buffer.AssignBoundingBox(child, box);
+
+	a_ecs.SubmitCommandBuffer(buffer);
+}
+
+// systems on different threads record into their own command buffer, nothing changes until the next sync point.
+TEST(SystemScheduler, command_buffer_playback_order)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::EntityComponentSystem& ecs = SchedulerTestECS();
+	const BB::BoundingBox box{ BB::float3(-0.5f, -0.5f, -0.5f), BB::float3(0.5f, 0.5f, 0.5f) };
+
+	CommandRecordSystem systems[2];
+	BB::ECSSystemScheduler scheduler;
+	scheduler.Init(arena, _countof(systems));
+	for (uint32_t i = 0; i < _countof(systems); i++)
+	{
+		CommandRecordSystem& system = systems[i];
+		system.buffer.Init(arena, BB::kbSize * 4);
+		system.position = BB::float3(100.f + static_cast<float>(i) * 20.f, 0.f, 0.f);
+		system.destroy_target = ecs.CreateEntity("target", BB::INVALID_ECS_OBJ, system.position - BB::float3(0.f, 0.f, 4.f));
+		ASSERT_TRUE(ecs.EntityAssignBoundingBox(system.destroy_target, box));
+
+		BB::ECSSystemCreateInfo create_info;
+		create_info.name = "command record system";
+		create_info.function = CommandRecordFunction;
+		create_info.user_data = &system;
+		create_info.access = BB::ECSSystemAccess();
+		scheduler.RegisterSystem(create_info);
+	}
+	ecs.SystemsUpdate();
+
+	scheduler.Execute(ecs, arena);
+	EXPECT_EQ(scheduler.GetLastLevelCount(), 1u);
+	for (const CommandRecordSystem& system : systems)
+	{
+		EXPECT_TRUE(ecs.ValidateEntity(system.destroy_target));
+		EXPECT_FALSE(ecs.ValidateEntity(SelectEntityAbove(ecs, system.position)));
+	}
+
+	// plays the commands back and runs the transform system, so the new entities have their world matrix.
+	ecs.SystemsUpdate();
+	for (const CommandRecordSystem& system : systems)
+	{
+		EXPECT_FALSE(ecs.ValidateEntity(system.destroy_target));
+		const BB::ECSEntity spawned = SelectEntityAbove(ecs, system.position);
+		ASSERT_TRUE(ecs.ValidateEntity(spawned));
+		EXPECT_EQ(ecs.GetPosition(spawned).x, system.position.x);
+		EXPECT_EQ(ecs.GetBoundingBox(spawned).max.y, box.max.y);
+		EXPECT_FALSE(ecs.ValidateEntity(SelectEntityAbove(ecs, system.position + BB::float3(0.f, 0.f, 4.f))));
+		EXPECT_FALSE(ecs.ValidateEntity(SelectEntityAbove(ecs, system.position + BB::float3(0.f, 0.f, 8.f))));
+	}
+}
+
+TEST(SystemScheduler, command_buffer_full_and_stale_parent)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::EntityComponentSystem& ecs = SchedulerTestECS();
+	const BB::float3 position = BB::float3(-100.f, 0.f, 0.f);
+	const BB::BoundingBox box{ BB::float3(-0.5f, -0.5f, -0.5f), BB::float3(0.5f, 0.5f, 0.5f) };
+
+	// a full buffer fails the record instead of writing past its memory.
+	BB::ECSCommandBuffer small_buffer;
+	small_buffer.Init(arena, 256);
+	uint32_t recorded = 0;
+	while (small_buffer.CreateEntity("overflow").IsValid())
+		++recorded;
+	EXPECT_EQ(small_buffer.GetCreateCount(), recorded);
+	// a destroy has no payload and can still fit in the space a create left.
+	while (small_buffer.DestroyEntity(BB::ECSEntity(0, 0))) {}
+	EXPECT_FALSE(small_buffer.AssignName(BB::ECSEntity(0, 0), "overflow"));
+	small_buffer.Reset();
+	EXPECT_EQ(small_buffer.GetCommandCount(), 0u);
+
+	// the parent is destroyed before playback, the entity becomes a root entity.
+	const BB::ECSEntity parent = ecs.CreateEntity("stale parent");
+	BB::ECSCommandBuffer buffer;
+	buffer.Init(arena, BB::kbSize);
+	const BB::ECSEntity child = buffer.CreateEntity("orphan", parent, position);
+	ASSERT_TRUE(child.IsValid());
+	EXPECT_TRUE(buffer.AssignBoundingBox(child, box));
+	ecs.SubmitCommandBuffer(buffer);
+	EXPECT_EQ(buffer.GetCommandCount(), 0u);
+	ASSERT_TRUE(ecs.DestroyEntity(parent));
+
+	ecs.SystemsUpdate();
+	ecs.SystemsUpdate();
+	const BB::ECSEntity orphan = SelectEntityAbove(ecs, position);
+	ASSERT_TRUE(ecs.ValidateEntity(orphan));
+	EXPECT_EQ(ecs.GetPosition(orphan).x, position.x);
+	EXPECT_TRUE(ecs.DestroyEntity(orphan));
+}
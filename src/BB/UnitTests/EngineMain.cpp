@@ -0,0 +1,42 @@
+// EngineMain.cpp : runs the engine tests on the null renderer, no gpu or window is needed.
+
+#pragma warning(push)
+#pragma warning(disable:26495)
+#pragma warning(disable:26439)
+#pragma warning(disable:26812)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include "Engine.hpp"
+
+using namespace BB;
+int main(int argc, char** argv)
+{
+	MemoryArena main_arena = MemoryArenaCreate();
+	EngineOptions engine_options{};
+	// like the editor, the engine finds the resources folder from the source path.
+	engine_options.exe_path = ENGINE_SRC_PATH;
+	engine_options.max_materials = 128;
+	engine_options.max_shader_effects = 64;
+	// every test scene makes its own material instances and the engine does not free them.
+	engine_options.max_material_instances = 1024;
+	// the scene and the ecs always profile, so the profiler has to be there.
+	engine_options.enable_debug = true;
+	engine_options.debug_options.max_profiler_entries = 64;
+	// the scheduler tests need job threads to run systems next to each other, also on a machine with few processors.
+	engine_options.job_thread_count = 4;
+
+	GraphicOptions graphic_options;
+	graphic_options.use_raytracing = false;
+	InitEngine(main_arena, L"BB_ENGINE_UNIT_TEST", engine_options, graphic_options);
+
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#pragma warning(disable:6262)
+#include "Engine/ArchetypeMap_UTEST.h"
+#include "Engine/EntityComponentSystem_UTEST.h"
+#include "Engine/RenderSystem_UTEST.h"
+#include "Engine/SystemScheduler_UTEST.h"
+#pragma warning(default:6262)
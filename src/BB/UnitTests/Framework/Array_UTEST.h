@@ -12,7 +12,7 @@ TEST(ArrayDataStructure, push_reserve)
 	BB::FreelistAllocator_t t_Allocator(allocatorSize);
 
 	BB::Array<size2593bytes> t_Array(t_Allocator);
-	EXPECT_EQ(t_Array.capacity(), BB::Array_Specs::multipleValue);
+	EXPECT_EQ(t_Array.capacity(), BB::Array_Specs::multiple_value);
 
 	//Allocate an object without having allocated memory, this must be valid.
 	{
@@ -104,10 +104,10 @@ TEST(ArrayDataStructure, Array_push)
 
 	BB::Array<size2593bytes> t_Array(t_Allocator, initialSize);
 
-	size_t t_RandomValues[pushSize]{};
+	size_t t_RandomValues[pushSize + 1]{};
 	size2593bytes t_SizeArray[initialSize]{};
 
-	for (size_t i = 0; i < pushSize; i++)
+	for (size_t i = 0; i < pushSize + 1; i++)
 	{
 		t_RandomValues[i] = static_cast<size_t>(BB::Random::Random());
 	}
@@ -174,7 +174,7 @@ TEST(ArrayDataStructure, Array_emplace_back)
 	BB::FreelistAllocator_t t_Allocator(allocatorSize);
 
 	BB::Array<size2593bytes> t_Array(t_Allocator);
-	EXPECT_EQ(t_Array.capacity(), BB::Array_Specs::multipleValue);
+	EXPECT_EQ(t_Array.capacity(), BB::Array_Specs::multiple_value);
 
 	size_t t_RandomValues[samples]{};
 
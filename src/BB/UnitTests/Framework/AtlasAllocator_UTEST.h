@@ -0,0 +1,139 @@
+#pragma once
+#include "../TestValues.h"
+#include "Allocators/AtlasAllocator.hpp"
+
+TEST(AtlasAllocator, fill_free_merge)
+{
+	constexpr uint32_t atlas_size = 1024;
+	constexpr uint32_t tile_size = 128;
+	constexpr uint32_t tiles_per_row = atlas_size / tile_size;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::AtlasAllocator allocator;
+	allocator.Init(arena, atlas_size, 16);
+
+	BB::AtlasAllocation tiles[tiles_per_row * tiles_per_row];
+	for (uint32_t i = 0; i < _countof(tiles); i++)
+	{
+		tiles[i] = allocator.Allocate(tile_size);
+		ASSERT_TRUE(tiles[i].IsValid());
+		EXPECT_EQ(tiles[i].size, tile_size);
+		EXPECT_EQ(tiles[i].offset.x % tile_size, 0u) << "tile is not aligned to its size";
+		EXPECT_EQ(tiles[i].offset.y % tile_size, 0u) << "tile is not aligned to its size";
+	}
+	EXPECT_FALSE(allocator.Allocate(16).IsValid()) << "atlas is full but still allocated";
+	EXPECT_EQ(allocator.GetReport().used_area, static_cast<uint64_t>(atlas_size) * atlas_size);
+
+	// free one tile out of every block of 4, nothing can merge so a larger tile does not fit.
+	for (uint32_t i = 0; i < _countof(tiles); i += 4)
+		allocator.Free(tiles[i]);
+	EXPECT_EQ(allocator.GetReport().largest_free, tile_size);
+	EXPECT_FALSE(allocator.Allocate(tile_size * 2).IsValid()) << "tile larger then any free node succeeded";
+
+	// the rest merges everything back into the whole atlas.
+	for (uint32_t i = 0; i < _countof(tiles); i++)
+		if (i % 4 != 0)
+			allocator.Free(tiles[i]);
+	const BB::AtlasAllocatorReport report = allocator.GetReport();
+	EXPECT_EQ(report.used_area, 0u);
+	EXPECT_EQ(report.allocation_count, 0u);
+	EXPECT_EQ(report.largest_free, atlas_size);
+
+	const BB::AtlasAllocation full = allocator.Allocate(atlas_size);
+	ASSERT_TRUE(full.IsValid());
+	EXPECT_EQ(full.offset.x, 0u);
+	EXPECT_EQ(full.offset.y, 0u);
+	allocator.Free(full);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(AtlasAllocator, sizes_round_up)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::AtlasAllocator allocator;
+	allocator.Init(arena, 512, 32);
+
+	EXPECT_FALSE(allocator.Allocate(0).IsValid());
+	EXPECT_FALSE(allocator.Allocate(513).IsValid());
+
+	const BB::AtlasAllocation small = allocator.Allocate(5);
+	ASSERT_TRUE(small.IsValid());
+	EXPECT_EQ(small.size, 32u) << "tile smaller then the min tile size";
+	const BB::AtlasAllocation odd = allocator.Allocate(100);
+	ASSERT_TRUE(odd.IsValid());
+	EXPECT_EQ(odd.size, 128u);
+
+	// small tiles pack into the node that is already split, the other 3 quarters stay whole.
+	const BB::AtlasAllocation second_small = allocator.Allocate(32);
+	ASSERT_TRUE(second_small.IsValid());
+	EXPECT_EQ(allocator.GetReport().largest_free, 256u);
+
+	allocator.Free(small);
+	allocator.Free(odd);
+	allocator.Free(second_small);
+	EXPECT_EQ(allocator.GetReport().largest_free, 512u);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(AtlasAllocator, random_tiles_never_overlap)
+{
+	constexpr uint32_t atlas_size = 2048;
+	constexpr uint32_t min_tile = 32;
+	constexpr uint32_t cells = atlas_size / min_tile;
+	constexpr uint32_t slot_count = 256;
+	constexpr uint32_t iterations = 20000;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::AtlasAllocator allocator;
+	allocator.Init(arena, atlas_size, min_tile);
+
+	// every min tile cell of the atlas remembers which slot owns it.
+	uint16_t* owners = ArenaAllocArr(arena, uint16_t, cells * cells);
+	constexpr uint16_t NO_OWNER = UINT16_MAX;
+	for (uint32_t i = 0; i < cells * cells; i++)
+		owners[i] = NO_OWNER;
+
+	BB::AtlasAllocation slots[slot_count];
+	uint64_t used_area = 0;
+
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+	{
+		const uint32_t slot = BB::Random::Random(slot_count);
+		if (slots[slot].IsValid())
+		{
+			const BB::AtlasAllocation tile = slots[slot];
+			for (uint32_t y = tile.offset.y / min_tile; y < (tile.offset.y + tile.size) / min_tile; y++)
+				for (uint32_t x = tile.offset.x / min_tile; x < (tile.offset.x + tile.size) / min_tile; x++)
+					owners[y * cells + x] = NO_OWNER;
+			allocator.Free(tile);
+			used_area -= static_cast<uint64_t>(tile.size) * tile.size;
+			slots[slot] = BB::AtlasAllocation();
+			continue;
+		}
+
+		const BB::AtlasAllocation tile = allocator.Allocate(BB::Random::Random(1, 512));
+		if (!tile.IsValid())
+			continue;
+
+		ASSERT_LE(tile.offset.x + tile.size, atlas_size);
+		ASSERT_LE(tile.offset.y + tile.size, atlas_size);
+		for (uint32_t y = tile.offset.y / min_tile; y < (tile.offset.y + tile.size) / min_tile; y++)
+			for (uint32_t x = tile.offset.x / min_tile; x < (tile.offset.x + tile.size) / min_tile; x++)
+			{
+				ASSERT_EQ(owners[y * cells + x], NO_OWNER) << "tile overlaps with slot " << owners[y * cells + x];
+				owners[y * cells + x] = static_cast<uint16_t>(slot);
+			}
+		slots[slot] = tile;
+		used_area += static_cast<uint64_t>(tile.size) * tile.size;
+	}
+
+	EXPECT_EQ(allocator.GetReport().used_area, used_area);
+
+	for (uint32_t i = 0; i < slot_count; i++)
+		if (slots[i].IsValid())
+			allocator.Free(slots[i]);
+
+	EXPECT_EQ(allocator.GetReport().largest_free, atlas_size) << "free tiles did not merge back together";
+
+	BB::MemoryArenaFree(arena);
+}
@@ -1,8 +1,9 @@
 #pragma once
 #include "../TestValues.h"
-#include "BBJson.hpp"
+#include "BBjson.hpp"
 #include "BBMain.h"
 #include "Storage/BBString.h"
+#include "OS/Program.h"
 
 TEST(BBjson, Small_Local_Memory_JSON)
 {
@@ -72,4 +73,44 @@ TEST(BBjson, Big_Disk_JSON)
 	//call the destructor as I want to clear the allocator.
 	t_JsonString.~Basic_String();
 	BB::MemoryArenaFree(arena);
-}
\ No newline at end of file
+}
+
+// a token that ends on the last byte of a file that fills a whole page has nothing mapped after it.
+static void WriteJsonEndingAtPage(BB::MemoryArena& a_arena, const char* a_path, const char* a_token)
+{
+	const size_t file_size = BB::OSPageSize();
+	const size_t token_size = strlen(a_token);
+	char* data = ArenaAllocArr(a_arena, char, file_size);
+	memset(data, ' ', file_size - token_size);
+	memcpy(data + file_size - token_size, a_token, token_size);
+
+	BB::OSFileHandle file = BB::OSCreateFile(a_path);
+	BB::OSWriteFile(file, data, file_size);
+	BB::CloseOSFile(file);
+}
+
+TEST(BBjson, Tokens_Ending_At_End_Of_File)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+
+	WriteJsonEndingAtPage(arena, "json_eof_number.json", "-12.5");
+	{
+		BB::JsonParser parser("json_eof_number.json");
+		parser.Parse();
+		const BB::JsonNode* number = parser.GetRootNode();
+		ASSERT_EQ(number->type, BB::JSON_TYPE::NUMBER);
+		EXPECT_EQ(number->number, -12.5f);
+	}
+
+	// not closed, the string stops at the end of the file.
+	WriteJsonEndingAtPage(arena, "json_eof_string.json", "\"unclosed");
+	{
+		BB::JsonParser parser("json_eof_string.json");
+		parser.Parse();
+		const BB::JsonNode* string = parser.GetRootNode();
+		ASSERT_EQ(string->type, BB::JSON_TYPE::STRING);
+		EXPECT_STREQ(string->string, "unclosed");
+	}
+
+	BB::MemoryArenaFree(arena);
+}
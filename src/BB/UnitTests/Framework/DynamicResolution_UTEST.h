@@ -0,0 +1,192 @@
+#pragma once
+#include "../TestValues.h"
+#include "DynamicResolution.hpp"
+
+// a recorded trace of a scene, the gpu time of a frame is a fixed part and a part that follows the pixel count.
+struct DynamicResolutionTrace
+{
+	double cpu_time;
+	double gpu_fixed_time;
+	double gpu_full_resolution_time;
+	// every frame is off by up to this much, deterministic so the test is.
+	double noise;
+	uint32_t noise_seed;
+
+	double NextNoise()
+	{
+		noise_seed = noise_seed * 1664525u + 1013904223u;
+		return (static_cast<double>(noise_seed >> 8) / static_cast<double>(1u << 24) * 2.0 - 1.0) * noise;
+	}
+
+	double GPUTime(const float a_scale)
+	{
+		const double gpu_time = gpu_fixed_time + gpu_full_resolution_time * static_cast<double>(a_scale) * static_cast<double>(a_scale);
+		return gpu_time * (1.0 + NextNoise());
+	}
+};
+
+static BB::DynamicResolutionCreateInfo DynamicResolutionTestCreateInfo()
+{
+	BB::DynamicResolutionCreateInfo create_info;
+	create_info.target_frame_time = 16.6f;
+	create_info.min_scale = 0.25f;
+	create_info.max_scale = 1.f;
+	create_info.window_size = 8;
+	return create_info;
+}
+
+static float RunDynamicResolutionTrace(BB::DynamicResolution& a_controller, DynamicResolutionTrace& a_trace, const uint32_t a_frame_count)
+{
+	float scale = a_controller.GetScale();
+	for (uint32_t i = 0; i < a_frame_count; i++)
+		scale = a_controller.Update(a_trace.cpu_time, a_trace.GPUTime(scale));
+	return scale;
+}
+
+TEST(DynamicResolution, gpu_bound_trace_settles_under_budget)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::DynamicResolution controller;
+	const BB::DynamicResolutionCreateInfo create_info = DynamicResolutionTestCreateInfo();
+	controller.Init(arena, create_info);
+	EXPECT_EQ(controller.GetScale(), create_info.max_scale);
+
+	// 30ms at full resolution, a 60hz target needs about 0.7.
+	DynamicResolutionTrace trace{ 6.0, 2.0, 28.0, 0.0, 1 };
+	const float scale = RunDynamicResolutionTrace(controller, trace, 200);
+	EXPECT_LT(scale, 1.f);
+	EXPECT_LE(trace.GPUTime(scale), create_info.target_frame_time) << "settled on a scale that is over the budget";
+	EXPECT_GE(trace.GPUTime(scale), create_info.target_frame_time * 0.75) << "dropped a lot further then needed";
+
+	// settled, it stays there.
+	const uint32_t changes = controller.GetState().scale_changes;
+	EXPECT_EQ(RunDynamicResolutionTrace(controller, trace, 200), scale);
+	EXPECT_EQ(controller.GetState().scale_changes, changes);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(DynamicResolution, light_trace_grows_back_to_max)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::DynamicResolution controller;
+	const BB::DynamicResolutionCreateInfo create_info = DynamicResolutionTestCreateInfo();
+	controller.Init(arena, create_info);
+	controller.Reset(0.25f);
+
+	DynamicResolutionTrace trace{ 4.0, 1.0, 8.0, 0.0, 1 };
+	// grows at most 5% a window, so it takes a while.
+	EXPECT_EQ(RunDynamicResolutionTrace(controller, trace, 400), create_info.max_scale);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(DynamicResolution, cpu_bound_trace_keeps_scale)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::DynamicResolution controller;
+	const BB::DynamicResolutionCreateInfo create_info = DynamicResolutionTestCreateInfo();
+	controller.Init(arena, create_info);
+
+	// the gpu is over the target but faster then the cpu, a lower scale would not make the frame faster.
+	DynamicResolutionTrace trace{ 25.0, 2.0, 18.0, 0.0, 1 };
+	EXPECT_EQ(RunDynamicResolutionTrace(controller, trace, 200), create_info.max_scale);
+	EXPECT_EQ(controller.GetState().scale_changes, 0u);
+
+	// when the cpu gets faster the gpu is the slow one.
+	trace.cpu_time = 5.0;
+	EXPECT_LT(RunDynamicResolutionTrace(controller, trace, 200), create_info.max_scale);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(DynamicResolution, noisy_trace_does_not_oscillate)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::DynamicResolution controller;
+	const BB::DynamicResolutionCreateInfo create_info = DynamicResolutionTestCreateInfo();
+	controller.Init(arena, create_info);
+
+	DynamicResolutionTrace trace{ 6.0, 2.0, 24.0, 0.15, 1234 };
+	RunDynamicResolutionTrace(controller, trace, 300);
+
+	const uint32_t changes = controller.GetState().scale_changes;
+	RunDynamicResolutionTrace(controller, trace, 1000);
+	EXPECT_LE(controller.GetState().scale_changes - changes, 2u) << "the scale keeps changing on noise";
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(DynamicResolution, spike_drops_then_recovers)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::DynamicResolution controller;
+	const BB::DynamicResolutionCreateInfo create_info = DynamicResolutionTestCreateInfo();
+	controller.Init(arena, create_info);
+
+	DynamicResolutionTrace trace{ 6.0, 2.0, 10.0, 0.0, 1 };
+	EXPECT_EQ(RunDynamicResolutionTrace(controller, trace, 100), create_info.max_scale);
+
+	// a heavy stretch, like an explosion filling the screen.
+	trace.gpu_full_resolution_time = 40.0;
+	const float heavy_scale = RunDynamicResolutionTrace(controller, trace, 100);
+	EXPECT_LT(heavy_scale, 0.75f);
+	EXPECT_LE(trace.GPUTime(heavy_scale), create_info.target_frame_time);
+
+	trace.gpu_full_resolution_time = 10.0;
+	EXPECT_EQ(RunDynamicResolutionTrace(controller, trace, 600), create_info.max_scale);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(DynamicResolution, scaled_resolution_rounds_and_clamps)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::DynamicResolution controller;
+	BB::DynamicResolutionCreateInfo create_info = DynamicResolutionTestCreateInfo();
+	create_info.min_scale = 0.001f;
+	controller.Init(arena, create_info);
+
+	EXPECT_EQ(controller.GetScaledResolution(BB::uint2(1920, 1080)), BB::uint2(1920, 1080));
+	controller.Reset(0.5f);
+	EXPECT_EQ(controller.GetScaledResolution(BB::uint2(1920, 1080)), BB::uint2(960, 540));
+	EXPECT_EQ(controller.GetScaledResolution(BB::uint2(3, 5)), BB::uint2(2, 3));
+	controller.Reset(0.001f);
+	EXPECT_EQ(controller.GetScaledResolution(BB::uint2(100, 100)), BB::uint2(1, 1));
+	controller.Reset(4.f);
+	EXPECT_EQ(controller.GetScale(), create_info.max_scale);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(CountingRingBuffer, sum_follows_the_window)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::CountingRingBuffer buffer;
+	BB::CountingRingBufferInit(arena, buffer, 5);
+	EXPECT_EQ(BB::CountingRingBufferSize(buffer), 0u);
+	EXPECT_EQ(BB::CountingRingBufferAverage(buffer), 0.0);
+
+	for (uint32_t i = 1; i <= 10; i++)
+	{
+		BB::CountingRingBufferPush(buffer, static_cast<double>(i));
+		// holds the last 4 values.
+		const uint32_t size = i < 4 ? i : 4;
+		double sum = 0;
+		for (uint32_t j = i - size + 1; j <= i; j++)
+			sum += static_cast<double>(j);
+		ASSERT_EQ(BB::CountingRingBufferSize(buffer), size);
+		ASSERT_DOUBLE_EQ(buffer.sum, sum);
+	}
+
+	const BB::StaticArray<double> linear = BB::CountingRingBufferLinear(arena, buffer);
+	ASSERT_EQ(linear.size(), 4u);
+	for (uint32_t i = 0; i < linear.size(); i++)
+		EXPECT_EQ(linear[i], static_cast<double>(7 + i));
+
+	BB::CountingRingBufferClear(buffer);
+	EXPECT_EQ(BB::CountingRingBufferSize(buffer), 0u);
+	EXPECT_EQ(buffer.sum, 0.0);
+
+	BB::MemoryArenaFree(arena);
+}
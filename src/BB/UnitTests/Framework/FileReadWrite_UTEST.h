@@ -1,84 +1,191 @@
 #pragma once
 #include "../TestValues.h"
 #include "OS/Program.h"
+#include "MemoryArena.hpp"
 
 TEST(Program_IO, Read_Write_Files)
 {
-	BB::LinearAllocator_t t_Allocator(1024);
+	BB::MemoryArena t_Allocator = BB::MemoryArenaCreate();
 
-	constexpr wchar* DOC_NAME = L"READWRITETEST.txt";
-	constexpr char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
+	constexpr const wchar* DOC_NAME = L"READWRITETEST.txt";
+	constexpr const char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
 
 	BB::OSFileHandle t_TestFile = BB::OSCreateFile(DOC_NAME);
 	
-	BB::OSWriteFile(t_TestFile, DOC_DATA, strnlen_s(DOC_DATA, 1024));
+	BB::OSWriteFile(t_TestFile, DOC_DATA, strlen(DOC_DATA));
 
 	BB::CloseOSFile(t_TestFile);
 
 	BB::Buffer t_ReadBuffer = BB::OSReadFile(t_Allocator, DOC_NAME);
 
-	char* t_TestText = BBnewArr(t_Allocator, t_ReadBuffer.size + 1, char);
+	char* t_TestText = ArenaAllocArr(t_Allocator, char, t_ReadBuffer.size + 1);
 	memcpy(t_TestText, t_ReadBuffer.data, t_ReadBuffer.size);
 	t_TestText[t_ReadBuffer.size] = '\0';
 
 	//Should be equal, or else read or write is broken.
 	ASSERT_STREQ(t_TestText, DOC_DATA);
 
-	t_Allocator.Clear();
+	BB::MemoryArenaFree(t_Allocator);
 }
 
 TEST(Program_IO, Read_Write_Files_Chunks)
 {
-	BB::LinearAllocator_t t_Allocator(1024);
+	BB::MemoryArena t_Allocator = BB::MemoryArenaCreate();
 
-	constexpr wchar* DOC_NAME = L"READWRITETEST_CHUNK.txt";
-	constexpr char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
-	constexpr char* DOC_DATA_CHUNK_ONE = "HELLO WORLD!";
-	constexpr char* DOC_DATA_CHUNK_TWO = " I'm a BB engine unit";
-	constexpr char* DOC_DATA_CHUNK_THREE = " test for file read and writing.";
+	constexpr const wchar* DOC_NAME = L"READWRITETEST_CHUNK.txt";
+	constexpr const char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
+	constexpr const char* DOC_DATA_CHUNK_ONE = "HELLO WORLD!";
+	constexpr const char* DOC_DATA_CHUNK_TWO = " I'm a BB engine unit";
+	constexpr const char* DOC_DATA_CHUNK_THREE = " test for file read and writing.";
 
 	BB::OSFileHandle t_TestFile = BB::OSCreateFile(DOC_NAME);
 
-	BB::OSWriteFile(t_TestFile, DOC_DATA_CHUNK_ONE, strnlen_s(DOC_DATA_CHUNK_ONE, 1024));
-	BB::OSWriteFile(t_TestFile, DOC_DATA_CHUNK_TWO, strnlen_s(DOC_DATA_CHUNK_TWO, 1024));
-	BB::OSWriteFile(t_TestFile, DOC_DATA_CHUNK_THREE, strnlen_s(DOC_DATA_CHUNK_THREE, 1024));
+	BB::OSWriteFile(t_TestFile, DOC_DATA_CHUNK_ONE, strlen(DOC_DATA_CHUNK_ONE));
+	BB::OSWriteFile(t_TestFile, DOC_DATA_CHUNK_TWO, strlen(DOC_DATA_CHUNK_TWO));
+	BB::OSWriteFile(t_TestFile, DOC_DATA_CHUNK_THREE, strlen(DOC_DATA_CHUNK_THREE));
 
 
 	BB::CloseOSFile(t_TestFile);
 
 	BB::Buffer t_ReadBuffer = BB::OSReadFile(t_Allocator, DOC_NAME);
 
-	char* t_TestText = BBnewArr(t_Allocator, t_ReadBuffer.size + 1, char);
+	char* t_TestText = ArenaAllocArr(t_Allocator, char, t_ReadBuffer.size + 1);
 	memcpy(t_TestText, t_ReadBuffer.data, t_ReadBuffer.size);
 	t_TestText[t_ReadBuffer.size] = '\0';
 
 	//Should be equal, or else read or write is broken.
 	ASSERT_STREQ(t_TestText, DOC_DATA);
 
-	t_Allocator.Clear();
+	BB::MemoryArenaFree(t_Allocator);
 }
 
 TEST(Program_IO, Read_Write_Files_Same_File)
 {
-	BB::LinearAllocator_t t_Allocator(1024);
+	BB::MemoryArena t_Allocator = BB::MemoryArenaCreate();
 
-	constexpr wchar* DOC_NAME = L"READWRITETEST_SAMEFILE.txt";
-	constexpr char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
+	constexpr const wchar* DOC_NAME = L"READWRITETEST_SAMEFILE.txt";
+	constexpr const char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
 
 	BB::OSFileHandle t_TestFile = BB::OSCreateFile(DOC_NAME);
 
-	BB::OSWriteFile(t_TestFile, DOC_DATA, strnlen_s(DOC_DATA, 1024));
+	BB::OSWriteFile(t_TestFile, DOC_DATA, strlen(DOC_DATA));
 
 	BB::SetOSFilePosition(t_TestFile, 0, BB::OS_FILE_READ_POINT::BEGIN);
 
 	BB::Buffer t_ReadBuffer = BB::OSReadFile(t_Allocator, t_TestFile);
 
-	char* t_TestText = BBnewArr(t_Allocator, t_ReadBuffer.size + 1, char);
+	char* t_TestText = ArenaAllocArr(t_Allocator, char, t_ReadBuffer.size + 1);
 	memcpy(t_TestText, t_ReadBuffer.data, t_ReadBuffer.size);
 	t_TestText[t_ReadBuffer.size] = '\0';
 
 	//Should be equal, or else read or write is broken.
 	ASSERT_STREQ(t_TestText, DOC_DATA);
 
-	t_Allocator.Clear();
-}
\ No newline at end of file
+	BB::MemoryArenaFree(t_Allocator);
+}
+
+TEST(Program_IO, Read_File_At_Offset)
+{
+	constexpr const char* DOC_NAME = "READWRITETEST_OFFSET.txt";
+	constexpr const char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
+	const size_t doc_size = strlen(DOC_DATA);
+
+	BB::OSFileHandle test_file = BB::OSCreateFile(DOC_NAME);
+	BB::OSWriteFile(test_file, DOC_DATA, doc_size);
+
+	char text[32]{};
+	ASSERT_EQ(BB::OSReadFileAt(test_file, text, 5, 6), 5u);
+	ASSERT_STREQ(text, "WORLD");
+
+	//Reading past the end only gives back what is there.
+	memset(text, 0, sizeof(text));
+	ASSERT_EQ(BB::OSReadFileAt(test_file, text, sizeof(text) - 1, doc_size - 8), 8u);
+	ASSERT_STREQ(text, "writing.");
+
+	BB::CloseOSFile(test_file);
+}
+
+TEST(Program_IO, Async_Read_Batch)
+{
+	constexpr const char* DOC_NAME = "READWRITETEST_ASYNC.bin";
+	constexpr uint32_t READ_COUNT = 16;
+	constexpr uint32_t READ_SIZE = 4096;
+
+	uint32_t data[READ_COUNT * READ_SIZE / sizeof(uint32_t)];
+	for (uint32_t i = 0; i < sizeof(data) / sizeof(data[0]); i++)
+		data[i] = i;
+
+	BB::OSFileHandle test_file = BB::OSCreateFile(DOC_NAME);
+	BB::OSWriteFile(test_file, data, sizeof(data));
+	BB::CloseOSFile(test_file);
+	test_file = BB::OSLoadFile(DOC_NAME);
+
+	uint32_t read_data[READ_COUNT * READ_SIZE / sizeof(uint32_t)]{};
+	BB::OSAsyncReadInfo infos[READ_COUNT];
+	BB::OSAsyncRead reads[READ_COUNT];
+	//Read the blocks in reverse so that the offsets really matter.
+	for (uint32_t i = 0; i < READ_COUNT; i++)
+	{
+		infos[i].file = test_file;
+		infos[i].file_offset = static_cast<uint64_t>(READ_COUNT - 1 - i) * READ_SIZE;
+		infos[i].buffer = BB::Pointer::Add(read_data, infos[i].file_offset);
+		infos[i].size = READ_SIZE;
+	}
+	ASSERT_TRUE(BB::OSSubmitAsyncReads(infos, READ_COUNT, reads));
+
+	for (uint32_t i = 0; i < READ_COUNT; i++)
+	{
+		size_t bytes_read = 0;
+		ASSERT_EQ(BB::OSWaitAsyncRead(reads[i], &bytes_read), BB::OS_ASYNC_READ_STATUS::DONE);
+		ASSERT_EQ(bytes_read, READ_SIZE);
+	}
+	ASSERT_EQ(memcmp(data, read_data, sizeof(data)), 0);
+
+	//Polling until it is done gives the same result as a wait.
+	uint32_t first_block[READ_SIZE / sizeof(uint32_t)]{};
+	BB::OSAsyncReadInfo poll_info{ test_file, 0, first_block, READ_SIZE };
+	BB::OSAsyncRead poll_read;
+	ASSERT_TRUE(BB::OSSubmitAsyncReads(&poll_info, 1, &poll_read));
+	BB::OS_ASYNC_READ_STATUS status;
+	while ((status = BB::OSPollAsyncRead(poll_read)) == BB::OS_ASYNC_READ_STATUS::PENDING) {}
+	ASSERT_EQ(status, BB::OS_ASYNC_READ_STATUS::DONE);
+	ASSERT_EQ(memcmp(data, first_block, READ_SIZE), 0);
+
+	//Asking for more then the file has gives a short read that is still done.
+	uint32_t last_blocks[2 * READ_SIZE / sizeof(uint32_t)]{};
+	BB::OSAsyncReadInfo short_info{ test_file, (READ_COUNT - 1) * READ_SIZE, last_blocks, sizeof(last_blocks) };
+	BB::OSAsyncRead short_read;
+	ASSERT_TRUE(BB::OSSubmitAsyncReads(&short_info, 1, &short_read));
+	size_t short_bytes_read = 0;
+	ASSERT_EQ(BB::OSWaitAsyncRead(short_read, &short_bytes_read), BB::OS_ASYNC_READ_STATUS::DONE);
+	ASSERT_EQ(short_bytes_read, READ_SIZE);
+	ASSERT_EQ(memcmp(BB::Pointer::Add(data, short_info.file_offset), last_blocks, READ_SIZE), 0);
+
+	//A cancelled read can still finish, but it always finishes and gives the slot back.
+	BB::OSAsyncRead cancel_read;
+	ASSERT_TRUE(BB::OSSubmitAsyncReads(&poll_info, 1, &cancel_read));
+	BB::OSCancelAsyncRead(cancel_read);
+	status = BB::OSWaitAsyncRead(cancel_read);
+	ASSERT_TRUE(status == BB::OS_ASYNC_READ_STATUS::DONE || status == BB::OS_ASYNC_READ_STATUS::CANCELLED);
+
+	BB::CloseOSFile(test_file);
+}
+
+TEST(Program_IO, Map_File)
+{
+	constexpr const char* DOC_NAME = "READWRITETEST_MAP.txt";
+	constexpr const char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for file read and writing.";
+	const size_t doc_size = strlen(DOC_DATA);
+
+	BB::OSFileHandle test_file = BB::OSCreateFile(DOC_NAME);
+	BB::OSWriteFile(test_file, DOC_DATA, doc_size);
+	BB::CloseOSFile(test_file);
+
+	const BB::OSMappedFile mapped_file = BB::OSMapFile(DOC_NAME, BB::OS_MAP_HINT::SEQUENTIAL);
+	ASSERT_TRUE(mapped_file.IsValid());
+	ASSERT_EQ(mapped_file.size, doc_size);
+	ASSERT_EQ(memcmp(mapped_file.data, DOC_DATA, doc_size), 0);
+	BB::OSUnmapFile(mapped_file);
+
+	ASSERT_FALSE(BB::OSMapFile("READWRITETEST_DOES_NOT_EXIST.txt").IsValid());
+}
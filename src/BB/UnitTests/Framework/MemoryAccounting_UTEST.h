@@ -0,0 +1,189 @@
+#pragma once
+#include "../TestValues.h"
+#include "Allocators/MemoryAccounting.hpp"
+#include "Allocators/MemoryArena.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// the accounting is global, every test uses its own owner so it only sees its own sites.
+
+TEST(MemoryAccounting, sites_and_counters)
+{
+	const int owner = 0;
+	const uint32_t site_a = BB::MemoryAccountingGetSiteIndex(BB::MemoryAccountingSite{ &owner, "tag a", __FILE__, __LINE__ });
+	const uint32_t site_b = BB::MemoryAccountingGetSiteIndex(BB::MemoryAccountingSite{ &owner, "tag b", __FILE__, __LINE__ });
+	ASSERT_NE(site_a, site_b);
+	ASSERT_NE(site_a, BB::MEMORY_ACCOUNTING_OVERFLOW_SITE);
+	EXPECT_STREQ(BB::MemoryAccountingGetSite(site_b).tag_name, "tag b");
+	// the same site gives the same index.
+	EXPECT_EQ(BB::MemoryAccountingGetSiteIndex(BB::MemoryAccountingGetSite(site_a)), site_a);
+
+	BB::MemoryAccountingAlloc(site_a, 100);
+	BB::MemoryAccountingAlloc(site_a, 50);
+	BB::MemoryAccountingResize(site_a, 50, 80);
+	BB::MemoryAccountingMove(site_a, site_b, 80);
+
+	// freed on another thread then it was allocated on.
+	std::thread([&]() { BB::MemoryAccountingFree(site_b, 80); }).join();
+
+	BB::MemoryAccountingSnapshot* snapshot = new BB::MemoryAccountingSnapshot;
+	BB::MemoryAccountingTakeSnapshot(*snapshot);
+	ASSERT_GT(snapshot->site_count, site_b);
+
+	// the move only changes the current counters, the totals stay with the site that allocated.
+	const BB::MemoryAccountingCounters& a = snapshot->sites[site_a];
+	EXPECT_EQ(a.current_bytes, 100);
+	EXPECT_EQ(a.current_count, 1);
+	EXPECT_EQ(a.total_bytes, 180u);
+	EXPECT_EQ(a.total_count, 2u);
+
+	const BB::MemoryAccountingCounters& b = snapshot->sites[site_b];
+	EXPECT_EQ(b.current_bytes, 0);
+	EXPECT_EQ(b.current_count, 0);
+	EXPECT_EQ(b.total_bytes, 0u);
+	EXPECT_EQ(b.total_count, 0u);
+
+	BB::MemoryAccountingFree(site_a, 100);
+	delete snapshot;
+}
+
+// threads count on the same sites while another takes snapshots, in the end everything adds up exactly.
+TEST(MemoryAccounting, concurrent_counting)
+{
+	constexpr uint32_t thread_count = 8;
+	constexpr uint32_t site_count = 16;
+	constexpr uint32_t iterations = 100000;
+
+	const int owner = 0;
+	uint32_t sites[site_count];
+	for (uint32_t i = 0; i < site_count; i++)
+		sites[i] = BB::MemoryAccountingGetSiteIndex(BB::MemoryAccountingSite{ &owner, nullptr, __FILE__, static_cast<int>(i) });
+
+	BB::MemoryAccountingSnapshot* snapshot = new BB::MemoryAccountingSnapshot;
+	std::atomic<bool> done{ false };
+	std::thread reader([&]()
+	{
+		while (!done.load(std::memory_order_relaxed))
+			BB::MemoryAccountingTakeSnapshot(*snapshot);
+	});
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < thread_count; t++)
+		threads.emplace_back([&, t]()
+		{
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				const uint32_t site = sites[(i + t) % site_count];
+				BB::MemoryAccountingAlloc(site, 32);
+				// every second allocation stays alive.
+				if (i & 1)
+					BB::MemoryAccountingFree(site, 32);
+			}
+		});
+	for (std::thread& thread : threads)
+		thread.join();
+	done.store(true, std::memory_order_relaxed);
+	reader.join();
+
+	BB::MemoryAccountingTakeSnapshot(*snapshot);
+	int64_t current_bytes = 0;
+	uint64_t total_count = 0;
+	for (uint32_t i = 0; i < site_count; i++)
+	{
+		current_bytes += snapshot->sites[sites[i]].current_bytes;
+		total_count += snapshot->sites[sites[i]].total_count;
+	}
+	EXPECT_EQ(current_bytes, int64_t(thread_count) * iterations / 2 * 32);
+	EXPECT_EQ(total_count, uint64_t(thread_count) * iterations);
+	delete snapshot;
+}
+
+#ifdef _DEBUG_MEMORY
+static BB::MemoryAccountingCounters ArenaAccounting(const BB::MemoryArena& a_arena, const char* a_tag_name)
+{
+	BB::MemoryAccountingSnapshot* snapshot = new BB::MemoryAccountingSnapshot;
+	BB::MemoryAccountingTakeSnapshot(*snapshot);
+	BB::MemoryAccountingCounters sum{};
+	for (uint32_t i = 0; i < snapshot->site_count; i++)
+	{
+		const BB::MemoryAccountingSite& site = BB::MemoryAccountingGetSite(i);
+		if (site.owner != a_arena.accounting_owner || site.tag_name != a_tag_name)
+			continue;
+		sum.current_bytes += snapshot->sites[i].current_bytes;
+		sum.current_count += snapshot->sites[i].current_count;
+		sum.total_bytes += snapshot->sites[i].total_bytes;
+		sum.total_count += snapshot->sites[i].total_count;
+	}
+	delete snapshot;
+	return sum;
+}
+
+TEST(MemoryAccounting, memory_arena_allocations)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	const char* tag = "accounting test tag";
+
+	void* first = ArenaAlloc(arena, 128, 8);
+	const BB::MemoryArenaMarker marker = BB::MemoryArenaGetMemoryMarker(arena);
+	void* tagged = ArenaAlloc(arena, 256, 8);
+	BB::TagMemory(arena, tagged, tag);
+	tagged = ArenaRealloc(arena, tagged, 256, 512, 8);
+	(void)first;
+
+	BB::MemoryAccountingCounters untagged_counters = ArenaAccounting(arena, nullptr);
+	BB::MemoryAccountingCounters tagged_counters = ArenaAccounting(arena, tag);
+	EXPECT_EQ(untagged_counters.current_bytes, 128);
+	EXPECT_EQ(untagged_counters.current_count, 1);
+	EXPECT_EQ(tagged_counters.current_bytes, 512);
+	EXPECT_EQ(tagged_counters.current_count, 1);
+
+	// going back to a marker frees what came after it.
+	BB::MemoryArenaSetMemoryMarker(arena, marker);
+	tagged_counters = ArenaAccounting(arena, tag);
+	EXPECT_EQ(tagged_counters.current_bytes, 0);
+	// the 256 bytes from before the tag count in the total of the untagged site, only the growth after it here.
+	EXPECT_EQ(tagged_counters.total_bytes, 256u);
+	EXPECT_EQ(ArenaAccounting(arena, nullptr).current_bytes, 128);
+
+	BB::MemoryArenaReset(arena);
+	untagged_counters = ArenaAccounting(arena, nullptr);
+	EXPECT_EQ(untagged_counters.current_bytes, 0);
+	EXPECT_EQ(untagged_counters.current_count, 0);
+
+	// freeing the arena frees everything still in it.
+	ArenaAlloc(arena, 64, 8);
+	const BB::MemoryArena freed_arena = arena;
+	BB::MemoryArenaFree(arena);
+	EXPECT_EQ(ArenaAccounting(freed_arena, nullptr).current_bytes, 0);
+}
+
+// arenas that live for a moment, like a json parse, keep using the same sites instead of filling the table.
+TEST(MemoryAccounting, short_lived_arenas_reuse_sites)
+{
+	// alive at the same time, so every arena has a buffer of its own.
+	std::vector<BB::MemoryArena> arenas(BB::MEMORY_ACCOUNTING_MAX_SITES * 2);
+	for (BB::MemoryArena& arena : arenas)
+	{
+		arena = BB::MemoryArenaCreate(BB::ARENA_DEFAULT_COMMIT);
+		ArenaAlloc(arena, 64, 8);
+	}
+
+	BB::MemoryAccountingSnapshot* snapshot = new BB::MemoryAccountingSnapshot;
+	BB::MemoryAccountingTakeSnapshot(*snapshot);
+	uint32_t arena_sites = 0;
+	for (uint32_t i = 0; i < snapshot->site_count; i++)
+	{
+		if (BB::MemoryAccountingGetSite(i).owner != arenas.front().accounting_owner)
+			continue;
+		++arena_sites;
+		EXPECT_EQ(snapshot->sites[i].current_count, static_cast<int64_t>(arenas.size()));
+	}
+	EXPECT_EQ(arena_sites, 1u);
+
+	for (BB::MemoryArena& arena : arenas)
+		BB::MemoryArenaFree(arena);
+	delete snapshot;
+}
+#endif // _DEBUG_MEMORY
@@ -2,6 +2,9 @@
 #include "../TestValues.h"
 #include "BBMemory.h"
 
+#include <chrono>
+#include <cstdio>
+
 TEST(MemoryTesting, Create_Memory_Leak_and_tag)
 {
 	constexpr size_t allocatorSize = 1028;
@@ -12,4 +15,106 @@ TEST(MemoryTesting, Create_Memory_Leak_and_tag)
 	void* ptr = BBalloc(t_LinearAllocator, allocationSize);
 	BB::BBTagAlloc(ptr, "memory leak tag");
 	//Leak will accur.
-}
\ No newline at end of file
+}
+
+TEST(MemoryArena, Stats_High_Water_Mark_And_Commits)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+
+	ArenaAlloc(arena, BB::ARENA_DEFAULT_COMMIT * 3, 8);
+	const BB::MemoryArenaStats& stats = BB::MemoryArenaGetStats(arena);
+	const size_t high_water_mark = stats.high_water_mark;
+	ASSERT_GE(high_water_mark, BB::ARENA_DEFAULT_COMMIT * 3);
+	ASSERT_GE(stats.commit_count, 1u);
+	ASSERT_EQ(stats.allocation_count, 1u);
+
+	//The mark stays after a reset, the per frame count moves over.
+	BB::MemoryArenaStatsNextFrame(arena);
+	BB::MemoryArenaReset(arena);
+	ArenaAlloc(arena, 64, 8);
+	ArenaAlloc(arena, 64, 8);
+	ASSERT_EQ(stats.high_water_mark, high_water_mark);
+	ASSERT_EQ(stats.allocations_last_frame, 1u);
+	ASSERT_EQ(stats.allocation_count, 2u);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(MemoryArena, Commit_Growth_And_Decay)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate(BB::ARENA_DEFAULT_RESERVE, true);
+	const BB::MemoryArenaStats& stats = BB::MemoryArenaGetStats(arena);
+
+	//A big load in small pieces, in 16 kb steps this would be thousands of commits.
+	constexpr size_t LOAD_SIZE = BB::mbSize * 64;
+	constexpr size_t PIECE_SIZE = BB::kbSize * 64;
+	for (size_t i = 0; i < LOAD_SIZE / PIECE_SIZE; i++)
+		ArenaAllocNoZero(arena, PIECE_SIZE, 16);
+	ASSERT_LT(stats.commit_count, 24u);
+	ASSERT_GE(BB::MemoryArenaSizeCommited(arena), LOAD_SIZE);
+
+	//The spike is inside the first window, the second window only sees small resets and gives the rest back.
+	for (uint32_t i = 0; i < BB::ARENA_DECAY_RESET_COUNT * 2; i++)
+	{
+		BB::MemoryArenaReset(arena);
+		ArenaAlloc(arena, PIECE_SIZE, 16);
+	}
+	ASSERT_GE(stats.decommit_count, 1u);
+	ASSERT_LT(BB::MemoryArenaSizeCommited(arena), BB::mbSize);
+
+	//Decommitted memory comes back zeroed when it is needed again.
+	BB::MemoryArenaReset(arena);
+	unsigned char* memory = reinterpret_cast<unsigned char*>(ArenaAllocNoZero(arena, BB::mbSize * 4, 16));
+	ASSERT_EQ(memory[BB::mbSize * 4 - 1], 0);
+
+	BB::MemoryArenaFree(arena);
+}
+
+//Not a pass or fail, build once with DEBUG_MEMORY_ENABLE on and once off to compare.
+TEST(MemoryArena, Benchmark_Frame_And_Thread_Arena)
+{
+	constexpr uint32_t FRAME_COUNT = 64;
+	constexpr uint32_t ALLOCATIONS_PER_FRAME = 8192;
+	constexpr uint32_t TASK_COUNT = 8192;
+	constexpr uint32_t ALLOCATIONS_PER_TASK = 64;
+
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+
+	//Like the ecs frame arena, lots of small allocations and one reset per frame.
+	const auto frame_begin = std::chrono::steady_clock::now();
+	for (uint32_t frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		for (uint32_t i = 0; i < ALLOCATIONS_PER_FRAME; i++)
+			ArenaAllocNoZero(arena, 16 + (i % 16) * 16, 16);
+		BB::MemoryArenaStatsNextFrame(arena);
+		BB::MemoryArenaReset(arena);
+	}
+	const double frame_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - frame_begin).count();
+	ASSERT_EQ(BB::MemoryArenaGetStats(arena).allocations_last_frame, ALLOCATIONS_PER_FRAME);
+
+	//Like the thread scheduler arena, a scope per task that goes back to the marker.
+	const auto thread_begin = std::chrono::steady_clock::now();
+	for (uint32_t task = 0; task < TASK_COUNT; task++)
+	{
+		MemoryArenaScope(arena)
+		{
+			for (uint32_t i = 0; i < ALLOCATIONS_PER_TASK; i++)
+				ArenaAlloc(arena, 32, 8);
+		}
+	}
+	const double thread_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - thread_begin).count();
+
+	BB::MemoryArenaFree(arena);
+
+#ifdef _DEBUG_MEMORY
+	constexpr const char* MODE = "with allocation tracking";
+#else
+	constexpr const char* MODE = "without allocation tracking";
+#endif // _DEBUG_MEMORY
+	char message[196];
+	snprintf(message, sizeof(message), "memory arena %s, frame arena: %.2fns per allocation, thread arena: %.2fns per allocation",
+		MODE,
+		frame_ns / (FRAME_COUNT * ALLOCATIONS_PER_FRAME),
+		thread_ns / (TASK_COUNT * ALLOCATIONS_PER_TASK));
+	BB_LOG(message);
+}
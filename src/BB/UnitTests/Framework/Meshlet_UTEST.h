@@ -0,0 +1,160 @@
+#pragma once
+#include "../TestValues.h"
+#include "Meshlet.hpp"
+#include "Math/Math.inl"
+
+#include <algorithm>
+
+// a flat grid on the xy plane at z = 0, a_flip turns the triangles to face -z instead of +z.
+static void CreateMeshletTestGrid(BB::MemoryArena& a_arena, const uint32_t a_quads, const bool a_flip, BB::ConstSlice<BB::float3>& a_positions, BB::Slice<uint32_t>& a_indices)
+{
+	const uint32_t vertices_per_row = a_quads + 1;
+	BB::float3* positions = ArenaAllocArr(a_arena, BB::float3, vertices_per_row * vertices_per_row);
+	for (uint32_t y = 0; y < vertices_per_row; y++)
+		for (uint32_t x = 0; x < vertices_per_row; x++)
+			positions[y * vertices_per_row + x] = BB::float3(static_cast<float>(x) / a_quads - 0.5f, static_cast<float>(y) / a_quads - 0.5f, 0.f);
+
+	uint32_t* indices = ArenaAllocArr(a_arena, uint32_t, a_quads * a_quads * 6);
+	uint32_t index = 0;
+	for (uint32_t y = 0; y < a_quads; y++)
+		for (uint32_t x = 0; x < a_quads; x++)
+		{
+			const uint32_t i0 = y * vertices_per_row + x;
+			const uint32_t i1 = i0 + 1;
+			const uint32_t i2 = i0 + vertices_per_row;
+			const uint32_t i3 = i2 + 1;
+			const uint32_t quad[6] = { i0, i1, i3, i0, i3, i2 };
+			for (uint32_t i = 0; i < 6; i++)
+				indices[index++] = quad[a_flip ? 5 - i : i];
+		}
+
+	a_positions = BB::ConstSlice<BB::float3>(positions, vertices_per_row * vertices_per_row);
+	a_indices = BB::Slice<uint32_t>(indices, a_quads * a_quads * 6);
+}
+
+static uint64_t MeshletTriangleKey(const uint32_t* a_triangle)
+{
+	// rotate so the smallest index is first, this keeps the winding.
+	uint32_t start = 0;
+	if (a_triangle[1] < a_triangle[start])
+		start = 1;
+	if (a_triangle[2] < a_triangle[start])
+		start = 2;
+	const uint64_t a = a_triangle[start];
+	const uint64_t b = a_triangle[(start + 1) % 3];
+	const uint64_t c = a_triangle[(start + 2) % 3];
+	return (a << 42) | (b << 21) | c;
+}
+
+TEST(Meshlet, build_limits_and_triangles)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::ConstSlice<BB::float3> positions;
+	BB::Slice<uint32_t> indices;
+	CreateMeshletTestGrid(arena, 48, false, positions, indices);
+
+	const uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+	uint64_t* original_triangles = ArenaAllocArr(arena, uint64_t, triangle_count);
+	for (uint32_t i = 0; i < triangle_count; i++)
+		original_triangles[i] = MeshletTriangleKey(&indices[i * 3]);
+
+	const BB::Slice<BB::Meshlet> meshlets = BB::BuildMeshlets(arena, positions, indices, true);
+	ASSERT_GT(meshlets.size(), 1u);
+
+	uint32_t index_start = 0;
+	for (size_t i = 0; i < meshlets.size(); i++)
+	{
+		const BB::Meshlet& meshlet = meshlets[i];
+		// the meshlets cover the index buffer in order without gaps.
+		ASSERT_EQ(meshlet.index_start, index_start);
+		ASSERT_EQ(meshlet.index_count % 3, 0u);
+		ASSERT_LE(meshlet.index_count / 3, BB::MESHLET_MAX_TRIANGLES);
+		index_start += meshlet.index_count;
+
+		uint32_t unique_vertices[BB::MESHLET_MAX_VERTICES * 3];
+		uint32_t unique_count = 0;
+		for (uint32_t j = 0; j < meshlet.index_count; j++)
+		{
+			const uint32_t vertex = indices[meshlet.index_start + j];
+			bool found = false;
+			for (uint32_t k = 0; k < unique_count; k++)
+				found |= unique_vertices[k] == vertex;
+			if (!found)
+				unique_vertices[unique_count++] = vertex;
+
+			// every vertex sits inside the bounding sphere.
+			const BB::float3 offset = positions[vertex] - meshlet.center;
+			EXPECT_LE(BB::Float3Length(offset), meshlet.radius + 0.0001f);
+		}
+		ASSERT_LE(unique_count, BB::MESHLET_MAX_VERTICES);
+
+		// a flat grid facing +z has a tight cone.
+		EXPECT_LT(meshlet.cone_cutoff, 0.1f);
+		EXPECT_NEAR(meshlet.cone_axis.z, 1.f, 0.0001f);
+	}
+	EXPECT_EQ(index_start, indices.size());
+
+	// the reorder keeps every triangle and its winding.
+	uint64_t* new_triangles = ArenaAllocArr(arena, uint64_t, triangle_count);
+	for (uint32_t i = 0; i < triangle_count; i++)
+		new_triangles[i] = MeshletTriangleKey(&indices[i * 3]);
+	std::sort(original_triangles, original_triangles + triangle_count);
+	std::sort(new_triangles, new_triangles + triangle_count);
+	for (uint32_t i = 0; i < triangle_count; i++)
+		ASSERT_EQ(original_triangles[i], new_triangles[i]);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(Meshlet, cull_frustum_and_backfaces)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::ConstSlice<BB::float3> positions;
+	BB::Slice<uint32_t> front_indices;
+	BB::Slice<uint32_t> back_indices;
+	CreateMeshletTestGrid(arena, 32, false, positions, front_indices);
+	CreateMeshletTestGrid(arena, 32, true, positions, back_indices);
+
+	const BB::Slice<BB::Meshlet> front_meshlets = BB::BuildMeshlets(arena, positions, front_indices, true);
+	const BB::Slice<BB::Meshlet> back_meshlets = BB::BuildMeshlets(arena, positions, back_indices, true);
+	const BB::Slice<BB::Meshlet> double_sided_meshlets = BB::BuildMeshlets(arena, positions, back_indices, false);
+	const BB::ConstSlice<BB::Meshlet> front(front_meshlets.data(), front_meshlets.size());
+	const BB::ConstSlice<BB::Meshlet> back(back_meshlets.data(), back_meshlets.size());
+	const BB::ConstSlice<BB::Meshlet> double_sided(double_sided_meshlets.data(), double_sided_meshlets.size());
+
+	// the camera looks down -z at the grid.
+	const BB::float3 eye = BB::float3(0.f, 0.f, 3.f);
+	const BB::float4x4 view = BB::Float4x4Lookat(eye, BB::float3(0.f), BB::float3(0.f, 1.f, 0.f));
+	const BB::float4x4 projection = BB::Float4x4Perspective(BB::ToRadians(60.f), 1.f, 0.1f, 100.f);
+	const BB::MeshletCullView cull_view = BB::CreateMeshletCullView(view, projection, eye);
+	const BB::float4x4 identity = BB::Float4x4Identity();
+
+	BB::MeshletDrawRange* ranges = ArenaAllocArr(arena, BB::MeshletDrawRange, front.size());
+
+	// everything is visible and in order, so it merges into a single draw.
+	uint32_t range_count = BB::CullMeshlets(front, identity, cull_view, ranges);
+	ASSERT_EQ(range_count, 1u);
+	EXPECT_EQ(ranges[0].index_start, 0u);
+	EXPECT_EQ(ranges[0].index_count, front_indices.size());
+
+	EXPECT_EQ(BB::CullMeshlets(back, identity, cull_view, ranges), 0u) << "back facing meshlets were not culled";
+	EXPECT_EQ(BB::CullMeshlets(double_sided, identity, cull_view, ranges), 1u) << "double sided meshlets were culled";
+
+	// move the grid behind the camera and far to the side.
+	EXPECT_EQ(BB::CullMeshlets(front, BB::Float4x4FromTranslation(BB::float3(0.f, 0.f, 10.f)), cull_view, ranges), 0u);
+	EXPECT_EQ(BB::CullMeshlets(front, BB::Float4x4FromTranslation(BB::float3(50.f, 0.f, 0.f)), cull_view, ranges), 0u);
+
+	// a mirrored transform turns the back faces towards the camera, those can not be cone culled.
+	const BB::float4x4 mirrored = BB::Float4x4Scale(identity, BB::float3(-1.f, 1.f, 1.f));
+	EXPECT_GT(BB::CullMeshlets(back, mirrored, cull_view, ranges), 0u);
+
+	// half the grid outside the frustum gives partial ranges.
+	range_count = BB::CullMeshlets(front, BB::Float4x4FromTranslation(BB::float3(2.1f, 0.f, 0.f)), cull_view, ranges);
+	uint32_t visible_indices = 0;
+	for (uint32_t i = 0; i < range_count; i++)
+		visible_indices += ranges[i].index_count;
+	EXPECT_GT(visible_indices, 0u);
+	EXPECT_LT(visible_indices, front_indices.size());
+
+	BB::MemoryArenaFree(arena);
+}
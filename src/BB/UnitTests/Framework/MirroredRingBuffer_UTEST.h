@@ -0,0 +1,152 @@
+#pragma once
+#include "../TestValues.h"
+#include "Storage/MirroredRingBuffer.hpp"
+#include "Allocators/RingAllocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+TEST(MirroredRingBuffer, memory_is_mirrored)
+{
+	size_t size = 1;
+	uint8_t* memory = reinterpret_cast<uint8_t*>(BB::OSCreateMirroredMemory(size));
+	ASSERT_NE(memory, nullptr);
+	ASSERT_GE(size, 1u);
+
+	// written through the second half, read through the first and the other way around.
+	for (size_t i = 0; i < size; i += 61)
+		memory[size + i] = static_cast<uint8_t>(i);
+	for (size_t i = 0; i < size; i += 61)
+		ASSERT_EQ(memory[i], static_cast<uint8_t>(i));
+
+	const char message[] = "this crosses the end of the buffer";
+	memcpy(memory + size - 10, message, sizeof(message));
+	EXPECT_EQ(memcmp(memory + size - 10, message, sizeof(message)), 0);
+	EXPECT_EQ(memcmp(memory, message + 10, sizeof(message) - 10), 0);
+
+	EXPECT_TRUE(BB::OSFreeMirroredMemory(memory, size));
+}
+
+TEST(MirroredRingBuffer, write_across_the_end)
+{
+	BB::MirroredRingBuffer ring;
+	ASSERT_TRUE(ring.Init(1000));
+	const size_t capacity = ring.Capacity();
+	ASSERT_GE(capacity, 1000u);
+	ASSERT_EQ(capacity & (capacity - 1), 0u);
+
+	// move the read and write position close to the end.
+	void* dst = ring.BeginWrite(capacity - 16);
+	ASSERT_NE(dst, nullptr);
+	ring.EndWrite(capacity - 16);
+	EXPECT_EQ(ring.BeginWrite(17), nullptr) << "the ring is too full for this";
+	size_t read_size;
+	ring.BeginRead(read_size);
+	EXPECT_EQ(read_size, capacity - 16);
+	ring.EndRead(read_size);
+	EXPECT_EQ(ring.Size(), 0u);
+
+	uint32_t values[64];
+	for (uint32_t i = 0; i < _countof(values); i++)
+		values[i] = i * 7;
+	ASSERT_TRUE(ring.Write(values, sizeof(values)));
+
+	// one range, no matter that it wrapped.
+	const uint32_t* read = reinterpret_cast<const uint32_t*>(ring.BeginRead(read_size));
+	ASSERT_EQ(read_size, sizeof(values));
+	for (uint32_t i = 0; i < _countof(values); i++)
+		EXPECT_EQ(read[i], i * 7);
+	ring.EndRead(read_size);
+
+	// the whole capacity fits in one write.
+	EXPECT_NE(ring.BeginWrite(capacity), nullptr);
+
+	ring.Destroy();
+}
+
+// a producer sends messages of different sizes to a consumer thread, every message is checked in order.
+TEST(MirroredRingBuffer, producer_consumer_stream)
+{
+	constexpr uint32_t message_count = 500000;
+
+	BB::MirroredRingBuffer ring;
+	ASSERT_TRUE(ring.Init(64 * kbSize));
+
+	std::atomic<uint32_t> bad_messages{ 0 };
+	const auto begin = std::chrono::steady_clock::now();
+	std::thread consumer([&]()
+	{
+		uint32_t expected = 0;
+		while (expected < message_count)
+		{
+			size_t size;
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(ring.BeginRead(size));
+			size_t read = 0;
+			while (read + sizeof(uint32_t) * 2 <= size)
+			{
+				uint32_t header[2];
+				memcpy(header, data + read, sizeof(header));
+				if (read + sizeof(header) + header[1] > size)
+					break;
+				if (header[0] != expected || header[1] != (expected * 13) % 200)
+					bad_messages.fetch_add(1, std::memory_order_relaxed);
+				for (uint32_t i = 0; i < header[1]; i++)
+					if (data[read + sizeof(header) + i] != static_cast<uint8_t>(expected))
+					{
+						bad_messages.fetch_add(1, std::memory_order_relaxed);
+						break;
+					}
+				read += sizeof(header) + header[1];
+				expected++;
+			}
+			if (read == 0)
+				std::this_thread::yield();
+			ring.EndRead(read);
+		}
+	});
+
+	for (uint32_t i = 0; i < message_count; i++)
+	{
+		const uint32_t header[2] = { i, (i * 13) % 200 };
+		const size_t size = sizeof(header) + header[1];
+		uint8_t* dst;
+		while ((dst = reinterpret_cast<uint8_t*>(ring.BeginWrite(size))) == nullptr)
+			std::this_thread::yield();
+		memcpy(dst, header, sizeof(header));
+		memset(dst + sizeof(header), static_cast<uint8_t>(i), header[1]);
+		ring.EndWrite(size);
+	}
+	consumer.join();
+	const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	EXPECT_EQ(bad_messages.load(), 0u);
+	EXPECT_EQ(ring.Size(), 0u);
+
+	char message[128];
+	snprintf(message, sizeof(message), "%u messages through a %zu byte mirrored ring: %.2fms", message_count, ring.Capacity(), time);
+	BB_LOG(message);
+
+	ring.Destroy();
+}
+
+TEST(MirroredRingBuffer, local_ring_allocator_does_not_skip_the_end)
+{
+	size_t size = 1;
+	BB::LocalRingAllocator ring(size);
+	ASSERT_GE(size, 1u);
+
+	uint8_t* first = reinterpret_cast<uint8_t*>(ring.Alloc(size - 8, 1));
+	ASSERT_NE(first, nullptr);
+
+	// only 8 bytes left before the end, the allocation continues in the mirror instead of going back to the start.
+	uint8_t* crossing = reinterpret_cast<uint8_t*>(ring.Alloc(32, 1));
+	EXPECT_EQ(crossing, first + size - 8);
+	memset(crossing, 0xAB, 32);
+	EXPECT_EQ(first[0], 0xAB) << "the part past the end should land at the start of the buffer";
+	EXPECT_EQ(first[23], 0xAB);
+
+	uint8_t* after = reinterpret_cast<uint8_t*>(ring.Alloc(16, 16));
+	EXPECT_EQ(after, first + 32);
+}
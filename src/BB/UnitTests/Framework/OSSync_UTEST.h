@@ -0,0 +1,241 @@
+#pragma once
+#include "../TestValues.h"
+#include "Program.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+// the standard library ones are the pthread primitives on linux and the same SRW locks on windows.
+constexpr uint32_t OS_SYNC_THREAD_COUNT = 4;
+constexpr uint32_t OS_SYNC_ITERATIONS = 50000;
+
+template<typename Func>
+static double RunContended(const uint32_t a_thread_count, Func a_func)
+{
+	std::thread threads[OS_SYNC_THREAD_COUNT * 2];
+	std::atomic<bool> start{ false };
+	for (uint32_t i = 0; i < a_thread_count; i++)
+		threads[i] = std::thread([&start, &a_func, i]()
+		{
+			while (!start.load(std::memory_order_acquire))
+				std::this_thread::yield();
+			a_func(i);
+		});
+
+	const auto begin = std::chrono::steady_clock::now();
+	start.store(true, std::memory_order_release);
+	for (uint32_t i = 0; i < a_thread_count; i++)
+		threads[i].join();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+TEST(OSSync, mutex_contended_counter)
+{
+	BB::BBMutex mutex = BB::OSCreateMutex();
+	uint64_t counter = 0;
+	RunContended(OS_SYNC_THREAD_COUNT, [&](uint32_t)
+	{
+		for (uint32_t i = 0; i < OS_SYNC_ITERATIONS; i++)
+		{
+			BB::OSWaitAndLockMutex(mutex);
+			++counter;
+			BB::OSUnlockMutex(mutex);
+		}
+	});
+	EXPECT_EQ(counter, static_cast<uint64_t>(OS_SYNC_THREAD_COUNT) * OS_SYNC_ITERATIONS);
+	BB::OSDestroyMutex(mutex);
+}
+
+TEST(OSSync, rwlock_readers_never_see_a_half_write)
+{
+	BB::BBRWLock lock = BB::OSCreateRWLock();
+	// writers keep both equal, a reader that sees them differ got in during a write.
+	uint64_t first = 0;
+	uint64_t second = 0;
+	std::atomic<uint32_t> torn_reads{ 0 };
+
+	RunContended(OS_SYNC_THREAD_COUNT * 2, [&](uint32_t a_thread)
+	{
+		for (uint32_t i = 0; i < OS_SYNC_ITERATIONS / 4; i++)
+		{
+			if (a_thread % 2 == 0)
+			{
+				BB::OSAcquireSRWLockWrite(&lock);
+				++first;
+				++second;
+				BB::OSReleaseSRWLockWrite(&lock);
+			}
+			else
+			{
+				BB::OSAcquireSRWLockRead(&lock);
+				if (first != second)
+					torn_reads.fetch_add(1, std::memory_order_relaxed);
+				BB::OSReleaseSRWLockRead(&lock);
+			}
+		}
+	});
+
+	EXPECT_EQ(torn_reads.load(), 0u);
+	EXPECT_EQ(first, static_cast<uint64_t>(OS_SYNC_THREAD_COUNT) * (OS_SYNC_ITERATIONS / 4));
+	EXPECT_EQ(first, second);
+	// the lock is free again after all that, none of these can block.
+	BB::OSAcquireSRWLockWrite(&lock);
+	BB::OSReleaseSRWLockWrite(&lock);
+	BB::OSAcquireSRWLockRead(&lock);
+	BB::OSAcquireSRWLockRead(&lock);
+	BB::OSReleaseSRWLockRead(&lock);
+	BB::OSReleaseSRWLockRead(&lock);
+}
+
+TEST(OSSync, semaphore_hands_out_every_signal_once)
+{
+	BB::BBSemaphore semaphore = BB::OSCreateSemaphore(0, OS_SYNC_ITERATIONS);
+	std::atomic<uint32_t> consumed{ 0 };
+	constexpr uint32_t CONSUMER_COUNT = OS_SYNC_THREAD_COUNT - 1;
+	constexpr uint32_t PER_CONSUMER = 2000;
+
+	RunContended(OS_SYNC_THREAD_COUNT, [&](uint32_t a_thread)
+	{
+		if (a_thread == 0)
+		{
+			for (uint32_t i = 0; i < CONSUMER_COUNT * PER_CONSUMER; i += 4)
+				EXPECT_TRUE(BB::OSSignalSemaphore(semaphore, 4));
+		}
+		else
+		{
+			for (uint32_t i = 0; i < PER_CONSUMER; i++)
+			{
+				BB::OSWaitSemaphore(semaphore);
+				consumed.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	});
+	EXPECT_EQ(consumed.load(), CONSUMER_COUNT * PER_CONSUMER);
+
+	// going over the maximum fails and changes nothing.
+	BB::BBSemaphore binary = BB::OSCreateSemaphore(1, 1);
+	EXPECT_FALSE(BB::OSSignalSemaphore(binary, 1));
+	BB::OSWaitSemaphore(binary);
+	EXPECT_TRUE(BB::OSSignalSemaphore(binary, 1));
+
+	BB::OSDestroySemaphore(binary);
+	BB::OSDestroySemaphore(semaphore);
+}
+
+TEST(OSSync, condition_variable_wakes_a_waiter)
+{
+	BB::BBRWLock lock = BB::OSCreateRWLock();
+	BB::BBConditionalVariable condition = BB::OSCreateConditionalVariable();
+	uint32_t produced = 0;
+	uint32_t consumed = 0;
+	constexpr uint32_t ROUNDS = 2000;
+
+	RunContended(2, [&](uint32_t a_thread)
+	{
+		for (uint32_t i = 0; i < ROUNDS; i++)
+		{
+			BB::OSAcquireSRWLockWrite(&lock);
+			if (a_thread == 0)
+			{
+				// waits until the last one is taken, so every round has one waiter and one waker.
+				while (produced != consumed)
+					BB::OSWaitConditionalVariableExclusive(&condition, &lock);
+				++produced;
+			}
+			else
+			{
+				while (produced == consumed)
+					BB::OSWaitConditionalVariableExclusive(&condition, &lock);
+				++consumed;
+			}
+			BB::OSWakeConditionVariable(&condition);
+			BB::OSReleaseSRWLockWrite(&lock);
+		}
+	});
+	EXPECT_EQ(produced, ROUNDS);
+	EXPECT_EQ(consumed, ROUNDS);
+}
+
+// not a pass or fail, it logs the time of the same contended loop on the framework and the standard primitives.
+TEST(OSSync, benchmark_against_std_primitives)
+{
+	constexpr uint32_t ITERATIONS = OS_SYNC_ITERATIONS * 2;
+	uint64_t counter = 0;
+
+	BB::BBMutex os_mutex = BB::OSCreateMutex();
+	const double os_mutex_time = RunContended(OS_SYNC_THREAD_COUNT, [&](uint32_t)
+	{
+		for (uint32_t i = 0; i < ITERATIONS; i++)
+		{
+			BB::OSWaitAndLockMutex(os_mutex);
+			++counter;
+			BB::OSUnlockMutex(os_mutex);
+		}
+	});
+	BB::OSDestroyMutex(os_mutex);
+
+	std::mutex std_mutex;
+	const double std_mutex_time = RunContended(OS_SYNC_THREAD_COUNT, [&](uint32_t)
+	{
+		for (uint32_t i = 0; i < ITERATIONS; i++)
+		{
+			std_mutex.lock();
+			++counter;
+			std_mutex.unlock();
+		}
+	});
+
+	// 1 writer for every 3 readers, about what the job system and the asset maps do.
+	BB::BBRWLock os_lock = BB::OSCreateRWLock();
+	const double os_rwlock_time = RunContended(OS_SYNC_THREAD_COUNT, [&](uint32_t a_thread)
+	{
+		for (uint32_t i = 0; i < ITERATIONS; i++)
+		{
+			if (a_thread == 0)
+			{
+				BB::OSAcquireSRWLockWrite(&os_lock);
+				++counter;
+				BB::OSReleaseSRWLockWrite(&os_lock);
+			}
+			else
+			{
+				BB::OSAcquireSRWLockRead(&os_lock);
+				const volatile uint64_t read = counter;
+				(void)read;
+				BB::OSReleaseSRWLockRead(&os_lock);
+			}
+		}
+	});
+
+	std::shared_mutex std_lock;
+	const double std_rwlock_time = RunContended(OS_SYNC_THREAD_COUNT, [&](uint32_t a_thread)
+	{
+		for (uint32_t i = 0; i < ITERATIONS; i++)
+		{
+			if (a_thread == 0)
+			{
+				std_lock.lock();
+				++counter;
+				std_lock.unlock();
+			}
+			else
+			{
+				std_lock.lock_shared();
+				const volatile uint64_t read = counter;
+				(void)read;
+				std_lock.unlock_shared();
+			}
+		}
+	});
+
+	EXPECT_EQ(counter, static_cast<uint64_t>(ITERATIONS) * OS_SYNC_THREAD_COUNT * 2 + ITERATIONS * 2);
+	char message[128];
+	snprintf(message, sizeof(message), "contended mutex, os: %.2fms std: %.2fms", os_mutex_time, std_mutex_time);
+	BB_LOG(message);
+	snprintf(message, sizeof(message), "contended rw lock, os: %.2fms std: %.2fms", os_rwlock_time, std_rwlock_time);
+	BB_LOG(message);
+}
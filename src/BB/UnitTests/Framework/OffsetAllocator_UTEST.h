@@ -0,0 +1,170 @@
+#pragma once
+#include "../TestValues.h"
+#include "Allocators/OffsetAllocator.hpp"
+
+TEST(OffsetAllocator, allocate_free_merge)
+{
+	constexpr uint32_t heap_size = 1024 * 1024;
+	constexpr uint32_t allocation_count = 256;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::OffsetAllocator allocator;
+	allocator.Init(arena, heap_size, allocation_count * 2 + 1);
+
+	BB::OffsetAllocation allocations[allocation_count];
+	for (uint32_t i = 0; i < allocation_count; i++)
+	{
+		allocations[i] = allocator.Allocate(heap_size / allocation_count);
+		ASSERT_TRUE(allocations[i].IsValid());
+		// an empty allocator hands out the space in order.
+		EXPECT_EQ(allocations[i].offset, i * (heap_size / allocation_count));
+	}
+	EXPECT_FALSE(allocator.Allocate(1).IsValid()) << "allocator is full but still allocated";
+	EXPECT_EQ(allocator.GetReport().total_free, 0u);
+
+	// free every other allocation, no free region can merge.
+	for (uint32_t i = 0; i < allocation_count; i += 2)
+		allocator.Free(allocations[i]);
+	BB::OffsetAllocatorReport report = allocator.GetReport();
+	EXPECT_EQ(report.total_free, heap_size / 2);
+	EXPECT_EQ(report.free_region_count, allocation_count / 2);
+	EXPECT_EQ(report.largest_free, heap_size / allocation_count);
+	EXPECT_FALSE(allocator.Allocate(heap_size / allocation_count + 1).IsValid()) << "allocation larger then any free region succeeded";
+
+	// the rest merges everything back into one region.
+	for (uint32_t i = 1; i < allocation_count; i += 2)
+		allocator.Free(allocations[i]);
+	report = allocator.GetReport();
+	EXPECT_EQ(report.total_free, heap_size);
+	EXPECT_EQ(report.free_region_count, 1u);
+	EXPECT_EQ(report.largest_free, heap_size);
+	EXPECT_EQ(report.allocation_count, 0u);
+
+	const BB::OffsetAllocation full = allocator.Allocate(heap_size);
+	ASSERT_TRUE(full.IsValid());
+	EXPECT_EQ(full.offset, 0u);
+	allocator.Free(full);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(OffsetAllocator, random_allocations_never_overlap)
+{
+	constexpr uint32_t heap_size = 64 * 1024;
+	constexpr uint32_t slot_count = 512;
+	constexpr uint32_t iterations = 20000;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::OffsetAllocator allocator;
+	allocator.Init(arena, heap_size, slot_count * 2 + 1);
+
+	// every byte of the heap remembers which slot owns it.
+	uint16_t* owners = ArenaAllocArr(arena, uint16_t, heap_size);
+	constexpr uint16_t NO_OWNER = UINT16_MAX;
+	for (uint32_t i = 0; i < heap_size; i++)
+		owners[i] = NO_OWNER;
+
+	BB::OffsetAllocation slots[slot_count];
+	uint32_t slot_sizes[slot_count]{};
+	uint32_t used_size = 0;
+
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+	{
+		const uint32_t slot = BB::Random::Random(slot_count);
+		if (slots[slot].IsValid())
+		{
+			for (uint32_t i = 0; i < slot_sizes[slot]; i++)
+				owners[slots[slot].offset + i] = NO_OWNER;
+			allocator.Free(slots[slot]);
+			used_size -= slot_sizes[slot];
+			slots[slot] = BB::OffsetAllocation();
+			continue;
+		}
+
+		const uint32_t size = BB::Random::Random(1, 512);
+		const BB::OffsetAllocation allocation = allocator.Allocate(size);
+		if (!allocation.IsValid())
+			continue;
+
+		ASSERT_LE(allocation.offset + size, heap_size);
+		ASSERT_EQ(allocator.GetAllocationSize(allocation), size);
+		for (uint32_t i = 0; i < size; i++)
+		{
+			ASSERT_EQ(owners[allocation.offset + i], NO_OWNER) << "allocation overlaps with slot " << owners[allocation.offset + i];
+			owners[allocation.offset + i] = static_cast<uint16_t>(slot);
+		}
+		slots[slot] = allocation;
+		slot_sizes[slot] = size;
+		used_size += size;
+	}
+
+	EXPECT_EQ(allocator.GetReport().total_free, heap_size - used_size);
+
+	for (uint32_t i = 0; i < slot_count; i++)
+		if (slots[i].IsValid())
+			allocator.Free(slots[i]);
+
+	const BB::OffsetAllocatorReport report = allocator.GetReport();
+	EXPECT_EQ(report.total_free, heap_size);
+	EXPECT_EQ(report.free_region_count, 1u) << "free regions did not merge back together";
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(OffsetAllocator, allocate_lower_compacts)
+{
+	constexpr uint32_t heap_size = 4096;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::OffsetAllocator allocator;
+	allocator.Init(arena, heap_size, 16);
+
+	const BB::OffsetAllocation a = allocator.Allocate(256);
+	const BB::OffsetAllocation b = allocator.Allocate(256);
+	const BB::OffsetAllocation c = allocator.Allocate(256);
+
+	// nothing free below c yet.
+	EXPECT_FALSE(allocator.AllocateLower(c).IsValid());
+	EXPECT_EQ(allocator.GetReport().allocation_count, 3u);
+
+	allocator.Free(a);
+	const BB::OffsetAllocation moved = allocator.AllocateLower(c);
+	ASSERT_TRUE(moved.IsValid());
+	EXPECT_LT(moved.offset, c.offset);
+	EXPECT_EQ(allocator.GetAllocationSize(moved), 256u);
+	allocator.Free(c);
+
+	// the heap is now compacted, the end is one free region.
+	const BB::OffsetAllocatorReport report = allocator.GetReport();
+	EXPECT_EQ(report.free_region_count, 1u);
+	EXPECT_EQ(report.largest_free, heap_size - 512);
+
+	allocator.Free(moved);
+	allocator.Free(b);
+	EXPECT_EQ(allocator.GetReport().total_free, heap_size);
+
+	BB::MemoryArenaFree(arena);
+}
+
+// with free regions of the same size class below it, the lowest one is picked and not the one the bins hand out first.
+TEST(OffsetAllocator, allocate_lower_picks_the_lowest_region)
+{
+	constexpr uint32_t heap_size = 4096;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::OffsetAllocator allocator;
+	allocator.Init(arena, heap_size, 16);
+
+	BB::OffsetAllocation regions[5];
+	for (BB::OffsetAllocation& region : regions)
+		region = allocator.Allocate(256);
+	const BB::OffsetAllocation last = allocator.Allocate(256);
+
+	// free regions at 0, 512 and 1024 with used regions between them, the one at 1024 is the newest bin head.
+	allocator.Free(regions[0]);
+	allocator.Free(regions[2]);
+	allocator.Free(regions[4]);
+
+	const BB::OffsetAllocation moved = allocator.AllocateLower(last);
+	ASSERT_TRUE(moved.IsValid());
+	EXPECT_EQ(moved.offset, 0u);
+	EXPECT_EQ(allocator.GetAllocationSize(moved), 256u);
+
+	BB::MemoryArenaFree(arena);
+}
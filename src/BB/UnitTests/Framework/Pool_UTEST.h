@@ -2,6 +2,13 @@
 #include "../TestValues.h"
 #include "Storage/Pool.h"
 #include "Storage/GrowPool.h"
+#include "Storage/ConcurrentPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
 TEST(PoolDataStructure, Pool_Create_Get_Free)
 {
@@ -118,3 +125,152 @@ TEST(GrowPoolDataStructure, GrowPool_Create_Get_Free)
 
 	pool.DestroyPool();
 }
+
+struct ConcurrentPoolObject
+{
+	std::atomic<uint32_t> owner;
+	uint32_t data[7];
+};
+
+// every thread takes a few objects at a time and marks them, if two threads ever hold the same object one of them sees the other's mark.
+template<typename Pool>
+static uint32_t ConcurrentPoolHandOuts(Pool& a_pool, const uint32_t a_thread_count, const uint32_t a_rounds, const uint32_t a_hold_count)
+{
+	std::atomic<uint32_t> shared_objects{ 0 };
+	std::thread threads[8];
+	for (uint32_t t = 0; t < a_thread_count; t++)
+		threads[t] = std::thread([&, t]()
+		{
+			ConcurrentPoolObject* held[64];
+			for (uint32_t round = 0; round < a_rounds; round++)
+			{
+				for (uint32_t i = 0; i < a_hold_count; i++)
+				{
+					held[i] = a_pool.Get();
+					if (held[i]->owner.exchange(t + 1, std::memory_order_relaxed) != 0)
+						shared_objects.fetch_add(1, std::memory_order_relaxed);
+				}
+				for (uint32_t i = 0; i < a_hold_count; i++)
+				{
+					if (held[i]->owner.exchange(0, std::memory_order_relaxed) != t + 1)
+						shared_objects.fetch_add(1, std::memory_order_relaxed);
+					a_pool.Free(held[i]);
+				}
+			}
+		});
+	for (uint32_t t = 0; t < a_thread_count; t++)
+		threads[t].join();
+	return shared_objects.load();
+}
+
+TEST(ConcurrentPoolDataStructure, ConcurrentPool_Threads_Never_Share_An_Object)
+{
+	constexpr uint32_t pool_size = 512;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::ConcurrentPool<ConcurrentPoolObject> pool;
+	pool.CreatePool(arena, pool_size);
+
+	// 8 threads holding 64 each empties the pool, so the head goes through empty and full a lot.
+	EXPECT_EQ(ConcurrentPoolHandOuts(pool, 8, 5000, 64), 0u);
+
+	// everything came back, the pool hands out exactly pool_size unique objects again.
+	ConcurrentPoolObject* objects[pool_size];
+	for (uint32_t i = 0; i < pool_size; i++)
+	{
+		objects[i] = pool.Get();
+		ASSERT_NE(objects[i], nullptr);
+		EXPECT_EQ(objects[i]->owner.exchange(1), 0u);
+	}
+	EXPECT_EQ(pool.Get(), nullptr);
+	for (uint32_t i = 0; i < pool_size; i++)
+		pool.Free(objects[i]);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(ConcurrentPoolDataStructure, ConcurrentGrowPool_Grows_From_Many_Threads)
+{
+	BB::ConcurrentGrowPool<ConcurrentPoolObject> pool;
+	pool.CreatePool(8, 1 << 16);
+	EXPECT_EQ(pool.Capacity(), 8u);
+
+	EXPECT_EQ(ConcurrentPoolHandOuts(pool, 8, 2000, 64), 0u);
+	EXPECT_GE(pool.Capacity(), 64u);
+	EXPECT_LE(pool.Capacity(), 8u * 64u * 2u) << "grew more then it needed";
+
+	// stops at the maximum size.
+	BB::ConcurrentGrowPool<ConcurrentPoolObject> small_pool;
+	small_pool.CreatePool(4, 16);
+	for (uint32_t i = 0; i < 16; i++)
+		EXPECT_NE(small_pool.Get(), nullptr);
+	EXPECT_EQ(small_pool.Get(), nullptr);
+
+	small_pool.DestroyPool();
+	pool.DestroyPool();
+}
+
+// not a pass or fail, logs the time of the same get and free loop on a Pool behind a lock and on the concurrent pools.
+TEST(ConcurrentPoolDataStructure, Benchmark_Contended_Get_Free)
+{
+	constexpr uint32_t thread_count = 4;
+	constexpr uint32_t iterations = 200000;
+	constexpr uint32_t hold_count = 4;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+
+	auto run_contended = [&](auto a_get, auto a_free) -> double
+	{
+		std::thread threads[thread_count];
+		const auto begin = std::chrono::steady_clock::now();
+		for (std::thread& thread : threads)
+			thread = std::thread([&]()
+			{
+				ConcurrentPoolObject* held[hold_count];
+				for (uint32_t i = 0; i < iterations; i++)
+				{
+					for (uint32_t j = 0; j < hold_count; j++)
+						held[j] = a_get();
+					for (uint32_t j = 0; j < hold_count; j++)
+						a_free(held[j]);
+				}
+			});
+		for (std::thread& thread : threads)
+			thread.join();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	};
+
+	// the way the engine guards a Pool now, like GPUTextureManager did.
+	BB::Pool<ConcurrentPoolObject> locked_pool;
+	locked_pool.CreatePool(arena, thread_count * hold_count);
+	BB::BBRWLock lock = BB::OSCreateRWLock();
+	const double rwlock_time = run_contended(
+		[&]() { BB::BBRWLockScopeWrite scope(lock); return locked_pool.Get(); },
+		[&](ConcurrentPoolObject* a_ptr) { BB::BBRWLockScopeWrite scope(lock); locked_pool.Free(a_ptr); });
+
+	BB::Pool<ConcurrentPoolObject> mutex_pool;
+	mutex_pool.CreatePool(arena, thread_count * hold_count);
+	std::mutex mutex;
+	const double mutex_time = run_contended(
+		[&]() { std::lock_guard<std::mutex> scope(mutex); return mutex_pool.Get(); },
+		[&](ConcurrentPoolObject* a_ptr) { std::lock_guard<std::mutex> scope(mutex); mutex_pool.Free(a_ptr); });
+
+	BB::ConcurrentPool<ConcurrentPoolObject> concurrent_pool;
+	concurrent_pool.CreatePool(arena, thread_count * hold_count);
+	const double concurrent_time = run_contended(
+		[&]() { return concurrent_pool.Get(); },
+		[&](ConcurrentPoolObject* a_ptr) { concurrent_pool.Free(a_ptr); });
+
+	BB::ConcurrentGrowPool<ConcurrentPoolObject> grow_pool;
+	grow_pool.CreatePool(thread_count * hold_count);
+	const double grow_time = run_contended(
+		[&]() { return grow_pool.Get(); },
+		[&](ConcurrentPoolObject* a_ptr) { grow_pool.Free(a_ptr); });
+	grow_pool.DestroyPool();
+
+	// with less hardware threads then thread_count the threads take turns instead of contending, say so with the numbers.
+	char message[256];
+	snprintf(message, sizeof(message), "%u threads on %u hardware threads %u get and free, rw lock pool: %.2fms mutex pool: %.2fms concurrent pool: %.2fms concurrent grow pool: %.2fms",
+		thread_count, std::thread::hardware_concurrency(), iterations * hold_count, rwlock_time, mutex_time, concurrent_time, grow_time);
+	BB_LOG(message);
+
+	BB::MemoryArenaFree(arena);
+}
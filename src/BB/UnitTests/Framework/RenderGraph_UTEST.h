@@ -0,0 +1,202 @@
+#pragma once
+#include "../TestValues.h"
+#include "RenderGraph.hpp"
+
+// the graph does not know what states mean, these stand in for image layouts.
+constexpr uint32_t RG_TEST_COLOR_TARGET = 1;
+constexpr uint32_t RG_TEST_SHADER_READ = 2;
+constexpr uint32_t RG_TEST_DEPTH_TARGET = 3;
+
+static const BB::RenderGraphPassPlan* FindPassPlan(const BB::RenderGraphPlan& a_plan, const BB::RGPass a_pass)
+{
+	for (size_t i = 0; i < a_plan.passes.size(); i++)
+		if (a_plan.passes[i].pass == a_pass)
+			return &a_plan.passes[i];
+	return nullptr;
+}
+
+static const BB::RenderGraphBarrier* FindBarrier(const BB::RenderGraphPlan& a_plan, const BB::RGPass a_pass, const BB::RGResource a_resource)
+{
+	const BB::RenderGraphPassPlan* pass_plan = FindPassPlan(a_plan, a_pass);
+	if (pass_plan == nullptr)
+		return nullptr;
+	for (uint32_t i = pass_plan->barrier_start; i < pass_plan->barrier_start + pass_plan->barrier_count; i++)
+		if (a_plan.barriers[i].resource == a_resource)
+			return &a_plan.barriers[i];
+	return nullptr;
+}
+
+TEST(RenderGraph, cull_unused_passes)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::RenderGraph graph;
+	graph.Init(arena, 8, 8, 32);
+
+	const BB::RGResource back_buffer = graph.Import("back buffer", RG_TEST_COLOR_TARGET);
+	const BB::RGResource used = graph.CreateTransient("used", 1024, 256);
+	const BB::RGResource unused = graph.CreateTransient("unused", 1024, 256);
+
+	const BB::RGPass write_used = graph.AddPass("write used");
+	graph.Overwrite(write_used, used, RG_TEST_COLOR_TARGET);
+	const BB::RGPass write_unused = graph.AddPass("write unused");
+	graph.Overwrite(write_unused, unused, RG_TEST_COLOR_TARGET);
+	// reads the unused resource but writes nothing that is needed, so the pass before it goes as well.
+	const BB::RGPass read_unused = graph.AddPass("read unused");
+	graph.Read(read_unused, unused, RG_TEST_SHADER_READ);
+	const BB::RGPass debug = graph.AddPass("debug capture", true);
+	const BB::RGPass composite = graph.AddPass("composite");
+	graph.Read(composite, used, RG_TEST_SHADER_READ);
+	graph.Write(composite, back_buffer, RG_TEST_COLOR_TARGET);
+
+	const BB::RenderGraphPlan plan = graph.Compile(arena);
+	ASSERT_EQ(plan.passes.size(), 3u);
+	EXPECT_EQ(plan.culled_pass_count, 2u);
+	EXPECT_EQ(plan.passes[0].pass, write_used);
+	EXPECT_EQ(plan.passes[1].pass, debug);
+	EXPECT_EQ(plan.passes[2].pass, composite);
+	EXPECT_EQ(FindPassPlan(plan, write_unused), nullptr);
+	EXPECT_EQ(FindPassPlan(plan, read_unused), nullptr);
+	EXPECT_EQ(plan.resources[unused.handle].first_pass, BB::RENDER_GRAPH_INVALID_PASS);
+	EXPECT_EQ(plan.transient_heap_size, 1024u);
+
+	// an overwrite hides everything written before it, so only the last writer stays.
+	graph.Reset();
+	const BB::RGResource target = graph.Import("target", RG_TEST_COLOR_TARGET);
+	const BB::RGResource scratch = graph.CreateTransient("scratch", 64, 64);
+	const BB::RGPass first_write = graph.AddPass("first write");
+	graph.Overwrite(first_write, scratch, RG_TEST_COLOR_TARGET);
+	const BB::RGPass second_write = graph.AddPass("second write");
+	graph.Overwrite(second_write, scratch, RG_TEST_COLOR_TARGET);
+	const BB::RGPass copy = graph.AddPass("copy");
+	graph.Read(copy, scratch, RG_TEST_SHADER_READ);
+	graph.Write(copy, target, RG_TEST_COLOR_TARGET);
+
+	const BB::RenderGraphPlan overwrite_plan = graph.Compile(arena);
+	ASSERT_EQ(overwrite_plan.passes.size(), 2u);
+	EXPECT_EQ(overwrite_plan.passes[0].pass, second_write);
+	EXPECT_EQ(overwrite_plan.passes[1].pass, copy);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(RenderGraph, barriers)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::RenderGraph graph;
+	graph.Init(arena, 8, 8, 32);
+
+	const BB::RGResource back_buffer = graph.Import("back buffer", RG_TEST_COLOR_TARGET);
+	const BB::RGResource depth = graph.CreateTransient("depth", 4096, 256);
+	const BB::RGResource shadow = graph.Import("shadow map", RG_TEST_SHADER_READ);
+
+	const BB::RGPass depth_prepass = graph.AddPass("depth prepass");
+	graph.Overwrite(depth_prepass, depth, RG_TEST_DEPTH_TARGET);
+	const BB::RGPass opaque = graph.AddPass("opaque");
+	graph.Write(opaque, depth, RG_TEST_DEPTH_TARGET);
+	graph.Read(opaque, shadow, RG_TEST_SHADER_READ);
+	graph.Write(opaque, back_buffer, RG_TEST_COLOR_TARGET);
+	const BB::RGPass depth_read_0 = graph.AddPass("depth read 0");
+	graph.Read(depth_read_0, depth, RG_TEST_SHADER_READ);
+	graph.Write(depth_read_0, back_buffer, RG_TEST_COLOR_TARGET);
+	const BB::RGPass depth_read_1 = graph.AddPass("depth read 1");
+	graph.Read(depth_read_1, depth, RG_TEST_SHADER_READ);
+	graph.Write(depth_read_1, back_buffer, RG_TEST_COLOR_TARGET);
+
+	const BB::RenderGraphPlan plan = graph.Compile(arena);
+	ASSERT_EQ(plan.passes.size(), 4u);
+
+	// the first use of a transient resource starts from undefined content.
+	const BB::RenderGraphBarrier* barrier = FindBarrier(plan, depth_prepass, depth);
+	ASSERT_NE(barrier, nullptr);
+	EXPECT_EQ(barrier->prev_state, BB::RENDER_GRAPH_STATE_UNDEFINED);
+	EXPECT_EQ(barrier->next_state, RG_TEST_DEPTH_TARGET);
+	EXPECT_FALSE(barrier->aliased);
+
+	// write after write in the same state still needs to wait.
+	barrier = FindBarrier(plan, opaque, depth);
+	ASSERT_NE(barrier, nullptr);
+	EXPECT_EQ(barrier->prev_state, RG_TEST_DEPTH_TARGET);
+	EXPECT_EQ(barrier->next_state, RG_TEST_DEPTH_TARGET);
+
+	// an imported resource that is only read in the state it was imported in needs nothing.
+	EXPECT_EQ(FindBarrier(plan, opaque, shadow), nullptr);
+
+	barrier = FindBarrier(plan, depth_read_0, depth);
+	ASSERT_NE(barrier, nullptr);
+	EXPECT_EQ(barrier->prev_state, RG_TEST_DEPTH_TARGET);
+	EXPECT_EQ(barrier->next_state, RG_TEST_SHADER_READ);
+
+	// the second reader shares the transition of the first one.
+	EXPECT_EQ(FindBarrier(plan, depth_read_1, depth), nullptr);
+	EXPECT_EQ(plan.resources[depth.handle].final_state, RG_TEST_SHADER_READ);
+
+	// all the barriers of a pass are next to each other so they go out in one batch.
+	const BB::RenderGraphPassPlan* opaque_plan = FindPassPlan(plan, opaque);
+	ASSERT_NE(opaque_plan, nullptr);
+	EXPECT_EQ(opaque_plan->barrier_count, 2u);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(RenderGraph, transient_aliasing)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::RenderGraph graph;
+	graph.Init(arena, 8, 8, 32);
+
+	const BB::RGResource back_buffer = graph.Import("back buffer", RG_TEST_COLOR_TARGET);
+	const BB::RGResource a = graph.CreateTransient("a", 4096, 256);
+	const BB::RGResource b = graph.CreateTransient("b", 2048, 256);
+	const BB::RGResource c = graph.CreateTransient("c", 3000, 512);
+	const BB::RGResource d = graph.CreateTransient("d", 1000, 256);
+
+	// a -> b -> c -> d -> back buffer, every resource only overlaps with its neighbours.
+	const BB::RGPass pass_a = graph.AddPass("a");
+	graph.Overwrite(pass_a, a, RG_TEST_COLOR_TARGET);
+	const BB::RGPass pass_b = graph.AddPass("b");
+	graph.Read(pass_b, a, RG_TEST_SHADER_READ);
+	graph.Overwrite(pass_b, b, RG_TEST_COLOR_TARGET);
+	const BB::RGPass pass_c = graph.AddPass("c");
+	graph.Read(pass_c, b, RG_TEST_SHADER_READ);
+	graph.Overwrite(pass_c, c, RG_TEST_COLOR_TARGET);
+	const BB::RGPass pass_d = graph.AddPass("d");
+	graph.Read(pass_d, c, RG_TEST_SHADER_READ);
+	graph.Overwrite(pass_d, d, RG_TEST_COLOR_TARGET);
+	const BB::RGPass present = graph.AddPass("present");
+	graph.Read(present, d, RG_TEST_SHADER_READ);
+	graph.Write(present, back_buffer, RG_TEST_COLOR_TARGET);
+
+	const BB::RenderGraphPlan plan = graph.Compile(arena);
+	ASSERT_EQ(plan.passes.size(), 5u);
+
+	const BB::RGResource transients[] = { a, b, c, d };
+	const uint64_t sizes[] = { 4096, 2048, 3000, 1000 };
+	for (size_t i = 0; i < _countof(transients); i++)
+	{
+		const BB::RenderGraphResourcePlan& lhs = plan.resources[transients[i].handle];
+		EXPECT_LE(lhs.heap_offset + sizes[i], plan.transient_heap_size);
+		for (size_t j = i + 1; j < _countof(transients); j++)
+		{
+			const BB::RenderGraphResourcePlan& rhs = plan.resources[transients[j].handle];
+			const bool lifetimes_overlap = lhs.first_pass <= rhs.last_pass && rhs.first_pass <= lhs.last_pass;
+			const bool memory_overlaps = lhs.heap_offset < rhs.heap_offset + sizes[j] && rhs.heap_offset < lhs.heap_offset + sizes[i];
+			EXPECT_FALSE(lifetimes_overlap && memory_overlaps) << "resources that are alive together share memory";
+		}
+	}
+	EXPECT_EQ(plan.resources[c.handle].heap_offset % 512, 0u);
+
+	// a and c, and b and d can share memory, so the heap is the size of the biggest pair.
+	EXPECT_LT(plan.transient_heap_size, plan.transient_unaliased_size);
+	EXPECT_LE(plan.transient_heap_size, 4096u + 2048u);
+
+	// c takes over memory that a used, the first barrier of c has to wait for a.
+	const BB::RenderGraphBarrier* barrier = FindBarrier(plan, pass_c, c);
+	ASSERT_NE(barrier, nullptr);
+	EXPECT_TRUE(barrier->aliased);
+	EXPECT_EQ(barrier->prev_state, BB::RENDER_GRAPH_STATE_UNDEFINED);
+	barrier = FindBarrier(plan, pass_a, a);
+	ASSERT_NE(barrier, nullptr);
+	EXPECT_FALSE(barrier->aliased);
+
+	BB::MemoryArenaFree(arena);
+}
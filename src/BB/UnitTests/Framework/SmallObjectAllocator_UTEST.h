@@ -0,0 +1,188 @@
+#pragma once
+#include "../TestValues.h"
+#include "Allocators/SmallObjectAllocator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST(SmallObjectAllocator, size_classes_and_reuse)
+{
+	BB::SmallObjectAllocator allocator;
+	allocator.Init();
+
+	for (size_t size = 1; size <= BB::SMALL_OBJECT_MAX_SIZE; size += 7)
+	{
+		void* ptr = allocator.Alloc(size);
+		ASSERT_NE(ptr, nullptr);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 16, 0u);
+		EXPECT_GE(BB::SmallObjectAllocator::GetAllocationSize(ptr), size);
+		memset(ptr, 0xCD, size);
+		allocator.Free(ptr);
+		// the thread cache hands back the last freed object first.
+		EXPECT_EQ(allocator.Alloc(size), ptr);
+		allocator.Free(ptr);
+	}
+
+	// works through the Allocator interface like any other allocator.
+	BB::Allocator small_allocator = allocator;
+	size32Bytes* object = BBnew(small_allocator, size32Bytes)();
+	ASSERT_NE(object, nullptr);
+	BBfree(small_allocator, object);
+
+	allocator.FlushThreadCache();
+	const BB::SmallObjectAllocatorStats stats = allocator.GetStats();
+	EXPECT_EQ(stats.depot_object_count, stats.object_count) << "objects got lost";
+
+	allocator.Destroy();
+}
+
+// producers allocate and fill objects, consumers on other threads check and free them.
+// every freed object ends up in a cache of a thread that never allocated it, which is what the depot batching is for.
+TEST(SmallObjectAllocator, producers_and_consumers)
+{
+	constexpr uint32_t producer_count = 4;
+	constexpr uint32_t consumer_count = 4;
+	constexpr uint32_t objects_per_producer = 100000;
+
+	struct Object { uint8_t* ptr; uint32_t size; };
+	std::mutex queue_lock;
+	std::vector<Object> queue;
+	queue.reserve(4096);
+	std::atomic<uint32_t> producers_done{ 0 };
+	std::atomic<uint32_t> bad_objects{ 0 };
+	std::atomic<uint32_t> consumed{ 0 };
+
+	BB::SmallObjectAllocator allocator;
+	allocator.Init();
+
+	for (uint32_t round = 0; round < 2; round++)
+	{
+		const auto begin = std::chrono::steady_clock::now();
+		std::vector<std::thread> threads;
+		for (uint32_t p = 0; p < producer_count; p++)
+			threads.emplace_back([&, p]()
+			{
+				std::mt19937 random(p * 31 + round);
+				Object batch[32];
+				uint32_t batch_count = 0;
+				for (uint32_t i = 0; i < objects_per_producer; i++)
+				{
+					const uint32_t size = 1 + random() % BB::SMALL_OBJECT_MAX_SIZE;
+					uint8_t* ptr = reinterpret_cast<uint8_t*>(allocator.Alloc(size));
+					if (ptr == nullptr)
+					{
+						bad_objects.fetch_add(1, std::memory_order_relaxed);
+						continue;
+					}
+					memset(ptr, static_cast<uint8_t>(size), size);
+					batch[batch_count++] = Object{ ptr, size };
+					if (batch_count == _countof(batch))
+					{
+						std::lock_guard<std::mutex> lock(queue_lock);
+						queue.insert(queue.end(), batch, batch + batch_count);
+						batch_count = 0;
+					}
+				}
+				{
+					std::lock_guard<std::mutex> lock(queue_lock);
+					queue.insert(queue.end(), batch, batch + batch_count);
+				}
+				allocator.FlushThreadCache();
+				producers_done.fetch_add(1, std::memory_order_release);
+			});
+
+		for (uint32_t c = 0; c < consumer_count; c++)
+			threads.emplace_back([&]()
+			{
+				std::vector<Object> taken;
+				while (true)
+				{
+					const bool done = producers_done.load(std::memory_order_acquire) == producer_count * (round + 1);
+					{
+						std::lock_guard<std::mutex> lock(queue_lock);
+						taken.swap(queue);
+					}
+					if (taken.empty())
+					{
+						if (done)
+							break;
+						std::this_thread::yield();
+						continue;
+					}
+					for (const Object& object : taken)
+					{
+						for (uint32_t i = 0; i < object.size; i += 13)
+							if (object.ptr[i] != static_cast<uint8_t>(object.size))
+							{
+								bad_objects.fetch_add(1, std::memory_order_relaxed);
+								break;
+							}
+						allocator.Free(object.ptr);
+					}
+					consumed.fetch_add(static_cast<uint32_t>(taken.size()), std::memory_order_relaxed);
+					taken.clear();
+				}
+				allocator.FlushThreadCache();
+			});
+
+		for (std::thread& thread : threads)
+			thread.join();
+		const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		EXPECT_EQ(bad_objects.load(), 0u) << "an object was handed out twice or overwritten while live";
+		EXPECT_EQ(consumed.load(), producer_count * objects_per_producer * (round + 1));
+
+		// everything is freed and every thread flushed, so every object is back in a depot.
+		const BB::SmallObjectAllocatorStats stats = allocator.GetStats();
+		EXPECT_EQ(stats.depot_object_count, stats.object_count) << "objects got lost between the caches and the depots";
+
+		char message[128];
+		snprintf(message, sizeof(message), "round %u, %u producers %u consumers: %.2fms, %u spans",
+			round, producer_count, consumer_count, time, stats.span_count);
+		BB_LOG(message);
+	}
+
+	allocator.Destroy();
+}
+
+// more threads then there are thread slots over the whole run, exited threads hand their slot and cache to new ones.
+TEST(SmallObjectAllocator, thread_slots_are_reused)
+{
+	BB::SmallObjectAllocator allocator;
+	allocator.Init();
+
+	std::atomic<uint32_t> failed{ 0 };
+	for (uint32_t wave = 0; wave < 8; wave++)
+	{
+		std::thread threads[16];
+		for (std::thread& thread : threads)
+			thread = std::thread([&]()
+			{
+				void* ptrs[64];
+				for (uint32_t i = 0; i < _countof(ptrs); i++)
+				{
+					ptrs[i] = allocator.Alloc(48);
+					if (ptrs[i] == nullptr)
+						failed.fetch_add(1, std::memory_order_relaxed);
+				}
+				for (uint32_t i = 0; i < _countof(ptrs); i++)
+					if (ptrs[i])
+						allocator.Free(ptrs[i]);
+			});
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+	EXPECT_EQ(failed.load(), 0u);
+
+	// the caches left behind by exited threads still count, nothing is lost.
+	const BB::SmallObjectAllocatorStats stats = allocator.GetStats();
+	EXPECT_LE(stats.depot_object_count, stats.object_count);
+	EXPECT_EQ(stats.span_count, 1u) << "a 48 byte class for 16 threads at a time should fit in one span";
+
+	allocator.Destroy();
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include "../TestValues.h"
+#include "Utils/StringAtom.hpp"
+
+// the atom table is initialized by InitBB in Main.cpp.
+static_assert(BB::StringHash("atom") == BB::StringHash("atom", 4), "constexpr StringHash does not match sized StringHash");
+
+TEST(StringAtom, intern_find_compare)
+{
+	const uint32_t start_count = BB::StringAtomCount();
+
+	const BB::StringAtom first = BB::StringAtomIntern("unit_test_atom_first");
+	const BB::StringAtom second = BB::StringAtomIntern("unit_test_atom_second");
+	ASSERT_TRUE(first.IsValid());
+	ASSERT_TRUE(second.IsValid());
+	EXPECT_NE(first, second) << "different strings interned to the same atom";
+	EXPECT_EQ(BB::StringAtomCount(), start_count + 2);
+
+	// interning from a different buffer with the same content must return the same atom.
+	BB::StackString<64> copy("unit_test_atom_first");
+	EXPECT_EQ(BB::StringAtomIntern(copy.GetView()), first) << "same string interned to a different atom";
+	EXPECT_EQ(BB::StringAtomCount(), start_count + 2);
+
+	EXPECT_EQ(BB::StringAtomFind("unit_test_atom_second"), second);
+	EXPECT_FALSE(BB::StringAtomFind("unit_test_atom_never_interned").IsValid());
+	// a prefix of an interned string is a different string.
+	EXPECT_FALSE(BB::StringAtomFind(BB::StringView("unit_test_atom_first", 10)).IsValid());
+
+	const BB::StringView view = BB::StringAtomGetView(first);
+	EXPECT_EQ(view.size(), strlen("unit_test_atom_first"));
+	EXPECT_TRUE(view.compare("unit_test_atom_first"));
+	EXPECT_EQ(strcmp(BB::StringAtomGetCStr(second), "unit_test_atom_second"), 0);
+	EXPECT_EQ(BB::StringAtomGetHash(first), BB::StringHash("unit_test_atom_first"));
+
+	const BB::StringAtom literal_atom = BB_STRING_ATOM("unit_test_atom_first");
+	EXPECT_EQ(literal_atom, first);
+}
+
+TEST(StringAtom, intern_many)
+{
+	constexpr uint32_t ATOM_COUNT = 512;
+	BB::StringAtom atoms[ATOM_COUNT];
+
+	for (uint32_t i = 0; i < ATOM_COUNT; i++)
+	{
+		BB::StackString<32> name("unit_test_many_");
+		name.append(std::to_string(i).c_str());
+		atoms[i] = BB::StringAtomIntern(name.GetView());
+	}
+
+	for (uint32_t i = 0; i < ATOM_COUNT; i++)
+	{
+		BB::StackString<32> name("unit_test_many_");
+		name.append(std::to_string(i).c_str());
+		ASSERT_EQ(BB::StringAtomFind(name.GetView()), atoms[i]);
+		ASSERT_TRUE(BB::StringAtomGetView(atoms[i]) == name.GetView());
+	}
+}
+
+TEST(StringAtom, transient_intern_release)
+{
+	const uint32_t start_count = BB::StringAtomCount();
+
+	const BB::StringAtom first = BB::StringAtomInternTransient("unit_test_transient");
+	ASSERT_TRUE(first.IsValid());
+	EXPECT_EQ(BB::StringAtomInternTransient("unit_test_transient"), first) << "same transient string interned to a different atom";
+	EXPECT_EQ(BB::StringAtomFind("unit_test_transient"), first);
+	EXPECT_TRUE(BB::StringAtomGetView(first).compare("unit_test_transient"));
+	EXPECT_EQ(BB::StringAtomGetHash(first), BB::StringHash("unit_test_transient"));
+	// transient atoms do not take space in the table for good.
+	EXPECT_EQ(BB::StringAtomCount(), start_count);
+
+	BB::StringAtomRelease(first);
+	EXPECT_EQ(BB::StringAtomFind("unit_test_transient"), first) << "released before the last reference was gone";
+	BB::StringAtomRelease(first);
+	EXPECT_FALSE(BB::StringAtomFind("unit_test_transient").IsValid());
+
+	// a string that is already interned for good gives that atom, releasing it does nothing.
+	const BB::StringAtom normal = BB::StringAtomIntern("unit_test_transient_normal");
+	EXPECT_EQ(BB::StringAtomInternTransient("unit_test_transient_normal"), normal);
+	BB::StringAtomRelease(normal);
+	EXPECT_EQ(BB::StringAtomFind("unit_test_transient_normal"), normal);
+}
+
+TEST(StringAtom, transient_release_keeps_others)
+{
+	constexpr uint32_t ATOM_COUNT = 512;
+	BB::StringAtom atoms[ATOM_COUNT];
+	for (uint32_t i = 0; i < ATOM_COUNT; i++)
+	{
+		BB::StackString<32> name("unit_test_transient_");
+		name.append(std::to_string(i).c_str());
+		atoms[i] = BB::StringAtomInternTransient(name.GetView());
+	}
+
+	// removing entries in the middle of probe chains must not hide the entries after them.
+	for (uint32_t i = 0; i < ATOM_COUNT; i += 2)
+		BB::StringAtomRelease(atoms[i]);
+
+	for (uint32_t i = 0; i < ATOM_COUNT; i++)
+	{
+		BB::StackString<32> name("unit_test_transient_");
+		name.append(std::to_string(i).c_str());
+		if (i & 1)
+		{
+			ASSERT_EQ(BB::StringAtomFind(name.GetView()), atoms[i]);
+			ASSERT_TRUE(BB::StringAtomGetView(atoms[i]) == name.GetView());
+			BB::StringAtomRelease(atoms[i]);
+		}
+		else
+			ASSERT_FALSE(BB::StringAtomFind(name.GetView()).IsValid());
+	}
+}
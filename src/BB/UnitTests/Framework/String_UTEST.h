@@ -11,7 +11,7 @@ TEST(String_DataStructure, append_insert_push_pop_copy_assignment)
 	const size_t allocatorSize = BB::kbSize * 16;
 	BB::MemoryArena arena = BB::MemoryArenaCreate();
 
-	BB::String string(arena);
+	BB::String string(arena, StringReserve);
 
 	//test single string and compare.
 	{
@@ -123,7 +123,7 @@ TEST(WideString_DataStructure, append_insert_push_pop_copy_assignment)
 
 	BB::MemoryArena arena = BB::MemoryArenaCreate();
 
-	BB::WString string(arena);
+	BB::WString string(arena, StringReserve);
 
 	//test single string and compare.
 	{
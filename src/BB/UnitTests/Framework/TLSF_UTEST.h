@@ -0,0 +1,241 @@
+#pragma once
+#include "../TestValues.h"
+#include "Allocators/MemoryInterfaces.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+TEST(TLSFAllocator, allocate_free_merge)
+{
+	constexpr size_t pool_size = 1024 * 1024;
+	constexpr size_t allocation_size = 1024;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::TLSFInterface tlsf;
+	tlsf.Initialize(arena, pool_size);
+
+	const BB::TLSFStats empty = tlsf.GetStats();
+	EXPECT_EQ(empty.free_block_count, 1u);
+	EXPECT_EQ(empty.largest_free_block, empty.free_size);
+	EXPECT_EQ(empty.used_size, 0u);
+
+	void* allocations[pool_size / allocation_size];
+	size_t allocation_count = 0;
+	while (void* ptr = tlsf.Alloc(allocation_size, 16))
+	{
+		ASSERT_LT(allocation_count, sizeof(allocations) / sizeof(allocations[0]));
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 16, 0u);
+		memset(ptr, static_cast<int>(allocation_count), allocation_size);
+		allocations[allocation_count++] = ptr;
+	}
+	ASSERT_GT(allocation_count, pool_size / allocation_size / 2);
+	EXPECT_EQ(tlsf.GetStats().used_size, allocation_count * allocation_size);
+
+	// free every other allocation, none of the holes can merge.
+	for (size_t i = 0; i < allocation_count; i += 2)
+		tlsf.Free(allocations[i]);
+	BB::TLSFStats stats = tlsf.GetStats();
+	EXPECT_GE(stats.free_block_count, allocation_count / 2);
+	EXPECT_LT(stats.largest_free_block, allocation_size * 2);
+	EXPECT_EQ(tlsf.Alloc(allocation_size * 2, 16), nullptr) << "allocation larger then any hole succeeded";
+
+	for (size_t i = 1; i < allocation_count; i += 2)
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(allocations[i]);
+		EXPECT_TRUE(bytes[0] == static_cast<uint8_t>(i) && bytes[allocation_size - 1] == static_cast<uint8_t>(i)) << "allocation got overwritten";
+		tlsf.Free(allocations[i]);
+	}
+
+	// everything merged back into the single block the pool started with.
+	stats = tlsf.GetStats();
+	EXPECT_EQ(stats.free_block_count, 1u);
+	EXPECT_EQ(stats.largest_free_block, empty.largest_free_block);
+	EXPECT_EQ(stats.allocation_count, 0u);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(TLSFAllocator, alignment_and_realloc)
+{
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::TLSFInterface tlsf;
+	tlsf.Initialize(arena, mbSize);
+
+	for (size_t alignment = 16; alignment <= 4096; alignment *= 2)
+	{
+		void* ptr = tlsf.Alloc(100, alignment);
+		ASSERT_NE(ptr, nullptr);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1), 0u) << "alignment " << alignment;
+	}
+
+	// the aligned allocations left gaps in front of them, start empty so nothing is after the next allocation.
+	tlsf.Clear();
+	EXPECT_EQ(tlsf.GetStats().free_block_count, 1u);
+
+	// nothing after it is used, so it grows in place.
+	void* grow = tlsf.Alloc(64, 16);
+	memset(grow, 0xAB, 64);
+	void* grown = tlsf.Realloc(grow, 4096, 16);
+	EXPECT_EQ(grown, grow);
+	EXPECT_GE(tlsf.GetAllocationSize(grown), 4096u);
+	EXPECT_EQ(reinterpret_cast<const uint8_t*>(grown)[63], 0xAB);
+
+	// something is in the way, it has to move and keep the data.
+	void* blocker = tlsf.Alloc(16, 16);
+	void* moved = tlsf.Realloc(grown, 8192, 16);
+	EXPECT_NE(moved, grown);
+	EXPECT_EQ(reinterpret_cast<const uint8_t*>(moved)[0], 0xAB);
+	EXPECT_EQ(reinterpret_cast<const uint8_t*>(moved)[63], 0xAB);
+
+	// shrinking hands the end back.
+	const size_t used_before = tlsf.GetStats().used_size;
+	EXPECT_EQ(tlsf.Realloc(moved, 128, 16), moved);
+	EXPECT_EQ(tlsf.GetStats().used_size, used_before - 8192 + 128);
+
+	EXPECT_EQ(tlsf.Realloc(moved, 0, 16), nullptr);
+	tlsf.Free(blocker);
+	EXPECT_EQ(tlsf.Alloc(mbSize * 2, 16), nullptr);
+	EXPECT_EQ(tlsf.GetStats().free_block_count, 1u);
+	EXPECT_EQ(tlsf.GetStats().allocation_count, 0u);
+
+	BB::MemoryArenaFree(arena);
+}
+
+TEST(TLSFAllocator, random_allocations_do_not_overlap)
+{
+	constexpr uint32_t slot_count = 1024;
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	BB::TLSFInterface tlsf;
+	tlsf.Initialize(arena, mbSize * 32);
+
+	struct Slot { uint8_t* ptr; size_t size; size_t alignment; };
+	Slot slots[slot_count]{};
+	std::mt19937 random(1234);
+
+	for (uint32_t op = 0; op < 50000; op++)
+	{
+		Slot& slot = slots[random() % slot_count];
+		if (slot.ptr)
+		{
+			for (size_t i = 0; i < slot.size; i += 7)
+				ASSERT_EQ(slot.ptr[i], static_cast<uint8_t>(slot.size)) << "memory of a live allocation got overwritten";
+		}
+
+		const size_t size = 1 + random() % (random() % 8 == 0 ? 16384 : 256);
+		const size_t alignment = size_t(1) << (random() % 8);
+		switch (random() % 3)
+		{
+		case 0:
+			if (slot.ptr)
+				tlsf.Free(slot.ptr);
+			slot.ptr = reinterpret_cast<uint8_t*>(tlsf.Alloc(size, alignment));
+			slot.alignment = alignment;
+			break;
+		case 1:
+			// a realloc keeps the alignment the block was allocated with.
+			if (slot.ptr == nullptr)
+				slot.alignment = alignment;
+			slot.ptr = reinterpret_cast<uint8_t*>(tlsf.Realloc(slot.ptr, size, slot.alignment));
+			break;
+		case 2:
+			if (slot.ptr)
+				tlsf.Free(slot.ptr);
+			slot.ptr = nullptr;
+			break;
+		}
+
+		if (slot.ptr)
+		{
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(slot.ptr) % 16, 0u);
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(slot.ptr) % slot.alignment, 0u);
+			slot.size = size;
+			memset(slot.ptr, static_cast<uint8_t>(size), size);
+		}
+	}
+
+	for (uint32_t i = 0; i < slot_count; i++)
+		if (slots[i].ptr)
+			tlsf.Free(slots[i].ptr);
+	const BB::TLSFStats stats = tlsf.GetStats();
+	EXPECT_EQ(stats.free_block_count, 1u);
+	EXPECT_EQ(stats.used_size, 0u);
+
+	BB::MemoryArenaFree(arena);
+}
+
+// not a pass or fail, logs the time and the memory footprint of the same random workload on the freelist and tlsf.
+// footprint is how far into the pool the allocator had to go to hold the live allocations, more means more fragmentation.
+TEST(TLSFAllocator, benchmark_against_freelist)
+{
+	constexpr uint32_t slot_count = 4096;
+	constexpr uint32_t operation_count = 200000;
+	constexpr size_t pool_size = mbSize * 256;
+
+	struct Operation { uint32_t slot; uint32_t size; };
+	BB::MemoryArena arena = BB::MemoryArenaCreate();
+	Operation* operations = ArenaAllocArr(arena, Operation, operation_count);
+	std::mt19937 random(4321);
+	for (uint32_t i = 0; i < operation_count; i++)
+	{
+		operations[i].slot = random() % slot_count;
+		// mostly small lua and string sized allocations with the odd large buffer.
+		operations[i].size = 8 + random() % (random() % 16 == 0 ? 65536 : 512);
+	}
+
+	struct Result { double time; size_t footprint; size_t live_size; };
+	auto run_workload = [&](auto& a_allocator) -> Result
+	{
+		void* slots[slot_count]{};
+		uint32_t sizes[slot_count]{};
+		size_t live_size = 0;
+		Result result{};
+		const uintptr_t pool_start = reinterpret_cast<uintptr_t>(a_allocator.Alloc(16, 16));
+
+		const auto begin = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < operation_count; i++)
+		{
+			const Operation& op = operations[i];
+			if (slots[op.slot])
+			{
+				a_allocator.Free(slots[op.slot]);
+				live_size -= sizes[op.slot];
+				slots[op.slot] = nullptr;
+				continue;
+			}
+			slots[op.slot] = a_allocator.Alloc(op.size, 16);
+			sizes[op.slot] = op.size;
+			live_size += op.size;
+			const size_t end = reinterpret_cast<uintptr_t>(slots[op.slot]) + op.size - pool_start;
+			if (end > result.footprint)
+			{
+				result.footprint = end;
+				result.live_size = live_size;
+			}
+		}
+		result.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		for (uint32_t i = 0; i < slot_count; i++)
+			if (slots[i])
+				a_allocator.Free(slots[i]);
+		return result;
+	};
+
+	BB::FreelistInterface freelist;
+	freelist.Initialize(arena, pool_size);
+	const Result freelist_result = run_workload(freelist);
+
+	BB::TLSFInterface tlsf;
+	tlsf.Initialize(arena, pool_size);
+	const Result tlsf_result = run_workload(tlsf);
+	EXPECT_EQ(tlsf.GetStats().allocation_count, 1u);
+
+	char message[192];
+	snprintf(message, sizeof(message), "%u random allocs and frees, freelist: %.2fms tlsf: %.2fms",
+		operation_count, freelist_result.time, tlsf_result.time);
+	BB_LOG(message);
+	snprintf(message, sizeof(message), "peak footprint, freelist: %zukb for %zukb live, tlsf: %zukb for %zukb live",
+		freelist_result.footprint / kbSize, freelist_result.live_size / kbSize, tlsf_result.footprint / kbSize, tlsf_result.live_size / kbSize);
+	BB_LOG(message);
+
+	BB::MemoryArenaFree(arena);
+}
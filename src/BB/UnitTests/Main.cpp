@@ -22,12 +22,18 @@ int main(int argc, char** argv)
 
 	Threads::InitThreads(8);
 
-	Logger::EnableLogTypes(0);
-	Logger::EnableLogType(WarningType::INFO);
-	testing::InitGoogleTest();
-	RUN_ALL_TESTS();
+	testing::InitGoogleTest(&argc, argv);
+	const int test_result = RUN_ALL_TESTS();
+
+	// the input check needs a window and someone at the keyboard, so it only runs when asked for.
+	bool input_test = false;
+	for (int i = 1; i < argc; i++)
+		if (strcmp(argv[i], "--input_test") == 0)
+			input_test = true;
+	if (!input_test)
+		return test_result;
+
 	WindowHandle mainWindow = CreateOSWindow(OS_WINDOW_STYLE::MAIN, 250, 200, 250, 200, L"Unit Test Main Window");
-	Logger::EnableLogTypes(UINT32_MAX);
 
 	bool hasWindows = true;
 	InputEvent t_InputEvents[INPUT_EVENT_BUFFER_MAX]{};
@@ -72,7 +78,7 @@ int main(int argc, char** argv)
 		hasWindows = ProcessMessages(mainWindow);
 	}
 
-	return 0;
+	return test_result;
 }
 
 //Suppress the stack warning, is safe since this code is only used for the unit testing here.
@@ -89,4 +95,15 @@ int main(int argc, char** argv)
 #include "Framework/Slotmap_UTEST.h"
 #include "Framework/String_UTEST.h"
 #include "Framework/FileReadWrite_UTEST.h"
+#include "Framework/StringAtom_UTEST.h"
+#include "Framework/OffsetAllocator_UTEST.h"
+#include "Framework/Meshlet_UTEST.h"
+#include "Framework/RenderGraph_UTEST.h"
+#include "Framework/AtlasAllocator_UTEST.h"
+#include "Framework/DynamicResolution_UTEST.h"
+#include "Framework/OSSync_UTEST.h"
+#include "Framework/TLSF_UTEST.h"
+#include "Framework/SmallObjectAllocator_UTEST.h"
+#include "Framework/MirroredRingBuffer_UTEST.h"
+#include "Framework/MemoryAccounting_UTEST.h"
 #pragma warning(default:6262)
\ No newline at end of file
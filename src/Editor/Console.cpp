@@ -35,6 +35,7 @@ void Console::Init(const ConsoleCreateInfo& a_create_info)
 		m_arena,
 		sizeof(Console::ConsoleEntry) * m_entry_commit_limit,
 		__alignof(Console::ConsoleEntry)));
+	TagMemory(m_arena, m_entry_start, "console entries");
 
 	m_writing_to_file = false;
 	m_entry_count = 0;
@@ -200,8 +201,12 @@ void Console::LoggerCallback(const char* a_file_name, int a_line, const WarningT
 			//check to see if we do not go over bounds, largly to deal with non-null-terminated wchar strings.
 			BB_ASSERT(char_size < entry.message.capacity() - entry.message.size(), "error log string size exceeds 2048 characters!");
 			char* character = BBstackAlloc_s(char_size, char);
+#ifdef _LINUX
+			wcstombs(character, w_char, char_size);
+#else
 			size_t conv_chars = 0;
 			wcstombs_s(&conv_chars, character, char_size, w_char, _TRUNCATE);
+#endif //_LINUX
 			entry.message.append(character);
 			BBstackFree_s(character);
 		}
@@ -282,7 +287,7 @@ void Console::LoggerToFile(MemoryArena& a_arena, void* a_puserdata)
 
 			//Get the line number into the buffer
 			char lineNumString[8]{};
-			sprintf_s(lineNumString, 8, "%u", entry.line);
+			snprintf(lineNumString, 8, "%u", entry.line);
 
 			massive_string.append(LOG_MESSAGE_LINE_NUMBER_1, sizeof(LOG_MESSAGE_LINE_NUMBER_1) - 1);
 			massive_string.append(lineNumString);
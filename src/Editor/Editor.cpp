@@ -103,13 +103,28 @@ void Editor::MainEditorImGuiInfo(const MemoryArena& a_arena)
 				ImGui::Text("memory commited: %zu", commited);
 				ImGui::Text("memory used: %zu", used);
 
-				const float perc_calculation = 1.f / static_cast<float>(ARENA_DEFAULT_COMMIT);
+				const MemoryArenaStats& stats = MemoryArenaGetStats(a_arena);
+				ImGui::Text("high water mark: %zu", stats.high_water_mark);
+				ImGui::Text("commit count: %u", stats.commit_count);
+				ImGui::Text("decommit count: %u", stats.decommit_count);
+				ImGui::Text("allocations last frame: %u", stats.allocations_last_frame);
+				ImGui::Text("allocations this frame so far: %u", stats.allocation_count);
+#ifdef _DEBUG_MEMORY
+				ImGui::TextUnformatted("allocation tracking: on");
+#else
+				ImGui::TextUnformatted("allocation tracking: off");
+#endif // _DEBUG_MEMORY
+
+				// commits grow with the arena, so show how full the committed range is.
 				ImGui::Separator();
 				ImGui::TextUnformatted("memory used till next commit");
-				ImGui::ProgressBar(perc_calculation * static_cast<float>(RoundUp(used, ARENA_DEFAULT_COMMIT) - used));
+				ImGui::ProgressBar(commited ? static_cast<float>(used) / static_cast<float>(commited) : 0.f);
 				ImGui::Unindent();
 			}
 		}
+		ImGui::Checkbox("defragment meshes every frame", &m_defragment_meshes);
+		if (ImGui::Button("defragment meshes"))
+			m_defragment_meshes_requested = true;
         ImGui::Unindent();
 	}
 }
@@ -164,6 +179,8 @@ void Editor::UpdateGame(EditorGame& a_instance, const float a_delta_time)
     m_per_frame.draw_struct[pool_index].game = &a_instance;
 	m_per_frame.fences[pool_index] = frame.render_frame.fence;
 	m_per_frame.fence_values[pool_index] = frame.render_frame.fence_value;
+	m_per_frame.wait_fences[pool_index] = frame.render_frame.wait_fence;
+	m_per_frame.wait_values[pool_index] = frame.render_frame.wait_value;
 	m_per_frame.frame_results[pool_index] = frame;
     m_per_frame.success[pool_index] = success;
     if (!success)
@@ -235,8 +252,10 @@ void Editor::Init(MemoryArena& a_arena, const WindowHandle a_window, const uint2
 	m_gpu_info = GetGPUInfo(a_arena);
 
 	m_editor_allocator.Initialize(a_arena, a_editor_memory);
+	m_memory_profiler.Init(a_arena);
 
 	m_imgui_material = Material::GetDefaultMasterMaterial(PASS_TYPE::GLOBAL, MATERIAL_TYPE::MATERIAL_2D);
+	m_entity_commands.Init(a_arena, EDITOR_ECS_COMMAND_MEMORY);
 
 	const uint32_t frame_count = GetBackBufferCount();
 
@@ -350,6 +369,8 @@ void Editor::Destroy()
 
 void Editor::StartFrame(MemoryArena& a_arena, const Slice<InputEvent> a_input_events, const float a_delta_time)
 {
+	// the main arena is shown in the editor info, so its allocations are counted per frame.
+	MemoryArenaStatsNextFrame(a_arena);
 	ImNewFrame(m_app_window_extent);
 
 	m_swallow_input = false;
@@ -377,6 +398,14 @@ void Editor::StartFrame(MemoryArena& a_arena, const Slice<InputEvent> a_input_ev
 	RenderStartFrame(list, start_info, m_render_target, m_per_frame.back_buffer_index);
 	m_per_frame.current_count = 0;
 
+	// no game is running here, so the meshes can be moved and patched before they draw.
+	m_per_frame.mesh_relocation_count = 0;
+	if (m_defragment_meshes || m_defragment_meshes_requested)
+	{
+		m_per_frame.mesh_relocation_count = Asset::DefragmentMeshes(list, m_per_frame.mesh_relocations.slice());
+		m_defragment_meshes_requested = m_per_frame.mesh_relocation_count == EDITOR_MESH_RELOCATIONS_PER_FRAME;
+	}
+
 	m_console.ImGuiShowConsole(a_arena, m_app_window_extent);
 }
 
@@ -390,6 +419,7 @@ ThreadTask Editor::UpdateGameInstance(MemoryArena& a_arena, const float a_delta_
     };
 
     ImGuiDisplayGame(a_game.GetGameInstance());
+    a_game.GetSceneHierarchy().GetECS().RelocateMeshes(m_per_frame.mesh_relocations.const_slice(m_per_frame.mesh_relocation_count));
 
     return Threads::StartTaskThread(ThreadFuncForDrawing, &params, sizeof(params), L"scene draw task");
 }
@@ -462,12 +492,27 @@ void Editor::EndFrame(MemoryArena& a_arena)
 		}
 
 		const uint32_t command_list_count = Max(m_per_frame.current_count.load(), 1u);
+
+		FixedArray<RFence, 8> wait_fences;
+		FixedArray<uint64_t, 8> wait_values;
+		uint32_t wait_count = 0;
+		for (size_t i = 0; i < m_per_frame.current_count; i++)
+		{
+			if (!m_per_frame.wait_fences[i].IsValid())
+				continue;
+			wait_fences[wait_count] = m_per_frame.wait_fences[i];
+			wait_values[wait_count++] = m_per_frame.wait_values[i];
+		}
+
 		uint64_t present_queue_value;
 		// TODO: fence values could bug if no scenes are being rendered.
 		result = PresentFrame(m_per_frame.pools.slice(command_list_count),
 			m_per_frame.fences.data(), 
 			m_per_frame.fence_values.data(), 
 			m_per_frame.current_count,
+			wait_fences.data(),
+			wait_values.data(),
+			wait_count,
 			present_queue_value, 
 			skip);
 	}
@@ -557,6 +602,7 @@ void Editor::ImGuiDisplayEditor(MemoryArena& a_arena)
 
 
     Asset::ShowAssetMenu(a_arena);
+    m_memory_profiler.ImGuiShow(a_arena);
 }
 
 void Editor::ImGuiDisplayGame(GameInstance& a_game)
@@ -632,6 +678,34 @@ void Editor::ImguiDisplayECS(EntityComponentSystem& a_ecs)
 			{
 				render_sys.ToggleSkipBloomPass();
 			}
+			if (ImGui::Button("toggle meshlet culling"))
+			{
+				render_sys.ToggleSkipMeshletCulling();
+			}
+			ImGui::Text("meshlet culling drew %u of %u indices", render_sys.m_meshlet_cull_stats.drawn_index_count, render_sys.m_meshlet_cull_stats.index_count);
+			if (ImGui::Button("toggle occlusion culling"))
+			{
+				render_sys.ToggleSkipOcclusionCulling();
+			}
+			ImGui::Text("render graph transient images use %llu of %llu bytes", static_cast<unsigned long long>(render_sys.m_render_graph.GetTransientHeapSize()), static_cast<unsigned long long>(render_sys.m_render_graph.GetTransientUnaliasedSize()));
+			const ShadowMapStats shadow_stats = render_sys.m_shadowmap_stage.GetStats();
+			ImGui::Text("shadow atlas rendered %u of %u shadows, %llu texels used", shadow_stats.rendered_count, shadow_stats.shadow_count, static_cast<unsigned long long>(shadow_stats.atlas_used_area));
+			if (ImGui::Button("toggle dynamic resolution"))
+			{
+				render_sys.ToggleDynamicResolution();
+			}
+			float target_frame_time = render_sys.m_dynamic_resolution.GetTargetFrameTime();
+			if (ImGui::SliderFloat("target frame time ms", &target_frame_time, 4.f, 50.f))
+				render_sys.m_dynamic_resolution.SetTargetFrameTime(target_frame_time);
+			const DynamicResolutionState resolution_state = render_sys.m_dynamic_resolution.GetState();
+			ImGui::Text("rendering at %u x %u, scale %.3f, cpu %.2f ms, gpu %.2f ms", render_sys.m_render_size.x, render_sys.m_render_size.y, resolution_state.scale, resolution_state.cpu_average, resolution_state.gpu_average);
+			if (ImGui::TreeNodeEx("cpu time per stage"))
+			{
+				const ConstSlice<RenderStageCPUTime> stage_times = render_sys.GetStageCPUTimes();
+				for (size_t i = 0; i < stage_times.size(); i++)
+					ImGui::Text("%s: %.3f ms", stage_times[i].name, stage_times[i].milliseconds);
+				ImGui::TreePop();
+			}
 		}
 
 		for (uint32_t i = 0; i < a_ecs.m_root_entity_system.root_entities.Size(); i++)
@@ -665,16 +739,16 @@ void Editor::ImGuiDisplayEntity(EntityComponentSystem& a_ecs, const ECSEntity a_
 {
 	ImGui::PushID(static_cast<int>(a_entity.handle));
 
-	if (ImGui::CollapsingHeader(a_ecs.m_name_pool.GetComponent(a_entity).c_str()))
+	if (ImGui::CollapsingHeader(StringAtomGetCStr(a_ecs.GetComponent(a_ecs.m_name_pool, a_entity))))
 	{
 		ImGui::Indent();
 		bool position_changed = false;
 		
 		if (ImGui::TreeNodeEx("transform"))
 		{
-			float3& pos = a_ecs.m_positions.GetComponent(a_entity);
-			//float3x3& rot = a_ecs.m_rotations.GetComponent(a_entity);
-			float3& scale = a_ecs.m_scales.GetComponent(a_entity);
+			float3& pos = a_ecs.GetComponent(a_ecs.m_positions, a_entity);
+			//float3x3& rot = a_ecs.GetComponent(a_ecs.m_rotations, a_entity);
+			float3& scale = a_ecs.GetComponent(a_ecs.m_scales, a_entity);
 
 			if (ImGui::InputFloat3("position", pos.e))
 			{
@@ -695,11 +769,11 @@ void Editor::ImGuiDisplayEntity(EntityComponentSystem& a_ecs, const ECSEntity a_
 			ImGui::TreePop();
 		}
 
-		const float3 pos = a_ecs.m_positions.GetComponent(a_entity);
+		const float3 pos = a_ecs.GetComponent(a_ecs.m_positions, a_entity);
 
 		if (a_ecs.m_ecs_entities.HasSignature(a_entity, RENDER_ECS_SIGNATURE))
 		{
-			RenderComponent& RenderComponent = a_ecs.m_render_mesh_pool.GetComponent(a_entity);
+			RenderComponent& RenderComponent = a_ecs.GetComponent(a_ecs.m_render_mesh_pool, a_entity);
 			if (ImGui::TreeNodeEx("rendering"))
 			{
 				ImGui::Indent();
@@ -758,7 +832,7 @@ void Editor::ImGuiDisplayEntity(EntityComponentSystem& a_ecs, const ECSEntity a_
 			if (ImGui::TreeNodeEx("light"))
 			{
 				ImGui::Indent();
-				LightComponent& comp = a_ecs.m_light_pool.GetComponent(a_entity);
+				LightComponent& comp = a_ecs.GetComponent(a_ecs.m_light_pool, a_entity);
 
 				comp.light.pos.x = pos.x;
 				comp.light.pos.y = pos.y;
@@ -847,18 +921,21 @@ void Editor::ImGuiDisplayEntity(EntityComponentSystem& a_ecs, const ECSEntity a_
 			ImGui::TreePop();
 		}
 
-		const EntityRelation relation = a_ecs.m_relations.GetComponent(a_entity);
+		const EntityRelation relation = a_ecs.GetComponent(a_ecs.m_relations, a_entity);
 		ECSEntity child = relation.first_child;
 		for (size_t i = 0; i < relation.child_count; i++)
 		{
 			ImGuiDisplayEntity(a_ecs, child);
-			child = a_ecs.m_relations.GetComponent(child).next;
+			child = a_ecs.GetComponent(a_ecs.m_relations, child).next;
 		}
 
         ImGuiCreateEntity(a_ecs, a_entity);
 
         if (ImGui::Button("Destroy entity"))
-            a_ecs.DestroyEntity(a_entity);
+        {
+            m_entity_commands.DestroyEntity(a_entity);
+            a_ecs.SubmitCommandBuffer(m_entity_commands);
+        }
             
 		ImGui::Unindent();
 	}
@@ -877,7 +954,8 @@ void Editor::ImGuiCreateEntity(EntityComponentSystem& a_ecs, const ECSEntity a_p
 
 		if (ImGui::Button("create scene object"))
 		{
-			a_ecs.CreateEntity(mesh_name, a_parent);
+			m_entity_commands.CreateEntity(mesh_name, a_parent);
+			a_ecs.SubmitCommandBuffer(m_entity_commands);
 		}
 
 		ImGui::Unindent();
@@ -962,8 +1040,10 @@ void Editor::ImGuiDisplayMaterial(const MasterMaterial& a_material) const
         DisplayShader(a_material.shaders.vertex, "vertex");
         DisplayShader(a_material.shaders.fragment_pixel, "fragment_pixel");
         DisplayShader(a_material.shaders.geometry, "geometry");
+        DisplayShader(a_material.shaders.compute, "compute");
 
 		ImGui::Text("Material CPU writeable: %d", a_material.cpu_writeable);
+		ImGui::Text("Instances: %u, stride: %u", a_material.instance_buffer.used_slots, a_material.instance_buffer.stride);
 		ImGui::Separator();
 
 		ImGui::Text("Descriptor Layout 2 (scene): %s", Material::PASS_TYPE_STR(a_material.pass_type));
@@ -6,6 +6,7 @@
 #include "BBThreadScheduler.hpp"
 #include "Console.hpp"
 #include "Gizmo.hpp"
+#include "MemoryProfilerWindow.hpp"
 #include "HID.h"
 
 #include <tuple>
@@ -13,6 +14,8 @@
 namespace BB
 {
 	constexpr size_t EDITOR_DEFAULT_MEMORY = mbSize * 4;
+	constexpr size_t EDITOR_MESH_RELOCATIONS_PER_FRAME = 8;
+	constexpr size_t EDITOR_ECS_COMMAND_MEMORY = kbSize * 4;
 
 	struct MemoryArena;
 	class Editor
@@ -38,7 +41,7 @@ namespace BB
 
 		bool DrawImgui(const RDescriptorIndex a_render_target, Viewport& a_viewport);
 
-		FreelistInterface m_editor_allocator;
+		TLSFInterface m_editor_allocator;
 
         void ImGuiDisplayEditor(MemoryArena& a_arena);
         void ImGuiDisplayGame(class GameInstance& a_game);
@@ -58,6 +61,7 @@ namespace BB
 
 		uint2 m_app_window_extent;
 		Console m_console;
+		MemoryProfilerWindow m_memory_profiler;
 
 		RImage m_render_target;
 		FixedArray<RDescriptorIndex, 3> m_render_target_descs;
@@ -83,9 +87,15 @@ namespace BB
 			FixedArray<DrawStruct, 8> draw_struct;
 			FixedArray<RFence, 8> fences;
 			FixedArray<uint64_t, 8> fence_values;
+			// async compute work the present has to wait on, an invalid fence means there is none.
+			FixedArray<RFence, 8> wait_fences;
+			FixedArray<uint64_t, 8> wait_values;
 			FixedArray<SceneFrame, 8> frame_results;
             FixedArray<bool, 8> success;
             FixedArray<StackString<64>, 8> error_message;
+			// meshes moved by the defragmenter this frame, every game ecs is patched before it runs.
+			FixedArray<MeshRelocation, EDITOR_MESH_RELOCATIONS_PER_FRAME> mesh_relocations;
+			size_t mesh_relocation_count = 0;
 
 			std::atomic<uint32_t> current_count = 0;
 			uint32_t back_buffer_index;
@@ -94,6 +104,11 @@ namespace BB
 
 		MasterMaterialHandle m_imgui_material;
 
+		// scanning every mesh each frame is not free, by default it only runs when asked for.
+		bool m_defragment_meshes = false;
+		// set by the button, runs until a frame has less then EDITOR_MESH_RELOCATIONS_PER_FRAME to move.
+		bool m_defragment_meshes_requested = false;
+
 		// input info
 		bool m_swallow_input;
 		float2 m_previous_mouse_pos;
@@ -104,6 +119,9 @@ namespace BB
 
         Gizmo m_gizmo;
 
+        // the entity tree is walked while the buttons are drawn, so creating and destroying from it is deferred to the next scene update.
+        ECSCommandBuffer m_entity_commands;
+
         struct Controls
         {
             InputChannelHandle channel;
@@ -0,0 +1,251 @@
+#include "MemoryProfilerWindow.hpp"
+#include "imgui.h"
+
+#include <algorithm>
+
+using namespace BB;
+
+struct MemoryProfilerRow
+{
+	uint32_t site_index;	// the first site of the group, for the name.
+	int64_t current_bytes;
+	int64_t current_count;
+	int64_t peak_bytes;		// the peak of every site added together when grouped.
+	int64_t churn_bytes;
+	int64_t churn_count;
+	int64_t growth_bytes;	// since the saved snapshot.
+	int64_t growth_count;
+};
+
+enum MEMORY_PROFILER_COLUMN : int
+{
+	COLUMN_NAME,
+	COLUMN_CURRENT,
+	COLUMN_COUNT,
+	COLUMN_PEAK,
+	COLUMN_CHURN,
+	COLUMN_CHURN_COUNT,
+	COLUMN_GROWTH,
+	COLUMN_GROWTH_COUNT
+};
+
+static const char* TagName(const MemoryAccountingSite& a_site)
+{
+	return a_site.tag_name ? a_site.tag_name : "untagged";
+}
+
+static int64_t RowSortValue(const MemoryProfilerRow& a_row, const int a_column)
+{
+	switch (a_column)
+	{
+	case COLUMN_COUNT:			return a_row.current_count;
+	case COLUMN_PEAK:			return a_row.peak_bytes;
+	case COLUMN_CHURN:			return a_row.churn_bytes;
+	case COLUMN_CHURN_COUNT:	return a_row.churn_count;
+	case COLUMN_GROWTH:			return a_row.growth_bytes;
+	case COLUMN_GROWTH_COUNT:	return a_row.growth_count;
+	default:					return a_row.current_bytes;
+	}
+}
+
+static float ToKb(const int64_t a_bytes)
+{
+	return static_cast<float>(a_bytes) / static_cast<float>(kbSize);
+}
+
+void MemoryProfilerWindow::Init(MemoryArena& a_arena)
+{
+	m_current = ArenaAllocType(a_arena, MemoryAccountingSnapshot);
+	m_last_frame = ArenaAllocType(a_arena, MemoryAccountingSnapshot);
+	m_saved = ArenaAllocType(a_arena, MemoryAccountingSnapshot);
+	m_peak_bytes = ArenaAllocArr(a_arena, int64_t, MEMORY_ACCOUNTING_MAX_SITES + 1);
+	MemoryAccountingTakeSnapshot(*m_last_frame);
+}
+
+void MemoryProfilerWindow::ImGuiShow(MemoryArenaTemp a_temp_arena)
+{
+	// sample even when the window is closed, the peaks only see the frames that are sampled.
+	MemoryAccountingTakeSnapshot(*m_current);
+	const uint32_t site_count = m_current->site_count;
+	for (uint32_t i = 0; i < site_count; i++)
+		m_peak_bytes[i] = Max(m_peak_bytes[i], m_current->sites[i].current_bytes);
+	m_peak_bytes[MEMORY_ACCOUNTING_OVERFLOW_SITE] = Max(m_peak_bytes[MEMORY_ACCOUNTING_OVERFLOW_SITE], m_current->sites[MEMORY_ACCOUNTING_OVERFLOW_SITE].current_bytes);
+
+	if (ImGui::Begin("Memory profiler", nullptr, ImGuiWindowFlags_MenuBar))
+	{
+		if (ImGui::BeginMenuBar())
+		{
+			if (ImGui::BeginMenu("Menu"))
+			{
+				if (ImGui::MenuItem("Take snapshot"))
+				{
+					memcpy(m_saved, m_current, sizeof(MemoryAccountingSnapshot));
+					m_has_saved = true;
+				}
+				if (ImGui::MenuItem("Clear snapshot", nullptr, false, m_has_saved))
+				{
+					m_has_saved = false;
+					m_only_growth = false;
+				}
+				if (ImGui::MenuItem("Reset peaks"))
+					memset(m_peak_bytes, 0, sizeof(int64_t) * (MEMORY_ACCOUNTING_MAX_SITES + 1));
+				ImGui::EndMenu();
+			}
+			ImGui::EndMenuBar();
+		}
+
+#ifndef _DEBUG_MEMORY
+		ImGui::TextUnformatted("allocation tracking: off, build with DEBUG_MEMORY_ENABLE to fill this window");
+#endif // _DEBUG_MEMORY
+
+		const char* group_names[] = { "site", "tag", "arena" };
+		int group_by = static_cast<int>(m_group_by);
+		if (ImGui::Combo("group by", &group_by, group_names, static_cast<int>(_countof(group_names))))
+			m_group_by = static_cast<GROUP_BY>(group_by);
+		if (m_has_saved)
+			ImGui::Checkbox("only show growth since the snapshot", &m_only_growth);
+
+		MemoryProfilerRow* rows = ArenaAllocArr(a_temp_arena, MemoryProfilerRow, site_count + 1);
+		uint32_t row_count = 0;
+		MemoryProfilerRow total{};
+
+		auto add_site = [&](const uint32_t a_site_index)
+		{
+			const MemoryAccountingCounters& current = m_current->sites[a_site_index];
+			if (current.total_count == 0)
+				return;
+			const MemoryAccountingCounters& last = m_last_frame->sites[a_site_index];
+			const MemoryAccountingSite& site = MemoryAccountingGetSite(a_site_index);
+
+			MemoryProfilerRow* row = nullptr;
+			for (uint32_t i = 0; i < row_count && m_group_by != GROUP_BY::SITE; i++)
+			{
+				const MemoryAccountingSite& row_site = MemoryAccountingGetSite(rows[i].site_index);
+				if ((m_group_by == GROUP_BY::TAG && strcmp(TagName(row_site), TagName(site)) == 0) ||
+					(m_group_by == GROUP_BY::ARENA && row_site.owner == site.owner))
+				{
+					row = &rows[i];
+					break;
+				}
+			}
+			if (row == nullptr)
+			{
+				row = &rows[row_count++];
+				*row = {};
+				row->site_index = a_site_index;
+			}
+
+			// the totals never go down, tagging only moves the current counters.
+			const int64_t churn_bytes = static_cast<int64_t>(current.total_bytes - last.total_bytes);
+			const int64_t churn_count = static_cast<int64_t>(current.total_count - last.total_count);
+			int64_t growth_bytes = 0;
+			int64_t growth_count = 0;
+			if (m_has_saved)
+			{
+				growth_bytes = current.current_bytes - m_saved->sites[a_site_index].current_bytes;
+				growth_count = current.current_count - m_saved->sites[a_site_index].current_count;
+			}
+
+			for (MemoryProfilerRow* sum : { row, &total })
+			{
+				sum->current_bytes += current.current_bytes;
+				sum->current_count += current.current_count;
+				sum->peak_bytes += m_peak_bytes[a_site_index];
+				sum->churn_bytes += churn_bytes;
+				sum->churn_count += churn_count;
+				sum->growth_bytes += growth_bytes;
+				sum->growth_count += growth_count;
+			}
+		};
+		for (uint32_t i = 0; i < site_count; i++)
+			add_site(i);
+		add_site(MEMORY_ACCOUNTING_OVERFLOW_SITE);
+
+		ImGui::Text("live: %.1f kb in %lld allocations", ToKb(total.current_bytes), static_cast<long long>(total.current_count));
+		ImGui::Text("this frame: %.1f kb in %lld allocations", ToKb(total.churn_bytes), static_cast<long long>(total.churn_count));
+		if (m_has_saved)
+			ImGui::Text("since snapshot: %.1f kb in %lld allocations", ToKb(total.growth_bytes), static_cast<long long>(total.growth_count));
+
+		const int columns = m_has_saved ? 8 : 6;
+		if (ImGui::BeginTable("memory sites", columns, ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+		{
+			ImGui::TableSetupScrollFreeze(0, 1);
+			const char* name_columns[] = { "site", "tag", "arena created at" };
+			ImGui::TableSetupColumn(name_columns[static_cast<int>(m_group_by)], ImGuiTableColumnFlags_NoSort);
+			ImGui::TableSetupColumn("current kb", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+			ImGui::TableSetupColumn("count", ImGuiTableColumnFlags_PreferSortDescending);
+			ImGui::TableSetupColumn("peak kb", ImGuiTableColumnFlags_PreferSortDescending);
+			ImGui::TableSetupColumn("kb this frame", ImGuiTableColumnFlags_PreferSortDescending);
+			ImGui::TableSetupColumn("allocs this frame", ImGuiTableColumnFlags_PreferSortDescending);
+			if (m_has_saved)
+			{
+				ImGui::TableSetupColumn("kb since snapshot", ImGuiTableColumnFlags_PreferSortDescending);
+				ImGui::TableSetupColumn("allocs since snapshot", ImGuiTableColumnFlags_PreferSortDescending);
+			}
+			ImGui::TableHeadersRow();
+
+			int sort_column = COLUMN_CURRENT;
+			bool ascending = false;
+			if (const ImGuiTableSortSpecs* sort_specs = ImGui::TableGetSortSpecs())
+			{
+				if (sort_specs->SpecsCount > 0)
+				{
+					sort_column = sort_specs->Specs[0].ColumnIndex;
+					ascending = sort_specs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+				}
+			}
+			std::sort(rows, rows + row_count, [sort_column, ascending](const MemoryProfilerRow& a_lhs, const MemoryProfilerRow& a_rhs)
+			{
+				const int64_t lhs = RowSortValue(a_lhs, sort_column);
+				const int64_t rhs = RowSortValue(a_rhs, sort_column);
+				return ascending ? lhs < rhs : lhs > rhs;
+			});
+
+			for (uint32_t i = 0; i < row_count; i++)
+			{
+				const MemoryProfilerRow& row = rows[i];
+				if (m_only_growth && row.growth_bytes <= 0)
+					continue;
+				const MemoryAccountingSite& site = MemoryAccountingGetSite(row.site_index);
+
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(COLUMN_NAME);
+				if (m_group_by == GROUP_BY::ARENA)
+				{
+					if (site.owner_file)
+						ImGui::Text("%s:%d", site.owner_file, site.owner_line);
+					else
+						ImGui::TextUnformatted(site.owner ? "unknown" : TagName(site));
+				}
+				else if (m_group_by == GROUP_BY::SITE && site.file)
+					ImGui::Text("%s  %s:%d", TagName(site), site.file, site.line);
+				else
+					ImGui::TextUnformatted(TagName(site));
+
+				ImGui::TableSetColumnIndex(COLUMN_CURRENT);
+				ImGui::Text("%.1f", ToKb(row.current_bytes));
+				ImGui::TableSetColumnIndex(COLUMN_COUNT);
+				ImGui::Text("%lld", static_cast<long long>(row.current_count));
+				ImGui::TableSetColumnIndex(COLUMN_PEAK);
+				ImGui::Text("%.1f", ToKb(row.peak_bytes));
+				ImGui::TableSetColumnIndex(COLUMN_CHURN);
+				ImGui::Text("%.1f", ToKb(row.churn_bytes));
+				ImGui::TableSetColumnIndex(COLUMN_CHURN_COUNT);
+				ImGui::Text("%lld", static_cast<long long>(row.churn_count));
+				if (m_has_saved)
+				{
+					ImGui::TableSetColumnIndex(COLUMN_GROWTH);
+					ImGui::Text("%+.1f", ToKb(row.growth_bytes));
+					ImGui::TableSetColumnIndex(COLUMN_GROWTH_COUNT);
+					ImGui::Text("%+lld", static_cast<long long>(row.growth_count));
+				}
+			}
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+
+	MemoryAccountingSnapshot* last_frame = m_last_frame;
+	m_last_frame = m_current;
+	m_current = last_frame;
+}
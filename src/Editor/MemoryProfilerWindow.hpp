@@ -0,0 +1,36 @@
+#pragma once
+#include "Common.h"
+#include "MemoryArena.hpp"
+#include "MemoryAccounting.hpp"
+
+namespace BB
+{
+	// shows the MemoryAccounting counters, filled by MemoryArena allocations when _DEBUG_MEMORY is on.
+	class MemoryProfilerWindow
+	{
+	public:
+		void Init(MemoryArena& a_arena);
+
+		// call every frame, the churn and peak come from the difference with the last call.
+		void ImGuiShow(MemoryArenaTemp a_temp_arena);
+
+	private:
+		enum class GROUP_BY : int
+		{
+			SITE,
+			TAG,
+			ARENA
+		};
+
+		MemoryAccountingSnapshot* m_current;
+		MemoryAccountingSnapshot* m_last_frame;
+		// taken by hand, the difference with it shows what grew since then.
+		MemoryAccountingSnapshot* m_saved;
+		bool m_has_saved = false;
+		bool m_only_growth = false;
+		GROUP_BY m_group_by = GROUP_BY::TAG;
+
+		// sampled once a frame per site.
+		int64_t* m_peak_bytes;
+	};
+}
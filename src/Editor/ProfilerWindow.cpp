@@ -21,7 +21,7 @@ void BB::ImGuiShowProfiler(MemoryArenaTemp temp_arena)
 		const ConstSlice<ProfileResult> profile_results = GetProfileResultsList();
 		for (size_t i = 0; i < profile_results.size(); i++)
 		{
-			if (ImGui::CollapsingHeader(profile_results[i].name.c_str()))
+			if (ImGui::CollapsingHeader(StringAtomGetCStr(profile_results[i].name)))
 			{
 				ImGui::Text("Average Time in miliseconds: %.6f", profile_results[i].average_time);
 				ImGui::PushID(static_cast<int>(i));
@@ -36,6 +36,8 @@ int main(int argc, char** argv)
         engine_options.max_shader_effects = 64;
         engine_options.max_material_instances = 256;
         engine_options.enable_debug = true;
+        engine_options.ecs_archetype_storage = false;
+        engine_options.job_thread_count = 0;
         engine_options.debug_options.max_profiler_entries = 64;
 
         GraphicOptions graphic_options;
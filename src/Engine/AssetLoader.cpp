@@ -55,20 +55,6 @@ static bool IsPathImage(const StringView a_view)
 	return false;
 }
 
-//crappy hash, don't care for now.
-static uint64_t StringHash(const StringView a_view)
-{
-	uint64_t hash = 5381;
-
-	for (size_t i = 0; i < a_view.size(); i++)
-	{
-		const uint64_t c = static_cast<uint64_t>(a_view[i]);
-		hash = ((hash << 5) + hash) + c;
-	}
-
-	return hash;
-}
-
 static uint64_t TurboCrappyImageHash(const void* a_pixels, const size_t a_byte_size)
 {
 	size_t remaining = a_byte_size;
@@ -211,7 +197,7 @@ struct AssetManager
     PathString asset_dir;
 
 	BBRWLock allocator_lock;
-	FreelistInterface allocator;
+	TLSFInterface allocator;
 
 	// asset storage
 	BBRWLock asset_lock;
@@ -245,6 +231,8 @@ struct AssetManager
 
 	IconGigaTexture icons_storage;
 	GPUUploader gpu_uploader;
+
+	bool compress_vertices;
 };
 static AssetManager* s_asset_manager;
 
@@ -252,14 +240,18 @@ template<typename T>
 static T* AssetAlloc()
 {
 	BBRWLockScopeWrite(s_asset_manager->allocator_lock);
-	return reinterpret_cast<T*>(s_asset_manager->allocator.Alloc(sizeof(T), alignof(T)));
+	T* ptr = reinterpret_cast<T*>(s_asset_manager->allocator.Alloc(sizeof(T), alignof(T)));
+	BB_ASSERT(ptr, "asset allocator out of memory");
+	return ptr;
 }
 
 template<typename T>
 static T* AssetAllocArr(const size_t a_size)
 {
 	BBRWLockScopeWrite(s_asset_manager->allocator_lock);
-	return reinterpret_cast<T*>(s_asset_manager->allocator.Alloc(sizeof(T) * a_size, alignof(T)));
+	T* ptr = reinterpret_cast<T*>(s_asset_manager->allocator.Alloc(sizeof(T) * a_size, alignof(T)));
+	BB_ASSERT(ptr, "asset allocator out of memory");
+	return ptr;
 }
 
 static void AssetFree(const void* a_ptr)
@@ -378,7 +370,7 @@ static void UploadAndWaitAssets(MemoryArena& a_thread_arena, void*)
 		const uint64_t asset_fence_value = uploader.next_fence_value.fetch_add(1);
 		cmd_pool.EndCommandList(list);
 		uint64_t mock_fence;	// TODO, remove this
-		bool success = ExecuteTransferCommands(Slice(&cmd_pool, 1), &uploader.fence, &asset_fence_value, 1, mock_fence);
+		bool success = ExecuteTransferCommands(Slice(&cmd_pool, 1), &uploader.fence, &asset_fence_value, 1, nullptr, nullptr, 0, mock_fence);
 		BB_ASSERT(success, "failed to execute transfer commands");
 	}
 	else
@@ -389,11 +381,243 @@ static void UploadAndWaitAssets(MemoryArena& a_thread_arena, void*)
 	uploading_assets = false;
 }
 
-static GPUFenceValue CreateMesh(MemoryArena& a_temp_arena, const CreateMeshInfo& a_create_info, Mesh& a_out_mesh)
+enum class MESH_STREAM : uint32_t
+{
+	POSITION,
+	NORMAL,
+	UV,
+	COLOR,
+	TANGENT,
+	ENUM_SIZE
+};
+
+struct MeshVertexStreams
+{
+	const void* data[static_cast<uint32_t>(MESH_STREAM::ENUM_SIZE)];
+	size_t size[static_cast<uint32_t>(MESH_STREAM::ENUM_SIZE)];
+	uint32_t vertex_format;
+};
+
+static uint16_t QuantizeUnorm16(const float a_value)
+{
+	return static_cast<uint16_t>(Clampf(a_value, 0.f, 1.f) * 65535.f + 0.5f);
+}
+
+static int16_t QuantizeSnorm16(const float a_value)
+{
+	const float rounded = Clampf(a_value, -1.f, 1.f) * 32767.f;
+	return static_cast<int16_t>(rounded >= 0.f ? rounded + 0.5f : rounded - 0.5f);
+}
+
+static uint8_t QuantizeUnorm8(const float a_value)
+{
+	return static_cast<uint8_t>(Clampf(a_value, 0.f, 1.f) * 255.f + 0.5f);
+}
+
+static uint16_t FloatToHalf(const float a_value)
+{
+	uint32_t bits;
+	memcpy(&bits, &a_value, sizeof(bits));
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t float_exponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (float_exponent == 0xFF)
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+	const int exponent = static_cast<int>(float_exponent) - 127 + 15;
+	if (exponent >= 31)
+		return static_cast<uint16_t>(sign | 0x7C00);
+
+	// too small for a normal half, becomes a denormal or 0.
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return static_cast<uint16_t>(sign);
+		mantissa |= 0x800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t half_mantissa = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1)
+			++half_mantissa;
+		return static_cast<uint16_t>(sign | half_mantissa);
+	}
+
+	// rounding can carry into the exponent, that is still the correct half.
+	uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000)
+		++half;
+	return static_cast<uint16_t>(half);
+}
+
+static float HalfToFloat(const uint16_t a_half)
+{
+	const uint32_t sign = static_cast<uint32_t>(a_half & 0x8000) << 16;
+	const uint32_t exponent = (a_half >> 10) & 0x1F;
+	const uint32_t mantissa = a_half & 0x3FF;
+
+	uint32_t bits;
+	if (exponent == 0)
+	{
+		const float denormal = static_cast<float>(mantissa) / 16777216.f;
+		return sign ? -denormal : denormal;
+	}
+	else if (exponent == 31)
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	else
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// octahedral encoding, maps the unit sphere onto a square and stores it as two snorm16 values.
+static uint32_t OctEncode(const float3 a_direction)
+{
+	const float length = fabsf(a_direction.x) + fabsf(a_direction.y) + fabsf(a_direction.z);
+	if (length == 0.f)
+		return 0;
+
+	float x = a_direction.x / length;
+	float y = a_direction.y / length;
+	if (a_direction.z < 0.f)
+	{
+		const float old_x = x;
+		x = (1.f - fabsf(y)) * (old_x >= 0.f ? 1.f : -1.f);
+		y = (1.f - fabsf(old_x)) * (y >= 0.f ? 1.f : -1.f);
+	}
+	return static_cast<uint16_t>(QuantizeSnorm16(x)) | (static_cast<uint32_t>(static_cast<uint16_t>(QuantizeSnorm16(y))) << 16);
+}
+
+// same as OctDecode in common.hlsl
+static float3 OctDecode(const uint32_t a_packed)
+{
+	const float x = Max(static_cast<float>(static_cast<int16_t>(a_packed & 0xFFFF)) / 32767.f, -1.f);
+	const float y = Max(static_cast<float>(static_cast<int16_t>(a_packed >> 16)) / 32767.f, -1.f);
+	float3 direction = float3(x, y, 1.f - fabsf(x) - fabsf(y));
+	const float t = Clampf(-direction.z, 0.f, 1.f);
+	direction.x += direction.x >= 0.f ? -t : t;
+	direction.y += direction.y >= 0.f ? -t : t;
+	return Float3Normalize(direction);
+}
+
+static float AngleBetweenDegrees(const float3 a_source, const float3 a_decoded)
+{
+	const float length = Float3Length(a_source);
+	if (length == 0.f)
+		return 0.f;
+	const float cos_angle = Clampf(Float3Dot(a_source * (1.f / length), a_decoded), -1.f, 1.f);
+	return acosf(cos_angle) * (180.f / PI_F);
+}
+
+// positions become 16 bit unorm inside the bounds of the mesh, normals and tangents are octahedral snorm16,
+// uvs are halfs and colors rgba8. all streams are 4 byte aligned for the ByteAddressBuffer loads.
+static VertexCompressionReport CompressMeshVertices(MemoryArena& a_temp_arena, const CreateMeshInfo& a_create_info, MeshVertexStreams& a_streams)
+{
+	VertexCompressionReport report{};
+
+	// primitives share the vertex streams, so the bounds are those of the whole mesh.
+	float3 bounds_min = float3(FLT_MAX);
+	float3 bounds_max = float3(-FLT_MAX);
+	for (size_t i = 0; i < a_create_info.positions.size(); i++)
+	{
+		bounds_min = Float3Min(bounds_min, a_create_info.positions[i]);
+		bounds_max = Float3Max(bounds_max, a_create_info.positions[i]);
+	}
+	if (a_create_info.positions.size() == 0)
+		bounds_min = bounds_max = float3(0.f);
+
+	const size_t position_size = sizeof(CompressedPositionHeader) + sizeof(uint2) * a_create_info.positions.size();
+	CompressedPositionHeader* header = reinterpret_cast<CompressedPositionHeader*>(ArenaAlloc(a_temp_arena, position_size, alignof(CompressedPositionHeader)));
+	header->bounds_min = bounds_min;
+	header->bounds_extent = bounds_max - bounds_min;
+	header->pad0 = 0.f;
+	header->pad1 = 0.f;
+
+	const float3 extent = header->bounds_extent;
+	const float3 inverse_extent = float3(
+		extent.x > 0.f ? 1.f / extent.x : 0.f,
+		extent.y > 0.f ? 1.f / extent.y : 0.f,
+		extent.z > 0.f ? 1.f / extent.z : 0.f);
+
+	uint2* positions = reinterpret_cast<uint2*>(header + 1);
+	double total_position_error = 0.0;
+	for (size_t i = 0; i < a_create_info.positions.size(); i++)
+	{
+		const float3 source = a_create_info.positions[i];
+		const float3 unorm = (source - bounds_min) * inverse_extent;
+		const uint16_t x = QuantizeUnorm16(unorm.x);
+		const uint16_t y = QuantizeUnorm16(unorm.y);
+		const uint16_t z = QuantizeUnorm16(unorm.z);
+		positions[i] = uint2(x | (static_cast<uint32_t>(y) << 16), z);
+
+		const float3 decoded = bounds_min + float3(x, y, z) * (1.f / 65535.f) * extent;
+		const float error = Float3Length(decoded - source);
+		report.max_position_error = Max(report.max_position_error, error);
+		total_position_error += error;
+	}
+	if (a_create_info.positions.size())
+		report.average_position_error = static_cast<float>(total_position_error / static_cast<double>(a_create_info.positions.size()));
+
+	uint32_t* normals = ArenaAllocArr(a_temp_arena, uint32_t, a_create_info.normals.size());
+	for (size_t i = 0; i < a_create_info.normals.size(); i++)
+	{
+		normals[i] = OctEncode(a_create_info.normals[i]);
+		report.max_normal_error = Max(report.max_normal_error, AngleBetweenDegrees(a_create_info.normals[i], OctDecode(normals[i])));
+	}
+
+	uint32_t* tangents = ArenaAllocArr(a_temp_arena, uint32_t, a_create_info.tangents.size());
+	for (size_t i = 0; i < a_create_info.tangents.size(); i++)
+	{
+		tangents[i] = OctEncode(a_create_info.tangents[i]);
+		report.max_tangent_error = Max(report.max_tangent_error, AngleBetweenDegrees(a_create_info.tangents[i], OctDecode(tangents[i])));
+	}
+
+	uint32_t* uvs = ArenaAllocArr(a_temp_arena, uint32_t, a_create_info.uvs.size());
+	for (size_t i = 0; i < a_create_info.uvs.size(); i++)
+	{
+		const uint16_t u = FloatToHalf(a_create_info.uvs[i].x);
+		const uint16_t v = FloatToHalf(a_create_info.uvs[i].y);
+		uvs[i] = u | (static_cast<uint32_t>(v) << 16);
+		report.max_uv_error = Max(report.max_uv_error, Max(fabsf(HalfToFloat(u) - a_create_info.uvs[i].x), fabsf(HalfToFloat(v) - a_create_info.uvs[i].y)));
+	}
+
+	uint32_t* colors = ArenaAllocArr(a_temp_arena, uint32_t, a_create_info.colors.size());
+	for (size_t i = 0; i < a_create_info.colors.size(); i++)
+	{
+		const float4 source = a_create_info.colors[i];
+		const uint8_t channels[4] = { QuantizeUnorm8(source.x), QuantizeUnorm8(source.y), QuantizeUnorm8(source.z), QuantizeUnorm8(source.w) };
+		colors[i] = channels[0] | (static_cast<uint32_t>(channels[1]) << 8) | (static_cast<uint32_t>(channels[2]) << 16) | (static_cast<uint32_t>(channels[3]) << 24);
+		const float4 decoded = float4(channels[0], channels[1], channels[2], channels[3]) * (1.f / 255.f);
+		report.max_color_error = Max(report.max_color_error, Max(Max(fabsf(decoded.x - source.x), fabsf(decoded.y - source.y)), Max(fabsf(decoded.z - source.z), fabsf(decoded.w - source.w))));
+	}
+
+	a_streams.data[static_cast<uint32_t>(MESH_STREAM::POSITION)] = header;
+	a_streams.size[static_cast<uint32_t>(MESH_STREAM::POSITION)] = position_size;
+	a_streams.data[static_cast<uint32_t>(MESH_STREAM::NORMAL)] = normals;
+	a_streams.size[static_cast<uint32_t>(MESH_STREAM::NORMAL)] = sizeof(uint32_t) * a_create_info.normals.size();
+	a_streams.data[static_cast<uint32_t>(MESH_STREAM::UV)] = uvs;
+	a_streams.size[static_cast<uint32_t>(MESH_STREAM::UV)] = sizeof(uint32_t) * a_create_info.uvs.size();
+	a_streams.data[static_cast<uint32_t>(MESH_STREAM::COLOR)] = colors;
+	a_streams.size[static_cast<uint32_t>(MESH_STREAM::COLOR)] = sizeof(uint32_t) * a_create_info.colors.size();
+	a_streams.data[static_cast<uint32_t>(MESH_STREAM::TANGENT)] = tangents;
+	a_streams.size[static_cast<uint32_t>(MESH_STREAM::TANGENT)] = sizeof(uint32_t) * a_create_info.tangents.size();
+	a_streams.vertex_format = VERTEX_FORMAT_COMPRESSED;
+
+	report.uncompressed_size = static_cast<uint32_t>(a_create_info.positions.sizeInBytes() + a_create_info.normals.sizeInBytes() + a_create_info.uvs.sizeInBytes() + a_create_info.colors.sizeInBytes() + a_create_info.tangents.sizeInBytes());
+	report.compressed_size = 0;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MESH_STREAM::ENUM_SIZE); i++)
+		report.compressed_size += static_cast<uint32_t>(a_streams.size[i]);
+	return report;
+}
+
+static GPUFenceValue UploadMesh(MemoryArena& a_temp_arena, const MeshVertexStreams& a_streams, const ConstSlice<uint32_t> a_indices, Model::Mesh& a_out_mesh)
 {
 	GPUUploader& uploader = s_asset_manager->gpu_uploader;
 
-	const size_t vertex_buffer_size = a_create_info.positions.sizeInBytes() + a_create_info.normals.sizeInBytes() + a_create_info.uvs.sizeInBytes() + a_create_info.colors.sizeInBytes() + a_create_info.tangents.sizeInBytes();
+	size_t vertex_buffer_size = 0;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MESH_STREAM::ENUM_SIZE); i++)
+		vertex_buffer_size += a_streams.size[i];
 
 	auto memcpy_and_advance = [](const GPUUploadRingAllocator& a_buffer, const size_t a_dst_offset, const void* a_src_data, const size_t a_src_size)
 		{
@@ -403,24 +627,28 @@ static GPUFenceValue CreateMesh(MemoryArena& a_temp_arena, const CreateMeshInfo&
 		};
 
 	const GPUFenceValue fence_value = GPUFenceValue(uploader.next_fence_value.load());
-	const size_t vertex_start_offset = uploader.upload_buffer.AllocateUploadMemory(vertex_buffer_size + a_create_info.indices.sizeInBytes(), fence_value);
+	const size_t vertex_start_offset = uploader.upload_buffer.AllocateUploadMemory(vertex_buffer_size + a_indices.sizeInBytes(), fence_value);
 	if (vertex_start_offset == size_t(-1))
 	{
 		UploadAndWaitAssets(a_temp_arena, nullptr);
-		return CreateMesh(a_temp_arena, a_create_info, a_out_mesh);
+		return UploadMesh(a_temp_arena, a_streams, a_indices, a_out_mesh);
 	}
 
-	const size_t normal_offset = memcpy_and_advance(uploader.upload_buffer, vertex_start_offset, a_create_info.positions.data(), a_create_info.positions.sizeInBytes());
-	const size_t uv_offset = memcpy_and_advance(uploader.upload_buffer, normal_offset, a_create_info.normals.data(), a_create_info.normals.sizeInBytes());
-	const size_t color_offset = memcpy_and_advance(uploader.upload_buffer, uv_offset, a_create_info.uvs.data(), a_create_info.uvs.sizeInBytes());
-	const size_t tangent_offset = memcpy_and_advance(uploader.upload_buffer, color_offset, a_create_info.colors.data(), a_create_info.colors.sizeInBytes());
-	const size_t index_offset = memcpy_and_advance(uploader.upload_buffer, tangent_offset, a_create_info.tangents.data(), a_create_info.tangents.sizeInBytes());
+	size_t stream_offsets[static_cast<uint32_t>(MESH_STREAM::ENUM_SIZE)];
+	size_t index_offset = vertex_start_offset;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MESH_STREAM::ENUM_SIZE); i++)
+	{
+		stream_offsets[i] = index_offset;
+		index_offset = memcpy_and_advance(uploader.upload_buffer, index_offset, a_streams.data[i], a_streams.size[i]);
+	}
 
 	// now the indices
-	memcpy_and_advance(uploader.upload_buffer, index_offset, a_create_info.indices.data(), a_create_info.indices.sizeInBytes());
+	memcpy_and_advance(uploader.upload_buffer, index_offset, a_indices.data(), a_indices.sizeInBytes());
 
-	const GPUBufferView vertex_buffer = AllocateFromVertexBuffer(vertex_buffer_size);
-	const GPUBufferView index_buffer = a_create_info.indices.size() ? AllocateFromIndexBuffer(a_create_info.indices.sizeInBytes()) : GPUBufferView();
+	OffsetAllocation vertex_allocation;
+	OffsetAllocation index_allocation;
+	const GPUBufferView vertex_buffer = AllocateFromVertexBuffer(vertex_buffer_size, vertex_allocation);
+	const GPUBufferView index_buffer = a_indices.size() ? AllocateFromIndexBuffer(a_indices.sizeInBytes(), index_allocation) : GPUBufferView();
 
 	UploadDataMesh task{};
 	task.vertex_region.size = vertex_buffer.size;
@@ -433,17 +661,49 @@ static GPUFenceValue CreateMesh(MemoryArena& a_temp_arena, const CreateMeshInfo&
 	BB_ASSERT(success, "failed to add mesh to uploadmesh tasks");
 
 	Mesh mesh{};
-	mesh.vertex_position_offset = vertex_buffer.offset;
-	mesh.vertex_normal_offset = vertex_buffer.offset + normal_offset - vertex_start_offset;
-	mesh.vertex_uv_offset = vertex_buffer.offset + uv_offset - vertex_start_offset;
-	mesh.vertex_color_offset = vertex_buffer.offset + color_offset - vertex_start_offset;
-	mesh.vertex_tangent_offset = vertex_buffer.offset + tangent_offset - vertex_start_offset;
+	mesh.vertex_position_offset = vertex_buffer.offset + stream_offsets[static_cast<uint32_t>(MESH_STREAM::POSITION)] - vertex_start_offset;
+	mesh.vertex_normal_offset = vertex_buffer.offset + stream_offsets[static_cast<uint32_t>(MESH_STREAM::NORMAL)] - vertex_start_offset;
+	mesh.vertex_uv_offset = vertex_buffer.offset + stream_offsets[static_cast<uint32_t>(MESH_STREAM::UV)] - vertex_start_offset;
+	mesh.vertex_color_offset = vertex_buffer.offset + stream_offsets[static_cast<uint32_t>(MESH_STREAM::COLOR)] - vertex_start_offset;
+	mesh.vertex_tangent_offset = vertex_buffer.offset + stream_offsets[static_cast<uint32_t>(MESH_STREAM::TANGENT)] - vertex_start_offset;
 	mesh.index_buffer_offset = index_buffer.offset;
+	mesh.vertex_format = a_streams.vertex_format;
 
-	a_out_mesh = mesh;
+	a_out_mesh.mesh = mesh;
+	a_out_mesh.vertex_allocation = vertex_allocation;
+	a_out_mesh.index_allocation = index_allocation;
+	a_out_mesh.upload_fence_value = fence_value;
 	return fence_value;
 }
 
+static GPUFenceValue CreateMesh(MemoryArena& a_temp_arena, const CreateMeshInfo& a_create_info, Model::Mesh& a_out_mesh)
+{
+	MeshVertexStreams streams;
+	a_out_mesh.compression_report = {};
+	if (s_asset_manager->compress_vertices)
+	{
+		a_out_mesh.compression_report = CompressMeshVertices(a_temp_arena, a_create_info, streams);
+		// half uvs lose precision on heavily tiled uvs, more then a texel of a 4k texture is visible.
+		BB_WARNING(a_out_mesh.compression_report.max_uv_error < 1.f / 4096.f, "vertex compression uv error is larger then a 4k texel", WarningType::LOW);
+	}
+	else
+	{
+		streams.data[static_cast<uint32_t>(MESH_STREAM::POSITION)] = a_create_info.positions.data();
+		streams.size[static_cast<uint32_t>(MESH_STREAM::POSITION)] = a_create_info.positions.sizeInBytes();
+		streams.data[static_cast<uint32_t>(MESH_STREAM::NORMAL)] = a_create_info.normals.data();
+		streams.size[static_cast<uint32_t>(MESH_STREAM::NORMAL)] = a_create_info.normals.sizeInBytes();
+		streams.data[static_cast<uint32_t>(MESH_STREAM::UV)] = a_create_info.uvs.data();
+		streams.size[static_cast<uint32_t>(MESH_STREAM::UV)] = a_create_info.uvs.sizeInBytes();
+		streams.data[static_cast<uint32_t>(MESH_STREAM::COLOR)] = a_create_info.colors.data();
+		streams.size[static_cast<uint32_t>(MESH_STREAM::COLOR)] = a_create_info.colors.sizeInBytes();
+		streams.data[static_cast<uint32_t>(MESH_STREAM::TANGENT)] = a_create_info.tangents.data();
+		streams.size[static_cast<uint32_t>(MESH_STREAM::TANGENT)] = a_create_info.tangents.sizeInBytes();
+		streams.vertex_format = VERTEX_FORMAT_FLOAT;
+	}
+
+	return UploadMesh(a_temp_arena, streams, a_create_info.indices, a_out_mesh);
+}
+
 static GPUFenceValue WriteTexture(MemoryArena& a_temp_arena, const WriteImageInfo& a_write_info)
 {
 	BB_ASSERT(a_write_info.image_info.extent.x != 0 && a_write_info.image_info.extent.y != 0, "one extent value is 0");
@@ -811,6 +1071,7 @@ void Asset::InitializeAssetManager(MemoryArena& a_arena, const AssetManagerInitI
 	s_asset_manager->linear_asset_table.Init(a_arena, a_init_info.asset_count);
 
 	s_asset_manager->gpu_tasks_queue.Init(a_arena, GPU_TASK_QUEUE_SIZE);
+	s_asset_manager->compress_vertices = a_init_info.compress_vertices;
 
 	s_asset_manager->icons_storage.max_slots = a_init_info.asset_count;
 	s_asset_manager->icons_storage.next_index = 0;
@@ -979,6 +1240,52 @@ static PathString CreateModelPath(const StringView& a_model_path)
 	return path;
 }
 
+// reads all files in one async batch so the disk gets every request at once, instead of a blocking read per file.
+// returns false if a file could not be opened or read, the caller then falls back to the blocking loaders.
+static bool ReadFilesAsync(MemoryArena& a_arena, const ConstSlice<PathString> a_paths, Buffer* a_out_buffers)
+{
+	const uint32_t file_count = static_cast<uint32_t>(a_paths.size());
+	OSFileHandle* files = ArenaAllocArr(a_arena, OSFileHandle, file_count);
+	OSAsyncReadInfo* read_infos = ArenaAllocArr(a_arena, OSAsyncReadInfo, file_count);
+	OSAsyncRead* reads = ArenaAllocArr(a_arena, OSAsyncRead, file_count);
+
+	bool success = true;
+	uint32_t opened_count = 0;
+	for (; opened_count < file_count; opened_count++)
+	{
+		const OSFileHandle file = OSLoadFile(a_paths[opened_count].c_str());
+		if (!OSFileIsValid(file))
+		{
+			success = false;
+			break;
+		}
+		files[opened_count] = file;
+		OSAsyncReadInfo& read_info = read_infos[opened_count];
+		read_info.file = file;
+		read_info.file_offset = 0;
+		read_info.size = GetOSFileSize(file);
+		read_info.buffer = ArenaAlloc(a_arena, read_info.size, 16);
+	}
+
+	if (success && OSSubmitAsyncReads(read_infos, file_count, reads))
+	{
+		for (uint32_t i = 0; i < file_count; i++)
+		{
+			size_t bytes_read = 0;
+			if (OSWaitAsyncRead(reads[i], &bytes_read) != OS_ASYNC_READ_STATUS::DONE || bytes_read != read_infos[i].size)
+				success = false;
+			a_out_buffers[i].data = read_infos[i].buffer;
+			a_out_buffers[i].size = bytes_read;
+		}
+	}
+	else
+		success = false;
+
+	for (uint32_t i = 0; i < opened_count; i++)
+		CloseOSFile(files[i]);
+	return success;
+}
+
 static inline void CreateImage_func(const StringView& a_name, const uint32_t a_width, const uint32_t a_height, const uint16_t a_array_layers, const IMAGE_FORMAT a_format, const IMAGE_VIEW_TYPE a_view_type, RImage& a_out_image, RDescriptorIndex& a_out_index)
 {
 	ImageCreateInfo create_image_info;
@@ -1087,13 +1394,25 @@ const Image& Asset::LoadImageArrayDisk(MemoryArena& a_temp_arena, const StringVi
 		return *asset.image;
 	asset.name = a_name;
 
+	const uint32_t array_layers = static_cast<uint32_t>(a_paths.size());
+	PathString* layer_paths = ArenaAllocArr(a_temp_arena, PathString, array_layers);
+	for (uint32_t i = 0; i < array_layers; i++)
+		layer_paths[i] = CreateTexturePath(a_paths[i]);
+	Buffer* layer_files = ArenaAllocArr(a_temp_arena, Buffer, array_layers);
+	const bool files_read = ReadFilesAsync(a_temp_arena, ConstSlice<PathString>(layer_paths, array_layers), layer_files);
+	auto LoadLayerPixels = [&](const uint32_t a_layer, int& a_width, int& a_height, int& a_channels) -> stbi_uc*
+	{
+		if (files_read)
+			return stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(layer_files[a_layer].data), static_cast<int>(layer_files[a_layer].size), &a_width, &a_height, &a_channels, 4);
+		return stbi_load(layer_paths[a_layer].c_str(), &a_width, &a_height, &a_channels, 4);
+	};
+
 	int width = 0, height = 0, channels = 0;
-	stbi_uc* pixels = stbi_load(CreateTexturePath(a_paths[0]).c_str(), &width, &height, &channels, 4);
+	stbi_uc* pixels = LoadLayerPixels(0, width, height, channels);
 	RImage gpu_image;
 	RDescriptorIndex descriptor_index;
 	const uint32_t uwidth = static_cast<uint32_t>(width);
 	const uint32_t uheight = static_cast<uint32_t>(height);
-	const uint32_t array_layers = static_cast<uint32_t>(a_paths.size());
 	CreateImage_func(asset.name.GetView(), uwidth, uheight, static_cast<uint16_t>(array_layers), a_format, a_is_cube_map ? IMAGE_VIEW_TYPE::CUBE : IMAGE_VIEW_TYPE::TYPE_2D_ARRAY, gpu_image, descriptor_index);
 
 	WriteImageInfo write_info{};
@@ -1110,7 +1429,7 @@ const Image& Asset::LoadImageArrayDisk(MemoryArena& a_temp_arena, const StringVi
 	for (uint32_t i = 1; i < array_layers; i++)
 	{
 		STBI_FREE(pixels);
-		pixels = stbi_load(CreateTexturePath(a_paths[i]).c_str(), &width, &height, &channels, 4);
+		pixels = LoadLayerPixels(i, width, height, channels);
 
 		BB_ASSERT(uwidth == static_cast<uint32_t>(width) && uheight == static_cast<uint32_t>(height), "image array are not the same dimensions");
 
@@ -1763,12 +2082,35 @@ static void LoadglTFMesh(MemoryArena& a_temp_arena, const cgltf_mesh& a_cgltf_me
 			create_mesh.colors = ConstSlice<float4>(colors, vertex_count);
 		}
 	}
+	// the indices can point straight into the gltf data, meshlets reorder them so copy them first.
+	uint32_t* meshlet_indices = ArenaAllocArr(a_temp_arena, uint32_t, create_mesh.indices.size());
+	memcpy(meshlet_indices, create_mesh.indices.data(), create_mesh.indices.sizeInBytes());
+
     for (size_t prim_index = 0; prim_index < mesh.primitives_count; prim_index++)
     {
         Model::Primitive& model_prim = a_mesh.primitives[prim_index];
         model_prim.bounding_box = GetBoundingBoxPrimitive(create_mesh.positions, create_mesh.indices, model_prim.start_index, model_prim.index_count);
+		model_prim.meshlets = ConstSlice<Meshlet>();
+
+		if (model_prim.index_count / 3 <= MESHLET_MAX_TRIANGLES || model_prim.start_index + model_prim.index_count > create_mesh.indices.size())
+			continue;
+
+		// back faces of double sided materials are visible, so those can only be frustum culled.
+		const bool cone_culling = !mesh.primitives[prim_index].material->double_sided;
+		MemoryArenaScope(a_temp_arena)
+		{
+			const Slice<Meshlet> meshlets = BuildMeshlets(a_temp_arena, create_mesh.positions, Slice<uint32_t>(meshlet_indices + model_prim.start_index, model_prim.index_count), cone_culling);
+			Meshlet* asset_meshlets = AssetAllocArr<Meshlet>(meshlets.size());
+			for (size_t i = 0; i < meshlets.size(); i++)
+			{
+				asset_meshlets[i] = meshlets[i];
+				asset_meshlets[i].index_start += model_prim.start_index;
+			}
+			model_prim.meshlets = ConstSlice<Meshlet>(asset_meshlets, meshlets.size());
+		}
     }
-	CreateMesh(a_temp_arena, create_mesh, a_mesh.mesh);
+	create_mesh.indices = ConstSlice<uint32_t>(meshlet_indices, create_mesh.indices.size());
+	CreateMesh(a_temp_arena, create_mesh, a_mesh);
 }
 
 struct LoadgltfMeshBatch_params
@@ -1800,6 +2142,49 @@ static void cgltf_arena_free(void*, void*)
 	// nothing
 }
 
+// the .gltf/.glb and its .bin buffers are mapped instead of read into the arena, vertex data is copied once from the mapping to the gpu upload.
+struct cgltf_mapped_file
+{
+	OSMappedFile mapping;
+	cgltf_mapped_file* next;
+};
+
+static cgltf_result cgltf_map_file_read(const cgltf_memory_options* a_memory_options, const cgltf_file_options* a_file_options, const char* a_path, cgltf_size* a_size, void** a_data)
+{
+	const OSMappedFile mapping = OSMapFile(a_path, OS_MAP_HINT::WILL_NEED);
+	if (!mapping.IsValid())
+		return cgltf_result_file_not_found;
+	// a buffer that claims to be bigger then the file on disk.
+	if (*a_size != 0 && mapping.size < *a_size)
+	{
+		OSUnmapFile(mapping);
+		return cgltf_result_io_error;
+	}
+
+	cgltf_mapped_file*& mapped_files = *reinterpret_cast<cgltf_mapped_file**>(a_file_options->user_data);
+	cgltf_mapped_file* mapped_file = reinterpret_cast<cgltf_mapped_file*>(a_memory_options->alloc_func(a_memory_options->user_data, sizeof(cgltf_mapped_file)));
+	mapped_file->mapping = mapping;
+	mapped_file->next = mapped_files;
+	mapped_files = mapped_file;
+
+	*a_size = mapping.size;
+	*a_data = const_cast<void*>(mapping.data);
+	return cgltf_result_success;
+}
+
+static void cgltf_map_file_release(const cgltf_memory_options*, const cgltf_file_options* a_file_options, void* a_data)
+{
+	for (cgltf_mapped_file* mapped_file = *reinterpret_cast<cgltf_mapped_file**>(a_file_options->user_data); mapped_file; mapped_file = mapped_file->next)
+	{
+		if (mapped_file->mapping.data == a_data)
+		{
+			OSUnmapFile(mapped_file->mapping);
+			mapped_file->mapping.data = nullptr;
+			return;
+		}
+	}
+}
+
 const Model& Asset::LoadglTFModel(MemoryArena& a_temp_arena, const MeshLoadFromDisk& a_mesh_op)
 {
 	const AssetHash asset_hash = CreateAssetHash(StringHash(a_mesh_op.path), ASSET_TYPE::MODEL);
@@ -1812,6 +2197,10 @@ const Model& Asset::LoadglTFModel(MemoryArena& a_temp_arena, const MeshLoadFromD
 	gltf_option.memory.alloc_func = cgltf_arena_alloc;
 	gltf_option.memory.free_func = cgltf_arena_free;
 	gltf_option.memory.user_data = &a_temp_arena;
+	cgltf_mapped_file* mapped_files = nullptr;
+	gltf_option.file.read = cgltf_map_file_read;
+	gltf_option.file.release = cgltf_map_file_release;
+	gltf_option.file.user_data = &mapped_files;
 	cgltf_data* gltf_data = nullptr;
 
 	const PathString path = CreateModelPath(a_mesh_op.path);
@@ -1827,6 +2216,7 @@ const Model& Asset::LoadglTFModel(MemoryArena& a_temp_arena, const MeshLoadFromD
 	if (cgltf_validate(gltf_data) != cgltf_result_success)
 	{
 		BB_ASSERT(false, "GLTF model validation failed!");
+		cgltf_free(gltf_data);
 		return *asset.model;
 	}
 	const uint32_t linear_node_count = static_cast<uint32_t>(gltf_data->nodes_count);
@@ -1944,7 +2334,7 @@ const Model& Asset::LoadMeshFromMemory(MemoryArena& a_temp_arena, const MeshLoad
 	Model::Mesh& mesh = asset.model->meshes[0];
 	mesh.primitives[0] = primitive;
     mesh.primitives[0].bounding_box = GetBoundingBoxPrimitive(create_mesh.positions, create_mesh.indices, mesh.primitives[0].start_index, mesh.primitives[0].index_count);
-	CreateMesh(a_temp_arena, create_mesh, mesh.mesh);
+	CreateMesh(a_temp_arena, create_mesh, mesh);
 
 	*asset.model->root_node_indices = 0;
 
@@ -1998,7 +2388,16 @@ void Asset::FreeAsset(const AssetHandle a_asset_handle)
 	case ASSET_TYPE::MODEL:
 
 		for (size_t i = 0; i < slot->model->meshes.size(); i++)
-			AssetFree(slot->model->meshes[i].primitives.data());
+		{
+			const Model::Mesh& mesh = slot->model->meshes[i];
+			FreeFromVertexBuffer(mesh.vertex_allocation);
+			if (mesh.index_allocation.IsValid())
+				FreeFromIndexBuffer(mesh.index_allocation);
+			for (size_t prim_index = 0; prim_index < mesh.primitives.size(); prim_index++)
+				if (mesh.primitives[prim_index].meshlets.size())
+					AssetFree(mesh.primitives[prim_index].meshlets.data());
+			AssetFree(mesh.primitives.data());
+		}
 		AssetFree(slot->model->linear_nodes);
 		AssetFree(slot->model->meshes.data());
 		AssetFree(slot->model);
@@ -2012,11 +2411,76 @@ void Asset::FreeAsset(const AssetHandle a_asset_handle)
 	}
 
 	OSAcquireSRWLockWrite(&s_asset_manager->asset_lock);
-	// TODO, erase from the linear array as well
+	for (size_t i = 0; i < s_asset_manager->linear_asset_table.size(); i++)
+	{
+		if (s_asset_manager->linear_asset_table[i] == slot)
+		{
+			s_asset_manager->linear_asset_table[i] = nullptr;
+			break;
+		}
+	}
 	s_asset_manager->asset_table.erase(a_asset_handle.handle);
 	OSReleaseSRWLockWrite(&s_asset_manager->asset_lock);
 }
 
+size_t Asset::DefragmentMeshes(const RCommandList a_list, const Slice<MeshRelocation> a_out_relocations)
+{
+	const GPUFenceValue uploaded_value = GetCurrentFenceValue(s_asset_manager->gpu_uploader.fence);
+	size_t relocation_count = 0;
+
+	OSAcquireSRWLockRead(&s_asset_manager->asset_lock);
+	for (size_t i = 0; i < s_asset_manager->linear_asset_table.size() && relocation_count < a_out_relocations.size(); i++)
+	{
+		AssetSlot* const slot = s_asset_manager->linear_asset_table[i];
+		if (slot == nullptr || slot->hash.type != ASSET_TYPE::MODEL || !slot->finished_loading)
+			continue;
+
+		for (size_t mesh_index = 0; mesh_index < slot->model->meshes.size() && relocation_count < a_out_relocations.size(); mesh_index++)
+		{
+			Model::Mesh& model_mesh = slot->model->meshes[mesh_index];
+			// the upload might still be copying into the old space.
+			if (model_mesh.upload_fence_value > uploaded_value)
+				continue;
+
+			const Mesh old_mesh = model_mesh.mesh;
+			bool moved = false;
+			if (RelocateInVertexBuffer(a_list, model_mesh.vertex_allocation))
+			{
+				const uint64_t vertex_start = model_mesh.vertex_allocation.offset;
+				model_mesh.mesh.vertex_position_offset = vertex_start;
+				model_mesh.mesh.vertex_normal_offset = vertex_start + old_mesh.vertex_normal_offset - old_mesh.vertex_position_offset;
+				model_mesh.mesh.vertex_uv_offset = vertex_start + old_mesh.vertex_uv_offset - old_mesh.vertex_position_offset;
+				model_mesh.mesh.vertex_color_offset = vertex_start + old_mesh.vertex_color_offset - old_mesh.vertex_position_offset;
+				model_mesh.mesh.vertex_tangent_offset = vertex_start + old_mesh.vertex_tangent_offset - old_mesh.vertex_position_offset;
+				moved = true;
+			}
+			if (model_mesh.index_allocation.IsValid() && RelocateInIndexBuffer(a_list, model_mesh.index_allocation))
+			{
+				model_mesh.mesh.index_buffer_offset = model_mesh.index_allocation.offset;
+				moved = true;
+			}
+
+			if (moved)
+			{
+				MeshRelocation& relocation = a_out_relocations[relocation_count++];
+				relocation.old_mesh = old_mesh;
+				relocation.new_mesh = model_mesh.mesh;
+			}
+		}
+	}
+	OSReleaseSRWLockRead(&s_asset_manager->asset_lock);
+
+	if (relocation_count)
+	{
+		const PipelineBarrierGlobalInfo global_barrier{};
+		PipelineBarrierInfo pipeline_info{};
+		pipeline_info.global_barriers = ConstSlice<PipelineBarrierGlobalInfo>(&global_barrier, 1);
+		PipelineBarriers(a_list, pipeline_info);
+	}
+
+	return relocation_count;
+}
+
 #include "imgui.h"
 
 constexpr size_t ASSET_SEARCH_PATH_SIZE_MAX = 512;
@@ -2056,6 +2520,32 @@ static void LoadAssetViaSearch(MemoryArena& a_temp_arena)
 	}
 }
 
+static void ImGuiDisplayCompressionReports(const Model& a_model)
+{
+	if (ImGui::TreeNodeEx("vertex compression"))
+	{
+		for (uint32_t i = 0; i < a_model.meshes.size(); i++)
+		{
+			const VertexCompressionReport& report = a_model.meshes[i].compression_report;
+			if (a_model.meshes[i].mesh.vertex_format != VERTEX_FORMAT_COMPRESSED)
+			{
+				ImGui::Text("mesh %u: not compressed", i);
+				continue;
+			}
+
+			ImGui::Text("mesh %u: %u -> %u bytes", i, report.uncompressed_size, report.compressed_size);
+			ImGui::Indent();
+			ImGui::Text("position error max: %f avg: %f", report.max_position_error, report.average_position_error);
+			ImGui::Text("normal error max: %f degrees", report.max_normal_error);
+			ImGui::Text("tangent error max: %f degrees", report.max_tangent_error);
+			ImGui::Text("uv error max: %f", report.max_uv_error);
+			ImGui::Text("color error max: %f", report.max_color_error);
+			ImGui::Unindent();
+		}
+		ImGui::TreePop();
+	}
+}
+
 void Asset::ShowAssetMenu(MemoryArena& a_arena)
 {
 	if (ImGui::Begin("Asset Menu", nullptr, ImGuiWindowFlags_MenuBar))
@@ -2123,6 +2613,9 @@ void Asset::ShowAssetMenu(MemoryArena& a_arena)
 						}
 					}
 
+					if (slot->hash.type == ASSET_TYPE::MODEL && slot->finished_loading)
+						ImGuiDisplayCompressionReports(*slot->model);
+
 					// show icon
 					const float icons_texture_width = static_cast<float>(ICON_EXTENT.x * s_asset_manager->icons_storage.max_slots);
 					const float slot_size_in_float = static_cast<float>(ICON_EXTENT.x) / icons_texture_width;
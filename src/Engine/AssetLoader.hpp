@@ -1,5 +1,7 @@
 #pragma once
 #include "Rendererfwd.hpp"
+#include "OffsetAllocator.hpp"
+#include "Meshlet.hpp"
 #include "Enginefwd.hpp"
 #include "ecs/components/NameComponent.hpp"
 
@@ -39,6 +41,19 @@ namespace BB
 		AssetHandle asset_handle; //32
 	};
 
+	// how much an import-time compressed mesh differs from the source data.
+	struct VertexCompressionReport
+	{
+		float max_position_error;     // model units
+		float average_position_error; // model units
+		float max_normal_error;       // degrees
+		float max_tangent_error;      // degrees
+		float max_uv_error;
+		float max_color_error;
+		uint32_t uncompressed_size;
+		uint32_t compressed_size;
+	};
+
 	struct Model
 	{
 		struct MaterialData
@@ -54,11 +69,20 @@ namespace BB
 			uint32_t index_count;
 
             BoundingBox bounding_box;
+			// empty when the primitive is too small to be worth splitting.
+			ConstSlice<Meshlet> meshlets;
 		};
 
 		struct Mesh
 		{
 			BB::Mesh mesh;
+			// space in the global vertex and index buffer, freed with the model.
+			OffsetAllocation vertex_allocation;
+			OffsetAllocation index_allocation;
+			// the mesh is on the gpu when the asset upload fence reaches this value.
+			GPUFenceValue upload_fence_value;
+			// zeroed when the mesh is not compressed.
+			VertexCompressionReport compression_report;
 			StaticArray<Primitive> primitives;
 		};
 
@@ -93,6 +117,8 @@ namespace BB
 
 			size_t asset_upload_buffer_size = gbSize * 2;
 			size_t max_textures = 1024;
+			// quantize the vertex attributes of every loaded mesh, see VERTEX_FORMAT_COMPRESSED.
+			bool compress_vertices = true;
 		};
 
 		enum class ASYNC_ASSET_TYPE : uint32_t
@@ -183,6 +209,10 @@ namespace BB
 
 		void FreeAsset(const AssetHandle a_asset_handle);
 
+		// moves up to a_out_relocations.size() meshes to lower space in the global vertex and index buffer with gpu copies.
+		// the models are patched directly, copies of their meshes need to be patched with the returned relocations.
+		size_t DefragmentMeshes(const RCommandList a_list, const Slice<MeshRelocation> a_out_relocations);
+
 		RDescriptorIndex GetWhiteTexture();
 		RDescriptorIndex GetBlackTexture();
 		RDescriptorIndex GetRedTexture();
@@ -21,6 +21,7 @@ static EngineConfig engine_config;
 static char s_root_path[PathString::capacity()];
 static bool s_window_closed = false;
 static bool s_resize_app = false;
+static bool s_ecs_archetype_storage = false;
 
 static void CustomCloseWindow(const BB::WindowHandle a_window_handle)
 {
@@ -64,10 +65,12 @@ EngineInfo BB::InitEngine(MemoryArena& a_arena, const wchar* a_app_name, const E
     PathString root_path = PathString(exe_path.c_str(), src_slash + 1);
     BB_ASSERT(root_path.size() < _countof(s_root_path), "root path is too big!");
     memcpy(s_root_path, root_path.c_str(), root_path.size());
+    s_ecs_archetype_storage = a_engine_options.ecs_archetype_storage;
 
     SystemInfo sys_info;
     OSSystemInfo(sys_info);
-    Threads::InitThreads(sys_info.processor_num / 2);
+    const uint32_t job_thread_count = a_engine_options.job_thread_count != 0 ? a_engine_options.job_thread_count : Max(sys_info.processor_num / 2, 1u);
+    Threads::InitThreads(job_thread_count);
 
     MemoryArenaScope(a_arena)
     {
@@ -104,25 +107,25 @@ EngineInfo BB::InitEngine(MemoryArena& a_arena, const wchar* a_app_name, const E
     const uint32_t back_buffer_count = GetBackBufferCount();
 
     MaterialSystemCreateInfo material_system_init{};
-    material_system_init.max_materials = 128;
-    material_system_init.max_shader_effects = 64;
-    material_system_init.max_material_instances = 256;
-    material_system_init.default_2d_vertex.path = "hlsl/Imgui.hlsl";
+    material_system_init.max_materials = a_engine_options.max_materials;
+    material_system_init.max_shader_effects = a_engine_options.max_shader_effects;
+    material_system_init.max_material_instances = a_engine_options.max_material_instances;
+    material_system_init.default_2d_vertex.path = "HLSL/Imgui.hlsl";
     material_system_init.default_2d_vertex.entry = "VertexMain";
     material_system_init.default_2d_vertex.stage = SHADER_STAGE::VERTEX;
     material_system_init.default_2d_vertex.next_stages = static_cast<SHADER_STAGE_FLAGS>(SHADER_STAGE::FRAGMENT_PIXEL);
 
-    material_system_init.default_2d_fragment.path = "hlsl/Imgui.hlsl";
+    material_system_init.default_2d_fragment.path = "HLSL/Imgui.hlsl";
     material_system_init.default_2d_fragment.entry = "FragmentMain";
     material_system_init.default_2d_fragment.stage = SHADER_STAGE::FRAGMENT_PIXEL;
     material_system_init.default_2d_fragment.next_stages = static_cast<SHADER_STAGE_FLAGS>(SHADER_STAGE::NONE);
 
-    material_system_init.default_3d_vertex.path = "hlsl/pbrmesh.hlsl";
+    material_system_init.default_3d_vertex.path = "HLSL/pbrmesh.hlsl";
     material_system_init.default_3d_vertex.entry = "VertexMain";
     material_system_init.default_3d_vertex.stage = SHADER_STAGE::VERTEX;
     material_system_init.default_3d_vertex.next_stages = static_cast<SHADER_STAGE_FLAGS>(SHADER_STAGE::FRAGMENT_PIXEL);
 
-    material_system_init.default_3d_fragment.path = "hlsl/pbrmesh.hlsl";
+    material_system_init.default_3d_fragment.path = "HLSL/pbrmesh.hlsl";
     material_system_init.default_3d_fragment.entry = "FragmentMain";
     material_system_init.default_3d_fragment.stage = SHADER_STAGE::FRAGMENT_PIXEL;
     material_system_init.default_3d_fragment.next_stages = static_cast<SHADER_STAGE_FLAGS>(SHADER_STAGE::NONE);
@@ -182,3 +185,8 @@ const StringView BB::GetRootPath()
 {
     return StringView(s_root_path);
 }
+
+bool BB::UseECSArchetypeStorage()
+{
+    return s_ecs_archetype_storage;
+}
@@ -24,6 +24,10 @@ namespace BB
         uint32_t max_shader_effects;
         uint32_t max_material_instances;
         bool enable_debug;
+        // the scenes store their components in archetype chunks instead of a pool per component.
+        bool ecs_archetype_storage;
+        // 0 uses half of the processors, there is always at least one job thread.
+        uint32_t job_thread_count;
         DebugOptions debug_options;
     };
 
@@ -47,6 +51,7 @@ namespace BB
 
     const char* GetExePath();
     const StringView GetRootPath();
+    bool UseECSArchetypeStorage();
 
     bool WindowResized();
     bool WindowClosed();
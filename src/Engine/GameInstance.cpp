@@ -25,7 +25,8 @@ bool GameInstance::Init(const uint2 a_game_viewport_size, const StringView a_pro
         m_input_channel = Input::CreateInputChannelByJson(m_arena, a_project_name, input_path.GetView());
     }
 
-    m_scene_hierarchy.Init(m_arena, STANDARD_ECS_OBJ_COUNT, a_game_viewport_size, a_project_name);
+    m_scene_hierarchy.Init(m_arena, STANDARD_ECS_OBJ_COUNT, a_game_viewport_size, a_project_name, UseECSArchetypeStorage());
+    m_command_buffer.Init(m_arena, GAME_ECS_COMMAND_MEMORY);
 
     m_viewport.Init(a_game_viewport_size, int2(0, 0), a_project_name);
     if (a_register_funcs.size())
@@ -89,6 +90,7 @@ bool GameInstance::Update(const float a_delta_time, const bool a_selected)
     lua_pushboolean(m_lua.State(), a_selected);
     m_lua.CallFunction(2, 1);
     const bool update_success = lua_toboolean(m_lua.State(), -1);
+    SubmitCommandBuffer();
 
     if (!update_success)
     {
@@ -103,6 +105,7 @@ void GameInstance::Destroy()
 {
     m_lua.LoadAndCallFunction("Destroy", 1);
     bool success = lua_isboolean(m_lua.State(), -1);
+    SubmitCommandBuffer();
     BB_WARNING(success, "something went wrong destroying game instance", WarningType::HIGH);
 }
 
@@ -175,6 +178,11 @@ void GameInstance::SetDirty()
     m_dirty = true;
 }
 
+void GameInstance::SubmitCommandBuffer()
+{
+    m_scene_hierarchy.GetECS().SubmitCommandBuffer(m_command_buffer);
+}
+
 static void LoadECSFunction(lua_State* a_state, const lua_CFunction a_function, const char* a_func_name)
 {
     lua_pushvalue(a_state, -1);
@@ -192,6 +200,7 @@ void GameInstance::RegisterLuaCFunctions()
     lua_pushlightuserdata(m_lua.State(), this);
 
     LoadECSFunction(m_lua.State(), LUA_FUNC_NAME(ECSCreateEntity));
+    LoadECSFunction(m_lua.State(), LUA_FUNC_NAME(ECSSpawnEntity));
     LoadECSFunction(m_lua.State(), LUA_FUNC_NAME(ECSDestroyEntity));
     LoadECSFunction(m_lua.State(), LUA_FUNC_NAME(ECSGetPosition));
     LoadECSFunction(m_lua.State(), LUA_FUNC_NAME(ECSSetPosition));
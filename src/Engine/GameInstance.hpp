@@ -8,9 +8,11 @@ namespace BB
 {
     typedef void (*PFN_LuaPluginRegisterFunctions)(class GameInstance& a_inst);
 
+    constexpr size_t GAME_ECS_COMMAND_MEMORY = kbSize * 64;
+
     class GameInstance
     {
-        friend Editor;
+        friend class Editor;
     public:
         bool Init(const uint2 a_viewport_size, const StringView a_project_name, MemoryArena* a_parena, const ConstSlice<PFN_LuaPluginRegisterFunctions> a_register_funcs = ConstSlice<PFN_LuaPluginRegisterFunctions>());
         bool Update(const float a_delta_time, const bool a_selected = true);
@@ -27,6 +29,8 @@ namespace BB
         Viewport& GetViewport() { return m_viewport; }
         InputChannelHandle GetInputChannel() const { return m_input_channel; }
         SceneHierarchy& GetSceneHierarchy() { return m_scene_hierarchy; }
+        // lua records the structural ecs changes here, they are submitted after every lua call and played back when the scene updates.
+        ECSCommandBuffer& GetCommandBuffer() { return m_command_buffer; }
         MemoryArena& GetMemory() { return m_arena; }
         const PathString& GetProjectPath() const { return m_project_path; }
         struct lua_State* GetLuaState();
@@ -34,12 +38,14 @@ namespace BB
     private:
         bool InitLua();
         void RegisterLuaCFunctions();
+        void SubmitCommandBuffer();
 
         bool m_dirty = false;
 
         MemoryArena m_arena;
         Viewport m_viewport;
         SceneHierarchy m_scene_hierarchy;
+        ECSCommandBuffer m_command_buffer;
         LuaContext m_lua;
         InputChannelHandle m_input_channel;
         StackString<32> m_project_name;
@@ -195,11 +195,11 @@ float2 Input::GetMousePos(const WindowHandle a_window_handle)
     return OSGetCursorPos(a_window_handle);
 }
 
-static bool HasSimiliarInputActionName(const ConstSlice<InputAction> a_input_action, const InputActionName& a_name)
+static bool HasSimiliarInputActionName(const ConstSlice<InputAction> a_input_action, const StringAtom a_name)
 {
     for (size_t i = 0; i < a_input_action.size(); i++)
     {
-        if (a_input_action[i].name == a_name)
+        if (a_input_action[i].name_atom == a_name)
         {
             return true;
         }
@@ -216,13 +216,15 @@ InputActionHandle Input::CreateInputAction(const InputChannelHandle a_channel, c
 {
     InputChannel* channel = reinterpret_cast<InputChannel*>(a_channel.handle);
     BB_ASSERT(channel->input_actions.IsFull() == false, "input channel is full");
-    BB_ASSERT(HasSimiliarInputActionName(channel->input_actions.const_slice(), a_name) == false, "duplicate input being created in input channel");
+    const StringAtom name_atom = StringAtomIntern(a_name.GetView());
+    BB_ASSERT(HasSimiliarInputActionName(channel->input_actions.const_slice(), name_atom) == false, "duplicate input being created in input channel");
 
     const InputActionHandle handle = InputActionHandle(channel->input_actions.size(), channel->channel_index);
 
     InputAction action{};
     action.handle = handle;
     action.name = a_name;
+    action.name_atom = name_atom;
     action.value_type = a_create_info.value_type;
     action.binding_type = a_create_info.binding_type;
     action.input_source = a_create_info.source;
@@ -236,9 +238,13 @@ InputActionHandle Input::CreateInputAction(const InputChannelHandle a_channel, c
 InputActionHandle Input::FindInputAction(const InputChannelHandle a_channel, const InputActionName& a_name)
 {
     InputChannel* channel = reinterpret_cast<InputChannel*>(a_channel.handle);
+    // a name that was never interned can't belong to an input action.
+    const StringAtom name_atom = StringAtomFind(a_name.GetView());
+    if (!name_atom.IsValid())
+        return InputActionHandle(); // invalid
 
     for (uint32_t i = 0; i < channel->input_actions.size(); i++)
-        if (channel->input_actions[i].name == a_name)
+        if (channel->input_actions[i].name_atom == name_atom)
             return InputActionHandle(i, channel->channel_index);
 
     return InputActionHandle(); // invalid
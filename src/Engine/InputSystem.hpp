@@ -3,6 +3,7 @@
 #include "HID.h"
 #include "Storage/BBString.h"
 #include "Storage/FixedArray.h"
+#include "Utils/StringAtom.hpp"
 
 namespace BB
 {
@@ -56,6 +57,7 @@ namespace BB
     {
         InputActionHandle handle;
         InputActionName name;
+        StringAtom name_atom;
         INPUT_VALUE_TYPE value_type;
         INPUT_BINDING_TYPE binding_type;
         INPUT_SOURCE input_source;
@@ -11,6 +11,8 @@ using namespace BB;
 BB_STATIC_ASSERT(sizeof(ShaderIndices) == sizeof(ShaderIndices2D), "shaderindices not the same sizeof.");
 
 constexpr size_t PUSH_CONSTANT_SPACE_SIZE = sizeof(ShaderIndices);
+// the highest minUniformBufferOffsetAlignment vulkan allows, every instance slot starts at this alignment.
+constexpr uint32_t MATERIAL_INSTANCE_ALIGNMENT = 256;
 
 static uint64_t ShaderEffectHash(const MaterialShaderCreateInfo& a_create_info)
 {
@@ -39,6 +41,9 @@ struct MaterialSystem_inst
 	StaticOL_HashMap<uint64_t, ShaderEffectHandle> shader_effect_cache;
 
 	FreelistArray<MaterialInstance> material_instances;
+	// every master material can hold all instances, its freed slots queue is made together with its instance buffer.
+	uint32_t instances_per_master;
+	MemoryArena instance_slot_arena;
 
 	RDescriptorLayout scene_desc_layout;
 	RDescriptorLayout material_desc_layout;
@@ -56,7 +61,7 @@ static inline MasterMaterialHandle& GetDefaultMasterMaterial_impl(const PASS_TYP
 	return s_material_inst->default_materials[static_cast<uint32_t>(a_pass_type)][static_cast<uint32_t>(a_material_type)];
 }
 
-static inline MasterMaterialHandle CreateMaterial_impl(const ShaderEffectHandle a_vertex, const ShaderEffectHandle a_fragment, const ShaderEffectHandle a_geometry, const PASS_TYPE a_pass_type, const MATERIAL_TYPE a_material_type, const uint32_t a_user_data_size, const bool a_cpu_writeable, const StringView name = "default")
+static inline MasterMaterialHandle CreateMaterial_impl(const ShaderEffectHandle a_vertex, const ShaderEffectHandle a_fragment, const ShaderEffectHandle a_geometry, const ShaderEffectHandle a_compute, const PASS_TYPE a_pass_type, const MATERIAL_TYPE a_material_type, const uint32_t a_user_data_size, const bool a_cpu_writeable, const StringView name = "default")
 {
 	const MasterMaterialHandle material = s_material_inst->material_map.emplace();
 	MasterMaterial& inst = s_material_inst->material_map.find(material);
@@ -64,11 +69,14 @@ static inline MasterMaterialHandle CreateMaterial_impl(const ShaderEffectHandle
 	inst.shaders.vertex = a_vertex;
 	inst.shaders.fragment_pixel = a_fragment;
 	inst.shaders.geometry = a_geometry;
+	inst.shaders.compute = a_compute;
 	inst.pass_type = a_pass_type;
 	inst.material_type = a_material_type;
 	inst.user_data_size = a_user_data_size;
 	inst.handle = material;
 	inst.cpu_writeable = a_cpu_writeable;
+	inst.instance_buffer = {};
+	inst.instance_buffer.stride = static_cast<uint32_t>(RoundUp(a_user_data_size, MATERIAL_INSTANCE_ALIGNMENT));
 	return material;
 }
 
@@ -77,6 +85,7 @@ struct ShaderEffectList
     ShaderEffectHandle vertex;
     ShaderEffectHandle fragment;
     ShaderEffectHandle geometry;
+    ShaderEffectHandle compute;
 };
 
 static ShaderEffectList CreateShaderEffects_impl(MemoryArena& a_temp_arena, const Slice<MaterialShaderCreateInfo> a_shader_effects_info, const ShaderDescriptorLayouts& a_desc_layouts, const uint32_t a_desc_layout_count)
@@ -100,6 +109,11 @@ static ShaderEffectList CreateShaderEffects_impl(MemoryArena& a_temp_arena, cons
                     return false;
                 a_list.geometry = a_effect;
                 break;
+            case SHADER_STAGE::COMPUTE:
+                if (a_list.compute.IsValid())
+                    return false;
+                a_list.compute = a_effect;
+                break;
             default:
                 BB_ASSERT(false, "something went wrong in creating shaders");
                 return false;
@@ -111,7 +125,9 @@ static ShaderEffectList CreateShaderEffects_impl(MemoryArena& a_temp_arena, cons
 	CreateShaderEffectInfo* shader_effects = ArenaAllocArr(a_temp_arena, CreateShaderEffectInfo, a_shader_effects_info.size());
 	size_t created_shader_effect_count = 0;
 
-	MemoryArenaMarker memory_pos_before_shader_read = MemoryArenaGetMemoryMarker(a_temp_arena);
+	// the shader sources are mapped, they stay mapped until all effects in this list are compiled.
+	OSMappedFile* shader_files = ArenaAllocArr(a_temp_arena, OSMappedFile, a_shader_effects_info.size());
+	size_t shader_file_count = 0;
 	PathString previous_shader_path;
 	Buffer shader_buffer;
 
@@ -122,16 +138,21 @@ static ShaderEffectList CreateShaderEffects_impl(MemoryArena& a_temp_arena, cons
 		if (const ShaderEffectHandle* found_shader = s_material_inst->shader_effect_cache.find(ShaderEffectHash(info)))
 		{
             if (!place_shader(return_list, info.stage, *found_shader))
+            {
+                for (size_t file_index = 0; file_index < shader_file_count; file_index++)
+                    OSUnmapFile(shader_files[file_index]);
                 return ShaderEffectList();
+            }
 		}
 		else
 		{
 			if (previous_shader_path != info.path)
 			{
-				MemoryArenaSetMemoryMarker(a_temp_arena, memory_pos_before_shader_read);
                 PathString path = s_material_inst->shader_path;
                 path.AddPathNoSlash(info.path.c_str());
-				shader_buffer = OSReadFile(a_temp_arena, path.c_str());
+				const OSMappedFile& shader_file = shader_files[shader_file_count++] = OSMapFile(path.c_str(), OS_MAP_HINT::SEQUENTIAL);
+				shader_buffer.data = const_cast<void*>(shader_file.data);
+				shader_buffer.size = shader_file.size;
                 previous_shader_path = path;
 			}
 
@@ -157,6 +178,8 @@ static ShaderEffectList CreateShaderEffects_impl(MemoryArena& a_temp_arena, cons
 
 	ShaderEffectHandle* created_handles = ArenaAllocArr(a_temp_arena, ShaderEffectHandle, created_shader_effect_count);
 	bool success = CreateShaderEffect(a_temp_arena, Slice(shader_effects, created_shader_effect_count), created_handles, false);
+	for (size_t i = 0; i < shader_file_count; i++)
+		OSUnmapFile(shader_files[i]);
 	if (!success)
 	{
 		BB_WARNING(false, "Material created failed due to failing to create shader effects", WarningType::MEDIUM);
@@ -216,6 +239,8 @@ void Material::InitMaterialSystem(MemoryArena& a_arena, const MaterialSystemCrea
 	s_material_inst = ArenaAllocType(a_arena, MaterialSystem_inst);
 	s_material_inst->material_map.Init(a_arena, a_create_info.max_materials);
 	s_material_inst->material_instances.Init(a_arena, a_create_info.max_material_instances);
+	s_material_inst->instances_per_master = a_create_info.max_material_instances;
+	s_material_inst->instance_slot_arena = MemoryArenaCreate();
 	s_material_inst->shader_effects.Init(a_arena, a_create_info.max_shader_effects);
 	s_material_inst->shader_effect_cache.Init(a_arena, a_create_info.max_shader_effects);
 	
@@ -304,49 +329,99 @@ MasterMaterialHandle Material::CreateMasterMaterial(MemoryArena& a_temp_arena, c
 
 	const ShaderEffectList shader_effects = CreateShaderEffects_impl(a_temp_arena, a_create_info.shader_infos, desc_layouts, layouts);
 
-	return CreateMaterial_impl(shader_effects.vertex, shader_effects.fragment, shader_effects.geometry, a_create_info.pass_type, a_create_info.material_type, a_create_info.user_data_size, a_create_info.cpu_writeable, a_name);
+	BB_ASSERT(!shader_effects.compute.IsValid() || (!shader_effects.vertex.IsValid() && !shader_effects.fragment.IsValid() && !shader_effects.geometry.IsValid()), "a compute material can not have graphics shaders");
+	return CreateMaterial_impl(shader_effects.vertex, shader_effects.fragment, shader_effects.geometry, shader_effects.compute, a_create_info.pass_type, a_create_info.material_type, a_create_info.user_data_size, a_create_info.cpu_writeable, a_name);
+}
+
+static uint32_t AllocateInstanceSlot(MasterMaterial& a_master)
+{
+	MasterMaterial::InstanceBuffer& instances = a_master.instance_buffer;
+	if (!instances.buffer.IsValid())
+	{
+		GPUBufferCreateInfo create_buffer;
+		create_buffer.name = a_master.name.c_str();
+		create_buffer.type = BUFFER_TYPE::UNIFORM;
+		create_buffer.size = static_cast<uint64_t>(instances.stride) * s_material_inst->instances_per_master;
+		create_buffer.host_writable = a_master.cpu_writeable;
+		instances.buffer = CreateGPUBuffer(create_buffer);
+		instances.mapped = create_buffer.host_writable ? MapGPUBuffer(instances.buffer) : nullptr;
+		instances.freed_slots.Init(s_material_inst->instance_slot_arena, s_material_inst->instances_per_master);
+	}
+
+	// the oldest freed slot is the first one the gpu is done with.
+	const MasterMaterial::FreedInstanceSlot* freed = instances.freed_slots.Peek();
+	uint32_t slot;
+	if (freed && freed->frame_number + GetBackBufferCount() <= GetFrameNumber())
+	{
+		slot = instances.freed_slots.DeQueue().slot;
+	}
+	else if (instances.next_unused_slot < s_material_inst->instances_per_master)
+	{
+		slot = instances.next_unused_slot++;
+	}
+	else
+	{
+		BB_ASSERT(freed, "master material instance buffer is full");
+		BB_WARNING(false, "master material instance buffer only has slots the gpu may still read, waiting for the gpu", WarningType::HIGH);
+		GPUWaitIdle();
+		slot = instances.freed_slots.DeQueue().slot;
+	}
+	++instances.used_slots;
+	return slot;
+}
+
+static void FreeInstanceSlot(MasterMaterial& a_master, const uint32_t a_slot)
+{
+	MasterMaterial::InstanceBuffer& instances = a_master.instance_buffer;
+	// a slot is only freed once, so the queue can hold all of them.
+	MasterMaterial::FreedInstanceSlot freed;
+	freed.slot = a_slot;
+	freed.frame_number = GetFrameNumber();
+	instances.freed_slots.EnQueue(freed);
+	--instances.used_slots;
 }
 
 MaterialHandle Material::CreateMaterialInstance(const MasterMaterialHandle a_master_material)
 {
-	const MasterMaterial& master = s_material_inst->material_map.find(a_master_material);
-	MaterialInstance mat;
+	MasterMaterial& master = s_material_inst->material_map.find(a_master_material);
+	MaterialInstance mat{};
 	mat.master_handle = a_master_material;
 	mat.user_data_size = master.user_data_size;
 
-	GPUBufferCreateInfo create_buffer;
-	create_buffer.name = master.name.c_str();
-	create_buffer.type = BUFFER_TYPE::UNIFORM;
-	create_buffer.size = mat.user_data_size;
-	create_buffer.host_writable = master.cpu_writeable;
-	mat.buffer = CreateGPUBuffer(create_buffer);
-	if (create_buffer.host_writable)
-		mat.mapper_ptr = MapGPUBuffer(mat.buffer);
-	else
-		mat.mapper_ptr = nullptr;
+	// materials without user data have nothing to store.
+	if (mat.user_data_size != 0)
+	{
+		mat.slot = AllocateInstanceSlot(master);
+		mat.buffer = master.instance_buffer.buffer;
+		mat.buffer_offset = static_cast<uint64_t>(mat.slot) * master.instance_buffer.stride;
+		if (master.instance_buffer.mapped)
+			mat.mapper_ptr = Pointer::Add(master.instance_buffer.mapped, mat.buffer_offset);
+	}
 
 	const MaterialHandle material_index = MaterialHandle(s_material_inst->material_instances.emplace(mat));
 
-	DescriptorWriteBufferInfo write_buffer;
-	write_buffer.descriptor_layout = s_material_inst->material_desc_layout;
-	write_buffer.allocation = s_material_inst->material_desc_allocation;
-	write_buffer.binding = PER_MATERIAL_BINDING;
-	write_buffer.descriptor_index = static_cast<uint32_t>(material_index.handle);
-	write_buffer.buffer_view.buffer = mat.buffer;
-	write_buffer.buffer_view.size = mat.user_data_size;
-	write_buffer.buffer_view.offset = 0;
-	DescriptorWriteUniformBuffer(write_buffer);
+	if (mat.user_data_size != 0)
+	{
+		DescriptorWriteBufferInfo write_buffer;
+		write_buffer.descriptor_layout = s_material_inst->material_desc_layout;
+		write_buffer.allocation = s_material_inst->material_desc_allocation;
+		write_buffer.binding = PER_MATERIAL_BINDING;
+		write_buffer.descriptor_index = static_cast<uint32_t>(material_index.handle);
+		write_buffer.buffer_view.buffer = mat.buffer;
+		write_buffer.buffer_view.size = mat.user_data_size;
+		write_buffer.buffer_view.offset = mat.buffer_offset;
+		DescriptorWriteUniformBuffer(write_buffer);
+	}
 
 	return material_index;
 }
 
 void Material::FreeMaterialInstance(const MaterialHandle a_material)
 {
-	MaterialInstance& mat = s_material_inst->material_instances.find(a_material.handle);
-	if (mat.mapper_ptr)
-		UnmapGPUBuffer(mat.buffer);
-	FreeGPUBuffer(mat.buffer);
-	mat = {};
+	const MaterialInstance& mat = s_material_inst->material_instances.find(a_material.handle);
+	if (mat.user_data_size != 0)
+		FreeInstanceSlot(s_material_inst->material_map.find(mat.master_handle), mat.slot);
+	s_material_inst->material_instances.erase(a_material.handle);
 }
 
 void Material::WriteMaterial(const MaterialHandle a_material, const RCommandList a_list, const GPUBuffer a_src_buffer, const size_t a_src_offset)
@@ -356,7 +431,7 @@ void Material::WriteMaterial(const MaterialHandle a_material, const RCommandList
 	RenderCopyBufferRegion copy_region;
 	copy_region.size = mat.user_data_size;
 	copy_region.src_offset = a_src_offset;
-	copy_region.dst_offset = 0;
+	copy_region.dst_offset = mat.buffer_offset;
 	RenderCopyBuffer copy_buffer;
 	copy_buffer.src = a_src_buffer;
 	copy_buffer.dst = mat.buffer;
@@ -364,16 +439,60 @@ void Material::WriteMaterial(const MaterialHandle a_material, const RCommandList
 	CopyBuffer(a_list, copy_buffer);
 }
 
+void Material::WriteMaterials(MemoryArena& a_temp_arena, const RCommandList a_list, const GPUBuffer a_src_buffer, const ConstSlice<MaterialWrite> a_writes)
+{
+	if (a_writes.size() == 0)
+		return;
+
+	MemoryArenaScope(a_temp_arena)
+	{
+		RenderCopyBufferRegion* regions = ArenaAllocArr(a_temp_arena, RenderCopyBufferRegion, a_writes.size());
+		bool* written = ArenaAllocArr(a_temp_arena, bool, a_writes.size());
+
+		// there are only a few master materials, so gather the regions of one instance buffer at a time.
+		for (size_t i = 0; i < a_writes.size(); i++)
+		{
+			if (written[i])
+				continue;
+
+			const GPUBuffer dst_buffer = s_material_inst->material_instances.find(a_writes[i].material.handle).buffer;
+			size_t region_count = 0;
+			for (size_t j = i; j < a_writes.size(); j++)
+			{
+				const MaterialInstance& mat = s_material_inst->material_instances.find(a_writes[j].material.handle);
+				if (written[j] || mat.buffer != dst_buffer)
+					continue;
+
+				BB_WARNING(!mat.mapper_ptr, "trying to write to a material that is meant to be CPU writeable", WarningType::OPTIMIZATION);
+				RenderCopyBufferRegion& region = regions[region_count++];
+				region.size = mat.user_data_size;
+				region.src_offset = a_writes[j].src_offset;
+				region.dst_offset = mat.buffer_offset;
+				written[j] = true;
+			}
+
+			RenderCopyBuffer copy_buffer;
+			copy_buffer.src = a_src_buffer;
+			copy_buffer.dst = dst_buffer;
+			copy_buffer.regions = Slice(regions, region_count);
+			CopyBuffer(a_list, copy_buffer);
+		}
+	}
+}
+
 void Material::WriteMaterialCPU(const MaterialHandle a_material, const void* a_memory, const size_t a_memory_size)
 {
 	const MaterialInstance& mat = s_material_inst->material_instances.find(a_material.handle);
 	BB_ASSERT(mat.mapper_ptr, "trying to write to a material that is not CPU writeable");
+	BB_ASSERT(a_memory_size <= mat.user_data_size, "writing more then the material user data size");
 	memcpy(mat.mapper_ptr, a_memory, a_memory_size);
 }
 
 RPipelineLayout Material::BindMaterial(const RCommandList a_list, const MasterMaterialHandle a_material)
 {
     const MasterMaterial& inst = s_material_inst->material_map.find(a_material);
+	if (inst.shaders.compute.IsValid())
+		return BindComputeShader(a_list, inst.shaders.compute);
 	return BindShaders(a_list, inst.shaders.vertex, inst.shaders.fragment_pixel, inst.shaders.geometry);
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "Storage/BBString.h"
 #include "Storage/FreelistArray.hpp"
+#include "Storage/Queue.hpp"
 #include "Rendererfwd.hpp"
 #include "Enginefwd.hpp"
 
@@ -70,6 +71,8 @@ namespace BB
 			ShaderEffectHandle vertex;
 			ShaderEffectHandle fragment_pixel;
 			ShaderEffectHandle geometry;
+			// a compute material has only this shader.
+			ShaderEffectHandle compute;
 			CachedShaderInfo* vertex_info;
 			CachedShaderInfo* fragment_pixel_info;
 			CachedShaderInfo* geometry_info;
@@ -81,16 +84,43 @@ namespace BB
 		uint32_t user_data_size;
 		MasterMaterialHandle handle;
 		bool cpu_writeable;
+
+		struct FreedInstanceSlot
+		{
+			uint32_t slot;
+			uint64_t frame_number;	// GetFrameNumber when the slot was freed
+		};
+
+		// every instance of the master material is a fixed stride slot in one buffer, created with the first instance.
+		struct InstanceBuffer
+		{
+			GPUBuffer buffer;
+			void* mapped;
+			uint32_t stride;
+			uint32_t used_slots;
+			uint32_t next_unused_slot;	// slots after this one were never handed out
+			// in the order they were freed, a slot is reused once the frames in flight that could read it are done.
+			SPSCQueue<FreedInstanceSlot> freed_slots;
+		} instance_buffer;
 	};
 
 	struct MaterialInstance
 	{
 		MasterMaterialHandle master_handle;
 		uint32_t user_data_size;
-		GPUBuffer buffer;
+		uint32_t slot;
+		GPUBuffer buffer;		// the instance buffer of the master material
+		uint64_t buffer_offset;
 		void* mapper_ptr; // if true means the buffer is cpu writeable;
 	};
 
+	// material data at src_offset that needs to be copied into the material.
+	struct MaterialWrite
+	{
+		MaterialHandle material;
+		uint64_t src_offset;
+	};
+
 	namespace Material
 	{
 		static inline const char* PASS_TYPE_STR(const PASS_TYPE a_pass)
@@ -120,8 +150,11 @@ namespace BB
 		MaterialHandle CreateMaterialInstance(const MasterMaterialHandle a_master_material);
 		void FreeMaterialInstance(const MaterialHandle a_material);
 		void WriteMaterial(const MaterialHandle a_material, const RCommandList a_list, const GPUBuffer a_src_buffer, const size_t a_src_offset);
+		// writes every material with one copy per master material instance buffer.
+		void WriteMaterials(MemoryArena& a_temp_arena, const RCommandList a_list, const GPUBuffer a_src_buffer, const ConstSlice<MaterialWrite> a_writes);
 		void WriteMaterialCPU(const MaterialHandle a_material, const void* a_memory, const size_t a_memory_size);
 
+		// compute materials are bound to the compute bind point.
 		RPipelineLayout BindMaterial(const RCommandList a_list, const MasterMaterialHandle a_material);
 
 		const DescriptorAllocation& GetMaterialDescAllocation();
@@ -2,29 +2,16 @@
 #include "Enginefwd.hpp"
 #include "Storage/BBString.h"
 #include "Storage/Array.h"
+#include "Utils/StringAtom.hpp"
+#include "Storage/CountingRingBuffer.hpp"
 
 namespace BB
 {
 
-	struct CountingRingBuffer
-	{
-		double sum;
-		double* buffer;
-		uint32_t head;
-		uint32_t tail;
-		uint32_t max_size;
-	};
-
-	// not thread safe, so specify your own head and tail here. 
-	// Strange things can still happen.
-	// please don't use it
-	StaticArray<double> CountingRingBufferLinear(MemoryArena& a_arena, const CountingRingBuffer& a_buff);
-
-
 	constexpr uint32_t PROFILE_RESULT_HISTORY_BUFFER_SIZE = 2048;
 	struct ProfileResult
 	{
-		StackString<32> name;
+		StringAtom name;
 		double start_time;
 		double time_in_miliseconds;
 		double average_time;
@@ -36,12 +23,15 @@ namespace BB
 
 	void InitializeProfiler(MemoryArena& a_arena, const uint32_t a_max_profile_entries);
 	// use BB_START_PROFILE instead of this function unless you know what you are doing
-	void StartProfile_f(const int a_line, const char* a_file, const StackString<32>& a_name);
+	void StartProfile_f(const int a_line, const char* a_file, const StringAtom a_name);
 	// use BB_END_PROFILE instead of this function
-	void EndProfile_f(const StackString<32>& a_name);
+	void EndProfile_f(const StringAtom a_name);
 
 	ConstSlice<ProfileResult> GetProfileResultsList();
 
-	#define BB_START_PROFILE(a_name) StartProfile_f(__LINE__, __FILE__, a_name)
-	#define BB_END_PROFILE(a_name) EndProfile_f(a_name)
+	// a_name must be a string literal, use the _ATOM versions for names created at runtime.
+	#define BB_START_PROFILE(a_name) StartProfile_f(__LINE__, __FILE__, BB_STRING_ATOM(a_name))
+	#define BB_END_PROFILE(a_name) EndProfile_f(BB_STRING_ATOM(a_name))
+	#define BB_START_PROFILE_ATOM(a_atom) StartProfile_f(__LINE__, __FILE__, a_atom)
+	#define BB_END_PROFILE_ATOM(a_atom) EndProfile_f(a_atom)
 }
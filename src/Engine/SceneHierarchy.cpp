@@ -6,6 +6,7 @@
 #include "OS/Program.h"
 #include "MaterialSystem.hpp"
 #include "ViewportInterface.hpp"
+#include "Profiler.hpp"
 
 #include "BBjson.hpp"
 
@@ -18,7 +19,7 @@ constexpr size_t UNIQUE_MODELS_PER_SCENE = 128;
 
 constexpr uint32_t LIGHT_COUNT = 128;
 
-void SceneHierarchy::Init(MemoryArena& a_arena, const uint32_t a_ecs_obj_max, const uint2 a_window_size, const StackString<32> a_name)
+void SceneHierarchy::Init(MemoryArena& a_arena, const uint32_t a_ecs_obj_max, const uint2 a_window_size, const StackString<32> a_name, const bool a_archetype_storage)
 {
 	{	// ECS systems
 		EntityComponentSystemCreateInfo create_info;
@@ -28,6 +29,7 @@ void SceneHierarchy::Init(MemoryArena& a_arena, const uint32_t a_ecs_obj_max, co
 		create_info.entity_count = a_ecs_obj_max;
 		create_info.light_count = LIGHT_COUNT;
 		create_info.render_mesh_count = a_ecs_obj_max;
+		create_info.archetype_storage = a_archetype_storage;
 		m_ecs.Init(a_arena, create_info, a_name);
 	}
 }
@@ -80,7 +82,7 @@ SceneFrame SceneHierarchy::UpdateScene(const RCommandList a_list, Viewport& a_vi
 	RenderSystem& render_sys = m_ecs.GetRenderSystem();
 	SceneFrame scene_frame;
 
-	m_ecs.TransformSystemUpdate();
+	m_ecs.SystemsUpdate();
 
 	if (render_sys.GetRenderTargetExtent() != a_viewport.GetExtent())
 	{
@@ -95,37 +97,64 @@ SceneFrame SceneHierarchy::UpdateScene(const RCommandList a_list, Viewport& a_vi
 	return scene_frame;
 }
 
-ECSEntity SceneHierarchy::CreateEntityViaModelNode(const Model::Node& a_node, const ECSEntity a_parent)
+static uint32_t CountModelNodePrototypes(const Model::Node& a_node)
 {
-	const ECSEntity ecs_obj = m_ecs.CreateEntity(a_node.name, a_parent, a_node.translation, a_node.rotation, a_node.scale);
+	uint32_t count = 1;
+	if (a_node.mesh)
+		count += a_node.mesh->primitives.size();
+	for (uint32_t i = 0; i < a_node.child_count; i++)
+		count += CountModelNodePrototypes(a_node.childeren[i]);
+	return count;
+}
+
+// depth first, so every parent prototype is added before its children.
+static void AddModelNodePrototypes(const Model::Node& a_node, const uint32_t a_parent_index, const StringAtom a_primitive_name, StaticArray<ECSEntityPrototype>& a_prototypes)
+{
+	const uint32_t node_index = a_prototypes.size();
+	ECSEntityPrototype node_prototype;
+	node_prototype.name = StringAtomIntern(a_node.name.GetView());
+	node_prototype.parent_index = a_parent_index;
+	node_prototype.position = a_node.translation;
+	node_prototype.rotation = a_node.rotation;
+	node_prototype.scale = a_node.scale;
+	node_prototype.has_render_component = false;
+	node_prototype.has_bounding_box = false;
+	a_prototypes.push_back(node_prototype);
 
 	if (a_node.mesh)
 	{
 		const Model::Mesh& mesh = *a_node.mesh;
 		for (uint32_t i = 0; i < mesh.primitives.size(); i++)
 		{
-			ECSEntity prim_obj = m_ecs.CreateEntity("unimplemented naming", ecs_obj);
-			RenderComponent mesh_info;
+			ECSEntityPrototype prim_prototype;
+			prim_prototype.name = a_primitive_name;
+			prim_prototype.parent_index = node_index;
+			prim_prototype.position = float3(0.f);
+			prim_prototype.rotation = Float3x3Identity();
+			prim_prototype.scale = float3(1.f);
+
+			RenderComponent& mesh_info = prim_prototype.render_component;
 			mesh_info.mesh = mesh.mesh;
 			mesh_info.index_start = mesh.primitives[i].start_index;
 			mesh_info.index_count = mesh.primitives[i].index_count;
+			mesh_info.meshlets = mesh.primitives[i].meshlets.data();
+			mesh_info.meshlet_count = static_cast<uint32_t>(mesh.primitives[i].meshlets.size());
 			mesh_info.master_material = mesh.primitives[i].material_data.material;
 			mesh_info.material = Material::CreateMaterialInstance(mesh.primitives[i].material_data.material);
 			mesh_info.material_data = mesh.primitives[i].material_data.mesh_metallic;
+			mesh_info.bounding_box = mesh.primitives[i].bounding_box;
 			mesh_info.material_dirty = true;
-			bool success = m_ecs.EntityAssignRenderComponent(prim_obj, mesh_info);
-			BB_ASSERT(success, "failed to create RenderComponent");
-            success = m_ecs.EntityAssignBoundingBox(prim_obj, mesh.primitives[i].bounding_box);
-            BB_ASSERT(success, "failed to assign BoundingBox");
+			prim_prototype.has_render_component = true;
+			prim_prototype.bounding_box = mesh.primitives[i].bounding_box;
+			prim_prototype.has_bounding_box = true;
+			a_prototypes.push_back(prim_prototype);
 		}
 	}
 
 	for (uint32_t i = 0; i < a_node.child_count; i++)
 	{
-		CreateEntityViaModelNode(a_node.childeren[i], ecs_obj);
+		AddModelNodePrototypes(a_node.childeren[i], node_index, a_primitive_name, a_prototypes);
 	}
-
-	return ecs_obj;
 }
 
 bool SceneHierarchy::CreateRaytraceComponent(MemoryArena& a_temp_arena, const ECSEntity a_entity, const RenderComponent& a_render)
@@ -159,8 +188,11 @@ ECSEntity SceneHierarchy::CreateEntityMesh(const float3 a_position, const SceneM
 	mesh_info.mesh = a_mesh_info.mesh;
 	mesh_info.index_start = a_mesh_info.index_start;
 	mesh_info.index_count = a_mesh_info.index_count;
+	mesh_info.meshlets = nullptr;
+	mesh_info.meshlet_count = 0;
 	mesh_info.master_material = a_mesh_info.master_material;
 	mesh_info.material_data = a_mesh_info.material_data;
+	mesh_info.bounding_box = a_bounding_box;
 	if (mesh_info.master_material.IsValid())
 	{
 		mesh_info.material = Material::CreateMaterialInstance(a_mesh_info.master_material);
@@ -180,14 +212,42 @@ ECSEntity SceneHierarchy::CreateEntityMesh(const float3 a_position, const SceneM
 	return ecs_obj;
 }
 
-ECSEntity SceneHierarchy::CreateEntityViaModel(const Model& a_model, const float3 a_position, const char* a_name, const ECSEntity a_parent)
+ECSEntity SceneHierarchy::CreateEntityViaModel(MemoryArena& a_temp_arena, const Model& a_model, const float3 a_position, const char* a_name, const ECSEntity a_parent)
 {
-	const ECSEntity ecs_obj = m_ecs.CreateEntity(a_name, a_parent, a_position);
-
-	for (uint32_t i = 0; i < a_model.root_node_count; i++)
+	BB_START_PROFILE("instantiate model");
+	ECSEntity ecs_obj = INVALID_ECS_OBJ;
+	MemoryArenaScope(a_temp_arena)
 	{
-		CreateEntityViaModelNode(a_model.linear_nodes[a_model.root_node_indices[i]], ecs_obj);
+		// the model entity is prototype 0, the nodes and their primitives follow it.
+		uint32_t prototype_count = 1;
+		for (uint32_t i = 0; i < a_model.root_node_count; i++)
+			prototype_count += CountModelNodePrototypes(a_model.linear_nodes[a_model.root_node_indices[i]]);
+
+		StaticArray<ECSEntityPrototype> prototypes{};
+		prototypes.Init(a_temp_arena, prototype_count);
+
+		ECSEntityPrototype model_prototype;
+		model_prototype.name = StringAtomIntern(a_name);
+		model_prototype.parent_index = ECS_PROTOTYPE_NO_PARENT;
+		model_prototype.position = a_position;
+		model_prototype.rotation = Float3x3Identity();
+		model_prototype.scale = float3(1.f);
+		model_prototype.has_render_component = false;
+		model_prototype.has_bounding_box = false;
+		prototypes.push_back(model_prototype);
+
+		const StringAtom primitive_name = StringAtomIntern("unimplemented naming");
+		for (uint32_t i = 0; i < a_model.root_node_count; i++)
+		{
+			AddModelNodePrototypes(a_model.linear_nodes[a_model.root_node_indices[i]], 0, primitive_name, prototypes);
+		}
+
+		ECSEntity* entities = ArenaAllocArr(a_temp_arena, ECSEntity, prototype_count);
+		const bool success = m_ecs.CreateEntities(a_temp_arena, prototypes.const_slice(), a_parent, Slice<ECSEntity>(entities, prototype_count));
+		BB_ASSERT(success, "failed to create the entities of a model");
+		ecs_obj = entities[0];
 	}
+	BB_END_PROFILE("instantiate model");
 
 	return ecs_obj;
 }
@@ -232,7 +292,7 @@ ECSEntity SceneHierarchy::CreateEntityFromJson(MemoryArena& a_temp_arena, const
         position.x = position_list.nodes[0]->GetNumber();
         position.y = position_list.nodes[1]->GetNumber();
         position.z = position_list.nodes[2]->GetNumber();
-        CreateEntityViaModel(*model, position, obj_name, top_level);
+        CreateEntityViaModel(a_temp_arena, *model, position, obj_name, top_level);
     }
 
     const JsonList& lights = scene_obj.Find("lights")->GetList();
@@ -312,5 +372,6 @@ float4x4 SceneHierarchy::CalculateLightProjectionView(const float3 a_pos, const
 {
 	const float4x4 projection = Float4x4Perspective(ToRadians(45.f), 1.0f, a_near, a_far);
 	const float4x4 view = Float4x4Lookat(a_pos, float3(), float3(0.0f, -1.0f, 0.0f));
-	return projection * view;
+	// row vectors, p * view * projection.
+	return view * projection;
 }
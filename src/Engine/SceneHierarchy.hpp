@@ -48,14 +48,14 @@ namespace BB
 	{
 	public:
 		friend class Editor;
-		void Init(MemoryArena& a_arena, const uint32_t a_ecs_obj_max, const uint2 a_window_size, const StackString<32> a_name);
+		void Init(MemoryArena& a_arena, const uint32_t a_ecs_obj_max, const uint2 a_window_size, const StackString<32> a_name, const bool a_archetype_storage = false);
 		static StaticArray<Asset::AsyncAsset> PreloadAssetsFromJson(MemoryArena& a_arena, const JsonParser& a_parsed_file);
 
 		SceneFrame UpdateScene(const RCommandList a_list, class Viewport& a_viewport);
 
 		ECSEntity CreateEntity(const float3 a_position, const NameComponent& a_name, const ECSEntity a_parent = INVALID_ECS_OBJ);
 		ECSEntity CreateEntityMesh(const float3 a_position, const SceneMeshCreateInfo& a_mesh_info, const char* a_name, const BoundingBox& a_bounding_box, const ECSEntity a_parent = INVALID_ECS_OBJ);
-		ECSEntity CreateEntityViaModel(const Model& a_model, const float3 a_position, const char* a_name, const ECSEntity a_parent = INVALID_ECS_OBJ);
+		ECSEntity CreateEntityViaModel(MemoryArena& a_temp_arena, const Model& a_model, const float3 a_position, const char* a_name, const ECSEntity a_parent = INVALID_ECS_OBJ);
 		ECSEntity CreateEntityAsLight(const LightCreateInfo& a_light_create_info, const char* a_name, const ECSEntity a_parent = INVALID_ECS_OBJ);
         ECSEntity CreateEntityFromJson(MemoryArena& a_temp_arena, const PathString& a_path);
 
@@ -63,7 +63,6 @@ namespace BB
 
 		EntityComponentSystem& GetECS() { return m_ecs; }
 	private:
-		ECSEntity CreateEntityViaModelNode(const Model::Node& a_node, const ECSEntity a_parent);
         bool CreateRaytraceComponent(MemoryArena& a_temp_arena, const ECSEntity a_entity, const RenderComponent& a_render);
 
 		bool CreateLight(const ECSEntity a_entity, const LightCreateInfo& a_light_info);
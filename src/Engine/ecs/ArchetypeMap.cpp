@@ -0,0 +1,323 @@
+#include "ArchetypeMap.hpp"
+#include "Utils/Utils.h"
+
+using namespace BB;
+
+constexpr uint32_t INVALID_ARCHETYPE = UINT32_MAX;
+
+void ECSArchetypeMap::Init(const uint32_t a_entity_max)
+{
+	m_arena = MemoryArenaCreate();
+	m_entity_max = a_entity_max;
+	memset(m_component_info, 0, sizeof(m_component_info));
+
+	m_archetype_count = 0;
+	m_chunk_count = 0;
+	m_free_chunks = nullptr;
+
+	m_locations = ArenaAllocArr(m_arena, Location, m_entity_max);
+	for (uint32_t i = 0; i < m_entity_max; i++)
+	{
+		m_locations[i].archetype = INVALID_ARCHETYPE;
+		m_locations[i].row = 0;
+	}
+}
+
+void ECSArchetypeMap::Destroy()
+{
+	MemoryArenaFree(m_arena);
+	m_archetype_count = 0;
+	m_chunk_count = 0;
+	m_free_chunks = nullptr;
+	m_locations = nullptr;
+}
+
+void ECSArchetypeMap::RegisterComponent(const ECSSignatureIndex a_signature_index, const uint32_t a_size, const uint32_t a_alignment)
+{
+	BB_ASSERT(a_signature_index.handle < MAX_ECS_COMPONENTS, "signature index out of bounds");
+	BB_ASSERT(m_archetype_count == 0, "register all components before adding entities");
+	m_component_info[a_signature_index.handle].size = a_size;
+	m_component_info[a_signature_index.handle].alignment = a_alignment;
+}
+
+bool ECSArchetypeMap::AddEntity(const ECSEntity a_entity, const ECSSignature& a_signature)
+{
+	if (a_entity.index >= m_entity_max || m_locations[a_entity.index].archetype != INVALID_ARCHETYPE)
+		return false;
+
+	const uint32_t archetype = GetOrCreateArchetype(a_signature);
+	m_locations[a_entity.index].archetype = archetype;
+	m_locations[a_entity.index].row = PushRow(archetype, a_entity);
+	return true;
+}
+
+bool ECSArchetypeMap::RemoveEntity(const ECSEntity a_entity)
+{
+	const Location* location = FindLocation(a_entity);
+	if (location == nullptr)
+		return false;
+
+	RemoveRow(location->archetype, location->row);
+	m_locations[a_entity.index].archetype = INVALID_ARCHETYPE;
+	return true;
+}
+
+bool ECSArchetypeMap::HasEntity(const ECSEntity a_entity) const
+{
+	return FindLocation(a_entity) != nullptr;
+}
+
+bool ECSArchetypeMap::ChangeSignature(const ECSEntity a_entity, const ECSSignature& a_signature)
+{
+	const Location* location = FindLocation(a_entity);
+	if (location == nullptr)
+		return false;
+
+	const uint32_t old_archetype_index = location->archetype;
+	const uint32_t old_row = location->row;
+	if (m_archetypes[old_archetype_index].signature == a_signature)
+		return true;
+
+	const uint32_t new_archetype_index = GetOrCreateArchetype(a_signature);
+	const uint32_t new_row = PushRow(new_archetype_index, a_entity);
+
+	const Archetype& old_archetype = m_archetypes[old_archetype_index];
+	const Archetype& new_archetype = m_archetypes[new_archetype_index];
+	const ECSSignature shared = old_archetype.signature & new_archetype.signature;
+	for (uint32_t i = 0; i < MAX_ECS_COMPONENTS; i++)
+	{
+		if (!shared[i])
+			continue;
+		memcpy(GetColumnElement(new_archetype, new_row, i), GetColumnElement(old_archetype, old_row, i), m_component_info[i].size);
+	}
+
+	// this can move another entity into old_row, so update our location after.
+	RemoveRow(old_archetype_index, old_row);
+	m_locations[a_entity.index].archetype = new_archetype_index;
+	m_locations[a_entity.index].row = new_row;
+	return true;
+}
+
+void* ECSArchetypeMap::AddComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index)
+{
+	const Location* location = FindLocation(a_entity);
+	if (location == nullptr)
+		return nullptr;
+
+	ECSSignature signature = m_archetypes[location->archetype].signature;
+	if (!signature[a_signature_index.handle])
+	{
+		signature.set(a_signature_index.handle);
+		ChangeSignature(a_entity, signature);
+	}
+
+	return GetComponent(a_entity, a_signature_index);
+}
+
+bool ECSArchetypeMap::RemoveComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index)
+{
+	const Location* location = FindLocation(a_entity);
+	if (location == nullptr)
+		return false;
+
+	ECSSignature signature = m_archetypes[location->archetype].signature;
+	if (!signature[a_signature_index.handle])
+		return false;
+
+	signature.reset(a_signature_index.handle);
+	return ChangeSignature(a_entity, signature);
+}
+
+void* ECSArchetypeMap::GetComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index) const
+{
+	const Location* location = FindLocation(a_entity);
+	BB_ASSERT(location != nullptr, "entity is not in the archetype map");
+	const Archetype& archetype = m_archetypes[location->archetype];
+	BB_ASSERT(archetype.signature[a_signature_index.handle], "entity does not have this component");
+	return GetColumnElement(archetype, location->row, a_signature_index.handle);
+}
+
+bool ECSArchetypeMap::HasComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index) const
+{
+	const Location* location = FindLocation(a_entity);
+	if (location == nullptr)
+		return false;
+	return m_archetypes[location->archetype].signature[a_signature_index.handle];
+}
+
+ConstSlice<ECSArchetypeChunk*> ECSArchetypeMap::GatherChunks(MemoryArena& a_arena, const ECSSignature& a_required) const
+{
+	uint32_t chunk_count = 0;
+	for (uint32_t i = 0; i < m_archetype_count; i++)
+		if ((m_archetypes[i].signature & a_required) == a_required)
+			chunk_count += m_archetypes[i].chunk_count;
+
+	if (chunk_count == 0)
+		return ConstSlice<ECSArchetypeChunk*>();
+
+	ECSArchetypeChunk** chunks = ArenaAllocArr(a_arena, ECSArchetypeChunk*, chunk_count);
+	uint32_t chunk_index = 0;
+	for (uint32_t i = 0; i < m_archetype_count; i++)
+	{
+		const Archetype& archetype = m_archetypes[i];
+		if ((archetype.signature & a_required) != a_required)
+			continue;
+		memcpy(&chunks[chunk_index], archetype.chunks, archetype.chunk_count * sizeof(ECSArchetypeChunk*));
+		chunk_index += archetype.chunk_count;
+	}
+
+	return ConstSlice<ECSArchetypeChunk*>(chunks, chunk_count);
+}
+
+uint32_t ECSArchetypeMap::Count(const ECSSignature& a_required) const
+{
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < m_archetype_count; i++)
+		if ((m_archetypes[i].signature & a_required) == a_required)
+			count += m_archetypes[i].entity_count;
+	return count;
+}
+
+uint32_t ECSArchetypeMap::GetOrCreateArchetype(const ECSSignature& a_signature)
+{
+	// archetype counts stay low, a linear search is fine.
+	for (uint32_t i = 0; i < m_archetype_count; i++)
+		if (m_archetypes[i].signature == a_signature)
+			return i;
+
+	BB_ASSERT(m_archetype_count < ECS_ARCHETYPE_MAX, "too many archetypes, increase ECS_ARCHETYPE_MAX");
+	const uint32_t archetype_index = m_archetype_count++;
+	Archetype& archetype = m_archetypes[archetype_index];
+	archetype.signature = a_signature;
+	archetype.entity_count = 0;
+
+	// worst case every column needs a full alignment worth of padding.
+	size_t entity_stride = sizeof(ECSEntity);
+	size_t padding = 0;
+	for (uint32_t i = 0; i < MAX_ECS_COMPONENTS; i++)
+	{
+		if (!a_signature[i])
+			continue;
+		BB_ASSERT(m_component_info[i].size != 0, "component is not registered to the archetype map");
+		entity_stride += m_component_info[i].size;
+		padding += m_component_info[i].alignment;
+	}
+	const size_t header_size = RoundUp(sizeof(ECSArchetypeChunk), alignof(ECSEntity));
+	archetype.chunk_capacity = static_cast<uint32_t>((ECS_ARCHETYPE_CHUNK_SIZE - header_size - padding) / entity_stride);
+	BB_ASSERT(archetype.chunk_capacity != 0, "archetype is too big to fit a single entity in a chunk");
+
+	size_t offset = header_size + sizeof(ECSEntity) * archetype.chunk_capacity;
+	for (uint32_t i = 0; i < MAX_ECS_COMPONENTS; i++)
+	{
+		if (!a_signature[i])
+		{
+			archetype.column_offsets[i] = 0;
+			continue;
+		}
+		offset = RoundUp(offset, m_component_info[i].alignment);
+		archetype.column_offsets[i] = static_cast<uint32_t>(offset);
+		offset += static_cast<size_t>(m_component_info[i].size) * archetype.chunk_capacity;
+	}
+	BB_ASSERT(offset <= ECS_ARCHETYPE_CHUNK_SIZE, "archetype chunk layout is bigger then a chunk");
+
+	archetype.chunk_count = 0;
+	archetype.chunk_max = m_entity_max / archetype.chunk_capacity + 1;
+	archetype.chunks = ArenaAllocArr(m_arena, ECSArchetypeChunk*, archetype.chunk_max);
+	return archetype_index;
+}
+
+uint32_t ECSArchetypeMap::PushRow(const uint32_t a_archetype, const ECSEntity a_entity)
+{
+	Archetype& archetype = m_archetypes[a_archetype];
+	const uint32_t row = archetype.entity_count++;
+	const uint32_t chunk_index = row / archetype.chunk_capacity;
+	if (chunk_index == archetype.chunk_count)
+	{
+		BB_ASSERT(archetype.chunk_count < archetype.chunk_max, "archetype has more entities then the entity max");
+		ECSArchetypeChunk* chunk;
+		if (m_free_chunks)
+		{
+			chunk = m_free_chunks;
+			m_free_chunks = chunk->next_free;
+		}
+		else
+		{
+			chunk = reinterpret_cast<ECSArchetypeChunk*>(ArenaAllocNoZero(m_arena, ECS_ARCHETYPE_CHUNK_SIZE, 64));
+			++m_chunk_count;
+		}
+
+		chunk->count = 0;
+		chunk->archetype = a_archetype;
+		chunk->next_free = nullptr;
+		chunk->entities = reinterpret_cast<ECSEntity*>(Pointer::Add(chunk, RoundUp(sizeof(ECSArchetypeChunk), alignof(ECSEntity))));
+		for (uint32_t i = 0; i < MAX_ECS_COMPONENTS; i++)
+			chunk->columns[i] = archetype.signature[i] ? Pointer::Add(chunk, archetype.column_offsets[i]) : nullptr;
+		archetype.chunks[archetype.chunk_count++] = chunk;
+	}
+
+	ECSArchetypeChunk* chunk = archetype.chunks[chunk_index];
+	const uint32_t chunk_row = chunk->count++;
+	chunk->entities[chunk_row] = a_entity;
+	for (uint32_t i = 0; i < MAX_ECS_COMPONENTS; i++)
+		if (archetype.signature[i])
+			memset(Pointer::Add(chunk->columns[i], static_cast<size_t>(m_component_info[i].size) * chunk_row), 0, m_component_info[i].size);
+
+	return row;
+}
+
+void ECSArchetypeMap::RemoveRow(const uint32_t a_archetype, const uint32_t a_row)
+{
+	Archetype& archetype = m_archetypes[a_archetype];
+	const uint32_t last_row = archetype.entity_count - 1;
+	ECSArchetypeChunk* last_chunk = archetype.chunks[last_row / archetype.chunk_capacity];
+
+	// swap the last entity into the hole to keep the chunks packed.
+	if (a_row != last_row)
+	{
+		ECSArchetypeChunk* chunk = archetype.chunks[a_row / archetype.chunk_capacity];
+		const uint32_t chunk_row = a_row % archetype.chunk_capacity;
+		const uint32_t last_chunk_row = last_row % archetype.chunk_capacity;
+		for (uint32_t i = 0; i < MAX_ECS_COMPONENTS; i++)
+		{
+			if (!archetype.signature[i])
+				continue;
+			const size_t size = m_component_info[i].size;
+			memcpy(Pointer::Add(chunk->columns[i], size * chunk_row), Pointer::Add(last_chunk->columns[i], size * last_chunk_row), size);
+		}
+
+		const ECSEntity moved_entity = last_chunk->entities[last_chunk_row];
+		chunk->entities[chunk_row] = moved_entity;
+		m_locations[moved_entity.index].row = a_row;
+	}
+
+	--archetype.entity_count;
+	if (--last_chunk->count == 0)
+	{
+		--archetype.chunk_count;
+		last_chunk->next_free = m_free_chunks;
+		m_free_chunks = last_chunk;
+	}
+}
+
+void* ECSArchetypeMap::GetColumnElement(const Archetype& a_archetype, const uint32_t a_row, const uint32_t a_signature_index) const
+{
+	const ECSArchetypeChunk* chunk = a_archetype.chunks[a_row / a_archetype.chunk_capacity];
+	const uint32_t chunk_row = a_row % a_archetype.chunk_capacity;
+	return Pointer::Add(chunk->columns[a_signature_index], static_cast<size_t>(m_component_info[a_signature_index].size) * chunk_row);
+}
+
+const ECSArchetypeMap::Location* ECSArchetypeMap::FindLocation(const ECSEntity a_entity) const
+{
+	if (a_entity.index >= m_entity_max)
+		return nullptr;
+	const Location& location = m_locations[a_entity.index];
+	if (location.archetype == INVALID_ARCHETYPE)
+		return nullptr;
+
+	const Archetype& archetype = m_archetypes[location.archetype];
+	const ECSArchetypeChunk* chunk = archetype.chunks[location.row / archetype.chunk_capacity];
+	// stale handle, the index got reused by a newer entity.
+	if (chunk->entities[location.row % archetype.chunk_capacity] != a_entity)
+		return nullptr;
+	return &location;
+}
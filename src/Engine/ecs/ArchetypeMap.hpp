@@ -0,0 +1,179 @@
+#pragma once
+#include "ECSBase.hpp"
+#include "MemoryArena.hpp"
+
+namespace BB
+{
+	constexpr uint32_t ECS_ARCHETYPE_CHUNK_SIZE = kbSize * 16;
+	constexpr uint32_t ECS_ARCHETYPE_MAX = 64;
+
+	// a chunk holds the components of up to archetype.chunk_capacity entities.
+	// every component lives in its own contiguous column, columns[i] is nullptr if the archetype does not have signature i.
+	struct ECSArchetypeChunk
+	{
+		uint32_t count;
+		uint32_t archetype;
+		ECSEntity* entities;
+		void* columns[MAX_ECS_COMPONENTS];
+		ECSArchetypeChunk* next_free;
+	};
+
+	// archetype storage, entities with the same signature share chunks that store their components SoA.
+	// components must be trivially copyable as they are memcpy'd when an entity changes archetype.
+	class ECSArchetypeMap
+	{
+	public:
+		void Init(const uint32_t a_entity_max);
+		void Destroy();
+
+		template<typename Pool>
+		void RegisterComponent()
+		{
+			static_assert(is_ecs_component_pool_type<Pool>, "Pool has no Component type or SIGNATURE_INDEX");
+			static_assert(std::is_trivially_copyable_v<typename Pool::Component>, "archetype components must be trivially copyable");
+			RegisterComponent(Pool::SIGNATURE_INDEX, sizeof(typename Pool::Component), alignof(typename Pool::Component));
+		}
+		void RegisterComponent(const ECSSignatureIndex a_signature_index, const uint32_t a_size, const uint32_t a_alignment);
+
+		// creates an entity with all the components in the signature zero initialized.
+		bool AddEntity(const ECSEntity a_entity, const ECSSignature& a_signature);
+		bool RemoveEntity(const ECSEntity a_entity);
+		bool HasEntity(const ECSEntity a_entity) const;
+		// moves the entity to the archetype of a_signature, components that exist in both are kept.
+		bool ChangeSignature(const ECSEntity a_entity, const ECSSignature& a_signature);
+
+		// overwrites the component if the entity already has it, otherwise moves the entity to a new archetype.
+		template<typename Pool>
+		bool AddComponent(const ECSEntity a_entity, const typename Pool::Component& a_component)
+		{
+			void* component = AddComponent(a_entity, Pool::SIGNATURE_INDEX);
+			if (component == nullptr)
+				return false;
+			memcpy(component, &a_component, sizeof(a_component));
+			return true;
+		}
+
+		template<typename Pool>
+		bool RemoveComponent(const ECSEntity a_entity)
+		{
+			return RemoveComponent(a_entity, Pool::SIGNATURE_INDEX);
+		}
+
+		template<typename Pool>
+		typename Pool::Component& GetComponent(const ECSEntity a_entity) const
+		{
+			return *reinterpret_cast<typename Pool::Component*>(GetComponent(a_entity, Pool::SIGNATURE_INDEX));
+		}
+
+		template<typename Pool>
+		bool HasComponent(const ECSEntity a_entity) const
+		{
+			return HasComponent(a_entity, Pool::SIGNATURE_INDEX);
+		}
+
+		void* AddComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index);
+		bool RemoveComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index);
+		void* GetComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index) const;
+		bool HasComponent(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index) const;
+
+		template<typename... Pools>
+		static ECSSignature MakeSignature()
+		{
+			ECSSignature signature{};
+			(signature.set(Pools::SIGNATURE_INDEX.handle), ...);
+			return signature;
+		}
+
+		// a_func(const ECSEntity, Pools::Component&...) is called for every entity that has all the components.
+		template<typename... Pools, typename Func>
+		void ForEach(Func a_func) const
+		{
+			const ECSSignature required = MakeSignature<Pools...>();
+			for (uint32_t archetype_index = 0; archetype_index < m_archetype_count; archetype_index++)
+			{
+				const Archetype& archetype = m_archetypes[archetype_index];
+				if ((archetype.signature & required) != required)
+					continue;
+
+				for (uint32_t chunk_index = 0; chunk_index < archetype.chunk_count; chunk_index++)
+					ForEachInChunk<Pools...>(*archetype.chunks[chunk_index], a_func);
+			}
+		}
+
+		// gathers every chunk that matches the pools so the iteration can be split up between threads with ForEachInChunk.
+		template<typename... Pools>
+		ConstSlice<ECSArchetypeChunk*> GatherChunks(MemoryArena& a_arena) const
+		{
+			return GatherChunks(a_arena, MakeSignature<Pools...>());
+		}
+		ConstSlice<ECSArchetypeChunk*> GatherChunks(MemoryArena& a_arena, const ECSSignature& a_required) const;
+
+		template<typename... Pools, typename Func>
+		static void ForEachInChunk(const ECSArchetypeChunk& a_chunk, Func& a_func)
+		{
+			ForEachInChunkImpl(a_chunk, a_func, reinterpret_cast<typename Pools::Component*>(a_chunk.columns[Pools::SIGNATURE_INDEX.handle])...);
+		}
+
+		template<typename... Pools>
+		uint32_t Count() const
+		{
+			return Count(MakeSignature<Pools...>());
+		}
+		uint32_t Count(const ECSSignature& a_required) const;
+
+		uint32_t GetArchetypeCount() const { return m_archetype_count; }
+		uint32_t GetChunkCount() const { return m_chunk_count; }
+
+	private:
+		template<typename Func, typename... Components>
+		static void ForEachInChunkImpl(const ECSArchetypeChunk& a_chunk, Func& a_func, Components*... a_columns)
+		{
+			for (uint32_t i = 0; i < a_chunk.count; i++)
+				a_func(a_chunk.entities[i], a_columns[i]...);
+		}
+
+		struct Archetype
+		{
+			ECSSignature signature;
+			uint32_t entity_count;
+			uint32_t chunk_capacity;
+			uint32_t column_offsets[MAX_ECS_COMPONENTS];
+
+			uint32_t chunk_count;
+			uint32_t chunk_max;
+			ECSArchetypeChunk** chunks;
+		};
+
+		struct Location
+		{
+			uint32_t archetype;
+			uint32_t row;
+		};
+
+		struct ComponentInfo
+		{
+			uint32_t size;
+			uint32_t alignment;
+		};
+
+		uint32_t GetOrCreateArchetype(const ECSSignature& a_signature);
+		uint32_t PushRow(const uint32_t a_archetype, const ECSEntity a_entity);
+		void RemoveRow(const uint32_t a_archetype, const uint32_t a_row);
+		void* GetColumnElement(const Archetype& a_archetype, const uint32_t a_row, const uint32_t a_signature_index) const;
+		const Location* FindLocation(const ECSEntity a_entity) const;
+
+		MemoryArena m_arena;
+		uint32_t m_entity_max;
+		ComponentInfo m_component_info[MAX_ECS_COMPONENTS];
+
+		uint32_t m_archetype_count;
+		Archetype m_archetypes[ECS_ARCHETYPE_MAX];
+
+		uint32_t m_chunk_count;
+		// empty chunks are reused by any archetype.
+		ECSArchetypeChunk* m_free_chunks;
+
+		// indexed by ECSEntity::index
+		Location* m_locations;
+	};
+}
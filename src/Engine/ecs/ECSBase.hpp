@@ -20,6 +20,13 @@ namespace BB
 
     constexpr ECSSignatureIndex BOUNDING_BOX_ECS_SIGNATURE = ECSSignatureIndex(10);
 
+    // not a component, systems use it in their ECSSystemAccess for the shared list of changed shadow caster bounds.
+    constexpr ECSSignatureIndex CHANGED_CASTER_BOUNDS_ECS_SIGNATURE = ECSSignatureIndex(MAX_ECS_COMPONENTS - 1);
+    struct ChangedCasterBoundsResource
+    {
+        static constexpr ECSSignatureIndex SIGNATURE_INDEX = CHANGED_CASTER_BOUNDS_ECS_SIGNATURE;
+    };
+
 	class EntitySparseSet
 	{
 	public:
@@ -141,10 +148,21 @@ namespace BB
 		{ v.GetSignatureIndex() } -> std::same_as<ECSSignatureIndex>;
 	};
 
+	// pool types are used to name components in archetype queries, see ECSArchetypeMap.
+	template <typename T>
+	concept is_ecs_component_pool_type = requires
+	{
+		typename T::Component;
+		{ T::SIGNATURE_INDEX } -> std::convertible_to<ECSSignatureIndex>;
+	};
+
 	template <typename T, ECSSignatureIndex ECS_INDEX>
 	class ECSComponentBase
 	{
 	public:
+		using Component = T;
+		static constexpr ECSSignatureIndex SIGNATURE_INDEX = ECS_INDEX;
+
 		void Init(struct MemoryArena& a_arena, const uint32_t a_entity_max)
 		{
 			m_components.Init(a_arena, a_entity_max);
@@ -0,0 +1,112 @@
+#include "EntityCommandBuffer.hpp"
+
+using namespace BB;
+
+constexpr size_t ECS_COMMAND_ALIGNMENT = 16;
+
+void ECSCommandBuffer::Init(MemoryArena& a_arena, const size_t a_command_memory)
+{
+	m_memory = reinterpret_cast<char*>(ArenaAllocNoZero(a_arena, a_command_memory, ECS_COMMAND_ALIGNMENT));
+	m_memory_size = a_command_memory;
+	Clear();
+}
+
+void ECSCommandBuffer::Reset()
+{
+	// the names are interned when they are recorded, give them back if they never reach the ecs.
+	for (size_t offset = 0; offset < m_memory_used;)
+	{
+		const ECSCommandHeader& header = *reinterpret_cast<const ECSCommandHeader*>(&m_memory[offset]);
+		if (header.type == ECS_COMMAND::CREATE_ENTITY)
+			StringAtomRelease(reinterpret_cast<const ECSCreateEntityCommand*>(&header + 1)->name);
+		else if (header.type == ECS_COMMAND::ASSIGN_NAME)
+			StringAtomRelease(*reinterpret_cast<const StringAtom*>(&header + 1));
+		offset += header.size;
+	}
+	Clear();
+}
+
+void ECSCommandBuffer::Clear()
+{
+	m_memory_used = 0;
+	m_command_count = 0;
+	m_create_count = 0;
+}
+
+ECSEntity ECSCommandBuffer::CreateEntity(const NameComponent& a_name, const ECSEntity a_parent, const float3 a_position, const float3x3 a_rotation, const float3 a_scale)
+{
+	// interning is thread safe, so the name is stored as an atom instead of the full string. The entity owns it after playback.
+	ECSCreateEntityCommand command;
+	command.name = StringAtomInternTransient(a_name.GetView());
+	command.parent = a_parent;
+	command.position = a_position;
+	command.rotation = a_rotation;
+	command.scale = a_scale;
+
+	const ECSEntity entity = ECSEntity(m_create_count, ECS_DEFERRED_ENTITY_SENTINEL);
+	if (!PushCommand(ECS_COMMAND::CREATE_ENTITY, entity, command))
+	{
+		StringAtomRelease(command.name);
+		return INVALID_ECS_OBJ;
+	}
+	++m_create_count;
+	return entity;
+}
+
+bool ECSCommandBuffer::DestroyEntity(const ECSEntity a_entity)
+{
+	return AllocateCommand(ECS_COMMAND::DESTROY_ENTITY, a_entity, 0) != nullptr;
+}
+
+bool ECSCommandBuffer::SetParent(const ECSEntity a_entity, const ECSEntity a_parent)
+{
+	return PushCommand(ECS_COMMAND::SET_PARENT, a_entity, a_parent);
+}
+
+bool ECSCommandBuffer::AssignName(const ECSEntity a_entity, const NameComponent& a_name)
+{
+	const StringAtom name = StringAtomInternTransient(a_name.GetView());
+	if (PushCommand(ECS_COMMAND::ASSIGN_NAME, a_entity, name))
+		return true;
+	StringAtomRelease(name);
+	return false;
+}
+
+bool ECSCommandBuffer::AssignBoundingBox(const ECSEntity a_entity, const BoundingBox& a_box)
+{
+	return PushCommand(ECS_COMMAND::ASSIGN_BOUNDING_BOX, a_entity, a_box);
+}
+
+bool ECSCommandBuffer::AssignRenderComponent(const ECSEntity a_entity, const RenderComponent& a_draw_info)
+{
+	return PushCommand(ECS_COMMAND::ASSIGN_RENDER, a_entity, a_draw_info);
+}
+
+bool ECSCommandBuffer::AssignLight(const ECSEntity a_entity, const LightComponent& a_light)
+{
+	return PushCommand(ECS_COMMAND::ASSIGN_LIGHT, a_entity, a_light);
+}
+
+bool ECSCommandBuffer::AssignRaytraceComponent(const ECSEntity a_entity, const RaytraceComponent& a_raytrace)
+{
+	return PushCommand(ECS_COMMAND::ASSIGN_RAYTRACE, a_entity, a_raytrace);
+}
+
+void* ECSCommandBuffer::AllocateCommand(const ECS_COMMAND a_type, const ECSEntity a_entity, const size_t a_payload_size)
+{
+	const size_t command_size = Pointer::AlignPad(sizeof(ECSCommandHeader) + a_payload_size, ECS_COMMAND_ALIGNMENT);
+	if (m_memory_used + command_size > m_memory_size)
+	{
+		BB_WARNING(false, "ecs command buffer is full, the command is not recorded. Submit more often or give the buffer more memory", WarningType::HIGH);
+		return nullptr;
+	}
+
+	ECSCommandHeader* header = reinterpret_cast<ECSCommandHeader*>(&m_memory[m_memory_used]);
+	header->type = a_type;
+	header->size = static_cast<uint32_t>(command_size);
+	header->entity = a_entity;
+
+	m_memory_used += command_size;
+	++m_command_count;
+	return header + 1;
+}
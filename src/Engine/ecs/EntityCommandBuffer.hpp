@@ -0,0 +1,106 @@
+#pragma once
+#include "ECSBase.hpp"
+#include "components/NameComponent.hpp"
+#include "components/RenderComponent.hpp"
+#include "components/LightComponent.hpp"
+#include "components/RaytraceComponent.hpp"
+
+#include "Math/Math.inl"
+
+namespace BB
+{
+	// also the playback order, commands of the same type keep the order they were recorded in.
+	enum class ECS_COMMAND : uint32_t
+	{
+		CREATE_ENTITY,
+		SET_PARENT,
+		ASSIGN_NAME,
+		ASSIGN_BOUNDING_BOX,
+		ASSIGN_RENDER,
+		ASSIGN_LIGHT,
+		ASSIGN_RAYTRACE,
+		DESTROY_ENTITY,
+		ENUM_SIZE
+	};
+
+	// entities returned by ECSCommandBuffer::CreateEntity have this as extra_index.
+	// they only exist inside commands and are replaced by the real entity during playback.
+	constexpr uint32_t ECS_DEFERRED_ENTITY_SENTINEL = UINT32_MAX - 1;
+
+	inline bool IsDeferredEntity(const ECSEntity a_entity)
+	{
+		return a_entity.extra_index == ECS_DEFERRED_ENTITY_SENTINEL;
+	}
+
+	// every command is a header followed by the payload, both 16 byte aligned.
+	struct ECSCommandHeader
+	{
+		ECS_COMMAND type;
+		uint32_t size; // header + payload
+		ECSEntity entity;
+	};
+	static_assert(sizeof(ECSCommandHeader) == 16);
+
+	struct ECSCreateEntityCommand
+	{
+		StringAtom name;
+		ECSEntity parent;
+		float3 position;
+		float3x3 rotation;
+		float3 scale;
+	};
+
+	// records structural ecs changes so that they can be made from any thread or while systems iterate.
+	// give every thread its own buffer, submit it with EntityComponentSystem::SubmitCommandBuffer and
+	// the commands are played back at the next sync point.
+	// recording fails when the buffer is full, CreateEntity then returns INVALID_ECS_OBJ and the rest return false.
+	class ECSCommandBuffer
+	{
+	public:
+		friend class EntityComponentSystem;
+		void Init(MemoryArena& a_arena, const size_t a_command_memory);
+		// throws away the commands that were not submitted.
+		void Reset();
+
+		// the returned entity can be used by later commands in this buffer, it becomes a real entity after playback.
+		ECSEntity CreateEntity(const NameComponent& a_name = "#UNNAMED#", const ECSEntity a_parent = INVALID_ECS_OBJ, const float3 a_position = float3(0.f), const float3x3 a_rotation = Float3x3Identity(), const float3 a_scale = float3(1.f));
+		// destroys the children as well.
+		bool DestroyEntity(const ECSEntity a_entity);
+		// an invalid parent makes the entity a root entity.
+		bool SetParent(const ECSEntity a_entity, const ECSEntity a_parent);
+
+		bool AssignName(const ECSEntity a_entity, const NameComponent& a_name);
+		bool AssignBoundingBox(const ECSEntity a_entity, const BoundingBox& a_box);
+		bool AssignRenderComponent(const ECSEntity a_entity, const RenderComponent& a_draw_info);
+		bool AssignLight(const ECSEntity a_entity, const LightComponent& a_light);
+		bool AssignRaytraceComponent(const ECSEntity a_entity, const RaytraceComponent& a_raytrace);
+
+		const void* GetCommands() const { return m_memory; }
+		size_t GetCommandMemoryUsed() const { return m_memory_used; }
+		uint32_t GetCommandCount() const { return m_command_count; }
+		uint32_t GetCreateCount() const { return m_create_count; }
+
+	private:
+		// empties the buffer without releasing the name atoms, the submitted copy owns them.
+		void Clear();
+		// returns nullptr when the buffer is full.
+		void* AllocateCommand(const ECS_COMMAND a_type, const ECSEntity a_entity, const size_t a_payload_size);
+
+		template<typename T>
+		bool PushCommand(const ECS_COMMAND a_type, const ECSEntity a_entity, const T& a_payload)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "command payloads are memcpy'd");
+			void* payload = AllocateCommand(a_type, a_entity, sizeof(T));
+			if (payload == nullptr)
+				return false;
+			memcpy(payload, &a_payload, sizeof(T));
+			return true;
+		}
+
+		char* m_memory;
+		size_t m_memory_used;
+		size_t m_memory_size;
+		uint32_t m_command_count;
+		uint32_t m_create_count;
+	};
+}
@@ -7,8 +7,13 @@
 #include "Math/Math.inl"
 #include "Math/Collision.inl"
 
+#include <cfloat>
+
 using namespace BB;
 
+// when more casters move the shadow cache invalidates everything.
+constexpr uint32_t CHANGED_CASTER_BOUNDS_MAX = 1024;
+
 constexpr ECSSignatureIndex SIGNATURES[] =
 {
     RELATION_ECS_SIGNATURE,
@@ -23,6 +28,9 @@ constexpr ECSSignatureIndex SIGNATURES[] =
 bool EntityComponentSystem::Init(MemoryArena& a_arena, const EntityComponentSystemCreateInfo& a_create_info, const StackString<32> a_name)
 {
 	m_name = a_name;
+	StackString<32> rendering_name = m_name;
+	rendering_name.append(" - render");
+	m_render_profile_name = StringAtomIntern(rendering_name.GetView());
 
 	m_per_frame.Init(a_arena, a_create_info.render_frame_count);
 	m_per_frame.resize(a_create_info.render_frame_count);
@@ -33,46 +41,128 @@ bool EntityComponentSystem::Init(MemoryArena& a_arena, const EntityComponentSyst
 
 	// components
 	m_ecs_entities.Init(a_arena, a_create_info.entity_count);
-	m_relations.Init(a_arena, a_create_info.entity_count);
-	m_name_pool.Init(a_arena, a_create_info.entity_count);
-    m_bounding_box_pool.Init(a_arena, a_create_info.entity_count);
-	m_positions.Init(a_arena, a_create_info.entity_count);
-	m_rotations.Init(a_arena, a_create_info.entity_count);
-	m_scales.Init(a_arena, a_create_info.entity_count);
-	m_local_matrices.Init(a_arena, a_create_info.entity_count);
-	m_world_matrices.Init(a_arena, a_create_info.entity_count);
-	m_render_mesh_pool.Init(a_arena, a_create_info.render_mesh_count, a_create_info.entity_count);
-	m_light_pool.Init(a_arena, a_create_info.light_count, a_create_info.entity_count);
-    m_raytrace_pool.Init(a_arena, a_create_info.render_mesh_count, a_create_info.entity_count);
+	m_archetype_storage = a_create_info.archetype_storage;
+	if (m_archetype_storage)
+	{
+		// the archetype map has its own arena, memory grows with the components that are actually used.
+		m_archetypes.Init(a_create_info.entity_count);
+		m_archetypes.RegisterComponent<RelationComponentPool>();
+		m_archetypes.RegisterComponent<NameComponentPool>();
+		m_archetypes.RegisterComponent<BoundingBoxComponentPool>();
+		m_archetypes.RegisterComponent<PositionComponentPool>();
+		m_archetypes.RegisterComponent<RotationComponentPool>();
+		m_archetypes.RegisterComponent<ScaleComponentPool>();
+		m_archetypes.RegisterComponent<LocalMatrixComponentPool>();
+		m_archetypes.RegisterComponent<WorldMatrixComponentPool>();
+		m_archetypes.RegisterComponent<RenderComponentPool>();
+		m_archetypes.RegisterComponent<LightComponentPool>();
+		m_archetypes.RegisterComponent<RaytraceComponentPool>();
+	}
+	else
+	{
+		m_relations.Init(a_arena, a_create_info.entity_count);
+		m_name_pool.Init(a_arena, a_create_info.entity_count);
+		m_bounding_box_pool.Init(a_arena, a_create_info.entity_count);
+		m_positions.Init(a_arena, a_create_info.entity_count);
+		m_rotations.Init(a_arena, a_create_info.entity_count);
+		m_scales.Init(a_arena, a_create_info.entity_count);
+		m_local_matrices.Init(a_arena, a_create_info.entity_count);
+		m_world_matrices.Init(a_arena, a_create_info.entity_count);
+		m_render_mesh_pool.Init(a_arena, a_create_info.render_mesh_count, a_create_info.entity_count);
+		m_light_pool.Init(a_arena, a_create_info.light_count, a_create_info.entity_count);
+		m_raytrace_pool.Init(a_arena, a_create_info.render_mesh_count, a_create_info.entity_count);
+	}
 
 	// maybe better system for this?
 	m_transform_system.dirty_transforms.Init(a_arena, a_create_info.entity_count, a_create_info.entity_count);
+	m_transform_system.changed_bounds.Init(a_arena, CHANGED_CASTER_BOUNDS_MAX);
+	m_transform_system.changed_bounds_overflow = false;
 	m_root_entity_system.root_entities.Init(a_arena, a_create_info.entity_count, a_create_info.entity_count / 4);
 
-	m_render_system.Init(a_arena, a_create_info.render_frame_count, a_create_info.light_count, a_create_info.window_size);
+	m_render_system.Init(a_arena, a_create_info.render_frame_count, a_create_info.light_count, a_create_info.render_mesh_count, a_create_info.window_size);
+	m_render_light_system.lights.Init(a_arena, a_create_info.light_count);
+
+	m_command_queue.lock = OSCreateRWLock();
+	m_command_queue.arena = MemoryArenaCreate();
+	m_command_queue.first = nullptr;
+	m_command_queue.last = nullptr;
+	m_command_queue.command_count = 0;
+	m_command_queue.create_count = 0;
+
+	m_system_scheduler.Init(a_arena, ECS_SYSTEM_MAX);
+	ECSSystemCreateInfo transform_system;
+	transform_system.name = "transform system";
+	transform_system.function = [](EntityComponentSystem& a_ecs, MemoryArena&, void*)
+	{
+		a_ecs.TransformSystemUpdate();
+	};
+	transform_system.user_data = nullptr;
+	// moved casters read their render component bounds and add them to the changed caster bounds.
+	transform_system.access = ECSSystemAccess()
+		.Read<RelationComponentPool, PositionComponentPool, RotationComponentPool, ScaleComponentPool, RenderComponentPool>()
+		.Write<LocalMatrixComponentPool, WorldMatrixComponentPool, ChangedCasterBoundsResource>();
+	RegisterSystem(transform_system);
+
+	// the cpu side of rendering, RenderSystemUpdate uses what they made.
+	ECSSystemCreateInfo render_transform_system;
+	render_transform_system.name = "render transform system";
+	render_transform_system.function = [](EntityComponentSystem& a_ecs, MemoryArena&, void*)
+	{
+		a_ecs.RenderTransformSystemUpdate();
+	};
+	render_transform_system.user_data = nullptr;
+	render_transform_system.access = ECSSystemAccess()
+		.Read<WorldMatrixComponentPool, RenderComponentPool>();
+	RegisterSystem(render_transform_system);
+
+	ECSSystemCreateInfo render_light_system;
+	render_light_system.name = "render light system";
+	render_light_system.function = [](EntityComponentSystem& a_ecs, MemoryArena&, void*)
+	{
+		a_ecs.RenderLightSystemUpdate();
+	};
+	render_light_system.user_data = nullptr;
+	render_light_system.access = ECSSystemAccess()
+		.Read<LightComponentPool>();
+	RegisterSystem(render_light_system);
 
 	return true;
 }
 
 ECSEntity EntityComponentSystem::CreateEntity(const NameComponent& a_name, const ECSEntity& a_parent, const float3 a_position, const float3x3 a_rotation, const float3 a_scale)
+{
+	return CreateEntity(StringAtomInternTransient(a_name.GetView()), a_parent, a_position, a_rotation, a_scale);
+}
+
+ECSEntity EntityComponentSystem::CreateEntity(const StringAtom a_name, const ECSEntity& a_parent, const float3 a_position, const float3x3 a_rotation, const float3 a_scale)
 {
 	ECSEntity entity;
 	bool success = m_ecs_entities.CreateEntity(entity);
 	BB_ASSERT(success, "error creating ecs entity");
 
+	if (m_archetype_storage)
+	{
+		// place the entity in its final archetype directly instead of moving it for every component.
+		ECSSignature signature{};
+		for (size_t i = 0; i < _countof(SIGNATURES); i++)
+			signature.set(SIGNATURES[i].handle);
+		success = m_archetypes.AddEntity(entity, signature);
+		BB_ASSERT(success, "ecs entity was not correctly deleted");
+	}
+
 	success = AddEntityRelation(entity, a_parent);
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
-	success = m_name_pool.CreateComponent(entity, a_name);
+	success = CreateComponent(m_name_pool, entity, a_name);
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
-	success = m_positions.CreateComponent(entity, a_position);
+	success = CreateComponent(m_positions, entity, a_position);
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
-	success = m_rotations.CreateComponent(entity, a_rotation);
+	success = CreateComponent(m_rotations, entity, a_rotation);
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
-	success = m_scales.CreateComponent(entity, a_scale);
+	success = CreateComponent(m_scales, entity, a_scale);
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
-	success = m_local_matrices.CreateComponent(entity);
+	success = CreateComponent(m_local_matrices, entity, float4x4());
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
-	success = m_world_matrices.CreateComponent(entity);
+	success = CreateComponent(m_world_matrices, entity, float4x4());
 	BB_ASSERT(success, "ecs entity was not correctly deleted");
 	// register to transform dirty system
 	const uint32_t res = m_transform_system.dirty_transforms.Insert(entity);
@@ -84,12 +174,120 @@ ECSEntity EntityComponentSystem::CreateEntity(const NameComponent& a_name, const
 	return entity;
 }
 
+bool EntityComponentSystem::CreateEntities(MemoryArena& a_temp_arena, const ConstSlice<ECSEntityPrototype> a_prototypes, const ECSEntity a_parent, const Slice<ECSEntity> a_out_entities)
+{
+	BB_ASSERT(a_prototypes.size() == a_out_entities.size(), "a_out_entities is not the same size as a_prototypes");
+	if (a_parent.IsValid() && !ValidateEntity(a_parent))
+		return false;
+	if (!m_ecs_entities.CreateEntities(a_out_entities))
+		return false;
+
+	ECSSignature base_signature{};
+	for (size_t i = 0; i < _countof(SIGNATURES); i++)
+		base_signature.set(SIGNATURES[i].handle);
+
+	MemoryArenaScope(a_temp_arena)
+	{
+		// remember the last child of every parent, so adding a sibling does not walk the child list.
+		ECSEntity* last_children = ArenaAllocArr(a_temp_arena, ECSEntity, a_prototypes.size());
+		ECSEntity parent_last_child = INVALID_ECS_OBJ;
+		if (a_parent.IsValid())
+		{
+			const EntityRelation& parent_relation = GetComponent(m_relations, a_parent);
+			parent_last_child = parent_relation.first_child;
+			for (size_t i = 1; i < parent_relation.child_count; i++)
+				parent_last_child = GetComponent(m_relations, parent_last_child).next;
+		}
+
+		for (size_t i = 0; i < a_prototypes.size(); i++)
+		{
+			const ECSEntityPrototype& prototype = a_prototypes[i];
+			const ECSEntity entity = a_out_entities[i];
+			last_children[i] = INVALID_ECS_OBJ;
+
+			ECSSignature signature = base_signature;
+			if (prototype.has_bounding_box)
+				signature.set(BOUNDING_BOX_ECS_SIGNATURE.handle);
+
+			bool success = true;
+			if (m_archetype_storage)
+			{
+				// the render component is assigned below, placing the entity with it already saves a move.
+				ECSSignature archetype_signature = signature;
+				if (prototype.has_render_component)
+					archetype_signature.set(RENDER_ECS_SIGNATURE.handle);
+				success = m_archetypes.AddEntity(entity, archetype_signature);
+				BB_ASSERT(success, "ecs entity was not correctly deleted");
+			}
+
+			EntityRelation relation;
+			relation.parent = a_parent;
+			relation.child_count = 0;
+			relation.first_child = INVALID_ECS_OBJ;
+			relation.next = INVALID_ECS_OBJ;
+			ECSEntity* last_child = &parent_last_child;
+			if (prototype.parent_index != ECS_PROTOTYPE_NO_PARENT)
+			{
+				BB_ASSERT(prototype.parent_index < i, "a prototype parent must come before its children");
+				relation.parent = a_out_entities[prototype.parent_index];
+				last_child = &last_children[prototype.parent_index];
+			}
+
+			if (relation.parent.IsValid())
+			{
+				EntityRelation& parent_relation = GetComponent(m_relations, relation.parent);
+				if (last_child->IsValid())
+					GetComponent(m_relations, *last_child).next = entity;
+				else
+					parent_relation.first_child = entity;
+				++parent_relation.child_count;
+				*last_child = entity;
+			}
+			else
+				m_root_entity_system.root_entities.Insert(entity);
+
+			// parents are created first so their world matrix is already there, the matrices are right before the transform pass.
+			float4x4 local_matrix = Float4x4FromTranslation(prototype.position) * prototype.rotation;
+			local_matrix = Float4x4Scale(local_matrix, prototype.scale);
+			float4x4 world_matrix = local_matrix;
+			if (relation.parent.IsValid())
+				world_matrix = GetComponent(m_world_matrices, relation.parent) * local_matrix;
+
+			success &= CreateComponent(m_relations, entity, relation);
+			success &= CreateComponent(m_name_pool, entity, prototype.name);
+			success &= CreateComponent(m_positions, entity, prototype.position);
+			success &= CreateComponent(m_rotations, entity, prototype.rotation);
+			success &= CreateComponent(m_scales, entity, prototype.scale);
+			success &= CreateComponent(m_local_matrices, entity, local_matrix);
+			success &= CreateComponent(m_world_matrices, entity, world_matrix);
+			if (prototype.has_bounding_box)
+				success &= CreateComponent(m_bounding_box_pool, entity, prototype.bounding_box);
+			BB_ASSERT(success, "failed to create the components of a prototype entity");
+			// the same as CreateEntity, the transform pass still sees the new entity.
+			const uint32_t res = m_transform_system.dirty_transforms.Insert(entity);
+			BB_ASSERT(res != SPARSE_SET_INVALID && res != SPARSE_SET_ALREADY_SET, "ecs entity can't be added to dirty transforms");
+
+			success = m_ecs_entities.RegisterSignatures(entity, signature);
+			BB_ASSERT(success, "ecs entity was not correctly deleted");
+
+			// after the matrices, the shadow casters need the world bounds of the new caster.
+			if (prototype.has_render_component)
+			{
+				success = EntityAssignRenderComponent(entity, prototype.render_component);
+				BB_ASSERT(success, "failed to assign the render component of a prototype entity");
+			}
+		}
+	}
+
+	return true;
+}
+
 void EntityComponentSystem::FindECSEntityClickTraverse(const ECSEntity a_entity, const float3& a_ray_origin, const float3& a_ray_dir, ECSEntity& a_found, float& a_found_dist)
 {
     if (m_ecs_entities.HasSignature(a_entity, BOUNDING_BOX_ECS_SIGNATURE)) // intersects
     {
-        const float4x4& world_mat = m_world_matrices.GetComponent(a_entity);
-        const BoundingBox box = m_bounding_box_pool.GetComponent(a_entity);
+        const float4x4& world_mat = GetComponent(m_world_matrices, a_entity);
+        const BoundingBox box = GetComponent(m_bounding_box_pool, a_entity);
 
         const float4 p0 = (world_mat * float4(box.min.x, box.min.y, box.min.z, 1.0));
         const float4 p1 = (world_mat * float4(box.max.x, box.max.y, box.max.z, 1.0));
@@ -104,7 +302,7 @@ void EntityComponentSystem::FindECSEntityClickTraverse(const ECSEntity a_entity,
         }
     }
 
-    const EntityRelation relation = m_relations.GetComponent(a_entity);
+    const EntityRelation relation = GetComponent(m_relations, a_entity);
 
     if (relation.child_count == 0)
         return;
@@ -113,7 +311,7 @@ void EntityComponentSystem::FindECSEntityClickTraverse(const ECSEntity a_entity,
     for (size_t i = 0; i < relation.child_count; i++)
     {
         FindECSEntityClickTraverse(child, a_ray_origin, a_ray_dir, a_found, a_found_dist);
-        const EntityRelation child_relation = m_relations.GetComponent(child);
+        const EntityRelation child_relation = GetComponent(m_relations, child);
         child = child_relation.next;
     }
 
@@ -137,16 +335,220 @@ bool EntityComponentSystem::DestroyEntity(const ECSEntity a_entity)
     if (!ValidateEntity(a_entity))
         return false;
 
-    const EntityRelation relation = m_relations.GetComponent(a_entity);
+    const EntityRelation relation = GetComponent(m_relations, a_entity);
     ECSEntity child = relation.first_child;
     for (size_t i = 0; i < relation.child_count; i++)
     {
-        const EntityRelation child_relation = m_relations.GetComponent(child);
+        const EntityRelation child_relation = GetComponent(m_relations, child);
         const ECSEntity next_child = child_relation.next;
         DestroyEntity(child);
         child = next_child;
     }
 
+    // the children unlink themselves, so the parent is never left pointing at a freed entity.
+    UnlinkFromParent(a_entity, GetComponent(m_relations, a_entity));
+    m_transform_system.dirty_transforms.Erase(a_entity);
+    FreePoolComponents(a_entity);
+
+    return m_ecs_entities.FreeEntity(a_entity);
+}
+
+bool EntityComponentSystem::SetParent(const ECSEntity a_entity, const ECSEntity a_parent)
+{
+    if (!ValidateEntity(a_entity))
+        return false;
+    if (a_parent.IsValid())
+    {
+        if (!ValidateEntity(a_parent))
+            return false;
+        // an entity can not become a child of itself or of one of its own children.
+        for (ECSEntity ancestor = a_parent; ancestor.IsValid(); ancestor = GetComponent(m_relations, ancestor).parent)
+            if (ancestor == a_entity)
+                return false;
+    }
+
+    EntityRelation& relation = GetComponent(m_relations, a_entity);
+    if (relation.parent == a_parent)
+        return true;
+
+    UnlinkFromParent(a_entity, relation);
+    LinkToParent(a_entity, relation, a_parent);
+    // the world matrix of the entity and its children changes with the parent.
+    m_transform_system.dirty_transforms.Insert(a_entity);
+    return true;
+}
+
+static void OffsetDeferredEntity(ECSEntity& a_entity, const uint32_t a_offset)
+{
+    if (IsDeferredEntity(a_entity))
+        a_entity.index += a_offset;
+}
+
+static ECSEntity ResolveDeferredEntity(const ECSEntity a_entity, const ECSEntity* a_created_entities)
+{
+    if (IsDeferredEntity(a_entity))
+        return a_created_entities[a_entity.index];
+    return a_entity;
+}
+
+void EntityComponentSystem::SubmitCommandBuffer(ECSCommandBuffer& a_command_buffer)
+{
+    if (a_command_buffer.GetCommandCount() == 0)
+        return;
+
+    BBRWLockScopeWrite lock(m_command_queue.lock);
+    const size_t size = a_command_buffer.GetCommandMemoryUsed();
+    char* commands = reinterpret_cast<char*>(ArenaAllocNoZero(m_command_queue.arena, size, alignof(ECSCommandHeader)));
+    memcpy(commands, a_command_buffer.GetCommands(), size);
+
+    // deferred entities are numbered per buffer, offset them so they are unique within the queue.
+    const uint32_t create_offset = m_command_queue.create_count;
+    for (size_t offset = 0; offset < size;)
+    {
+        ECSCommandHeader& header = *reinterpret_cast<ECSCommandHeader*>(&commands[offset]);
+        OffsetDeferredEntity(header.entity, create_offset);
+        if (header.type == ECS_COMMAND::CREATE_ENTITY)
+            OffsetDeferredEntity(reinterpret_cast<ECSCreateEntityCommand*>(&header + 1)->parent, create_offset);
+        else if (header.type == ECS_COMMAND::SET_PARENT)
+            OffsetDeferredEntity(*reinterpret_cast<ECSEntity*>(&header + 1), create_offset);
+        offset += header.size;
+    }
+
+    CommandQueue::Block* block = ArenaAllocType(m_command_queue.arena, CommandQueue::Block);
+    block->next = nullptr;
+    block->commands = commands;
+    block->size = size;
+    if (m_command_queue.last)
+        m_command_queue.last->next = block;
+    else
+        m_command_queue.first = block;
+    m_command_queue.last = block;
+    m_command_queue.command_count += a_command_buffer.GetCommandCount();
+    m_command_queue.create_count += a_command_buffer.GetCreateCount();
+    a_command_buffer.Clear();
+}
+
+void EntityComponentSystem::PlaybackCommandBuffers()
+{
+    BBRWLockScopeWrite lock(m_command_queue.lock);
+    if (m_command_queue.command_count == 0)
+        return;
+
+    MemoryArena& arena = m_command_queue.arena;
+    constexpr uint32_t TYPE_COUNT = static_cast<uint32_t>(ECS_COMMAND::ENUM_SIZE);
+
+    // counting sort on the command type, commands of the same type stay in submit order.
+    // this way all creates happen before anything references them and all destroys happen last.
+    uint32_t type_offsets[TYPE_COUNT]{};
+    for (const CommandQueue::Block* block = m_command_queue.first; block; block = block->next)
+        for (size_t offset = 0; offset < block->size; offset += reinterpret_cast<const ECSCommandHeader*>(&block->commands[offset])->size)
+            ++type_offsets[static_cast<uint32_t>(reinterpret_cast<const ECSCommandHeader*>(&block->commands[offset])->type)];
+
+    uint32_t command_index = 0;
+    for (uint32_t i = 0; i < TYPE_COUNT; i++)
+    {
+        const uint32_t type_count = type_offsets[i];
+        type_offsets[i] = command_index;
+        command_index += type_count;
+    }
+
+    const ECSCommandHeader** sorted_commands = ArenaAllocArr(arena, const ECSCommandHeader*, m_command_queue.command_count);
+    for (const CommandQueue::Block* block = m_command_queue.first; block; block = block->next)
+    {
+        for (size_t offset = 0; offset < block->size;)
+        {
+            const ECSCommandHeader* header = reinterpret_cast<const ECSCommandHeader*>(&block->commands[offset]);
+            sorted_commands[type_offsets[static_cast<uint32_t>(header->type)]++] = header;
+            offset += header->size;
+        }
+    }
+
+    ECSEntity* created_entities = ArenaAllocArr(arena, ECSEntity, m_command_queue.create_count);
+    for (uint32_t i = 0; i < m_command_queue.command_count; i++)
+        PlaybackCommand(*sorted_commands[i], created_entities);
+
+    MemoryArenaReset(arena);
+    m_command_queue.first = nullptr;
+    m_command_queue.last = nullptr;
+    m_command_queue.command_count = 0;
+    m_command_queue.create_count = 0;
+}
+
+void EntityComponentSystem::PlaybackCommand(const ECSCommandHeader& a_header, ECSEntity* a_created_entities)
+{
+    const void* payload = &a_header + 1;
+    if (a_header.type == ECS_COMMAND::CREATE_ENTITY)
+    {
+        const ECSCreateEntityCommand& command = *reinterpret_cast<const ECSCreateEntityCommand*>(payload);
+        ECSEntity parent = ResolveDeferredEntity(command.parent, a_created_entities);
+        // like the entity of the other commands, the parent can be destroyed after recording.
+        if (parent.IsValid() && !ValidateEntity(parent))
+        {
+            BB_WARNING(false, "ecs create command has an invalid parent, creating it as a root entity", WarningType::MEDIUM);
+            parent = INVALID_ECS_OBJ;
+        }
+        a_created_entities[a_header.entity.index] = CreateEntity(command.name, parent, command.position, command.rotation, command.scale);
+        return;
+    }
+
+    const ECSEntity entity = ResolveDeferredEntity(a_header.entity, a_created_entities);
+    // the entity can be destroyed by an earlier playback or by the main thread after recording.
+    if (!ValidateEntity(entity))
+    {
+        BB_WARNING(false, "ecs command on an invalid entity, skipping it", WarningType::MEDIUM);
+        // the name was never handed to a component.
+        if (a_header.type == ECS_COMMAND::ASSIGN_NAME)
+            StringAtomRelease(*reinterpret_cast<const StringAtom*>(payload));
+        return;
+    }
+
+    bool success = true;
+    switch (a_header.type)
+    {
+    case ECS_COMMAND::SET_PARENT:
+        success = SetParent(entity, ResolveDeferredEntity(*reinterpret_cast<const ECSEntity*>(payload), a_created_entities));
+        break;
+    case ECS_COMMAND::ASSIGN_NAME:
+        success = EntityAssignName(entity, *reinterpret_cast<const StringAtom*>(payload));
+        break;
+    case ECS_COMMAND::ASSIGN_BOUNDING_BOX:
+        success = EntityAssignBoundingBox(entity, *reinterpret_cast<const BoundingBox*>(payload));
+        break;
+    case ECS_COMMAND::ASSIGN_RENDER:
+        success = EntityAssignRenderComponent(entity, *reinterpret_cast<const RenderComponent*>(payload));
+        break;
+    case ECS_COMMAND::ASSIGN_LIGHT:
+        success = EntityAssignLight(entity, *reinterpret_cast<const LightComponent*>(payload));
+        break;
+    case ECS_COMMAND::ASSIGN_RAYTRACE:
+        success = EntityAssignRaytraceComponent(entity, *reinterpret_cast<const RaytraceComponent*>(payload));
+        break;
+    case ECS_COMMAND::DESTROY_ENTITY:
+        success = DestroyEntity(entity);
+        break;
+    default:
+        BB_ASSERT(false, "unknown ECS_COMMAND");
+        break;
+    }
+    BB_WARNING(success, "ecs command failed during playback", WarningType::MEDIUM);
+}
+
+void EntityComponentSystem::FreePoolComponents(const ECSEntity a_entity)
+{
+    // the shadow casters read the bounds from the components, so do this before they are gone in either storage.
+    if (m_ecs_entities.HasSignature(a_entity, RENDER_ECS_SIGNATURE))
+        AddChangedCasterBounds(a_entity);
+
+    if (m_archetype_storage)
+    {
+        if (m_archetypes.HasComponent<NameComponentPool>(a_entity))
+            StringAtomRelease(m_archetypes.GetComponent<NameComponentPool>(a_entity));
+        // one move out of the archetype instead of a move for every component.
+        const bool success = m_archetypes.RemoveEntity(a_entity);
+        BB_ASSERT(success, "ecs entity is not in the archetype map");
+        return;
+    }
+
     if (m_ecs_entities.HasSignature(a_entity, RELATION_ECS_SIGNATURE))
         m_relations.FreeComponent(a_entity);
     if (m_ecs_entities.HasSignature(a_entity, NAME_ECS_SIGNATURE))
@@ -170,12 +572,6 @@ bool EntityComponentSystem::DestroyEntity(const ECSEntity a_entity)
         m_raytrace_pool.FreeComponent(a_entity);
     if (m_ecs_entities.HasSignature(a_entity, BOUNDING_BOX_ECS_SIGNATURE))
         m_bounding_box_pool.FreeComponent(a_entity);
-
-    if (m_root_entity_system.root_entities.Find(a_entity.index) != SPARSE_SET_INVALID)
-        m_root_entity_system.root_entities.Erase(a_entity);
-
-    
-    return m_ecs_entities.FreeEntity(a_entity);
 }
 
 void EntityComponentSystem::AddLinesToFrame(const ConstSlice<Line> a_lines)
@@ -185,8 +581,8 @@ void EntityComponentSystem::AddLinesToFrame(const ConstSlice<Line> a_lines)
 
 void EntityComponentSystem::DrawAABB(const ECSEntity a_entity, const LineColor a_color)
 {
-    const float4x4& world_mat = m_world_matrices.GetComponent(a_entity);
-    const BoundingBox box = m_bounding_box_pool.GetComponent(a_entity);
+    const float4x4& world_mat = GetComponent(m_world_matrices, a_entity);
+    const BoundingBox box = GetComponent(m_bounding_box_pool, a_entity);
 
     const float4 p0 = (world_mat * float4(box.min.x, box.min.y, box.min.z, 1.0));
     const float4 p1 = (world_mat * float4(box.max.x, box.max.y, box.max.z, 1.0));
@@ -242,6 +638,7 @@ void EntityComponentSystem::DrawAABB(const ECSEntity a_entity, const LineColor a
 void EntityComponentSystem::StartFrame()
 {
 	PerFrame& frame = m_per_frame[m_current_frame];
+	MemoryArenaStatsNextFrame(frame.arena);
 	MemoryArenaReset(frame.arena);
 }
 
@@ -250,6 +647,24 @@ void EntityComponentSystem::EndFrame()
 	m_current_frame = (m_current_frame + 1) % m_per_frame.size();
 }
 
+void EntityComponentSystem::SystemsUpdate()
+{
+	// no system is running, so this is the sync point for the structural changes recorded since the last update.
+	// playing them back first means the systems and the render see the same entities this frame.
+	PlaybackCommandBuffers();
+	m_system_scheduler.Execute(*this, m_per_frame[m_current_frame].arena);
+}
+
+void EntityComponentSystem::RegisterSystem(const ECSSystemCreateInfo& a_create_info)
+{
+	ECSSystemCreateInfo create_info = a_create_info;
+	// the transform setters share the dirty transform set, so writing any of them counts as writing all of them.
+	const ECSSignature transform_signature = ECSArchetypeMap::MakeSignature<PositionComponentPool, RotationComponentPool, ScaleComponentPool>();
+	if ((create_info.access.write & transform_signature).any())
+		create_info.access.write |= transform_signature;
+	m_system_scheduler.RegisterSystem(create_info);
+}
+
 void EntityComponentSystem::TransformSystemUpdate()
 {
 	while (m_transform_system.dirty_transforms.Size() != 0)
@@ -258,15 +673,47 @@ void EntityComponentSystem::TransformSystemUpdate()
 	}
 }
 
+void EntityComponentSystem::RenderTransformSystemUpdate()
+{
+	if (m_archetype_storage)
+		m_render_system.PrepareDrawTransforms(m_archetypes);
+	else
+		m_render_system.PrepareDrawTransforms(m_world_matrices, m_render_mesh_pool);
+}
+
+void EntityComponentSystem::RenderLightSystemUpdate()
+{
+	StaticArray<LightComponent>& lights = m_render_light_system.lights;
+	lights.clear();
+	if (m_archetype_storage)
+	{
+		m_archetypes.ForEach<LightComponentPool>([&lights](const ECSEntity, LightComponent& a_light)
+		{
+			lights.push_back(a_light);
+		});
+	}
+	else
+	{
+		const ConstSlice<LightComponent> pool_lights = m_light_pool.GetAllComponents();
+		for (size_t i = 0; i < pool_lights.size(); i++)
+			lights.push_back(pool_lights[i]);
+	}
+}
+
 RenderSystemFrame EntityComponentSystem::RenderSystemUpdate(const RCommandList a_list, const uint2 a_draw_area_size)
 {
 	m_render_system.StartFrame(a_list);
+	m_render_system.SetChangedCasterBounds(m_transform_system.changed_bounds.const_slice(), m_transform_system.changed_bounds_overflow);
 
-	StackString<32> rendering_name = m_name;
-	rendering_name.append(" - render");
-	BB_START_PROFILE(rendering_name);
-	m_render_system.UpdateRenderSystem(m_per_frame[m_current_frame].arena, a_list, a_draw_area_size, m_world_matrices, m_render_mesh_pool, m_raytrace_pool, m_light_pool.GetAllComponents());
-	BB_END_PROFILE(rendering_name);
+	BB_START_PROFILE_ATOM(m_render_profile_name);
+	// the lights are gathered by the render light system during SystemsUpdate.
+	if (m_archetype_storage)
+		m_render_system.UpdateRenderSystem(m_per_frame[m_current_frame].arena, a_list, a_draw_area_size, m_archetypes, m_render_light_system.lights.const_slice());
+	else
+		m_render_system.UpdateRenderSystem(m_per_frame[m_current_frame].arena, a_list, a_draw_area_size, m_world_matrices, m_render_mesh_pool, m_raytrace_pool, m_render_light_system.lights.const_slice());
+	BB_END_PROFILE_ATOM(m_render_profile_name);
+	m_transform_system.changed_bounds.clear();
+	m_transform_system.changed_bounds_overflow = false;
 
     m_render_system.DebugDraw(a_list, a_draw_area_size);
 
@@ -276,55 +723,55 @@ RenderSystemFrame EntityComponentSystem::RenderSystemUpdate(const RCommandList a
 float3 EntityComponentSystem::Translate(const ECSEntity a_entity, const float3 a_translate)
 {
 	m_transform_system.dirty_transforms.Insert(a_entity);
-	float3& pos = m_positions.GetComponent(a_entity);
+	float3& pos = GetComponent(m_positions, a_entity);
 	return pos = pos + a_translate;
 }
 
 float3x3 EntityComponentSystem::Rotate(const ECSEntity a_entity, const float3x3 a_rotate)
 {
 	m_transform_system.dirty_transforms.Insert(a_entity);
-	float3x3& rot = m_rotations.GetComponent(a_entity);
+	float3x3& rot = GetComponent(m_rotations, a_entity);
 	return rot = rot * a_rotate;
 }
 
 float3 EntityComponentSystem::Scale(const ECSEntity a_entity, const float3 a_scale)
 {
 	m_transform_system.dirty_transforms.Insert(a_entity);
-	float3& scale = m_scales.GetComponent(a_entity);
+	float3& scale = GetComponent(m_scales, a_entity);
 	return scale = scale + a_scale;
 }
 
 void EntityComponentSystem::SetPosition(const ECSEntity a_entity, const float3 a_position)
 {
 	m_transform_system.dirty_transforms.Insert(a_entity);
-	m_positions.GetComponent(a_entity) = a_position;
+	GetComponent(m_positions, a_entity) = a_position;
 }
 
 void EntityComponentSystem::SetRotation(const ECSEntity a_entity, const float3x3 a_rotation)
 {
 	m_transform_system.dirty_transforms.Insert(a_entity);
-	m_rotations.GetComponent(a_entity) = a_rotation;
+	GetComponent(m_rotations, a_entity) = a_rotation;
 }
 
 void EntityComponentSystem::SetScale(const ECSEntity a_entity, const float3 a_scale)
 {
 	m_transform_system.dirty_transforms.Insert(a_entity);
-	m_scales.GetComponent(a_entity) = a_scale;
+	GetComponent(m_scales, a_entity) = a_scale;
 }
 
 float3 EntityComponentSystem::GetPosition(const ECSEntity a_entity) const
 {
-    return m_positions.GetComponent(a_entity);
+    return GetComponent(m_positions, a_entity);
 }
 
 float3x3 EntityComponentSystem::GetRotation(const ECSEntity a_entity) const
 {
-    return m_rotations.GetComponent(a_entity);
+    return GetComponent(m_rotations, a_entity);
 }
 
 float3 EntityComponentSystem::GetScale(const ECSEntity a_entity) const
 {
-    return m_positions.GetComponent(a_entity);
+    return GetComponent(m_positions, a_entity);
 }
 
 bool EntityComponentSystem::ValidateEntity(const ECSEntity a_entity) const
@@ -335,18 +782,18 @@ bool EntityComponentSystem::ValidateEntity(const ECSEntity a_entity) const
 const float4x4& EntityComponentSystem::GetWorldMatrix(const ECSEntity a_entity) const
 {
     BB_ASSERT(a_entity.IsValid(), "invalid entity");
-    return m_world_matrices.GetComponent(a_entity);
+    return GetComponent(m_world_matrices, a_entity);
 }
 
 const BoundingBox& EntityComponentSystem::GetBoundingBox(const ECSEntity a_entity) const
 {
     BB_ASSERT(a_entity.IsValid(), "invalid entity");
-    return m_bounding_box_pool.GetComponent(a_entity);
+    return GetComponent(m_bounding_box_pool, a_entity);
 }
 
 bool EntityComponentSystem::EntityAssignBoundingBox(const ECSEntity a_entity, const BoundingBox& a_box)
 {
-    if (!m_bounding_box_pool.CreateComponent(a_entity, a_box))
+    if (!CreateComponent(m_bounding_box_pool, a_entity, a_box))
         return false;
     if (!m_ecs_entities.RegisterSignature(a_entity, m_bounding_box_pool.GetSignatureIndex()))
         return false;
@@ -355,25 +802,90 @@ bool EntityComponentSystem::EntityAssignBoundingBox(const ECSEntity a_entity, co
 
 bool EntityComponentSystem::EntityAssignName(const ECSEntity a_entity, const NameComponent& a_name)
 {
-	if (!m_name_pool.CreateComponent(a_entity, a_name))
+	return EntityAssignName(a_entity, StringAtomInternTransient(a_name.GetView()));
+}
+
+bool EntityComponentSystem::EntityAssignName(const ECSEntity a_entity, const StringAtom a_name)
+{
+	if (!CreateComponent(m_name_pool, a_entity, a_name))
 		return false;
 	if (!m_ecs_entities.RegisterSignature(a_entity, m_name_pool.GetSignatureIndex()))
 		return false;
 	return true;
 }
 
+bool EntityComponentSystem::CreateComponent(NameComponentPool& a_pool, const ECSEntity a_entity, const StringAtom& a_component)
+{
+	if (!m_archetype_storage)
+		return a_pool.CreateComponent(a_entity, a_component);
+
+	// new rows are zeroed, releasing the name of an entity that had none does nothing.
+	const StringAtom old_name = m_archetypes.HasComponent<NameComponentPool>(a_entity) ? m_archetypes.GetComponent<NameComponentPool>(a_entity) : StringAtom();
+	if (!m_archetypes.AddComponent<NameComponentPool>(a_entity, a_component))
+	{
+		StringAtomRelease(a_component);
+		return false;
+	}
+	StringAtomRelease(old_name);
+	return true;
+}
+
+bool EntityComponentSystem::FreeComponent(NameComponentPool& a_pool, const ECSEntity a_entity)
+{
+	if (!m_archetype_storage)
+		return a_pool.FreeComponent(a_entity);
+
+	if (m_archetypes.HasComponent<NameComponentPool>(a_entity))
+		StringAtomRelease(m_archetypes.GetComponent<NameComponentPool>(a_entity));
+	return m_archetypes.RemoveComponent<NameComponentPool>(a_entity);
+}
+
 bool EntityComponentSystem::EntityAssignRenderComponent(const ECSEntity a_entity, const RenderComponent& a_draw_info)
 {
-	if (!m_render_mesh_pool.CreateComponent(a_entity, a_draw_info))
+	if (!CreateComponent(m_render_mesh_pool, a_entity, a_draw_info))
 		return false;
 	if (!m_ecs_entities.RegisterSignature(a_entity, m_render_mesh_pool.GetSignatureIndex()))
 		return false;
+	AddChangedCasterBounds(a_entity);
 	return true;
 }
 
+void EntityComponentSystem::RelocateMeshes(const ConstSlice<MeshRelocation> a_relocations)
+{
+	if (a_relocations.size() == 0)
+		return;
+
+	// the vertex position offset is unique for every mesh.
+	auto relocate = [a_relocations](RenderComponent& a_render)
+	{
+		for (size_t i = 0; i < a_relocations.size(); i++)
+		{
+			if (a_render.mesh.vertex_position_offset == a_relocations[i].old_mesh.vertex_position_offset)
+			{
+				a_render.mesh = a_relocations[i].new_mesh;
+				return;
+			}
+		}
+	};
+
+	if (m_archetype_storage)
+	{
+		m_archetypes.ForEach<RenderComponentPool>([&relocate](const ECSEntity, RenderComponent& a_render)
+		{
+			relocate(a_render);
+		});
+	}
+	else
+	{
+		const ConstSlice<ECSEntity> entities = m_render_mesh_pool.GetEntityComponents();
+		for (size_t i = 0; i < entities.size(); i++)
+			relocate(m_render_mesh_pool.GetComponent(entities[i]));
+	}
+}
+
 bool EntityComponentSystem::EntityAssignLight(const ECSEntity a_entity, const LightComponent& a_light)
 {
-	if (!m_light_pool.CreateComponent(a_entity, a_light))
+	if (!CreateComponent(m_light_pool, a_entity, a_light))
 		return false;
 	if (!m_ecs_entities.RegisterSignature(a_entity, m_light_pool.GetSignatureIndex()))
 		return false;
@@ -382,7 +894,7 @@ bool EntityComponentSystem::EntityAssignLight(const ECSEntity a_entity, const Li
 
 bool EntityComponentSystem::EntityAssignRaytraceComponent(const ECSEntity a_entity, const RaytraceComponent& a_raytrace)
 {
-    if (!m_raytrace_pool.CreateComponent(a_entity, a_raytrace))
+    if (!CreateComponent(m_raytrace_pool, a_entity, a_raytrace))
 		return false;
 	if (!m_ecs_entities.RegisterSignature(a_entity, m_raytrace_pool.GetSignatureIndex()))
 		return false;
@@ -393,7 +905,7 @@ bool EntityComponentSystem::EntityFreeLight(const ECSEntity a_entity)
 {
 	if (!m_ecs_entities.HasSignature(a_entity, LIGHT_ECS_SIGNATURE))
 		return false;
-	if (!m_light_pool.FreeComponent(a_entity))
+	if (!FreeComponent(m_light_pool, a_entity))
 		return false;
 	if (!m_ecs_entities.UnregisterSignature(a_entity, LIGHT_ECS_SIGNATURE))
 		return false;
@@ -411,21 +923,27 @@ bool EntityComponentSystem::AddEntityRelation(const ECSEntity a_entity, const EC
 	EntityRelation relations;
 	relations.child_count = 0;
 	relations.first_child = INVALID_ECS_OBJ;
-	relations.next = INVALID_ECS_OBJ;
-	relations.parent = a_parent;
-	if (relations.parent.IsValid())
+	LinkToParent(a_entity, relations, a_parent);
+	return CreateComponent(m_relations, a_entity, relations);
+}
+
+void EntityComponentSystem::LinkToParent(const ECSEntity a_entity, EntityRelation& a_relation, const ECSEntity a_parent)
+{
+	a_relation.next = INVALID_ECS_OBJ;
+	a_relation.parent = a_parent;
+	if (a_relation.parent.IsValid())
 	{
-		EntityRelation& parent_relation = m_relations.GetComponent(relations.parent);
+		EntityRelation& parent_relation = GetComponent(m_relations, a_relation.parent);
 		if (parent_relation.child_count != 0)
 		{
 			ECSEntity next_free = parent_relation.first_child;
 			for (size_t i = 1; i < parent_relation.child_count; i++)
 			{
-				next_free = m_relations.GetComponent(next_free).next;
+				next_free = GetComponent(m_relations, next_free).next;
 			}
 
-			BB_ASSERT(!m_relations.GetComponent(next_free).next.IsValid(), "next free entity is not free!");
-			m_relations.GetComponent(next_free).next = a_entity;
+			BB_ASSERT(!GetComponent(m_relations, next_free).next.IsValid(), "next free entity is not free!");
+			GetComponent(m_relations, next_free).next = a_entity;
 		}
 		else
 			parent_relation.first_child = a_entity;
@@ -434,27 +952,55 @@ bool EntityComponentSystem::AddEntityRelation(const ECSEntity a_entity, const EC
 	}
 	else
 		m_root_entity_system.root_entities.Insert(a_entity);
+}
 
-	return m_relations.CreateComponent(a_entity, relations);
+void EntityComponentSystem::UnlinkFromParent(const ECSEntity a_entity, EntityRelation& a_relation)
+{
+	if (a_relation.parent.IsValid())
+	{
+		EntityRelation& parent_relation = GetComponent(m_relations, a_relation.parent);
+		if (parent_relation.first_child == a_entity)
+			parent_relation.first_child = a_relation.next;
+		else
+		{
+			ECSEntity previous = parent_relation.first_child;
+			while (GetComponent(m_relations, previous).next != a_entity)
+				previous = GetComponent(m_relations, previous).next;
+			GetComponent(m_relations, previous).next = a_relation.next;
+		}
+		--parent_relation.child_count;
+	}
+	else if (m_root_entity_system.root_entities.Find(a_entity.index) != SPARSE_SET_INVALID)
+		m_root_entity_system.root_entities.Erase(a_entity);
+
+	a_relation.parent = INVALID_ECS_OBJ;
+	a_relation.next = INVALID_ECS_OBJ;
 }
 
 void EntityComponentSystem::UpdateTransform(const ECSEntity a_entity)
 {
-	float4x4& local_matrix = m_local_matrices.GetComponent(a_entity);
-	local_matrix = Float4x4FromTranslation(m_positions.GetComponent(a_entity)) * m_rotations.GetComponent(a_entity);
-	local_matrix = Float4x4Scale(local_matrix, m_scales.GetComponent(a_entity));
+	// a moved caster changes the shadows it was in and the ones it moved into.
+	const bool is_caster = m_ecs_entities.HasSignature(a_entity, RENDER_ECS_SIGNATURE);
+	if (is_caster)
+		AddChangedCasterBounds(a_entity);
+
+	float4x4& local_matrix = GetComponent(m_local_matrices, a_entity);
+	local_matrix = Float4x4FromTranslation(GetComponent(m_positions, a_entity)) * GetComponent(m_rotations, a_entity);
+	local_matrix = Float4x4Scale(local_matrix, GetComponent(m_scales, a_entity));
 
-	const EntityRelation& parent_relation = m_relations.GetComponent(a_entity);
+	const EntityRelation& parent_relation = GetComponent(m_relations, a_entity);
 	if (parent_relation.parent.IsValid())
 	{
-		const float4x4& world_parent_matrix = m_world_matrices.GetComponent(parent_relation.parent);
-		m_world_matrices.GetComponent(a_entity) = world_parent_matrix * local_matrix;
+		const float4x4& world_parent_matrix = GetComponent(m_world_matrices, parent_relation.parent);
+		GetComponent(m_world_matrices, a_entity) = world_parent_matrix * local_matrix;
 	}
 	else
 	{
-		m_world_matrices.GetComponent(a_entity) = local_matrix;
+		GetComponent(m_world_matrices, a_entity) = local_matrix;
 	}
 
+	if (is_caster)
+		AddChangedCasterBounds(a_entity);
 	m_transform_system.dirty_transforms.Erase(a_entity);
 
 	// update all the chilren last
@@ -462,6 +1008,35 @@ void EntityComponentSystem::UpdateTransform(const ECSEntity a_entity)
 	for (size_t i = 0; i < parent_relation.child_count; i++)
 	{
 		UpdateTransform(child);
-		child = m_relations.GetComponent(child).next;
+		child = GetComponent(m_relations, child).next;
+	}
+}
+
+void EntityComponentSystem::AddChangedCasterBounds(const ECSEntity a_entity)
+{
+	if (m_transform_system.changed_bounds_overflow || m_transform_system.changed_bounds.IsFull())
+	{
+		m_transform_system.changed_bounds_overflow = true;
+		return;
+	}
+	if (!m_ecs_entities.HasSignature(a_entity, WORLD_MATRIX_ECS_SIGNATURE))
+		return;
+
+	const float4x4& world_mat = GetComponent(m_world_matrices, a_entity);
+	const BoundingBox box = GetComponent(m_render_mesh_pool, a_entity).bounding_box;
+
+	BoundingBox world_box;
+	world_box.min = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	world_box.max = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (uint32_t corner = 0; corner < 8; corner++)
+	{
+		const float4 p = world_mat * float4(
+			corner & 1 ? box.max.x : box.min.x,
+			corner & 2 ? box.max.y : box.min.y,
+			corner & 4 ? box.max.z : box.min.z,
+			1.0);
+		world_box.min = Float3Min(world_box.min, float3(p.x, p.y, p.z));
+		world_box.max = Float3Max(world_box.max, float3(p.x, p.y, p.z));
 	}
+	m_transform_system.changed_bounds.push_back(world_box);
 }
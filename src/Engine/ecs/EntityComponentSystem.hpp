@@ -1,5 +1,8 @@
 #pragma once
 #include "EntityMap.hpp"
+#include "ArchetypeMap.hpp"
+#include "SystemScheduler.hpp"
+#include "EntityCommandBuffer.hpp"
 #include "systems/RenderSystem.hpp"
 #include "components/LightComponent.hpp"
 #include "components/NameComponent.hpp"
@@ -11,6 +14,8 @@
 
 namespace BB
 {
+	constexpr uint32_t ECS_SYSTEM_MAX = 64;
+
 	// thanks to David Colson for the idea https://www.david-colson.com/2020/02/09/making-a-simple-ecs.html
 	struct EntityComponentSystemCreateInfo
 	{
@@ -20,6 +25,28 @@ namespace BB
 		uint32_t entity_count;
 		uint32_t render_mesh_count;
 		uint32_t light_count;
+		// store components in archetype chunks instead of the per component pools.
+		bool archetype_storage;
+	};
+
+	constexpr uint32_t ECS_PROTOTYPE_NO_PARENT = UINT32_MAX;
+
+	// describes one entity for EntityComponentSystem::CreateEntities.
+	struct ECSEntityPrototype
+	{
+		// not transient, every entity made from the prototype uses it.
+		StringAtom name;
+		// index of the parent in the prototype array, it must come before this prototype.
+		// ECS_PROTOTYPE_NO_PARENT uses the parent given to CreateEntities.
+		uint32_t parent_index;
+		float3 position;
+		float3x3 rotation;
+		float3 scale;
+
+		bool has_render_component;
+		bool has_bounding_box;
+		RenderComponent render_component;
+		BoundingBox bounding_box;
 	};
 
 	class EntityComponentSystem
@@ -29,15 +56,30 @@ namespace BB
 		bool Init(MemoryArena& a_arena, const EntityComponentSystemCreateInfo& a_create_info, const StackString<32> a_name);
 
         ECSEntity CreateEntity(const NameComponent& a_name = "#UNNAMED#", const ECSEntity& a_parent = INVALID_ECS_OBJ, const float3 a_position = float3(0.f), const float3x3 a_rotation = Float3x3Identity(), const float3 a_scale = float3(1.f));
+		// a transient a_name is owned by the entity after this.
+		ECSEntity CreateEntity(const StringAtom a_name, const ECSEntity& a_parent, const float3 a_position, const float3x3 a_rotation, const float3 a_scale);
+		// creates every prototype in one batch, entity ids are reserved at once and the transforms are calculated directly.
+		// a_out_entities must be the same size as a_prototypes, returns false if there are not enough free entities.
+		bool CreateEntities(MemoryArena& a_temp_arena, const ConstSlice<ECSEntityPrototype> a_prototypes, const ECSEntity a_parent, const Slice<ECSEntity> a_out_entities);
         ECSEntity SelectEntityByRay(const float3 a_ray_origin, const float3 a_ray_dir);
         bool DestroyEntity(const ECSEntity a_entity);
+		// moves the entity and its children under a_parent, an invalid parent makes it a root entity.
+		bool SetParent(const ECSEntity a_entity, const ECSEntity a_parent);
+
+		// thread safe, the commands are copied and the buffer is empty after this. The copy owns the recorded names.
+		void SubmitCommandBuffer(ECSCommandBuffer& a_command_buffer);
+		// plays back every submitted command sorted by ECS_COMMAND, only call this when no system is running.
+		void PlaybackCommandBuffers();
 
         void AddLinesToFrame(const ConstSlice<Line> a_lines);
         void DrawAABB(const ECSEntity a_entity, const LineColor a_color);
 
 		void StartFrame();
 		void EndFrame();
+		// plays back the submitted command buffers, then runs the transform system, the render side systems and every registered system through the system scheduler.
+		void SystemsUpdate();
 		void TransformSystemUpdate();
+		void RegisterSystem(const ECSSystemCreateInfo& a_create_info);
 		RenderSystemFrame RenderSystemUpdate(const RCommandList a_list, const uint2 a_draw_area_size);
 
 		float3 Translate(const ECSEntity a_entity, const float3 a_translate);
@@ -56,13 +98,18 @@ namespace BB
 
         const float4x4& GetWorldMatrix(const ECSEntity a_entity) const;
         const BoundingBox& GetBoundingBox(const ECSEntity a_entity) const;
+		// world bounds of the shadow casters that were added, moved or destroyed since the last render.
+		ConstSlice<BoundingBox> GetChangedCasterBounds() const { return m_transform_system.changed_bounds.const_slice(); }
 
         bool EntityAssignBoundingBox(const ECSEntity a_entity, const BoundingBox& a_box);
 		bool EntityAssignName(const ECSEntity a_entity, const NameComponent& a_name);
+		bool EntityAssignName(const ECSEntity a_entity, const StringAtom a_name);
 		bool EntityAssignRenderComponent(const ECSEntity a_entity, const RenderComponent& a_draw_info);
 		bool EntityAssignLight(const ECSEntity a_entity, const LightComponent& a_light);
         bool EntityAssignRaytraceComponent(const ECSEntity a_entity, const RaytraceComponent& a_raytrace);
 		bool EntityFreeLight(const ECSEntity a_entity);
+		// patches the mesh of every render component that uses a relocated mesh, see Asset::DefragmentMeshes.
+		void RelocateMeshes(const ConstSlice<MeshRelocation> a_relocations);
 
         void CalculateView(const float3 a_pos, const float3 a_center, const float3 a_up);
 
@@ -71,14 +118,64 @@ namespace BB
 			return m_render_system;
 		}
 
+		const ECSSystemScheduler& GetSystemScheduler() const
+		{
+			return m_system_scheduler;
+		}
+
+		// only valid with archetype storage, a_func can be called from multiple threads at the same time.
+		template<typename... Pools, typename Func>
+		void ParallelForEach(MemoryArena& a_arena, Func a_func)
+		{
+			BB_ASSERT(m_archetype_storage, "ParallelForEach requires archetype storage");
+			ECSParallelForEach<Pools...>(m_archetypes, a_arena, a_func);
+		}
+
 		StackString<32> GetName() const { return m_name; }
 
 	private:
         void FindECSEntityClickTraverse(const ECSEntity a_entity, const float3& a_ray_origin, const float3& a_ray_dir, ECSEntity& a_found, float& a_found_dist);
 		bool AddEntityRelation(const ECSEntity a_entity, const ECSEntity a_parent);
+		void LinkToParent(const ECSEntity a_entity, EntityRelation& a_relation, const ECSEntity a_parent);
+		void UnlinkFromParent(const ECSEntity a_entity, EntityRelation& a_relation);
+		void PlaybackCommand(const ECSCommandHeader& a_header, ECSEntity* a_created_entities);
+		void FreePoolComponents(const ECSEntity a_entity);
 		void UpdateTransform(const ECSEntity a_entity);
+		void AddChangedCasterBounds(const ECSEntity a_entity);
+		void RenderTransformSystemUpdate();
+		void RenderLightSystemUpdate();
+
+		// component access goes through these so the storage can either be the pools or the archetype map.
+		template<typename Pool>
+		typename Pool::Component& GetComponent(const Pool& a_pool, const ECSEntity a_entity) const
+		{
+			if (m_archetype_storage)
+				return m_archetypes.GetComponent<Pool>(a_entity);
+			return a_pool.GetComponent(a_entity);
+		}
+
+		template<typename Pool>
+		bool CreateComponent(Pool& a_pool, const ECSEntity a_entity, const typename Pool::Component& a_component)
+		{
+			if (m_archetype_storage)
+				return m_archetypes.AddComponent<Pool>(a_entity, a_component);
+			return a_pool.CreateComponent(a_entity, a_component);
+		}
+
+		template<typename Pool>
+		bool FreeComponent(Pool& a_pool, const ECSEntity a_entity)
+		{
+			if (m_archetype_storage)
+				return m_archetypes.RemoveComponent<Pool>(a_entity);
+			return a_pool.FreeComponent(a_entity);
+		}
+
+		// the names are atoms owned by the entity, the archetype storage releases them like the NameComponentPool does.
+		bool CreateComponent(NameComponentPool& a_pool, const ECSEntity a_entity, const StringAtom& a_component);
+		bool FreeComponent(NameComponentPool& a_pool, const ECSEntity a_entity);
 
 		StackString<32> m_name;
+		StringAtom m_render_profile_name;
 		struct PerFrame
 		{
 			MemoryArena arena;
@@ -89,7 +186,10 @@ namespace BB
 		// ecs entities
 		EntityMap m_ecs_entities;
 
-		// component pools
+		bool m_archetype_storage;
+		ECSArchetypeMap m_archetypes;
+
+		// component pools, unused when m_archetype_storage is set.
 		RelationComponentPool m_relations;
 		PositionComponentPool m_positions;
 		RotationComponentPool m_rotations;
@@ -102,13 +202,40 @@ namespace BB
 		LightComponentPool m_light_pool;
         RaytraceComponentPool m_raytrace_pool;
 
+		// submitted ECSCommandBuffers, every submit is copied into its own block.
+		struct CommandQueue
+		{
+			struct Block
+			{
+				Block* next;
+				const char* commands;
+				size_t size;
+			};
+
+			BBRWLock lock;
+			MemoryArena arena;
+			Block* first;
+			Block* last;
+			uint32_t command_count;
+			uint32_t create_count;
+		} m_command_queue;
+
 		// systems
+		ECSSystemScheduler m_system_scheduler;
 		RenderSystem m_render_system;
 		struct TransformSystem
 		{
 			EntitySparseSet dirty_transforms;
+			// world bounds of the render entities that moved since the last render, before and after. the shadow cache checks against them.
+			StaticArray<BoundingBox> changed_bounds;
+			bool changed_bounds_overflow;
 		} m_transform_system;
 
+		struct RenderLightSystem
+		{
+			StaticArray<LightComponent> lights;
+		} m_render_light_system;
+
 		struct RootEntitySystem
 		{
 			EntitySparseSet root_entities;
@@ -32,6 +32,16 @@ bool EntityMap::CreateEntity(ECSEntity& a_out_entity)
 	return true;
 }
 
+bool EntityMap::CreateEntities(const Slice<ECSEntity> a_out_entities)
+{
+	if (m_entity_count + a_out_entities.size() > m_entities.capacity())
+		return false;
+	m_entity_count += static_cast<uint32_t>(a_out_entities.size());
+	for (size_t i = 0; i < a_out_entities.size(); i++)
+		a_out_entities[i] = m_entity_queue.DeQueue();
+	return true;
+}
+
 bool EntityMap::FreeEntity(const ECSEntity a_entity)
 {
 	if (m_entity_count == 0)
@@ -73,6 +83,15 @@ bool EntityMap::RegisterSignatures(const ECSEntity a_entity, const ConstSlice<EC
 	return no_overlap_registrations;
 }
 
+bool EntityMap::RegisterSignatures(const ECSEntity a_entity, const ECSSignature& a_signature)
+{
+	if (!ValidateEntity(a_entity))
+		return false;
+	const bool no_overlap_registrations = (m_entities[a_entity.index].signature & a_signature).none();
+	m_entities[a_entity.index].signature |= a_signature;
+	return no_overlap_registrations;
+}
+
 bool EntityMap::UnregisterSignature(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index)
 {
 	if (!ValidateEntity(a_entity))
@@ -10,12 +10,15 @@ namespace BB
 		bool Init(MemoryArena& a_arena, const uint32_t a_max_entities);
 
 		bool CreateEntity(ECSEntity& a_out_entity);
+		// reserves a_out_entities.size() entities at once, returns false without creating any if there are not enough left.
+		bool CreateEntities(const Slice<ECSEntity> a_out_entities);
 		bool FreeEntity(const ECSEntity a_entity);
 
 		// returns false if the signature is already set.
 		bool RegisterSignature(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index);
 		// returns false if one of the signature is already set.
 		bool RegisterSignatures(const ECSEntity a_entity, const ConstSlice<ECSSignatureIndex> a_signature_indices);
+		bool RegisterSignatures(const ECSEntity a_entity, const ECSSignature& a_signature);
 		// returns false if the signature was not set.
 		bool UnregisterSignature(const ECSEntity a_entity, const ECSSignatureIndex a_signature_index);
 		// returns false if one of the signature was not set.
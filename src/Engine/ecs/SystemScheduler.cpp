@@ -0,0 +1,85 @@
+#include "SystemScheduler.hpp"
+#include "EntityComponentSystem.hpp"
+
+using namespace BB;
+
+struct SystemTaskParams
+{
+	EntityComponentSystem* ecs;
+	const ECSSystemCreateInfo* system;
+};
+
+static void SystemTask(MemoryArena& a_thread_arena, void* a_param)
+{
+	const SystemTaskParams& params = *reinterpret_cast<const SystemTaskParams*>(a_param);
+	params.system->function(*params.ecs, a_thread_arena, params.system->user_data);
+}
+
+void ECSSystemScheduler::Init(MemoryArena& a_arena, const uint32_t a_system_max)
+{
+	m_systems.Init(a_arena, a_system_max);
+	m_last_level_count = 0;
+}
+
+void ECSSystemScheduler::RegisterSystem(const ECSSystemCreateInfo& a_create_info)
+{
+	BB_ASSERT(a_create_info.function != nullptr, "ecs system has no function");
+	BB_ASSERT(m_systems.size() < m_systems.capacity(), "too many ecs systems registered");
+	m_systems.push_back(a_create_info);
+}
+
+void ECSSystemScheduler::Execute(EntityComponentSystem& a_ecs, MemoryArena& a_arena)
+{
+	const uint32_t system_count = m_systems.size();
+	if (system_count == 0)
+		return;
+
+	MemoryArenaScope(a_arena)
+	{
+		// a system runs one level after the last earlier registered system it conflicts with.
+		uint32_t* levels = ArenaAllocArr(a_arena, uint32_t, system_count);
+		uint32_t level_count = 0;
+		for (uint32_t i = 0; i < system_count; i++)
+		{
+			levels[i] = 0;
+			for (uint32_t j = 0; j < i; j++)
+				if (levels[j] + 1 > levels[i] && m_systems[i].access.ConflictsWith(m_systems[j].access))
+					levels[i] = levels[j] + 1;
+			level_count = Max(level_count, levels[i] + 1);
+		}
+
+		SystemTaskParams* params = ArenaAllocArr(a_arena, SystemTaskParams, system_count);
+		ThreadTask* tasks = ArenaAllocArr(a_arena, ThreadTask, system_count);
+		for (uint32_t level = 0; level < level_count; level++)
+		{
+			// hand all but one system of this level to the job threads, the calling thread runs the rest.
+			uint32_t task_count = 0;
+			uint32_t local_system = UINT32_MAX;
+			for (uint32_t i = 0; i < system_count; i++)
+			{
+				if (levels[i] != level)
+					continue;
+				if (local_system == UINT32_MAX)
+				{
+					local_system = i;
+					continue;
+				}
+
+				params[i].ecs = &a_ecs;
+				params[i].system = &m_systems[i];
+				const ThreadTask task = Threads::TryStartTaskThread(SystemTask, &params[i], sizeof(params[i]), L"ecs system");
+				if (task.IsValid())
+					tasks[task_count++] = task;
+				else
+					m_systems[i].function(a_ecs, a_arena, m_systems[i].user_data);
+			}
+
+			if (local_system != UINT32_MAX)
+				m_systems[local_system].function(a_ecs, a_arena, m_systems[local_system].user_data);
+
+			for (uint32_t i = 0; i < task_count; i++)
+				Threads::WaitForTask(tasks[i]);
+		}
+		m_last_level_count = level_count;
+	}
+}
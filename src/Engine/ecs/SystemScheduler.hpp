@@ -0,0 +1,108 @@
+#pragma once
+#include "ArchetypeMap.hpp"
+#include "Storage/Array.h"
+#include "BBThreadScheduler.hpp"
+
+namespace BB
+{
+	// the components a system touches, systems whose access does not conflict run at the same time.
+	struct ECSSystemAccess
+	{
+		ECSSignature read;
+		ECSSignature write;
+
+		template<typename... Pools>
+		ECSSystemAccess& Read()
+		{
+			read |= ECSArchetypeMap::MakeSignature<Pools...>();
+			return *this;
+		}
+
+		template<typename... Pools>
+		ECSSystemAccess& Write()
+		{
+			write |= ECSArchetypeMap::MakeSignature<Pools...>();
+			return *this;
+		}
+
+		bool ConflictsWith(const ECSSystemAccess& a_other) const
+		{
+			return (write & (a_other.read | a_other.write)).any() || (a_other.write & read).any();
+		}
+	};
+
+	using PFN_ECSSystem = void(*)(class EntityComponentSystem& a_ecs, MemoryArena& a_thread_arena, void* a_user_data);
+
+	struct ECSSystemCreateInfo
+	{
+		const char* name;
+		PFN_ECSSystem function;
+		void* user_data;
+		ECSSystemAccess access;
+	};
+
+	// runs every registered system once per Execute.
+	// systems that conflict run in registration order, the rest run in parallel on the job threads.
+	class ECSSystemScheduler
+	{
+	public:
+		void Init(MemoryArena& a_arena, const uint32_t a_system_max);
+		void RegisterSystem(const ECSSystemCreateInfo& a_create_info);
+
+		// a_arena is only used during Execute
+		void Execute(class EntityComponentSystem& a_ecs, MemoryArena& a_arena);
+
+		uint32_t GetSystemCount() const { return m_systems.size(); }
+		// the amount of serial steps the last Execute needed, systems in the same step ran in parallel.
+		uint32_t GetLastLevelCount() const { return m_last_level_count; }
+
+	private:
+		StaticArray<ECSSystemCreateInfo> m_systems;
+		uint32_t m_last_level_count;
+	};
+
+	// calls a_func(const ECSEntity, Pools::Component&...) for every matching entity, chunks are split between the calling thread and free job threads.
+	// a_func is called from multiple threads at the same time, it must only write to the components of the entity it gets.
+	template<typename... Pools, typename Func>
+	void ECSParallelForEach(const ECSArchetypeMap& a_archetypes, MemoryArena& a_arena, Func a_func)
+	{
+		const ConstSlice<ECSArchetypeChunk*> chunks = a_archetypes.GatherChunks<Pools...>(a_arena);
+		if (chunks.size() == 0)
+			return;
+
+		struct Job
+		{
+			const ConstSlice<ECSArchetypeChunk*>* chunks;
+			std::atomic<size_t>* next_chunk;
+			Func* func;
+
+			static void Run(MemoryArena&, void* a_param)
+			{
+				const Job& job = *reinterpret_cast<const Job*>(a_param);
+				for (size_t i = (*job.next_chunk)++; i < job.chunks->size(); i = (*job.next_chunk)++)
+					ECSArchetypeMap::ForEachInChunk<Pools...>(*(*job.chunks)[i], *job.func);
+			}
+		};
+
+		std::atomic<size_t> next_chunk = 0;
+		Job job;
+		job.chunks = &chunks;
+		job.next_chunk = &next_chunk;
+		job.func = &a_func;
+
+		// chunks are pulled from a shared counter, so it does not matter how many threads actually joined.
+		const size_t helper_max = Min(Threads::ThreadsAvailable(), chunks.size() - 1);
+		ThreadTask* helpers = ArenaAllocArr(a_arena, ThreadTask, helper_max + 1);
+		size_t helper_count = 0;
+		for (; helper_count < helper_max; helper_count++)
+		{
+			helpers[helper_count] = Threads::TryStartTaskThread(Job::Run, &job, sizeof(job), L"ecs parallel for each");
+			if (!helpers[helper_count].IsValid())
+				break;
+		}
+
+		Job::Run(a_arena, &job);
+		for (size_t i = 0; i < helper_count; i++)
+			Threads::WaitForTask(helpers[i]);
+	}
+}
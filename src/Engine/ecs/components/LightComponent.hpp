@@ -15,6 +15,9 @@ namespace BB
 	class LightComponentPool
 	{
 	public:
+		using Component = LightComponent;
+		static constexpr ECSSignatureIndex SIGNATURE_INDEX = LIGHT_ECS_SIGNATURE;
+
 		void Init(struct MemoryArena& a_arena, const uint32_t a_light_count, const uint32_t a_entity_count);
 
 		bool CreateComponent(const ECSEntity a_entity);
@@ -27,7 +30,7 @@ namespace BB
 
 		inline ECSSignatureIndex GetSignatureIndex() const
 		{
-			return LIGHT_ECS_SIGNATURE;
+			return SIGNATURE_INDEX;
 		}
 		// hack or maybe add this to add.
 		inline const LightComponent& GetComponent(const uint32_t a_index) const
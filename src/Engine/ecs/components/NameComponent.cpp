@@ -12,31 +12,38 @@ void NameComponentPool::Init(struct MemoryArena& a_arena, const uint32_t a_trans
 
 bool NameComponentPool::CreateComponent(const ECSEntity a_entity)
 {
-	if (EntityInvalid(a_entity))
-		return false;
-
-	new (&m_components[a_entity.index]) NameComponent("unnamed");
-	return true;
+	return CreateComponent(a_entity, BB_STRING_ATOM("unnamed"));
 }
 
-bool NameComponentPool::CreateComponent(const ECSEntity a_entity, const NameComponent& a_component)
+bool NameComponentPool::CreateComponent(const ECSEntity a_entity, const StringAtom& a_component)
 {
 	if (EntityInvalid(a_entity))
+	{
+		StringAtomRelease(a_component);
 		return false;
+	}
 
-	new (&m_components[a_entity.index]) NameComponent(a_component);
+	StringAtomRelease(m_components[a_entity.index]);
+	m_components[a_entity.index] = a_component;
 	return true;
 }
 
+bool NameComponentPool::CreateComponent(const ECSEntity a_entity, const NameComponent& a_name)
+{
+	return CreateComponent(a_entity, StringAtomInternTransient(a_name.GetView()));
+}
+
 bool NameComponentPool::FreeComponent(const ECSEntity a_entity)
 {
 	if (EntityInvalid(a_entity))
 		return false;
 
+	StringAtomRelease(m_components[a_entity.index]);
+	m_components[a_entity.index] = StringAtom();
 	return true;
 }
 
-NameComponent& NameComponentPool::GetComponent(const ECSEntity a_entity) const
+StringAtom& NameComponentPool::GetComponent(const ECSEntity a_entity) const
 {
 	BB_ASSERT(!EntityInvalid(a_entity), "entity entry is not valid!");
 	return m_components[a_entity.index];
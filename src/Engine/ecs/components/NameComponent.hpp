@@ -2,24 +2,31 @@
 #include "BBMemory.h"
 #include "ecs/ECSBase.hpp"
 #include "Storage/BBString.h"
+#include "Utils/StringAtom.hpp"
 
 namespace BB
 {
 	using NameComponent = StackString<64>;
 
+	// names are stored as interned StringAtoms, NameComponent is only used to create them.
+	// a NameComponent becomes a transient atom. The pool owns the atoms it is given and releases them when the name is replaced or freed.
 	class NameComponentPool
 	{
 	public:
+		using Component = StringAtom;
+		static constexpr ECSSignatureIndex SIGNATURE_INDEX = NAME_ECS_SIGNATURE;
+
 		void Init(struct MemoryArena& a_arena, const uint32_t a_transform_count);
 
 		bool CreateComponent(const ECSEntity a_entity);
-		bool CreateComponent(const ECSEntity a_entity, const NameComponent& a_component);
+		bool CreateComponent(const ECSEntity a_entity, const StringAtom& a_component);
+		bool CreateComponent(const ECSEntity a_entity, const NameComponent& a_name);
 		bool FreeComponent(const ECSEntity a_entity);
-		NameComponent& GetComponent(const ECSEntity a_entity) const;
+		StringAtom& GetComponent(const ECSEntity a_entity) const;
 
 		inline ECSSignatureIndex GetSignatureIndex() const
 		{
-			return NAME_ECS_SIGNATURE;
+			return SIGNATURE_INDEX;
 		}
 		inline uint32_t GetSize() const
 		{
@@ -31,7 +38,7 @@ namespace BB
 
 		// components equal to entities.
 		uint32_t m_size;
-		StaticArray<NameComponent> m_components;
+		StaticArray<StringAtom> m_components;
 	};
-	static_assert(is_ecs_component_map<NameComponentPool, NameComponent>);
+	static_assert(is_ecs_component_map<NameComponentPool, StringAtom>);
 }
@@ -20,6 +20,9 @@ namespace BB
 	class RaytraceComponentPool
 	{
 	public:
+		using Component = RaytraceComponent;
+		static constexpr ECSSignatureIndex SIGNATURE_INDEX = RAYTRACE_ECS_SIGNATURE;
+
 		void Init(struct MemoryArena& a_arena, const uint32_t a_component_count, const uint32_t a_entity_count);
 
 		bool CreateComponent(const ECSEntity a_entity);
@@ -31,7 +34,7 @@ namespace BB
 
 		inline ECSSignatureIndex GetSignatureIndex() const
 		{
-			return RAYTRACE_ECS_SIGNATURE;
+			return SIGNATURE_INDEX;
 		}
 		inline uint32_t GetSize() const
 		{
@@ -1,6 +1,7 @@
 #pragma once
 #include "ecs/ECSBase.hpp"
 #include "Rendererfwd.hpp"
+#include "Meshlet.hpp"
 
 namespace BB
 {
@@ -12,12 +13,21 @@ namespace BB
 		MeshMetallic material_data;
 		uint32_t index_start;
 		uint32_t index_count;
+		// owned by the model asset, index_start of a meshlet is relative to the mesh like index_start.
+		// not a slice, components need to stay trivially copyable.
+		const Meshlet* meshlets;
+		uint32_t meshlet_count;
+		// local space, the occlusion culling tests the transformed box.
+		BoundingBox bounding_box;
 		bool material_dirty;
 	};
 
 	class RenderComponentPool
 	{
 	public:
+		using Component = RenderComponent;
+		static constexpr ECSSignatureIndex SIGNATURE_INDEX = RENDER_ECS_SIGNATURE;
+
 		void Init(struct MemoryArena& a_arena, const uint32_t a_render_mesh_count, const uint32_t a_entity_count);
 
 		bool CreateComponent(const ECSEntity a_entity);
@@ -29,7 +39,7 @@ namespace BB
 
 		inline ECSSignatureIndex GetSignatureIndex() const
 		{
-			return RENDER_ECS_SIGNATURE;
+			return SIGNATURE_INDEX;
 		}
 		inline uint32_t GetSize() const
 		{
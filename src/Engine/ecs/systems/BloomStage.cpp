@@ -4,130 +4,289 @@
 
 using namespace BB;
 
-void BloomStage::Init(MemoryArena& a_arena)
+static MasterMaterialHandle CreateComputeMaterial(MemoryArena& a_arena, const char* a_entry, const char* a_name)
 {
-    MaterialCreateInfo gaussian_material;
-    gaussian_material.pass_type = PASS_TYPE::SCENE;
-    gaussian_material.material_type = MATERIAL_TYPE::NONE;
-    FixedArray<MaterialShaderCreateInfo, 2> gaussian_shaders;
-    gaussian_shaders[0].path = "hlsl/GaussianBlur.hlsl";
-    gaussian_shaders[0].entry = "VertexMain";
-    gaussian_shaders[0].stage = SHADER_STAGE::VERTEX;
-    gaussian_shaders[0].next_stages = static_cast<uint32_t>(SHADER_STAGE::FRAGMENT_PIXEL);
-    gaussian_shaders[1].path = "hlsl/GaussianBlur.hlsl";
-    gaussian_shaders[1].entry = "FragmentMain";
-    gaussian_shaders[1].stage = SHADER_STAGE::FRAGMENT_PIXEL;
-    gaussian_shaders[1].next_stages = static_cast<uint32_t>(SHADER_STAGE::NONE);
-    gaussian_material.shader_infos = Slice(gaussian_shaders.slice());
+    MaterialShaderCreateInfo compute_shader;
+    compute_shader.path = "HLSL/Bloom.hlsl";
+    compute_shader.entry = a_entry;
+    compute_shader.stage = SHADER_STAGE::COMPUTE;
+    compute_shader.next_stages = static_cast<uint32_t>(SHADER_STAGE::NONE);
 
+    MaterialCreateInfo material_info;
+    material_info.pass_type = PASS_TYPE::SCENE;
+    material_info.material_type = MATERIAL_TYPE::NONE;
+    material_info.shader_infos = Slice(&compute_shader, 1);
+    material_info.user_data_size = 0;
+    material_info.cpu_writeable = false;
+
+    MasterMaterialHandle material;
     MemoryArenaScope(a_arena)
     {
-        m_gaussian_material = Material::CreateMasterMaterial(a_arena, gaussian_material, "shadow map material");
+        material = Material::CreateMasterMaterial(a_arena, material_info, a_name);
     }
+    return material;
+}
+
+static uint32_t DivideRoundUp(const uint32_t a_value, const uint32_t a_divisor)
+{
+    return (a_value + a_divisor - 1) / a_divisor;
+}
+
+static uint2 BloomNextLevelResolution(const uint2 a_resolution)
+{
+    return uint2(Max((a_resolution.x + 1) / 2, 1u), Max((a_resolution.y + 1) / 2, 1u));
+}
+
+void BloomStage::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count)
+{
+    m_prefilter_material = CreateComputeMaterial(a_arena, "PrefilterMain", "bloom prefilter material");
+    m_downsample_material = CreateComputeMaterial(a_arena, "DownsampleMain", "bloom downsample material");
+    m_upsample_material = CreateComputeMaterial(a_arena, "UpsampleMain", "bloom upsample material");
+
+    MaterialCreateInfo composite_material;
+    composite_material.pass_type = PASS_TYPE::SCENE;
+    composite_material.material_type = MATERIAL_TYPE::NONE;
+    FixedArray<MaterialShaderCreateInfo, 2> composite_shaders;
+    composite_shaders[0].path = "HLSL/BloomComposite.hlsl";
+    composite_shaders[0].entry = "VertexMain";
+    composite_shaders[0].stage = SHADER_STAGE::VERTEX;
+    composite_shaders[0].next_stages = static_cast<uint32_t>(SHADER_STAGE::FRAGMENT_PIXEL);
+    composite_shaders[1].path = "HLSL/BloomComposite.hlsl";
+    composite_shaders[1].entry = "FragmentMain";
+    composite_shaders[1].stage = SHADER_STAGE::FRAGMENT_PIXEL;
+    composite_shaders[1].next_stages = static_cast<uint32_t>(SHADER_STAGE::NONE);
+    composite_material.shader_infos = Slice(composite_shaders.slice());
+
+    MemoryArenaScope(a_arena)
+    {
+        m_composite_material = Material::CreateMasterMaterial(a_arena, composite_material, "bloom composite material");
+    }
+
+    m_chains.Init(a_arena, a_back_buffer_count);
+    m_chains.resize(a_back_buffer_count);
+    for (uint32_t i = 0; i < m_chains.size(); i++)
+    {
+        m_chains[i].buffer = GPUBuffer();
+        m_chains[i].buffer_size = 0;
+        m_chains[i].draw_area = uint2(0, 0);
+        m_chains[i].prefiltered = false;
+        m_chains[i].compute_value = 0;
+        m_chains[i].composite_value = 0;
+    }
+
+    m_compute_fence = CreateFence(0, "bloom compute fence");
+    m_next_compute_value = 1;
 
-    m_bloom_scale = 1.0f;
     m_bloom_strength = 1.5f;
 }
 
-void BloomStage::ExecutePass(const RCommandList a_list, const uint2 a_resolution, const RImage a_render_target_image, const RDescriptorIndex a_render_target_0, const RDescriptorIndex a_render_target_1, const uint2 a_draw_area, const RImageView a_render_target)
+void BloomStage::BeginFrame(const uint32_t a_frame_index, const uint2 a_draw_area_size)
+{
+    Chain& chain = m_chains[a_frame_index];
+    chain.prefiltered = false;
+    if (chain.draw_area == a_draw_area_size)
+    {
+        // almost always done already, the chain of this frame is read by the frame after it.
+        WaitFence(m_compute_fence, chain.compute_value);
+        return;
+    }
+
+    // dynamic resolution changes the draw area often, a smaller chain fits in the buffer that is already there.
+    Chain resized = chain;
+    if (chain.buffer.IsValid() && SetChainArea(resized, a_draw_area_size) <= chain.buffer_size)
+    {
+        WaitFence(m_compute_fence, chain.compute_value);
+        chain = resized;
+        chain.compute_value = 0;
+        return;
+    }
+
+    GPUWaitIdle();
+    for (uint32_t i = 0; i < m_chains.size(); i++)
+        m_chains[i].compute_value = 0;
+    if (chain.buffer.IsValid())
+        FreeGPUBuffer(chain.buffer);
+    CreateChain(chain, a_draw_area_size);
+}
+
+bool BloomStage::CanComposite(const uint32_t a_frame_index) const
+{
+    const Chain& previous = m_chains[(a_frame_index + m_chains.size() - 1) % m_chains.size()];
+    // the composite samples the chain by uv, so a chain of another draw area still lines up.
+    return previous.compute_value != 0;
+}
+
+void BloomStage::PrefilterPass(const RCommandList a_list, const uint32_t a_frame_index, const RDescriptorIndex a_bright)
+{
+    Chain& chain = m_chains[a_frame_index];
+
+    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, m_prefilter_material);
+    {
+        const uint32_t buffer_indices[] = { 0 };
+        const size_t buffer_offsets[]{ GetGlobalDescriptorAllocation().offset };
+        //set 1, the bright image is read through the bindless textures
+        SetComputeDescriptorBufferOffset(a_list,
+            pipe_layout,
+            SPACE_GLOBAL,
+            _countof(buffer_offsets),
+            buffer_indices,
+            buffer_offsets);
+    }
+
+    ShaderBloom bloom_indices;
+    bloom_indices.bloom_address = chain.address;
+    bloom_indices.src_resolution = chain.draw_area;
+    bloom_indices.dst_resolution = chain.resolution;
+    bloom_indices.src = a_bright.handle;
+    bloom_indices.dst_offset = 0;
+    SetPushConstants(a_list, pipe_layout, 0, sizeof(bloom_indices), &bloom_indices);
+    DispatchCompute(a_list, DivideRoundUp(chain.resolution.x, BLOOM_GROUP_SIZE), DivideRoundUp(chain.resolution.y, BLOOM_GROUP_SIZE), 1);
+
+    chain.prefiltered = true;
+}
+
+void BloomStage::CompositePass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_draw_area_size, const RImageView a_render_target)
 {
+    const Chain& previous = m_chains[(a_frame_index + m_chains.size() - 1) % m_chains.size()];
+    m_chains[a_frame_index].composite_value = previous.compute_value;
+
     SetPrimitiveTopology(a_list, PRIMITIVE_TOPOLOGY::TRIANGLE_LIST);
-    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, m_gaussian_material);
-
-    FixedArray<PipelineBarrierImageInfo, 2> transitions{};
-    PipelineBarrierImageInfo& to_shader_read = transitions[0];
-    to_shader_read.prev = IMAGE_LAYOUT::RT_COLOR;
-    to_shader_read.next = IMAGE_LAYOUT::RO_FRAGMENT;
-    to_shader_read.image = a_render_target_image;
-    to_shader_read.layer_count = 1;
-    to_shader_read.level_count = 1;
-    to_shader_read.base_array_layer = 0;
-    to_shader_read.base_mip_level = 0;
-    to_shader_read.image_aspect = IMAGE_ASPECT::COLOR;
-
-    PipelineBarrierImageInfo& to_render_target = transitions[1];
-    to_render_target.prev = IMAGE_LAYOUT::RO_FRAGMENT;
-    to_render_target.next = IMAGE_LAYOUT::RT_COLOR;
-    to_render_target.image = a_render_target_image;
-    to_render_target.layer_count = 1;
-    to_render_target.level_count = 1;
-    to_render_target.base_array_layer = 1;
-    to_render_target.base_mip_level = 0;
-    to_render_target.image_aspect = IMAGE_ASPECT::COLOR;
-
-    PipelineBarrierInfo barrier_info{};
-    barrier_info.image_barriers = transitions.const_slice();
+    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, m_composite_material);
 
     SetFrontFace(a_list, false);
     SetCullMode(a_list, CULL_MODE::NONE);
-    // horizontal bloom slice
+
+    FixedArray<ColorBlendState, 1> blend_state;
+    blend_state[0].blend_enable = true;
+    blend_state[0].color_flags = 0xF;
+    blend_state[0].color_blend_op = BLEND_OP::ADD;
+    blend_state[0].src_blend = BLEND_MODE::FACTOR_ONE;
+    blend_state[0].dst_blend = BLEND_MODE::FACTOR_ONE;
+    blend_state[0].alpha_blend_op = BLEND_OP::ADD;
+    blend_state[0].src_alpha_blend = BLEND_MODE::FACTOR_SRC_ALPHA;
+    blend_state[0].dst_alpha_blend = BLEND_MODE::FACTOR_DST_ALPHA;
+    SetBlendMode(a_list, 0, blend_state.slice());
+
+    RenderingAttachmentColor color_attach;
+    color_attach.load_color = true;
+    color_attach.store_color = true;
+    color_attach.image_layout = IMAGE_LAYOUT::RT_COLOR;
+    color_attach.image_view = a_render_target;
+    StartRenderingInfo rendering_info;
+    rendering_info.color_attachments = Slice(&color_attach, 1);
+    rendering_info.depth_attachment = nullptr;
+    rendering_info.render_area_extent = a_draw_area_size;
+    rendering_info.render_area_offset = int2{ 0, 0 };
+
+    // every level adds about the same amount of light, the chain is the sum of all of them.
+    ShaderBloomComposite push_constant{};
+    push_constant.bloom_address = previous.address;
+    push_constant.resolution = previous.resolution;
+    push_constant.strength = m_bloom_strength / static_cast<float>(previous.level_count);
+    SetPushConstants(a_list, pipe_layout, 0, sizeof(push_constant), &push_constant);
+
+    StartRenderPass(a_list, rendering_info);
+    DrawVertices(a_list, 3, 1, 0, 0);
+    EndRenderPass(a_list);
+}
+
+uint64_t BloomStage::SubmitComputePasses(const uint32_t a_frame_index, const RFence a_graphics_fence, const uint64_t a_graphics_value)
+{
+    Chain& chain = m_chains[a_frame_index];
+    const uint64_t composite_value = chain.composite_value;
+    chain.composite_value = 0;
+    if (!chain.prefiltered)
     {
-        PipelineBarriers(a_list, barrier_info);
-
-        RenderingAttachmentColor color_attach;
-        color_attach.load_color = false;
-        color_attach.store_color = true;
-        color_attach.image_layout = IMAGE_LAYOUT::RT_COLOR;
-        color_attach.image_view = GetImageView(a_render_target_1);
-        StartRenderingInfo rendering_info;
-        rendering_info.color_attachments = Slice(&color_attach, 1);
-        rendering_info.depth_attachment = nullptr;
-        rendering_info.render_area_extent = a_resolution;
-        rendering_info.render_area_offset = int2();
-
-        ShaderGaussianBlur push_constant;
-        push_constant.horizontal_enable = false;
-        push_constant.src_texture = a_render_target_0;
-        push_constant.src_resolution = a_resolution;
-        push_constant.blur_strength = m_bloom_strength;
-        push_constant.blur_scale = m_bloom_scale;
-
-        SetPushConstants(a_list, pipe_layout, 0, sizeof(push_constant), &push_constant);
-
-        StartRenderPass(a_list, rendering_info);
-        DrawVertices(a_list, 3, 1, 0, 0);
-        EndRenderPass(a_list);
-
-        // ping pong
-        to_render_target.base_array_layer = 0;
-        to_shader_read.base_array_layer = 1;
-        PipelineBarriers(a_list, barrier_info);
+        chain.compute_value = 0;
+        return composite_value;
     }
+    chain.prefiltered = false;
+
+    CommandPool& pool = GetComputeCommandPool();
+    const RCommandList list = pool.StartCommandList("bloom chain");
 
-    // vertical slice
+    PipelineBarrierGlobalInfo global_barrier{};
+    PipelineBarrierInfo level_barrier{};
+    level_barrier.global_barriers = ConstSlice<PipelineBarrierGlobalInfo>(&global_barrier, 1);
+
+    // every level is filtered down from the one before it.
+    FixedArray<uint32_t, BLOOM_MAX_LEVELS> level_offsets;
+    FixedArray<uint2, BLOOM_MAX_LEVELS> level_resolutions;
+    level_offsets[0] = 0;
+    level_resolutions[0] = chain.resolution;
+    for (uint32_t i = 1; i < chain.level_count; i++)
     {
-        FixedArray<ColorBlendState, 1> blend_state;
-        blend_state[0].blend_enable = true;
-        blend_state[0].color_flags = 0xF;
-        blend_state[0].color_blend_op = BLEND_OP::ADD;
-        blend_state[0].src_blend = BLEND_MODE::FACTOR_ONE;
-        blend_state[0].dst_blend = BLEND_MODE::FACTOR_ONE;
-        blend_state[0].alpha_blend_op = BLEND_OP::ADD;
-        blend_state[0].src_alpha_blend = BLEND_MODE::FACTOR_SRC_ALPHA;
-        blend_state[0].dst_alpha_blend = BLEND_MODE::FACTOR_DST_ALPHA;
-        SetBlendMode(a_list, 0, blend_state.slice());
-
-        RenderingAttachmentColor color_attach;
-        color_attach.load_color = true;
-        color_attach.store_color = true;
-        color_attach.image_layout = IMAGE_LAYOUT::RT_COLOR;
-        color_attach.image_view = a_render_target;
-        StartRenderingInfo rendering_info;
-        rendering_info.color_attachments = Slice(&color_attach, 1);
-        rendering_info.depth_attachment = nullptr;
-        rendering_info.render_area_extent = a_draw_area;
-        rendering_info.render_area_offset = int2{ 0, 0 };
-
-        ShaderGaussianBlur push_constant;
-        push_constant.horizontal_enable = true;
-        push_constant.src_texture = a_render_target_1;
-        push_constant.src_resolution = a_resolution;
-        push_constant.blur_strength = m_bloom_strength;
-        push_constant.blur_scale = m_bloom_scale;
-        SetPushConstants(a_list, pipe_layout, 0, sizeof(push_constant), &push_constant);
-
-        StartRenderPass(a_list, rendering_info);
-        DrawVertices(a_list, 3, 1, 0, 0);
-        EndRenderPass(a_list);
+        level_offsets[i] = level_offsets[i - 1] + level_resolutions[i - 1].x * level_resolutions[i - 1].y;
+        level_resolutions[i] = BloomNextLevelResolution(level_resolutions[i - 1]);
     }
+
+    ShaderBloom bloom_indices;
+    bloom_indices.bloom_address = chain.address;
+    RPipelineLayout pipe_layout = Material::BindMaterial(list, m_downsample_material);
+    for (uint32_t i = 1; i < chain.level_count; i++)
+    {
+        bloom_indices.src_resolution = level_resolutions[i - 1];
+        bloom_indices.dst_resolution = level_resolutions[i];
+        bloom_indices.src = level_offsets[i - 1];
+        bloom_indices.dst_offset = level_offsets[i];
+        SetPushConstants(list, pipe_layout, 0, sizeof(bloom_indices), &bloom_indices);
+        DispatchCompute(list, DivideRoundUp(bloom_indices.dst_resolution.x, BLOOM_GROUP_SIZE), DivideRoundUp(bloom_indices.dst_resolution.y, BLOOM_GROUP_SIZE), 1);
+        PipelineBarriers(list, level_barrier);
+    }
+
+    // and then added back up from the smallest level, the first level ends up with all of them.
+    pipe_layout = Material::BindMaterial(list, m_upsample_material);
+    for (uint32_t i = chain.level_count - 1; i > 0; i--)
+    {
+        bloom_indices.src_resolution = level_resolutions[i];
+        bloom_indices.dst_resolution = level_resolutions[i - 1];
+        bloom_indices.src = level_offsets[i];
+        bloom_indices.dst_offset = level_offsets[i - 1];
+        SetPushConstants(list, pipe_layout, 0, sizeof(bloom_indices), &bloom_indices);
+        DispatchCompute(list, DivideRoundUp(bloom_indices.dst_resolution.x, BLOOM_GROUP_SIZE), DivideRoundUp(bloom_indices.dst_resolution.y, BLOOM_GROUP_SIZE), 1);
+        PipelineBarriers(list, level_barrier);
+    }
+
+    pool.EndCommandList(list);
+
+    // waiting on a value that is signaled by a later submit is fine with timeline fences.
+    chain.compute_value = m_next_compute_value++;
+    uint64_t compute_queue_value;
+    const bool success = ExecuteComputeCommands(Slice(&pool, 1), &m_compute_fence, &chain.compute_value, 1, &a_graphics_fence, &a_graphics_value, 1, compute_queue_value);
+    BB_ASSERT(success, "failed to execute bloom compute commands");
+    return composite_value;
+}
+
+uint64_t BloomStage::SetChainArea(Chain& a_chain, const uint2 a_draw_area_size)
+{
+    a_chain.draw_area = a_draw_area_size;
+    a_chain.resolution = BloomNextLevelResolution(a_draw_area_size);
+    a_chain.level_count = 1;
+    uint2 level_resolution = a_chain.resolution;
+    uint64_t texel_count = static_cast<uint64_t>(level_resolution.x) * level_resolution.y;
+    while (a_chain.level_count < BLOOM_MAX_LEVELS)
+    {
+        const uint2 next_resolution = BloomNextLevelResolution(level_resolution);
+        if (next_resolution.x < BLOOM_MIN_RESOLUTION || next_resolution.y < BLOOM_MIN_RESOLUTION)
+            break;
+        level_resolution = next_resolution;
+        texel_count += static_cast<uint64_t>(level_resolution.x) * level_resolution.y;
+        ++a_chain.level_count;
+    }
+    return texel_count * sizeof(uint2);
+}
+
+void BloomStage::CreateChain(Chain& a_chain, const uint2 a_draw_area_size)
+{
+    a_chain.buffer_size = SetChainArea(a_chain, a_draw_area_size);
+
+    GPUBufferCreateInfo chain_buffer_info;
+    chain_buffer_info.name = "bloom chain";
+    chain_buffer_info.size = a_chain.buffer_size;
+    chain_buffer_info.type = BUFFER_TYPE::STORAGE;
+    chain_buffer_info.host_writable = false;
+    a_chain.buffer = CreateGPUBuffer(chain_buffer_info);
+    a_chain.address = GetGPUBufferAddress(a_chain.buffer);
+    a_chain.prefiltered = false;
+    a_chain.compute_value = 0;
 }
@@ -5,16 +5,56 @@
 
 namespace BB
 {
+    // the bright image is filtered into a mip chain on the async compute queue.
+    // a frame composites the chain of the frame before it, so the compute work overlaps the next frame its shadows and meshes.
     class BloomStage
     {
     public:
-        void Init(MemoryArena& a_arena);
-        void ExecutePass(const RCommandList a_list, const uint2 a_resolution, const RImage a_render_target_image, const RDescriptorIndex a_render_target_0, const RDescriptorIndex a_render_target_1, const uint2 a_draw_area, const RImageView a_render_target);
-        //void UpdateConstantBuffer(Scene3DInfo& a_scene_3d_info) const;
+        void Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count);
+        // recreates the chain of the frame when the draw area changed, call before any of the passes.
+        void BeginFrame(const uint32_t a_frame_index, const uint2 a_draw_area_size);
+        // false when the frame before this one has no chain to composite.
+        bool CanComposite(const uint32_t a_frame_index) const;
+
+        // a_bright must be in RO_COMPUTE, writes the first level of the chain on the graphics queue.
+        void PrefilterPass(const RCommandList a_list, const uint32_t a_frame_index, const RDescriptorIndex a_bright);
+        // adds the chain of the frame before on top of a_render_target.
+        void CompositePass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_draw_area_size, const RImageView a_render_target);
+        // submits the rest of the chain to the compute queue, it starts when a_graphics_fence reaches a_graphics_value.
+        // returns the compute value the graphics work of this frame has to wait on, 0 if there is none.
+        uint64_t SubmitComputePasses(const uint32_t a_frame_index, const RFence a_graphics_fence, const uint64_t a_graphics_value);
+
+        RFence GetComputeFence() const { return m_compute_fence; }
+
     private:
+        struct Chain
+        {
+            GPUBuffer buffer;
+            GPUAddress address;
+            uint64_t buffer_size;
+            uint2 draw_area;
+            // of the first level, every level after that is half the one before.
+            uint2 resolution;
+            uint32_t level_count;
+            bool prefiltered;
+            // signaled when the whole chain is done, 0 when the chain has nothing valid.
+            uint64_t compute_value;
+            // the compute value the composite of this frame read from.
+            uint64_t composite_value;
+        };
+        // returns the size in bytes the chain needs for a_draw_area_size.
+        static uint64_t SetChainArea(Chain& a_chain, const uint2 a_draw_area_size);
+        void CreateChain(Chain& a_chain, const uint2 a_draw_area_size);
+
         float m_bloom_strength;
-        float m_bloom_scale;
 
-        MasterMaterialHandle m_gaussian_material;
+        StaticArray<Chain> m_chains;
+        RFence m_compute_fence;
+        uint64_t m_next_compute_value;
+
+        MasterMaterialHandle m_prefilter_material;
+        MasterMaterialHandle m_downsample_material;
+        MasterMaterialHandle m_upsample_material;
+        MasterMaterialHandle m_composite_material;
     };
 }
@@ -0,0 +1,257 @@
+#include "FrameRenderGraph.hpp"
+#include "Renderer.hpp"
+
+using namespace BB;
+
+constexpr uint32_t RENDER_GRAPH_MAX_PASSES = 32;
+constexpr uint32_t RENDER_GRAPH_MAX_IMAGES = 32;
+constexpr uint32_t RENDER_GRAPH_MAX_ACCESSES = 128;
+
+static_assert(static_cast<uint32_t>(IMAGE_LAYOUT::NONE) == RENDER_GRAPH_STATE_UNDEFINED, "the render graph uses image layouts as states");
+
+static IMAGE_ASPECT FormatToAspect(const IMAGE_FORMAT a_format)
+{
+    switch (a_format)
+    {
+    case IMAGE_FORMAT::D16_UNORM:
+    case IMAGE_FORMAT::D32_SFLOAT:
+        return IMAGE_ASPECT::DEPTH;
+    case IMAGE_FORMAT::D32_SFLOAT_S8_UINT:
+    case IMAGE_FORMAT::D24_UNORM_S8_UINT:
+        return IMAGE_ASPECT::DEPTH_STENCIL;
+    default:
+        return IMAGE_ASPECT::COLOR;
+    }
+}
+
+static bool SameImage(const ImageCreateInfo& a_lhs, const ImageCreateInfo& a_rhs)
+{
+    return a_lhs.width == a_rhs.width &&
+        a_lhs.height == a_rhs.height &&
+        a_lhs.depth == a_rhs.depth &&
+        a_lhs.array_layers == a_rhs.array_layers &&
+        a_lhs.mip_levels == a_rhs.mip_levels &&
+        a_lhs.type == a_rhs.type &&
+        a_lhs.format == a_rhs.format &&
+        a_lhs.usage == a_rhs.usage &&
+        a_lhs.use_optimal_tiling == a_rhs.use_optimal_tiling &&
+        a_lhs.is_cube_map == a_rhs.is_cube_map;
+}
+
+void FrameRenderGraph::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count)
+{
+    m_graph.Init(a_arena, RENDER_GRAPH_MAX_PASSES, RENDER_GRAPH_MAX_IMAGES, RENDER_GRAPH_MAX_ACCESSES);
+    m_images.Init(a_arena, RENDER_GRAPH_MAX_IMAGES);
+
+    m_per_frame.Init(a_arena, a_back_buffer_count);
+    m_per_frame.resize(a_back_buffer_count);
+    for (uint32_t i = 0; i < m_per_frame.size(); i++)
+    {
+        PerFrame& pfd = m_per_frame[i];
+        pfd.heap = RMemoryHeap();
+        pfd.heap_size = 0;
+        pfd.heap_memory_type_bits = 0;
+        pfd.images.Init(a_arena, RENDER_GRAPH_MAX_IMAGES);
+    }
+
+    m_current_frame = 0;
+    m_plan = {};
+    m_image_barriers = nullptr;
+}
+
+void FrameRenderGraph::Begin(const uint32_t a_frame_index)
+{
+    m_graph.Reset();
+    m_images.clear();
+    m_current_frame = a_frame_index;
+    m_plan = {};
+    m_image_barriers = nullptr;
+}
+
+RGResource FrameRenderGraph::CreateImage(const ImageCreateInfo& a_create_info)
+{
+    Image image;
+    image.imported = false;
+    image.image = RImage();
+    image.aspect = FormatToAspect(a_create_info.format);
+    image.base_array_layer = 0;
+    image.create_info = a_create_info;
+    image.requirements = GetImageMemoryRequirements(a_create_info);
+    m_images.push_back(image);
+
+    const RGResource resource = m_graph.CreateTransient(a_create_info.name, image.requirements.size, image.requirements.alignment);
+    BB_ASSERT(resource.handle == m_images.size() - 1, "render graph resources and images are out of sync");
+    return resource;
+}
+
+RGResource FrameRenderGraph::ImportImage(const char* a_name, const RImage a_image, const IMAGE_LAYOUT a_layout, const IMAGE_ASPECT a_aspect, const uint16_t a_base_array_layer)
+{
+    Image image{};
+    image.imported = true;
+    image.image = a_image;
+    image.aspect = a_aspect;
+    image.base_array_layer = a_base_array_layer;
+    m_images.push_back(image);
+
+    const RGResource resource = m_graph.Import(a_name, static_cast<uint32_t>(a_layout));
+    BB_ASSERT(resource.handle == m_images.size() - 1, "render graph resources and images are out of sync");
+    return resource;
+}
+
+const RenderGraphPlan& FrameRenderGraph::Compile(MemoryArena& a_per_frame_arena)
+{
+    m_plan = m_graph.Compile(a_per_frame_arena);
+    PerFrame& pfd = m_per_frame[m_current_frame];
+
+    // the graph is mostly the same every frame, only touch the heap when it is not.
+    // StartFrame waited on the fence of this frame, so nothing on the gpu uses the old images.
+    if (!IsRealized(pfd))
+    {
+        FreeRealizedImages(pfd);
+
+        GPUMemoryRequirements heap_requirements;
+        heap_requirements.size = m_plan.transient_heap_size;
+        heap_requirements.alignment = 1;
+        heap_requirements.memory_type_bits = UINT32_MAX;
+        for (uint32_t i = 0; i < m_images.size(); i++)
+        {
+            if (m_images[i].imported || m_plan.resources[i].first_pass == RENDER_GRAPH_INVALID_PASS)
+                continue;
+            heap_requirements.alignment = Max(heap_requirements.alignment, m_images[i].requirements.alignment);
+            heap_requirements.memory_type_bits &= m_images[i].requirements.memory_type_bits;
+        }
+        BB_ASSERT(heap_requirements.memory_type_bits != 0, "render graph images have no memory type in common");
+
+        const bool heap_fits = pfd.heap.IsValid() &&
+            pfd.heap_size >= heap_requirements.size &&
+            (pfd.heap_memory_type_bits & ~heap_requirements.memory_type_bits) == 0;
+        if (!heap_fits && heap_requirements.size != 0)
+        {
+            if (pfd.heap.IsValid())
+                FreeMemoryHeap(pfd.heap);
+            pfd.heap = CreateMemoryHeap("render graph transient heap", heap_requirements);
+            pfd.heap_size = heap_requirements.size;
+            pfd.heap_memory_type_bits = heap_requirements.memory_type_bits;
+        }
+
+        pfd.images.resize(m_images.size());
+        for (uint32_t i = 0; i < m_images.size(); i++)
+        {
+            const Image& image = m_images[i];
+            RealizedImage& realized = pfd.images[i];
+            realized = {};
+            if (image.imported || m_plan.resources[i].first_pass == RENDER_GRAPH_INVALID_PASS)
+                continue;
+
+            realized.heap_offset = m_plan.resources[i].heap_offset;
+            realized.create_info = image.create_info;
+            realized.image = CreateAliasedImage(image.create_info, pfd.heap, realized.heap_offset);
+
+            ImageViewCreateInfo view_info;
+            view_info.name = image.create_info.name;
+            view_info.image = realized.image;
+            view_info.type = IMAGE_VIEW_TYPE::TYPE_2D;
+            view_info.base_array_layer = 0;
+            view_info.array_layers = image.create_info.array_layers;
+            view_info.mip_levels = image.create_info.mip_levels;
+            view_info.base_mip_level = 0;
+            view_info.format = image.create_info.format;
+            view_info.aspects = image.aspect;
+            if (image.aspect == IMAGE_ASPECT::COLOR)
+            {
+                realized.descriptor = CreateImageView(view_info);
+                realized.view = BB::GetImageView(realized.descriptor);
+            }
+            else
+            {
+                realized.view = CreateImageViewShaderInaccessible(view_info);
+                // a sampled view can only have the depth aspect.
+                view_info.aspects = IMAGE_ASPECT::DEPTH;
+                realized.descriptor = CreateImageView(view_info);
+            }
+        }
+    }
+
+    m_image_barriers = ArenaAllocArr(a_per_frame_arena, PipelineBarrierImageInfo, m_plan.barriers.size());
+    for (size_t i = 0; i < m_plan.barriers.size(); i++)
+    {
+        const RenderGraphBarrier& barrier = m_plan.barriers[i];
+        const Image& image = m_images[barrier.resource.handle];
+
+        PipelineBarrierImageInfo& image_barrier = m_image_barriers[i];
+        image_barrier = {};
+        image_barrier.image = image.imported ? image.image : pfd.images[barrier.resource.handle].image;
+        image_barrier.prev = static_cast<IMAGE_LAYOUT>(barrier.prev_state);
+        image_barrier.next = static_cast<IMAGE_LAYOUT>(barrier.next_state);
+        image_barrier.layer_count = image.imported ? 1 : image.create_info.array_layers;
+        image_barrier.level_count = image.imported ? 1 : image.create_info.mip_levels;
+        image_barrier.base_array_layer = image.base_array_layer;
+        image_barrier.base_mip_level = 0;
+        image_barrier.image_aspect = image.aspect;
+    }
+
+    return m_plan;
+}
+
+void FrameRenderGraph::BarrierPass(const RCommandList a_list, const RenderGraphPassPlan& a_pass_plan) const
+{
+    if (a_pass_plan.barrier_count == 0)
+        return;
+
+    // an image that takes over memory from an earlier one has to wait for all the work on that memory.
+    bool aliased = false;
+    for (uint32_t i = a_pass_plan.barrier_start; i < a_pass_plan.barrier_start + a_pass_plan.barrier_count; i++)
+        aliased |= m_plan.barriers[i].aliased;
+
+    PipelineBarrierGlobalInfo global_barrier{};
+    PipelineBarrierInfo barrier_info{};
+    if (aliased)
+        barrier_info.global_barriers = ConstSlice<PipelineBarrierGlobalInfo>(&global_barrier, 1);
+    barrier_info.image_barriers = ConstSlice<PipelineBarrierImageInfo>(&m_image_barriers[a_pass_plan.barrier_start], a_pass_plan.barrier_count);
+    PipelineBarriers(a_list, barrier_info);
+}
+
+RImageView FrameRenderGraph::GetImageView(const RGResource a_image) const
+{
+    BB_ASSERT(!m_images[a_image.handle].imported, "imported render graph images have no view");
+    return m_per_frame[m_current_frame].images[a_image.handle].view;
+}
+
+RDescriptorIndex FrameRenderGraph::GetImageDescriptor(const RGResource a_image) const
+{
+    BB_ASSERT(!m_images[a_image.handle].imported, "imported render graph images have no descriptor");
+    return m_per_frame[m_current_frame].images[a_image.handle].descriptor;
+}
+
+bool FrameRenderGraph::IsRealized(const PerFrame& a_pfd) const
+{
+    if (a_pfd.images.size() != m_images.size())
+        return false;
+
+    for (uint32_t i = 0; i < m_images.size(); i++)
+    {
+        const RealizedImage& realized = a_pfd.images[i];
+        const bool used = !m_images[i].imported && m_plan.resources[i].first_pass != RENDER_GRAPH_INVALID_PASS;
+        if (used != realized.image.IsValid())
+            return false;
+        if (used && (realized.heap_offset != m_plan.resources[i].heap_offset || !SameImage(realized.create_info, m_images[i].create_info)))
+            return false;
+    }
+    return true;
+}
+
+void FrameRenderGraph::FreeRealizedImages(PerFrame& a_pfd)
+{
+    for (uint32_t i = 0; i < a_pfd.images.size(); i++)
+    {
+        RealizedImage& realized = a_pfd.images[i];
+        if (!realized.image.IsValid())
+            continue;
+
+        if (FormatToAspect(realized.create_info.format) != IMAGE_ASPECT::COLOR)
+            FreeImageViewShaderInaccessible(realized.view);
+        FreeImageView(realized.descriptor);
+        FreeAliasedImage(realized.image);
+    }
+    a_pfd.images.clear();
+}
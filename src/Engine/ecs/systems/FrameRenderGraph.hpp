@@ -0,0 +1,88 @@
+#pragma once
+#include "RenderStagesfwd.hpp"
+#include "RenderGraph.hpp"
+
+namespace BB
+{
+    // the image side of the render graph. transient images are placed in one heap per frame and only recreated when the graph changes.
+    class FrameRenderGraph
+    {
+    public:
+        void Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count);
+        void Begin(const uint32_t a_frame_index);
+
+        RGResource CreateImage(const ImageCreateInfo& a_create_info);
+        // a_layout is the layout the image is in before the graph starts.
+        RGResource ImportImage(const char* a_name, const RImage a_image, const IMAGE_LAYOUT a_layout, const IMAGE_ASPECT a_aspect, const uint16_t a_base_array_layer);
+
+        RGPass AddPass(const char* a_name, const bool a_has_side_effects = false)
+        {
+            return m_graph.AddPass(a_name, a_has_side_effects);
+        }
+        void Read(const RGPass a_pass, const RGResource a_image, const IMAGE_LAYOUT a_layout)
+        {
+            m_graph.Read(a_pass, a_image, static_cast<uint32_t>(a_layout));
+        }
+        void Write(const RGPass a_pass, const RGResource a_image, const IMAGE_LAYOUT a_layout)
+        {
+            m_graph.Write(a_pass, a_image, static_cast<uint32_t>(a_layout));
+        }
+        void Overwrite(const RGPass a_pass, const RGResource a_image, const IMAGE_LAYOUT a_layout)
+        {
+            m_graph.Overwrite(a_pass, a_image, static_cast<uint32_t>(a_layout));
+        }
+
+        // creates the transient images and the barriers, the plan stays valid until the next Begin.
+        const RenderGraphPlan& Compile(MemoryArena& a_per_frame_arena);
+        // issues all the barriers a pass needs in one call.
+        void BarrierPass(const RCommandList a_list, const RenderGraphPassPlan& a_pass_plan) const;
+
+        const char* GetPassName(const RGPass a_pass) const { return m_graph.GetPassName(a_pass); }
+
+        // only valid for transient images, after Compile.
+        RImageView GetImageView(const RGResource a_image) const;
+        RDescriptorIndex GetImageDescriptor(const RGResource a_image) const;
+        uint64_t GetTransientHeapSize() const { return m_plan.transient_heap_size; }
+        uint64_t GetTransientUnaliasedSize() const { return m_plan.transient_unaliased_size; }
+
+    private:
+        struct Image
+        {
+            bool imported;
+            RImage image;
+            IMAGE_ASPECT aspect;
+            uint16_t base_array_layer;
+            ImageCreateInfo create_info;
+            GPUMemoryRequirements requirements;
+        };
+
+        // what the heap of a frame holds right now.
+        struct RealizedImage
+        {
+            RImage image;
+            RImageView view;
+            RDescriptorIndex descriptor;
+            uint64_t heap_offset;
+            ImageCreateInfo create_info;
+        };
+
+        struct PerFrame
+        {
+            RMemoryHeap heap;
+            uint64_t heap_size;
+            uint32_t heap_memory_type_bits;
+            StaticArray<RealizedImage> images;
+        };
+
+        bool IsRealized(const PerFrame& a_pfd) const;
+        void FreeRealizedImages(PerFrame& a_pfd);
+
+        RenderGraph m_graph;
+        StaticArray<Image> m_images;
+        StaticArray<PerFrame> m_per_frame;
+        uint32_t m_current_frame;
+
+        RenderGraphPlan m_plan;
+        PipelineBarrierImageInfo* m_image_barriers;
+    };
+}
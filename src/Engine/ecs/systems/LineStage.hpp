@@ -3,7 +3,7 @@
 
 namespace BB
 {
-    constexpr uint32_t LINE_MAX = 64 * 64;
+    constexpr uint32_t LINE_STAGE_MAX = 64 * 64;
 
     class LineStage
     {
@@ -4,41 +4,127 @@
 
 using namespace BB;
 
-void RasterMeshStage::Init(MemoryArena& a_arena, const uint2 a_render_target_extent, const uint32_t a_back_buffer_count)
+constexpr uint64_t CULL_BUFFER_VISIBILITY_SIZE = OCCLUSION_CULL_MAX_DRAWS * sizeof(uint32_t);
+constexpr uint64_t CULL_BUFFER_ARGUMENTS_SIZE = OCCLUSION_CULL_MAX_DRAWS * sizeof(ShaderDrawIndexedIndirect);
+
+static MasterMaterialHandle CreateComputeMaterial(MemoryArena& a_arena, const char* a_path, const char* a_entry, const char* a_name)
+{
+    MaterialShaderCreateInfo compute_shader;
+    compute_shader.path = a_path;
+    compute_shader.entry = a_entry;
+    compute_shader.stage = SHADER_STAGE::COMPUTE;
+    compute_shader.next_stages = static_cast<uint32_t>(SHADER_STAGE::NONE);
+
+    MaterialCreateInfo material_info;
+    material_info.pass_type = PASS_TYPE::SCENE;
+    material_info.material_type = MATERIAL_TYPE::NONE;
+    material_info.shader_infos = Slice(&compute_shader, 1);
+    material_info.user_data_size = 0;
+    material_info.cpu_writeable = false;
+
+    MasterMaterialHandle material;
+    MemoryArenaScope(a_arena)
+    {
+        material = Material::CreateMasterMaterial(a_arena, material_info, a_name);
+    }
+    return material;
+}
+
+static uint32_t DivideRoundUp(const uint32_t a_value, const uint32_t a_divisor)
+{
+    return (a_value + a_divisor - 1) / a_divisor;
+}
+
+static uint2 HiZNextLevelResolution(const uint2 a_resolution)
+{
+    return uint2(Max((a_resolution.x + 1) / 2, 1u), Max((a_resolution.y + 1) / 2, 1u));
+}
+
+// the first level is half the depth buffer, every level after that halves again down to 1x1.
+static uint64_t HiZBufferSize(const uint2 a_depth_extent)
 {
-    m_per_frame.Init(a_arena, a_back_buffer_count);
-    m_per_frame.resize(a_back_buffer_count);
-    for (uint32_t i = 0; i < m_per_frame.size(); i++)
+    uint2 level_resolution = HiZNextLevelResolution(a_depth_extent);
+    uint64_t hiz_size = 0;
+    while (true)
     {
-        PerFrame& pfd = m_per_frame[i];
-        CreateDepthImages(pfd, a_render_target_extent);
+        hiz_size += static_cast<uint64_t>(level_resolution.x) * level_resolution.y * sizeof(float);
+        if (level_resolution.x == 1 && level_resolution.y == 1)
+            break;
+        level_resolution = HiZNextLevelResolution(level_resolution);
     }
+    return hiz_size;
 }
 
-void RasterMeshStage::ExecutePass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright)
+void RasterMeshStage::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count)
 {
-    PerFrame& pfd = m_per_frame[a_frame_index];
+    m_hiz_build_material = CreateComputeMaterial(a_arena, "HLSL/HiZBuild.hlsl", "ComputeMain", "hi-z build material");
+    m_early_cull_material = CreateComputeMaterial(a_arena, "HLSL/OcclusionCull.hlsl", "EarlyMain", "early occlusion cull material");
+    m_late_cull_material = CreateComputeMaterial(a_arena, "HLSL/OcclusionCull.hlsl", "LateMain", "late occlusion cull material");
 
-    if (pfd.depth_extent != a_draw_area_size)
+    GPUBufferCreateInfo cull_buffer_info;
+    cull_buffer_info.name = "occlusion cull buffer";
+    cull_buffer_info.size = CULL_BUFFER_VISIBILITY_SIZE + CULL_BUFFER_ARGUMENTS_SIZE * 2;
+    cull_buffer_info.type = BUFFER_TYPE::INDIRECT;
+    cull_buffer_info.host_writable = false;
+    m_cull_buffer = CreateGPUBuffer(cull_buffer_info);
+    m_cull_address = GetGPUBufferAddress(m_cull_buffer);
+
+    m_hiz.Init(a_arena, a_back_buffer_count);
+    m_hiz.resize(a_back_buffer_count);
+    for (uint32_t i = 0; i < m_hiz.size(); i++)
+    {
+        m_hiz[i].buffer = GPUBuffer();
+        m_hiz[i].buffer_size = 0;
+        m_hiz[i].depth_extent = uint2(0, 0);
+        m_hiz[i].valid = false;
+    }
+}
+
+void RasterMeshStage::BeginFrame(const uint32_t a_frame_index, const uint2 a_draw_area_size)
+{
+    HiZ& hiz = m_hiz[a_frame_index];
+    if (hiz.depth_extent == a_draw_area_size)
+        return;
+
+    // dynamic resolution changes the draw area often, a smaller pyramid fits in the buffer that is already there.
+    // the cull maps screen space onto whatever size a pyramid has, so the pyramids of other frames stay valid.
+    if (hiz.buffer.IsValid() && HiZBufferSize(a_draw_area_size) <= hiz.buffer_size)
     {
-        FreeImage(pfd.depth_image);
-        FreeImageViewShaderInaccessible(pfd.depth_image_view);
-        CreateDepthImages(pfd, a_draw_area_size);
+        hiz.depth_extent = a_draw_area_size;
+        hiz.resolution = HiZNextLevelResolution(a_draw_area_size);
+        hiz.valid = false;
+        return;
     }
 
-    PipelineBarrierImageInfo image_transitions[1]{};
-    image_transitions[0].prev = IMAGE_LAYOUT::NONE;
-    image_transitions[0].next = IMAGE_LAYOUT::RT_DEPTH;
-    image_transitions[0].image = pfd.depth_image;
-    image_transitions[0].layer_count = 1;
-    image_transitions[0].level_count = 1;
-    image_transitions[0].base_array_layer = 0;
-    image_transitions[0].base_mip_level = 0;
-    image_transitions[0].image_aspect = IMAGE_ASPECT::DEPTH_STENCIL;
+    // the pyramid of every frame is read by the frame after it, wait until nothing uses the old one.
+    GPUWaitIdle();
+    for (uint32_t i = 0; i < m_hiz.size(); i++)
+        m_hiz[i].valid = false;
+    if (hiz.buffer.IsValid())
+        FreeGPUBuffer(hiz.buffer);
+    CreateHiZ(hiz, a_draw_area_size);
+}
+
+bool RasterMeshStage::CanOcclusionCull(const DrawList& a_draw_list) const
+{
+    return a_draw_list.draw_entries.size() <= OCCLUSION_CULL_MAX_DRAWS;
+}
+
+void RasterMeshStage::DrawPass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright, const RImageView a_depth)
+{
+    RenderDraws(a_list, a_draw_area_size, a_draw_list, a_render_target, a_render_target_bright, a_depth, false, OCCLUSION_PASS::EARLY);
+    m_hiz[a_frame_index].valid = false;
+}
+
+void RasterMeshStage::OcclusionDrawPass(const RCommandList a_list, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright, const RImageView a_depth, const OCCLUSION_PASS a_pass)
+{
+    RenderDraws(a_list, a_draw_area_size, a_draw_list, a_render_target, a_render_target_bright, a_depth, true, a_pass);
+}
 
-    PipelineBarrierInfo pipeline_info = {};
-    pipeline_info.image_barriers = ConstSlice<PipelineBarrierImageInfo>(image_transitions, 1);
-    PipelineBarriers(a_list, pipeline_info);
+void RasterMeshStage::RenderDraws(const RCommandList a_list, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright, const RImageView a_depth, const bool a_occlusion_culled, const OCCLUSION_PASS a_pass)
+{
+    // the late pass draws on top of the early pass.
+    const bool load = a_pass == OCCLUSION_PASS::LATE;
 
     FixedArray<RenderingAttachmentColor, 2> color_attachs;
     color_attachs[0].load_color = true;
@@ -46,17 +132,17 @@ void RasterMeshStage::ExecutePass(const RCommandList a_list, const uint32_t a_fr
     color_attachs[0].image_layout = IMAGE_LAYOUT::RT_COLOR;
     color_attachs[0].image_view = a_render_target;
 
-    color_attachs[1].load_color = false;
+    color_attachs[1].load_color = load;
     color_attachs[1].store_color = true;
     color_attachs[1].image_layout = IMAGE_LAYOUT::RT_COLOR;
     color_attachs[1].image_view = a_render_target_bright;
     const uint32_t color_attach_count = 2;
 
     RenderingAttachmentDepth depth_attach{};
-    depth_attach.load_depth = false;
+    depth_attach.load_depth = load;
     depth_attach.store_depth = true;
     depth_attach.image_layout = IMAGE_LAYOUT::RT_DEPTH;
-    depth_attach.image_view = pfd.depth_image_view;
+    depth_attach.image_view = a_depth;
 
     StartRenderingInfo rendering_info;
     rendering_info.color_attachments = color_attachs.slice(color_attach_count);
@@ -86,9 +172,12 @@ void RasterMeshStage::ExecutePass(const RCommandList a_list, const uint32_t a_fr
     SetFrontFace(a_list, false);
     SetCullMode(a_list, CULL_MODE::NONE);
 
+    const uint64_t arguments_offset = CULL_BUFFER_VISIBILITY_SIZE + (a_pass == OCCLUSION_PASS::LATE ? CULL_BUFFER_ARGUMENTS_SIZE : 0);
     for (uint32_t i = 0; i < a_draw_list.draw_entries.size(); i++)
     {
         const DrawList::DrawEntry& mesh_draw_call = a_draw_list.draw_entries[i];
+        if (mesh_draw_call.culled_index_count == 0)
+            continue;
 
         SetPrimitiveTopology(a_list, PRIMITIVE_TOPOLOGY::TRIANGLE_LIST);
         const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, mesh_draw_call.master_material);
@@ -112,44 +201,114 @@ void RasterMeshStage::ExecutePass(const RCommandList a_list, const uint32_t a_fr
         shader_indices.color_offset = static_cast<uint32_t>(mesh_draw_call.mesh.vertex_color_offset);
         shader_indices.tangent_offset = static_cast<uint32_t>(mesh_draw_call.mesh.vertex_tangent_offset);
         shader_indices.material_index = RDescriptorIndex(mesh_draw_call.material.index);
+        shader_indices.vertex_format = mesh_draw_call.mesh.vertex_format;
         SetPushConstants(a_list, pipe_layout, 0, sizeof(shader_indices), &shader_indices);
-        DrawIndexed(a_list,
-            mesh_draw_call.index_count,
-            1,
-            static_cast<uint32_t>(mesh_draw_call.mesh.index_buffer_offset / sizeof(uint32_t)) + mesh_draw_call.index_start,
-            0,
-            0);
+        if (a_occlusion_culled)
+        {
+            // the cull pass wrote an instance count of 0 or 1 for every draw.
+            DrawIndexedIndirect(a_list, m_cull_buffer, arguments_offset + i * sizeof(ShaderDrawIndexedIndirect), 1, sizeof(ShaderDrawIndexedIndirect));
+        }
+        else
+        {
+            DrawIndexed(a_list,
+                mesh_draw_call.culled_index_count,
+                1,
+                mesh_draw_call.culled_first_index,
+                0,
+                0);
+        }
     }
 
     EndRenderPass(a_list);
 }
 
-void RasterMeshStage::CreateDepthImages(PerFrame& a_frame, const uint2 a_extent)
+void RasterMeshStage::CullPass(const RCommandList a_list, const uint32_t a_frame_index, const DrawList& a_draw_list, const GPUAddress a_occlusion_draws, const OCCLUSION_PASS a_pass)
+{
+    // the early pass tests against the pyramid of last frame, the late pass against the one built this frame.
+    const uint32_t hiz_frame = a_pass == OCCLUSION_PASS::EARLY ? (a_frame_index + m_hiz.size() - 1) % m_hiz.size() : a_frame_index;
+    const HiZ& hiz = m_hiz[hiz_frame];
+    const uint32_t draw_count = a_draw_list.draw_entries.size();
+
+    const MasterMaterialHandle material = a_pass == OCCLUSION_PASS::EARLY ? m_early_cull_material : m_late_cull_material;
+    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, material);
+
+    ShaderOcclusionCull cull_indices;
+    cull_indices.draws_address = a_occlusion_draws;
+    cull_indices.cull_address = m_cull_address;
+    cull_indices.hiz_address = hiz.valid ? hiz.address : 0;
+    cull_indices.draw_count = draw_count;
+    cull_indices.hiz_resolution = hiz.resolution.x | (hiz.resolution.y << 16);
+    SetPushConstants(a_list, pipe_layout, 0, sizeof(cull_indices), &cull_indices);
+    DispatchCompute(a_list, DivideRoundUp(draw_count, OCCLUSION_CULL_GROUP_SIZE), 1, 1);
+
+    // the indirect arguments are read by the draws after this, the render graph only tracks images.
+    PipelineBarrierGlobalInfo global_barrier{};
+    PipelineBarrierInfo barrier_info{};
+    barrier_info.global_barriers = ConstSlice<PipelineBarrierGlobalInfo>(&global_barrier, 1);
+    PipelineBarriers(a_list, barrier_info);
+}
+
+void RasterMeshStage::BuildHiZPass(const RCommandList a_list, const uint32_t a_frame_index, const RDescriptorIndex a_depth_descriptor)
 {
-    ImageCreateInfo depth_img_info;
-    depth_img_info.name = "scene depth buffer";
-    depth_img_info.width = a_extent.x;
-    depth_img_info.height = a_extent.y;
-    depth_img_info.depth = 1;
-    depth_img_info.mip_levels = 1;
-    depth_img_info.array_layers = 1;
-    depth_img_info.format = IMAGE_FORMAT::D24_UNORM_S8_UINT;
-    depth_img_info.usage = IMAGE_USAGE::DEPTH;
-    depth_img_info.type = IMAGE_TYPE::TYPE_2D;
-    depth_img_info.use_optimal_tiling = true;
-    depth_img_info.is_cube_map = false;
-    a_frame.depth_image = CreateImage(depth_img_info);
-
-    ImageViewCreateInfo depth_img_view_info;
-    depth_img_view_info.name = "scene depth view";
-    depth_img_view_info.image = a_frame.depth_image;
-    depth_img_view_info.type = IMAGE_VIEW_TYPE::TYPE_2D;
-    depth_img_view_info.base_array_layer = 0;
-    depth_img_view_info.array_layers = 1;
-    depth_img_view_info.mip_levels = 1;
-    depth_img_view_info.base_mip_level = 0;
-    depth_img_view_info.format = IMAGE_FORMAT::D24_UNORM_S8_UINT;
-    depth_img_view_info.aspects = IMAGE_ASPECT::DEPTH_STENCIL;
-    a_frame.depth_image_view = CreateImageViewShaderInaccessible(depth_img_view_info);
-    a_frame.depth_extent = a_extent;
+    HiZ& hiz = m_hiz[a_frame_index];
+
+    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, m_hiz_build_material);
+    {
+        const uint32_t buffer_indices[] = { 0 };
+        const size_t buffer_offsets[]{ GetGlobalDescriptorAllocation().offset };
+        //set 1, the depth is read through the bindless textures
+        SetComputeDescriptorBufferOffset(a_list,
+            pipe_layout,
+            SPACE_GLOBAL,
+            _countof(buffer_offsets),
+            buffer_indices,
+            buffer_offsets);
+    }
+
+    PipelineBarrierGlobalInfo global_barrier{};
+    PipelineBarrierInfo level_barrier{};
+    level_barrier.global_barriers = ConstSlice<PipelineBarrierGlobalInfo>(&global_barrier, 1);
+
+    ShaderHiZBuild build_indices;
+    build_indices.hiz_address = hiz.address;
+    build_indices.src_resolution = hiz.depth_extent;
+    build_indices.dst_resolution = hiz.resolution;
+    build_indices.src_offset = 0;
+    build_indices.depth_texture = a_depth_descriptor;
+    while (true)
+    {
+        SetPushConstants(a_list, pipe_layout, 0, sizeof(build_indices), &build_indices);
+        DispatchCompute(a_list, DivideRoundUp(build_indices.dst_resolution.x, HIZ_BUILD_GROUP_SIZE), DivideRoundUp(build_indices.dst_resolution.y, HIZ_BUILD_GROUP_SIZE), 1);
+        // also makes the last level visible to the late cull.
+        PipelineBarriers(a_list, level_barrier);
+
+        if (build_indices.dst_resolution.x == 1 && build_indices.dst_resolution.y == 1)
+            break;
+
+        // the level after the first reads the one just written, descriptor 0 is the invalid texture.
+        if (build_indices.depth_texture != RDescriptorIndex(0))
+            build_indices.depth_texture = RDescriptorIndex(0);
+        else
+            build_indices.src_offset += build_indices.src_resolution.x * build_indices.src_resolution.y;
+        build_indices.src_resolution = build_indices.dst_resolution;
+        build_indices.dst_resolution = HiZNextLevelResolution(build_indices.dst_resolution);
+    }
+
+    hiz.valid = true;
+}
+
+void RasterMeshStage::CreateHiZ(HiZ& a_hiz, const uint2 a_depth_extent)
+{
+    a_hiz.depth_extent = a_depth_extent;
+    a_hiz.resolution = HiZNextLevelResolution(a_depth_extent);
+    a_hiz.buffer_size = HiZBufferSize(a_depth_extent);
+
+    GPUBufferCreateInfo hiz_buffer_info;
+    hiz_buffer_info.name = "hi-z pyramid";
+    hiz_buffer_info.size = a_hiz.buffer_size;
+    hiz_buffer_info.type = BUFFER_TYPE::STORAGE;
+    hiz_buffer_info.host_writable = false;
+    a_hiz.buffer = CreateGPUBuffer(hiz_buffer_info);
+    a_hiz.address = GetGPUBufferAddress(a_hiz.buffer);
+    a_hiz.valid = false;
 }
@@ -10,21 +10,46 @@ namespace BB
     class RasterMeshStage
     {
     public:
-        void Init(MemoryArena& a_arena, const uint2 a_render_target_extent, const uint32_t a_back_buffer_count);
-        void ExecutePass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright);
-        RImageView GetDepth(const uint32_t a_frame_index) const
+        enum class OCCLUSION_PASS
         {
-            return m_per_frame[a_frame_index].depth_image_view;
-        }
+            EARLY,
+            LATE
+        };
+
+        void Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count);
+        // recreates the hi-z pyramid of the frame when the draw area changed, call before any of the passes.
+        void BeginFrame(const uint32_t a_frame_index, const uint2 a_draw_area_size);
+        bool CanOcclusionCull(const DrawList& a_draw_list) const;
+
+        // draws everything without occlusion culling, the next frame has no pyramid to test against.
+        void DrawPass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright, const RImageView a_depth);
+        // two phases, what was visible last frame is drawn first and builds the pyramid that culls the rest.
+        // a_occlusion_draws points to a ShaderOcclusionCullHeader followed by draw_list.occlusion_draws.
+        void CullPass(const RCommandList a_list, const uint32_t a_frame_index, const DrawList& a_draw_list, const GPUAddress a_occlusion_draws, const OCCLUSION_PASS a_pass);
+        void OcclusionDrawPass(const RCommandList a_list, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright, const RImageView a_depth, const OCCLUSION_PASS a_pass);
+        // a_depth_descriptor must be in RO_COMPUTE.
+        void BuildHiZPass(const RCommandList a_list, const uint32_t a_frame_index, const RDescriptorIndex a_depth_descriptor);
     private:
-        struct PerFrame
+        // built from the depth of the early pass, the next frame tests against it before it has any depth.
+        struct HiZ
         {
-            RImage depth_image;
-            RImageView depth_image_view;
+            GPUBuffer buffer;
+            GPUAddress address;
+            uint64_t buffer_size;
             uint2 depth_extent;
+            uint2 resolution;
+            bool valid;
         };
-        void CreateDepthImages(PerFrame& a_frame, const uint2 a_extent);
+        void CreateHiZ(HiZ& a_hiz, const uint2 a_depth_extent);
+        void RenderDraws(const RCommandList a_list, const uint2 a_draw_area_size, const DrawList& a_draw_list, const RImageView a_render_target, const RImageView a_render_target_bright, const RImageView a_depth, const bool a_occlusion_culled, const OCCLUSION_PASS a_pass);
+
+        StaticArray<HiZ> m_hiz;
 
-        StaticArray<PerFrame> m_per_frame;
+        MasterMaterialHandle m_hiz_build_material;
+        MasterMaterialHandle m_early_cull_material;
+        MasterMaterialHandle m_late_cull_material;
+        // the visibility of last frame and the indirect arguments, shared by all frames since they run in order on the gpu.
+        GPUBuffer m_cull_buffer;
+        GPUAddress m_cull_address;
     };
 }
@@ -32,9 +32,16 @@ namespace BB
             MaterialHandle material;
             uint32_t index_start;
             uint32_t index_count;
+            // what survived meshlet culling, the first index is into the whole index buffer.
+            uint32_t culled_first_index;
+            uint32_t culled_index_count;
         };
 
         StaticArray<DrawEntry> draw_entries;
         StaticArray<ShaderTransform> transforms;
+        // world space bounds of every draw entry for the gpu occlusion culling.
+        StaticArray<ShaderOcclusionDraw> occlusion_draws;
+        // copies the visible meshlet indices next to each other, so that a culled draw is still one draw call.
+        StaticArray<RenderCopyBufferRegion> meshlet_index_copies;
     };
 }
@@ -5,22 +5,33 @@
 
 #include "AssetLoader.hpp"
 
+#include <cfloat>
+#include <chrono>
+
 using namespace BB;
 
-constexpr float BLOOM_IMAGE_DOWNSCALE_FACTOR = 1.f;
+constexpr size_t MESHLET_INDEX_BUFFER_SIZE = mbSize * 4;
+constexpr uint32_t MESHLET_INDEX_COPY_MAX = 8192;
+constexpr uint32_t RENDER_STAGE_CPU_TIME_MAX = 32;
 
-void RenderSystem::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count, const uint32_t a_max_lights, const uint2 a_render_target_size)
+static double GetTimeInMiliseconds()
+{
+	const auto now = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(now.time_since_epoch()).count();
+}
+
+void RenderSystem::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count, const uint32_t a_max_lights, const uint32_t a_render_entity_max, const uint2 a_render_target_size)
 {
 	m_global_buffer.light_max = a_max_lights;
 	GPUBufferCreateInfo buff_create;
 	buff_create.name = "light buffer";
-	buff_create.size = a_max_lights * (sizeof(Light) + sizeof(float4x4));
+	buff_create.size = a_max_lights * (sizeof(Light) + sizeof(ShaderShadow) * SHADOW_CASCADE_COUNT);
 	buff_create.type = BUFFER_TYPE::UNIFORM;
 	buff_create.host_writable = false;
 	m_global_buffer.buffer.Init(buff_create);
 
 	m_global_buffer.buffer.Allocate(a_max_lights * sizeof(Light), m_global_buffer.light_view);
-	m_global_buffer.buffer.Allocate(a_max_lights * sizeof(float4x4), m_global_buffer.light_viewproj_view);
+	m_global_buffer.buffer.Allocate(a_max_lights * sizeof(ShaderShadow) * SHADOW_CASCADE_COUNT, m_global_buffer.shadow_view);
 
 	m_fence = CreateFence(0, "scene fence");
 	m_last_completed_fence_value = 0;
@@ -30,18 +41,37 @@ void RenderSystem::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count
 
 	m_scene_info.ambient_light = float4(0.03f, 0.03f, 0.03f, 1.f);
 	m_scene_info.exposure = 1.0;
-	m_scene_info.shadow_map_resolution = float2(DEPTH_IMAGE_SIZE_W_H, DEPTH_IMAGE_SIZE_W_H);
 
 	m_options.skip_skybox = false;
 	m_options.skip_shadow_mapping = false;
 	m_options.skip_object_rendering = false;
 	m_options.skip_bloom = false;
+	m_options.skip_meshlet_culling = false;
+	m_options.skip_occlusion_culling = false;
+	m_options.dynamic_resolution = false;
+	m_meshlet_cull_stats = {};
+	m_stage_cpu_times.Init(a_arena, RENDER_STAGE_CPU_TIME_MAX);
+	m_changed_caster_bounds = {};
+	m_all_casters_changed = true;
+	m_prepared_transforms.Init(a_arena, a_render_entity_max);
 
     m_clear_stage.Init(a_arena);
-    m_shadowmap_stage.Init(a_arena, a_back_buffer_count);
-    m_raster_mesh_stage.Init(a_arena, a_render_target_size, a_back_buffer_count);
-    m_bloom_stage.Init(a_arena);
-	m_line_stage.Init(a_arena, a_back_buffer_count, LINE_MAX);
+    m_shadowmap_stage.Init(a_arena, a_max_lights);
+    m_raster_mesh_stage.Init(a_arena, a_back_buffer_count);
+    m_bloom_stage.Init(a_arena, a_back_buffer_count);
+	m_line_stage.Init(a_arena, a_back_buffer_count, LINE_STAGE_MAX);
+	m_upscale_stage.Init(a_arena);
+	m_render_graph.Init(a_arena, a_back_buffer_count);
+
+	m_timestamp_pool = CreateTimestampPool(a_back_buffer_count * 2, "frame timestamps");
+	m_previous_frame_start = GetTimeInMiliseconds();
+	DynamicResolutionCreateInfo dynamic_resolution_info;
+	dynamic_resolution_info.target_frame_time = 1000.f / 60.f;
+	dynamic_resolution_info.min_scale = 0.5f;
+	dynamic_resolution_info.max_scale = 1.f;
+	dynamic_resolution_info.window_size = 8;
+	m_dynamic_resolution.Init(a_arena, dynamic_resolution_info);
+	m_render_size = a_render_target_size;
 
 	// per frame
 	m_per_frame.Init(a_arena, a_back_buffer_count);
@@ -49,7 +79,6 @@ void RenderSystem::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count
 	for (uint32_t i = 0; i < m_per_frame.size(); i++)
 	{
 		PerFrame& pfd = m_per_frame[i];
-		pfd.previous_draw_area = { 0, 0 };
 		pfd.scene_descriptor = AllocateDescriptor(GetSceneDescriptorLayout());
 
 		pfd.scene_buffer.Init(BUFFER_TYPE::UNIFORM, sizeof(m_scene_info), "scene info buffer");
@@ -70,8 +99,10 @@ void RenderSystem::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count
 		pfd.storage_buffer.Init(buffer_info);
 
 		pfd.fence_value = 0;
+		pfd.timestamps_written = false;
 
-		pfd.bloom.image = RImage();
+		pfd.meshlet_indices.view = AllocateFromIndexBuffer(MESHLET_INDEX_BUFFER_SIZE, pfd.meshlet_indices.allocation);
+		pfd.meshlet_indices.used = 0;
 	}
 	m_render_target.format = IMAGE_FORMAT::RGBA8_SRGB;
 	CreateRenderTarget(a_render_target_size);
@@ -128,9 +159,9 @@ RDescriptorLayout RenderSystem::GetSceneDescriptorLayout()
 	descriptor_bindings[2].shader_stage = SHADER_STAGE::FRAGMENT_PIXEL;
 	descriptor_bindings[2].type = DESCRIPTOR_TYPE::READONLY_BUFFER;
 
-	descriptor_bindings[3].binding = PER_SCENE_LIGHT_PROJECTION_VIEW_DATA_BINDING;
+	descriptor_bindings[3].binding = PER_SCENE_SHADOW_DATA_BINDING;
 	descriptor_bindings[3].count = 1;
-	descriptor_bindings[3].shader_stage = SHADER_STAGE::VERTEX;
+	descriptor_bindings[3].shader_stage = SHADER_STAGE::ALL;
 	descriptor_bindings[3].type = DESCRIPTOR_TYPE::READONLY_BUFFER;
 	s_scene_descriptor_layout = CreateDescriptorLayout(temp_arena, descriptor_bindings.const_slice());
 
@@ -141,9 +172,21 @@ RDescriptorLayout RenderSystem::GetSceneDescriptorLayout()
 void RenderSystem::StartFrame(const RCommandList a_list)
 {
 	PerFrame& pfd = m_per_frame[m_current_frame];
+	const double frame_start = GetTimeInMiliseconds();
 	WaitFence(m_fence, pfd.fence_value);
+	const double fence_wait_time = GetTimeInMiliseconds() - frame_start;
 	pfd.fence_value = m_next_fence_value;
 
+	// the cpu time is the time between 2 frames without the time spend waiting on the gpu.
+	const uint32_t first_timestamp = m_current_frame * 2;
+	double timestamps[2];
+	if (pfd.timestamps_written && ReadTimestamps(m_timestamp_pool, first_timestamp, 2, timestamps) && m_options.dynamic_resolution)
+		m_dynamic_resolution.Update(frame_start - m_previous_frame_start - fence_wait_time, timestamps[1] - timestamps[0]);
+	m_previous_frame_start = frame_start;
+
+	ResetTimestamps(a_list, m_timestamp_pool, first_timestamp, 2);
+	WriteTimestamp(a_list, m_timestamp_pool, first_timestamp);
+
 	PipelineBarrierImageInfo render_target_transition;
 	render_target_transition.prev = IMAGE_LAYOUT::NONE;
 	render_target_transition.next = IMAGE_LAYOUT::RT_COLOR;
@@ -157,8 +200,6 @@ void RenderSystem::StartFrame(const RCommandList a_list)
 	PipelineBarrierInfo pipeline_info{};
 	pipeline_info.image_barriers = ConstSlice<PipelineBarrierImageInfo>(&render_target_transition, 1);
 	PipelineBarriers(a_list, pipeline_info);
-
-
 }
 
 RenderSystemFrame RenderSystem::EndFrame(const RCommandList a_list, const IMAGE_LAYOUT a_current_layout)
@@ -177,18 +218,29 @@ RenderSystemFrame RenderSystem::EndFrame(const RCommandList a_list, const IMAGE_
 	pipeline_info.image_barriers = ConstSlice<PipelineBarrierImageInfo>(&render_target_transition, 1);
 	PipelineBarriers(a_list, pipeline_info);
 
+	WriteTimestamp(a_list, m_timestamp_pool, m_current_frame * 2 + 1);
+	m_per_frame[m_current_frame].timestamps_written = true;
+
 	RenderSystemFrame frame;
 	frame.render_target = m_per_frame[m_current_frame].render_target_view;
+	const uint32_t frame_index = m_current_frame;
 	m_current_frame = (m_current_frame + 1) % m_per_frame.size();
 
 	frame.fence = m_fence;
 	frame.fence_value = m_next_fence_value++;
+	// the bloom chain of this frame starts on the compute queue once the graphics work is done, the next frame composites it.
+	frame.wait_fence = m_bloom_stage.GetComputeFence();
+	frame.wait_value = m_bloom_stage.SubmitComputePasses(frame_index, frame.fence, frame.fence_value);
+	if (frame.wait_value == 0)
+		frame.wait_fence = RFence();
 	return frame;
 }
 
 void RenderSystem::UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCommandList a_list, const uint2 a_draw_area, const WorldMatrixComponentPool& a_world_matrices, const RenderComponentPool& a_render_pool, const RaytraceComponentPool& a_raytrace_pool, const ConstSlice<LightComponent> a_lights)
 {
 	PerFrame& pfd = m_per_frame[m_current_frame];
+	m_stage_cpu_times.clear();
+	double stage_start = GetTimeInMiliseconds();
 
 	const ConstSlice<ECSEntity> render_entities = a_render_pool.GetEntityComponents();
     const size_t render_component_count = render_entities.size();
@@ -197,6 +249,10 @@ void RenderSystem::UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCom
     DrawList draw_list;
     draw_list.draw_entries.Init(a_per_frame_arena, static_cast<uint32_t>(render_component_count));
     draw_list.transforms.Init(a_per_frame_arena, static_cast<uint32_t>(render_component_count));
+    draw_list.occlusion_draws.Init(a_per_frame_arena, static_cast<uint32_t>(render_component_count));
+    StaticArray<RenderComponent*> dirty_materials{};
+    dirty_materials.Init(a_per_frame_arena, static_cast<uint32_t>(render_component_count));
+	StartMeshletCulling(pfd, draw_list, a_per_frame_arena);
 
 	for (size_t i = 0; i < render_component_count; i++)
 	{
@@ -204,14 +260,6 @@ void RenderSystem::UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCom
 		const float4x4& transform = a_world_matrices.GetComponent(render_entities[i]);
 		//RaytraceComponent& ray_comp = a_raytrace_pool.GetComponent(render_entities[i]);
 
-		if (comp.material_dirty)
-		{
-			const uint64_t upload_offset = m_upload_allocator.AllocateUploadMemory(sizeof(comp.material_data), pfd.fence_value);
-			m_upload_allocator.MemcpyIntoBuffer(upload_offset, &comp.material_data, sizeof(comp.material_data));
-			Material::WriteMaterial(comp.material, a_list, m_upload_allocator.GetBuffer(), upload_offset);
-			comp.material_dirty = false;
-		}
-
 		// raytrace stuff
 		//if (ray_comp.needs_build)
 		//{
@@ -240,51 +288,286 @@ void RenderSystem::UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCom
 		//	//BuildBottomLevelAccelerationStruct(a_per_frame_arena, a_list, acc_build_info);
 		//}
 
-		DrawList::DrawEntry entry;
-		entry.mesh = comp.mesh;
-		entry.master_material = comp.master_material;
-		entry.material = comp.material;
-		entry.index_start = comp.index_start;
-		entry.index_count = comp.index_count;
+		AddDrawEntry(a_per_frame_arena, pfd, render_entities[i], comp, transform, draw_list, dirty_materials);
+	}
+	WriteDirtyMaterials(a_per_frame_arena, pfd, a_list, dirty_materials.const_slice());
+	stage_start = AddStageCPUTime("draw list", stage_start);
 
-		ShaderTransform shader_transform;
-		shader_transform.transform = transform;
-		shader_transform.inverse = Float4x4Inverse(transform);
+	//if (m_raytrace_data.top_level.must_rebuild || !m_raytrace_data.top_level.accel_struct.IsValid())
+    if (false)
+	{
+		GPUAddress* acceleration_structs = ArenaAllocArr(a_per_frame_arena, GPUAddress, render_component_count);
+		for (size_t i = 0; i < render_component_count; i++)
+			acceleration_structs[i] = a_raytrace_pool.GetComponent(render_entities[i]).acceleration_struct_address;
 
-		draw_list.draw_entries.push_back(entry);
-		draw_list.transforms.push_back(shader_transform);
+		BuildDrawListTopLevel(a_per_frame_arena, a_list, draw_list, ConstSlice<GPUAddress>(acceleration_structs, render_component_count));
 	}
 
-	BindIndexBuffer(a_list, 0);
-	UpdateConstantBuffer(m_current_frame, a_list, a_draw_area, a_lights);
+	RenderDrawList(a_per_frame_arena, pfd, a_list, a_draw_area, draw_list, a_lights, stage_start);
+}
+
+void RenderSystem::UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCommandList a_list, const uint2 a_draw_area, const ECSArchetypeMap& a_archetypes, const ConstSlice<LightComponent> a_lights)
+{
+	PerFrame& pfd = m_per_frame[m_current_frame];
+	m_stage_cpu_times.clear();
+	double stage_start = GetTimeInMiliseconds();
+
+	const uint32_t render_component_count = a_archetypes.Count<WorldMatrixComponentPool, RenderComponentPool>();
+	if (render_component_count == 0)
+		return;
+	DrawList draw_list;
+	draw_list.draw_entries.Init(a_per_frame_arena, render_component_count);
+	draw_list.transforms.Init(a_per_frame_arena, render_component_count);
+	draw_list.occlusion_draws.Init(a_per_frame_arena, render_component_count);
+	StaticArray<RenderComponent*> dirty_materials{};
+	dirty_materials.Init(a_per_frame_arena, render_component_count);
+	StartMeshletCulling(pfd, draw_list, a_per_frame_arena);
+
+	// the archetype chunks store the matrices and render components contiguous, so this walks memory linearly.
+	a_archetypes.ForEach<WorldMatrixComponentPool, RenderComponentPool>([&](const ECSEntity a_entity, float4x4& a_transform, RenderComponent& a_comp)
+	{
+		AddDrawEntry(a_per_frame_arena, pfd, a_entity, a_comp, a_transform, draw_list, dirty_materials);
+	});
+	WriteDirtyMaterials(a_per_frame_arena, pfd, a_list, dirty_materials.const_slice());
+	stage_start = AddStageCPUTime("draw list", stage_start);
 
 	//if (m_raytrace_data.top_level.must_rebuild || !m_raytrace_data.top_level.accel_struct.IsValid())
-    if (false)
+	if (false)
 	{
-		StaticArray<AccelerationStructureInstanceInfo> instances{};
-		instances.Init(a_per_frame_arena, static_cast<uint32_t>(render_component_count), static_cast<uint32_t>(render_component_count));
-		for (size_t i = 0; i < render_component_count; i++)
+		// same query as the draw list, so the order matches the draw entries. Not every render entity has a raytrace component.
+		StaticArray<GPUAddress> acceleration_structs{};
+		acceleration_structs.Init(a_per_frame_arena, render_component_count);
+		a_archetypes.ForEach<WorldMatrixComponentPool, RenderComponentPool>([&](const ECSEntity a_entity, float4x4&, RenderComponent&)
+		{
+			const bool has_raytrace = a_archetypes.HasComponent<RaytraceComponentPool>(a_entity);
+			acceleration_structs.push_back(has_raytrace ? a_archetypes.GetComponent<RaytraceComponentPool>(a_entity).acceleration_struct_address : GPUAddress(0));
+		});
+
+		BuildDrawListTopLevel(a_per_frame_arena, a_list, draw_list, acceleration_structs.const_slice());
+	}
+
+	RenderDrawList(a_per_frame_arena, pfd, a_list, a_draw_area, draw_list, a_lights, stage_start);
+}
+
+void RenderSystem::PrepareDrawTransforms(const WorldMatrixComponentPool& a_world_matrices, const RenderComponentPool& a_render_pool)
+{
+	m_prepared_transforms.clear();
+	const ConstSlice<ECSEntity> render_entities = a_render_pool.GetEntityComponents();
+	const size_t prepare_count = Min(render_entities.size(), static_cast<size_t>(m_prepared_transforms.capacity()));
+	for (size_t i = 0; i < prepare_count; i++)
+		m_prepared_transforms.push_back(CalculateDrawTransform(render_entities[i], a_render_pool.GetComponent(render_entities[i]).bounding_box, a_world_matrices.GetComponent(render_entities[i])));
+}
+
+void RenderSystem::PrepareDrawTransforms(const ECSArchetypeMap& a_archetypes)
+{
+	m_prepared_transforms.clear();
+	a_archetypes.ForEach<WorldMatrixComponentPool, RenderComponentPool>([this](const ECSEntity a_entity, float4x4& a_transform, RenderComponent& a_comp)
+	{
+		if (m_prepared_transforms.size() < m_prepared_transforms.capacity())
+			m_prepared_transforms.push_back(CalculateDrawTransform(a_entity, a_comp.bounding_box, a_transform));
+	});
+}
+
+RenderSystem::DrawTransform RenderSystem::CalculateDrawTransform(const ECSEntity a_entity, const BoundingBox& a_box, const float4x4& a_transform)
+{
+	DrawTransform draw_transform;
+	draw_transform.entity = a_entity;
+	draw_transform.world_matrix = a_transform;
+	draw_transform.transform.transform = a_transform;
+	draw_transform.transform.inverse = Float4x4Inverse(a_transform);
+
+	// the gpu tests the world space box, so transform all 8 corners of the local box.
+	draw_transform.bounds_min = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	draw_transform.bounds_max = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		const float3 corner = float3(
+			(i & 1) ? a_box.max.x : a_box.min.x,
+			(i & 2) ? a_box.max.y : a_box.min.y,
+			(i & 4) ? a_box.max.z : a_box.min.z);
+		const float4 world = a_transform * float4(corner.x, corner.y, corner.z, 1.f);
+		draw_transform.bounds_min = Float3Min(draw_transform.bounds_min, float3(world.x, world.y, world.z));
+		draw_transform.bounds_max = Float3Max(draw_transform.bounds_max, float3(world.x, world.y, world.z));
+	}
+	return draw_transform;
+}
+
+void RenderSystem::BuildDrawListTopLevel(MemoryArena& a_per_frame_arena, const RCommandList a_list, const DrawList& a_draw_list, const ConstSlice<GPUAddress> a_acceleration_structs)
+{
+	const uint32_t instance_count = static_cast<uint32_t>(a_acceleration_structs.size());
+	StaticArray<AccelerationStructureInstanceInfo> instances{};
+	instances.Init(a_per_frame_arena, instance_count, instance_count);
+	for (uint32_t i = 0; i < instance_count; i++)
+	{
+		instances[i].transform = &a_draw_list.transforms[i].transform;
+		instances[i].shader_custom_index = 0;
+		instances[i].mask = 0xFF;
+		instances[i].shader_binding_table_offset = 0;
+		instances[i].acceleration_structure_address = a_acceleration_structs[i];
+	}
+
+	BuildTopLevelAccelerationStructure(a_per_frame_arena, a_list, instances.const_slice());
+}
+
+void RenderSystem::WriteDirtyMaterials(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const RCommandList a_list, const ConstSlice<RenderComponent*> a_dirty_materials)
+{
+	if (a_dirty_materials.size() == 0)
+		return;
+
+	// one upload allocation for all of them, the ring buffer only tracks RING_BUFFER_QUEUE_ELEMENT_COUNT allocations in flight.
+	const size_t upload_size = a_dirty_materials.size() * sizeof(MeshMetallic);
+	const uint64_t upload_offset = m_upload_allocator.AllocateUploadMemory(upload_size, a_pfd.fence_value);
+	BB_ASSERT(upload_offset != uint64_t(-1), "upload offset invalid");
+
+	MaterialWrite* material_writes = ArenaAllocArr(a_per_frame_arena, MaterialWrite, a_dirty_materials.size());
+	for (size_t i = 0; i < a_dirty_materials.size(); i++)
+	{
+		RenderComponent& comp = *a_dirty_materials[i];
+		material_writes[i].material = comp.material;
+		material_writes[i].src_offset = upload_offset + i * sizeof(MeshMetallic);
+		m_upload_allocator.MemcpyIntoBuffer(material_writes[i].src_offset, &comp.material_data, sizeof(comp.material_data));
+		comp.material_dirty = false;
+	}
+	Material::WriteMaterials(a_per_frame_arena, a_list, m_upload_allocator.GetBuffer(), ConstSlice<MaterialWrite>(material_writes, a_dirty_materials.size()));
+}
+
+void RenderSystem::AddDrawEntry(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const ECSEntity a_entity, RenderComponent& a_comp, const float4x4& a_transform, DrawList& a_draw_list, StaticArray<RenderComponent*>& a_dirty_materials)
+{
+	// dirty materials are copied together after all the draw entries are added.
+	if (a_comp.material_dirty)
+		a_dirty_materials.push_back(&a_comp);
+
+	DrawList::DrawEntry entry;
+	entry.mesh = a_comp.mesh;
+	entry.master_material = a_comp.master_material;
+	entry.material = a_comp.material;
+	entry.index_start = a_comp.index_start;
+	entry.index_count = a_comp.index_count;
+	entry.culled_first_index = static_cast<uint32_t>(a_comp.mesh.index_buffer_offset / sizeof(uint32_t)) + a_comp.index_start;
+	entry.culled_index_count = a_comp.index_count;
+	if (!m_options.skip_meshlet_culling && a_comp.meshlet_count)
+		CullDrawEntryMeshlets(a_per_frame_arena, a_pfd, ConstSlice<Meshlet>(a_comp.meshlets, a_comp.meshlet_count), a_transform, a_draw_list, entry);
+
+	m_meshlet_cull_stats.index_count += entry.index_count;
+	m_meshlet_cull_stats.drawn_index_count += entry.culled_index_count;
+
+	// the render transform system did these already, unless the entity or its matrix changed after it ran.
+	const size_t draw_index = a_draw_list.draw_entries.size();
+	const bool prepared = draw_index < m_prepared_transforms.size() &&
+		m_prepared_transforms[draw_index].entity == a_entity &&
+		memcmp(&m_prepared_transforms[draw_index].world_matrix, &a_transform, sizeof(a_transform)) == 0;
+	const DrawTransform draw_transform = prepared ? m_prepared_transforms[draw_index] : CalculateDrawTransform(a_entity, a_comp.bounding_box, a_transform);
+
+	ShaderOcclusionDraw occlusion_draw;
+	occlusion_draw.bounds_min = draw_transform.bounds_min;
+	occlusion_draw.bounds_max = draw_transform.bounds_max;
+	occlusion_draw.first_index = entry.culled_first_index;
+	occlusion_draw.index_count = entry.culled_index_count;
+
+	a_draw_list.draw_entries.push_back(entry);
+	a_draw_list.transforms.push_back(draw_transform.transform);
+	a_draw_list.occlusion_draws.push_back(occlusion_draw);
+}
+
+void RenderSystem::StartMeshletCulling(PerFrame& a_pfd, DrawList& a_draw_list, MemoryArena& a_per_frame_arena)
+{
+	a_draw_list.meshlet_index_copies.Init(a_per_frame_arena, MESHLET_INDEX_COPY_MAX);
+	a_pfd.meshlet_indices.used = 0;
+	a_pfd.meshlet_indices.cull_view = CreateMeshletCullView(m_scene_info.view, m_scene_info.proj, m_scene_info.view_pos);
+	m_meshlet_cull_stats = {};
+}
+
+void RenderSystem::CullDrawEntryMeshlets(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const ConstSlice<Meshlet> a_meshlets, const float4x4& a_transform, DrawList& a_draw_list, DrawList::DrawEntry& a_entry)
+{
+	MemoryArenaScope(a_per_frame_arena)
+	{
+		MeshletDrawRange* ranges = ArenaAllocArr(a_per_frame_arena, MeshletDrawRange, a_meshlets.size());
+		const uint32_t range_count = CullMeshlets(a_meshlets, a_transform, a_pfd.meshlet_indices.cull_view, ranges);
+		const uint32_t mesh_first_index = static_cast<uint32_t>(a_entry.mesh.index_buffer_offset / sizeof(uint32_t));
+
+		uint32_t visible_index_count = 0;
+		for (uint32_t i = 0; i < range_count; i++)
+			visible_index_count += ranges[i].index_count;
+
+		const uint32_t index_capacity = static_cast<uint32_t>(a_pfd.meshlet_indices.view.size / sizeof(uint32_t));
+		if (range_count == 0)
+		{
+			a_entry.culled_index_count = 0;
+		}
+		else if (range_count == 1)
+		{
+			// one range is already contiguous in the mesh, no need to copy it.
+			a_entry.culled_first_index = mesh_first_index + ranges[0].index_start;
+			a_entry.culled_index_count = ranges[0].index_count;
+		}
+		else if (a_pfd.meshlet_indices.used + visible_index_count <= index_capacity &&
+			a_draw_list.meshlet_index_copies.size() + range_count <= a_draw_list.meshlet_index_copies.capacity())
 		{
-			instances[i].transform = &draw_list.transforms[i].transform;
-			instances[i].shader_custom_index = 0;
-			instances[i].mask = 0xFF;
-			instances[i].shader_binding_table_offset = 0;
-			instances[i].acceleration_structure_address = a_raytrace_pool.GetComponent(render_entities[i]).acceleration_struct_address;
+			uint64_t dst_offset = a_pfd.meshlet_indices.view.offset + a_pfd.meshlet_indices.used * sizeof(uint32_t);
+			for (uint32_t i = 0; i < range_count; i++)
+			{
+				RenderCopyBufferRegion region;
+				region.size = ranges[i].index_count * sizeof(uint32_t);
+				region.src_offset = a_entry.mesh.index_buffer_offset + ranges[i].index_start * sizeof(uint32_t);
+				region.dst_offset = dst_offset;
+				a_draw_list.meshlet_index_copies.push_back(region);
+				dst_offset += region.size;
+			}
+
+			a_entry.culled_first_index = static_cast<uint32_t>(a_pfd.meshlet_indices.view.offset / sizeof(uint32_t)) + a_pfd.meshlet_indices.used;
+			a_entry.culled_index_count = visible_index_count;
+			a_pfd.meshlet_indices.used += visible_index_count;
 		}
+		// otherwise the compaction space is full and the primitive is drawn whole.
+	}
+}
 
-		BuildTopLevelAccelerationStructure(a_per_frame_arena, a_list, instances.const_slice());
+GPUAddress RenderSystem::UploadOcclusionDraws(PerFrame& a_pfd, const DrawList& a_draw_list)
+{
+	ShaderOcclusionCullHeader header;
+	header.view = m_scene_info.view;
+	header.proj = m_scene_info.proj;
+
+	// the cull shader loads float4's, the upload ring does not align so do it here.
+	const size_t draws_size = a_draw_list.occlusion_draws.size() * sizeof(ShaderOcclusionDraw);
+	const size_t upload_size = sizeof(header) + draws_size;
+	const uint64_t upload_offset = m_upload_allocator.AllocateUploadMemory(upload_size + 16, a_pfd.fence_value);
+	if (upload_offset == uint64_t(-1))
+	{
+		BB_WARNING(false, "not enough upload memory for occlusion culling, drawing without it", WarningType::MEDIUM);
+		return 0;
 	}
+	const uint64_t aligned_offset = RoundUp(upload_offset, 16);
+	m_upload_allocator.MemcpyIntoBuffer(aligned_offset, &header, sizeof(header));
+	m_upload_allocator.MemcpyIntoBuffer(aligned_offset + sizeof(header), a_draw_list.occlusion_draws.data(), draws_size);
+
+	return GetGPUBufferAddress(m_upload_allocator.GetBuffer()) + aligned_offset;
+}
+
+void RenderSystem::RenderDrawList(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const RCommandList a_list, const uint2 a_draw_area, const DrawList& a_draw_list, const ConstSlice<LightComponent> a_lights, double a_stage_start)
+{
+	// with dynamic resolution the scene renders into the top left of images the size of the draw area, the upscale pass stretches that over the render target.
+	// the images keep the size of the draw area so a scale change does not recreate them.
+	const bool upscale = m_options.dynamic_resolution;
+	const uint2 render_size = upscale ? m_dynamic_resolution.GetScaledResolution(a_draw_area) : a_draw_area;
+	m_render_size = render_size;
+
+	// the shadows are known before the upload, the lights point into them.
+	m_shadowmap_stage.PrepareShadows(a_per_frame_arena, a_lights, m_scene_info, a_draw_area, a_draw_list, m_changed_caster_bounds, m_all_casters_changed);
+	m_changed_caster_bounds = {};
+	m_all_casters_changed = false;
+	a_stage_start = AddStageCPUTime("shadow prepare", a_stage_start);
 
 	BindIndexBuffer(a_list, 0);
-	UpdateConstantBuffer(m_current_frame, a_list, a_draw_area, a_lights);
+	UpdateConstantBuffer(m_current_frame, a_list, render_size, a_lights);
 
     // sam please find a better way
     SetPrimitiveTopology(a_list, PRIMITIVE_TOPOLOGY::TRIANGLE_LIST);
-    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, draw_list.draw_entries[0].master_material);
+    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, a_draw_list.draw_entries[0].master_material);
     {
         const uint32_t buffer_indices[] = { 0, 0 };
         const DescriptorAllocation& global_desc_alloc = GetGlobalDescriptorAllocation();
-        const size_t buffer_offsets[]{ global_desc_alloc.offset, pfd.scene_descriptor.offset };
+        const size_t buffer_offsets[]{ global_desc_alloc.offset, a_pfd.scene_descriptor.offset };
         //set 1-2
         SetDescriptorBufferOffset(a_list,
             pipe_layout,
@@ -293,21 +576,171 @@ void RenderSystem::UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCom
             buffer_indices,
             buffer_offsets);
     }
-	
-    m_clear_stage.ExecutePass(a_list, a_draw_area, GetImageView(pfd.render_target_view));
 
-	ResourceUploadPass(pfd, a_list, draw_list, a_lights);
+	ResourceUploadPass(a_pfd, a_list, a_draw_list, a_lights);
+	a_stage_start = AddStageCPUTime("resource upload", a_stage_start);
+
+	// the graph only tracks images, the buffers the passes share still use global barriers.
+	m_render_graph.Begin(m_current_frame);
+	const RGResource render_target = m_render_graph.ImportImage("render target", m_render_target.image, IMAGE_LAYOUT::RT_COLOR, IMAGE_ASPECT::COLOR, static_cast<uint16_t>(m_current_frame));
+
+	ImageCreateInfo depth_info;
+	depth_info.name = "scene depth buffer";
+	depth_info.width = a_draw_area.x;
+	depth_info.height = a_draw_area.y;
+	depth_info.depth = 1;
+	depth_info.mip_levels = 1;
+	depth_info.array_layers = 1;
+	depth_info.format = IMAGE_FORMAT::D24_UNORM_S8_UINT;
+	depth_info.usage = IMAGE_USAGE::DEPTH;
+	depth_info.type = IMAGE_TYPE::TYPE_2D;
+	depth_info.use_optimal_tiling = true;
+	depth_info.is_cube_map = false;
+	const RGResource depth = m_render_graph.CreateImage(depth_info);
+
+	ImageCreateInfo bloom_info;
+	bloom_info.name = "bloom bright image";
+	bloom_info.width = a_draw_area.x;
+	bloom_info.height = a_draw_area.y;
+	bloom_info.depth = 1;
+	bloom_info.mip_levels = 1;
+	bloom_info.array_layers = 1;
+	bloom_info.format = m_render_target.format;
+	bloom_info.usage = IMAGE_USAGE::RENDER_TARGET;
+	bloom_info.type = IMAGE_TYPE::TYPE_2D;
+	bloom_info.use_optimal_tiling = true;
+	bloom_info.is_cube_map = false;
+	const RGResource bloom_bright = m_render_graph.CreateImage(bloom_info);
+
+	RGResource scene_color = render_target;
+	if (upscale)
+	{
+		ImageCreateInfo scene_color_info = bloom_info;
+		scene_color_info.name = "scene color image";
+		scene_color = m_render_graph.CreateImage(scene_color_info);
+	}
+
+	const RGPass clear_pass = m_render_graph.AddPass("clear");
+	m_render_graph.Overwrite(clear_pass, scene_color, IMAGE_LAYOUT::RT_COLOR);
+
+	// the shadow atlas lives across frames and handles its own barriers.
+	const RGPass shadow_map_pass = m_render_graph.AddPass("shadow map", true);
+
+	const GPUAddress occlusion_draws = m_options.skip_occlusion_culling || !m_raster_mesh_stage.CanOcclusionCull(a_draw_list) ? 0 : UploadOcclusionDraws(a_pfd, a_draw_list);
+	RGPass raster_pass;
+	RGPass early_cull_pass;
+	RGPass early_raster_pass;
+	RGPass hiz_build_pass;
+	RGPass late_cull_pass;
+	RGPass late_raster_pass;
+	if (occlusion_draws == 0)
+	{
+		raster_pass = m_render_graph.AddPass("raster meshes");
+		m_render_graph.Overwrite(raster_pass, depth, IMAGE_LAYOUT::RT_DEPTH);
+		m_render_graph.Write(raster_pass, scene_color, IMAGE_LAYOUT::RT_COLOR);
+		m_render_graph.Overwrite(raster_pass, bloom_bright, IMAGE_LAYOUT::RT_COLOR);
+	}
+	else
+	{
+		// the cull passes and the hi-z build write buffers that the next frame reads, so they always run.
+		early_cull_pass = m_render_graph.AddPass("early occlusion cull", true);
+		early_raster_pass = m_render_graph.AddPass("early raster meshes");
+		m_render_graph.Overwrite(early_raster_pass, depth, IMAGE_LAYOUT::RT_DEPTH);
+		m_render_graph.Write(early_raster_pass, scene_color, IMAGE_LAYOUT::RT_COLOR);
+		m_render_graph.Overwrite(early_raster_pass, bloom_bright, IMAGE_LAYOUT::RT_COLOR);
+
+		hiz_build_pass = m_render_graph.AddPass("hi-z build", true);
+		m_render_graph.Read(hiz_build_pass, depth, IMAGE_LAYOUT::RO_COMPUTE);
+
+		late_cull_pass = m_render_graph.AddPass("late occlusion cull", true);
+		late_raster_pass = m_render_graph.AddPass("late raster meshes");
+		m_render_graph.Write(late_raster_pass, depth, IMAGE_LAYOUT::RT_DEPTH);
+		m_render_graph.Write(late_raster_pass, scene_color, IMAGE_LAYOUT::RT_COLOR);
+		m_render_graph.Write(late_raster_pass, bloom_bright, IMAGE_LAYOUT::RT_COLOR);
+	}
+
+	const RGPass line_pass = m_render_graph.AddPass("debug lines");
+	m_render_graph.Read(line_pass, depth, IMAGE_LAYOUT::RT_DEPTH);
+	m_render_graph.Write(line_pass, scene_color, IMAGE_LAYOUT::RT_COLOR);
+
+	// the prefilter writes the first level of the chain that the compute queue finishes after this frame.
+	// the composite uses the chain of the frame before, so the bloom is a frame behind.
+	RGPass bloom_prefilter_pass;
+	RGPass bloom_composite_pass;
+	m_bloom_stage.BeginFrame(m_current_frame, render_size);
+	if (!m_options.skip_bloom)
+	{
+		bloom_prefilter_pass = m_render_graph.AddPass("bloom prefilter", true);
+		m_render_graph.Read(bloom_prefilter_pass, bloom_bright, IMAGE_LAYOUT::RO_COMPUTE);
+
+		if (m_bloom_stage.CanComposite(m_current_frame))
+		{
+			bloom_composite_pass = m_render_graph.AddPass("bloom composite");
+			m_render_graph.Write(bloom_composite_pass, scene_color, IMAGE_LAYOUT::RT_COLOR);
+		}
+	}
+
+	RGPass upscale_pass;
+	if (upscale)
+	{
+		upscale_pass = m_render_graph.AddPass("upscale");
+		m_render_graph.Read(upscale_pass, scene_color, IMAGE_LAYOUT::RO_FRAGMENT);
+		m_render_graph.Overwrite(upscale_pass, render_target, IMAGE_LAYOUT::RT_COLOR);
+	}
 
-    m_shadowmap_stage.ExecutePass(a_list, m_current_frame, uint2(DEPTH_IMAGE_SIZE_W_H, DEPTH_IMAGE_SIZE_W_H), draw_list, a_lights);
-    m_raster_mesh_stage.ExecutePass(a_list, m_current_frame, a_draw_area, draw_list, GetImageView(pfd.render_target_view), GetImageView(pfd.bloom.descriptor_index_0));
-    if (!m_options.skip_bloom)
-	    m_bloom_stage.ExecutePass(a_list, pfd.bloom.resolution, pfd.bloom.image, pfd.bloom.descriptor_index_0, pfd.bloom.descriptor_index_1, a_draw_area, GetImageView(pfd.render_target_view));
+	const RenderGraphPlan& plan = m_render_graph.Compile(a_per_frame_arena);
+	m_raster_mesh_stage.BeginFrame(m_current_frame, render_size);
+	a_stage_start = AddStageCPUTime("render graph compile", a_stage_start);
+
+	const RImageView render_target_view = GetImageView(a_pfd.render_target_view);
+	const RImageView scene_color_view = upscale ? m_render_graph.GetImageView(scene_color) : render_target_view;
+	for (size_t i = 0; i < plan.passes.size(); i++)
+	{
+		const RGPass pass = plan.passes[i].pass;
+		m_render_graph.BarrierPass(a_list, plan.passes[i]);
+
+		if (pass == clear_pass)
+			m_clear_stage.ExecutePass(a_list, render_size, scene_color_view);
+		else if (pass == shadow_map_pass)
+			m_shadowmap_stage.ExecutePass(a_list, a_draw_list);
+		else if (pass == raster_pass)
+			m_raster_mesh_stage.DrawPass(a_list, m_current_frame, render_size, a_draw_list, scene_color_view, m_render_graph.GetImageView(bloom_bright), m_render_graph.GetImageView(depth));
+		else if (pass == early_cull_pass)
+			m_raster_mesh_stage.CullPass(a_list, m_current_frame, a_draw_list, occlusion_draws, RasterMeshStage::OCCLUSION_PASS::EARLY);
+		else if (pass == early_raster_pass)
+			m_raster_mesh_stage.OcclusionDrawPass(a_list, render_size, a_draw_list, scene_color_view, m_render_graph.GetImageView(bloom_bright), m_render_graph.GetImageView(depth), RasterMeshStage::OCCLUSION_PASS::EARLY);
+		else if (pass == hiz_build_pass)
+			m_raster_mesh_stage.BuildHiZPass(a_list, m_current_frame, m_render_graph.GetImageDescriptor(depth));
+		else if (pass == late_cull_pass)
+			m_raster_mesh_stage.CullPass(a_list, m_current_frame, a_draw_list, occlusion_draws, RasterMeshStage::OCCLUSION_PASS::LATE);
+		else if (pass == late_raster_pass)
+			m_raster_mesh_stage.OcclusionDrawPass(a_list, render_size, a_draw_list, scene_color_view, m_render_graph.GetImageView(bloom_bright), m_render_graph.GetImageView(depth), RasterMeshStage::OCCLUSION_PASS::LATE);
+		else if (pass == line_pass)
+			m_line_stage.ExecutePass(a_list, m_current_frame, render_size, scene_color_view, m_render_graph.GetImageView(depth));
+		else if (pass == bloom_prefilter_pass)
+			m_bloom_stage.PrefilterPass(a_list, m_current_frame, m_render_graph.GetImageDescriptor(bloom_bright));
+		else if (pass == bloom_composite_pass)
+			m_bloom_stage.CompositePass(a_list, m_current_frame, render_size, scene_color_view);
+		else if (pass == upscale_pass)
+			m_upscale_stage.ExecutePass(a_list, m_render_graph.GetImageDescriptor(scene_color), a_draw_area, render_size, a_draw_area, render_target_view);
+
+		a_stage_start = AddStageCPUTime(m_render_graph.GetPassName(pass), a_stage_start);
+	}
+}
+
+double RenderSystem::AddStageCPUTime(const char* a_name, const double a_stage_start)
+{
+	const double stage_end = GetTimeInMiliseconds();
+	if (m_stage_cpu_times.size() < m_stage_cpu_times.capacity())
+		m_stage_cpu_times.push_back(RenderStageCPUTime{ a_name, static_cast<float>(stage_end - a_stage_start) });
+	return stage_end;
 }
 
 void RenderSystem::DebugDraw(const RCommandList a_list, const uint2 a_draw_area)
 {
+    // lines are drawn inside the render graph, this only draws the ones added after it ran.
     PerFrame& pfd = m_per_frame[m_current_frame];
-    m_line_stage.ExecutePass(a_list, m_current_frame, a_draw_area, GetImageView(pfd.render_target_view), m_raster_mesh_stage.GetDepth(m_current_frame));
+    m_line_stage.ExecutePass(a_list, m_current_frame, a_draw_area, GetImageView(pfd.render_target_view), RImageView());
 }
 
 void RenderSystem::Resize(const uint2 a_new_extent, const bool a_force)
@@ -358,6 +791,12 @@ void RenderSystem::SetView(const float4x4& a_view, const float3& a_view_position
 	m_scene_info.view_pos = float3(a_view_position.x, a_view_position.y, a_view_position.z);
 }
 
+void RenderSystem::SetChangedCasterBounds(const ConstSlice<BoundingBox> a_bounds, const bool a_all_changed)
+{
+	m_changed_caster_bounds = a_bounds;
+	m_all_casters_changed = m_all_casters_changed || a_all_changed;
+}
+
 void RenderSystem::SetProjection(const float4x4& a_projection, const float a_near_plane)
 {
 	m_scene_info.proj = a_projection;
@@ -389,85 +828,10 @@ void RenderSystem::BuildTopLevelAccelerationStructure(MemoryArena& a_per_frame_a
 
 void RenderSystem::UpdateConstantBuffer(const uint32_t a_frame_index, const RCommandList a_list, const uint2 a_draw_area_size, const ConstSlice<LightComponent> a_lights)
 {
-    // temp jank
-    PerFrame& a_pfd = m_per_frame[a_frame_index];
     m_clear_stage.UpdateConstantBuffer(m_scene_info);
-    m_shadowmap_stage.UpdateConstantBuffer(a_frame_index, m_scene_info);
+    m_shadowmap_stage.UpdateConstantBuffer(m_scene_info);
 	m_scene_info.light_count = static_cast<uint32_t>(a_lights.size());
 	m_scene_info.scene_resolution = a_draw_area_size;
-
-	if (a_pfd.previous_draw_area != a_draw_area_size)
-	{
-		if (a_pfd.bloom.image.IsValid())
-		{
-			FreeImage(a_pfd.bloom.image);
-			FreeImageView(a_pfd.bloom.descriptor_index_0);
-			FreeImageView(a_pfd.bloom.descriptor_index_1);
-		}
-
-		{
-			const float2 downscaled_bloom_image = {
-				static_cast<float>(a_draw_area_size.x) * BLOOM_IMAGE_DOWNSCALE_FACTOR,
-				static_cast<float>(a_draw_area_size.y) * BLOOM_IMAGE_DOWNSCALE_FACTOR
-			};
-
-			a_pfd.bloom.resolution = uint2(static_cast<uint32_t>(downscaled_bloom_image.x), static_cast<uint32_t>(downscaled_bloom_image.y));
-
-			ImageCreateInfo bloom_img_info;
-			bloom_img_info.name = "bloom image";
-			bloom_img_info.width = a_pfd.bloom.resolution.x;
-			bloom_img_info.height = a_pfd.bloom.resolution.y;
-			bloom_img_info.depth = 1;
-			bloom_img_info.mip_levels = 1;
-			bloom_img_info.array_layers = 2;			// 0 == bloom image, 1 = bloom vertical blur
-			bloom_img_info.format = m_render_target.format;
-			bloom_img_info.usage = IMAGE_USAGE::RENDER_TARGET;
-			bloom_img_info.type = IMAGE_TYPE::TYPE_2D;
-			bloom_img_info.use_optimal_tiling = true;
-			bloom_img_info.is_cube_map = false;
-			a_pfd.bloom.image = CreateImage(bloom_img_info);
-
-			ImageViewCreateInfo bloom_img_view_info;
-			bloom_img_view_info.name = "bloom image view";
-			bloom_img_view_info.image = a_pfd.bloom.image;
-			bloom_img_view_info.type = IMAGE_VIEW_TYPE::TYPE_2D;
-			bloom_img_view_info.base_array_layer = 0;
-			bloom_img_view_info.array_layers = 1;
-			bloom_img_view_info.mip_levels = 1;
-			bloom_img_view_info.base_mip_level = 0;
-			bloom_img_view_info.format = m_render_target.format;
-			bloom_img_view_info.aspects = IMAGE_ASPECT::COLOR;
-			a_pfd.bloom.descriptor_index_0 = CreateImageView(bloom_img_view_info);
-
-			bloom_img_view_info.base_array_layer = 1;
-			a_pfd.bloom.descriptor_index_1 = CreateImageView(bloom_img_view_info);
-
-			FixedArray<PipelineBarrierImageInfo, 2> bloom_initial_stages;
-			bloom_initial_stages[0].prev = IMAGE_LAYOUT::NONE;
-			bloom_initial_stages[0].next = IMAGE_LAYOUT::RT_COLOR;
-			bloom_initial_stages[0].image = a_pfd.bloom.image;
-			bloom_initial_stages[0].layer_count = 1;
-			bloom_initial_stages[0].level_count = 1;
-			bloom_initial_stages[0].base_array_layer = 0;
-			bloom_initial_stages[0].base_mip_level = 0;
-			bloom_initial_stages[0].image_aspect = IMAGE_ASPECT::COLOR;
-
-			bloom_initial_stages[1].prev = IMAGE_LAYOUT::NONE;
-			bloom_initial_stages[1].next = IMAGE_LAYOUT::RO_FRAGMENT;
-			bloom_initial_stages[1].image = a_pfd.bloom.image;
-			bloom_initial_stages[1].layer_count = 1;
-			bloom_initial_stages[1].level_count = 1;
-			bloom_initial_stages[1].base_array_layer = 1;
-			bloom_initial_stages[1].base_mip_level = 0;
-			bloom_initial_stages[1].image_aspect = IMAGE_ASPECT::COLOR;
-
-			PipelineBarrierInfo barriers{};
-			barriers.image_barriers = bloom_initial_stages.const_slice();
-			PipelineBarriers(a_list, barriers);
-		}
-
-		a_pfd.previous_draw_area = a_draw_area_size;
-	}
 }
 
 void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list, const DrawList& a_draw_list, const ConstSlice<LightComponent> a_lights)
@@ -481,7 +845,8 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 
 	const size_t matrices_upload_size = a_draw_list.draw_entries.size() * sizeof(ShaderTransform);
 	const size_t light_upload_size = a_lights.size() * sizeof(Light);
-	const size_t light_projection_view_size = a_lights.size() * sizeof(float4x4);
+	const ConstSlice<ShaderShadow> shadows = m_shadowmap_stage.GetShadows();
+	const size_t shadow_upload_size = shadows.size() * sizeof(ShaderShadow);
 
 	auto memcpy_and_advance = [](const GPUUploadRingAllocator& a_buffer, const size_t a_dst_offset, const void* a_src_data, const size_t a_src_size)
 		{
@@ -491,7 +856,7 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 		};
 
 	// optimize this
-	const size_t total_size = matrices_upload_size + light_upload_size + light_projection_view_size;
+	const size_t total_size = matrices_upload_size + light_upload_size + shadow_upload_size;
 
 	uint64_t upload_offset = m_upload_allocator.AllocateUploadMemory(total_size, a_pfd.fence_value);
 	BB_ASSERT(upload_offset != uint64_t(-1), "upload offset invalid");
@@ -501,11 +866,14 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 
 	const uint64_t light_offset = upload_offset;
 	for (uint32_t i = 0; i < a_lights.size(); i++)
-		upload_offset = memcpy_and_advance(m_upload_allocator, upload_offset, &a_lights[i].light, sizeof(Light));
+	{
+		Light light = a_lights[i].light;
+		m_shadowmap_stage.GetLightShadows(i, light.shadow_index, light.shadow_count);
+		upload_offset = memcpy_and_advance(m_upload_allocator, upload_offset, &light, sizeof(Light));
+	}
 
-	const uint64_t light_projection_view_offset = upload_offset;
-	for (uint32_t i = 0; i < a_lights.size(); i++)
-		upload_offset = memcpy_and_advance(m_upload_allocator, upload_offset, &a_lights[i].projection_view, sizeof(float4x4));
+	const uint64_t shadow_offset = upload_offset;
+	upload_offset = memcpy_and_advance(m_upload_allocator, upload_offset, shadows.data(), shadow_upload_size);
 
 	GPUBufferView transform_view;
 	bool success = cur_scene_buffer.Allocate(matrices_upload_size, transform_view);
@@ -513,8 +881,8 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 	GPUBufferView light_view;
 	success = cur_scene_buffer.Allocate(light_upload_size, light_view);
 	BB_ASSERT(success, "failed to allocate frame memory");
-	GPUBufferView light_projection_view;
-	success = cur_scene_buffer.Allocate(light_projection_view_size, light_projection_view);
+	GPUBufferView shadow_view;
+	success = cur_scene_buffer.Allocate(shadow_upload_size, shadow_view);
 	BB_ASSERT(success, "failed to allocate frame memory");
 
 	//upload to some GPU buffer here.
@@ -522,7 +890,7 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 	matrix_buffer_copy.src = m_upload_allocator.GetBuffer();
 	matrix_buffer_copy.dst = cur_scene_buffer.GetBuffer();
 	size_t copy_region_count = 0;
-	FixedArray<RenderCopyBufferRegion, 3> buffer_regions; //0 = matrix, 1 = lights, 2 = light projection view
+	FixedArray<RenderCopyBufferRegion, 3> buffer_regions; //0 = matrix, 1 = lights, 2 = shadows
 	if (matrices_upload_size)
 	{
 		buffer_regions[copy_region_count].src_offset = matrix_offset;
@@ -537,10 +905,13 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 		buffer_regions[copy_region_count].dst_offset = light_view.offset;
 		buffer_regions[copy_region_count].size = light_upload_size;
 		++copy_region_count;
+	}
 
-		buffer_regions[copy_region_count].src_offset = light_projection_view_offset;
-		buffer_regions[copy_region_count].dst_offset = light_projection_view.offset;
-		buffer_regions[copy_region_count].size = light_projection_view_size;
+	if (shadow_upload_size)
+	{
+		buffer_regions[copy_region_count].src_offset = shadow_offset;
+		buffer_regions[copy_region_count].dst_offset = shadow_view.offset;
+		buffer_regions[copy_region_count].size = shadow_upload_size;
 		++copy_region_count;
 	}
 
@@ -566,12 +937,25 @@ void RenderSystem::ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list
 			desc_write.binding = PER_SCENE_LIGHT_DATA_BINDING;
 			desc_write.buffer_view = light_view;
 			DescriptorWriteStorageBuffer(desc_write);
-
-			desc_write.binding = PER_SCENE_LIGHT_PROJECTION_VIEW_DATA_BINDING;
-			desc_write.buffer_view = light_projection_view;
+		}
+		if (shadow_upload_size)
+		{
+			desc_write.binding = PER_SCENE_SHADOW_DATA_BINDING;
+			desc_write.buffer_view = shadow_view;
 			DescriptorWriteStorageBuffer(desc_write);
 		}
 	}
+
+	if (a_draw_list.meshlet_index_copies.size())
+	{
+		CopyToIndexBuffer(a_list, a_pfd.meshlet_indices.view.buffer, a_draw_list.meshlet_index_copies.slice());
+
+		// the copied indices are read by the draws after this.
+		const PipelineBarrierGlobalInfo global_barrier{};
+		PipelineBarrierInfo pipeline_info{};
+		pipeline_info.global_barriers = ConstSlice<PipelineBarrierGlobalInfo>(&global_barrier, 1);
+		PipelineBarriers(a_list, pipeline_info);
+	}
 }
 
 void RenderSystem::CreateRenderTarget(const uint2 a_render_target_size)
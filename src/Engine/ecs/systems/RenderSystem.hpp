@@ -1,14 +1,19 @@
 #pragma once
 #include "GPUBuffers.hpp"
+#include "OffsetAllocator.hpp"
 #include "Rendererfwd.hpp"
 #include "ecs/components/RenderComponent.hpp"
 #include "ecs/components/RaytraceComponent.hpp"
+#include "ecs/ArchetypeMap.hpp"
 
 #include "ClearStage.hpp"
 #include "ShadowMapStage.hpp"
 #include "RasterMeshStage.hpp"
 #include "BloomStage.hpp"
 #include "LineStage.hpp"
+#include "UpscaleStage.hpp"
+#include "FrameRenderGraph.hpp"
+#include "DynamicResolution.hpp"
 
 namespace BB
 {
@@ -17,6 +22,15 @@ namespace BB
 		RDescriptorIndex render_target;
 		RFence fence;
 		uint64_t fence_value;
+		// the graphics work of the frame waits on this before it shades, an invalid fence means there is nothing to wait on.
+		RFence wait_fence;
+		uint64_t wait_value;
+	};
+
+	struct RenderStageCPUTime
+	{
+		const char* name;
+		float milliseconds;
 	};
 
 	class RenderSystem
@@ -25,11 +39,16 @@ namespace BB
         friend class Editor;
         // temporary
         friend class EntityComponentSystem;
-		void Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count, const uint32_t a_max_lights, const uint2 a_render_target_size);
+		void Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count, const uint32_t a_max_lights, const uint32_t a_render_entity_max, const uint2 a_render_target_size);
 
 		void StartFrame(const RCommandList a_list);
 		RenderSystemFrame EndFrame(const RCommandList a_list, const IMAGE_LAYOUT a_current_layout);
 		void UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCommandList a_list, const uint2 a_draw_area, const WorldMatrixComponentPool& a_world_matrices, const RenderComponentPool& a_render_pool, const RaytraceComponentPool& a_raytrace_pool, const ConstSlice<LightComponent> a_lights);
+		void UpdateRenderSystem(MemoryArena& a_per_frame_arena, const RCommandList a_list, const uint2 a_draw_area, const ECSArchetypeMap& a_archetypes, const ConstSlice<LightComponent> a_lights);
+		// calculates the draw transforms and world bounds of every render component, in the order UpdateRenderSystem walks them.
+		// run by the render transform system, entries that changed after it ran are calculated again when the draw list is made.
+		void PrepareDrawTransforms(const WorldMatrixComponentPool& a_world_matrices, const RenderComponentPool& a_render_pool);
+		void PrepareDrawTransforms(const ECSArchetypeMap& a_archetypes);
         void DebugDraw(const RCommandList a_list, const uint2 a_draw_area);
 
 		void Resize(const uint2 a_new_extent, const bool a_force = false);
@@ -58,6 +77,24 @@ namespace BB
 			return m_options.skip_bloom = !m_options.skip_bloom;
 		}
 
+		bool ToggleSkipMeshletCulling()
+		{
+			return m_options.skip_meshlet_culling = !m_options.skip_meshlet_culling;
+		}
+
+		bool ToggleSkipOcclusionCulling()
+		{
+			return m_options.skip_occlusion_culling = !m_options.skip_occlusion_culling;
+		}
+
+		bool ToggleDynamicResolution()
+		{
+			m_options.dynamic_resolution = !m_options.dynamic_resolution;
+			if (!m_options.dynamic_resolution)
+				m_dynamic_resolution.Reset(1.f);
+			return m_options.dynamic_resolution;
+		}
+
 		uint2 GetRenderTargetExtent() const
 		{
 			return m_render_target.extent;
@@ -66,6 +103,13 @@ namespace BB
 		void SetView(const float4x4& a_view, const float3& a_view_position);
 		void SetProjection(const float4x4& a_projection, const float a_near_plane);
 
+        // world bounds of the casters that moved since the last frame, before and after the move, the next UpdateRenderSystem uses them.
+        // a_all_changed invalidates every cached shadow, for when there were too many moves to track.
+        void SetChangedCasterBounds(const ConstSlice<BoundingBox> a_bounds, const bool a_all_changed);
+
+        // the cpu time of every stage of the last UpdateRenderSystem, the render graph passes use their pass name.
+        ConstSlice<RenderStageCPUTime> GetStageCPUTimes() const { return m_stage_cpu_times.const_slice(); }
+
         float4x4 GetProjection() const {return m_scene_info.proj; }
         float4x4 GetView() const {return m_scene_info.view; }
 
@@ -74,8 +118,9 @@ namespace BB
 		{
 			RDescriptorIndex render_target_view;
 
-			uint2 previous_draw_area;
 			GPUFenceValue fence_value;
+			// the start and end timestamps of this frame are in the pool, read them once the fence is done.
+			bool timestamps_written;
 			DescriptorAllocation scene_descriptor;
 
 			// scene data
@@ -83,13 +128,14 @@ namespace BB
 			// I want this to be uniform but hlsl is giga cringe
 			GPULinearBuffer storage_buffer;
 
-			struct Bloom
+			// the visible meshlet indices of this frame are copied here.
+			struct MeshletIndices
 			{
-				RImage image;
-				RDescriptorIndex descriptor_index_0;
-				RDescriptorIndex descriptor_index_1;
-				uint2 resolution;
-			} bloom;
+				GPUBufferView view;
+				OffsetAllocation allocation;
+				uint32_t used;
+				MeshletCullView cull_view;
+			} meshlet_indices;
 		};
 
         struct RaytraceData
@@ -126,8 +172,18 @@ namespace BB
 		void UpdateConstantBuffer(const uint32_t a_frame_index, const RCommandList a_list, const uint2 a_draw_area_size, const ConstSlice<LightComponent> a_lights);
 		void BuildTopLevelAccelerationStructure(MemoryArena& a_per_frame_arena, const RCommandList a_list, const ConstSlice<AccelerationStructureInstanceInfo> a_instances);
 		void ResourceUploadPass(PerFrame& a_pfd, const RCommandList a_list, const DrawList& a_draw_list, const ConstSlice<LightComponent> a_lights);
+		void AddDrawEntry(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const ECSEntity a_entity, RenderComponent& a_comp, const float4x4& a_transform, DrawList& a_draw_list, StaticArray<RenderComponent*>& a_dirty_materials);
+		// instance i uses the transform of draw entry i.
+		void BuildDrawListTopLevel(MemoryArena& a_per_frame_arena, const RCommandList a_list, const DrawList& a_draw_list, const ConstSlice<GPUAddress> a_acceleration_structs);
+		void WriteDirtyMaterials(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const RCommandList a_list, const ConstSlice<RenderComponent*> a_dirty_materials);
+		void StartMeshletCulling(PerFrame& a_pfd, DrawList& a_draw_list, MemoryArena& a_per_frame_arena);
+		void CullDrawEntryMeshlets(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const ConstSlice<Meshlet> a_meshlets, const float4x4& a_transform, DrawList& a_draw_list, DrawList::DrawEntry& a_entry);
+		GPUAddress UploadOcclusionDraws(PerFrame& a_pfd, const DrawList& a_draw_list);
+		void RenderDrawList(MemoryArena& a_per_frame_arena, PerFrame& a_pfd, const RCommandList a_list, const uint2 a_draw_area, const DrawList& a_draw_list, const ConstSlice<LightComponent> a_lights, double a_stage_start);
 
 		void CreateRenderTarget(const uint2 a_render_target_size);
+		// returns the end of the stage, which is the start of the next one.
+		double AddStageCPUTime(const char* a_name, const double a_stage_start);
 
 		uint32_t m_current_frame;
 		StaticArray<PerFrame> m_per_frame;
@@ -139,15 +195,40 @@ namespace BB
 			bool skip_shadow_mapping;
 			bool skip_object_rendering;
 			bool skip_bloom;
+			bool skip_meshlet_culling;
+			bool skip_occlusion_culling;
+			bool dynamic_resolution;
 		} m_options;
 
+		struct MeshletCullStats
+		{
+			uint32_t index_count;
+			uint32_t drawn_index_count;
+		} m_meshlet_cull_stats;
+
+		StaticArray<RenderStageCPUTime> m_stage_cpu_times;
+
+		ConstSlice<BoundingBox> m_changed_caster_bounds;
+		bool m_all_casters_changed;
+
+		struct DrawTransform
+		{
+			ECSEntity entity;
+			float4x4 world_matrix;
+			ShaderTransform transform;
+			float3 bounds_min;
+			float3 bounds_max;
+		};
+		static DrawTransform CalculateDrawTransform(const ECSEntity a_entity, const BoundingBox& a_box, const float4x4& a_transform);
+		StaticArray<DrawTransform> m_prepared_transforms;
+
 		Scene3DInfo m_scene_info;
 		struct GlobalBuffer
 		{
 			GPULinearBuffer buffer;
 			uint32_t light_max;
 			GPUBufferView light_view;
-			GPUBufferView light_viewproj_view;
+			GPUBufferView shadow_view;
 		} m_global_buffer;
 
 		RFence m_fence;
@@ -155,10 +236,19 @@ namespace BB
 		uint64_t m_last_completed_fence_value;
 		GPUUploadRingAllocator m_upload_allocator;
 
+		// 2 timestamps per frame, the start and the end.
+		RTimestampPool m_timestamp_pool;
+		double m_previous_frame_start;
+		DynamicResolution m_dynamic_resolution;
+		// the part of the draw area the scene rendered at in the last frame.
+		uint2 m_render_size;
+
         ClearStage m_clear_stage;
         ShadowMapStage m_shadowmap_stage;
         RasterMeshStage m_raster_mesh_stage;
         BloomStage m_bloom_stage;
 		LineStage m_line_stage;
+		UpscaleStage m_upscale_stage;
+		FrameRenderGraph m_render_graph;
 	};
 }
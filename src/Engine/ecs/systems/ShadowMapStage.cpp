@@ -1,18 +1,139 @@
 #include "ShadowMapStage.hpp"
 #include "Renderer.hpp"
 #include "MaterialSystem.hpp"
+#include "Math/Math.inl"
+
+#include <bit>
+#include <cfloat>
 
 using namespace BB;
 
-constexpr uint32_t INITIAL_DEPTH_ARRAY_COUNT = 8;
+// directional lights have no shadow further from the camera then this.
+constexpr float SHADOW_CASCADE_MAX_DISTANCE = 64.f;
+// blends the cascade splits between uniform and logarithmic, higher gives the near cascades more of the resolution.
+constexpr float SHADOW_CASCADE_SPLIT_LAMBDA = 0.75f;
+// how far behind a cascade a caster can be and still throw a shadow into it.
+constexpr float SHADOW_CASCADE_MAX_CASTER_DISTANCE = 128.f;
+// a light ends where its attenuation falls below 1 / this, used to size the tiles.
+constexpr float SHADOW_LIGHT_ATTENUATION_CUTOFF = 64.f;
+
+static float LightRange(const Light& a_light)
+{
+    const float c = a_light.radius_constant - SHADOW_LIGHT_ATTENUATION_CUTOFF;
+    if (c >= 0.f)
+        return 0.f;
+    if (a_light.radius_quadratic > 0.f)
+        return (-a_light.radius_linear + sqrtf(a_light.radius_linear * a_light.radius_linear - 4.f * a_light.radius_quadratic * c)) / (2.f * a_light.radius_quadratic);
+    if (a_light.radius_linear > 0.f)
+        return -c / a_light.radius_linear;
+    return FLT_MAX;
+}
+
+// the tile size is the size of the light range on screen in pixels.
+static uint32_t ShadowTileSize(const Light& a_light, const Scene3DInfo& a_scene_info, const uint2 a_draw_area, const uint32_t a_current_size)
+{
+    const float range = LightRange(a_light);
+    const float distance = FloatDistance(float3(a_light.pos.x, a_light.pos.y, a_light.pos.z), a_scene_info.view_pos) - range;
+    float screen_size = static_cast<float>(SHADOW_TILE_MAX_SIZE);
+    if (distance > a_scene_info.near_plane)
+        screen_size = range / distance * fabsf(a_scene_info.proj.e[1][1]) * static_cast<float>(a_draw_area.y);
+
+    // a light between 2 sizes would otherwise change tile, and so render, every frame.
+    if (a_current_size != 0 && screen_size > static_cast<float>(a_current_size) * 0.375f && screen_size <= static_cast<float>(a_current_size) * 1.25f)
+        return a_current_size;
+
+    const float clamped_size = Min(Max(screen_size, static_cast<float>(SHADOW_TILE_MIN_SIZE)), static_cast<float>(SHADOW_TILE_MAX_SIZE));
+    return std::bit_ceil(static_cast<uint32_t>(clamped_size));
+}
+
+static float CameraFarPlane(const Scene3DInfo& a_scene_info)
+{
+    // Float4x4Perspective stores -(f + n) / (f - n) and -2fn / (f - n), together they give f.
+    const float far_plane = a_scene_info.proj.e[2][3] / (a_scene_info.proj.e[2][2] + 1.f);
+    if (!(far_plane > a_scene_info.near_plane))
+        return SHADOW_CASCADE_MAX_DISTANCE;
+    return far_plane;
+}
+
+static float4x4 CascadeProjectionView(const float3 a_light_dir, const Scene3DInfo& a_scene_info, const float a_split_near, const float a_split_far, const uint32_t a_tile_size, const BoundingBox& a_caster_bounds)
+{
+    // a sphere around the slice of the camera frustum, unlike a box it does not change size when the camera rotates.
+    const float tan_x = 1.f / fabsf(a_scene_info.proj.e[0][0]);
+    const float tan_y = 1.f / fabsf(a_scene_info.proj.e[1][1]);
+    const float corner_slope_sq = tan_x * tan_x + tan_y * tan_y;
+    const float center_distance = Min((a_split_near + a_split_far) * (1.f + corner_slope_sq) * 0.5f, a_split_far);
+    const float near_corner = sqrtf((center_distance - a_split_near) * (center_distance - a_split_near) + a_split_near * a_split_near * corner_slope_sq);
+    const float far_corner = sqrtf((a_split_far - center_distance) * (a_split_far - center_distance) + a_split_far * a_split_far * corner_slope_sq);
+    // rounded so float noise in the camera matrices does not change the cascade.
+    const float radius = ceilf(Max(near_corner, far_corner) * 16.f) / 16.f;
+
+    float3 right, up, forward;
+    Float4x4ExtractView(a_scene_info.view, right, up, forward);
+    const float3 center = a_scene_info.view_pos + forward * center_distance;
+
+    // the rotation only depends on the light, so the texel grid stays in place while the camera moves.
+    const float3 up_hint = fabsf(a_light_dir.y) > 0.99f ? float3(0.f, 0.f, 1.f) : float3(0.f, 1.f, 0.f);
+    const float4x4 light_view = Float4x4Lookat(float3(0.f, 0.f, 0.f), a_light_dir, up_hint);
+
+    const float4 light_center = float4(center.x, center.y, center.z, 1.f) * light_view;
+    const float texel_size = radius * 2.f / static_cast<float>(a_tile_size);
+    const float center_x = floorf(light_center.x / texel_size) * texel_size;
+    const float center_y = floorf(light_center.y / texel_size) * texel_size;
+
+    // the light looks down -z, the depth range starts at the caster closest to the light.
+    float caster_z = -FLT_MAX;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const float4 corner = float4(
+            (i & 1) ? a_caster_bounds.max.x : a_caster_bounds.min.x,
+            (i & 2) ? a_caster_bounds.max.y : a_caster_bounds.min.y,
+            (i & 4) ? a_caster_bounds.max.z : a_caster_bounds.min.z,
+            1.f);
+        caster_z = Max(caster_z, (corner * light_view).z);
+    }
+    const float depth_snap = radius * 0.25f;
+    const float near_z = Min(Max(light_center.z + radius, caster_z), light_center.z + radius + SHADOW_CASCADE_MAX_CASTER_DISTANCE);
+    const float z_near = ceilf(near_z / depth_snap) * depth_snap;
+    const float z_far = floorf((light_center.z - radius) / depth_snap) * depth_snap;
+
+    // y is flipped like Float4x4Perspective so every shadow has the same winding, depth goes from 0 at z_near to 1 at z_far.
+    float4x4 projection = Float4x4Identity();
+    projection.e[0][0] = 1.f / radius;
+    projection.e[0][3] = -center_x / radius;
+    projection.e[1][1] = -1.f / radius;
+    projection.e[1][3] = center_y / radius;
+    projection.e[2][2] = -1.f / (z_near - z_far);
+    projection.e[2][3] = z_near / (z_near - z_far);
+    return light_view * projection;
+}
+
+// conservative, only false when all 8 corners are outside the same clip plane.
+static bool BoxInShadowView(const float4x4& a_projection_view, const float3 a_min, const float3 a_max)
+{
+    uint32_t outside_all = 0x3F;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const float4 corner = float4((i & 1) ? a_max.x : a_min.x, (i & 2) ? a_max.y : a_min.y, (i & 4) ? a_max.z : a_min.z, 1.f);
+        const float4 clip = corner * a_projection_view;
+        uint32_t outside = 0;
+        if (clip.x < -clip.w) outside |= 1 << 0;
+        if (clip.x > clip.w)  outside |= 1 << 1;
+        if (clip.y < -clip.w) outside |= 1 << 2;
+        if (clip.y > clip.w)  outside |= 1 << 3;
+        if (clip.z < 0.f)     outside |= 1 << 4;
+        if (clip.z > clip.w)  outside |= 1 << 5;
+        outside_all &= outside;
+    }
+    return outside_all == 0;
+}
 
-void ShadowMapStage::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count)
+void ShadowMapStage::Init(MemoryArena& a_arena, const uint32_t a_max_lights)
 {
     MaterialCreateInfo shadow_map_material;
     shadow_map_material.pass_type = PASS_TYPE::SCENE;
     shadow_map_material.material_type = MATERIAL_TYPE::NONE;
     MaterialShaderCreateInfo vertex_shadow_map;
-    vertex_shadow_map.path = "hlsl/ShadowMap.hlsl";
+    vertex_shadow_map.path = "HLSL/ShadowMap.hlsl";
     vertex_shadow_map.entry = "VertexMain";
     vertex_shadow_map.stage = SHADER_STAGE::VERTEX;
     vertex_shadow_map.next_stages = static_cast<uint32_t>(SHADER_STAGE::NONE);
@@ -22,81 +143,291 @@ void ShadowMapStage::Init(MemoryArena& a_arena, const uint32_t a_back_buffer_cou
         m_shadowmap_material = Material::CreateMasterMaterial(a_arena, shadow_map_material, "shadow map material");
     }
 
-    m_per_frame.Init(a_arena, a_back_buffer_count);
-    m_per_frame.resize(a_back_buffer_count);
-    for (uint32_t i = 0; i < m_per_frame.size(); i++)
+    m_atlas_allocator.Init(a_arena, SHADOW_ATLAS_SIZE, SHADOW_TILE_MIN_SIZE);
+    m_cache.Init(a_arena, a_max_lights * SHADOW_CASCADE_COUNT, a_max_lights * SHADOW_CASCADE_COUNT);
+    m_frame_shadows = {};
+    m_frame_shadow_cache = {};
+    m_render_shadows = {};
+    m_light_shadows = {};
+    for (uint32_t i = 0; i < m_cache.size(); i++)
+    {
+        m_cache[i].tile = AtlasAllocation();
+        m_cache[i].size_limit = 0;
+        m_cache[i].valid = false;
+        m_cache[i].used_this_frame = false;
+    }
+    m_previous_draw_count = 0;
+    m_stats = {};
+
+    // all frames share the atlas, they are all on the graphics queue so the barriers keep them in order.
+    {
+        ImageCreateInfo shadow_atlas_img;
+        shadow_atlas_img.name = "shadow atlas";
+        shadow_atlas_img.width = SHADOW_ATLAS_SIZE;
+        shadow_atlas_img.height = SHADOW_ATLAS_SIZE;
+        shadow_atlas_img.depth = 1;
+        shadow_atlas_img.array_layers = 1;
+        shadow_atlas_img.mip_levels = 1;
+        shadow_atlas_img.use_optimal_tiling = true;
+        shadow_atlas_img.type = IMAGE_TYPE::TYPE_2D;
+        shadow_atlas_img.format = IMAGE_FORMAT::D16_UNORM;
+        shadow_atlas_img.usage = IMAGE_USAGE::SHADOW_MAP;
+        shadow_atlas_img.is_cube_map = false;
+        m_atlas = CreateImage(shadow_atlas_img);
+    }
+
+    ImageViewCreateInfo shadow_atlas_view;
+    shadow_atlas_view.name = "shadow atlas view";
+    shadow_atlas_view.image = m_atlas;
+    shadow_atlas_view.base_array_layer = 0;
+    shadow_atlas_view.array_layers = 1;
+    shadow_atlas_view.mip_levels = 1;
+    shadow_atlas_view.base_mip_level = 0;
+    shadow_atlas_view.format = IMAGE_FORMAT::D16_UNORM;
+    shadow_atlas_view.type = IMAGE_VIEW_TYPE::TYPE_2D;
+    shadow_atlas_view.aspects = IMAGE_ASPECT::DEPTH;
+    m_atlas_descriptor = CreateImageView(shadow_atlas_view);
+
+    shadow_atlas_view.name = "shadow atlas renderpass view";
+    m_atlas_render_view = CreateImageViewShaderInaccessible(shadow_atlas_view);
+    m_atlas_initialized = false;
+}
+
+void ShadowMapStage::PrepareShadows(MemoryArena& a_per_frame_arena, const ConstSlice<LightComponent> a_lights, const Scene3DInfo& a_scene_info, const uint2 a_draw_area, const DrawList& a_draw_list, const ConstSlice<BoundingBox> a_changed_caster_bounds, const bool a_all_casters_changed)
+{
+    const uint32_t light_count = static_cast<uint32_t>(a_lights.size());
+    BB_ASSERT(light_count * SHADOW_CASCADE_COUNT <= m_cache.size(), "more lights then the shadow cache was made for");
+
+    for (uint32_t i = 0; i < m_cache.size(); i++)
+        m_cache[i].used_this_frame = false;
+
+    m_frame_shadows = {};
+    m_frame_shadow_cache = {};
+    m_render_shadows = {};
+    m_light_shadows = {};
+    const bool draw_count_changed = a_draw_list.draw_entries.size() != m_previous_draw_count;
+    m_previous_draw_count = a_draw_list.draw_entries.size();
+
+    // one limited tile may grow back per frame, so the lights do not all take the same free space and repack again.
+    uint32_t growth_space = m_atlas_allocator.GetReport().largest_free;
+    StaticArray<FrameShadow> shadows{};
+    if (light_count != 0)
+        shadows.Init(a_per_frame_arena, light_count * SHADOW_CASCADE_COUNT);
+    for (uint32_t light_index = 0; light_index < light_count; light_index++)
     {
-        PerFrame& pfd = m_per_frame[i];
-        pfd.render_pass_views.Init(a_arena, INITIAL_DEPTH_ARRAY_COUNT);
-        pfd.render_pass_views.resize(INITIAL_DEPTH_ARRAY_COUNT);
+        const Light& light = a_lights[light_index].light;
+        const bool directional = light.light_type == static_cast<uint32_t>(LIGHT_TYPE::DIRECTIONAL_LIGHT);
+        const uint32_t cascade_count = directional ? SHADOW_CASCADE_COUNT : 1;
+        for (uint32_t cascade = 0; cascade < cascade_count; cascade++)
         {
-            ImageCreateInfo shadow_map_img;
-            shadow_map_img.name = "shadow map array";
-            shadow_map_img.width = DEPTH_IMAGE_SIZE_W_H;
-            shadow_map_img.height = DEPTH_IMAGE_SIZE_W_H;
-            shadow_map_img.depth = 1;
-            shadow_map_img.array_layers = static_cast<uint16_t>(pfd.render_pass_views.size());
-            shadow_map_img.mip_levels = 1;
-            shadow_map_img.use_optimal_tiling = true;
-            shadow_map_img.type = IMAGE_TYPE::TYPE_2D;
-            shadow_map_img.format = IMAGE_FORMAT::D16_UNORM;
-            shadow_map_img.usage = IMAGE_USAGE::SHADOW_MAP;
-            shadow_map_img.is_cube_map = false;
-            pfd.image = CreateImage(shadow_map_img);
+            FrameShadow shadow;
+            shadow.cache_index = light_index * SHADOW_CASCADE_COUNT + cascade;
+            shadow.light_index = light_index;
+            shadow.cascade = cascade;
+
+            CachedShadow& cached = m_cache[shadow.cache_index];
+            cached.used_this_frame = true;
+            // a cascade that got a smaller tile from a repack keeps it, growing back would repack every frame when the atlas is full.
+            if (directional)
+                shadow.size = cached.tile.IsValid() ? cached.tile.size : SHADOW_TILE_MAX_SIZE;
+            else
+            {
+                shadow.size = ShadowTileSize(light, a_scene_info, a_draw_area, cached.tile.size);
+                // the same for point and spot tiles, their screen size would ask for the size from before the repack again.
+                if (cached.size_limit != 0 && shadow.size > cached.size_limit)
+                {
+                    if (shadow.size <= growth_space)
+                    {
+                        cached.size_limit = 0;
+                        growth_space = 0;
+                    }
+                    else
+                        shadow.size = cached.size_limit;
+                }
+            }
+            shadows.push_back(shadow);
         }
+    }
 
+    // the tiles of lights that are gone go back to the atlas.
+    for (uint32_t i = 0; i < m_cache.size(); i++)
+    {
+        CachedShadow& cached = m_cache[i];
+        if (!cached.used_this_frame && cached.tile.IsValid())
         {
-            ImageViewCreateInfo shadow_map_img_view;
-            shadow_map_img_view.name = "shadow map array view";
-            shadow_map_img_view.image = pfd.image;
-            shadow_map_img_view.base_array_layer = 0;
-            shadow_map_img_view.array_layers = static_cast<uint16_t>(pfd.render_pass_views.size());
-            shadow_map_img_view.mip_levels = 1;
-            shadow_map_img_view.base_mip_level = 0;
-            shadow_map_img_view.format = IMAGE_FORMAT::D16_UNORM;
-            shadow_map_img_view.type = IMAGE_VIEW_TYPE::TYPE_2D_ARRAY;
-            shadow_map_img_view.aspects = IMAGE_ASPECT::DEPTH;
-            pfd.descriptor_index = CreateImageView(shadow_map_img_view);
+            m_atlas_allocator.Free(cached.tile);
+            cached.tile = AtlasAllocation();
+            cached.size_limit = 0;
+            cached.valid = false;
         }
+    }
+
+    m_stats = {};
+    m_stats.atlas_used_area = m_atlas_allocator.GetReport().used_area;
+    if (light_count == 0)
+        return;
 
+    if (!AllocateTiles(shadows.slice()))
+        RepackTiles(a_per_frame_arena, shadows.slice());
+
+    BoundingBox caster_bounds;
+    caster_bounds.min = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+    caster_bounds.max = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < a_draw_list.occlusion_draws.size(); i++)
+    {
+        caster_bounds.min = Float3Min(caster_bounds.min, a_draw_list.occlusion_draws[i].bounds_min);
+        caster_bounds.max = Float3Max(caster_bounds.max, a_draw_list.occlusion_draws[i].bounds_max);
+    }
+
+    float cascade_splits[SHADOW_CASCADE_COUNT + 1];
+    {
+        const float near_plane = a_scene_info.near_plane;
+        const float far_plane = Min(CameraFarPlane(a_scene_info), SHADOW_CASCADE_MAX_DISTANCE);
+        for (uint32_t i = 0; i < SHADOW_CASCADE_COUNT + 1; i++)
         {
-            ImageViewCreateInfo render_pass_shadow_view{};
-            render_pass_shadow_view.name = "shadow map renderpass view";
-            render_pass_shadow_view.image = pfd.image;
-            render_pass_shadow_view.array_layers = 1;
-            render_pass_shadow_view.mip_levels = 1;
-            render_pass_shadow_view.base_mip_level = 0;
-            render_pass_shadow_view.format = IMAGE_FORMAT::D16_UNORM;
-            render_pass_shadow_view.type = IMAGE_VIEW_TYPE::TYPE_2D;
-            render_pass_shadow_view.aspects = IMAGE_ASPECT::DEPTH;
-            for (uint32_t shadow_index = 0; shadow_index < pfd.render_pass_views.size(); shadow_index++)
-            {
-                render_pass_shadow_view.base_array_layer = static_cast<uint16_t>(shadow_index);
-                pfd.render_pass_views[shadow_index] = CreateImageViewShaderInaccessible(render_pass_shadow_view);
-            }
+            const float part = static_cast<float>(i) / static_cast<float>(SHADOW_CASCADE_COUNT);
+            const float uniform_split = near_plane + (far_plane - near_plane) * part;
+            const float log_split = near_plane * powf(far_plane / near_plane, part);
+            cascade_splits[i] = Lerp(uniform_split, log_split, SHADOW_CASCADE_SPLIT_LAMBDA);
+        }
+    }
+
+    m_frame_shadows.Init(a_per_frame_arena, shadows.size());
+    m_frame_shadow_cache.Init(a_per_frame_arena, shadows.size());
+    m_render_shadows.Init(a_per_frame_arena, shadows.size());
+    m_light_shadows.Init(a_per_frame_arena, light_count, light_count);
+
+    // a new or removed draw can be anywhere, the draw list has no way to tell which one it was.
+    const bool all_dirty = a_all_casters_changed || draw_count_changed;
+    const float atlas_size = static_cast<float>(SHADOW_ATLAS_SIZE);
+    for (uint32_t i = 0; i < shadows.size(); i++)
+    {
+        const FrameShadow& shadow = shadows[i];
+        CachedShadow& cached = m_cache[shadow.cache_index];
+        uint2& light_shadows = m_light_shadows[shadow.light_index];
+        if (shadow.cascade == 0)
+            light_shadows = uint2(m_frame_shadows.size(), 0);
+
+        // a shadow without a tile ends the shadows of the light, the shader wants them next to each other.
+        if (!cached.tile.IsValid() || light_shadows.y != shadow.cascade)
+            continue;
+
+        const Light& light = a_lights[shadow.light_index].light;
+        float4x4 projection_view;
+        if (light.light_type == static_cast<uint32_t>(LIGHT_TYPE::DIRECTIONAL_LIGHT))
+        {
+            const float3 light_dir = float3(light.direction.x, light.direction.y, light.direction.z);
+            if (Float3LengthSq(light_dir) == 0.f)
+                continue;
+            projection_view = CascadeProjectionView(Float3Normalize(light_dir), a_scene_info, cascade_splits[shadow.cascade], cascade_splits[shadow.cascade + 1], cached.tile.size, caster_bounds);
+        }
+        else
+            projection_view = a_lights[shadow.light_index].projection_view;
+
+        bool dirty = !cached.valid || all_dirty || memcmp(&cached.projection_view, &projection_view, sizeof(float4x4)) != 0;
+        for (size_t bounds_index = 0; !dirty && bounds_index < a_changed_caster_bounds.size(); bounds_index++)
+            dirty = BoxInShadowView(projection_view, a_changed_caster_bounds[bounds_index].min, a_changed_caster_bounds[bounds_index].max);
+
+        if (dirty)
+        {
+            cached.projection_view = projection_view;
+            cached.valid = true;
+            m_render_shadows.push_back(m_frame_shadows.size());
         }
+
+        ShaderShadow shader_shadow;
+        shader_shadow.projection_view = projection_view;
+        shader_shadow.atlas_rect = float4(
+            static_cast<float>(cached.tile.offset.x) / atlas_size,
+            static_cast<float>(cached.tile.offset.y) / atlas_size,
+            static_cast<float>(cached.tile.size) / atlas_size,
+            static_cast<float>(cached.tile.size) / atlas_size);
+        m_frame_shadows.push_back(shader_shadow);
+        m_frame_shadow_cache.push_back(shadow.cache_index);
+        ++light_shadows.y;
     }
+
+    m_stats.shadow_count = m_frame_shadows.size();
+    m_stats.rendered_count = m_render_shadows.size();
+    m_stats.atlas_used_area = m_atlas_allocator.GetReport().used_area;
 }
 
-void ShadowMapStage::ExecutePass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_shadow_map_resolution, const DrawList& a_draw_list, const ConstSlice<LightComponent> a_lights)
+bool ShadowMapStage::AllocateTiles(const Slice<FrameShadow> a_shadows)
 {
-    PerFrame& pfd = m_per_frame[a_frame_index];
+    // free the tiles that change size first, so their space can be used by the new tiles.
+    for (size_t i = 0; i < a_shadows.size(); i++)
+    {
+        CachedShadow& cached = m_cache[a_shadows[i].cache_index];
+        if (cached.tile.IsValid() && cached.tile.size != a_shadows[i].size)
+        {
+            m_atlas_allocator.Free(cached.tile);
+            cached.tile = AtlasAllocation();
+            cached.valid = false;
+        }
+    }
 
-    const uint32_t shadow_map_count = static_cast<uint32_t>(a_lights.size());
-    if (shadow_map_count == 0)
+    for (size_t i = 0; i < a_shadows.size(); i++)
     {
-        return;
+        CachedShadow& cached = m_cache[a_shadows[i].cache_index];
+        if (cached.tile.IsValid())
+            continue;
+        cached.tile = m_atlas_allocator.Allocate(a_shadows[i].size);
+        cached.valid = false;
+        if (!cached.tile.IsValid())
+            return false;
+    }
+    return true;
+}
+
+void ShadowMapStage::RepackTiles(MemoryArena& a_per_frame_arena, const Slice<FrameShadow> a_shadows)
+{
+    // the atlas is too full or too fragmented, start over with the largest tiles first and shrink the tiles that do not fit.
+    m_atlas_allocator.Reset();
+    for (uint32_t i = 0; i < m_cache.size(); i++)
+    {
+        m_cache[i].tile = AtlasAllocation();
+        m_cache[i].size_limit = 0;
+        m_cache[i].valid = false;
+    }
+
+    // sort indices, the shadows of a light need to stay next to each other.
+    uint32_t* order = ArenaAllocArr(a_per_frame_arena, uint32_t, a_shadows.size());
+    for (uint32_t i = 0; i < a_shadows.size(); i++)
+    {
+        uint32_t insert = i;
+        while (insert > 0 && a_shadows[order[insert - 1]].size < a_shadows[i].size)
+        {
+            order[insert] = order[insert - 1];
+            --insert;
+        }
+        order[insert] = i;
     }
-    BB_ASSERT(shadow_map_count <= pfd.render_pass_views.size(), "too many lights! Make a dynamic shadow mapping array");
+
+    for (size_t i = 0; i < a_shadows.size(); i++)
+    {
+        const FrameShadow& shadow = a_shadows[order[i]];
+        CachedShadow& cached = m_cache[shadow.cache_index];
+        for (uint32_t size = shadow.size; size >= SHADOW_TILE_MIN_SIZE && !cached.tile.IsValid(); size /= 2)
+            cached.tile = m_atlas_allocator.Allocate(size);
+        if (cached.tile.IsValid() && cached.tile.size < shadow.size)
+            cached.size_limit = cached.tile.size;
+    }
+}
+
+void ShadowMapStage::ExecutePass(const RCommandList a_list, const DrawList& a_draw_list)
+{
+    if (m_render_shadows.size() == 0)
+        return;
 
     SetPrimitiveTopology(a_list, PRIMITIVE_TOPOLOGY::TRIANGLE_LIST);
     const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, m_shadowmap_material);
 
+    // the tiles that are not rendered keep their depth, only the first use of the atlas can discard it.
     PipelineBarrierImageInfo shadow_map_write_transition = {};
-    shadow_map_write_transition.prev = IMAGE_LAYOUT::NONE;
+    shadow_map_write_transition.prev = m_atlas_initialized ? IMAGE_LAYOUT::RO_DEPTH : IMAGE_LAYOUT::NONE;
     shadow_map_write_transition.next = IMAGE_LAYOUT::RT_DEPTH;
-    shadow_map_write_transition.image = pfd.image;
-    shadow_map_write_transition.layer_count = shadow_map_count;
+    shadow_map_write_transition.image = m_atlas;
+    shadow_map_write_transition.layer_count = 1;
     shadow_map_write_transition.level_count = 1;
     shadow_map_write_transition.base_array_layer = 0;
     shadow_map_write_transition.base_mip_level = 0;
@@ -106,16 +437,16 @@ void ShadowMapStage::ExecutePass(const RCommandList a_list, const uint32_t a_fra
     write_pipeline.image_barriers = ConstSlice<PipelineBarrierImageInfo>(&shadow_map_write_transition, 1);
     PipelineBarriers(a_list, write_pipeline);
 
+    // the clear only touches the render area, so it clears just the tile.
     RenderingAttachmentDepth depth_attach{};
     depth_attach.load_depth = false;
     depth_attach.store_depth = true;
     depth_attach.image_layout = IMAGE_LAYOUT::RT_DEPTH;
+    depth_attach.image_view = m_atlas_render_view;
 
     StartRenderingInfo rendering_info;
     rendering_info.color_attachments = {};	// null
     rendering_info.depth_attachment = &depth_attach;
-    rendering_info.render_area_extent = a_shadow_map_resolution;
-    rendering_info.render_area_offset = int2(0, 0);
 
     SetCullMode(a_list, CULL_MODE::FRONT);
     SetFrontFace(a_list, true);
@@ -131,19 +462,27 @@ void ShadowMapStage::ExecutePass(const RCommandList a_list, const uint32_t a_fra
     blend_state[0].dst_alpha_blend = BLEND_MODE::FACTOR_ZERO;
     SetBlendMode(a_list, 0, blend_state.slice());
 
-    for (uint32_t shadow_map_index = 0; shadow_map_index < shadow_map_count; shadow_map_index++)
+    for (uint32_t render_index = 0; render_index < m_render_shadows.size(); render_index++)
     {
-        depth_attach.image_view = pfd.render_pass_views[shadow_map_index];
+        const uint32_t shadow_index = m_render_shadows[render_index];
+        const CachedShadow& cached = m_cache[m_frame_shadow_cache[shadow_index]];
+        rendering_info.render_area_offset = int2(static_cast<int>(cached.tile.offset.x), static_cast<int>(cached.tile.offset.y));
+        rendering_info.render_area_extent = uint2(cached.tile.size, cached.tile.size);
 
         StartRenderPass(a_list, rendering_info);
         for (uint32_t draw_index = 0; draw_index < a_draw_list.draw_entries.size(); draw_index++)
         {
+            const ShaderOcclusionDraw& draw_bounds = a_draw_list.occlusion_draws[draw_index];
+            if (!BoxInShadowView(cached.projection_view, draw_bounds.bounds_min, draw_bounds.bounds_max))
+                continue;
+
             const DrawList::DrawEntry& mesh_draw_call = a_draw_list.draw_entries[draw_index];
 
             ShaderIndicesShadowMapping shader_indices;
             shader_indices.position_offset = static_cast<uint32_t>(mesh_draw_call.mesh.vertex_position_offset);
             shader_indices.transform_index = draw_index;
-            shader_indices.light_projection_view_index = shadow_map_index;
+            shader_indices.shadow_index = shadow_index;
+            shader_indices.vertex_format = mesh_draw_call.mesh.vertex_format;
             SetPushConstants(a_list, pipe_layout, 0, sizeof(shader_indices), &shader_indices);
             DrawIndexed(a_list,
                 mesh_draw_call.index_count,
@@ -158,8 +497,8 @@ void ShadowMapStage::ExecutePass(const RCommandList a_list, const uint32_t a_fra
     PipelineBarrierImageInfo shadow_map_read_transition = {};
     shadow_map_read_transition.prev = IMAGE_LAYOUT::RT_DEPTH;
     shadow_map_read_transition.next = IMAGE_LAYOUT::RO_DEPTH;
-    shadow_map_read_transition.image = pfd.image;
-    shadow_map_read_transition.layer_count = shadow_map_count;
+    shadow_map_read_transition.image = m_atlas;
+    shadow_map_read_transition.layer_count = 1;
     shadow_map_read_transition.level_count = 1;
     shadow_map_read_transition.base_array_layer = 0;
     shadow_map_read_transition.base_mip_level = 0;
@@ -168,11 +507,18 @@ void ShadowMapStage::ExecutePass(const RCommandList a_list, const uint32_t a_fra
     PipelineBarrierInfo pipeline_info = {};
     pipeline_info.image_barriers = ConstSlice<PipelineBarrierImageInfo>(&shadow_map_read_transition, 1);
     PipelineBarriers(a_list, pipeline_info);
+    m_atlas_initialized = true;
+}
+
+void ShadowMapStage::UpdateConstantBuffer(Scene3DInfo& a_scene_3d_info) const
+{
+    a_scene_3d_info.shadow_count = m_frame_shadows.size();
+    a_scene_3d_info.shadow_atlas_descriptor = m_atlas_descriptor;
+    a_scene_3d_info.shadow_atlas_texel_size = float2(1.f / static_cast<float>(SHADOW_ATLAS_SIZE), 1.f / static_cast<float>(SHADOW_ATLAS_SIZE));
 }
 
-void ShadowMapStage::UpdateConstantBuffer(const uint32_t a_frame_index, Scene3DInfo& a_scene_3d_info) const
+void ShadowMapStage::GetLightShadows(const uint32_t a_light_index, uint32_t& a_shadow_index, uint32_t& a_shadow_count) const
 {
-    const PerFrame& pfd = m_per_frame[a_frame_index];
-    a_scene_3d_info.shadow_map_count = pfd.render_pass_views.size();
-    a_scene_3d_info.shadow_map_array_descriptor = pfd.descriptor_index;
+    a_shadow_index = m_light_shadows[a_light_index].x;
+    a_shadow_count = m_light_shadows[a_light_index].y;
 }
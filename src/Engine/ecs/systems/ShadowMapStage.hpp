@@ -1,28 +1,84 @@
 #pragma once
 #include "RenderStagesfwd.hpp"
+#include "AtlasAllocator.hpp"
 
 #include "ecs/components/TransformComponents.hpp"
 #include "ecs/components/LightComponent.hpp"
 
 namespace BB
 {
-    constexpr uint32_t DEPTH_IMAGE_SIZE_W_H = 4096;
+    constexpr uint32_t SHADOW_ATLAS_SIZE = 8192;
+    constexpr uint32_t SHADOW_TILE_MIN_SIZE = 128;
+    constexpr uint32_t SHADOW_TILE_MAX_SIZE = 2048;
+    constexpr uint32_t SHADOW_CASCADE_COUNT = 4;
 
+    struct ShadowMapStats
+    {
+        uint32_t shadow_count;
+        uint32_t rendered_count;
+        uint64_t atlas_used_area;
+    };
+
+    // every shadow gets a square tile in one atlas that lives across frames, the tile size follows how large the light is on screen.
+    // a tile keeps its depth until its view changes or a caster inside the view moved, so a static scene renders no shadows.
+    // directional lights get SHADOW_CASCADE_COUNT cascades that are snapped to their texels, so they only change when the camera moves a texel.
     class ShadowMapStage
     {
     public:
-        void Init(MemoryArena& a_arena, const uint32_t a_back_buffer_count);
-        void ExecutePass(const RCommandList a_list, const uint32_t a_frame_index, const uint2 a_shadow_map_resolution, const DrawList& a_draw_list, const ConstSlice<LightComponent> a_lights);
-        void UpdateConstantBuffer(const uint32_t a_frame_index, Scene3DInfo& a_scene_3d_info) const;
+        void Init(MemoryArena& a_arena, const uint32_t a_max_lights);
+        // builds the shadows of the frame, packs them into the atlas and finds the ones that have to render.
+        // a_changed_caster_bounds are the world bounds of the casters that moved since the last frame, before and after the move.
+        void PrepareShadows(MemoryArena& a_per_frame_arena, const ConstSlice<LightComponent> a_lights, const Scene3DInfo& a_scene_info, const uint2 a_draw_area, const DrawList& a_draw_list, const ConstSlice<BoundingBox> a_changed_caster_bounds, const bool a_all_casters_changed);
+        // renders the shadows that are not cached, records nothing when all of them are.
+        void ExecutePass(const RCommandList a_list, const DrawList& a_draw_list);
+        void UpdateConstantBuffer(Scene3DInfo& a_scene_3d_info) const;
+
+        // valid after PrepareShadows, the ShaderShadows of a light are next to each other.
+        ConstSlice<ShaderShadow> GetShadows() const { return m_frame_shadows.const_slice(); }
+        void GetLightShadows(const uint32_t a_light_index, uint32_t& a_shadow_index, uint32_t& a_shadow_count) const;
+        ShadowMapStats GetStats() const { return m_stats; }
+
     private:
-        struct PerFrame
+        // one for every light index and cascade.
+        struct CachedShadow
+        {
+            AtlasAllocation tile;
+            float4x4 projection_view;
+            // the size a repack shrunk a point or spot tile to, 0 when it is not limited.
+            uint32_t size_limit;
+            // the tile holds the depth of projection_view.
+            bool valid;
+            bool used_this_frame;
+        };
+
+        struct FrameShadow
         {
-            RImage image;
-            RDescriptorIndex descriptor_index;
-            StaticArray<RImageView> render_pass_views;
+            uint32_t cache_index;
+            uint32_t light_index;
+            uint32_t cascade;
+            uint32_t size;
+            float4x4 projection_view;
         };
 
-        StaticArray<PerFrame> m_per_frame;
+        bool AllocateTiles(const Slice<FrameShadow> a_shadows);
+        void RepackTiles(MemoryArena& a_per_frame_arena, const Slice<FrameShadow> a_shadows);
+
+        AtlasAllocator m_atlas_allocator;
+        RImage m_atlas;
+        RImageView m_atlas_render_view;
+        RDescriptorIndex m_atlas_descriptor;
+        bool m_atlas_initialized;
+
+        StaticArray<CachedShadow> m_cache;
+        uint32_t m_previous_draw_count;
+
+        // per frame, allocated from the per frame arena.
+        StaticArray<ShaderShadow> m_frame_shadows;
+        StaticArray<uint32_t> m_frame_shadow_cache;
+        StaticArray<uint2> m_light_shadows;
+        StaticArray<uint32_t> m_render_shadows;
+
+        ShadowMapStats m_stats;
         MasterMaterialHandle m_shadowmap_material;
     };
 }
@@ -0,0 +1,69 @@
+#include "UpscaleStage.hpp"
+#include "MaterialSystem.hpp"
+#include "Renderer.hpp"
+
+using namespace BB;
+
+void UpscaleStage::Init(MemoryArena& a_arena)
+{
+    MaterialCreateInfo upscale_material;
+    upscale_material.pass_type = PASS_TYPE::SCENE;
+    upscale_material.material_type = MATERIAL_TYPE::NONE;
+    FixedArray<MaterialShaderCreateInfo, 2> upscale_shaders;
+    upscale_shaders[0].path = "HLSL/Upscale.hlsl";
+    upscale_shaders[0].entry = "VertexMain";
+    upscale_shaders[0].stage = SHADER_STAGE::VERTEX;
+    upscale_shaders[0].next_stages = static_cast<uint32_t>(SHADER_STAGE::FRAGMENT_PIXEL);
+    upscale_shaders[1].path = "HLSL/Upscale.hlsl";
+    upscale_shaders[1].entry = "FragmentMain";
+    upscale_shaders[1].stage = SHADER_STAGE::FRAGMENT_PIXEL;
+    upscale_shaders[1].next_stages = static_cast<uint32_t>(SHADER_STAGE::NONE);
+    upscale_material.shader_infos = Slice(upscale_shaders.slice());
+
+    MemoryArenaScope(a_arena)
+    {
+        m_upscale_material = Material::CreateMasterMaterial(a_arena, upscale_material, "upscale material");
+    }
+}
+
+void UpscaleStage::ExecutePass(const RCommandList a_list, const RDescriptorIndex a_source, const uint2 a_source_size, const uint2 a_rendered_size, const uint2 a_output_size, const RImageView a_render_target)
+{
+    SetPrimitiveTopology(a_list, PRIMITIVE_TOPOLOGY::TRIANGLE_LIST);
+    const RPipelineLayout pipe_layout = Material::BindMaterial(a_list, m_upscale_material);
+
+    SetFrontFace(a_list, false);
+    SetCullMode(a_list, CULL_MODE::NONE);
+
+    FixedArray<ColorBlendState, 1> blend_state;
+    blend_state[0].blend_enable = false;
+    blend_state[0].color_flags = 0xF;
+    blend_state[0].color_blend_op = BLEND_OP::ADD;
+    blend_state[0].src_blend = BLEND_MODE::FACTOR_ONE;
+    blend_state[0].dst_blend = BLEND_MODE::FACTOR_ZERO;
+    blend_state[0].alpha_blend_op = BLEND_OP::ADD;
+    blend_state[0].src_alpha_blend = BLEND_MODE::FACTOR_ONE;
+    blend_state[0].dst_alpha_blend = BLEND_MODE::FACTOR_ZERO;
+    SetBlendMode(a_list, 0, blend_state.slice());
+
+    // every texel is written, nothing to load.
+    RenderingAttachmentColor color_attach;
+    color_attach.load_color = false;
+    color_attach.store_color = true;
+    color_attach.image_layout = IMAGE_LAYOUT::RT_COLOR;
+    color_attach.image_view = a_render_target;
+    StartRenderingInfo rendering_info;
+    rendering_info.color_attachments = Slice(&color_attach, 1);
+    rendering_info.depth_attachment = nullptr;
+    rendering_info.render_area_extent = a_output_size;
+    rendering_info.render_area_offset = int2{ 0, 0 };
+
+    ShaderUpscale push_constant{};
+    push_constant.uv_scale = float2(static_cast<float>(a_rendered_size.x) / static_cast<float>(a_source_size.x), static_cast<float>(a_rendered_size.y) / static_cast<float>(a_source_size.y));
+    push_constant.source_size = float2(static_cast<float>(a_source_size.x), static_cast<float>(a_source_size.y));
+    push_constant.source = a_source;
+    SetPushConstants(a_list, pipe_layout, 0, sizeof(push_constant), &push_constant);
+
+    StartRenderPass(a_list, rendering_info);
+    DrawVertices(a_list, 3, 1, 0, 0);
+    EndRenderPass(a_list);
+}
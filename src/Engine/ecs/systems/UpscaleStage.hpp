@@ -0,0 +1,18 @@
+#pragma once
+#include "GPUBuffers.hpp"
+#include "Rendererfwd.hpp"
+#include "Enginefwd.hpp"
+
+namespace BB
+{
+    // the scene renders into the top left of an image the size of the render target, this scales that part up to the whole render target.
+    class UpscaleStage
+    {
+    public:
+        void Init(MemoryArena& a_arena);
+        // a_source must be in RO_FRAGMENT, a_source_size is the size of the whole image and a_rendered_size the part that was rendered.
+        void ExecutePass(const RCommandList a_list, const RDescriptorIndex a_source, const uint2 a_source_size, const uint2 a_rendered_size, const uint2 a_output_size, const RImageView a_render_target);
+    private:
+        MasterMaterialHandle m_upscale_material;
+    };
+}
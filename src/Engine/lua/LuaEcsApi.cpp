@@ -28,11 +28,25 @@ int luaapi::ECSCreateEntity(lua_State* a_state)
     return 1;
 }
 
+// like ECSCreateEntity but deferred, nothing is returned as the entity is made when the scene updates.
+int luaapi::ECSSpawnEntity(lua_State* a_state)
+{
+    const NameComponent name = lua_tostring(a_state, 1);
+    const ECSEntity parent = ECSEntity(*lua_getbbhandle(a_state, 2));
+    const float3 pos = *lua_getfloat3(a_state, 3);
+
+    GameInstance* inst = GetGameInstance(a_state);
+    inst->GetCommandBuffer().CreateEntity(name, parent, pos);
+    return 0;
+}
+
+// the entity and its children stay valid until the scene updates, then they are destroyed in one batch.
 int luaapi::ECSDestroyEntity(lua_State* a_state)
 {
     const ECSEntity entity = ECSEntity(*lua_getbbhandle(a_state, 1));
     GameInstance* inst = GetGameInstance(a_state);
-    bool success = inst->GetSceneHierarchy().GetECS().DestroyEntity(entity);
+    // fails as well when the command buffer is full.
+    const bool success = inst->GetSceneHierarchy().GetECS().ValidateEntity(entity) && inst->GetCommandBuffer().DestroyEntity(entity);
 
     lua_pushboolean(a_state, success);
     return 1;
@@ -16,38 +16,31 @@ using namespace BB;
 
 static void* LuaAlloc(void* a_user_data, void* a_ptr, const size_t a_old_size, const size_t a_new_size)
 {
-    FreelistInterface* allocator = reinterpret_cast<FreelistInterface*>(a_user_data);
+    TLSFInterface* allocator = reinterpret_cast<TLSFInterface*>(a_user_data);
+    (void)a_old_size;
 
-    void* ret_val = nullptr;
+    // lua frees with a nullptr when the allocation never happened.
+    if (a_new_size == 0 && a_ptr == nullptr)
+        return nullptr;
 
-    if (a_new_size)
-    {
-        ret_val = allocator->Alloc(a_new_size, 16);
-        BB_ASSERT(ret_val, "failed to allocate lua mem");
-
-        if (a_ptr)
-        {
-            memcpy(ret_val, a_ptr, Min(a_old_size, a_new_size));
-            allocator->Free(a_ptr);
-        }
-    }
-    else if (a_new_size == 0)
-    {
-        allocator->Free(a_ptr);
-    }
-
-    return ret_val;
+    // a nullptr return on growth lets lua raise a memory error, shrinking never fails.
+    return allocator->Realloc(a_ptr, a_new_size, 16);
 }
 
-#define _USE_LAUL
+// luaL_newstate used to set a panic handler, lua_newstate does not. lua aborts the program after this returns.
+static int LuaPanic(lua_State* a_state)
+{
+    const char* message = lua_tostring(a_state, -1);
+    BB_LOG(message ? message : "lua error object is not a string");
+    BB_ASSERT(false, "lua panic, error outside of a protected call");
+    return 0;
+}
 
 void LuaContext::RegisterLua()
 {
-#ifdef _USE_LAUL
-    m_state = luaL_newstate();
-#else
     m_state = lua_newstate(LuaAlloc, &m_allocator);
-#endif // _USE_LUAL
+    BB_ASSERT(m_state, "failed to create a lua state");
+    lua_atpanic(m_state, LuaPanic);
     luaL_openlibs(m_state);
     lua_registerbbtypes(m_state);
     PathString lua_path = Asset::GetAssetPath();
@@ -31,6 +31,6 @@ namespace BB
     private:
         void RegisterLua();
         lua_State* m_state = nullptr;
-        FreelistInterface m_allocator;
+        TLSFInterface m_allocator;
     };
 }
@@ -0,0 +1,1058 @@
+#include "VulkanRenderer.hpp"
+#include "NullRenderer.hpp"
+
+#include "Program.h"
+#include "Utils/Utils.h"
+
+#include <atomic>
+#include <cstdio>
+
+using namespace BB;
+using namespace BB::NullRenderer;
+
+// implements the backend functions of VulkanRenderer.hpp without a gpu, built instead of the vulkan backend when RENDERER_NULL_BACKEND is on.
+// every call succeeds, handles are indices so they are the same every run and submitted work is done the moment it is submitted.
+// buffers only get host memory when they are mapped, images and shaders are nothing but a handle.
+
+constexpr uint32_t NULL_BUFFER_MAX = 4096;
+constexpr uint32_t NULL_COMMAND_POOL_MAX = 128;
+constexpr uint32_t NULL_COMMAND_LIST_MAX = 2048;
+constexpr uint32_t NULL_FENCE_MAX = 256;
+constexpr uint32_t NULL_TIMESTAMP_POOL_MAX = 32;
+constexpr uint32_t NULL_DESCRIPTOR_LAYOUT_MAX = 128;
+constexpr uint32_t NULL_PIPELINE_LAYOUT_MAX = 64;
+constexpr uint32_t NULL_DESCRIPTOR_SIZE = 64;
+constexpr size_t NULL_DESCRIPTOR_BUFFER_SIZE = mbSize * 4;
+constexpr size_t NULL_COMMAND_LIST_RESERVE = mbSize * 64;
+constexpr size_t NULL_RECORDING_RESERVE = gbSize * 4;
+// every buffer gets its own 4gb of fake address space, so an address says which buffer it points into.
+constexpr uint32_t NULL_BUFFER_ADDRESS_SHIFT = 32;
+
+// a byte stream that reserves its whole size up front and commits pages as it grows.
+struct NullByteStream
+{
+	uint8_t* begin;
+	size_t size;
+	size_t committed;
+	size_t reserved;
+};
+
+static void ByteStreamAppend(NullByteStream& a_stream, const void* a_data, const size_t a_size)
+{
+	if (a_stream.begin == nullptr)
+		a_stream.begin = reinterpret_cast<uint8_t*>(ReserveVirtualMemory(a_stream.reserved));
+
+	const size_t new_size = a_stream.size + a_size;
+	BB_ASSERT(new_size <= a_stream.reserved, "null renderer: recorded more commands than reserved");
+	if (new_size > a_stream.committed)
+	{
+		const size_t new_committed = RoundUp(new_size, mbSize);
+		const bool success = CommitVirtualMemory(a_stream.begin + a_stream.committed, new_committed - a_stream.committed);
+		BB_ASSERT(success, "null renderer: failed to commit memory for recorded commands");
+		a_stream.committed = new_committed;
+	}
+	memcpy(a_stream.begin + a_stream.size, a_data, a_size);
+	a_stream.size = new_size;
+}
+
+struct NullBuffer
+{
+	uint64_t size;
+	void* memory;
+	bool in_use;
+};
+
+struct NullCommandList
+{
+	NullByteStream commands;
+	uint32_t command_counts[static_cast<uint32_t>(NULL_COMMAND::ENUM_SIZE)];
+	bool recording;
+};
+
+struct NullCommandPool
+{
+	uint32_t first_list;
+	uint32_t list_count;
+};
+
+struct NullTimestampPool
+{
+	uint32_t count;
+};
+
+struct NullPipelineLayout
+{
+	RDescriptorLayout descriptor_layouts[SPACE_AMOUNT];
+	uint32_t descriptor_layout_count;
+	uint32_t push_constant_size;
+};
+
+struct NullRenderer_inst
+{
+	BBRWLock lock;
+	bool record_commands;
+	NullByteStream recording;
+	NullRendererStats stats;
+
+	NullBuffer buffers[NULL_BUFFER_MAX];
+	uint32_t buffer_free_list[NULL_BUFFER_MAX];
+	uint32_t buffer_free_count;
+	uint32_t next_buffer;
+
+	NullCommandPool pools[NULL_COMMAND_POOL_MAX];
+	uint32_t pool_count;
+	NullCommandList lists[NULL_COMMAND_LIST_MAX];
+	uint32_t list_count;
+
+	std::atomic<uint64_t> fences[NULL_FENCE_MAX];
+	uint32_t fence_count;
+
+	NullTimestampPool timestamp_pools[NULL_TIMESTAMP_POOL_MAX];
+	uint32_t timestamp_pool_count;
+
+	// the same layouts give the same pipeline layout, like the vulkan layout cache. BindShaders asserts on it.
+	NullPipelineLayout pipeline_layouts[NULL_PIPELINE_LAYOUT_MAX];
+	uint32_t pipeline_layout_count;
+
+	uint32_t descriptor_layout_sizes[NULL_DESCRIPTOR_LAYOUT_MAX];
+	uint32_t descriptor_layout_count;
+	void* descriptor_buffer;
+	std::atomic<uint32_t> descriptor_buffer_used;
+
+	// images, views, shaders and the rest only need a unique handle.
+	std::atomic<uint64_t> next_handle;
+
+	uint2 swapchain_extent;
+};
+
+static NullRenderer_inst* s_null_inst = nullptr;
+
+static uint64_t NextHandle()
+{
+	return s_null_inst->next_handle.fetch_add(1, std::memory_order_relaxed);
+}
+
+static NullBuffer& GetBuffer(const GPUBuffer a_buffer)
+{
+	BB_ASSERT(a_buffer.handle < s_null_inst->next_buffer && s_null_inst->buffers[a_buffer.handle].in_use, "null renderer: invalid buffer");
+	return s_null_inst->buffers[a_buffer.handle];
+}
+
+static NullCommandList& GetCommandList(const RCommandList a_list)
+{
+	BB_ASSERT(a_list.handle < s_null_inst->list_count, "null renderer: invalid command list");
+	return s_null_inst->lists[a_list.handle];
+}
+
+static void RecordCommand(const RCommandList a_list, const NULL_COMMAND a_type, const void* a_payload, const size_t a_payload_size)
+{
+	NullCommandList& list = GetCommandList(a_list);
+	BB_ASSERT(list.recording, "null renderer: recording a command on a list that was not started");
+	++list.command_counts[static_cast<uint32_t>(a_type)];
+	if (!s_null_inst->record_commands)
+		return;
+
+	BB_ASSERT(a_payload_size % 4 == 0 && a_payload_size <= UINT16_MAX, "null renderer: command payload must be 4 byte aligned and fit in the header");
+	const NullCommandHeader header{ a_type, static_cast<uint16_t>(a_payload_size) };
+	ByteStreamAppend(list.commands, &header, sizeof(header));
+	if (a_payload_size)
+		ByteStreamAppend(list.commands, a_payload, a_payload_size);
+}
+
+template<typename T>
+static void RecordCommand(const RCommandList a_list, const NULL_COMMAND a_type, const T& a_payload)
+{
+	static_assert(sizeof(T) % 4 == 0, "null renderer: command payload must be 4 byte aligned");
+	RecordCommand(a_list, a_type, &a_payload, sizeof(T));
+}
+
+static void SignalFences(const RFence* a_fences, const uint64_t* a_values, const uint32_t a_count)
+{
+	for (uint32_t i = 0; i < a_count; i++)
+	{
+		BB_ASSERT(a_fences[i].handle < s_null_inst->fence_count, "null renderer: invalid fence");
+		std::atomic<uint64_t>& fence = s_null_inst->fences[a_fences[i].handle];
+		uint64_t current = fence.load(std::memory_order_relaxed);
+		while (current < a_values[i] && !fence.compare_exchange_weak(current, a_values[i]));
+	}
+}
+
+// the lists run in submit order, so their commands go into the recording in that order as well.
+static void SubmitCommandLists(const ExecuteCommandsInfo& a_execute_info)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	++s_null_inst->stats.submit_count;
+	if (s_null_inst->record_commands)
+	{
+		const NullCommandHeader submit_header{ NULL_COMMAND::SUBMIT, 0 };
+		ByteStreamAppend(s_null_inst->recording, &submit_header, sizeof(submit_header));
+	}
+
+	for (uint32_t i = 0; i < a_execute_info.list_count; i++)
+	{
+		NullCommandList& list = GetCommandList(a_execute_info.lists[i]);
+		BB_ASSERT(!list.recording, "null renderer: submitting a list that is still recording");
+		for (uint32_t command = 0; command < static_cast<uint32_t>(NULL_COMMAND::ENUM_SIZE); command++)
+		{
+			s_null_inst->stats.command_counts[command] += list.command_counts[command];
+			list.command_counts[command] = 0;
+		}
+		if (list.commands.size)
+			ByteStreamAppend(s_null_inst->recording, list.commands.begin, list.commands.size);
+		list.commands.size = 0;
+	}
+	s_null_inst->stats.recorded_size = s_null_inst->recording.size;
+
+	SignalFences(a_execute_info.signal_fences, a_execute_info.signal_values, a_execute_info.signal_count);
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+}
+
+bool Vulkan::InitializeVulkan(MemoryArena& a_arena, const RendererCreateInfo a_create_info)
+{
+	(void)a_create_info;
+	BB_ASSERT(s_null_inst == nullptr, "null renderer: already initialized");
+	s_null_inst = ArenaAllocType(a_arena, NullRenderer_inst);
+	s_null_inst->lock = OSCreateRWLock();
+	s_null_inst->record_commands = false;
+	s_null_inst->recording = {};
+	s_null_inst->recording.reserved = NULL_RECORDING_RESERVE;
+	s_null_inst->stats = {};
+	s_null_inst->buffer_free_count = 0;
+	s_null_inst->next_buffer = 0;
+	s_null_inst->pool_count = 0;
+	s_null_inst->list_count = 0;
+	s_null_inst->fence_count = 0;
+	s_null_inst->timestamp_pool_count = 0;
+	s_null_inst->pipeline_layout_count = 0;
+	s_null_inst->descriptor_layout_count = 0;
+	s_null_inst->descriptor_buffer = ArenaAlloc(a_arena, NULL_DESCRIPTOR_BUFFER_SIZE, 64);
+	s_null_inst->descriptor_buffer_used = 0;
+	s_null_inst->next_handle = 0;
+	return true;
+}
+
+GPUDeviceInfo Vulkan::GetGPUDeviceInfo(MemoryArena& a_arena)
+{
+	constexpr const char NULL_DEVICE_NAME[] = "null device";
+	GPUDeviceInfo device;
+	device.name = ArenaAllocArr(a_arena, char, sizeof(NULL_DEVICE_NAME));
+	memcpy(device.name, NULL_DEVICE_NAME, sizeof(NULL_DEVICE_NAME));
+
+	device.memory_heaps.Init(a_arena, 1);
+	GPUDeviceInfo::MemoryHeapInfo heap_info;
+	heap_info.heap_num = 0;
+	heap_info.heap_size = gbSize * 8;
+	heap_info.heap_device_local = true;
+	device.memory_heaps.emplace_back(heap_info);
+
+	device.queue_families.Init(a_arena, 1);
+	GPUDeviceInfo::QueueFamily queue_family;
+	queue_family.queue_family_index = 0;
+	queue_family.queue_count = static_cast<uint32_t>(QUEUE_TYPE::ENUM_SIZE);
+	queue_family.support_compute = true;
+	queue_family.support_graphics = true;
+	queue_family.support_transfer = true;
+	device.queue_families.emplace_back(queue_family);
+	return device;
+}
+
+bool Vulkan::CreateSwapchain(MemoryArena&, const WindowHandle, const uint32_t a_width, const uint32_t a_height, uint32_t& a_backbuffer_count)
+{
+	s_null_inst->swapchain_extent = uint2(a_width, a_height);
+	(void)a_backbuffer_count;
+	return true;
+}
+
+bool Vulkan::RecreateSwapchain(const uint32_t a_width, const uint32_t a_height)
+{
+	s_null_inst->swapchain_extent = uint2(a_width, a_height);
+	return true;
+}
+
+void Vulkan::CreateCommandPool(const QUEUE_TYPE, const uint32_t a_command_list_count, RCommandPool& a_pool, RCommandList* a_plists)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	BB_ASSERT(s_null_inst->pool_count < NULL_COMMAND_POOL_MAX, "null renderer: too many command pools");
+	BB_ASSERT(s_null_inst->list_count + a_command_list_count <= NULL_COMMAND_LIST_MAX, "null renderer: too many command lists");
+	NullCommandPool& pool = s_null_inst->pools[s_null_inst->pool_count];
+	pool.first_list = s_null_inst->list_count;
+	pool.list_count = a_command_list_count;
+	for (uint32_t i = 0; i < a_command_list_count; i++)
+	{
+		NullCommandList& list = s_null_inst->lists[pool.first_list + i];
+		list = {};
+		list.commands.reserved = NULL_COMMAND_LIST_RESERVE;
+		a_plists[i] = RCommandList(pool.first_list + i);
+	}
+	s_null_inst->list_count += a_command_list_count;
+	a_pool = RCommandPool(s_null_inst->pool_count++);
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+}
+
+void Vulkan::FreeCommandPool(const RCommandPool a_pool)
+{
+	// the lists stay reserved, pools are only freed on shutdown.
+	ResetCommandPool(a_pool);
+}
+
+const GPUBuffer Vulkan::CreateBuffer(const GPUBufferCreateInfo& a_create_info)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	uint32_t index;
+	if (s_null_inst->buffer_free_count)
+		index = s_null_inst->buffer_free_list[--s_null_inst->buffer_free_count];
+	else
+	{
+		BB_ASSERT(s_null_inst->next_buffer < NULL_BUFFER_MAX, "null renderer: too many buffers");
+		index = s_null_inst->next_buffer++;
+	}
+	NullBuffer& buffer = s_null_inst->buffers[index];
+	buffer.size = a_create_info.size;
+	buffer.memory = nullptr;
+	buffer.in_use = true;
+	++s_null_inst->stats.buffer_count;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return GPUBuffer(index);
+}
+
+void Vulkan::FreeBuffer(const GPUBuffer a_buffer)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	NullBuffer& buffer = GetBuffer(a_buffer);
+	if (buffer.memory)
+	{
+		ReleaseVirtualMemory(buffer.memory);
+		s_null_inst->stats.buffer_memory -= buffer.size;
+	}
+	buffer.memory = nullptr;
+	buffer.in_use = false;
+	s_null_inst->buffer_free_list[s_null_inst->buffer_free_count++] = static_cast<uint32_t>(a_buffer.handle);
+	--s_null_inst->stats.buffer_count;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+}
+
+GPUAddress Vulkan::GetBufferAddress(const GPUBuffer a_buffer)
+{
+	return (a_buffer.handle + 1) << NULL_BUFFER_ADDRESS_SHIFT;
+}
+
+size_t Vulkan::AccelerationStructureInstanceUploadSize()
+{
+	// the size of a VkAccelerationStructureInstanceKHR.
+	return 64;
+}
+
+bool Vulkan::UploadAccelerationStructureInstances(void* a_mapped, const size_t a_mapped_size, const ConstSlice<AccelerationStructureInstanceInfo> a_instances)
+{
+	const size_t upload_size = a_instances.size() * AccelerationStructureInstanceUploadSize();
+	if (upload_size > a_mapped_size)
+		return false;
+	memset(a_mapped, 0, upload_size);
+	return true;
+}
+
+AccelerationStructSizeInfo Vulkan::GetBottomLevelAccelerationStructSizeInfo(MemoryArena&, const ConstSlice<AccelerationStructGeometrySize>, const ConstSlice<uint32_t> a_primitive_counts, const GPUAddress, const GPUAddress)
+{
+	uint32_t primitive_count = 0;
+	for (size_t i = 0; i < a_primitive_counts.size(); i++)
+		primitive_count += a_primitive_counts[i];
+
+	AccelerationStructSizeInfo size_info;
+	size_info.acceleration_structure_size = static_cast<uint32_t>(RoundUp(primitive_count * 64 + 256, 256));
+	size_info.scratch_build_size = size_info.acceleration_structure_size;
+	size_info.scratch_update_size = size_info.acceleration_structure_size / 2;
+	return size_info;
+}
+
+AccelerationStructSizeInfo Vulkan::GetTopLevelAccelerationStructSizeInfo(MemoryArena&, const ConstSlice<GPUAddress> a_instances)
+{
+	AccelerationStructSizeInfo size_info;
+	size_info.acceleration_structure_size = static_cast<uint32_t>(RoundUp(a_instances.size() * 128 + 256, 256));
+	size_info.scratch_build_size = size_info.acceleration_structure_size;
+	size_info.scratch_update_size = size_info.acceleration_structure_size / 2;
+	return size_info;
+}
+
+RAccelerationStruct Vulkan::CreateBottomLevelAccelerationStruct(const uint32_t, const GPUBuffer, const uint64_t)
+{
+	return RAccelerationStruct(NextHandle());
+}
+
+RAccelerationStruct Vulkan::CreateTopLevelAccelerationStruct(const uint32_t, const GPUBuffer, const uint64_t)
+{
+	return RAccelerationStruct(NextHandle());
+}
+
+GPUAddress Vulkan::GetAccelerationStructureAddress(const RAccelerationStruct a_acc_struct)
+{
+	return a_acc_struct.handle;
+}
+
+const RImage Vulkan::CreateImage(const ImageCreateInfo&)
+{
+	return RImage(NextHandle());
+}
+
+void Vulkan::FreeImage(const RImage)
+{
+}
+
+GPUMemoryRequirements Vulkan::GetImageMemoryRequirements(const ImageCreateInfo& a_create_info)
+{
+	// 8 bytes a texel covers every format, a third more for the mips.
+	uint64_t size = static_cast<uint64_t>(a_create_info.width) * a_create_info.height * Max(a_create_info.depth, 1u) * Max(a_create_info.array_layers, static_cast<uint16_t>(1)) * 8;
+	if (a_create_info.mip_levels > 1)
+		size += size / 3;
+
+	GPUMemoryRequirements requirements;
+	requirements.alignment = kbSize * 64;
+	requirements.size = RoundUp(size, requirements.alignment);
+	requirements.memory_type_bits = 1;
+	return requirements;
+}
+
+RMemoryHeap Vulkan::CreateMemoryHeap(const char*, const GPUMemoryRequirements&)
+{
+	return RMemoryHeap(NextHandle());
+}
+
+void Vulkan::FreeMemoryHeap(const RMemoryHeap)
+{
+}
+
+const RImage Vulkan::CreateAliasedImage(const ImageCreateInfo&, const RMemoryHeap, const uint64_t)
+{
+	return RImage(NextHandle());
+}
+
+void Vulkan::FreeAliasedImage(const RImage)
+{
+}
+
+const RImageView Vulkan::CreateImageView(const ImageViewCreateInfo&)
+{
+	return RImageView(NextHandle());
+}
+
+void Vulkan::FreeViewImage(const RImageView)
+{
+}
+
+RDescriptorLayout Vulkan::CreateDescriptorLayout(MemoryArena&, const ConstSlice<DescriptorBindingInfo> a_bindings)
+{
+	uint32_t descriptor_count = 0;
+	for (size_t i = 0; i < a_bindings.size(); i++)
+		descriptor_count += a_bindings[i].count;
+
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	BB_ASSERT(s_null_inst->descriptor_layout_count < NULL_DESCRIPTOR_LAYOUT_MAX, "null renderer: too many descriptor layouts");
+	const uint32_t index = s_null_inst->descriptor_layout_count++;
+	s_null_inst->descriptor_layout_sizes[index] = descriptor_count * NULL_DESCRIPTOR_SIZE;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return RDescriptorLayout(index);
+}
+
+RDescriptorLayout Vulkan::CreateDescriptorSamplerLayout(const Slice<SamplerCreateInfo> a_static_samplers)
+{
+	BB_ASSERT(a_static_samplers.size() <= STATIC_SAMPLER_MAX, "too many static samplers on pipeline!");
+	// immutable samplers live in the layout, allocating it takes no descriptor memory.
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	BB_ASSERT(s_null_inst->descriptor_layout_count < NULL_DESCRIPTOR_LAYOUT_MAX, "null renderer: too many descriptor layouts");
+	const uint32_t index = s_null_inst->descriptor_layout_count++;
+	s_null_inst->descriptor_layout_sizes[index] = 0;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return RDescriptorLayout(index);
+}
+
+DescriptorAllocation Vulkan::AllocateDescriptor(const RDescriptorLayout a_descriptor)
+{
+	BB_ASSERT(a_descriptor.handle < s_null_inst->descriptor_layout_count, "null renderer: invalid descriptor layout");
+	const uint32_t size = s_null_inst->descriptor_layout_sizes[a_descriptor.handle];
+
+	DescriptorAllocation allocation;
+	allocation.size = size;
+	allocation.offset = s_null_inst->descriptor_buffer_used.fetch_add(size);
+	allocation.buffer_start = s_null_inst->descriptor_buffer;
+	BB_ASSERT(allocation.offset + size <= NULL_DESCRIPTOR_BUFFER_SIZE, "null renderer: out of descriptor memory");
+	return allocation;
+}
+
+static void DescriptorWrite(const RDescriptorLayout a_layout, const DescriptorAllocation& a_allocation, const uint32_t a_descriptor_index)
+{
+	BB_ASSERT(a_layout.handle < s_null_inst->descriptor_layout_count, "null renderer: invalid descriptor layout");
+	BB_ASSERT(a_allocation.buffer_start == s_null_inst->descriptor_buffer, "null renderer: descriptor allocation is not from the descriptor buffer");
+	BB_ASSERT(a_descriptor_index * NULL_DESCRIPTOR_SIZE < s_null_inst->descriptor_layout_sizes[a_layout.handle], "null renderer: descriptor index out of bounds of the layout");
+}
+
+void Vulkan::DescriptorWriteUniformBuffer(const DescriptorWriteBufferInfo& a_write_info)
+{
+	DescriptorWrite(a_write_info.descriptor_layout, a_write_info.allocation, a_write_info.descriptor_index);
+}
+
+void Vulkan::DescriptorWriteStorageBuffer(const DescriptorWriteBufferInfo& a_write_info)
+{
+	DescriptorWrite(a_write_info.descriptor_layout, a_write_info.allocation, a_write_info.descriptor_index);
+}
+
+void Vulkan::DescriptorWriteImage(const DescriptorWriteImageInfo& a_write_info)
+{
+	DescriptorWrite(a_write_info.descriptor_layout, a_write_info.allocation, a_write_info.descriptor_index);
+}
+
+RPipelineLayout Vulkan::CreatePipelineLayout(const RDescriptorLayout* a_descriptor_layouts, const uint32_t a_layout_count, const PushConstantRange a_constant_range)
+{
+	BB_ASSERT(a_layout_count <= SPACE_AMOUNT, "null renderer: too many descriptor layouts in a pipeline layout");
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	uint32_t index = 0;
+	for (; index < s_null_inst->pipeline_layout_count; index++)
+	{
+		const NullPipelineLayout& layout = s_null_inst->pipeline_layouts[index];
+		if (layout.descriptor_layout_count == a_layout_count &&
+			layout.push_constant_size == a_constant_range.size &&
+			memcmp(layout.descriptor_layouts, a_descriptor_layouts, sizeof(RDescriptorLayout) * a_layout_count) == 0)
+			break;
+	}
+
+	if (index == s_null_inst->pipeline_layout_count)
+	{
+		BB_ASSERT(s_null_inst->pipeline_layout_count < NULL_PIPELINE_LAYOUT_MAX, "null renderer: too many pipeline layouts");
+		NullPipelineLayout& layout = s_null_inst->pipeline_layouts[s_null_inst->pipeline_layout_count++];
+		memcpy(layout.descriptor_layouts, a_descriptor_layouts, sizeof(RDescriptorLayout) * a_layout_count);
+		layout.descriptor_layout_count = a_layout_count;
+		layout.push_constant_size = a_constant_range.size;
+	}
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return RPipelineLayout(index);
+}
+
+void Vulkan::FreePipelineLayout(const RPipelineLayout)
+{
+}
+
+ShaderObject Vulkan::CreateShaderObject(const ShaderObjectCreateInfo& a_shader_object)
+{
+	BB_ASSERT(a_shader_object.shader_code_size != 0, "null renderer: creating a shader object without code");
+	return ShaderObject(NextHandle());
+}
+
+void Vulkan::CreateShaderObjects(MemoryArena&, Slice<ShaderObjectCreateInfo> a_shader_objects, ShaderObject* a_pshader_objects, const bool)
+{
+	for (size_t i = 0; i < a_shader_objects.size(); i++)
+		a_pshader_objects[i] = CreateShaderObject(a_shader_objects[i]);
+}
+
+void Vulkan::DestroyShaderObject(const ShaderObject)
+{
+}
+
+void* Vulkan::MapBufferMemory(const GPUBuffer a_buffer)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	NullBuffer& buffer = GetBuffer(a_buffer);
+	if (buffer.memory == nullptr)
+	{
+		buffer.memory = ReserveVirtualMemory(buffer.size);
+		const bool success = CommitVirtualMemory(buffer.memory, buffer.size);
+		BB_ASSERT(success, "null renderer: failed to commit memory for a mapped buffer");
+		s_null_inst->stats.buffer_memory += buffer.size;
+	}
+	void* memory = buffer.memory;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return memory;
+}
+
+void Vulkan::UnmapBufferMemory(const GPUBuffer)
+{
+	// the memory stays, mapping again returns the same pointer like a persistently mapped buffer.
+}
+
+void Vulkan::ResetCommandPool(const RCommandPool a_pool)
+{
+	BB_ASSERT(a_pool.handle < s_null_inst->pool_count, "null renderer: invalid command pool");
+	const NullCommandPool& pool = s_null_inst->pools[a_pool.handle];
+	for (uint32_t i = 0; i < pool.list_count; i++)
+	{
+		NullCommandList& list = s_null_inst->lists[pool.first_list + i];
+		list.commands.size = 0;
+		list.recording = false;
+		memset(list.command_counts, 0, sizeof(list.command_counts));
+	}
+}
+
+void Vulkan::StartCommandList(const RCommandList a_list, const char*)
+{
+	NullCommandList& list = GetCommandList(a_list);
+	BB_ASSERT(!list.recording, "null renderer: starting a list that is already recording");
+	list.recording = true;
+}
+
+void Vulkan::EndCommandList(const RCommandList a_list)
+{
+	NullCommandList& list = GetCommandList(a_list);
+	BB_ASSERT(list.recording, "null renderer: ending a list that is not recording");
+	list.recording = false;
+}
+
+void Vulkan::CopyBuffer(const RCommandList a_list, const RenderCopyBuffer& a_copy_buffer)
+{
+	struct { uint64_t dst; uint64_t src; uint64_t size; uint32_t region_count; uint32_t pad; } payload;
+	payload.dst = a_copy_buffer.dst.handle;
+	payload.src = a_copy_buffer.src.handle;
+	payload.size = 0;
+	for (size_t i = 0; i < a_copy_buffer.regions.size(); i++)
+	{
+		const RenderCopyBufferRegion& region = a_copy_buffer.regions[i];
+		BB_ASSERT(region.src_offset + region.size <= GetBuffer(a_copy_buffer.src).size, "null renderer: copy reads past the end of the source buffer");
+		BB_ASSERT(region.dst_offset + region.size <= GetBuffer(a_copy_buffer.dst).size, "null renderer: copy writes past the end of the destination buffer");
+		payload.size += region.size;
+	}
+	payload.region_count = static_cast<uint32_t>(a_copy_buffer.regions.size());
+	payload.pad = 0;
+	RecordCommand(a_list, NULL_COMMAND::COPY_BUFFER, payload);
+}
+
+void Vulkan::CopyImage(const RCommandList a_list, const CopyImageInfo& a_copy_info)
+{
+	struct { uint64_t src; uint64_t dst; uint3 extent; uint32_t pad; } payload;
+	payload.src = a_copy_info.src_image.handle;
+	payload.dst = a_copy_info.dst_image.handle;
+	payload.extent = a_copy_info.extent;
+	payload.pad = 0;
+	RecordCommand(a_list, NULL_COMMAND::COPY_IMAGE, payload);
+}
+
+void Vulkan::CopyBufferToImage(const RCommandList a_list, const RenderCopyBufferToImageInfo& a_copy_info)
+{
+	struct { uint64_t src; uint64_t src_offset; uint64_t dst; uint3 extent; uint32_t mip_level; } payload;
+	payload.src = a_copy_info.src_buffer.handle;
+	payload.src_offset = a_copy_info.src_offset;
+	payload.dst = a_copy_info.dst_image.handle;
+	payload.extent = a_copy_info.dst_image_info.extent;
+	payload.mip_level = a_copy_info.dst_image_info.mip_level;
+	RecordCommand(a_list, NULL_COMMAND::COPY_BUFFER_TO_IMAGE, payload);
+}
+
+void Vulkan::CopyImageToBuffer(const RCommandList a_list, const RenderCopyImageToBufferInfo& a_copy_info)
+{
+	struct { uint64_t src; uint64_t dst; uint3 extent; uint32_t dst_offset; } payload;
+	payload.src = a_copy_info.src_image.handle;
+	payload.dst = a_copy_info.dst_buffer.handle;
+	payload.extent = a_copy_info.src_image_info.extent;
+	payload.dst_offset = a_copy_info.dst_offset;
+	RecordCommand(a_list, NULL_COMMAND::COPY_IMAGE_TO_BUFFER, payload);
+}
+
+void Vulkan::PipelineBarriers(const RCommandList a_list, const PipelineBarrierInfo& a_barriers)
+{
+	// the counts and every image transition, a changed layout is the most likely difference between 2 recordings.
+	struct ImageTransition { uint64_t image; IMAGE_LAYOUT prev; IMAGE_LAYOUT next; uint32_t base_array_layer; uint32_t base_mip_level; };
+	constexpr uint32_t MAX_RECORDED_TRANSITIONS = 32;
+	struct { uint32_t global_count; uint32_t buffer_count; uint32_t image_count; uint32_t pad; ImageTransition images[MAX_RECORDED_TRANSITIONS]; } payload;
+	payload.global_count = static_cast<uint32_t>(a_barriers.global_barriers.size());
+	payload.buffer_count = static_cast<uint32_t>(a_barriers.buffer_barriers.size());
+	payload.image_count = static_cast<uint32_t>(a_barriers.image_barriers.size());
+	payload.pad = 0;
+	const uint32_t transition_count = Min(payload.image_count, MAX_RECORDED_TRANSITIONS);
+	for (uint32_t i = 0; i < transition_count; i++)
+	{
+		const PipelineBarrierImageInfo& barrier = a_barriers.image_barriers[i];
+		payload.images[i] = { barrier.image.handle, barrier.prev, barrier.next, barrier.base_array_layer, barrier.base_mip_level };
+	}
+	RecordCommand(a_list, NULL_COMMAND::PIPELINE_BARRIERS, &payload, offsetof(decltype(payload), images) + sizeof(ImageTransition) * transition_count);
+}
+
+void Vulkan::ClearImage(const RCommandList a_list, const ClearImageInfo& a_clear_info)
+{
+	struct { uint64_t image; float4 clear_color; IMAGE_LAYOUT layout; uint32_t base_array_layer; } payload;
+	payload.image = a_clear_info.image.handle;
+	payload.clear_color = a_clear_info.clear_color;
+	payload.layout = a_clear_info.layout;
+	payload.base_array_layer = a_clear_info.base_array_layer;
+	RecordCommand(a_list, NULL_COMMAND::CLEAR_IMAGE, payload);
+}
+
+void Vulkan::ClearDepthImage(const RCommandList a_list, const ClearDepthImageInfo& a_clear_info)
+{
+	struct { uint64_t image; float clear_depth; uint32_t clear_stencil; IMAGE_LAYOUT layout; uint32_t base_array_layer; } payload;
+	payload.image = a_clear_info.image.handle;
+	payload.clear_depth = a_clear_info.clear_depth;
+	payload.clear_stencil = a_clear_info.clear_stencil;
+	payload.layout = a_clear_info.layout;
+	payload.base_array_layer = a_clear_info.base_array_layer;
+	RecordCommand(a_list, NULL_COMMAND::CLEAR_DEPTH_IMAGE, payload);
+}
+
+void Vulkan::BlitImage(const RCommandList a_list, const BlitImageInfo& a_info)
+{
+	struct { uint64_t src; uint64_t dst; int3 src_p1; int3 dst_p1; } payload;
+	payload.src = a_info.src_image.handle;
+	payload.dst = a_info.dst_image.handle;
+	payload.src_p1 = a_info.src_offset_p1;
+	payload.dst_p1 = a_info.dst_offset_p1;
+	RecordCommand(a_list, NULL_COMMAND::BLIT_IMAGE, payload);
+}
+
+void Vulkan::BuildBottomLevelAccelerationStruct(MemoryArena&, const RCommandList a_list, const BuildBottomLevelAccelerationStructInfo& a_build_info, const GPUAddress, const GPUAddress)
+{
+	struct { uint64_t acc_struct; uint32_t geometry_count; uint32_t pad; } payload;
+	payload.acc_struct = a_build_info.acc_struct.handle;
+	payload.geometry_count = static_cast<uint32_t>(a_build_info.geometry_sizes.size());
+	payload.pad = 0;
+	RecordCommand(a_list, NULL_COMMAND::BUILD_BOTTOM_LEVEL_ACCELERATION_STRUCT, payload);
+}
+
+void Vulkan::BuildTopLevelAccelerationStruct(MemoryArena&, const RCommandList a_list, const BuildTopLevelAccelerationStructInfo& a_build_info)
+{
+	struct { uint64_t acc_struct; uint32_t instance_count; uint32_t pad; } payload;
+	payload.acc_struct = a_build_info.acc_struct.handle;
+	payload.instance_count = static_cast<uint32_t>(a_build_info.instances.size());
+	payload.pad = 0;
+	RecordCommand(a_list, NULL_COMMAND::BUILD_TOP_LEVEL_ACCELERATION_STRUCT, payload);
+}
+
+void Vulkan::StartRenderPass(const RCommandList a_list, const StartRenderingInfo& a_render_info)
+{
+	struct { uint2 extent; int2 offset; uint32_t color_count; uint32_t has_depth; } payload;
+	payload.extent = a_render_info.render_area_extent;
+	payload.offset = a_render_info.render_area_offset;
+	payload.color_count = static_cast<uint32_t>(a_render_info.color_attachments.size());
+	payload.has_depth = a_render_info.depth_attachment != nullptr;
+	RecordCommand(a_list, NULL_COMMAND::START_RENDER_PASS, payload);
+}
+
+void Vulkan::EndRenderPass(const RCommandList a_list)
+{
+	RecordCommand(a_list, NULL_COMMAND::END_RENDER_PASS, nullptr, 0);
+}
+
+void Vulkan::SetScissor(const RCommandList a_list, const ScissorInfo& a_scissor)
+{
+	RecordCommand(a_list, NULL_COMMAND::SET_SCISSOR, a_scissor);
+}
+
+void Vulkan::BindIndexBuffer(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset)
+{
+	const uint64_t payload[2]{ a_buffer.handle, a_offset };
+	RecordCommand(a_list, NULL_COMMAND::BIND_INDEX_BUFFER, payload);
+}
+
+void Vulkan::BindShaders(const RCommandList a_list, const uint32_t a_shader_stage_count, const SHADER_STAGE*, const ShaderObject* a_shader_objects)
+{
+	constexpr uint32_t MAX_SHADER_STAGES = 4;
+	BB_ASSERT(a_shader_stage_count <= MAX_SHADER_STAGES, "null renderer: too many shader stages");
+	uint64_t payload[MAX_SHADER_STAGES]{};
+	for (uint32_t i = 0; i < a_shader_stage_count; i++)
+		payload[i] = a_shader_objects[i].handle;
+	RecordCommand(a_list, NULL_COMMAND::BIND_SHADERS, payload, sizeof(uint64_t) * a_shader_stage_count);
+}
+
+void Vulkan::BindComputeShader(const RCommandList a_list, const ShaderObject a_shader_object)
+{
+	RecordCommand(a_list, NULL_COMMAND::BIND_COMPUTE_SHADER, a_shader_object.handle);
+}
+
+void Vulkan::SetBlendMode(const RCommandList a_list, const uint32_t a_first_attachment, const Slice<ColorBlendState> a_blend_states)
+{
+	const uint32_t payload[2]{ a_first_attachment, static_cast<uint32_t>(a_blend_states.size()) };
+	RecordCommand(a_list, NULL_COMMAND::SET_BLEND_MODE, payload);
+}
+
+void Vulkan::SetPrimitiveTopology(const RCommandList a_list, const PRIMITIVE_TOPOLOGY a_topology)
+{
+	RecordCommand(a_list, NULL_COMMAND::SET_PRIMITIVE_TOPOLOGY, static_cast<uint32_t>(a_topology));
+}
+
+void Vulkan::SetFrontFace(const RCommandList a_list, const bool a_is_clockwise)
+{
+	RecordCommand(a_list, NULL_COMMAND::SET_FRONT_FACE, static_cast<uint32_t>(a_is_clockwise));
+}
+
+void Vulkan::SetCullMode(const RCommandList a_list, const CULL_MODE a_cull_mode)
+{
+	RecordCommand(a_list, NULL_COMMAND::SET_CULL_MODE, static_cast<uint32_t>(a_cull_mode));
+}
+
+void Vulkan::SetDepthBias(const RCommandList a_list, const float a_bias_constant_factor, const float a_bias_clamp, const float a_bias_slope_factor)
+{
+	const float payload[3]{ a_bias_constant_factor, a_bias_clamp, a_bias_slope_factor };
+	RecordCommand(a_list, NULL_COMMAND::SET_DEPTH_BIAS, payload);
+}
+
+void Vulkan::SetDescriptorImmutableSamplers(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const bool a_compute_bind_point)
+{
+	const uint64_t payload[2]{ a_pipe_layout.handle, a_compute_bind_point };
+	RecordCommand(a_list, NULL_COMMAND::SET_DESCRIPTOR_IMMUTABLE_SAMPLERS, payload);
+}
+
+void Vulkan::SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t*, const size_t* a_offsets, const bool a_compute_bind_point)
+{
+	constexpr uint32_t MAX_SETS = 4;
+	BB_ASSERT(a_set_count <= MAX_SETS, "null renderer: too many descriptor sets");
+	struct { uint64_t pipe_layout; uint32_t first_set; uint32_t compute_bind_point; uint64_t offsets[MAX_SETS]; } payload;
+	payload.pipe_layout = a_pipe_layout.handle;
+	payload.first_set = a_first_set;
+	payload.compute_bind_point = a_compute_bind_point;
+	for (uint32_t i = 0; i < a_set_count; i++)
+		payload.offsets[i] = a_offsets[i];
+	RecordCommand(a_list, NULL_COMMAND::SET_DESCRIPTOR_BUFFER_OFFSET, &payload, offsetof(decltype(payload), offsets) + sizeof(uint64_t) * a_set_count);
+}
+
+void Vulkan::SetPushConstants(const RCommandList a_list, const RPipelineLayout, const uint32_t a_offset, const uint32_t a_size, const void* a_data)
+{
+	// the offset and then the data itself, these hold most of what a draw does.
+	constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 256;
+	BB_ASSERT(a_size <= MAX_PUSH_CONSTANT_SIZE && a_size % 4 == 0, "null renderer: invalid push constant size");
+	uint32_t payload[MAX_PUSH_CONSTANT_SIZE / 4 + 1];
+	payload[0] = a_offset;
+	memcpy(&payload[1], a_data, a_size);
+	RecordCommand(a_list, NULL_COMMAND::SET_PUSH_CONSTANTS, payload, sizeof(uint32_t) + a_size);
+}
+
+void Vulkan::DrawVertices(const RCommandList a_list, const uint32_t a_vertex_count, const uint32_t a_instance_count, const uint32_t a_first_vertex, const uint32_t a_first_instance)
+{
+	const uint32_t payload[4]{ a_vertex_count, a_instance_count, a_first_vertex, a_first_instance };
+	RecordCommand(a_list, NULL_COMMAND::DRAW_VERTICES, payload);
+}
+
+void Vulkan::DrawIndexed(const RCommandList a_list, const uint32_t a_index_count, const uint32_t a_instance_count, const uint32_t a_first_index, const int32_t a_vertex_offset, const uint32_t a_first_instance)
+{
+	const uint32_t payload[5]{ a_index_count, a_instance_count, a_first_index, static_cast<uint32_t>(a_vertex_offset), a_first_instance };
+	RecordCommand(a_list, NULL_COMMAND::DRAW_INDEXED, payload);
+}
+
+void Vulkan::DrawIndexedIndirect(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset, const uint32_t a_draw_count, const uint32_t a_stride)
+{
+	struct { uint64_t buffer; uint64_t offset; uint32_t draw_count; uint32_t stride; } payload{ a_buffer.handle, a_offset, a_draw_count, a_stride };
+	RecordCommand(a_list, NULL_COMMAND::DRAW_INDEXED_INDIRECT, payload);
+}
+
+void Vulkan::DispatchCompute(const RCommandList a_list, const uint32_t a_group_count_x, const uint32_t a_group_count_y, const uint32_t a_group_count_z)
+{
+	const uint32_t payload[3]{ a_group_count_x, a_group_count_y, a_group_count_z };
+	RecordCommand(a_list, NULL_COMMAND::DISPATCH_COMPUTE, payload);
+}
+
+PRESENT_IMAGE_RESULT Vulkan::UploadImageToSwapchain(const RCommandList a_list, const RImage a_src_image, const uint32_t a_array_layer, const int2 a_src_image_size, const int2, const uint32_t a_backbuffer_index)
+{
+	struct { uint64_t image; int2 src_size; uint32_t array_layer; uint32_t backbuffer_index; } payload{ a_src_image.handle, a_src_image_size, a_array_layer, a_backbuffer_index };
+	RecordCommand(a_list, NULL_COMMAND::UPLOAD_IMAGE_TO_SWAPCHAIN, payload);
+	return PRESENT_IMAGE_RESULT::SUCCESS;
+}
+
+void Vulkan::ExecuteCommandLists(const RQueue, const ExecuteCommandsInfo* a_execute_infos, const uint32_t a_execute_info_count)
+{
+	for (uint32_t i = 0; i < a_execute_info_count; i++)
+		SubmitCommandLists(a_execute_infos[i]);
+}
+
+PRESENT_IMAGE_RESULT Vulkan::ExecutePresentCommandList(const RQueue, const ExecuteCommandsInfo& a_execute_info, const uint32_t)
+{
+	SubmitCommandLists(a_execute_info);
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	++s_null_inst->stats.present_count;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return PRESENT_IMAGE_RESULT::SUCCESS;
+}
+
+RFence Vulkan::CreateFence(const uint64_t a_initial_value, const char*)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	BB_ASSERT(s_null_inst->fence_count < NULL_FENCE_MAX, "null renderer: too many fences");
+	const uint32_t index = s_null_inst->fence_count++;
+	s_null_inst->fences[index] = a_initial_value;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return RFence(index);
+}
+
+void Vulkan::FreeFence(const RFence)
+{
+}
+
+void Vulkan::WaitFence(const RFence a_fence, const GPUFenceValue a_fence_value)
+{
+	if (GetCurrentFenceValue(a_fence) < a_fence_value)
+	{
+		OSAcquireSRWLockWrite(&s_null_inst->lock);
+		++s_null_inst->stats.unsignaled_fence_waits;
+		OSReleaseSRWLockWrite(&s_null_inst->lock);
+	}
+}
+
+void Vulkan::WaitFences(const RFence* a_fences, const GPUFenceValue* a_fence_values, const uint32_t a_fence_count)
+{
+	for (uint32_t i = 0; i < a_fence_count; i++)
+		WaitFence(a_fences[i], a_fence_values[i]);
+}
+
+GPUFenceValue Vulkan::GetCurrentFenceValue(const RFence a_fence)
+{
+	BB_ASSERT(a_fence.handle < s_null_inst->fence_count, "null renderer: invalid fence");
+	return s_null_inst->fences[a_fence.handle].load(std::memory_order_relaxed);
+}
+
+RTimestampPool Vulkan::CreateTimestampPool(const uint32_t a_timestamp_count, const char*)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	BB_ASSERT(s_null_inst->timestamp_pool_count < NULL_TIMESTAMP_POOL_MAX, "null renderer: too many timestamp pools");
+	const uint32_t index = s_null_inst->timestamp_pool_count++;
+	s_null_inst->timestamp_pools[index].count = a_timestamp_count;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+	return RTimestampPool(index);
+}
+
+void Vulkan::FreeTimestampPool(const RTimestampPool)
+{
+}
+
+void Vulkan::ResetTimestamps(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count)
+{
+	BB_ASSERT(a_first + a_count <= s_null_inst->timestamp_pools[a_pool.handle].count, "null renderer: timestamp reset out of bounds");
+	const uint32_t payload[3]{ static_cast<uint32_t>(a_pool.handle), a_first, a_count };
+	RecordCommand(a_list, NULL_COMMAND::RESET_TIMESTAMPS, payload);
+}
+
+void Vulkan::WriteTimestamp(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_index)
+{
+	BB_ASSERT(a_index < s_null_inst->timestamp_pools[a_pool.handle].count, "null renderer: timestamp write out of bounds");
+	const uint32_t payload[2]{ static_cast<uint32_t>(a_pool.handle), a_index };
+	RecordCommand(a_list, NULL_COMMAND::WRITE_TIMESTAMP, payload);
+}
+
+bool Vulkan::ReadTimestamps(const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count, double* a_miliseconds)
+{
+	BB_ASSERT(a_first + a_count <= s_null_inst->timestamp_pools[a_pool.handle].count, "null renderer: timestamp read out of bounds");
+	// the work takes no time at all.
+	for (uint32_t i = 0; i < a_count; i++)
+		a_miliseconds[i] = 0.0;
+	return true;
+}
+
+RQueue Vulkan::GetQueue(const QUEUE_TYPE a_queue_type, const char*)
+{
+	return RQueue(static_cast<uint64_t>(a_queue_type));
+}
+
+const char* NullRenderer::NullCommandName(const NULL_COMMAND a_command)
+{
+	switch (a_command)
+	{
+	case NULL_COMMAND::SUBMIT:									return "SUBMIT";
+	case NULL_COMMAND::COPY_BUFFER:								return "COPY_BUFFER";
+	case NULL_COMMAND::COPY_IMAGE:								return "COPY_IMAGE";
+	case NULL_COMMAND::COPY_BUFFER_TO_IMAGE:					return "COPY_BUFFER_TO_IMAGE";
+	case NULL_COMMAND::COPY_IMAGE_TO_BUFFER:					return "COPY_IMAGE_TO_BUFFER";
+	case NULL_COMMAND::PIPELINE_BARRIERS:						return "PIPELINE_BARRIERS";
+	case NULL_COMMAND::CLEAR_IMAGE:								return "CLEAR_IMAGE";
+	case NULL_COMMAND::CLEAR_DEPTH_IMAGE:						return "CLEAR_DEPTH_IMAGE";
+	case NULL_COMMAND::BLIT_IMAGE:								return "BLIT_IMAGE";
+	case NULL_COMMAND::BUILD_BOTTOM_LEVEL_ACCELERATION_STRUCT:	return "BUILD_BOTTOM_LEVEL_ACCELERATION_STRUCT";
+	case NULL_COMMAND::BUILD_TOP_LEVEL_ACCELERATION_STRUCT:		return "BUILD_TOP_LEVEL_ACCELERATION_STRUCT";
+	case NULL_COMMAND::START_RENDER_PASS:						return "START_RENDER_PASS";
+	case NULL_COMMAND::END_RENDER_PASS:							return "END_RENDER_PASS";
+	case NULL_COMMAND::SET_SCISSOR:								return "SET_SCISSOR";
+	case NULL_COMMAND::BIND_INDEX_BUFFER:						return "BIND_INDEX_BUFFER";
+	case NULL_COMMAND::SET_PRIMITIVE_TOPOLOGY:					return "SET_PRIMITIVE_TOPOLOGY";
+	case NULL_COMMAND::BIND_SHADERS:							return "BIND_SHADERS";
+	case NULL_COMMAND::BIND_COMPUTE_SHADER:						return "BIND_COMPUTE_SHADER";
+	case NULL_COMMAND::SET_BLEND_MODE:							return "SET_BLEND_MODE";
+	case NULL_COMMAND::SET_FRONT_FACE:							return "SET_FRONT_FACE";
+	case NULL_COMMAND::SET_CULL_MODE:							return "SET_CULL_MODE";
+	case NULL_COMMAND::SET_DEPTH_BIAS:							return "SET_DEPTH_BIAS";
+	case NULL_COMMAND::SET_DESCRIPTOR_IMMUTABLE_SAMPLERS:		return "SET_DESCRIPTOR_IMMUTABLE_SAMPLERS";
+	case NULL_COMMAND::SET_DESCRIPTOR_BUFFER_OFFSET:			return "SET_DESCRIPTOR_BUFFER_OFFSET";
+	case NULL_COMMAND::SET_PUSH_CONSTANTS:						return "SET_PUSH_CONSTANTS";
+	case NULL_COMMAND::DRAW_VERTICES:							return "DRAW_VERTICES";
+	case NULL_COMMAND::DRAW_INDEXED:							return "DRAW_INDEXED";
+	case NULL_COMMAND::DRAW_INDEXED_INDIRECT:					return "DRAW_INDEXED_INDIRECT";
+	case NULL_COMMAND::DISPATCH_COMPUTE:						return "DISPATCH_COMPUTE";
+	case NULL_COMMAND::UPLOAD_IMAGE_TO_SWAPCHAIN:				return "UPLOAD_IMAGE_TO_SWAPCHAIN";
+	case NULL_COMMAND::RESET_TIMESTAMPS:						return "RESET_TIMESTAMPS";
+	case NULL_COMMAND::WRITE_TIMESTAMP:							return "WRITE_TIMESTAMP";
+	default:
+		BB_ASSERT(false, "null renderer: NULL_COMMAND has no name");
+		return "UNKNOWN";
+	}
+}
+
+void NullRenderer::SetCommandRecording(const bool a_record)
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	s_null_inst->record_commands = a_record;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+}
+
+ConstSlice<uint8_t> NullRenderer::GetRecordedCommands()
+{
+	return ConstSlice<uint8_t>(s_null_inst->recording.begin, s_null_inst->recording.size);
+}
+
+uint64_t NullRenderer::HashRecordedCommands()
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < s_null_inst->recording.size; i++)
+	{
+		hash ^= s_null_inst->recording.begin[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+void NullRenderer::ClearRecordedCommands()
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	s_null_inst->recording.size = 0;
+	s_null_inst->stats.recorded_size = 0;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+}
+
+bool NullRenderer::WriteRecordedCommands(const char* a_path)
+{
+	const OSFileHandle file = OSCreateFile(a_path);
+	if (!OSFileIsValid(file))
+		return false;
+
+	bool success = true;
+	const NullByteStream& recording = s_null_inst->recording;
+	size_t position = 0;
+	while (position < recording.size && success)
+	{
+		NullCommandHeader header;
+		memcpy(&header, recording.begin + position, sizeof(header));
+		position += sizeof(header);
+
+		// the name and then the payload as 32 bit words in hex.
+		char line[2048];
+		int line_size = snprintf(line, sizeof(line), "%s", NullCommandName(header.type));
+		for (uint32_t word = 0; word < header.payload_size / 4u && line_size < static_cast<int>(sizeof(line)) - 10; word++)
+		{
+			uint32_t value;
+			memcpy(&value, recording.begin + position + word * 4, sizeof(value));
+			line_size += snprintf(line + line_size, sizeof(line) - static_cast<size_t>(line_size), " %08x", value);
+		}
+		line[line_size++] = '\n';
+		success = OSWriteFile(file, line, static_cast<size_t>(line_size));
+		position += header.payload_size;
+	}
+
+	CloseOSFile(file);
+	return success;
+}
+
+NullRendererStats NullRenderer::GetStats()
+{
+	OSAcquireSRWLockRead(&s_null_inst->lock);
+	const NullRendererStats stats = s_null_inst->stats;
+	OSReleaseSRWLockRead(&s_null_inst->lock);
+	return stats;
+}
+
+void NullRenderer::ResetStats()
+{
+	OSAcquireSRWLockWrite(&s_null_inst->lock);
+	memset(s_null_inst->stats.command_counts, 0, sizeof(s_null_inst->stats.command_counts));
+	s_null_inst->stats.submit_count = 0;
+	s_null_inst->stats.present_count = 0;
+	s_null_inst->stats.unsignaled_fence_waits = 0;
+	OSReleaseSRWLockWrite(&s_null_inst->lock);
+}
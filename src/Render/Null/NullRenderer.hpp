@@ -0,0 +1,83 @@
+#pragma once
+#include "Common.h"
+#include "Slice.h"
+
+namespace BB
+{
+	// the null backend implements the functions of VulkanRenderer.hpp without a gpu when RENDERER_NULL_BACKEND is on.
+	// this is the extra api it has, to look at what the renderer would have sent to the gpu.
+	namespace NullRenderer
+	{
+		enum class NULL_COMMAND : uint16_t
+		{
+			SUBMIT,		// not a command, marks where the lists of one submit start.
+			COPY_BUFFER,
+			COPY_IMAGE,
+			COPY_BUFFER_TO_IMAGE,
+			COPY_IMAGE_TO_BUFFER,
+			PIPELINE_BARRIERS,
+			CLEAR_IMAGE,
+			CLEAR_DEPTH_IMAGE,
+			BLIT_IMAGE,
+			BUILD_BOTTOM_LEVEL_ACCELERATION_STRUCT,
+			BUILD_TOP_LEVEL_ACCELERATION_STRUCT,
+			START_RENDER_PASS,
+			END_RENDER_PASS,
+			SET_SCISSOR,
+			BIND_INDEX_BUFFER,
+			SET_PRIMITIVE_TOPOLOGY,
+			BIND_SHADERS,
+			BIND_COMPUTE_SHADER,
+			SET_BLEND_MODE,
+			SET_FRONT_FACE,
+			SET_CULL_MODE,
+			SET_DEPTH_BIAS,
+			SET_DESCRIPTOR_IMMUTABLE_SAMPLERS,
+			SET_DESCRIPTOR_BUFFER_OFFSET,
+			SET_PUSH_CONSTANTS,
+			DRAW_VERTICES,
+			DRAW_INDEXED,
+			DRAW_INDEXED_INDIRECT,
+			DISPATCH_COMPUTE,
+			UPLOAD_IMAGE_TO_SWAPCHAIN,
+			RESET_TIMESTAMPS,
+			WRITE_TIMESTAMP,
+
+			ENUM_SIZE
+		};
+
+		// every recorded command is a header followed by payload_size bytes, 4 byte aligned.
+		// handles and gpu addresses are indices that are the same every run, so 2 recordings of the same frames can be diffed.
+		struct NullCommandHeader
+		{
+			NULL_COMMAND type;
+			uint16_t payload_size;
+		};
+
+		struct NullRendererStats
+		{
+			uint64_t command_counts[static_cast<uint32_t>(NULL_COMMAND::ENUM_SIZE)];
+			uint64_t submit_count;
+			uint64_t present_count;
+			// waits on a value that was never submitted, a real gpu would hang or time out on these.
+			uint64_t unsignaled_fence_waits;
+			uint32_t buffer_count;
+			uint64_t buffer_memory;
+			uint64_t recorded_size;
+		};
+
+		const char* NullCommandName(const NULL_COMMAND a_command);
+
+		// off by default, the commands are only counted then.
+		void SetCommandRecording(const bool a_record);
+		// the commands of all submitted lists in submit order.
+		ConstSlice<uint8_t> GetRecordedCommands();
+		uint64_t HashRecordedCommands();
+		void ClearRecordedCommands();
+		// one command per line, so a text diff shows where 2 recordings differ.
+		bool WriteRecordedCommands(const char* a_path);
+
+		NullRendererStats GetStats();
+		void ResetStats();
+	}
+}
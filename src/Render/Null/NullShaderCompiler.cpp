@@ -0,0 +1,93 @@
+#include "ShaderCompiler.h"
+
+#include "Logger.h"
+#include "MemoryArena.hpp"
+#include "Program.h"
+
+using namespace BB;
+
+// built instead of the DXC ShaderCompiler.cpp when RENDERER_NULL_BACKEND is on, DXC only ships for windows.
+// nothing is compiled, the source is handed on as the shader code. The null backend only checks that a shader has code.
+
+constexpr uint32_t NULL_SHADER_CODE_MAX = 256;
+
+struct NullShaderCompiler_inst;
+
+struct NullShaderCode
+{
+	NullShaderCompiler_inst* compiler;
+	Buffer code;
+	NullShaderCode* next_free;
+};
+
+struct NullShaderCompiler_inst
+{
+	BBRWLock lock;
+	NullShaderCode codes[NULL_SHADER_CODE_MAX];
+	NullShaderCode* free_list;
+};
+
+ShaderCompiler BB::CreateShaderCompiler(MemoryArena& a_arena)
+{
+	NullShaderCompiler_inst* inst = ArenaAllocType(a_arena, NullShaderCompiler_inst);
+	inst->lock = OSCreateRWLock();
+	inst->free_list = nullptr;
+	for (uint32_t i = NULL_SHADER_CODE_MAX; i-- > 0;)
+	{
+		inst->codes[i].compiler = inst;
+		inst->codes[i].next_free = inst->free_list;
+		inst->free_list = &inst->codes[i];
+	}
+
+	return ShaderCompiler(reinterpret_cast<uintptr_t>(inst));
+}
+
+void BB::DestroyShaderCompiler(const ShaderCompiler a_shader_compiler)
+{
+	(void)a_shader_compiler;
+}
+
+bool BB::CompileShader(const ShaderCompiler a_shader_compiler, const Buffer& a_buffer, const char* a_entry, const SHADER_STAGE a_shader_stage, ShaderCode& a_out_shader_code)
+{
+	(void)a_entry;
+	(void)a_shader_stage;
+	NullShaderCompiler_inst* inst = reinterpret_cast<NullShaderCompiler_inst*>(a_shader_compiler.handle);
+	if (a_buffer.data == nullptr || a_buffer.size == 0)
+	{
+		BB_WARNING(false, "null shader compiler: no shader source", WarningType::HIGH);
+		return false;
+	}
+
+	OSAcquireSRWLockWrite(&inst->lock);
+	NullShaderCode* code = inst->free_list;
+	if (code != nullptr)
+		inst->free_list = code->next_free;
+	OSReleaseSRWLockWrite(&inst->lock);
+
+	if (code == nullptr)
+	{
+		BB_WARNING(false, "null shader compiler: too many shader codes alive, release them after creating the shader objects", WarningType::HIGH);
+		return false;
+	}
+
+	code->code = a_buffer;
+	a_out_shader_code = ShaderCode(reinterpret_cast<uintptr_t>(code));
+	return true;
+}
+
+void BB::ReleaseShaderCode(const ShaderCode a_handle)
+{
+	NullShaderCode* code = reinterpret_cast<NullShaderCode*>(a_handle.handle);
+	NullShaderCompiler_inst* inst = code->compiler;
+	code->code = {};
+
+	OSAcquireSRWLockWrite(&inst->lock);
+	code->next_free = inst->free_list;
+	inst->free_list = code;
+	OSReleaseSRWLockWrite(&inst->lock);
+}
+
+Buffer BB::GetShaderCodeBuffer(const ShaderCode a_handle)
+{
+	return reinterpret_cast<NullShaderCode*>(a_handle.handle)->code;
+}
@@ -3,6 +3,7 @@
 
 #include "Storage/Slotmap.h"
 #include "Storage/Queue.hpp"
+#include "Storage/ConcurrentPool.h"
 #include "Program.h"
 
 #include "ShaderCompiler.h"
@@ -93,33 +94,23 @@ class GPUTextureManager
 public:
 	void Init(MemoryArena& a_arena)
 	{
-		m_views = ArenaAllocArr(a_arena, RImageView, MAX_TEXTURES);
-		m_next_free = 0;
-		m_lock = OSCreateRWLock();
-
-		// setup the freelist before making the debug texture
-		for (uint32_t i = m_next_free; i < MAX_TEXTURES - 1; i++)
-		{
-			m_views[i].index = i + 1;
-		}
-		m_views[MAX_TEXTURES - 1].index = UINT32_MAX;
+		// the debug texture is made first, so it gets slot 0.
+		m_views.CreatePool(a_arena, MAX_TEXTURES);
 	}
 
 	void SetAllTextures(const RDescriptorIndex a_descriptor_index, const RDescriptorLayout a_global_layout, const DescriptorAllocation& a_allocation) const;
 
 	const RDescriptorIndex AllocAndWriteImageView(const ImageViewCreateInfo& a_info, const RDescriptorLayout a_global_layout, const DescriptorAllocation& a_allocation)
 	{
-		OSAcquireSRWLockWrite(&m_lock);
-		const uint32_t descriptor_index = m_next_free;
-		m_next_free = m_views[descriptor_index].index;
-		OSReleaseSRWLockWrite(&m_lock);
-
-		m_views[descriptor_index] =  Vulkan::CreateImageView(a_info);
+		RImageView* view = m_views.Get();
+		BB_ASSERT(view, "out of bindless texture slots");
+		const uint32_t descriptor_index = m_views.IndexOf(view);
+		*view = Vulkan::CreateImageView(a_info);
 
 		DescriptorWriteImageInfo write_info;
 		write_info.binding = GLOBAL_BINDLESS_TEXTURES_BINDING;
 		write_info.descriptor_index = descriptor_index;
-		write_info.view = m_views[descriptor_index];
+		write_info.view = *view;
 		write_info.layout = IMAGE_LAYOUT::RO_FRAGMENT;
 		write_info.allocation = a_allocation;
 		write_info.descriptor_layout = a_global_layout;
@@ -133,7 +124,7 @@ public:
 
 	const RImageView GetImageView(const RDescriptorIndex a_index) const
 	{
-		return m_views[a_index.handle];
+		return m_views.At(a_index.handle);
 	}
 
 	void DisplayTextureListImgui()
@@ -141,16 +132,6 @@ public:
 		if (ImGui::CollapsingHeader("Texture Manager"))
 		{
 			ImGui::Indent();
-			if (ImGui::CollapsingHeader("next free image slot"))
-			{
-				ImGui::Indent();
-				ImGui::Text("RImageView index: %u", m_next_free);
-				const ImVec2 image_size = { 160, 160 };
-
-				ImGui::Image(m_next_free, image_size);
-				ImGui::Unindent();
-			}
-
 			for (uint32_t i = 0; i < MAX_TEXTURES; i++)
 			{
 				const size_t id = i;
@@ -170,9 +151,8 @@ public:
 	}
 
 private:
-	uint32_t m_next_free;
-	RImageView* m_views;
-	BBRWLock m_lock;
+	// lock free, textures are made and freed from the asset loading threads.
+	ConcurrentPool<RImageView> m_views;
 };
 
 RCommandList CommandPool::StartCommandList(const char* a_name)
@@ -410,6 +390,27 @@ struct ShaderEffect
 };
 
 constexpr uint32_t BACK_BUFFER_MAX = 3;
+// max allocations + free regions in the vertex or index buffer.
+constexpr uint32_t GEOMETRY_ALLOCATION_MAX = 16384;
+
+// the gpu only vertex and index buffers, sub allocated with an OffsetAllocator so that meshes can be freed.
+struct GeometryBuffer
+{
+	GPUBuffer buffer;
+	GPUAddress address;
+	uint64_t size;
+
+	BBRWLock lock;
+	OffsetAllocator allocator;
+
+	// freed space is only reused after the gpu is done with the frames that could still read it.
+	struct PendingFree
+	{
+		OffsetAllocation allocation;
+		GPUFenceValue fence_value;
+	};
+	StaticArray<PendingFree> pending_frees;
+};
 
 struct RenderInterface_inst
 {
@@ -422,6 +423,7 @@ struct RenderInterface_inst
 	struct Status
 	{
 		uint32_t frame_index;
+		uint64_t frame_number;
 		bool frame_started;
 		bool frame_ended;
 	} status;
@@ -429,6 +431,7 @@ struct RenderInterface_inst
 	struct Frame
 	{
 		uint64_t graphics_queue_fence_value;
+		uint64_t compute_queue_fence_value;
 	};
 	uint32_t frame_count;
 	Frame* frames;
@@ -457,13 +460,7 @@ struct RenderInterface_inst
 		void* mapped;
 	} global_buffer;
 
-	struct VertexBuffer
-	{
-		GPUBuffer buffer;
-        GPUAddress address;
-		uint64_t size;
-		std::atomic<uint64_t> used;
-	} vertex_buffer;
+	GeometryBuffer vertex_buffer;
 	struct CPUVertexBuffer
 	{
 		GPUBuffer buffer;
@@ -473,13 +470,7 @@ struct RenderInterface_inst
 		void* start_mapped;
 	} cpu_vertex_buffer;
 
-	struct IndexBuffer
-	{
-		GPUBuffer buffer;
-        GPUAddress address;
-		uint64_t size;
-		std::atomic<uint64_t> used;
-	} index_buffer;
+	GeometryBuffer index_buffer;
 	struct CPUIndexBuffer
 	{
 		GPUBuffer buffer;
@@ -511,11 +502,8 @@ void GPUTextureManager::SetAllTextures(const RDescriptorIndex a_descriptor_index
 
 void GPUTextureManager::FreeImageView(const RDescriptorIndex a_descriptor_index, const RDescriptorLayout a_global_layout, const DescriptorAllocation& a_allocation)
 {
-	OSAcquireSRWLockWrite(&m_lock);
-	Vulkan::FreeViewImage(m_views[a_descriptor_index.handle]);
-	m_views[a_descriptor_index.handle].index = m_next_free;
-	m_next_free = m_views[a_descriptor_index.handle].index;
-	OSReleaseSRWLockWrite(&m_lock);
+	RImageView& view = m_views.At(a_descriptor_index.handle);
+	Vulkan::FreeViewImage(view);
 
 	DescriptorWriteImageInfo write_info;
 	write_info.binding = GLOBAL_BINDLESS_TEXTURES_BINDING;
@@ -526,6 +514,30 @@ void GPUTextureManager::FreeImageView(const RDescriptorIndex a_descriptor_index,
 	write_info.descriptor_layout = a_global_layout;
 
 	DescriptorWriteImage(write_info);
+	// only reuse the slot after the debug texture is written to it, else it could overwrite a new texture in that slot.
+	m_views.Free(&view);
+}
+
+static void ImguiDisplayGeometryBuffer(const char* a_name, GeometryBuffer& a_buffer)
+{
+	OffsetAllocatorReport report;
+	uint32_t pending_free_count;
+	{
+		BBRWLockScopeWrite lock(a_buffer.lock);
+		report = a_buffer.allocator.GetReport();
+		pending_free_count = static_cast<uint32_t>(a_buffer.pending_frees.size());
+	}
+
+	if (ImGui::TreeNode(a_name))
+	{
+		const float used = static_cast<float>(a_buffer.size - report.total_free);
+		ImGui::ProgressBar(used / static_cast<float>(a_buffer.size));
+		ImGui::Text("allocations: %u", report.allocation_count);
+		ImGui::Text("free: %u bytes in %u regions", report.total_free, report.free_region_count);
+		ImGui::Text("largest free region: %u bytes", report.largest_free);
+		ImGui::Text("pending frees: %u", pending_free_count);
+		ImGui::TreePop();
+	}
 }
 
 static void ImguiDisplayRenderer()
@@ -534,30 +546,145 @@ static void ImguiDisplayRenderer()
 	{
 		s_render_inst->texture_manager.DisplayTextureListImgui();
 		ImGui::InputFloat("gamma", &s_render_inst->global_buffer.data.gamma);
+		ImguiDisplayGeometryBuffer("vertex buffer", s_render_inst->vertex_buffer);
+		ImguiDisplayGeometryBuffer("index buffer", s_render_inst->index_buffer);
 	}
 	ImGui::End();
 }
 
-GPUBufferView BB::AllocateFromVertexBuffer(const size_t a_size_in_bytes)
+static GPUBufferView AllocateFromGeometryBuffer(GeometryBuffer& a_buffer, const size_t a_size_in_bytes, OffsetAllocation& a_out_allocation)
 {
+	{
+		BBRWLockScopeWrite lock(a_buffer.lock);
+		a_out_allocation = a_buffer.allocator.Allocate(static_cast<uint32_t>(a_size_in_bytes));
+	}
+	BB_ASSERT(a_out_allocation.IsValid(), "out of geometry buffer space!");
+
 	GPUBufferView view;
-	view.buffer = s_render_inst->vertex_buffer.buffer;
+	view.buffer = a_buffer.buffer;
 	view.size = a_size_in_bytes;
-	view.offset = s_render_inst->vertex_buffer.used.fetch_add(a_size_in_bytes);
-
-	BB_ASSERT(s_render_inst->vertex_buffer.size > view.offset + a_size_in_bytes, "out of vertex buffer space!");
+	view.offset = a_out_allocation.offset;
 	return view;
 }
 
+static void ReleasePendingFrees(GeometryBuffer& a_buffer, const GPUFenceValue a_completed_value)
+{
+	BBRWLockScopeWrite lock(a_buffer.lock);
+	size_t i = 0;
+	while (i < a_buffer.pending_frees.size())
+	{
+		if (a_buffer.pending_frees[i].fence_value <= a_completed_value)
+		{
+			a_buffer.allocator.Free(a_buffer.pending_frees[i].allocation);
+			a_buffer.pending_frees[i] = a_buffer.pending_frees[a_buffer.pending_frees.size() - 1];
+			a_buffer.pending_frees.pop();
+		}
+		else
+			++i;
+	}
+}
+
+static void FreeFromGeometryBuffer(GeometryBuffer& a_buffer, const OffsetAllocation a_allocation)
+{
+	GeometryBuffer::PendingFree pending_free;
+	pending_free.allocation = a_allocation;
+	// the frame that is being recorded signals this value or higher.
+	pending_free.fence_value = s_render_inst->graphics_queue.GetNextFenceValue();
+
+	{
+		BBRWLockScopeWrite lock(a_buffer.lock);
+		if (!a_buffer.pending_frees.IsFull())
+		{
+			a_buffer.pending_frees.push_back(pending_free);
+			return;
+		}
+	}
+
+	// every pending free still holds an allocator node, so this only happens when the queue is made smaller than the allocator.
+	BB_WARNING(false, "geometry buffer pending frees are full, waiting for the gpu", WarningType::HIGH);
+	const GPUFenceValue submitted_value = s_render_inst->graphics_queue.GetNextFenceValue() - 1;
+	s_render_inst->graphics_queue.WaitFenceValue(submitted_value);
+	ReleasePendingFrees(a_buffer, submitted_value);
+
+	BBRWLockScopeWrite lock(a_buffer.lock);
+	if (a_buffer.pending_frees.IsFull())
+	{
+		// the frame that is being recorded may still use it, keeping it allocated is the only safe option.
+		BB_WARNING(false, "geometry buffer pending frees are full with frees of this frame, the allocation is not freed", WarningType::HIGH);
+		return;
+	}
+	a_buffer.pending_frees.push_back(pending_free);
+}
+
+static bool RelocateInGeometryBuffer(const RCommandList a_list, GeometryBuffer& a_buffer, OffsetAllocation& a_allocation)
+{
+	OffsetAllocation new_allocation;
+	uint32_t size;
+	{
+		BBRWLockScopeWrite lock(a_buffer.lock);
+		new_allocation = a_buffer.allocator.AllocateLower(a_allocation);
+		size = a_buffer.allocator.GetAllocationSize(a_allocation);
+	}
+	if (!new_allocation.IsValid())
+		return false;
+
+	// the old space is still allocated until the pending free is released, so the regions never overlap.
+	RenderCopyBufferRegion region;
+	region.size = size;
+	region.src_offset = a_allocation.offset;
+	region.dst_offset = new_allocation.offset;
+
+	RenderCopyBuffer copy_info;
+	copy_info.src = a_buffer.buffer;
+	copy_info.dst = a_buffer.buffer;
+	copy_info.regions = Slice(&region, 1);
+	Vulkan::CopyBuffer(a_list, copy_info);
+
+	FreeFromGeometryBuffer(a_buffer, a_allocation);
+	a_allocation = new_allocation;
+	return true;
+}
+
+GPUBufferView BB::AllocateFromVertexBuffer(const size_t a_size_in_bytes)
+{
+	OffsetAllocation allocation;
+	return AllocateFromGeometryBuffer(s_render_inst->vertex_buffer, a_size_in_bytes, allocation);
+}
+
 GPUBufferView BB::AllocateFromIndexBuffer(const size_t a_size_in_bytes)
 {
-	GPUBufferView view;
-	view.buffer = s_render_inst->index_buffer.buffer;
-	view.size = a_size_in_bytes;
-	view.offset = s_render_inst->index_buffer.used.fetch_add(a_size_in_bytes);
+	OffsetAllocation allocation;
+	return AllocateFromGeometryBuffer(s_render_inst->index_buffer, a_size_in_bytes, allocation);
+}
 
-	BB_ASSERT(s_render_inst->index_buffer.size > view.offset + a_size_in_bytes, "out of index buffer space!");
-	return view;
+GPUBufferView BB::AllocateFromVertexBuffer(const size_t a_size_in_bytes, OffsetAllocation& a_out_allocation)
+{
+	return AllocateFromGeometryBuffer(s_render_inst->vertex_buffer, a_size_in_bytes, a_out_allocation);
+}
+
+GPUBufferView BB::AllocateFromIndexBuffer(const size_t a_size_in_bytes, OffsetAllocation& a_out_allocation)
+{
+	return AllocateFromGeometryBuffer(s_render_inst->index_buffer, a_size_in_bytes, a_out_allocation);
+}
+
+void BB::FreeFromVertexBuffer(const OffsetAllocation a_allocation)
+{
+	FreeFromGeometryBuffer(s_render_inst->vertex_buffer, a_allocation);
+}
+
+void BB::FreeFromIndexBuffer(const OffsetAllocation a_allocation)
+{
+	FreeFromGeometryBuffer(s_render_inst->index_buffer, a_allocation);
+}
+
+bool BB::RelocateInVertexBuffer(const RCommandList a_list, OffsetAllocation& a_allocation)
+{
+	return RelocateInGeometryBuffer(a_list, s_render_inst->vertex_buffer, a_allocation);
+}
+
+bool BB::RelocateInIndexBuffer(const RCommandList a_list, OffsetAllocation& a_allocation)
+{
+	return RelocateInGeometryBuffer(a_list, s_render_inst->index_buffer, a_allocation);
 }
 
 void BB::CopyToVertexBuffer(const RCommandList a_list, const GPUBuffer a_src, const Slice<RenderCopyBufferRegion> a_regions)
@@ -723,7 +850,7 @@ static GPUBuffer UploadStartupResources()
 	UnmapGPUBuffer(upload_buffer);
 
 	uint64_t a_out_fence_value;
-	const bool success = ExecuteGraphicCommands(Slice(&pool, 1), nullptr, nullptr, 0, a_out_fence_value);
+	const bool success = ExecuteGraphicCommands(Slice(&pool, 1), nullptr, nullptr, 0, nullptr, nullptr, 0, a_out_fence_value);
 	BB_ASSERT(success, "failed to upload base resources");
 
 	return upload_buffer;
@@ -735,6 +862,7 @@ bool BB::InitializeRenderer(MemoryArena& a_arena, const RendererCreateInfo& a_re
 	s_render_inst = ArenaAllocType(a_arena, RenderInterface_inst)(a_arena);
 	s_render_inst->frame_count = BACK_BUFFER_MAX;
 	s_render_inst->status.frame_index = 0;
+	s_render_inst->status.frame_number = 0;
 	s_render_inst->frames = ArenaAllocArr(a_arena, RenderInterface_inst::Frame, BACK_BUFFER_MAX);
 	Vulkan::CreateSwapchain(a_arena, a_render_create_info.window_handle, a_render_create_info.swapchain_width, a_render_create_info.swapchain_height, s_render_inst->frame_count);
 
@@ -789,7 +917,7 @@ bool BB::InitializeRenderer(MemoryArena& a_arena, const RendererCreateInfo& a_re
 
 			descriptor_bindings[3].binding = GLOBAL_BINDLESS_TEXTURES_BINDING;
 			descriptor_bindings[3].count = MAX_TEXTURES;
-			descriptor_bindings[3].shader_stage = SHADER_STAGE::FRAGMENT_PIXEL;
+			descriptor_bindings[3].shader_stage = SHADER_STAGE::ALL;
 			descriptor_bindings[3].type = DESCRIPTOR_TYPE::IMAGE;
 
 			s_render_inst->global_descriptor_set = Vulkan::CreateDescriptorLayout(a_arena, descriptor_bindings.const_slice());
@@ -820,7 +948,9 @@ bool BB::InitializeRenderer(MemoryArena& a_arena, const RendererCreateInfo& a_re
 		s_render_inst->vertex_buffer.buffer = Vulkan::CreateBuffer(vertex_buffer);
         s_render_inst->vertex_buffer.address = Vulkan::GetBufferAddress(s_render_inst->vertex_buffer.buffer);
 		s_render_inst->vertex_buffer.size = static_cast<uint32_t>(vertex_buffer.size);
-		s_render_inst->vertex_buffer.used = 0;
+		s_render_inst->vertex_buffer.lock = OSCreateRWLock();
+		s_render_inst->vertex_buffer.allocator.Init(a_arena, static_cast<uint32_t>(vertex_buffer.size), GEOMETRY_ALLOCATION_MAX);
+		s_render_inst->vertex_buffer.pending_frees.Init(a_arena, GEOMETRY_ALLOCATION_MAX);
 
 		vertex_buffer.host_writable = true;
 		s_render_inst->cpu_vertex_buffer.buffer = Vulkan::CreateBuffer(vertex_buffer);
@@ -873,7 +1003,9 @@ bool BB::InitializeRenderer(MemoryArena& a_arena, const RendererCreateInfo& a_re
 		s_render_inst->index_buffer.buffer = Vulkan::CreateBuffer(index_buffer);
         s_render_inst->index_buffer.address = Vulkan::GetBufferAddress(s_render_inst->index_buffer.buffer);
 		s_render_inst->index_buffer.size = static_cast<uint32_t>(index_buffer.size);
-		s_render_inst->index_buffer.used = 0;
+		s_render_inst->index_buffer.lock = OSCreateRWLock();
+		s_render_inst->index_buffer.allocator.Init(a_arena, static_cast<uint32_t>(index_buffer.size), GEOMETRY_ALLOCATION_MAX);
+		s_render_inst->index_buffer.pending_frees.Init(a_arena, GEOMETRY_ALLOCATION_MAX);
 
 		index_buffer.host_writable = true;
 		s_render_inst->cpu_index_buffer.buffer = Vulkan::CreateBuffer(index_buffer);
@@ -918,15 +1050,25 @@ uint32_t BB::GetBackBufferCount()
 	return s_render_inst->frame_count;
 }
 
+uint64_t BB::GetFrameNumber()
+{
+	return s_render_inst->status.frame_number;
+}
+
 void BB::RenderStartFrame(const RCommandList a_list, const RenderStartFrameInfo& a_info, const RImage a_render_target, uint32_t& a_back_buffer_index)
 {
 	BB_ASSERT(s_render_inst->status.frame_started == false, "did not call RenderEndFrame before a new RenderStartFrame");
 	s_render_inst->status.frame_started = true;
+	++s_render_inst->status.frame_number;
 
 	const uint32_t frame_index = s_render_inst->status.frame_index;
 	const RenderInterface_inst::Frame& cur_frame = s_render_inst->frames[frame_index];
 
 	s_render_inst->graphics_queue.WaitFenceValue(cur_frame.graphics_queue_fence_value);
+	// the compute work of that frame is usually done as well, this only recycles its command pools.
+	s_render_inst->compute_queue.WaitFenceValue(cur_frame.compute_queue_fence_value);
+	ReleasePendingFrees(s_render_inst->vertex_buffer, cur_frame.graphics_queue_fence_value);
+	ReleasePendingFrees(s_render_inst->index_buffer, cur_frame.graphics_queue_fence_value);
 
 	{
 		PipelineBarrierImageInfo image_transitions[1]{};
@@ -1042,11 +1184,22 @@ RPipelineLayout BB::BindShaders(const RCommandList a_list, const ShaderEffectHan
 
 	Vulkan::BindShaders(a_list, UNIQUE_SHADER_STAGE_COUNT, CONSEQUTIVE_SHADER_STAGES, shader_objects);
 	// set the samplers
-	Vulkan::SetDescriptorImmutableSamplers(a_list, layout);
+	Vulkan::SetDescriptorImmutableSamplers(a_list, layout, false);
 
 	return layout;
 }
 
+RPipelineLayout BB::BindComputeShader(const RCommandList a_list, const ShaderEffectHandle a_compute)
+{
+	const ShaderEffect& effect = s_render_inst->shader_effects[a_compute];
+	BB_ASSERT(effect.shader_stage == SHADER_STAGE::COMPUTE, "binding a shader that is not a compute shader");
+
+	Vulkan::BindComputeShader(a_list, effect.shader_object);
+	Vulkan::SetDescriptorImmutableSamplers(a_list, effect.pipeline_layout, true);
+
+	return effect.pipeline_layout;
+}
+
 void BB::SetBlendMode(const RCommandList a_list, const uint32_t a_first_attachment, const Slice<ColorBlendState> a_blend_states)
 {
 	Vulkan::SetBlendMode(a_list, a_first_attachment, a_blend_states);
@@ -1092,6 +1245,16 @@ void BB::DrawIndexed(const RCommandList a_list, const uint32_t a_index_count, co
 	Vulkan::DrawIndexed(a_list, a_index_count, a_instance_count, a_first_index, a_vertex_offset, a_first_instance);
 }
 
+void BB::DrawIndexedIndirect(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset, const uint32_t a_draw_count, const uint32_t a_stride)
+{
+	Vulkan::DrawIndexedIndirect(a_list, a_buffer, a_offset, a_draw_count, a_stride);
+}
+
+void BB::DispatchCompute(const RCommandList a_list, const uint32_t a_group_count_x, const uint32_t a_group_count_y, const uint32_t a_group_count_z)
+{
+	Vulkan::DispatchCompute(a_list, a_group_count_x, a_group_count_y, a_group_count_z);
+}
+
 CommandPool& BB::GetGraphicsCommandPool()
 {
 	return s_render_inst->graphics_queue.GetCommandPool();
@@ -1102,12 +1265,12 @@ CommandPool& BB::GetTransferCommandPool()
 	return s_render_inst->transfer_queue.GetCommandPool();
 }
 
-CommandPool& BB::GetCommandCommandPool()
+CommandPool& BB::GetComputeCommandPool()
 {
 	return s_render_inst->compute_queue.GetCommandPool();
 }
 
-PRESENT_IMAGE_RESULT BB::PresentFrame(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value, const bool a_skip)
+PRESENT_IMAGE_RESULT BB::PresentFrame(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value, const bool a_skip)
 {
 	if (a_skip)
 	{
@@ -1136,9 +1299,10 @@ PRESENT_IMAGE_RESULT BB::PresentFrame(const BB::Slice<CommandPool> a_cmd_pools,
 
 	//set the next fence value for the frame
 	s_render_inst->graphics_queue.ReturnPools(a_cmd_pools);
-	const PRESENT_IMAGE_RESULT result = s_render_inst->graphics_queue.ExecutePresentCommands(lists, list_count, a_signal_fences, a_signal_values, a_signal_count, nullptr, nullptr, 0, s_render_inst->status.frame_index, a_out_present_fence_value);
+	const PRESENT_IMAGE_RESULT result = s_render_inst->graphics_queue.ExecutePresentCommands(lists, list_count, a_signal_fences, a_signal_values, a_signal_count, a_wait_fences, a_wait_values, a_wait_count, s_render_inst->status.frame_index, a_out_present_fence_value);
 	s_render_inst->status.frame_index = (s_render_inst->status.frame_index + 1) % s_render_inst->frame_count;
 	s_render_inst->frames[s_render_inst->status.frame_index].graphics_queue_fence_value = a_out_present_fence_value;
+	s_render_inst->frames[s_render_inst->status.frame_index].compute_queue_fence_value = s_render_inst->compute_queue.GetNextFenceValue() - 1;
 
 	s_render_inst->status.frame_ended = false;
 	s_render_inst->status.frame_started = false;
@@ -1146,7 +1310,7 @@ PRESENT_IMAGE_RESULT BB::PresentFrame(const BB::Slice<CommandPool> a_cmd_pools,
 	return result;
 }
 
-static bool ExecuteQueueCommands(RenderQueue& a_queue, const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value)
+static bool ExecuteQueueCommands(RenderQueue& a_queue, const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value)
 {
 	uint32_t list_count = 0;
 	for (size_t i = 0; i < a_cmd_pools.size(); i++)
@@ -1163,23 +1327,23 @@ static bool ExecuteQueueCommands(RenderQueue& a_queue, const BB::Slice<CommandPo
 	}
 
 	a_queue.ReturnPools(a_cmd_pools);
-	a_queue.ExecuteCommands(lists, list_count, a_signal_fences, a_signal_values, a_signal_count, nullptr, nullptr, 0, a_out_present_fence_value);
+	a_queue.ExecuteCommands(lists, list_count, a_signal_fences, a_signal_values, a_signal_count, a_wait_fences, a_wait_values, a_wait_count, a_out_present_fence_value);
 	return true;
 }
 
-bool BB::ExecuteGraphicCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value)
+bool BB::ExecuteGraphicCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value)
 {
-	return ExecuteQueueCommands(s_render_inst->graphics_queue, a_cmd_pools, a_signal_fences, a_signal_values, a_signal_count, a_out_present_fence_value);
+	return ExecuteQueueCommands(s_render_inst->graphics_queue, a_cmd_pools, a_signal_fences, a_signal_values, a_signal_count, a_wait_fences, a_wait_values, a_wait_count, a_out_present_fence_value);
 }
 
-bool BB::ExecuteTransferCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value)
+bool BB::ExecuteTransferCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value)
 {
-	return ExecuteQueueCommands(s_render_inst->transfer_queue, a_cmd_pools, a_signal_fences, a_signal_values, a_signal_count, a_out_present_fence_value);
+	return ExecuteQueueCommands(s_render_inst->transfer_queue, a_cmd_pools, a_signal_fences, a_signal_values, a_signal_count, a_wait_fences, a_wait_values, a_wait_count, a_out_present_fence_value);
 }
 
-bool BB::ExecuteComputeCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value)
+bool BB::ExecuteComputeCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value)
 {
-	return ExecuteQueueCommands(s_render_inst->compute_queue, a_cmd_pools, a_signal_fences, a_signal_values, a_signal_count, a_out_present_fence_value);
+	return ExecuteQueueCommands(s_render_inst->compute_queue, a_cmd_pools, a_signal_fences, a_signal_values, a_signal_count, a_wait_fences, a_wait_values, a_wait_count, a_out_present_fence_value);
 }
 
 RDescriptorLayout BB::CreateDescriptorLayout(MemoryArena& a_temp_arena, const ConstSlice<DescriptorBindingInfo> a_bindings)
@@ -1334,6 +1498,31 @@ void BB::FreeImageViewShaderInaccessible(const RImageView a_view)
 	Vulkan::FreeViewImage(a_view);
 }
 
+GPUMemoryRequirements BB::GetImageMemoryRequirements(const ImageCreateInfo& a_create_info)
+{
+	return Vulkan::GetImageMemoryRequirements(a_create_info);
+}
+
+RMemoryHeap BB::CreateMemoryHeap(const char* a_name, const GPUMemoryRequirements& a_requirements)
+{
+	return Vulkan::CreateMemoryHeap(a_name, a_requirements);
+}
+
+void BB::FreeMemoryHeap(const RMemoryHeap a_heap)
+{
+	Vulkan::FreeMemoryHeap(a_heap);
+}
+
+const RImage BB::CreateAliasedImage(const ImageCreateInfo& a_create_info, const RMemoryHeap a_heap, const uint64_t a_heap_offset)
+{
+	return Vulkan::CreateAliasedImage(a_create_info, a_heap, a_heap_offset);
+}
+
+void BB::FreeAliasedImage(const RImage a_image)
+{
+	Vulkan::FreeAliasedImage(a_image);
+}
+
 void BB::ClearImage(const RCommandList a_list, const ClearImageInfo& a_clear_info)
 {
 	Vulkan::ClearImage(a_list, a_clear_info);
@@ -1485,6 +1674,31 @@ GPUFenceValue BB::GetCurrentFenceValue(const RFence a_fence)
 	return Vulkan::GetCurrentFenceValue(a_fence);
 }
 
+RTimestampPool BB::CreateTimestampPool(const uint32_t a_timestamp_count, const char* a_name)
+{
+	return Vulkan::CreateTimestampPool(a_timestamp_count, a_name);
+}
+
+void BB::FreeTimestampPool(const RTimestampPool a_pool)
+{
+	Vulkan::FreeTimestampPool(a_pool);
+}
+
+void BB::ResetTimestamps(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count)
+{
+	Vulkan::ResetTimestamps(a_list, a_pool, a_first, a_count);
+}
+
+void BB::WriteTimestamp(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_index)
+{
+	Vulkan::WriteTimestamp(a_list, a_pool, a_index);
+}
+
+bool BB::ReadTimestamps(const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count, double* a_miliseconds)
+{
+	return Vulkan::ReadTimestamps(a_pool, a_first, a_count, a_miliseconds);
+}
+
 void BB::SetPushConstants(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_offset, const uint32_t a_size, const void* a_data)
 {
 	Vulkan::SetPushConstants(a_list, a_pipe_layout, a_offset, a_size, a_data);
@@ -1497,7 +1711,12 @@ void BB::PipelineBarriers(const RCommandList a_list, const PipelineBarrierInfo&
 
 void BB::SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets)
 {
-	Vulkan::SetDescriptorBufferOffset(a_list, a_pipe_layout, a_first_set, a_set_count, a_buffer_indices, a_offsets);
+	Vulkan::SetDescriptorBufferOffset(a_list, a_pipe_layout, a_first_set, a_set_count, a_buffer_indices, a_offsets, false);
+}
+
+void BB::SetComputeDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets)
+{
+	Vulkan::SetDescriptorBufferOffset(a_list, a_pipe_layout, a_first_set, a_set_count, a_buffer_indices, a_offsets, true);
 }
 
 const BB::DescriptorAllocation& BB::GetGlobalDescriptorAllocation()
@@ -6,6 +6,7 @@
 
 #include "Storage/LinkedList.h"
 #include "MemoryInterfaces.hpp"
+#include "OffsetAllocator.hpp"
 #include "Storage/FixedArray.h"
 #include "BBImage.hpp"
 
@@ -42,6 +43,8 @@ namespace BB
 
 	GPUDeviceInfo GetGPUInfo(MemoryArena& a_arena);
 	uint32_t GetBackBufferCount();
+	// the frames started since the renderer was made, a frame is done on the gpu once GetBackBufferCount frames started after it.
+	uint64_t GetFrameNumber();
 
 	struct RenderStartFrameInfo
 	{
@@ -59,6 +62,8 @@ namespace BB
 
 	void BindIndexBuffer(const RCommandList a_list, const uint64_t a_offset, const bool a_cpu_readable = false);
 	RPipelineLayout BindShaders(const RCommandList a_list, const ShaderEffectHandle a_vertex, const ShaderEffectHandle a_fragment_pixel, const ShaderEffectHandle a_geometry);
+	// compute has its own bind point, the descriptor buffer offsets need to be set with SetComputeDescriptorBufferOffset.
+	RPipelineLayout BindComputeShader(const RCommandList a_list, const ShaderEffectHandle a_compute);
 	void SetBlendMode(const RCommandList a_list, const uint32_t a_first_attachment, const Slice<ColorBlendState> a_blend_states);
     void SetPrimitiveTopology(const RCommandList a_list, const PRIMITIVE_TOPOLOGY a_topology);
 	void SetFrontFace(const RCommandList a_list, const bool a_is_clockwise);
@@ -69,18 +74,33 @@ namespace BB
 	void DrawVertices(const RCommandList a_list, const uint32_t a_vertex_count, const uint32_t a_instance_count, const uint32_t a_first_vertex, const uint32_t a_first_instance);
 	void DrawCubemap(const RCommandList a_list, const uint32_t a_instance_count, const uint32_t a_first_instance);
 	void DrawIndexed(const RCommandList a_list, const uint32_t a_index_count, const uint32_t a_instance_count, const uint32_t a_first_index, const int32_t a_vertex_offset, const uint32_t a_first_instance);
+	// a_buffer holds ShaderDrawIndexedIndirect arguments, the buffer needs to be BUFFER_TYPE::INDIRECT.
+	void DrawIndexedIndirect(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset, const uint32_t a_draw_count, const uint32_t a_stride);
+	void DispatchCompute(const RCommandList a_list, const uint32_t a_group_count_x, const uint32_t a_group_count_y, const uint32_t a_group_count_z);
 
 	CommandPool& GetGraphicsCommandPool();
 	CommandPool& GetTransferCommandPool();
-	CommandPool& GetCommandCommandPool();
+	CommandPool& GetComputeCommandPool();
 
-	PRESENT_IMAGE_RESULT PresentFrame(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value, const bool a_skip);
-	bool ExecuteGraphicCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value);
-	bool ExecuteTransferCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value);
-	bool ExecuteComputeCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, uint64_t& a_out_present_fence_value);
+	// the wait fences only hold back fragment and compute shaders, so the vertex and depth only work of the frame can start before they are signaled.
+	PRESENT_IMAGE_RESULT PresentFrame(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value, const bool a_skip);
+	// the wait fences can be signaled by work that is submitted later to another queue.
+	bool ExecuteGraphicCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value);
+	bool ExecuteTransferCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value);
+	bool ExecuteComputeCommands(const BB::Slice<CommandPool> a_cmd_pools, const RFence* a_signal_fences, const uint64_t* a_signal_values, const uint32_t a_signal_count, const RFence* a_wait_fences, const uint64_t* a_wait_values, const uint32_t a_wait_count, uint64_t& a_out_present_fence_value);
 
 	GPUBufferView AllocateFromVertexBuffer(const size_t a_size_in_bytes);
 	GPUBufferView AllocateFromIndexBuffer(const size_t a_size_in_bytes);
+	// the allocation can be given back with FreeFromVertexBuffer or FreeFromIndexBuffer.
+	GPUBufferView AllocateFromVertexBuffer(const size_t a_size_in_bytes, OffsetAllocation& a_out_allocation);
+	GPUBufferView AllocateFromIndexBuffer(const size_t a_size_in_bytes, OffsetAllocation& a_out_allocation);
+	// the space is reused once the frames in flight are done with it.
+	void FreeFromVertexBuffer(const OffsetAllocation a_allocation);
+	void FreeFromIndexBuffer(const OffsetAllocation a_allocation);
+	// copies the allocation to a lower offset in the same buffer and frees the old space, returns false if there is no lower space.
+	// add a global barrier after the copies before the new offsets are used.
+	bool RelocateInVertexBuffer(const RCommandList a_list, OffsetAllocation& a_allocation);
+	bool RelocateInIndexBuffer(const RCommandList a_list, OffsetAllocation& a_allocation);
 	void CopyToVertexBuffer(const RCommandList a_list, const GPUBuffer a_src, const Slice<RenderCopyBufferRegion> a_regions);
 	void CopyToIndexBuffer(const RCommandList a_list, const GPUBuffer a_src, const Slice<RenderCopyBufferRegion> a_regions);
 
@@ -101,6 +121,12 @@ namespace BB
 	void FreeImage(const RImage a_image);
 	void FreeImageView(const RDescriptorIndex a_index);
 	void FreeImageViewShaderInaccessible(const RImageView a_image_view);
+	// images placed in a shared heap, used to alias the memory of images that are never alive at the same time.
+	GPUMemoryRequirements GetImageMemoryRequirements(const ImageCreateInfo& a_create_info);
+	RMemoryHeap CreateMemoryHeap(const char* a_name, const GPUMemoryRequirements& a_requirements);
+	void FreeMemoryHeap(const RMemoryHeap a_heap);
+	const RImage CreateAliasedImage(const ImageCreateInfo& a_create_info, const RMemoryHeap a_heap, const uint64_t a_heap_offset);
+	void FreeAliasedImage(const RImage a_image);
 
 	void ClearImage(const RCommandList a_list, const ClearImageInfo& a_clear_info);
 	void ClearDepthImage(const RCommandList a_list, const ClearDepthImageInfo& a_clear_info);
@@ -137,9 +163,18 @@ namespace BB
 	void WaitFences(const RFence* a_fences, const GPUFenceValue* a_fence_values, const uint32_t a_fence_count);
 	GPUFenceValue GetCurrentFenceValue(const RFence a_fence);
 
+	RTimestampPool CreateTimestampPool(const uint32_t a_timestamp_count, const char* a_name);
+	void FreeTimestampPool(const RTimestampPool a_pool);
+	// timestamps must be reset before they are written again.
+	void ResetTimestamps(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count);
+	void WriteTimestamp(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_index);
+	// in miliseconds from an arbitrary start, false when the gpu did not write all of them yet.
+	bool ReadTimestamps(const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count, double* a_miliseconds);
+
 	void SetPushConstants(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_offset, const uint32_t a_size, const void* a_data);
 	void PipelineBarriers(const RCommandList a_list, const struct PipelineBarrierInfo& a_barrier_info);
 	void SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets);
+	void SetComputeDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets);
 	const DescriptorAllocation& GetGlobalDescriptorAllocation();
 
 	RDescriptorIndex GetDebugTexture();
@@ -20,8 +20,10 @@ namespace BB
 	using RImage = FrameworkHandle<struct RImageTag>;
 	using RImageView = FrameworkHandle<struct RImageViewTag>;
 	using RAccelerationStruct = FrameworkHandle<struct RAccelerationStuctTag>;
+	using RMemoryHeap = FrameworkHandle<struct RMemoryHeapTag>;
 
 	using RFence = FrameworkHandle<struct RFenceTag>;
+	using RTimestampPool = FrameworkHandle<struct RTimestampPoolTag>;
 	
 	using ShaderCode = FrameworkHandle<struct ShaderCodeTag>;
 	using ShaderEffectHandle = FrameworkHandle<struct ShaderEffectHandleTag>;
@@ -34,8 +36,10 @@ namespace BB
 		VERTEX			= 1 << 1,
 		FRAGMENT_PIXEL	= 1 << 2,
 		GEOMETRY		= 1 << 3,
+		COMPUTE			= 1 << 4,
 		ENUM_SIZE		= 5
 	};
+	// the graphics stages, compute is bound on its own.
 	constexpr uint32_t UNIQUE_SHADER_STAGE_COUNT = 3;
 	constexpr SHADER_STAGE CONSEQUTIVE_SHADER_STAGES[] = { SHADER_STAGE::VERTEX, SHADER_STAGE::FRAGMENT_PIXEL, SHADER_STAGE::GEOMETRY };
 
@@ -201,6 +205,7 @@ namespace BB
 		UNIFORM,
 		VERTEX,
 		INDEX,
+		INDIRECT,	// storage buffer that can also be used for indirect draw arguments
 		RT_ACCELERATION,
 		RT_BUILD_ACCELERATION,
 
@@ -386,6 +391,15 @@ namespace BB
 		uint64_t vertex_color_offset;
 		uint64_t vertex_tangent_offset;
 		uint64_t index_buffer_offset;
+		// VERTEX_FORMAT_FLOAT or VERTEX_FORMAT_COMPRESSED
+		uint32_t vertex_format;
+	};
+
+	// a mesh that was moved inside the vertex and index buffer.
+	struct MeshRelocation
+	{
+		Mesh old_mesh;
+		Mesh new_mesh;
 	};
 
 	using ShaderDescriptorLayouts = FixedArray<RDescriptorLayout, SPACE_AMOUNT>;
@@ -402,10 +416,9 @@ namespace BB
 		uint32_t desc_layout_count;
 	};
 
+	// a full memory barrier, every write before it is visible to every command after it.
 	struct PipelineBarrierGlobalInfo
 	{
-		uint32_t todo;
-		// TODO
 	};
 
 	struct PipelineBarrierBufferInfo
@@ -453,6 +466,13 @@ namespace BB
 		bool is_cube_map;
 	};
 
+	struct GPUMemoryRequirements
+	{
+		uint64_t size;
+		uint64_t alignment;
+		uint32_t memory_type_bits;	// the memory types the resource can be placed in, combine them with & for a shared heap
+	};
+
 	struct ImageViewCreateInfo
 	{
 		const char* name;
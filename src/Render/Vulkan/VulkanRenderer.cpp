@@ -367,6 +367,8 @@ static VkDevice CreateLogicalDevice(MemoryArena& a_temp_arena, const VkPhysicalD
 	VkPhysicalDeviceFeatures device_features{};
 	device_features.geometryShader = VK_TRUE;
 	device_features.samplerAnisotropy = VK_TRUE;
+	// compute shaders read and write buffers through 64 bit device addresses.
+	device_features.shaderInt64 = VK_TRUE;
 	VkPhysicalDeviceTimelineSemaphoreFeatures timeline_sem_features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES };
 	timeline_sem_features.timelineSemaphore = VK_TRUE;
 	timeline_sem_features.pNext = nullptr;
@@ -476,6 +478,8 @@ struct Vulkan_inst
 	struct DeviceInfo
 	{
 		float max_anisotropy;
+		// nanoseconds per timestamp tick.
+		float timestamp_period;
 	} device_info;
 
 	struct DescriptorSizes
@@ -593,6 +597,7 @@ static inline VkShaderStageFlags ShaderStageFlags(const SHADER_STAGE a_stage)
 	case SHADER_STAGE::VERTEX:				return VK_SHADER_STAGE_VERTEX_BIT;
 	case SHADER_STAGE::FRAGMENT_PIXEL:		return VK_SHADER_STAGE_FRAGMENT_BIT;
 	case SHADER_STAGE::GEOMETRY:		    return VK_SHADER_STAGE_GEOMETRY_BIT;
+	case SHADER_STAGE::COMPUTE:			    return VK_SHADER_STAGE_COMPUTE_BIT;
 	default:
 		BB_ASSERT(false, "Vulkan: SHADER_STAGE failed to convert to a VkShaderStageFlagBits.");
 		return VK_SHADER_STAGE_ALL;
@@ -754,7 +759,7 @@ static inline VkImageUsageFlags ImageUsage(const IMAGE_USAGE a_usage)
 {
 	switch (a_usage)
 	{
-	case IMAGE_USAGE::DEPTH:			    return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT BB_EXTENDED_IMAGE_USAGE_FLAGS;
+	case IMAGE_USAGE::DEPTH:			    return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT BB_EXTENDED_IMAGE_USAGE_FLAGS;
 	case IMAGE_USAGE::SHADOW_MAP:			return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT BB_EXTENDED_IMAGE_USAGE_FLAGS;
 	case IMAGE_USAGE::TEXTURE:			    return VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT BB_EXTENDED_IMAGE_USAGE_FLAGS;
 	case IMAGE_USAGE::SWAPCHAIN_COPY_IMG:	return  VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT BB_EXTENDED_IMAGE_USAGE_FLAGS;
@@ -1052,6 +1057,7 @@ bool Vulkan::InitializeVulkan(MemoryArena& a_arena, const RendererCreateInfo a_c
 			device_properties.pNext = &desc_info;
 			vkGetPhysicalDeviceProperties2(s_vulkan_inst->phys_device, &device_properties);
 			s_vulkan_inst->device_info.max_anisotropy = device_properties.properties.limits.maxSamplerAnisotropy;
+			s_vulkan_inst->device_info.timestamp_period = device_properties.properties.limits.timestampPeriod;
 
 			s_vulkan_inst->descriptor_sizes.uniform_buffer = static_cast<uint32_t>(desc_info.uniformBufferDescriptorSize);
 			s_vulkan_inst->descriptor_sizes.storage_buffer = static_cast<uint32_t>(desc_info.storageBufferDescriptorSize);
@@ -1406,6 +1412,9 @@ const GPUBuffer Vulkan::CreateBuffer(const GPUBufferCreateInfo& a_create_info)
 	case BUFFER_TYPE::INDEX:
 		buffer_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 		break;
+	case BUFFER_TYPE::INDIRECT:
+		buffer_info.usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+		break;
 	case BUFFER_TYPE::RT_ACCELERATION:
 		buffer_info.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 		break;
@@ -1625,7 +1634,7 @@ GPUAddress Vulkan::GetAccelerationStructureAddress(const RAccelerationStruct a_a
 	return GetAccelerationStructureAddress(s_vulkan_inst->device, reinterpret_cast<VkAccelerationStructureKHR>(a_acc_struct.handle));
 }
 
-const RImage Vulkan::CreateImage(const ImageCreateInfo& a_create_info)
+static VkImageCreateInfo FillImageCreateInfo(const ImageCreateInfo& a_create_info)
 {
 	VkImageCreateInfo image_create_info{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
 	image_create_info.extent.width = a_create_info.width;
@@ -1645,6 +1654,13 @@ const RImage Vulkan::CreateImage(const ImageCreateInfo& a_create_info)
 	image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
 	image_create_info.flags = a_create_info.is_cube_map ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
 
+	return image_create_info;
+}
+
+const RImage Vulkan::CreateImage(const ImageCreateInfo& a_create_info)
+{
+	const VkImageCreateInfo image_create_info = FillImageCreateInfo(a_create_info);
+
 	VmaAllocationCreateInfo alloc_info{};
 	alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
 	alloc_info.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
@@ -1680,6 +1696,72 @@ void Vulkan::FreeImage(const RImage a_image)
 	s_vulkan_inst->allocation_map.erase(a_image.handle);
 }
 
+GPUMemoryRequirements Vulkan::GetImageMemoryRequirements(const ImageCreateInfo& a_create_info)
+{
+	const VkImageCreateInfo image_create_info = FillImageCreateInfo(a_create_info);
+	VkDeviceImageMemoryRequirements image_requirements{ VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS };
+	image_requirements.pCreateInfo = &image_create_info;
+
+	VkMemoryRequirements2 memory_requirements{ VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+	vkGetDeviceImageMemoryRequirements(s_vulkan_inst->device, &image_requirements, &memory_requirements);
+
+	GPUMemoryRequirements requirements;
+	requirements.size = memory_requirements.memoryRequirements.size;
+	requirements.alignment = memory_requirements.memoryRequirements.alignment;
+	requirements.memory_type_bits = memory_requirements.memoryRequirements.memoryTypeBits;
+	return requirements;
+}
+
+RMemoryHeap Vulkan::CreateMemoryHeap(const char* a_name, const GPUMemoryRequirements& a_requirements)
+{
+	VkMemoryRequirements memory_requirements;
+	memory_requirements.size = a_requirements.size;
+	memory_requirements.alignment = a_requirements.alignment;
+	memory_requirements.memoryTypeBits = a_requirements.memory_type_bits;
+
+	VmaAllocationCreateInfo alloc_info{};
+	alloc_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	VmaAllocation allocation;
+	VKASSERT(vmaAllocateMemory(s_vulkan_inst->vma,
+		&memory_requirements,
+		&alloc_info,
+		&allocation,
+		nullptr),
+		"Vulkan: Failed to allocate memory heap");
+	vmaSetAllocationName(s_vulkan_inst->vma, allocation, a_name);
+
+	return RMemoryHeap(reinterpret_cast<uintptr_t>(allocation));
+}
+
+void Vulkan::FreeMemoryHeap(const RMemoryHeap a_heap)
+{
+	vmaFreeMemory(s_vulkan_inst->vma, reinterpret_cast<VmaAllocation>(a_heap.handle));
+}
+
+const RImage Vulkan::CreateAliasedImage(const ImageCreateInfo& a_create_info, const RMemoryHeap a_heap, const uint64_t a_heap_offset)
+{
+	const VkImageCreateInfo image_create_info = FillImageCreateInfo(a_create_info);
+
+	VkImage image;
+	VKASSERT(vmaCreateAliasingImage2(s_vulkan_inst->vma,
+		reinterpret_cast<VmaAllocation>(a_heap.handle),
+		a_heap_offset,
+		&image_create_info,
+		&image),
+		"Vulkan: Failed to create aliased image");
+
+	SetDebugName(a_create_info.name, image, VK_OBJECT_TYPE_IMAGE);
+
+	return RImage(reinterpret_cast<uintptr_t>(image));
+}
+
+void Vulkan::FreeAliasedImage(const RImage a_image)
+{
+	// the memory belongs to the heap, only the image goes.
+	vkDestroyImage(s_vulkan_inst->device, reinterpret_cast<VkImage>(a_image.handle), nullptr);
+}
+
 const RImageView Vulkan::CreateImageView(const ImageViewCreateInfo& a_create_info)
 {
 	VkImageViewCreateInfo view_info{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
@@ -2356,7 +2438,6 @@ static void _PipelineBarrierFillStages(const IMAGE_LAYOUT a_usage, VkPipelineSta
 	case IMAGE_LAYOUT::RO_COMPUTE:
 		a_stage_flags = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
 		a_access_flags = VK_ACCESS_2_SHADER_READ_BIT;
-		a_access_flags = VK_IMAGE_ASPECT_COLOR_BIT;
 		a_image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		break;
 	case IMAGE_LAYOUT::RW_GEOMETRY:
@@ -2418,7 +2499,13 @@ void Vulkan::PipelineBarriers(const RCommandList a_list, const PipelineBarrierIn
 
 	for (size_t i = 0; i < a_barriers.global_barriers.size(); i++)
 	{
-		BB_UNIMPLEMENTED("implement global barriers");
+		VkMemoryBarrier2& wr_b = global_barriers[i];
+		wr_b.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		wr_b.pNext = nullptr;
+		wr_b.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		wr_b.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+		wr_b.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		wr_b.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
 	}
 
 	for (size_t i = 0; i < a_barriers.buffer_barriers.size(); i++)
@@ -2527,8 +2614,8 @@ void Vulkan::StartRenderPass(const RCommandList a_list, const StartRenderingInfo
 
 	// maybe make this it's own function? Think there is no need now
 	VkViewport viewport{};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
+	viewport.x = static_cast<float>(a_render_info.render_area_offset.x);
+	viewport.y = static_cast<float>(a_render_info.render_area_offset.y);
 	viewport.width = static_cast<float>(a_render_info.render_area_extent.x);
 	viewport.height = static_cast<float>(a_render_info.render_area_extent.y);
 	viewport.minDepth = 0.0f;
@@ -2587,6 +2674,13 @@ void Vulkan::BindShaders(const RCommandList a_list, const uint32_t a_shader_stag
 	vkCmdSetPrimitiveRestartEnable(cmd_buffer, VK_FALSE);
 }
 
+void Vulkan::BindComputeShader(const RCommandList a_list, const ShaderObject a_shader_object)
+{
+	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
+	const VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	s_vulkan_inst->pfn.CmdBindShadersEXT(cmd_buffer, 1, &stage, reinterpret_cast<const VkShaderEXT*>(&a_shader_object));
+}
+
 void Vulkan::SetBlendMode(const RCommandList a_list, const uint32_t a_first_attachment, const Slice<ColorBlendState> a_blend_states)
 {
 	BB_ASSERT(a_blend_states.size() < MAX_COLOR_ATTACHMENTS, "more then MAX_COLOR_ATTACHMENTS of blend states");
@@ -2652,22 +2746,22 @@ void Vulkan::SetDepthBias(const RCommandList a_list, const float a_bias_constant
 	vkCmdSetDepthBias(cmd_buffer, a_bias_constant_factor, a_bias_clamp, a_bias_slope_factor);
 }
 
-void Vulkan::SetDescriptorImmutableSamplers(const RCommandList a_list, const RPipelineLayout a_pipe_layout)
+void Vulkan::SetDescriptorImmutableSamplers(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const bool a_compute_bind_point)
 {
 	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
 
 	s_vulkan_inst->pfn.CmdBindDescriptorBufferEmbeddedSamplersEXT(cmd_buffer,
-		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		a_compute_bind_point ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS,
 		reinterpret_cast<VkPipelineLayout>(a_pipe_layout.handle),
 		SPACE_IMMUTABLE_SAMPLER);
 }
 
-void Vulkan::SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets)
+void Vulkan::SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets, const bool a_compute_bind_point)
 {
 	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
 
 	s_vulkan_inst->pfn.CmdSetDescriptorBufferOffsetsEXT(cmd_buffer,
-		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		a_compute_bind_point ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS,
 		reinterpret_cast<VkPipelineLayout>(a_pipe_layout.handle),
 		a_first_set,
 		a_set_count,
@@ -2700,6 +2794,20 @@ void Vulkan::DrawIndexed(const RCommandList a_list, const uint32_t a_index_count
 	vkCmdDrawIndexed(cmd_buffer, a_index_count, a_instance_count, a_first_index, a_vertex_offset, a_first_instance);
 }
 
+void Vulkan::DrawIndexedIndirect(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset, const uint32_t a_draw_count, const uint32_t a_stride)
+{
+	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
+
+	vkCmdDrawIndexedIndirect(cmd_buffer, reinterpret_cast<VkBuffer>(a_buffer.handle), a_offset, a_draw_count, a_stride);
+}
+
+void Vulkan::DispatchCompute(const RCommandList a_list, const uint32_t a_group_count_x, const uint32_t a_group_count_y, const uint32_t a_group_count_z)
+{
+	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
+
+	vkCmdDispatch(cmd_buffer, a_group_count_x, a_group_count_y, a_group_count_z);
+}
+
 PRESENT_IMAGE_RESULT Vulkan::UploadImageToSwapchain(const RCommandList a_list, const RImage a_src_image, const uint32_t a_array_layer, const int2 a_src_image_size, const int2 a_swapchain_size, const uint32_t a_backbuffer_index)
 {
 	uint32_t image_index;
@@ -2813,6 +2921,14 @@ void Vulkan::ExecuteCommandLists(const RQueue a_queue, const ExecuteCommandsInfo
 		a_execute_info_count,
 		VkSubmitInfo);
 
+	// the waits come from other queues, so nothing in the lists can start before they are done.
+	uint32_t max_wait_count = 0;
+	for (size_t i = 0; i < a_execute_info_count; i++)
+		max_wait_count = Max(max_wait_count, a_execute_infos[i].wait_count);
+	VkPipelineStageFlags* wait_stages = BBstackAlloc(max_wait_count + 1, VkPipelineStageFlags);
+	for (uint32_t i = 0; i < max_wait_count; i++)
+		wait_stages[i] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
 	for (size_t i = 0; i < a_execute_info_count; i++)
 	{
 		const ExecuteCommandsInfo& exe_inf = a_execute_infos[i];
@@ -2832,6 +2948,7 @@ void Vulkan::ExecuteCommandLists(const RQueue a_queue, const ExecuteCommandsInfo
 		cur_sub_inf.pCommandBuffers = reinterpret_cast<const VkCommandBuffer*>(exe_inf.lists);
 		cur_sub_inf.waitSemaphoreCount = exe_inf.wait_count;
 		cur_sub_inf.pWaitSemaphores = reinterpret_cast<const VkSemaphore*>(exe_inf.wait_fences);
+		cur_sub_inf.pWaitDstStageMask = wait_stages;
 		cur_sub_inf.signalSemaphoreCount = exe_inf.signal_count;
 		cur_sub_inf.pSignalSemaphores = reinterpret_cast<const VkSemaphore*>(exe_inf.signal_fences);
 	}
@@ -2846,15 +2963,13 @@ void Vulkan::ExecuteCommandLists(const RQueue a_queue, const ExecuteCommandsInfo
 
 PRESENT_IMAGE_RESULT Vulkan::ExecutePresentCommandList(const RQueue a_queue, const ExecuteCommandsInfo& a_execute_info, const uint32_t a_backbuffer_index)
 {
-	// TEMP
-	constexpr VkPipelineStageFlags WAIT_STAGES[8] = { VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT };
-
 	// handle the window api for vulkan.
 	const uint32_t wait_semaphore_count = a_execute_info.wait_count + 1;
 	const uint32_t signal_semaphore_count = a_execute_info.signal_count + 1;
 
 	VkSemaphore* wait_semaphores = BBstackAlloc(wait_semaphore_count, VkSemaphore);
-	uint64_t* wait_values = BBstackAlloc(signal_semaphore_count, uint64_t);
+	uint64_t* wait_values = BBstackAlloc(wait_semaphore_count, uint64_t);
+	VkPipelineStageFlags* wait_stages = BBstackAlloc(wait_semaphore_count, VkPipelineStageFlags);
 	VkSemaphore* signal_semaphores = BBstackAlloc(signal_semaphore_count, VkSemaphore);
 	uint64_t* signal_values = BBstackAlloc(signal_semaphore_count, uint64_t);
 
@@ -2864,6 +2979,10 @@ PRESENT_IMAGE_RESULT Vulkan::ExecutePresentCommandList(const RQueue a_queue, con
 	Memory::Copy(wait_values, a_execute_info.wait_values, a_execute_info.wait_count);
 	wait_semaphores[a_execute_info.wait_count] = s_vulkan_swapchain->frames[a_backbuffer_index].image_available_semaphore;
 	wait_values[a_execute_info.wait_count] = 0;
+	// the user waits are post processing from the async compute queue, only the shading has to wait on it.
+	for (uint32_t i = 0; i < a_execute_info.wait_count; i++)
+		wait_stages[i] = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	wait_stages[a_execute_info.wait_count] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
 	Memory::Copy<VkSemaphore>(signal_semaphores, a_execute_info.signal_fences, a_execute_info.signal_count);
 	Memory::Copy(signal_values, a_execute_info.signal_values, a_execute_info.signal_count);
@@ -2884,7 +3003,7 @@ PRESENT_IMAGE_RESULT Vulkan::ExecutePresentCommandList(const RQueue a_queue, con
 	submit_info.pWaitSemaphores = wait_semaphores;
 	submit_info.signalSemaphoreCount = signal_semaphore_count;
 	submit_info.pSignalSemaphores = signal_semaphores;
-	submit_info.pWaitDstStageMask = WAIT_STAGES;
+	submit_info.pWaitDstStageMask = wait_stages;
 
 	VkQueue queue = reinterpret_cast<VkQueue>(a_queue.handle);
 	VKASSERT(vkQueueSubmit(queue,
@@ -2969,6 +3088,65 @@ GPUFenceValue Vulkan::GetCurrentFenceValue(const RFence a_fence)
 	return value;
 }
 
+RTimestampPool Vulkan::CreateTimestampPool(const uint32_t a_timestamp_count, const char* a_name)
+{
+	VkQueryPoolCreateInfo query_pool_info{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+	query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	query_pool_info.queryCount = a_timestamp_count;
+
+	VkQueryPool query_pool;
+	VKASSERT(vkCreateQueryPool(s_vulkan_inst->device,
+		&query_pool_info,
+		nullptr,
+		&query_pool),
+		"Vulkan: failed to create timestamp query pool");
+
+	SetDebugName(a_name, query_pool, VK_OBJECT_TYPE_QUERY_POOL);
+
+	return RTimestampPool(reinterpret_cast<uintptr_t>(query_pool));
+}
+
+void Vulkan::FreeTimestampPool(const RTimestampPool a_pool)
+{
+	vkDestroyQueryPool(s_vulkan_inst->device, reinterpret_cast<VkQueryPool>(a_pool.handle), nullptr);
+}
+
+void Vulkan::ResetTimestamps(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count)
+{
+	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
+	vkCmdResetQueryPool(cmd_buffer, reinterpret_cast<VkQueryPool>(a_pool.handle), a_first, a_count);
+}
+
+void Vulkan::WriteTimestamp(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_index)
+{
+	// all commands, so the timestamp is written once everything recorded before it finished.
+	const VkCommandBuffer cmd_buffer = reinterpret_cast<VkCommandBuffer>(a_list.handle);
+	vkCmdWriteTimestamp2(cmd_buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, reinterpret_cast<VkQueryPool>(a_pool.handle), a_index);
+}
+
+bool Vulkan::ReadTimestamps(const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count, double* a_miliseconds)
+{
+	constexpr uint32_t MAX_TIMESTAMPS_READ = 16;
+	BB_ASSERT(a_count <= MAX_TIMESTAMPS_READ, "Vulkan: reading too many timestamps at once");
+	uint64_t ticks[MAX_TIMESTAMPS_READ];
+	// no wait flag, VK_NOT_READY when the gpu did not write all of them yet.
+	const VkResult result = vkGetQueryPoolResults(s_vulkan_inst->device,
+		reinterpret_cast<VkQueryPool>(a_pool.handle),
+		a_first,
+		a_count,
+		sizeof(ticks),
+		ticks,
+		sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS)
+		return false;
+
+	const double miliseconds_per_tick = static_cast<double>(s_vulkan_inst->device_info.timestamp_period) / 1000000.0;
+	for (uint32_t i = 0; i < a_count; i++)
+		a_miliseconds[i] = static_cast<double>(ticks[i]) * miliseconds_per_tick;
+	return true;
+}
+
 RQueue Vulkan::GetQueue(const QUEUE_TYPE a_queue_type, const char* a_name)
 {
 	uint32_t queue_index;
@@ -9,6 +9,7 @@
 
 namespace BB
 {
+	// the backend interface, Null/NullRenderer.cpp implements these as well when RENDERER_NULL_BACKEND is on.
 	namespace Vulkan //annoying, but many function names actually overlap.
 	{
 		bool InitializeVulkan(MemoryArena& a_arena, const RendererCreateInfo a_create_info);
@@ -34,6 +35,11 @@ namespace BB
 
 		const RImage CreateImage(const ImageCreateInfo& a_create_info);
 		void FreeImage(const RImage a_image);
+		GPUMemoryRequirements GetImageMemoryRequirements(const ImageCreateInfo& a_create_info);
+		RMemoryHeap CreateMemoryHeap(const char* a_name, const GPUMemoryRequirements& a_requirements);
+		void FreeMemoryHeap(const RMemoryHeap a_heap);
+		const RImage CreateAliasedImage(const ImageCreateInfo& a_create_info, const RMemoryHeap a_heap, const uint64_t a_heap_offset);
+		void FreeAliasedImage(const RImage a_image);
 
 		const RImageView CreateImageView(const ImageViewCreateInfo& a_create_info);
 		void FreeViewImage(const RImageView a_image_view);
@@ -78,17 +84,20 @@ namespace BB
 		void BindIndexBuffer(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset);
 		void SetPrimitiveTopology(const RCommandList a_list, const PRIMITIVE_TOPOLOGY a_topology);
 		void BindShaders(const RCommandList a_list, const uint32_t a_shader_stage_count, const SHADER_STAGE* a_shader_stages, const ShaderObject* a_shader_objects);
+		void BindComputeShader(const RCommandList a_list, const ShaderObject a_shader_object);
 		void SetBlendMode(const RCommandList a_list, const uint32_t a_first_attachment, const Slice<ColorBlendState> a_blend_states);
         void SetPrimitiveTopology(const RCommandList a_list, const PRIMITIVE_TOPOLOGY a_topology);
         void SetFrontFace(const RCommandList a_list, const bool a_is_clockwise);
 		void SetCullMode(const RCommandList a_list, const CULL_MODE a_cull_mode);
 		void SetDepthBias(const RCommandList a_list, const float a_bias_constant_factor, const float a_bias_clamp, const float a_bias_slope_factor);
-		void SetDescriptorImmutableSamplers(const RCommandList a_list, const RPipelineLayout a_pipe_layout);
-		void SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets);
+		void SetDescriptorImmutableSamplers(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const bool a_compute_bind_point);
+		void SetDescriptorBufferOffset(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_first_set, const uint32_t a_set_count, const uint32_t* a_buffer_indices, const size_t* a_offsets, const bool a_compute_bind_point);
 		void SetPushConstants(const RCommandList a_list, const RPipelineLayout a_pipe_layout, const uint32_t a_offset, const uint32_t a_size, const void* a_data);
 
 		void DrawVertices(const RCommandList a_list, const uint32_t a_vertex_count, const uint32_t a_instance_count, const uint32_t a_first_vertex, const uint32_t a_first_instance);
 		void DrawIndexed(const RCommandList a_list, const uint32_t a_index_count, const uint32_t a_instance_count, const uint32_t a_first_index, const int32_t a_vertex_offset, const uint32_t a_first_instance);
+		void DrawIndexedIndirect(const RCommandList a_list, const GPUBuffer a_buffer, const uint64_t a_offset, const uint32_t a_draw_count, const uint32_t a_stride);
+		void DispatchCompute(const RCommandList a_list, const uint32_t a_group_count_x, const uint32_t a_group_count_y, const uint32_t a_group_count_z);
 		PRESENT_IMAGE_RESULT UploadImageToSwapchain(const RCommandList a_list, const RImage a_src_image, const uint32_t a_array_layer, const int2 a_src_image_size, const int2 a_swapchain_size, const uint32_t a_backbuffer_index);
 
 		void ExecuteCommandLists(const RQueue a_queue, const ExecuteCommandsInfo* a_execute_infos, const uint32_t a_execute_info_count);
@@ -100,6 +109,12 @@ namespace BB
 		void WaitFences(const RFence* a_fences, const GPUFenceValue* a_fence_values, const uint32_t a_fence_count);
 		GPUFenceValue GetCurrentFenceValue(const RFence a_fence);
 
+		RTimestampPool CreateTimestampPool(const uint32_t a_timestamp_count, const char* a_name);
+		void FreeTimestampPool(const RTimestampPool a_pool);
+		void ResetTimestamps(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count);
+		void WriteTimestamp(const RCommandList a_list, const RTimestampPool a_pool, const uint32_t a_index);
+		bool ReadTimestamps(const RTimestampPool a_pool, const uint32_t a_first, const uint32_t a_count, double* a_miliseconds);
+
 		RQueue GetQueue(const QUEUE_TYPE a_queue_type, const char* a_name);
 	}
 }
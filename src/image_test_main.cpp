@@ -91,7 +91,7 @@ int main(int argc, char** argv)
 	{
 		StackString<128> directory_names{"thread_count"};
 		char thread_count_str[4]{};
-		sprintf_s(thread_count_str, 3, "%u", thread_count);
+		snprintf(thread_count_str, sizeof(thread_count_str), "%u", thread_count);
 		directory_names.append(thread_count_str);
 		OSCreateDirectory(directory_names.c_str());
 		directory_names.append("/");